@@ -14,6 +14,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <utility>
 
 namespace OpenMS
 {
@@ -37,19 +38,35 @@ public:
 
     /// Compute optimal solution and return value of objective function
     /// If the input feature map is empty, a warning is issued and -1 is returned.
-    /// @return value of objective function
+    /// The connected components of the edge graph are solved independently (in parallel if
+    /// OpenMS uses COIN-OR), components with an obvious unique optimum without the ILP.
+    /// @return value of objective function (summed over all components)
     /// and @p pairs will have all realized edges set to "active"
     double compute(const FeatureMap& fm, PairsType& pairs, Size verbose_level) const;
 
 private:
 
-    /// slicing the problem into subproblems
-    double computeSlice_(const FeatureMap& fm,
-                         PairsType& pairs,
-                         const PairsIndex margin_left,
-                         const PairsIndex margin_right,
+    /// half-open ranges of edges
+    typedef std::vector<std::pair<PairsIndex, PairsIndex> > RangesType;
+
+    /// solve the ILP of the edges in @p ranges (one or more connected components)
+    double computeSlice_(PairsType& pairs,
+                         const RangesType& ranges,
                          const Size verbose_level) const;
 
+    /**
+      @brief Solves a connected component without the ILP, if its optimum is unique and easy to find
+
+      Components without conflicting charge variants (all edges are realized) and trees (by dynamic
+      programming) are solved, unless another realization of the edges gives the same score.
+
+      @return whether the component was solved (then @p objective is set)
+    */
+    bool solveTrivialComponent_(PairsType& pairs,
+                                const PairsIndex margin_left,
+                                const PairsIndex margin_right,
+                                double& objective) const;
+
     /// slicing the problem into subproblems
     double computeSliceOld_(const FeatureMap& fm,
                             PairsType& pairs,
@@ -0,0 +1,169 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/FORMAT/MappedIndexFile.h>
+
+#include <string_view>
+#include <utility>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Memory-mappable store of the digested peptides of a FASTA database
+
+    Digesting a protein database and generating the modified variants of its
+    peptides is repeated by every search for every input file. A digest store
+    holds the result once: all unique (modified) peptides with their
+    monoisotopic masses, sorted by mass, together with references to the
+    proteins they occur in. Opening a store only maps the file into memory,
+    after which all peptides of a precursor mass window can be retrieved by
+    binary search (see getPeptideRange()).
+
+    The content of a store depends on the FASTA file and on the digestion
+    settings (see Parameters). Both are recorded in the file, such that a
+    store can be kept next to the database and reused as long as neither
+    changed (see isUpToDate() and openOrCreate()). The FASTA file is
+    identified by its size and modification time and, if those differ, by the
+    SHA1 checksum of its content.
+
+    Peptides containing ambiguous amino acids (B, X, Z) are skipped. Modified
+    variants of a peptide are generated with ModifiedPeptideGenerator; the
+    unmodified sequence of each variant and its position in the generated
+    list are available as well.
+
+    @note The file uses the byte order of the machine it was written on.
+
+    @ingroup Analysis_ID
+  */
+  class OPENMS_DLLAPI DigestStore
+  {
+public:
+
+    /// Index into the string pool
+    typedef Internal::MappedIndexFile::StringIndex StringIndex;
+
+    /// Settings of the digestion (everything the content of a store depends on, except for the database)
+    struct OPENMS_DLLAPI Parameters
+    {
+      String enzyme = "Trypsin";
+      EnzymaticDigestion::Specificity specificity = EnzymaticDigestion::SPEC_FULL;
+      Size missed_cleavages = 1;
+      Size min_length = 6;
+      Size max_length = 40; ///< 0 = no restriction
+      StringList fixed_modifications;
+      StringList variable_modifications;
+      Size max_variable_mods_per_peptide = 2;
+
+      /// Canonical description of the settings (stored in the file)
+      String getFingerprint() const;
+    };
+
+    /// Fixed-size peptide record
+    struct PeptideRecord
+    {
+      double mass; ///< monoisotopic (neutral) mass
+      StringIndex sequence; ///< modified sequence (AASequence::toString())
+      StringIndex unmodified_sequence;
+      UInt32 first_protein_ref; ///< index for getProteinRef()
+      UInt32 nr_protein_refs;
+      UInt32 variant_index; ///< position among the variants ModifiedPeptideGenerator generates for the unmodified sequence
+    };
+
+    /// Default constructor (no file opened)
+    DigestStore();
+
+    /// Destructor (unmaps the file)
+    ~DigestStore();
+
+    DigestStore(const DigestStore&) = delete;
+    DigestStore& operator=(const DigestStore&) = delete;
+
+    /**
+      @brief Digests a FASTA database and writes the store
+
+      @param filename The output file
+      @param fasta_file The protein database
+      @param params The digestion settings
+
+      @exception Exception::FileNotFound is thrown if @p fasta_file does not exist
+      @exception Exception::ParseError is thrown if @p fasta_file cannot be parsed
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+      @exception Exception::InvalidValue is thrown if the store exceeds the limits of the format (2^32 strings or records)
+    */
+    static void create(const String& filename, const String& fasta_file, const Parameters& params);
+
+    /**
+      @brief Whether @p filename is a valid store of @p fasta_file created with @p params
+
+      Returns false if the file does not exist, is not a digest store, was
+      created with other settings or from another version of the database.
+    */
+    static bool isUpToDate(const String& filename, const String& fasta_file, const Parameters& params);
+
+    /**
+      @brief Memory-maps a store
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::ParseError is thrown if the file is not a valid digest store
+    */
+    void open(const String& filename);
+
+    /// Opens @p filename, after (re)creating it if it is not up to date (see isUpToDate())
+    void openOrCreate(const String& filename, const String& fasta_file, const Parameters& params);
+
+    /// Whether a file is currently mapped
+    bool isOpen() const;
+
+    /// Unmaps the file
+    void close();
+
+    /** @name Zero-copy access to the mapped records
+    */
+    //@{
+    Size getNrPeptides() const;
+    Size getNrProteins() const;
+
+    /// Peptide @p index (sorted by mass)
+    const PeptideRecord& getPeptide(Size index) const;
+
+    /// Returns string @p index of the string pool (valid as long as the file is mapped)
+    std::string_view getString(StringIndex index) const;
+
+    /// Modified sequence of peptide @p index
+    std::string_view getSequence(Size index) const;
+
+    /// Identifier of protein @p index (in database order)
+    std::string_view getProteinAccession(Size index) const;
+
+    /// Protein reference @p index (see PeptideRecord::first_protein_ref); returns the index of the protein
+    UInt32 getProteinRef(Size index) const;
+
+    /// Half-open range [first, last) of all peptides with mass in [@p min_mass, @p max_mass]
+    std::pair<Size, Size> getPeptideRange(double min_mass, double max_mass) const;
+    //@}
+
+protected:
+
+    Internal::MappedIndexFile file_;
+
+    const StringIndex* proteins_ = nullptr;
+    const PeptideRecord* peptides_ = nullptr;
+    const UInt32* protein_refs_ = nullptr;
+
+    Size nr_proteins_ = 0;
+    Size nr_peptides_ = 0;
+    Size nr_protein_refs_ = 0;
+  };
+
+}
@@ -23,6 +23,7 @@ namespace OpenMS
 {
 
   struct ScoreToTgtDecLabelPairs;
+  class PSMTable;
 
   /**
     @brief Calculates false discovery rates (FDR) from identifications
@@ -71,6 +72,20 @@ public:
     */
     void apply(std::vector<PeptideIdentification>& id, bool annotate_peptide_fdr = false) const;
 
+    /**
+    @brief Calculates the FDR of one run from a concatenated sequence DB search, on a PSM table
+
+    Same as apply(std::vector<PeptideIdentification>&, bool), but works on the
+    columns of @p table. Charge variants and runs (if treated separately) are
+    processed in parallel. The original scores are kept in the numeric column
+    "<score type>_score", peptide-level values in "peptide q-value" (or
+    "peptide FDR").
+
+    @param table PSM table, containing target and decoy hits
+    @param annotate_peptide_fdr adds the peptide q-value or peptide fdr column. Calculation uses best PSM per peptide.
+    */
+    void apply(PSMTable& table, bool annotate_peptide_fdr = false) const;
+
     /**
     @brief Calculates the FDR of two runs, a forward run and decoy run on protein level
 
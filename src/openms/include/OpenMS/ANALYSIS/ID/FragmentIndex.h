@@ -0,0 +1,218 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/DATASTRUCTURES/StringView.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Inverted fragment ion index for fast candidate retrieval in database searches
+
+    Stores the theoretical fragment ions of all (modified) peptides of a
+    database in a compact, cache-friendly layout (as popularized by MSFragger
+    and Sage):
+
+    - peptides are sorted by mass, such that all candidates of a precursor
+      mass window form a contiguous index range (see getPeptideRange())
+    - fragments are sorted by m/z and split into buckets of fixed size; within
+      each bucket the fragments are sorted by peptide index
+
+    To score a spectrum, each of its peaks is looked up in the buckets that
+    overlap its tolerance window, and only fragments of peptides inside the
+    precursor mass window(s) are visited (binary search inside the bucket).
+    Matches are accumulated per peptide in a caller-provided Accumulator,
+    which makes concurrent queries from several threads possible (one
+    Accumulator per thread). The best scoring candidates are returned and are
+    usually rescored by an exact scoring function.
+
+    Unmodified sequences are stored once in a string pool; each peptide entry
+    refers to its sequence and to a modification index, the meaning of which
+    is defined by the caller (e.g. the enumeration index of
+    ModifiedPeptideGenerator). Entries without a sequence (e.g. the spectra of
+    a spectral library) can be added with addEntry() and are identified by a
+    caller-defined id (see getEntryId()).
+
+    Usage: addSequence() and addPeptide() (or addEntry()) for all entries,
+    followed by build().
+    An index can be stored to and loaded from a binary file, which remembers a
+    user-defined fingerprint of the settings that were used to create it (see
+    isUpToDate()).
+
+    @note The file uses the byte order of the machine it was written on.
+
+    @ingroup Analysis_ID
+  */
+  class OPENMS_DLLAPI FragmentIndex
+  {
+public:
+
+    /// Sequence index of the entries added with addEntry()
+    static constexpr UInt32 NO_SEQUENCE = std::numeric_limits<UInt32>::max();
+
+    /// A peptide of the index
+    struct Peptide
+    {
+      UInt32 sequence; ///< index of the unmodified sequence (see getSequence()), NO_SEQUENCE for entries added with addEntry()
+      UInt32 modification_index; ///< caller-defined index of the modified variant, or the id of an entry added with addEntry() (see getEntryId())
+      double mass; ///< monoisotopic (neutral) mass
+    };
+
+    /// A fragment ion of the index
+    struct Fragment
+    {
+      float mz;
+      UInt32 peptide; ///< index of the peptide (see getPeptide())
+    };
+
+    /// A candidate returned by query()
+    struct Candidate
+    {
+      UInt32 peptide; ///< index of the peptide (see getPeptide())
+      UInt32 matched_peaks; ///< number of matched fragments
+      double score; ///< preliminary score: log(1 + summed intensity) + log(matched_peaks!)
+    };
+
+    /// Per-thread scratch space of query()
+    struct Accumulator
+    {
+      std::vector<UInt32> matched_peaks;
+      std::vector<float> summed_intensity;
+      std::vector<UInt32> touched;
+    };
+
+    /// Default constructor (empty index)
+    FragmentIndex();
+
+    /// Removes all entries
+    void clear();
+
+    /**
+      @brief Adds an unmodified sequence to the string pool and returns its index
+
+      @exception Exception::InvalidValue is thrown if the index exceeds 2^32 sequences
+    */
+    UInt32 addSequence(const String& sequence);
+
+    /**
+      @brief Adds a peptide with its fragment ion m/z values
+
+      @param sequence Index of the sequence as returned by addSequence()
+      @param modification_index Caller-defined index of the modified variant
+      @param mass Monoisotopic mass of the peptide
+      @param fragment_mz The m/z values of the fragments (in any order)
+
+      @exception Exception::InvalidValue is thrown if the index exceeds 2^32 peptides
+    */
+    void addPeptide(UInt32 sequence, UInt32 modification_index, double mass, const std::vector<double>& fragment_mz);
+
+    /**
+      @brief Adds an entry without sequence (e.g. a library spectrum) with its fragment ion m/z values
+
+      @param id Caller-defined id of the entry (see getEntryId())
+      @param mass Mass of the entry (any mass-like value used to select candidates, e.g. the precursor m/z)
+      @param fragment_mz The m/z values of the fragments (in any order)
+
+      @exception Exception::InvalidValue is thrown if the index exceeds 2^32 peptides
+    */
+    void addEntry(UInt32 id, double mass, const std::vector<double>& fragment_mz);
+
+    /**
+      @brief Sorts peptides by mass and fragments into buckets
+
+      Must be called after the last addPeptide() and before any query.
+
+      @param bucket_size Number of fragments per m/z bucket
+    */
+    void build(Size bucket_size = 8192);
+
+    /// Whether build() was called (or the index was loaded) and no entries were added since
+    bool isBuilt() const;
+
+    Size getNrSequences() const;
+    Size getNrPeptides() const;
+    Size getNrFragments() const;
+    Size getBucketSize() const;
+
+    /// Returns the unmodified sequence @p index (valid as long as no sequences are added)
+    StringView getSequence(UInt32 index) const;
+
+    /// Returns peptide @p index (after build(), peptides are sorted by mass)
+    const Peptide& getPeptide(Size index) const;
+
+    /// Returns the id of entry @p index, as passed to addEntry() (or the modification index of a peptide)
+    UInt32 getEntryId(Size index) const;
+
+    /// Half-open range [first, last) of all peptides with mass in [@p min_mass, @p max_mass]
+    std::pair<Size, Size> getPeptideRange(double min_mass, double max_mass) const;
+
+    /**
+      @brief Retrieves the best candidates for a spectrum
+
+      Every peak of @p spectrum is matched against the fragments of all
+      peptides inside @p peptide_ranges (as returned by getPeptideRange(),
+      may overlap). Candidates are ranked by their preliminary score.
+
+      @param spectrum The spectrum (peak intensities are summed per candidate)
+      @param peptide_ranges The peptide index ranges to consider
+      @param fragment_mass_tolerance Fragment mass tolerance
+      @param fragment_mass_tolerance_unit_ppm Whether the tolerance is in ppm (otherwise Da)
+      @param max_candidates Maximum number of candidates returned
+      @param accumulator Scratch space; use one per thread
+      @param candidates The best candidates, ordered by decreasing score
+    */
+    void query(const MSSpectrum& spectrum,
+      const std::vector<std::pair<Size, Size>>& peptide_ranges,
+      double fragment_mass_tolerance,
+      bool fragment_mass_tolerance_unit_ppm,
+      Size max_candidates,
+      Accumulator& accumulator,
+      std::vector<Candidate>& candidates) const;
+
+    /**
+      @brief Writes the index to a binary file
+
+      @param filename The output file
+      @param fingerprint Arbitrary description of the settings used to create the index (see isUpToDate())
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+      @exception Exception::IllegalArgument is thrown if the index was not built
+    */
+    void store(const String& filename, const String& fingerprint) const;
+
+    /**
+      @brief Reads an index written by store()
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::ParseError is thrown if the file is not a valid fragment index
+    */
+    void load(const String& filename);
+
+    /// Whether @p filename is a fragment index that was stored with the given @p fingerprint
+    static bool isUpToDate(const String& filename, const String& fingerprint);
+
+protected:
+
+    std::string sequence_pool_;
+    std::vector<UInt64> sequence_offsets_; ///< size getNrSequences() + 1
+    std::vector<Peptide> peptides_;
+    std::vector<Fragment> fragments_;
+    std::vector<float> bucket_min_mz_; ///< smallest m/z of each bucket
+    Size bucket_size_ = 0;
+    bool built_ = false;
+  };
+
+} // namespace OpenMS
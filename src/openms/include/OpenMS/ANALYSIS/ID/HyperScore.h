@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
 #include <OpenMS/KERNEL/StandardTypes.h>
 #include <OpenMS/CONCEPT/Types.h>
 #include <OpenMS/CONCEPT/Macros.h>
@@ -58,6 +59,17 @@ struct OPENMS_DLLAPI HyperScore
                         PSMDetail& d
                        );
 
+  /** @brief compute the (ln transformed) X!Tandem HyperScore for fragments generated by TheoreticalSpectrumGenerator::getFragmentMZs()
+   *  Same as the overload for theoretical spectra with unit peak intensities, but b- and y-ions are recognized from the encoded
+   *  ions, which avoids creating (and comparing) ion name strings. Returns 0 if one of the inputs is empty.
+   */
+  static double computeWithDetail(double fragment_mass_tolerance,
+                        bool fragment_mass_tolerance_unit_ppm,
+                        const PeakSpectrum& exp_spectrum,
+                        const TheoreticalSpectrumGenerator::FragmentBuffer& theo_fragments,
+                        PSMDetail& d
+                       );
+
   private:
     /// helper to compute the log factorial
     static double logfactorial_(const int x, int base = 2);
@@ -357,6 +357,7 @@ namespace OpenMS
     // although we usually do long-running tasks per CC such that the extra virtual call does not matter much
     // Instead we gain type erasure.
     /// Do sth on connected components (your functor object has to inherit from std::function or be a lambda)
+    /// The components are processed in parallel, the biggest ones first. The second functor argument is the index of the component.
     void applyFunctorOnCCs(const std::function<unsigned long(Graph&, unsigned int)>& functor);
     /// Do sth on connected components single threaded (your functor object has to inherit from std::function or be a lambda)
     void applyFunctorOnCCsST(const std::function<void(Graph&)>& functor);
@@ -513,6 +514,9 @@ namespace OpenMS
     //vertex_t addVertexWithLookup_(IDPointerConst& ptr, std::unordered_map<IDPointerConst, vertex_t, boost::hash<IDPointerConst>>& vertex_map);
 
 
+    /// indices of the connected components, sorted by decreasing size (vertices plus edges)
+    std::vector<Size> getCCsBySizeDescending_() const;
+
     /// internal function to annotate the underlying ID structures based on the given Graph
     void annotateIndistProteins_(const Graph& fg, bool addSingletons);
     void calculateAndAnnotateIndistProteins_(const Graph& fg, bool addSingletons);
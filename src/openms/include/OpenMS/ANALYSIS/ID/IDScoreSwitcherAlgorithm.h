@@ -18,6 +18,7 @@
 
 namespace OpenMS
 {
+  class PSMTable;
 
   class OPENMS_DLLAPI IDScoreSwitcherAlgorithm:
     public DefaultParamHandler
@@ -88,6 +89,18 @@ namespace OpenMS
       id.setHigherScoreBetter(higher_better_);
     }
 
+    /**
+      @brief Switches the scores of all rows of @p table according to the
+      settings in the param object
+
+      Same as switchScores() for identifications, but the new score is taken
+      from the numeric column named like the new score (see
+      PSMTable::importIDs()) and the old score is stored in a numeric column.
+
+      @exception Exception::MissingInformation is thrown if the new score is not available for all rows
+    */
+    void switchScores(PSMTable& table, Size& counter);
+
     /// Looks at the first Hit of the given @p id and according to the given @p type ,
     /// deduces a fitting score and score direction to be switched to.
     /// Then tries to switch all hits.
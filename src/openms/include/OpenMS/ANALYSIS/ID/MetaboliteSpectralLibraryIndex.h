@@ -0,0 +1,158 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/FORMAT/MappedIndexFile.h>
+#include <OpenMS/KERNEL/StandardTypes.h>
+
+#include <string_view>
+#include <utility>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Memory-mappable index of a small molecule MS2 spectral library
+
+    Index of the library used by MetaboliteSpectralMatching (mzML, MSP or MGF,
+    e.g. from MassBank, GNPS or MoNA): the peaks of all library spectra, sorted
+    by precursor m/z, together with the metabolite annotations that are
+    reported for a match (identifiers, name, sum formula, InChI, SMILES and
+    adduct). Opening an index only maps the file into memory, after which all
+    spectra of a precursor m/z window can be retrieved by binary search (see
+    getSpectrumRange()) and scored without copying (see getPeaks()).
+
+    An index can be kept next to the library and reused as long as the library
+    did not change (see isUpToDate() and openOrCreate()). The library file is
+    identified by its size and modification time and, if those differ, by the
+    SHA1 checksum of its content.
+
+    Spectra with the same precursor m/z keep the order of the library, the
+    peaks of a spectrum are stored in the order of the library.
+
+    @note The file uses the byte order of the machine it was written on.
+
+    @ingroup Analysis_ID
+  */
+  class OPENMS_DLLAPI MetaboliteSpectralLibraryIndex
+  {
+public:
+
+    /// Index into the string pool
+    typedef Internal::MappedIndexFile::StringIndex StringIndex;
+
+    /// Fixed-size library spectrum record
+    struct SpectrumRecord
+    {
+      double precursor_mz;
+      UInt64 first_peak; ///< index of the first peak (see getPeaks())
+      UInt32 nr_peaks;
+      Int32 charge; ///< precursor charge (the sign gives the ionization mode)
+      UInt32 library_index; ///< position of the spectrum in the library
+      StringIndex primary_id; ///< meta value "Massbank_Accession_ID"
+      StringIndex secondary_id; ///< meta value "HMDB_ID"
+      StringIndex name; ///< meta value Constants::UserParam::MSM_METABOLITE_NAME
+      StringIndex sum_formula; ///< meta value Constants::UserParam::MSM_SUM_FORMULA
+      StringIndex inchi; ///< meta value Constants::UserParam::MSM_INCHI_STRING
+      StringIndex smiles; ///< meta value Constants::UserParam::MSM_SMILES_STRING
+      StringIndex adduct; ///< meta value Constants::UserParam::MSM_PRECURSOR_ADDUCT
+    };
+
+    /// Default constructor (no file opened)
+    MetaboliteSpectralLibraryIndex();
+
+    /// Destructor (unmaps the file)
+    ~MetaboliteSpectralLibraryIndex();
+
+    MetaboliteSpectralLibraryIndex(const MetaboliteSpectralLibraryIndex&) = delete;
+    MetaboliteSpectralLibraryIndex& operator=(const MetaboliteSpectralLibraryIndex&) = delete;
+
+    /**
+      @brief Reads a spectral library (mzML, MSP or MGF) and writes the index
+
+      @exception Exception::FileNotFound is thrown if @p library_file does not exist
+      @exception Exception::ParseError is thrown if @p library_file cannot be parsed
+      @exception Exception::MissingInformation is thrown if a library spectrum has no precursor
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+      @exception Exception::InvalidValue is thrown if the index exceeds the limits of the format (2^32 strings, spectra or peaks per spectrum)
+    */
+    static void create(const String& filename, const String& library_file);
+
+    /**
+      @brief Writes the index of a library that is already loaded
+
+      The index is not associated with a library file (isUpToDate() is false for any library file).
+
+      @exception Exception::MissingInformation is thrown if a library spectrum has no precursor
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+      @exception Exception::InvalidValue is thrown if the index exceeds the limits of the format
+    */
+    static void create(const String& filename, const PeakMap& library);
+
+    /**
+      @brief Whether @p filename is a valid index of @p library_file
+
+      Returns false if the file does not exist, is not a metabolite spectral
+      library index or was created from another version of the library.
+    */
+    static bool isUpToDate(const String& filename, const String& library_file);
+
+    /**
+      @brief Memory-maps an index
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::ParseError is thrown if the file is not a valid metabolite spectral library index
+    */
+    void open(const String& filename);
+
+    /// Opens @p filename, after (re)creating it if it is not up to date (see isUpToDate())
+    void openOrCreate(const String& filename, const String& library_file);
+
+    /// Whether a file is currently mapped
+    bool isOpen() const;
+
+    /// Unmaps the file
+    void close();
+
+    /** @name Zero-copy access to the mapped records
+    */
+    //@{
+    Size getNrSpectra() const;
+
+    /// Spectrum @p index (sorted by precursor m/z)
+    const SpectrumRecord& getSpectrum(Size index) const;
+
+    /// Returns string @p index of the string pool (valid as long as the file is mapped)
+    std::string_view getString(StringIndex index) const;
+
+    /// Peaks of spectrum @p index
+    SpectrumComparisonKernels::PeakArraysView getPeaks(Size index) const;
+
+    /// Half-open range [first, last) of all spectra with precursor m/z in [@p min_mz, @p max_mz]
+    std::pair<Size, Size> getSpectrumRange(double min_mz, double max_mz) const;
+    //@}
+
+protected:
+
+    /// Writes the index of @p library, recording @p library_file as its source (may be empty)
+    static void write_(const String& filename, const PeakMap& library, const String& library_file);
+
+    Internal::MappedIndexFile file_;
+
+    const SpectrumRecord* spectra_ = nullptr;
+    const double* peak_mz_ = nullptr;
+    const Peak1D::IntensityType* peak_intensity_ = nullptr;
+
+    Size nr_spectra_ = 0;
+    Size nr_peaks_ = 0;
+  };
+
+}
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
 #include <OpenMS/KERNEL/MassTrace.h>
 #include <OpenMS/KERNEL/Feature.h>
 #include <OpenMS/KERNEL/FeatureMap.h>
@@ -22,6 +23,8 @@
 
 namespace OpenMS
 {
+  class FragmentIndex;
+  class MetaboliteSpectralLibraryIndex;
 
   struct OPENMS_DLLAPI PrecursorMassComparator
   {
@@ -151,8 +154,25 @@ namespace OpenMS
       std::vector<PeptideHit::PeakAnnotation>& annotations,
       double mz_lower_bound = 0.0);
 
-    /// main method of MetaboliteSpectralMatching
-    void run(PeakMap &, PeakMap &, MzTab &, String &);
+    /// main method of MetaboliteSpectralMatching (indexes the library @p spec_db in a temporary file, see below)
+    void run(PeakMap & msexp, PeakMap & spec_db, MzTab & mztab_out, String & out_spectra);
+
+    /**
+      @brief Searches the MS2 spectra @p msexp against an indexed spectral library
+
+      Query spectra are filtered (and merged, see parameter "merge_spectra")
+      and then searched in parallel. For every precursor, the library
+      spectra within the precursor mass tolerance and with the right
+      ionization mode are scored by their hyperscore; the best (or top three)
+      matches are reported. With parameter "analog_search", hits of library
+      spectra with a shifted precursor m/z are reported in addition.
+
+      @param msexp The MS2 spectra (filtered and merged in place)
+      @param spec_db The spectral library
+      @param mztab_out The matches (small molecule section)
+      @param out_spectra If not empty, the filtered and merged spectra are stored to this mzML file
+    */
+    void run(PeakMap & msexp, const MetaboliteSpectralLibraryIndex & spec_db, MzTab & mztab_out, String & out_spectra);
 
   protected:
     void updateMembers_() override;
@@ -167,6 +187,31 @@ namespace OpenMS
       std::vector<PeptideHit::PeakAnnotation>* annotations = 0,
       double mz_lower_bound = 0.0);
 
+    /**
+      @brief Hyperscore of a query spectrum and a library spectrum of an index
+
+      Same result as computeHyperScore_() without annotations and lower bound.
+      Library peaks that do not match directly are matched after shifting them
+      by @p mass_shift (if not zero). @p matched_db_intensity is scratch space
+      (one entry per query peak, all negative between calls).
+    */
+    static double computeHyperScore_(
+      double fragment_mass_error,
+      bool fragment_mass_tolerance_unit_ppm,
+      const MSSpectrum& exp_spectrum,
+      const SpectrumComparisonKernels::PeakArraysView& db_peaks,
+      double mass_shift,
+      std::vector<double>& matched_db_intensity);
+
+    /**
+      @brief Builds the prefilter of the analog search
+
+      Fragment index with one entry per library spectrum (same order as in
+      @p spec_db), which contains its fragment m/z values and its neutral
+      losses (fragment m/z minus precursor m/z, i.e. mostly negative values).
+    */
+    static void buildAnalogIndex_(const MetaboliteSpectralLibraryIndex& spec_db, FragmentIndex& analog_index);
+
   private:
     /// private member functions
     void exportMzTab_(const std::vector<SpectralMatch>&, MzTab&);
@@ -179,6 +224,10 @@ namespace OpenMS
     String report_mode_;
 
     bool merge_spectra_;
+
+    bool analog_search_;
+    double analog_max_mass_shift_;
+    Size analog_max_candidates_;
   };
 
 }
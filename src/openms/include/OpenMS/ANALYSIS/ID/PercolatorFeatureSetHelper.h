@@ -24,6 +24,8 @@
 
 namespace OpenMS
 {
+    class PSMTable;
+
     /**
         @brief Percolator feature set and integration helper
 
@@ -135,6 +137,15 @@ namespace OpenMS
          */
         static void checkExtraFeatures(const std::vector<PeptideHit> &psms, StringList& extra_features);
 
+        /**
+          @brief checkExtraFeatures
+          @param table the PSM table to be checked (with the requested features loaded as meta columns)
+          @param extra_features the list of requested extra features
+
+          checks and removes requested extra Percolator features that are not available for all rows of @p table
+         */
+        static void checkExtraFeatures(const PSMTable& table, StringList& extra_features);
+
         /**
          * @brief addMSFraggerFeatures
          * @param extra_features register of added features
@@ -9,7 +9,10 @@
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
 #include <OpenMS/CHEMISTRY/ModifiedPeptideGenerator.h>
+#include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/DATASTRUCTURES/StringView.h>
 
@@ -67,6 +70,21 @@ class OPENMS_DLLAPI SimpleSearchEngineAlgorithm :
     /// @brief filter, deisotope, decharge spectra
     static void preprocessSpectra_(PeakMap& exp, double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm);
 
+    /// @brief create the fragment index of all (modified) database peptides, or load it from fragment_index:file if that is up to date
+    void buildFragmentIndex_(const std::vector<FASTAFile::FASTAEntry>& fasta_db,
+      const String& database_name,
+      const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+      const ModifiedPeptideGenerator::MapToResidueType& variable_modifications,
+      FragmentIndex& fragment_index) const;
+
+    /// @brief retrieve candidates of each spectrum from the fragment index and rescore them with the HyperScore
+    void searchFragmentIndex_(const PeakMap& spectra,
+      const FragmentIndex& fragment_index,
+      const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+      const ModifiedPeptideGenerator::MapToResidueType& variable_modifications,
+      const TheoreticalSpectrumGenerator& spectrum_generator,
+      std::vector<std::vector<AnnotatedHit_> >& annotated_hits) const;
+
     /// @brief filter and annotate search results
     /// most of the parameters are used to properly add meta data to the id objects
     void postProcessHits_(const PeakMap& exp, 
@@ -120,6 +138,13 @@ class OPENMS_DLLAPI SimpleSearchEngineAlgorithm :
     String peptide_motif_;
 
     Size report_top_hits_;
+
+    String search_mode_;
+    Size fragment_index_candidates_;
+    Size fragment_index_bucket_size_;
+    String fragment_index_file_;
+
+    String digest_store_file_;
 };
 
 } // namespace
@@ -0,0 +1,189 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/FORMAT/MappedIndexFile.h>
+#include <OpenMS/METADATA/PeptideHit.h>
+
+#include <string_view>
+#include <utility>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Memory-mappable index of a searchable spectral library (MSP format)
+
+    Searching a spectral library used to start with parsing the whole MSP
+    file, filtering its entries by modifications and preprocessing every
+    library spectrum. A spectral library index holds the result once: the
+    preprocessed (square-root transformed) peaks of all library spectra that
+    pass the modification filter, sorted by precursor m/z, together with their
+    binned and normalized form (see SpectraSTSimilarityScore::transform()) and
+    the peptide and peak annotations of the library. Opening an index only
+    maps the file into memory, after which all spectra of a precursor m/z
+    window can be retrieved by binary search (see getSpectrumRange()) and
+    scored without copying (see getPeaks() and getBins()).
+
+    The content of an index depends on the library file and on the
+    preprocessing settings (see Parameters). Both are recorded in the file,
+    such that an index can be kept next to the library and reused as long as
+    neither changed (see isUpToDate() and openOrCreate()). The library file is
+    identified by its size and modification time and, if those differ, by the
+    SHA1 checksum of its content.
+
+    Spectra with the same precursor m/z keep the order of the library file.
+
+    @note The file uses the byte order of the machine it was written on.
+
+    @ingroup Analysis_ID
+  */
+  class OPENMS_DLLAPI SpectralLibraryIndex
+  {
+public:
+
+    /// Index into the string pool
+    typedef Internal::MappedIndexFile::StringIndex StringIndex;
+
+    /// Preprocessing settings (everything the content of an index depends on, except for the library)
+    struct OPENMS_DLLAPI Parameters
+    {
+      /// Library peaks with intensities not above this threshold are removed
+      double remove_peaks_below_threshold = 2.01;
+      /// Library spectra with residues that could carry one of these modifications, but carry another one, are skipped
+      StringList fixed_modifications;
+      /// Library spectra with residues modified differently from these modifications are skipped
+      StringList variable_modifications;
+
+      /// Canonical description of the settings (stored in the file)
+      String getFingerprint() const;
+    };
+
+    /// Fixed-size library spectrum record
+    struct SpectrumRecord
+    {
+      double precursor_mz;
+      double rt;
+      UInt64 first_peak; ///< index of the first peak (see getPeaks())
+      UInt64 first_bin; ///< index of the first non-zero bin (see getBins())
+      UInt64 first_annotation; ///< index of the first peak annotation (see getPeptideHit())
+      UInt32 nr_peaks;
+      UInt32 nr_bins;
+      UInt32 nr_annotations;
+      Int32 charge;
+      StringIndex sequence; ///< modified sequence (AASequence::toString())
+      UInt32 library_index; ///< position of the spectrum in the library file
+    };
+
+    /// Fixed-size peak annotation record (see PeptideHit::PeakAnnotation)
+    struct AnnotationRecord
+    {
+      double mz;
+      double intensity;
+      Int32 charge;
+      StringIndex annotation;
+    };
+
+    /// Default constructor (no file opened)
+    SpectralLibraryIndex();
+
+    /// Destructor (unmaps the file)
+    ~SpectralLibraryIndex();
+
+    SpectralLibraryIndex(const SpectralLibraryIndex&) = delete;
+    SpectralLibraryIndex& operator=(const SpectralLibraryIndex&) = delete;
+
+    /**
+      @brief Reads and preprocesses a spectral library and writes the index
+
+      @param filename The output file
+      @param library_file The spectral library (MSP format)
+      @param params The preprocessing settings
+
+      @exception Exception::FileNotFound is thrown if @p library_file does not exist
+      @exception Exception::ParseError is thrown if @p library_file cannot be parsed
+      @exception Exception::IllegalArgument is thrown if a library spectrum has no peak annotations
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+      @exception Exception::InvalidValue is thrown if the index exceeds the limits of the format (2^32 strings, spectra or peaks per spectrum)
+    */
+    static void create(const String& filename, const String& library_file, const Parameters& params);
+
+    /**
+      @brief Whether @p filename is a valid index of @p library_file created with @p params
+
+      Returns false if the file does not exist, is not a spectral library index,
+      was created with other settings or from another version of the library.
+    */
+    static bool isUpToDate(const String& filename, const String& library_file, const Parameters& params);
+
+    /**
+      @brief Memory-maps an index
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::ParseError is thrown if the file is not a valid spectral library index
+    */
+    void open(const String& filename);
+
+    /// Opens @p filename, after (re)creating it if it is not up to date (see isUpToDate())
+    void openOrCreate(const String& filename, const String& library_file, const Parameters& params);
+
+    /// Whether a file is currently mapped
+    bool isOpen() const;
+
+    /// Unmaps the file
+    void close();
+
+    /** @name Zero-copy access to the mapped records
+    */
+    //@{
+    Size getNrSpectra() const;
+
+    /// Spectrum @p index (sorted by precursor m/z)
+    const SpectrumRecord& getSpectrum(Size index) const;
+
+    /// Returns string @p index of the string pool (valid as long as the file is mapped)
+    std::string_view getString(StringIndex index) const;
+
+    /// Modified sequence of spectrum @p index
+    std::string_view getSequence(Size index) const;
+
+    /// Preprocessed peaks of spectrum @p index (in the order of the library file)
+    SpectrumComparisonKernels::PeakArraysView getPeaks(Size index) const;
+
+    /// Non-zero bins of the binned and normalized spectrum @p index (see SpectraSTSimilarityScore::transform())
+    SpectrumComparisonKernels::BinsView getBins(Size index) const;
+
+    /// Half-open range [first, last) of all spectra with precursor m/z in [@p min_mz, @p max_mz]
+    std::pair<Size, Size> getSpectrumRange(double min_mz, double max_mz) const;
+    //@}
+
+    /// Library annotation of spectrum @p index: sequence, charge and peak annotations (as read from the library file)
+    PeptideHit getPeptideHit(Size index) const;
+
+protected:
+
+    Internal::MappedIndexFile file_;
+
+    const SpectrumRecord* spectra_ = nullptr;
+    const double* peak_mz_ = nullptr;
+    const Peak1D::IntensityType* peak_intensity_ = nullptr;
+    const UInt32* bin_index_ = nullptr;
+    const float* bin_value_ = nullptr;
+    const AnnotationRecord* annotations_ = nullptr;
+
+    Size nr_spectra_ = 0;
+    Size nr_peaks_ = 0;
+    Size nr_bins_ = 0;
+    Size nr_annotations_ = 0;
+  };
+
+}
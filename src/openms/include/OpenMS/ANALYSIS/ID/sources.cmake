@@ -18,9 +18,11 @@ ConsensusIDAlgorithmRanks.h
 ConsensusIDAlgorithmSimilarity.h
 ConsensusIDAlgorithmWorst.h
 ConsensusMapMergerAlgorithm.h
+DigestStore.h
 FalseDiscoveryRate.h
 FIAMSDataProcessor.h
 FIAMSScheduler.h
+FragmentIndex.h
 HyperScore.h
 IDBoostGraph.h
 IDDecoyProbability.h
@@ -32,6 +34,7 @@ IDScoreGetterSetter.h
 IDScoreSwitcherAlgorithm.h
 IonIdentityMolecularNetworking.h
 MessagePasserFactory.h
+MetaboliteSpectralLibraryIndex.h
 MetaboliteSpectralMatching.h
 MorpheusScore.h
 NeighborSeq.h
@@ -43,6 +46,7 @@ PScore.h
 SimpleSearchEngineAlgorithm.h
 SiriusExportAlgorithm.h
 SiriusMSConverter.h
+SpectralLibraryIndex.h
 )
 
 ### add path to the filenames
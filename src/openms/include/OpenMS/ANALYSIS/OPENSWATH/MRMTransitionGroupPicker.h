@@ -25,8 +25,13 @@
 #include <OpenMS/OPENSWATHALGO/ALGO/Scoring.h>
 #include <OpenMS/OPENSWATHALGO/ALGO/StatsHelpers.h>
 
+#include <exception>
 #include <numeric>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //#define DEBUG_TRANSITIONGROUPPICKER
 
 namespace OpenMS
@@ -49,6 +54,12 @@ namespace OpenMS
     Step 2 is performed by finding the largest peak overall and use this to
     create a feature, propagating this through all chromatograms.
 
+    When many transition groups are processed, a Workspace should be passed
+    to pickTransitionGroup() so that the picked, smoothed and resampled
+    chromatograms reuse their memory from one group to the next.
+    pickTransitionGroups() processes a whole batch of transition groups in
+    parallel, using one picker and one workspace per thread.
+
   */
   class OPENMS_DLLAPI MRMTransitionGroupPicker :
     public DefaultParamHandler
@@ -64,6 +75,27 @@ public:
     ~MRMTransitionGroupPicker() override;
     //@}
 
+    /**
+      @brief Buffers that are reused across calls of pickTransitionGroup()
+
+      Holds the picked and smoothed chromatograms, the candidate features and
+      the temporary containers used for resampling and integration. Their
+      memory is kept between transition groups, so after the first few groups
+      picking allocates (almost) nothing. The content is only meaningful
+      during a call of pickTransitionGroup(). A workspace must not be used by
+      two threads at the same time.
+    */
+    struct Workspace
+    {
+      std::vector<MSChromatogram> picked_chroms;
+      std::vector<MSChromatogram> smoothed_chroms;
+      std::vector<MRMFeature> features;
+      MSChromatogram master_peak_container;
+      MSChromatogram used_chromatogram;
+      std::vector<double> left_edges;
+      std::vector<double> right_edges;
+    };
+
     /**
       @brief Pick a group of chromatograms belonging to the same peptide
 
@@ -85,33 +117,59 @@ public:
     */
     template <typename SpectrumT, typename TransitionT>
     void pickTransitionGroup(MRMTransitionGroup<SpectrumT, TransitionT>& transition_group)
+    {
+      Workspace workspace;
+      pickTransitionGroup(transition_group, workspace);
+    }
+
+    /**
+      @brief Pick a group of chromatograms, reusing the buffers of @p workspace
+
+      Identical to pickTransitionGroup(MRMTransitionGroup&), but all temporary
+      chromatograms are kept in @p workspace. Passing the same workspace for
+      consecutive transition groups avoids re-allocating them for every group.
+    */
+    template <typename SpectrumT, typename TransitionT>
+    void pickTransitionGroup(MRMTransitionGroup<SpectrumT, TransitionT>& transition_group, Workspace& workspace)
     {
       OPENMS_PRECONDITION(transition_group.isInternallyConsistent(), "Consistent state required")
       OPENMS_PRECONDITION(transition_group.chromatogramIdsMatch(), "Chromatogram native IDs need to match keys in transition group")
 
-      std::vector<MSChromatogram > picked_chroms;
-      std::vector<MSChromatogram > smoothed_chroms;
+      std::vector<MSChromatogram >& picked_chroms = workspace.picked_chroms;
+      std::vector<MSChromatogram >& smoothed_chroms = workspace.smoothed_chroms;
+
+      // Count the chromatograms to pick and size the buffers accordingly;
+      // existing elements keep their memory
+      Size nr_picked = 0;
+      for (Size k = 0; k < transition_group.getChromatograms().size(); k++)
+      {
+        if (isPickedChromatogram_(transition_group, transition_group.getChromatograms()[k].getNativeID())) nr_picked++;
+      }
+      if (use_precursors_) nr_picked += transition_group.getPrecursorChromatograms().size();
+      picked_chroms.resize(nr_picked);
+      smoothed_chroms.resize(nr_picked);
 
       // Pick fragment ion chromatograms
+      Size idx = 0;
       for (Size k = 0; k < transition_group.getChromatograms().size(); k++)
       {
         MSChromatogram& chromatogram = transition_group.getChromatograms()[k];
-        String native_id = chromatogram.getNativeID();
+        const String& native_id = chromatogram.getNativeID();
 
         // only pick detecting transitions (skip all others)
-        if (transition_group.getTransitions().size() > 0 && 
-            transition_group.hasTransition(native_id)  && 
-            !transition_group.getTransition(native_id).isDetectingTransition() )
+        if (!isPickedChromatogram_(transition_group, native_id))
         {
           continue;
         }
 
-        MSChromatogram picked_chrom, smoothed_chrom;
+        MSChromatogram& picked_chrom = picked_chroms[idx];
+        MSChromatogram& smoothed_chrom = smoothed_chroms[idx];
+        picked_chrom.clear(true);
+        smoothed_chrom.clear(true);
         smoothed_chrom.setNativeID(native_id);
         picker_.pickChromatogram(chromatogram, picked_chrom, smoothed_chrom);
         picked_chrom.sortByIntensity();
-        picked_chroms.push_back(std::move(picked_chrom));
-        smoothed_chroms.push_back(std::move(smoothed_chrom));
+        idx++;
       }
 
       // Pick precursor chromatograms
@@ -119,13 +177,15 @@ public:
       {
         for (Size k = 0; k < transition_group.getPrecursorChromatograms().size(); k++)
         {
-          SpectrumT picked_chrom, smoothed_chrom;
           SpectrumT& chromatogram = transition_group.getPrecursorChromatograms()[k];
 
+          MSChromatogram& picked_chrom = picked_chroms[idx];
+          MSChromatogram& smoothed_chrom = smoothed_chroms[idx];
+          picked_chrom.clear(true);
+          smoothed_chrom.clear(true);
           picker_.pickChromatogram(chromatogram, picked_chrom, smoothed_chrom);
           picked_chrom.sortByIntensity();
-          picked_chroms.push_back(picked_chrom);
-          smoothed_chroms.push_back(smoothed_chrom);
+          idx++;
         }
       }
 
@@ -134,7 +194,8 @@ public:
       // a feature. Whenever we run out of peaks, we will get -1 back as index
       // and terminate.
       int chr_idx, peak_idx, cnt = 0;
-      std::vector<MRMFeature> features;
+      std::vector<MRMFeature>& features = workspace.features;
+      features.clear();
       while (true)
       {
         chr_idx = -1; peak_idx = -1;
@@ -155,7 +216,7 @@ public:
         }
 
         // Compute a feature from the individual chromatograms and add non-zero features
-        MRMFeature mrm_feature = createMRMFeature(transition_group, picked_chroms, smoothed_chroms, chr_idx, peak_idx);
+        MRMFeature mrm_feature = createMRMFeature(transition_group, picked_chroms, smoothed_chroms, chr_idx, peak_idx, workspace);
         double total_xic = 0;
         double intensity = mrm_feature.getIntensity();
         if (intensity > 0)
@@ -192,7 +253,59 @@ public:
           transition_group.addFeature(mrm_feature);
         }
       }
+      features.clear();
+    }
+
+    /**
+      @brief Pick a batch of transition groups in parallel
+
+      Each transition group is processed as in pickTransitionGroup(). Every
+      thread uses its own copy of this picker (with the same parameters) and
+      its own Workspace; the groups are distributed dynamically over the
+      threads since their sizes can differ considerably.
+
+      @param transition_groups The transition groups to pick (the features are added to each group)
+    */
+    template <typename SpectrumT, typename TransitionT>
+    void pickTransitionGroups(std::vector<MRMTransitionGroup<SpectrumT, TransitionT>* >& transition_groups)
+    {
+      std::exception_ptr error;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+      {
+        MRMTransitionGroupPicker picker;
+        picker.setParameters(param_);
+        Workspace workspace;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+        for (SignedSize i = 0; i < (SignedSize)transition_groups.size(); ++i)
+        {
+          try
+          {
+            picker.pickTransitionGroup(*transition_groups[i], workspace);
+          }
+          catch (...)
+          {
+#ifdef _OPENMP
+#pragma omp critical (MRMTransitionGroupPicker_pickTransitionGroups)
+#endif
+            if (!error) error = std::current_exception();
+          }
+        }
+      }
+      if (error) std::rethrow_exception(error);
+    }
 
+    /// Pick a batch of transition groups in parallel (see above)
+    template <typename SpectrumT, typename TransitionT>
+    void pickTransitionGroups(std::vector<MRMTransitionGroup<SpectrumT, TransitionT> >& transition_groups)
+    {
+      std::vector<MRMTransitionGroup<SpectrumT, TransitionT>* > group_ptrs;
+      group_ptrs.reserve(transition_groups.size());
+      for (auto& tg : transition_groups) group_ptrs.push_back(&tg);
+      pickTransitionGroups(group_ptrs);
     }
 
     /// Create feature from a vector of chromatograms and a specified peak
@@ -202,6 +315,19 @@ public:
                                 const std::vector<SpectrumT>& smoothed_chroms,
                                 const int chr_idx,
                                 const int peak_idx)
+    {
+      Workspace workspace;
+      return createMRMFeature(transition_group, picked_chroms, smoothed_chroms, chr_idx, peak_idx, workspace);
+    }
+
+    /// Create feature from a vector of chromatograms and a specified peak, using the temporary containers of @p workspace
+    template <typename SpectrumT, typename TransitionT>
+    MRMFeature createMRMFeature(const MRMTransitionGroup<SpectrumT, TransitionT>& transition_group,
+                                std::vector<SpectrumT>& picked_chroms,
+                                const std::vector<SpectrumT>& smoothed_chroms,
+                                const int chr_idx,
+                                const int peak_idx,
+                                Workspace& workspace)
     {
       OPENMS_PRECONDITION(transition_group.isInternallyConsistent(), "Consistent state required")
       OPENMS_PRECONDITION(transition_group.chromatogramIdsMatch(), "Chromatogram native IDs need to match keys in transition group")
@@ -226,8 +352,10 @@ public:
         }
       }
 
-      std::vector< double > left_edges;
-      std::vector< double > right_edges;
+      std::vector< double >& left_edges = workspace.left_edges;
+      std::vector< double >& right_edges = workspace.right_edges;
+      left_edges.clear();
+      right_edges.clear();
       double min_left = best_left;
       double max_right = best_right;
       if (use_consensus_)
@@ -271,7 +399,8 @@ public:
       // empty master_peak_container with the same RT (m/z) values as the
       // reference chromatogram. We use the overall minimal left boundary and
       // maximal right boundary to prepare the container.
-      SpectrumT master_peak_container;
+      SpectrumT& master_peak_container = workspace.master_peak_container;
+      master_peak_container.clear(true);
       const SpectrumT& ref_chromatogram = selectChromHelper_(transition_group, picked_chroms[chr_idx].getNativeID());
       prepareMasterContainer_(ref_chromatogram, master_peak_container, min_left, max_right);
 
@@ -283,7 +412,7 @@ public:
                                 best_left, best_right, use_consensus_,
                                 total_intensity, total_xic, total_mi, total_peak_apices,
                                 master_peak_container, left_edges, right_edges,
-                                chr_idx, peak_idx);
+                                chr_idx, peak_idx, &workspace.used_chromatogram);
 
       // Also pick the precursor chromatogram(s); note total_xic is not
       // extracted here, only for fragment traces
@@ -291,7 +420,7 @@ public:
                                 picked_chroms, mrmFeature, smoothed_chroms,
                                 best_left, best_right, use_consensus_,
                                 total_intensity, master_peak_container, left_edges, right_edges,
-                                chr_idx, peak_idx);
+                                chr_idx, peak_idx, &workspace.used_chromatogram);
 
       mrmFeature.setRT(peak_apex);
       mrmFeature.setIntensity(total_intensity);
@@ -377,8 +506,12 @@ public:
                                     const std::vector< double > & left_edges,
                                     const std::vector< double > & right_edges,
                                     const int chr_idx,
-                                    const int peak_idx)
+                                    const int peak_idx,
+                                    SpectrumT* used_chromatogram_buffer = nullptr)
     {
+      // resampled chromatogram; reuses the memory of @p used_chromatogram_buffer if given
+      SpectrumT local_used_chromatogram;
+      SpectrumT& used_chromatogram = used_chromatogram_buffer ? *used_chromatogram_buffer : local_used_chromatogram;
       for (Size k = 0; k < transition_group.getTransitions().size(); k++)
       {
 
@@ -452,11 +585,10 @@ public:
           }
         }
 
-        SpectrumT used_chromatogram;
         // resample the current chromatogram
         if (peak_integration_ == "original")
         {
-          used_chromatogram = resampleChromatogram_(chromatogram, master_peak_container, local_left, local_right);
+          resampleChromatogram_(chromatogram, master_peak_container, local_left, local_right, used_chromatogram);
         }
         else if (peak_integration_ == "smoothed")
         {
@@ -465,7 +597,7 @@ public:
             throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
                                              "Tried to calculate peak area and height without any smoothed chromatograms");
           }
-          used_chromatogram = resampleChromatogram_(smoothed_chroms[k], master_peak_container, local_left, local_right);
+          resampleChromatogram_(smoothed_chroms[k], master_peak_container, local_left, local_right, used_chromatogram);
         }
         else
         {
@@ -577,8 +709,12 @@ public:
                                     const std::vector< double > & left_edges,
                                     const std::vector< double > & right_edges,
                                     const int chr_idx,
-                                    const int peak_idx)
+                                    const int peak_idx,
+                                    SpectrumT* used_chromatogram_buffer = nullptr)
     {
+      // resampled chromatogram; reuses the memory of @p used_chromatogram_buffer if given
+      SpectrumT local_used_chromatogram;
+      SpectrumT& used_chromatogram = used_chromatogram_buffer ? *used_chromatogram_buffer : local_used_chromatogram;
       for (Size k = 0; k < transition_group.getPrecursorChromatograms().size(); k++)
       {
         const SpectrumT& chromatogram = transition_group.getPrecursorChromatograms()[k];
@@ -595,11 +731,10 @@ public:
           local_right = right_edges[prec_idx];
         }
 
-        SpectrumT used_chromatogram;
         // resample the current chromatogram
         if (peak_integration_ == "original")
         {
-          used_chromatogram = resampleChromatogram_(chromatogram, master_peak_container, local_left, local_right);
+          resampleChromatogram_(chromatogram, master_peak_container, local_left, local_right, used_chromatogram);
           // const SpectrumT& used_chromatogram = chromatogram; // instead of resampling
         }
         else if (peak_integration_ == "smoothed" && smoothed_chroms.size() <= prec_idx)
@@ -609,7 +744,7 @@ public:
         }
         else if (peak_integration_ == "smoothed")
         {
-          used_chromatogram = resampleChromatogram_(smoothed_chroms[prec_idx], master_peak_container, local_left, local_right);
+          resampleChromatogram_(smoothed_chroms[prec_idx], master_peak_container, local_left, local_right, used_chromatogram);
         }
         else
         {
@@ -757,6 +892,15 @@ protected:
     /// Assignment operator is protected for algorithm
     MRMTransitionGroupPicker& operator=(const MRMTransitionGroupPicker& rhs);
 
+    /// Whether the fragment ion chromatogram @p native_id is used for peak picking (i.e. not a non-detecting transition)
+    template <typename SpectrumT, typename TransitionT>
+    bool isPickedChromatogram_(MRMTransitionGroup<SpectrumT, TransitionT>& transition_group, const String& native_id) const
+    {
+      return !(transition_group.getTransitions().size() > 0 &&
+               transition_group.hasTransition(native_id) &&
+               !transition_group.getTransition(native_id).isDetectingTransition());
+    }
+
     /**
       @brief Select matching precursor or fragment ion chromatogram
     */
@@ -1091,6 +1235,17 @@ protected:
     template <typename SpectrumT>
     SpectrumT resampleChromatogram_(const SpectrumT& chromatogram,
                                     const SpectrumT& master_peak_container, double left_boundary, double right_boundary)
+    {
+      SpectrumT resampled_peak_container;
+      resampleChromatogram_(chromatogram, master_peak_container, left_boundary, right_boundary, resampled_peak_container);
+      return resampled_peak_container;
+    }
+
+    /// Resample a container at the positions of the master peak container, writing into (and reusing the memory of) @p resampled_peak_container
+    template <typename SpectrumT>
+    void resampleChromatogram_(const SpectrumT& chromatogram,
+                               const SpectrumT& master_peak_container, double left_boundary, double right_boundary,
+                               SpectrumT& resampled_peak_container)
     {
       // get the start / end point of this chromatogram => then add one more
       // point beyond the two boundaries to make the resampling accurate also
@@ -1103,11 +1258,9 @@ protected:
       while (end != chromatogram.end() && end->getMZ() < right_boundary) {end++;}
       if (end != chromatogram.end()) {end++;}
 
-      SpectrumT resampled_peak_container = master_peak_container; // copy the master container, which contains the RT values
+      resampled_peak_container = master_peak_container; // copy the master container, which contains the RT values
       LinearResamplerAlign lresampler;
       lresampler.raster(begin, end, resampled_peak_container.begin(), resampled_peak_container.end());
-
-      return resampled_peak_container;
     }
 
     //@}
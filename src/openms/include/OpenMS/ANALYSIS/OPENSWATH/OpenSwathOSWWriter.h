@@ -16,6 +16,7 @@
 #include <OpenMS/KERNEL/FeatureMap.h>
 
 #include <fstream>
+#include <memory>
 
 namespace OpenMS
 {
@@ -85,6 +86,18 @@ namespace OpenMS
         <tr> <td BGCOLOR="#EBEBEB">VAR_...</td> <td>REAL</td> <td>Fragment ion score used in pyProphet  </td> </tr>
       </table>
 
+    Two ways of writing are supported:
+
+    - prepareLine() / writeLines(): each feature is rendered into SQL INSERT
+      statements which the caller collects and flushes in a single transaction.
+    - bulk writing (enableBulkWrite()): features are converted into typed rows
+      by enqueueFeatures() (thread-safe, may be called from the scoring threads)
+      and handed to a dedicated writer thread, which inserts them through
+      prepared statements with bound parameters in large transactions. Indices
+      are only created once all data has been loaded (finishBulkWrite()). The
+      number of rows waiting in the queue is bounded, so memory does not grow
+      with the size of the run.
+
    */
   class OPENMS_DLLAPI OpenSwathOSWWriter
   {
@@ -94,6 +107,17 @@ namespace OpenMS
     bool doWrite_;
     bool enable_uis_scoring_;
 
+    /// Rows per transaction for bulk writing (0 = bulk writing disabled)
+    Size bulk_rows_per_transaction_ = 0;
+    /// Maximal number of queued rows before enqueueFeatures() blocks
+    Size bulk_max_queued_rows_ = 0;
+    /// Whether SQLite waits for the data to reach the disk during bulk writing
+    bool bulk_synchronous_ = true;
+
+    /// Queue and writer thread used for bulk writing (shared between copies)
+    struct BulkWriter_;
+    std::shared_ptr<BulkWriter_> bulk_writer_;
+
   public:
 
     OpenSwathOSWWriter(const String& output_filename,
@@ -103,9 +127,30 @@ namespace OpenMS
 
     bool isActive() const;
 
+    /**
+     * @brief Enables bulk writing through a dedicated writer thread
+     *
+     * Needs to be called before writeHeader(), which then starts the writer
+     * thread. Features are subsequently passed to enqueueFeatures() instead of
+     * prepareLine() / writeLines().
+     *
+     * @param rows_per_transaction Number of inserted rows after which the current transaction is committed
+     * @param max_queued_rows Number of rows which may wait for the writer thread before enqueueFeatures() blocks
+     * @param synchronous If false, SQLite neither waits for the data to reach the disk nor keeps its journal
+     * on disk (PRAGMA synchronous = OFF, journal_mode = MEMORY). This is faster, but a crash or power failure
+     * during the run can leave a corrupt file.
+     *
+     */
+    void enableBulkWrite(Size rows_per_transaction = 100000, Size max_queued_rows = 1000000, bool synchronous = true);
+
+    /// Whether the writer thread is running (i.e. enqueueFeatures() should be used)
+    bool isBulkWriting() const;
+
     /**
      * @brief Initializes file by generating SQLite tables
      *
+     * If bulk writing is enabled, this also starts the writer thread.
+     *
      */
     void writeHeader();
 
@@ -168,6 +213,40 @@ namespace OpenMS
      */
     void writeLines(const std::vector<String>& to_osw_output);
 
+    /**
+     * @brief Hand features to the writer thread (bulk writing only)
+     *
+     * Converts all features of @p output into typed rows for the FEATURE,
+     * FEATURE_MS1, FEATURE_MS2, FEATURE_PRECURSOR and FEATURE_TRANSITION tables
+     * and appends them to the queue of the writer thread. The same data as with
+     * prepareLine() is written. Blocks while the queue is full.
+     *
+     * If the writer thread has failed, the features are dropped and false is
+     * returned; the error itself is rethrown by finishBulkWrite(). This allows
+     * calling the function inside an OpenMP parallel region, which exceptions
+     * must not leave.
+     *
+     * @param output The feature map containing all features (each feature will generate one entry in the output)
+     * @param id The transition group identifier (peptide/metabolite id)
+     *
+     * @returns Whether the features were queued
+     *
+     * @note Thread-safe, no critical section required.
+     *
+     * @exception Exception::IllegalArgument is thrown if bulk writing was not started or already finished
+     */
+    bool enqueueFeatures(const FeatureMap& output, const String& id);
+
+    /**
+     * @brief Flushes all queued rows, stops the writer thread and creates the table indices
+     *
+     * Does nothing if bulk writing is not active. Call it after the parallel
+     * region in which the features were enqueued.
+     *
+     * @exception Exception::IllegalArgument is thrown if writing to the database failed
+     */
+    void finishBulkWrite();
+
   };
 
 }
@@ -69,6 +69,10 @@ public:
      * the theoretically expected drift time. The resulting linear
      * transformation is stored using a TransformationDescription object.
      *
+     * The m/z windows are integrated in @p swath_maps as given, i.e. after
+     * correctMZ() in the m/z-corrected maps. The calibration points can
+     * therefore not be collected in the same pass as those of correctMZ().
+     *
      * @param transition_group_map A MRMFeatureFinderScoring result map
      * @param swath_maps The raw swath maps from the current run
      * @param targeted_exp The corresponding spectral library (required for extraction coordinates)
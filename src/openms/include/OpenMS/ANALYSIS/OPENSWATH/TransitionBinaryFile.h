@@ -0,0 +1,213 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>
+
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/FORMAT/MappedIndexFile.h>
+
+#include <string_view>
+#include <utility>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Compact binary assay library for fast OpenSwath startup
+
+    Stores an OpenSwath::LightTargetedExperiment in a flat, memory-mappable
+    file. All strings (transition, compound and protein identifiers, sequences
+    etc.) are interned into a single string pool and referenced by index;
+    transitions, compounds and proteins are stored as fixed-size records. In
+    addition, the file holds a permutation of all transitions sorted by
+    precursor m/z (ties broken by product m/z), such that the transitions of a
+    SWATH window can be found by binary search without touching the rest of
+    the library.
+
+    Loading does not parse anything: open() maps the file into memory and the
+    records are accessed in place. toLightTargetedExperiment() materializes the
+    data structure used by the OpenSwath workflow, which is several orders of
+    magnitude faster than reading the corresponding PQP file through
+    TransitionPQPFile.
+
+    The file remembers the file it was generated from (usually a PQP file) and
+    a fingerprint of the settings used to read it, which allows to use it as a
+    cache next to the original library (see isUpToDate()).
+
+    The transition order of the original library is preserved.
+
+    @note The file uses the byte order of the machine it was written on and is
+    not meant to be exchanged between machines of different endianness.
+
+    @ingroup OpenSwath
+  */
+  class OPENMS_DLLAPI TransitionBinaryFile
+  {
+public:
+
+    /// Index into the string pool
+    typedef Internal::MappedIndexFile::StringIndex StringIndex;
+
+    /// Fixed-size transition record
+    struct TransitionRecord
+    {
+      double library_intensity;
+      double product_mz;
+      double precursor_mz;
+      double precursor_im;
+      StringIndex transition_name;
+      StringIndex peptide_ref;
+      Int32 fragment_charge;
+      UInt32 flags; ///< combination of the FLAG_* values
+    };
+
+    /// Fixed-size compound (peptide or metabolite) record
+    struct CompoundRecord
+    {
+      double rt;
+      double drift_time;
+      Int32 charge;
+      StringIndex id;
+      StringIndex sequence;
+      StringIndex peptide_group_label;
+      StringIndex gene_name;
+      StringIndex sum_formula;
+      StringIndex compound_name;
+      UInt32 first_protein_ref; ///< index for getProteinRef()
+      UInt32 nr_protein_refs;
+      UInt32 first_modification; ///< index for getModification()
+      UInt32 nr_modifications;
+      UInt32 padding_;
+    };
+
+    /// Fixed-size protein record
+    struct ProteinRecord
+    {
+      StringIndex id;
+      StringIndex sequence;
+    };
+
+    /// Flags of TransitionRecord
+    enum TransitionFlag : UInt32
+    {
+      FLAG_DECOY = 1,
+      FLAG_DETECTING = 2,
+      FLAG_QUANTIFYING = 4,
+      FLAG_IDENTIFYING = 8
+    };
+
+    /// Default constructor (no file opened)
+    TransitionBinaryFile();
+
+    /// Destructor (unmaps the file)
+    ~TransitionBinaryFile();
+
+    TransitionBinaryFile(const TransitionBinaryFile&) = delete;
+    TransitionBinaryFile& operator=(const TransitionBinaryFile&) = delete;
+
+    /**
+      @brief Writes a binary library
+
+      @param filename The output file
+      @param exp The assay library to store
+      @param source_file The file @p exp was loaded from (may be empty); its size, modification time and checksum are recorded for isUpToDate()
+      @param fingerprint Description of the settings used to load @p source_file (e.g. input type and reader parameters), checked by isUpToDate()
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+      @exception Exception::InvalidValue is thrown if the library exceeds the limits of the format (2^32 strings or records)
+    */
+    static void store(const String& filename, const OpenSwath::LightTargetedExperiment& exp, const String& source_file = "", const String& fingerprint = "");
+
+    /**
+      @brief Whether @p filename is a valid binary library created from the current version of @p source_file with the settings described by @p fingerprint
+
+      Returns false if the file does not exist, is not a binary library, if
+      @p fingerprint differs from the one recorded during store(), or if the
+      size of @p source_file differs. If only the modification time of
+      @p source_file differs, the SHA1 checksums of its content are compared.
+    */
+    static bool isUpToDate(const String& filename, const String& source_file, const String& fingerprint = "");
+
+    /**
+      @brief Memory-maps a binary library
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::ParseError is thrown if the file is not a valid binary library
+    */
+    void open(const String& filename);
+
+    /// Whether a file is currently mapped
+    bool isOpen() const;
+
+    /// Unmaps the file
+    void close();
+
+    /**
+      @brief Materializes the library as an OpenSwath::LightTargetedExperiment
+
+      Any content of @p exp is replaced.
+    */
+    void toLightTargetedExperiment(OpenSwath::LightTargetedExperiment& exp) const;
+
+    /// Convenience function: open() and toLightTargetedExperiment()
+    void load(const String& filename, OpenSwath::LightTargetedExperiment& exp);
+
+    /** @name Zero-copy access to the mapped records
+    */
+    //@{
+    Size getNrStrings() const;
+    Size getNrTransitions() const;
+    Size getNrCompounds() const;
+    Size getNrProteins() const;
+
+    /// Returns string @p index of the string pool (valid as long as the file is mapped)
+    std::string_view getString(StringIndex index) const;
+
+    const TransitionRecord& getTransition(Size index) const;
+    const CompoundRecord& getCompound(Size index) const;
+    const ProteinRecord& getProtein(Size index) const;
+
+    /// Protein reference @p index (see CompoundRecord::first_protein_ref)
+    StringIndex getProteinRef(Size index) const;
+
+    /// Modification @p index (see CompoundRecord::first_modification)
+    const OpenSwath::LightModification& getModification(Size index) const;
+
+    /// Transition indices sorted by precursor m/z (and product m/z)
+    const UInt32* getPrecursorMZOrder() const;
+
+    /**
+      @brief Positions in getPrecursorMZOrder() of all transitions with precursor m/z in [@p mz_start, @p mz_end)
+
+      Returns a half-open range [first, last) into getPrecursorMZOrder(), e.g.
+      all transitions of a SWATH window.
+    */
+    std::pair<Size, Size> getPrecursorMZRange(double mz_start, double mz_end) const;
+    //@}
+
+protected:
+
+    Internal::MappedIndexFile file_;
+
+    const ProteinRecord* proteins_ = nullptr;
+    const CompoundRecord* compounds_ = nullptr;
+    const StringIndex* protein_refs_ = nullptr;
+    const OpenSwath::LightModification* modifications_ = nullptr;
+    const TransitionRecord* transitions_ = nullptr;
+    const UInt32* precursor_mz_order_ = nullptr;
+
+    Size nr_proteins_ = 0;
+    Size nr_compounds_ = 0;
+    Size nr_protein_refs_ = 0;
+    Size nr_modifications_ = 0;
+    Size nr_transitions_ = 0;
+  };
+
+}
@@ -17,6 +17,9 @@
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 
 #include <fstream>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
 
 namespace OpenMS
 {
@@ -110,7 +113,10 @@ Remarks:
 </ul>
 </p>
 
-
+  Input files are memory-mapped and parsed in parallel in line-aligned
+  chunks; the result does not depend on the number of threads. When reading
+  into an OpenSwath::LightTargetedExperiment, the transitions are converted
+  chunk by chunk, so the full transition list is never held in memory.
 
   @htmlinclude OpenMS_TransitionTSVFile.parameters
 
@@ -195,6 +201,18 @@ protected:
     */
     void TSVToTargetedExperiment_(std::vector<TSVTransition>& transition_list, OpenSwath::LightTargetedExperiment& exp);
 
+    /// Compounds, proteins and peptide label groups already added to a LightTargetedExperiment
+    struct LightConversionState;
+
+    /** @brief Append a list of TSVTransition to a LightTargetedExperiment
+     *
+     * Allows to build a LightTargetedExperiment incrementally from consecutive
+     * parts of a transition list (see readTSVInput_). The transitions may be
+     * modified.
+     *
+    */
+    void addToLightTargetedExperiment_(std::vector<TSVTransition>& transitions, LightConversionState& state, OpenSwath::LightTargetedExperiment& exp);
+
     /// Convert an OpenMS transition to a TSVTransition for output writing
     TransitionTSVFile::TSVTransition convertTransition_(const ReactionMonitoringTransition* it, OpenMS::TargetedExperiment& targeted_exp);
     //@}
@@ -232,6 +250,9 @@ private:
     */
     void getTSVHeader_(const std::string& line, char& delimiter, std::map<std::string, int>& header_dict) const;
 
+    /// Column indices of the fields of a TSV file, resolved once from the header
+    struct TSVColumns;
+
     /** @brief Read tab or comma separated input with columns defined by their column headers only
      *
      * @param filename The input file
@@ -241,6 +262,36 @@ private:
     */
     void readUnstructuredTSVInput_(const char* filename, FileTypes::Type filetype, std::vector<TSVTransition>& transition_list);
 
+    /** @brief Read tab or comma separated input chunk by chunk
+     *
+     * The file is memory-mapped and split into line-aligned chunks which are
+     * parsed in parallel. The parsed chunks are passed to @p consumer in file
+     * order; the consumer may modify (e.g. move from) the transitions, which are
+     * discarded afterwards.
+     *
+     * @param filename The input file
+     * @param filetype The type of file ("mrm" or "tsv")
+     * @param consumer Called with the transitions of each chunk
+     *
+     * @exception Exception::FileNotFound is thrown if the file does not exist
+     * @exception Exception::IllegalArgument is thrown if a line does not match the header
+    */
+    void readTSVInput_(const char* filename, FileTypes::Type filetype, const std::function<void(std::vector<TSVTransition>&)>& consumer);
+
+    /** @brief Parse the fields of a single line
+     *
+     * @param columns The column layout of the file
+     * @param tmp_line The fields of the line
+     * @param filetype The type of file ("mrm" or "tsv")
+     * @param line_nr The number of the line (used to name transitions without identifier)
+     * @param mytransition The output transition
+     * @param spectrast_legacy Set to true if a legacy SpectraST retention time was found
+     *
+     * @return Whether the transition should be kept (unannotated transitions in SpectraST MRM files are skipped)
+    */
+    bool parseTSVRow_(const TSVColumns& columns, const std::vector<std::string_view>& tmp_line, FileTypes::Type filetype,
+                      int line_nr, TSVTransition& mytransition, bool& spectrast_legacy);
+
     /// Extract retention time from a SpectraST comment string
     void spectrastRTExtract(const String& str_inp, double & value, bool & spectrast_legacy);
 
@@ -271,6 +322,14 @@ private:
      */
     void resolveMixedSequenceGroups_(std::vector<TSVTransition>& transition_list) const;
 
+    /** @brief Incremental version of resolveMixedSequenceGroups_ for a single transition
+     *
+     * @param transition The transition to be fixed
+     * @param label_sequences The peptide sequence of the first transition of each peptide label group seen so far
+     *
+     */
+    void resolveMixedSequenceGroup_(TSVTransition& transition, std::unordered_map<String, String>& label_sequences) const;
+
     /// Populate a new ReactionMonitoringTransition object from a row in the csv
     void createTransition_(std::vector<TSVTransition>::iterator& tr_it,
                            OpenMS::ReactionMonitoringTransition& rm_trans);
@@ -332,6 +391,9 @@ public:
     void convertTSVToTargetedExperiment(const char* filename, FileTypes::Type filetype, OpenMS::TargetedExperiment& targeted_exp);
 
     /** @brief Read in a tsv file and construct a targeted experiment (Light transition structure)
+     *
+     * The file is read and converted chunk by chunk, the memory required is
+     * thus dominated by the output.
      *
      * @param filename The input file
      * @param filetype The type of file ("mrm" or "tsv")
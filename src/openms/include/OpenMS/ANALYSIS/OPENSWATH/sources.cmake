@@ -37,6 +37,7 @@ set(sources_list_h
   SwathQC.h
   SpectrumAddition.h
   TargetedSpectraExtractor.h
+  TransitionBinaryFile.h
   TransitionTSVFile.h
   TransitionPQPFile.h
 )
@@ -24,7 +24,8 @@ namespace OpenMS
   In other words, per spectrum deconvolved masses are converted into deconvolved features
   Currently only works for MS1 spectra. (Top-down DIA is not yet used much).
   Every time an MS1 spectrum is deconvolved, the relevant information is stored in this class.
-  Tracing is performed at the end of FLASHDeconv run.
+  Tracing is performed at the end of FLASHDeconv run, or, to keep only a sliding RT window in memory,
+  repeatedly during the run with findClosedFeatures().
   This class also comes with tsv, TopFD, ProMex format output functions.
   @ingroup Topdown
   */
@@ -60,12 +61,32 @@ namespace OpenMS
        */
     std::vector<FLASHDeconvHelperStructs::MassFeature> findFeatures(const PrecalculatedAveragine& averagine);
 
+    /**
+       @brief Find the mass features that can no longer be extended by spectra stored later (streaming mode).
+
+       Mass tracing is performed on the stored spectra. A trace is closed if more than trace_termination_outliers
+       spectra were stored after its last peak. The features of closed traces are returned and their peak groups
+       are removed. Stored spectra that cannot contribute to a future trace anymore are discarded, so the memory
+       use is bounded by the RT span of the open traces. Call findFeatures() after the last spectrum to obtain
+       the remaining features.
+       Features at the borders of the window may differ slightly from tracing all spectra at once.
+       @param averagine precalculated averagine for cosine calculation
+       */
+    std::vector<FLASHDeconvHelperStructs::MassFeature> findClosedFeatures(const PrecalculatedAveragine& averagine);
+
   protected:
     void updateMembers_() override;
 
   private:
+    /// trace the stored spectra; with @p closed_only, only closed traces are turned into features (and removed, see findClosedFeatures())
+    std::vector<FLASHDeconvHelperStructs::MassFeature> findFeatures_(const PrecalculatedAveragine& averagine, bool closed_only);
+
     /// cosine thresholds for scoring and filtering
     double min_isotope_cosine_;
+    /// number of consecutive spectra without a peak after which a trace cannot be extended anymore
+    Size trace_termination_outliers_;
+    /// minimum RT span of a mass trace
+    double min_trace_length_;
     /// peak group information is stored in here for tracing
     std::map<double, std::map<double, PeakGroup>> peak_group_map_; // rt , mono mass, peakgroup
   };
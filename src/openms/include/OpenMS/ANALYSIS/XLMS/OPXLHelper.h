@@ -14,7 +14,15 @@
 #include <OpenMS/FORMAT/FASTAFile.h>
 #include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
 #include <OpenMS/CHEMISTRY/ModifiedPeptideGenerator.h>
+#include <OpenMS/CHEMISTRY/SimpleTSGXLMS.h>
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <numeric>
+#include <unordered_map>
 
 namespace OpenMS
 {
@@ -66,6 +74,125 @@ namespace OpenMS
         }
       };
 
+      /**
+       * @brief Thread-safe, size-bounded cache of linear fragment ion spectra (see SimpleTSGXLMS::getLinearIonSpectrum())
+
+          The linear fragments of a candidate only depend on the peptide and the link position(s), and the same peptides are candidates
+          for many spectra. One cache is shared by all threads of a search. The entries are distributed over independently locked shards,
+          each of which evicts its least recently used entries once its share of the capacity is reached. Spectra are returned as shared
+          pointers and stay valid after eviction.
+
+          Peptides are identified by their address, i.e. the peptides have to stay in place (and unchanged) while the cache is used.
+       */
+      class OPENMS_DLLAPI LinearIonSpectrumCache
+      {
+      public:
+        typedef std::shared_ptr<const std::vector<SimpleTSGXLMS::SimplePeak>> SpectrumPtr;
+
+        /**
+         * @param spec_gen The generator for the spectra (has to outlive the cache)
+         * @param max_entries The maximal number of cached spectra (0 disables caching)
+         */
+        LinearIonSpectrumCache(const SimpleTSGXLMS& spec_gen, Size max_entries);
+
+        /// Returns the linear ion spectrum of @p peptide (see SimpleTSGXLMS::getLinearIonSpectrum() for the parameters), generated on a cache miss
+        SpectrumPtr get(const AASequence& peptide, Size link_pos, int charge, Size link_pos_2 = 0);
+
+        /// Number of requests answered from the cache
+        Size getHits() const;
+
+        /// Number of requests that generated the spectrum
+        Size getMisses() const;
+
+        /// Number of cached spectra
+        Size size() const;
+
+      private:
+        struct Key
+        {
+          const AASequence* peptide;
+          Size link_pos;
+          Size link_pos_2;
+          int charge;
+
+          bool operator==(const Key& other) const
+          {
+            return peptide == other.peptide && link_pos == other.link_pos && link_pos_2 == other.link_pos_2 && charge == other.charge;
+          }
+        };
+
+        struct KeyHash
+        {
+          std::size_t operator()(const Key& key) const;
+        };
+
+        struct Shard
+        {
+          mutable std::mutex mutex;
+          std::list<Key> lru; ///< most recently used first
+          std::unordered_map<Key, std::pair<SpectrumPtr, std::list<Key>::iterator>, KeyHash> entries;
+        };
+
+        const SimpleTSGXLMS& spec_gen_;
+        Size max_entries_per_shard_;
+        std::vector<Shard> shards_;
+        std::atomic<Size> hits_;
+        std::atomic<Size> misses_;
+      };
+
+      /**
+       * @brief Cheap prefilter for the peptides of cross-link candidates, based on their linear fragment ions
+
+          OpenPepXL and OpenPepXLLF discard candidates with less than two matched linear fragment ions (for each peptide) before generating
+          and matching the fragments containing the linker. The linear fragments of a peptide for any link position are a subset of its complete
+          fragment ladder, so the number of ladder peaks with an experimental peak within the fragment mass tolerance is an upper bound for the
+          number of matches at any link position. This bound is computed once per peptide and spectrum (on demand), which allows to discard most
+          peptide pairs during the enumeration, before any candidate is built (see forEachCrossLinkCandidate()). The candidates that are discarded
+          are exactly those that would fail the linear fragment check later on.
+
+          operator() can be called from several threads for the same spectrum (forEachCrossLinkCandidate() does so), setSpectrum() must not be
+          called concurrently with anything else.
+       */
+      class OPENMS_DLLAPI LinearFragmentFilter
+      {
+      public:
+        /**
+         * @param peptides The peptide database (indices refer to this vector, which has to outlive the filter)
+         * @param spec_gen The generator used for the linear fragment spectra of the candidates
+         * @param fragment_mass_tolerance The fragment mass tolerance used to match the linear fragments
+         * @param fragment_mass_tolerance_unit_ppm The unit of the fragment mass tolerance ("ppm" if true, "Da" if false)
+         * @param max_charge The maximal charge of the linear fragments
+         * @param min_matches The minimal number of matched linear fragments of a peptide
+         */
+        LinearFragmentFilter(const std::vector<OPXLDataStructs::AASeqWithMass>& peptides, const SimpleTSGXLMS& spec_gen, double fragment_mass_tolerance,
+                             bool fragment_mass_tolerance_unit_ppm, int max_charge = 2, Size min_matches = 2);
+
+        /// Takes the fragment ladders from @p cache (and its generator), so they are shared across spectra and with the scoring of the candidates
+        LinearFragmentFilter(const std::vector<OPXLDataStructs::AASeqWithMass>& peptides, LinearIonSpectrumCache& cache, const SimpleTSGXLMS& spec_gen,
+                             double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, int max_charge = 2, Size min_matches = 2);
+
+        /// Sets the experimental linear fragment peaks (sorted by m/z, has to outlive the calls for this spectrum) and forgets the results for the previous spectrum
+        void setSpectrum(const PeakSpectrum& linear_peaks);
+
+        /// Returns false if peptide @p index cannot have @p min_matches matched linear fragments in the current spectrum
+        bool operator()(Size index);
+
+        /// Upper bound for the number of linear fragments of @p peptide matching the current spectrum at any link position
+        Size countMatchesUpperBound(const AASequence& peptide) const;
+
+      private:
+        const std::vector<OPXLDataStructs::AASeqWithMass>& peptides_;
+        const SimpleTSGXLMS& spec_gen_;
+        LinearIonSpectrumCache* cache_ = nullptr;
+        double fragment_mass_tolerance_;
+        bool fragment_mass_tolerance_unit_ppm_;
+        int max_charge_;
+        Size min_matches_;
+        const PeakSpectrum* linear_peaks_ = nullptr;
+        Size spectrum_generation_ = 1; ///< incremented for each spectrum, so the states of the previous one do not have to be reset
+        std::vector<std::atomic<Size>> state_; ///< per peptide: (spectrum generation << 1) | accepted, from the last spectrum it was computed for
+      };
+
       /**
        * @brief Enumerates precursor masses for all candidates in an XL-MS search
 
@@ -85,6 +212,29 @@ namespace OpenMS
        */
       static std::vector<OPXLDataStructs::XLPrecursor> enumerateCrossLinksAndMasses(const std::vector<OPXLDataStructs::AASeqWithMass>&  peptides, double cross_link_mass_light, const DoubleList& cross_link_mass_mono_link, const StringList& cross_link_residue1, const StringList& cross_link_residue2, const std::vector< double >& spectrum_precursors, std::vector< int >& precursor_correction_positions, double precursor_mass_tolerance, bool precursor_mass_tolerance_unit_ppm);
 
+      /**
+       * @brief Enumerates the same candidates as enumerateCrossLinksAndMasses(), but passes them on one by one instead of collecting them
+
+          Peptide pairs are enumerated with a two-pointer sweep over the sorted peptide masses for each precursor mass, i.e. in linear time in the
+          number of peptides plus the number of candidates. The sweep runs in parallel over chunks of alpha peptides; only the index pairs of the
+          current precursor mass are buffered. Candidates are passed to @p candidate_callback (from the calling thread) in order of precursor mass,
+          then type (loop-links, mono-links, cross-links), then peptide indices, independent of the number of threads, so they can be filtered or
+          processed without materializing all of them.
+
+       * @param peptides The peptides with precomputed masses from the digestDatabase function, sorted by mass
+       * @param cross_link_mass_light Mass of the cross-linker, only the light one if a labeled linker is used
+       * @param cross_link_mass_mono_link A list of possible masses for the cross-link, if it is attached to a peptide on one side (sorted in descending order)
+       * @param cross_link_residue1 A list of residues, to which the first side of the linker can react
+       * @param cross_link_residue2 A list of residues, to which the second side of the linker can react
+       * @param spectrum_precursors The precursor masses to search for, sorted in ascending order
+       * @param precursor_mass_tolerance The precursor mass tolerance
+       * @param precursor_mass_tolerance_unit_ppm The unit of the precursor mass tolerance ("ppm" if true, "Da" if false)
+       * @param peptide_filter If set, candidates containing a peptide for which it returns false are skipped (e.g. a LinearFragmentFilter). Called from several threads at once.
+       * @param candidate_callback Called with the alpha index, the beta index (peptides.size() + 1 for mono- and loop-links), the precursor mass and the position of the precursor in @p spectrum_precursors of each candidate
+       */
+      static void forEachCrossLinkCandidate(const std::vector<OPXLDataStructs::AASeqWithMass>& peptides, double cross_link_mass_light, const DoubleList& cross_link_mass_mono_link, const StringList& cross_link_residue1, const StringList& cross_link_residue2, const std::vector< double >& spectrum_precursors, double precursor_mass_tolerance, bool precursor_mass_tolerance_unit_ppm,
+                                            const std::function<bool(Size)>& peptide_filter, const std::function<void(Size, Size, double, int)>& candidate_callback);
+
       /**
        * @brief Digests a database with the given EnzymaticDigestion settings and precomputes masses for all peptides
 
@@ -226,6 +376,7 @@ namespace OpenMS
        * @param cross_link_name The name of the cross-linker, e.g. "DSS" or "BS3"
        * @param use_sequence_tags Whether to use sequence tags to filter out candidates
        * @param tags The list of sequence tags that are used to filter candidate sequences. Only applied if use_sequence_tags = true
+       * @param peptide_filter If set, candidates containing a peptide (index into @p filtered_peptide_masses) for which it returns false are skipped during the enumeration (e.g. a LinearFragmentFilter)
        */
       static std::vector <OPXLDataStructs::ProteinProteinCrossLink> collectPrecursorCandidates(const IntList& precursor_correction_steps,
                                                                                                 double precursor_mass,
@@ -238,7 +389,8 @@ namespace OpenMS
                                                                                                 const StringList& cross_link_residue2,
                                                                                                 String cross_link_name,
                                                                                                 bool use_sequence_tags = false,
-                                                                                                const std::vector<std::string>& tags = std::vector<std::string>());
+                                                                                                const std::vector<std::string>& tags = std::vector<std::string>(),
+                                                                                                const std::function<bool(Size)>& peptide_filter = std::function<bool(Size)>());
 
       /**
        * @brief Computes the mass error of a precursor mass to a hit
@@ -153,6 +153,7 @@ private:
 
     Int number_top_hits_;
     String deisotope_mode_;
+    Size linear_fragment_cache_size_;
 
     String add_y_ions_;
     String add_b_ions_;
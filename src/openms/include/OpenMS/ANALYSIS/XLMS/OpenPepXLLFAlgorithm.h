@@ -137,6 +137,7 @@ private:
 
     Int number_top_hits_;
     String deisotope_mode_;
+    Size linear_fragment_cache_size_;
     bool use_sequence_tags_;
     Size sequence_tag_min_length_;
 
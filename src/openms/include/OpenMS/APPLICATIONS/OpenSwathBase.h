@@ -18,6 +18,7 @@
 #include <OpenMS/FORMAT/SwathFile.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/SwathWindowLoader.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/TransitionTSVFile.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/TransitionBinaryFile.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/TransitionPQPFile.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathTSVWriter.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>
@@ -283,15 +284,37 @@ protected:
    * @param tr_type Input file type
    * @param tr_file Input file name
    * @param tsv_reader_param Parameters on how to interpret spectral data
+   * @param binary_cache Optional binary assay library (see TransitionBinaryFile). If it is
+   *        up to date with respect to @p tr_file, @p tr_type and @p tsv_reader_param, the
+   *        transitions are loaded from it. Otherwise @p tr_file is loaded and the cache is
+   *        (re-)generated.
    *
    */
   OpenSwath::LightTargetedExperiment loadTransitionList(const FileTypes::Type& tr_type,
                                                         const String& tr_file,
-                                                        const Param& tsv_reader_param)
+                                                        const Param& tsv_reader_param,
+                                                        const String& binary_cache = "")
   {
     OpenSwath::LightTargetedExperiment transition_exp;
     ProgressLogger progresslogger;
     progresslogger.setLogType(log_type_);
+    // the cache depends on how the transition list was read
+    String cache_fingerprint = "type=" + FileTypes::typeToName(tr_type) + ";";
+    if (tr_type == FileTypes::TSV)
+    {
+      for (Param::ParamIterator it = tsv_reader_param.begin(); it != tsv_reader_param.end(); ++it)
+      {
+        cache_fingerprint += it.getName() + "=" + it->value.toString() + ";";
+      }
+    }
+    if (!binary_cache.empty() && TransitionBinaryFile::isUpToDate(binary_cache, tr_file, cache_fingerprint))
+    {
+      progresslogger.startProgress(0, 1, "Load binary assay library");
+      TransitionBinaryFile().load(binary_cache, transition_exp);
+      progresslogger.endProgress();
+      return transition_exp;
+    }
+
     if (tr_type == FileTypes::TRAML)
     {
       progresslogger.startProgress(0, 1, "Load TraML file");
@@ -319,6 +342,13 @@ protected:
       OPENMS_LOG_ERROR << "Provide valid TraML, TSV or PQP transition file." << std::endl;
       throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Need to provide valid input file.");
     }
+
+    if (!binary_cache.empty())
+    {
+      progresslogger.startProgress(0, 1, "Store binary assay library");
+      TransitionBinaryFile::store(binary_cache, transition_exp, tr_file, cache_fingerprint);
+      progresslogger.endProgress();
+    }
     return transition_exp;
   }
 
@@ -597,6 +597,25 @@ protected:
     static AASequence fromString(const char* s,
                                  bool permissive = true);
 
+    /**
+      @brief create AASequence object by parsing an OpenMS string, re-using previous parsing results
+
+      Same as fromString(), but parsed sequences are kept in a global cache
+      (keyed by the string), so that strings which occur repeatedly (e.g.
+      the same peptide identified in many spectra) are parsed only once.
+      Use this when reading identification or assay files.
+
+      The cache is thread-safe and bounded in size. Strings that cannot be
+      parsed are not cached, i.e. the exception is thrown on every call.
+
+      @param s Input string
+      @param permissive If set, skip spaces and replace stop codon symbols ("*", "#", "+") by "X" (unknown amino acid) during parsing
+
+      @throws Exception::ParseError if an invalid string representation of an AA sequence is passed
+    */
+    static AASequence fromStringCached(const String& s,
+                                       bool permissive = true);
+
   protected:
 
     std::vector<const Residue*> peptide_;
@@ -12,6 +12,7 @@
 #include <OpenMS/DATASTRUCTURES/String.h>
 #include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/IsotopeDistribution.h>
 
+#include <array>
 #include <map>
 #include <memory>
 #include <unordered_map>
@@ -37,6 +38,10 @@ namespace OpenMS
       Specific isotopes of elements can be accessed by writing the atomic number of the isotope
       in brackets followed by the element name, e.g. "(2)H" for deuterium.
 
+      Lookups do not take any locks. One and two letter element symbols (the
+      common case when parsing empirical formulas) are resolved through a
+      directly addressed table instead of a hash map.
+
       @improvement include exact mass values for the isotopes (done) and update IsotopeDistribution (Andreas)
       @improvement add exact isotope distribution based on exact isotope values (Andreas)
 */
@@ -134,12 +139,21 @@ protected:
     **/
     void clear_();
 
+    /// index of a one or two letter element symbol (e.g. "C" or "Cl") in symbol_table_, or symbol_table_.size() for all other strings
+    static Size symbolIndex_(const std::string& symbol);
+
+    /// rebuilds symbol_table_ from symbols_
+    void updateSymbolTable_();
+
     std::unordered_map<std::string, const Element*> names_;
 
     std::unordered_map<std::string, const Element*> symbols_;
 
     std::unordered_map<unsigned int, const Element*> atomic_numbers_;
 
+    /// direct lookup table for one and two letter symbols (see symbolIndex_()), mirrors the respective entries of symbols_
+    std::array<const Element*, 26 * 27> symbol_table_{};
+
 private:
     ElementDB();
     ~ElementDB();
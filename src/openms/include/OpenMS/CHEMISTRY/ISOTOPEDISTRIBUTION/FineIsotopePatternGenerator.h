@@ -73,6 +73,11 @@ namespace OpenMS
     * highest isotopic peak (relative). This is how the stop_condition
     * parameter is interpreted when use_total_prob is set to false.
     *
+    * Callers that request the same formulas over and over again can enable
+    * caching (see setCaching()): computed distributions are then kept by sum
+    * formula and parameters in the process-wide IsotopeDistributionCache,
+    * i.e. repeated requests for the same formula only copy the cached result.
+    *
     * @note Computation of fine isotope patterns can be slow for large
     *       molecules, if you don't need fine isotope distributions consider using
     *       CoarseIsotopePatternGenerator.
@@ -135,6 +140,9 @@ namespace OpenMS
       * down processing, consider using IsoSpec (IsoSpecWrapper /
       * IsoSpecGeneratorWrapper) directly for increased performance.
       *
+      * @note If caching is enabled, the result is taken from
+      * IsotopeDistributionCache::getInstance() (computed on a cache miss).
+      *
       **/
     IsotopeDistribution run(const EmpiricalFormula&) const override;
 
@@ -174,10 +182,23 @@ namespace OpenMS
       return use_total_prob_;
     }
 
+    /// Set whether computed distributions are cached (see IsotopeDistributionCache, default: false)
+    void setCaching(bool caching)
+    {
+      caching_ = caching;
+    }
+
+    /// Returns whether computed distributions are cached (see IsotopeDistributionCache)
+    bool getCaching() const
+    {
+      return caching_;
+    }
+
  protected:
     double stop_condition_ = 0.01;
     bool absolute_ = false;
     bool use_total_prob_ = true;
+    bool caching_ = false;
 
   };
 
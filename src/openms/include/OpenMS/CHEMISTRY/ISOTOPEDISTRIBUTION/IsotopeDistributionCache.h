@@ -0,0 +1,121 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Rost $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/IsotopeDistribution.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace OpenMS
+{
+  class EmpiricalFormula;
+  class FineIsotopePatternGenerator;
+
+  /**
+    @brief Thread-safe, size-bounded cache of fine isotope distributions (see FineIsotopePatternGenerator)
+
+    Many algorithms generate the isotope distributions of the same sum
+    formulas over and over again (e.g. the fragment ions of
+    TheoreticalSpectrumGenerator with isotope peaks). The distributions are
+    cached by sum formula and generator parameters (stop condition, total
+    probability or threshold mode, absolute or relative threshold). The
+    charge of the formula does not change its distribution and is not part
+    of the key. Elements are identified by their isotope masses and
+    abundances, i.e. changes to an element in the ElementDB are picked up.
+
+    The least recently used entries are evicted once the capacity is reached.
+    Large caches are split into independently locked shards (of at least
+    MIN_ENTRIES_PER_SHARD entries), each of which evicts on its own.
+    Distributions are returned as shared pointers and stay valid after
+    eviction.
+
+    FineIsotopePatternGenerator::run() uses the process-wide cache returned by
+    getInstance() if caching is enabled for the generator (see
+    FineIsotopePatternGenerator::setCaching(), e.g. used by
+    TheoreticalSpectrumGenerator for the isotope peaks of fragment ions).
+
+    @ingroup Chemistry
+  */
+  class OPENMS_DLLAPI IsotopeDistributionCache
+  {
+public:
+    typedef std::shared_ptr<const IsotopeDistribution> DistributionPtr;
+
+    /// Capacity of the process-wide cache
+    static constexpr Size DEFAULT_MAX_ENTRIES = 32768;
+
+    /// Minimal capacity of a shard, smaller caches are not split
+    static constexpr Size MIN_ENTRIES_PER_SHARD = 256;
+
+    /// Constructor, @p max_entries is the maximal number of cached distributions (0 disables caching)
+    explicit IsotopeDistributionCache(Size max_entries = DEFAULT_MAX_ENTRIES);
+
+    IsotopeDistributionCache(const IsotopeDistributionCache&) = delete;
+    IsotopeDistributionCache& operator=(const IsotopeDistributionCache&) = delete;
+
+    /// Returns the process-wide cache
+    static IsotopeDistributionCache& getInstance();
+
+    /// Returns the distribution of @p formula (sorted by mass) as computed by @p generator, computed on a cache miss
+    DistributionPtr get(const EmpiricalFormula& formula, const FineIsotopePatternGenerator& generator);
+
+    /**
+      @brief Sets the maximal number of cached distributions (0 disables caching)
+
+      Evicts the least recently used entries if necessary. Must not be called while other threads use the cache.
+    */
+    void setMaxEntries(Size max_entries);
+
+    /// Returns the maximal number of cached distributions
+    Size getMaxEntries() const;
+
+    /// Number of requests answered from the cache
+    Size getHits() const;
+
+    /// Number of requests that computed the distribution
+    Size getMisses() const;
+
+    /// Number of cached distributions
+    Size size() const;
+
+    /// Removes all entries and resets the counters
+    void clear();
+
+private:
+    /// Sum formula and generator parameters, serialized
+    typedef std::string Key;
+
+    struct Shard
+    {
+      mutable std::mutex mutex;
+      std::list<Key> lru; ///< most recently used first
+      std::unordered_map<Key, std::pair<DistributionPtr, std::list<Key>::iterator>> entries;
+    };
+
+    /// Serializes the sum formula and the parameters of @p generator
+    static Key makeKey_(const EmpiricalFormula& formula, const FineIsotopePatternGenerator& generator);
+
+    /// Removes the least recently used entries of @p shard beyond @p max_entries (shard has to be locked)
+    static void trim_(Shard& shard, Size max_entries);
+
+    std::vector<Shard> shards_; ///< only the first nr_shards_ are in use
+    Size nr_shards_;
+    Size max_entries_;
+    Size max_entries_per_shard_;
+    std::atomic<Size> hits_;
+    std::atomic<Size> misses_;
+  };
+
+} // namespace OpenMS
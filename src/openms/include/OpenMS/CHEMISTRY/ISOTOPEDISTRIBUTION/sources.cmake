@@ -8,6 +8,7 @@ set(sources_list_h
   FineIsotopePatternGenerator.h
   IsoSpecWrapper.h
   IsotopeDistribution.h
+  IsotopeDistributionCache.h
   IsotopePatternGenerator.h
 )
 
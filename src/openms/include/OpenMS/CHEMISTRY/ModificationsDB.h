@@ -12,9 +12,13 @@
 #include <OpenMS/DATASTRUCTURES/String.h>
 #include <OpenMS/CHEMISTRY/ResidueModification.h>
 
+#include <array>
+#include <atomic>
 #include <set>
 #include <memory>  // unique_ptr
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace OpenMS
 {
@@ -45,6 +49,23 @@ namespace OpenMS
       databases. This can be done by providing a path through
       initializeModificationsDB(), however it is important that this is done
       *before* the first call to getInstance().
+
+      @section ModificationsDB_threads Thread safety
+
+      The modifications read on construction are frozen, i.e. they are never
+      changed afterwards and lookups of these modifications do not take any
+      locks. Modifications added at runtime (e.g. via addModification(),
+      readFromUnimodXMLFile() or user-defined modifications like "[+12.34]"
+      when parsing peptide sequences) are stored separately and protected by
+      an OpenMP critical section; only lookups after such an addition need to
+      take the lock. A
+      call to freeze() moves the runtime modifications into the lock-free
+      part again.
+
+      Lookups in the frozen part are accelerated by precomputed indices: a
+      directly addressed table of UniMod accessions ("UniMod:<record id>")
+      and lists of modifications sorted by mass difference (per residue of
+      origin) for the searchModificationsByDiffMonoMass() family.
   */
   class OPENMS_DLLAPI ModificationsDB
   {
@@ -211,6 +232,34 @@ public:
     /// Writes tab separated entries: FullId,FullName,Origin,AA,TerminusSpecificity,DiffMonoMass (including header) to TSV file
     void writeTSV(const String& filename);
 
+    /**
+       @brief Adds modifications from a given file in OBO format
+
+       After construction, the modifications are added to the runtime part of the database (see freeze()).
+
+       @throw Exception::ParseError if the file cannot be parsed correctly
+    */
+    void readFromOBOFile(const String& filename);
+
+    /**
+       @brief Adds modifications from a given file in Unimod XML format
+
+       After construction, the modifications are added to the runtime part of the database (see freeze()).
+    */
+    void readFromUnimodXMLFile(const String& filename);
+
+    /**
+       @brief Moves all modifications added at runtime into the frozen (lock-free) part of the database
+
+       Afterwards, lookups of these modifications do not take any locks
+       anymore. Call this e.g. after setting up the modifications of a search
+       and before entering a parallel region. Indices of modifications (see
+       getModification(Size)) are not changed.
+
+       @warning Not thread-safe: no other thread may access the database while freeze() is running.
+    */
+    void freeze();
+
   protected:
 
     /// Stores whether ModificationsDB was instantiated before
@@ -222,6 +271,52 @@ public:
     /// Stores the mappings of (unique) names to the modifications
     std::unordered_map<String, std::set<const ResidueModification*> > modification_names_;
 
+    /// Modifications added after construction or the last call to freeze() (protected by the critical section, indices continue those of mods_)
+    std::vector<ResidueModification*> runtime_mods_;
+
+    /// Mappings of names to the modifications in runtime_mods_ (protected by the critical section)
+    std::unordered_map<String, std::set<const ResidueModification*> > runtime_modification_names_;
+
+    /// Whether the constructor has finished, i.e. mods_ and modification_names_ are frozen
+    bool constructed_ = false;
+
+    /// Whether the runtime part (runtime_mods_ or runtime_modification_names_) is non-empty, i.e. lookups need to take the lock
+    std::atomic<bool> has_runtime_mods_{false};
+
+    /// Entries of modification_names_ for the UniMod accessions ("UniMod:<index>"; nullptr if not present)
+    std::vector<const std::set<const ResidueModification*>*> unimod_index_;
+
+    /// Mass differences and indices (in mods_) of all frozen modifications, sorted by mass difference
+    std::vector<std::pair<double, Size> > mass_index_;
+
+    /// As mass_index_, but separately for each residue of origin
+    std::array<std::vector<std::pair<double, Size> >, 256> mass_index_by_origin_;
+
+    /// Rebuilds unimod_index_, mass_index_ and mass_index_by_origin_ from mods_ and modification_names_
+    void buildIndices_();
+
+    /**
+       @brief Calls @p f for the frozen and the runtime part of the database, locking where needed
+
+       @p f is called as f(mods, names, offset), where @p offset is the index of the first element of @p mods in the database.
+       It must not throw (it may run inside a critical section).
+    */
+    template <typename FunctionType>
+    void forEachPart_(FunctionType&& f) const;
+
+    /// Returns the modifications in @p names with name @p mod_name (nullptr if there are none); uses unimod_index_ for the frozen part
+    const std::set<const ResidueModification*>* findByName_(const std::unordered_map<String, std::set<const ResidueModification*> >& names, const String& mod_name) const;
+
+    /// Collects all modifications matching the mass and specificity criteria in order of appearance in the DB
+    void searchByDiffMonoMass_(std::vector<const ResidueModification*>& mods, double mass, double max_error, char residue, ResidueModification::TermSpecificity term_spec) const;
+
+    /**
+       @brief Adds @p new_mod (owned by the DB afterwards) to the runtime part; must be called inside the critical section
+
+       @return @p new_mod
+    */
+    const ResidueModification* addRuntimeModification_(ResidueModification* new_mod);
+
     /** @brief Helper function to check if a residue matches the origin for a modification
      *
      * Special cases are handled as follows:
@@ -270,15 +365,5 @@ private:
        @param new_mod A copy will be made on the heap and added to the modification if not already present.
     */
     const ResidueModification* addNewModification_(const ResidueModification& new_mod);
-
-    /**
-       @brief Adds modifications from a given file in OBO format
-
-       @throw Exception::ParseError if the file cannot be parsed correctly
-    */
-    void readFromOBOFile(const String& filename);
-
-    /// Adds modifications from a given file in Unimod XML format
-    void readFromUnimodXMLFile(const String& filename);
   };
 }
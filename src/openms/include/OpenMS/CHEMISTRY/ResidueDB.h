@@ -27,6 +27,12 @@ namespace OpenMS
       @brief OpenMS stores a central database of all residues in the ResidueDB.
       All (unmodified) residues are added to the database on construction.
       Modified residues get created and added if getModifiedResidue is called.
+
+      Lookups of unmodified residues do not take any locks, since they are
+      never changed after construction. Modified residues created at runtime
+      are protected by an OpenMP critical section. A call to freeze() moves
+      them into a read-only part, so that subsequent getModifiedResidue()
+      calls for these residues do not take the lock either.
   */
   class OPENMS_DLLAPI ResidueDB
   {
@@ -104,6 +110,16 @@ public:
     /// returns all residue sets that are registered which this instance
     const std::set<String> getResidueSets() const;
 
+    /**
+       @brief Moves all modified residues created so far into the frozen (lock-free) part of the database
+
+       Call this e.g. after a warm-up (parsing the sequences, setting up the
+       modifications of a search) and before entering a parallel region.
+
+       @warning Not thread-safe: no other thread may access the database while freeze() is running.
+    */
+    void freeze();
+
     //@}
 
     /** @name Predicates
@@ -149,11 +165,18 @@ protected:
     /// adds names of single residue to the index
     void addResidueNames_(const Residue*);
 
-    /// adds names of single modified residue to the index
+    /// adds names of single modified residue to the (runtime) index
     void addModifiedResidueNames_(const Residue*);
-    
+
+    /// returns the residue @p res_name (which has to exist) with modification @p mod, creates it if needed
+    const Residue* getOrCreateModifiedResidue_(const String& res_name, const ResidueModification* mod);
+
+    /// frozen index of modified residues by residue name and modification name (only changed by freeze())
     std::map<String, std::map<String, const Residue*> > residue_mod_names_;
 
+    /// index of modified residues created after the last call to freeze() (protected by the critical section)
+    std::map<String, std::map<String, const Residue*> > runtime_residue_mod_names_;
+
     /// all (unmodified) residues
     std::set<const Residue*> const_residues_;
 
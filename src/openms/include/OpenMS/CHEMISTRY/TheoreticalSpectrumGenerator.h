@@ -32,6 +32,13 @@ namespace OpenMS
       are extended. Therefore it is not recommended to add to or change the PeakSpectrum or these DataArrays
       between calls of the getSpectrum function with the same PeakSpectrum.
 
+      For search engines that score many candidates and usually only need
+      fragment m/z values, getFragmentMZs() provides a lean alternative to
+      getSpectrum(): it works on prefix/suffix residue masses that are computed
+      once per peptide (getPrefixSuffixMasses()) and fills a reusable
+      FragmentBuffer without allocating memory or sorting. Ion names are encoded
+      as integers and only turned into strings on demand (getIonName()).
+
       @note The generation of neutral loss peaks is very slow in this class.
       Something similar to the neutral loss precalculation used in TheoreticalSpectrumGeneratorXLMS
       should be implemented here as well.
@@ -80,6 +87,85 @@ namespace OpenMS
     void updateMembers_() override;
     //@}
 
+    /** @name Lean fragment generation
+     */
+    //@{
+    /// Cumulative residue masses of a peptide (see getPrefixSuffixMasses())
+    struct PrefixSuffixMasses
+    {
+      std::vector<double> prefix; ///< prefix[i]: internal masses of the first i+1 residues, including the N-terminal modification
+      std::vector<double> suffix; ///< suffix[i]: internal masses of the last i+1 residues, including the C-terminal modification
+    };
+
+    /// Reusable output of getFragmentMZs(); keeps its capacity between calls
+    struct FragmentBuffer
+    {
+      std::vector<double> mz; ///< fragment m/z, sorted ascending
+      std::vector<UInt32> ion; ///< encoded ion of each m/z (see getIonName())
+
+      /// One ion series while merging (internal)
+      struct Series
+      {
+        const double* mass;
+        Size pos;
+        Size end;
+        double offset;
+        double charge;
+        double current_mz;
+        UInt32 code;
+      };
+      std::vector<Series> series; ///< scratch space of getFragmentMZs()
+    };
+
+    /// Computes the prefix and suffix masses of @p peptide (reusing the memory of @p masses)
+    static void getPrefixSuffixMasses(const AASequence& peptide, PrefixSuffixMasses& masses);
+
+    /**
+      @brief Generates the m/z values of all fragment ions of a peptide, sorted by m/z
+
+      Ion series and the first prefix ion are chosen according to the parameters
+      (add_b_ions, add_y_ions, ..., add_first_prefix_ion), with charges from
+      @p min_charge to @p max_charge. Each ion series is sorted by construction,
+      so the series are merged instead of sorted.
+
+      Neutral losses, isotope peaks, precursor peaks and immonium ions are not
+      generated (use getSpectrum() for these); intensities are not stored.
+
+      @param masses Prefix/suffix masses of the peptide (see getPrefixSuffixMasses())
+      @param min_charge Minimum fragment charge
+      @param max_charge Maximum fragment charge
+      @param buffer Output; previous content is replaced
+    */
+    void getFragmentMZs(const PrefixSuffixMasses& masses, Int min_charge, Int max_charge, FragmentBuffer& buffer) const;
+
+    /// Encodes ion type, ordinal and charge of a fragment (as stored in FragmentBuffer::ion)
+    static UInt32 encodeIon(Residue::ResidueType res_type, Size ordinal, Int charge)
+    {
+      return (UInt32(res_type) << 24) | (UInt32(charge & 0xFF) << 16) | UInt32(ordinal & 0xFFFF);
+    }
+
+    /// Ion type of an encoded ion
+    static Residue::ResidueType getIonType(UInt32 ion)
+    {
+      return Residue::ResidueType(ion >> 24);
+    }
+
+    /// Ion ordinal (e.g. 3 for b3) of an encoded ion
+    static Size getIonOrdinal(UInt32 ion)
+    {
+      return ion & 0xFFFF;
+    }
+
+    /// Charge of an encoded ion
+    static Int getIonCharge(UInt32 ion)
+    {
+      return Int((ion >> 16) & 0xFF);
+    }
+
+    /// Ion name of an encoded ion as used for getSpectrum() annotations, e.g. "y8++"
+    static String getIonName(UInt32 ion);
+    //@}
+
     protected:
 
     /// adds peaks to a spectrum of the given ion-type, peptide, charge, and intensity, also adds charges and ion names to the DataArrays, if the add_metainfo parameter is set to true
@@ -57,6 +57,9 @@ public:
     /// function call operator, calculates self similarity
     double operator()(const BinnedSpectrum& spec) const override;
 
+    /// similarity of @p query to each spectrum of @p library (the query bins are kept dense for all comparisons)
+    void batchCompare(const BinnedSpectrum& query, const std::vector<const BinnedSpectrum*>& library, std::vector<double>& scores) const override;
+
 protected:
     void updateMembers_() override;
     double precursor_mass_tolerance_;
@@ -13,6 +13,7 @@
 #include <OpenMS/KERNEL/BinnedSpectrum.h>
 
 #include <cmath>
+#include <vector>
 
 namespace OpenMS
 {
@@ -52,6 +53,15 @@ public:
     /// function call operator, calculates self similarity
     virtual double operator()(const BinnedSpectrum& spec) const = 0;
 
+    /**
+      @brief Calculates the similarity of @p query to each spectrum of @p library
+
+      Same as calling operator()(query, *library[i]) for every library spectrum,
+      but functors may prepare @p query only once. @p scores is resized to the
+      size of @p library.
+    */
+    virtual void batchCompare(const BinnedSpectrum& query, const std::vector<const BinnedSpectrum*>& library, std::vector<double>& scores) const;
+
   };
 
 }
@@ -11,8 +11,15 @@
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/KERNEL/StandardTypes.h>
 
+#include <vector>
+
 namespace OpenMS
 {
+  namespace SpectrumComparisonKernels
+  {
+    struct PeakArrays;
+    struct PeakArraysView;
+  }
 
   /**
 
@@ -47,6 +54,23 @@ public:
     /// calculates self similarity
     virtual double operator()(const PeakSpectrum & a) const = 0;
 
+    /**
+      @brief Calculates the similarity of @p query to each spectrum of @p library
+
+      Same as calling operator()(query, *library[i]) for every library spectrum,
+      but functors may prepare @p query only once (e.g. when searching a
+      spectral library). @p scores is resized to the size of @p library.
+    */
+    virtual void batchCompare(const PeakSpectrum & query, const std::vector<const PeakSpectrum*> & library, std::vector<double> & scores) const;
+
+    /**
+      @brief Calculates the similarity of @p query to library spectra that are not stored as PeakSpectrum
+
+      Used for memory-mapped libraries (see SpectralLibraryIndex). By default,
+      each view is copied into a PeakSpectrum and compared with operator().
+    */
+    virtual void batchCompareViews(const PeakSpectrum & query, const std::vector<SpectrumComparisonKernels::PeakArraysView> & library, std::vector<double> & scores) const;
+
   };
 
 }
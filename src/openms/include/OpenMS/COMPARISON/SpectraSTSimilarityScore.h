@@ -13,6 +13,11 @@
 
 namespace OpenMS
 {
+  namespace SpectrumComparisonKernels
+  {
+    class DenseBins;
+    struct BinsView;
+  }
 
   /**
       @brief Similarity score of SpectraST.
@@ -66,6 +71,9 @@ public:
     */
     double operator()(const PeakSpectrum & spec) const override;
 
+    /// normalized dot products of @p query and each spectrum of @p library (the query is binned only once)
+    void batchCompare(const PeakSpectrum & query, const std::vector<const PeakSpectrum*> & library, std::vector<double> & scores) const override;
+
     /**
         @brief Preprocesses the spectrum
 
@@ -89,6 +97,14 @@ public:
     */
     double dot_bias(const BinnedSpectrum & bin1, const BinnedSpectrum & bin2, double dot_product = -1) const;
 
+    /**
+        @brief Dot bias of a query and a pre-binned library spectrum (e.g. of a SpectralLibraryIndex)
+
+        Same result as dot_bias(bin1, bin2, dot_product) for the binned query
+        @p query (see transform()) and the bins @p library of a library spectrum.
+    */
+    double dot_bias(const SpectrumComparisonKernels::DenseBins & query, const SpectrumComparisonKernels::BinsView & library, double dot_product) const;
+
     /**
         @brief calculates the normalized distance between top_hit and runner_up.
         @param top_hit is the best score for a given match.
@@ -113,6 +129,8 @@ public:
 
 protected:
 
+    /// implementation of transform()
+    static BinnedSpectrum binAndNormalize_(const PeakSpectrum & spec);
 
   };
 
@@ -65,10 +65,18 @@ public:
     double operator()(const PeakSpectrum & spec1, const PeakSpectrum & spec2) const override;
 
     double operator()(const PeakSpectrum & spec) const override;
-    // @}
 
+    void batchCompare(const PeakSpectrum & query, const std::vector<const PeakSpectrum*> & library, std::vector<double> & scores) const override;
     // @}
 
+protected:
+
+    /// aligner with the tolerance settings of this score
+    SpectrumAlignment getAligner_() const;
+
+    /// score of two spectra, @p sum1 is the sum of the squared intensities of @p s1
+    double compare_(const PeakSpectrum & s1, double sum1, const PeakSpectrum & s2, const SpectrumAlignment & aligner) const;
+
   };
 
 }
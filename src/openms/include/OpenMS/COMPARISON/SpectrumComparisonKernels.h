@@ -0,0 +1,196 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/KERNEL/BinnedSpectrum.h>
+#include <OpenMS/KERNEL/StandardTypes.h>
+
+#include <cmath>
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Inner loops shared by the spectrum compare functors
+
+    The functors of the COMPARISON module differ in how they weight matching
+    peaks, but they all spend their time in the same few loops: matching two
+    m/z-sorted peak lists within a tolerance, summing intensities and taking
+    dot products of binned spectra. The kernels work on raw arrays instead
+    of Eigen iterators; the spectrum that is compared to many others (the
+    query of a library search) is converted once into a contiguous layout
+    (PeakArrays, DenseBins) that keeps the inner loops tight.
+
+    All kernels visit and accumulate values in the same order as the original
+    implementations of the functors, i.e. scores are bit-identical.
+
+    @ingroup SpectraComparison
+  */
+  namespace SpectrumComparisonKernels
+  {
+    /// The peaks of a spectrum as separate, contiguous m/z and intensity arrays
+    struct OPENMS_DLLAPI PeakArrays
+    {
+      PeakArrays() = default;
+
+      explicit PeakArrays(const PeakSpectrum& spec);
+
+      /// Copies the peaks of @p spec (in the order of the spectrum)
+      void assign(const PeakSpectrum& spec);
+
+      Size size() const
+      {
+        return mz.size();
+      }
+
+      std::vector<double> mz;
+      std::vector<Peak1D::IntensityType> intensity;
+    };
+
+    /// Non-owning view of peaks stored as contiguous m/z and intensity arrays (e.g. in a memory-mapped file)
+    struct PeakArraysView
+    {
+      const double* mz = nullptr;
+      const Peak1D::IntensityType* intensity = nullptr;
+      Size nr_peaks = 0;
+
+      Size size() const
+      {
+        return nr_peaks;
+      }
+    };
+
+    /// Non-owning view of the non-zero bins of a binned spectrum (indices in increasing order)
+    struct BinsView
+    {
+      const UInt32* index = nullptr;
+      const float* value = nullptr;
+      Size nr_bins = 0;
+    };
+
+    /// m/z of peak @p i
+    inline double getMZ(const PeakArrays& peaks, Size i)
+    {
+      return peaks.mz[i];
+    }
+
+    /// m/z of peak @p i
+    inline double getMZ(const PeakArraysView& peaks, Size i)
+    {
+      return peaks.mz[i];
+    }
+
+    /// m/z of peak @p i
+    inline double getMZ(const PeakSpectrum& peaks, Size i)
+    {
+      return peaks[i].getMZ();
+    }
+
+    /// Intensity of peak @p i
+    inline Peak1D::IntensityType getIntensity(const PeakArraysView& peaks, Size i)
+    {
+      return peaks.intensity[i];
+    }
+
+    /// Intensity of peak @p i
+    inline Peak1D::IntensityType getIntensity(const PeakSpectrum& peaks, Size i)
+    {
+      return peaks[i].getIntensity();
+    }
+
+    /// Sum of the intensities
+    OPENMS_DLLAPI double sumOfIntensities(const PeakArrays& peaks);
+
+    /// Sum of the intensities
+    OPENMS_DLLAPI double sumOfIntensities(const PeakSpectrum& peaks);
+
+    /// Sum of the intensities
+    OPENMS_DLLAPI double sumOfIntensities(const PeakArraysView& peaks);
+
+    /// Sum of the squared intensities
+    OPENMS_DLLAPI double sumOfSquaredIntensities(const PeakArrays& peaks);
+
+    /// Sum of the squared intensities
+    OPENMS_DLLAPI double sumOfSquaredIntensities(const PeakSpectrum& peaks);
+
+    /**
+      @brief Calls @p f(i, j) for all pairs of peaks closer than @p tolerance in m/z
+
+      Two-pointer sweep over two m/z-sorted peak lists (PeakArrays or
+      PeakSpectrum, in any combination). With @p Inclusive, pairs exactly
+      @p tolerance apart match as well. Pairs are visited in order of @p i,
+      then @p j.
+    */
+    template <bool Inclusive, typename Peaks1, typename Peaks2, typename MatchFunctor>
+    void forEachMatch(const Peaks1& s1, const Peaks2& s2, double tolerance, MatchFunctor&& f)
+    {
+      const Size n1 = s1.size();
+      const Size n2 = s2.size();
+      Size j_left = 0;
+      for (Size i = 0; i != n1; ++i)
+      {
+        const double pos1 = getMZ(s1, i);
+        for (Size j = j_left; j != n2; ++j)
+        {
+          const double pos2 = getMZ(s2, j);
+          const double diff = std::fabs(pos1 - pos2);
+          if (Inclusive ? diff <= tolerance : diff < tolerance)
+          {
+            f(i, j);
+          }
+          else if (pos2 > pos1)
+          {
+            break;
+          }
+          else
+          {
+            j_left = j;
+          }
+        }
+      }
+    }
+
+    /// Dot product of two bin vectors (same result as BinnedSpectrum::SparseVectorType::dot())
+    OPENMS_DLLAPI float sparseDot(const BinnedSpectrum::SparseVectorType& a, const BinnedSpectrum::SparseVectorType& b);
+
+    /**
+      @brief Dense copy of the bins of one spectrum, for scoring it against many others
+
+      A sparse-sparse dot product has to merge the indices of both vectors.
+      Keeping the query dense turns every dot product into a single pass over
+      the non-zero bins of the other spectrum (a gather). The result is the one
+      of sparseDot(), as long as the intensities are finite.
+    */
+    class OPENMS_DLLAPI DenseBins
+    {
+public:
+      DenseBins() = default;
+
+      explicit DenseBins(const BinnedSpectrum::SparseVectorType& bins);
+
+      /// Sets the bins (the memory is reused between queries)
+      void assign(const BinnedSpectrum::SparseVectorType& bins);
+
+      /// Dot product with @p bins
+      float dot(const BinnedSpectrum::SparseVectorType& bins) const;
+
+      /// Dot product with @p bins
+      float dot(const BinsView& bins) const;
+
+      /// Euclidean norm of the element-wise product with @p bins (same result as cwiseProduct().norm() of the sparse vectors)
+      float productNorm(const BinsView& bins) const;
+
+private:
+      std::vector<float> values_; ///< values up to the highest non-zero bin
+      std::vector<Size> non_zero_; ///< indices set in values_ (to reset them on the next assign())
+    };
+  }
+
+}
@@ -70,6 +70,17 @@ public:
         This function return the similarity score of itself based on SteinScott.
     */
     double operator()(const PeakSpectrum & spec) const override;
+
+    void batchCompare(const PeakSpectrum & query, const std::vector<const PeakSpectrum*> & library, std::vector<double> & scores) const override;
+
+protected:
+    /// score of two spectra, @p sum1 and @p sum3 are the sums of the squared and plain intensities of @p s1
+    double compare_(const SpectrumComparisonKernels::PeakArrays & s1, double sum1, double sum3, const PeakSpectrum & s2) const;
+
+    void updateMembers_() override;
+
+    double tolerance_;
+    float threshold_;
   };
 }
 
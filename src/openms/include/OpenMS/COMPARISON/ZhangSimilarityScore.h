@@ -51,13 +51,28 @@ public:
     double operator()(const PeakSpectrum & spec1, const PeakSpectrum & spec2) const override;
 
     double operator()(const PeakSpectrum & spec) const override;
+
+    void batchCompare(const PeakSpectrum & query, const std::vector<const PeakSpectrum*> & library, std::vector<double> & scores) const override;
+
+    void batchCompareViews(const PeakSpectrum & query, const std::vector<SpectrumComparisonKernels::PeakArraysView> & library, std::vector<double> & scores) const override;
     // @}
 
 protected:
 
+    /// score of two spectra, @p sum1 is the sum of the intensities of @p s1 (@p s2 is a PeakSpectrum or a PeakArraysView)
+    template <typename LibraryPeaks>
+    double compare_(const SpectrumComparisonKernels::PeakArrays & s1, double sum1, const LibraryPeaks & s2) const;
+
     /// returns the factor associated with the m/z tolerance and m/z difference of the peaks
     double getFactor_(double mz_tolerance, double mz_difference, bool is_gaussian = false) const;
 
+    void updateMembers_() override;
+
+    double tolerance_;
+    bool is_relative_tolerance_;
+    bool use_linear_factor_;
+    bool use_gaussian_factor_;
+
 
   };
 
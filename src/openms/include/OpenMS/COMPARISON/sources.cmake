@@ -13,6 +13,7 @@ SpectraSTSimilarityScore.h
 SpectrumAlignment.h
 SpectrumAlignmentScore.h
 SpectrumCheapDPCorr.h
+SpectrumComparisonKernels.h
 SpectrumPrecursorComparator.h
 SteinScottImproveScore.h
 ZhangSimilarityScore.h
@@ -17,6 +17,7 @@
 
 #include <functional>
 #include <fstream>
+#include <future>
 #include <unordered_map>
 #include <memory>
 #include <utility>
@@ -87,14 +88,16 @@ public:
     return chunk_offset_;
   }
 
-  /** @brief Swaps in the background cache of entries, read previously via @p cacheChunk()
+  /** @brief Swaps in the background cache of entries, read previously via @p cacheChunk() or @p prefetchChunk()
       
       If you call this function without a prior call to @p cacheChunk(), the cache will be empty.
+      Waits for a pending @p prefetchChunk() to finish.
       @return true if cache contains data; false if empty
       @note Should be invoked by a single thread, followed by a barrier to sync access of subsequent calls to chunkAt()
   */
   bool activateCache()
   {
+    waitForPrefetch_();
     chunk_offset_ += data_fg_.size();
     data_fg_.swap(data_bg_);
     data_bg_.clear(); // just in case someone calls activateCache() multiple times...
@@ -109,17 +112,20 @@ public:
   */
   bool cacheChunk(int suggested_size)
   {
-    data_bg_.clear();
-    data_bg_.reserve(suggested_size);
-    FASTAFile::FASTAEntry p;
-    for (int i = 0; i < suggested_size; ++i)
-    {
-      std::streampos spos = f_.position();
-      if (!f_.readNext(p)) break;
-      data_bg_.push_back(std::move(p));
-      offsets_.push_back(spos);
-    }
-    return !data_bg_.empty();
+    waitForPrefetch_();
+    return readChunk_(suggested_size);
+  }
+
+  /** @brief Same as @p cacheChunk(), but reads the entries in a background thread and returns immediately
+
+     Use this to read the next chunk from disk while the active chunk is processed.
+     The next call to @p activateCache() waits until reading is done. Exceptions during reading are rethrown there.
+     @param suggested_size Number of FASTA entries to read from disk
+  */
+  void prefetchChunk(int suggested_size)
+  {
+    waitForPrefetch_();
+    prefetch_ = std::async(std::launch::async, [this, suggested_size]() { readChunk_(suggested_size); });
   }
 
   /// number of entries in active cache
@@ -162,6 +168,7 @@ public:
       return true;
     }
     // read anew from disk...
+    waitForPrefetch_();
     if (pos >= offsets_.size())
     {
       throw Exception::IndexOverflow(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, pos, offsets_.size());
@@ -176,12 +183,15 @@ public:
   /// is the FASTA file empty?
   bool empty()
   { // trusting the FASTA file can be read...
+    waitForPrefetch_();
     return f_.atEnd() && offsets_.empty();
   }
 
   /// resets reading of the FASTA file, enables fresh reading of the FASTA from the beginning
   void reset()
   {
+    if (prefetch_.valid()) prefetch_.wait(); // errors of the old file position do not matter any longer
+    prefetch_ = std::future<void>();
     offsets_.clear();
     data_fg_.clear();
     data_bg_.clear();
@@ -197,16 +207,40 @@ public:
   */
   size_t size() const
   {
+    if (prefetch_.valid()) prefetch_.wait();
     return offsets_.size();
   }
 
 private:
+  /// read up to @p suggested_size entries into the background cache
+  bool readChunk_(int suggested_size)
+  {
+    data_bg_.clear();
+    data_bg_.reserve(suggested_size);
+    FASTAFile::FASTAEntry p;
+    for (int i = 0; i < suggested_size; ++i)
+    {
+      std::streampos spos = f_.position();
+      if (!f_.readNext(p)) break;
+      data_bg_.push_back(std::move(p));
+      offsets_.push_back(spos);
+    }
+    return !data_bg_.empty();
+  }
+
+  /// wait for a pending prefetchChunk() to finish; rethrows its exception (if any)
+  void waitForPrefetch_()
+  {
+    if (prefetch_.valid()) prefetch_.get();
+  }
+
   FASTAFile f_; ///< FASTA file connection
   std::vector<std::streampos> offsets_; ///< internal byte offsets into FASTA file for random access reading of previous entries.
   std::vector<FASTAFile::FASTAEntry> data_fg_; ///< active (foreground) data
   std::vector<FASTAFile::FASTAEntry> data_bg_; ///< prefetched (background) data; will become the next active data
   size_t chunk_offset_; ///< number of entries before the current chunk
   std::string filename_;///< FASTA file name
+  std::future<void> prefetch_; ///< pending background read started by prefetchChunk(); declared last, so it is finished before the other members are destroyed
 };
 
 /**
@@ -264,6 +298,12 @@ public:
     return false; 
   }
 
+  /// same as cacheChunk()
+  void prefetchChunk(int suggested_size)
+  {
+    cacheChunk(suggested_size);
+  }
+
   /** @brief active data spans the full range, i.e. size of container
       
       @return the size of the underlying vector
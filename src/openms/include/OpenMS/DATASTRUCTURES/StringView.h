@@ -44,6 +44,11 @@ namespace OpenMS
     {
     }
 
+    // create view on @p size characters starting at @p begin
+    StringView(const char* begin, Size size) : begin_(begin), size_(size)
+    {
+    }
+
     /// less operator
     bool operator<(const StringView other) const
     {
@@ -0,0 +1,137 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/INTERFACES/IIdentificationConsumer.h>
+
+#include <OpenMS/FORMAT/IdXMLFile.h>
+
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace OpenMS
+{
+    /**
+      @brief Consumer class that writes identifications to disk using the idXML format.
+
+      The IdXMLWritingConsumer writes peptide identifications to disk as soon
+      as they are consumed, i.e. only protein identifications (runs) are kept
+      in memory. Together with IdXMLFile::transform() it allows processing
+      large idXML files with bounded memory:
+
+      @code
+      IdXMLWritingConsumer writer(out_file);
+      MyFilteringConsumer consumer(&writer); // some implementation, forwards to the writer
+      IdXMLFile().transform(in_file, &consumer);
+      writer.close();
+      @endcode
+
+      Since idXML stores the peptide identifications inside the run they
+      belong to and all search parameters in front of the runs, peptide
+      identifications are spooled to one temporary file per run. The output
+      file is assembled when close() is called (or the consumer is
+      destroyed). The result is identical to IdXMLFile::store() with all
+      consumed identifications.
+
+      @note A protein identification has to be consumed before the peptide
+      identifications that refer to it (as done by IdXMLFile::transform()).
+      Peptide identifications of unknown runs and peptide identifications
+      without hits are omitted (with a warning), like in IdXMLFile::store().
+    */
+    class OPENMS_DLLAPI IdXMLWritingConsumer :
+      public Interfaces::IIdentificationConsumer
+    {
+
+    public:
+      /**
+        @brief Constructor
+
+        @param filename Filename for the output idXML
+
+        @exception Exception::UnableToCreateFile is thrown if the file could not be created
+      */
+      explicit IdXMLWritingConsumer(const String& filename);
+
+      /// Destructor (writes the file if close() was not called)
+      ~IdXMLWritingConsumer() override;
+
+      /// @name IIdentificationConsumer interface
+      //@{
+      void setDocumentIdentifier(const String& document_id) override;
+
+      /**
+        @brief Consume a protein identification (run)
+
+        @exception Exception::ParseError is thrown if a run with the same identifier was consumed before
+      */
+      void consumeProteinIdentification(ProteinIdentification& prot_id) override;
+
+      /**
+        @brief Consume a batch of peptide identifications
+
+        The peptide identifications are written to disk immediately.
+
+        @exception Exception::ElementNotFound is thrown if a protein accession of a hit is unknown
+      */
+      void consumePeptideIdentifications(std::vector<PeptideIdentification>& pep_ids) override;
+      //@}
+
+      /**
+        @brief Writes the idXML file
+
+        No identifications can be consumed afterwards. Calling close() again has no effect.
+      */
+      void close();
+
+      /// Returns the number of peptide identifications written
+      Size getNrPeptideIdentificationsWritten() const;
+
+    protected:
+
+      /// A run: its IdentificationRun/ProteinIdentification element and the spool file of its peptide identifications
+      struct Run_
+      {
+        String identifier;
+        String protein_xml;
+        String spool_file;
+        std::ofstream spool;
+      };
+
+      /// Output filename
+      String filename_;
+      /// Output file stream (opened by the constructor)
+      std::ofstream ofs_;
+      /// Handler providing the idXML writing functions
+      IdXMLFile handler_;
+      /// Document identifier
+      String document_id_;
+      /// Distinct search parameters of the runs (in order of first occurrence)
+      std::vector<ProteinIdentification::SearchParameters> params_;
+      /// Consumed runs
+      std::vector<std::unique_ptr<Run_>> runs_;
+      /// Index of each run in runs_ (key: identifier)
+      std::unordered_map<String, Size> run_index_;
+      /// Id (PH_<id>) of every protein accession
+      std::unordered_map<std::string, UInt> accession_to_id_;
+      /// Number of protein hits written
+      UInt prot_count_;
+      /// Number of peptide identifications written
+      Size pep_ids_written_;
+      /// Number of peptide identifications omitted because of empty hits
+      Size count_empty_;
+      /// Number of peptide identifications omitted because of an unknown run
+      Size count_unknown_run_;
+      /// Whether close() was called
+      bool closed_;
+    };
+
+} //end namespace OpenMS
+
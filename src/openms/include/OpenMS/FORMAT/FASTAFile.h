@@ -149,6 +149,8 @@ namespace OpenMS
         /**
           @brief loads a FASTA file given by 'filename' and stores the information in 'data'
           This uses more RAM than readStart() and readNext().
+          The file is memory-mapped and split into chunks at entry boundaries, which are parsed in parallel.
+          The order of the entries is the same as in the file.
           @exception Exception::FileNotFound is thrown if the file does not exists.
           @exception Exception::ParseError is thrown if the file does not suit to the standard.
         */
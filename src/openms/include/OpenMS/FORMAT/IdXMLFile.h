@@ -13,11 +13,15 @@
 #include <OpenMS/METADATA/PeptideIdentification.h>
 #include <OpenMS/FORMAT/HANDLERS/XMLHandler.h>
 #include <OpenMS/FORMAT/XMLFile.h>
+#include <OpenMS/INTERFACES/IIdentificationConsumer.h>
 
+#include <unordered_map>
 #include <vector>
 
 namespace OpenMS
 {
+  class IdXMLWritingConsumer;
+
   namespace Internal
   {
     class FeatureXMLHandler;
@@ -46,6 +50,8 @@ public:
     // both ConsensusXMLFile and FeatureXMLFile use some protected IdXML helper functions to parse identifications without code duplication
     friend class Internal::ConsensusXMLHandler;
     friend class Internal::FeatureXMLHandler;
+    // writes idXML incrementally using the store() helper functions
+    friend class IdXMLWritingConsumer;
 
     /// Constructor
     IdXMLFile();
@@ -82,6 +88,27 @@ public:
     */
     void store(const String& filename, const std::vector<ProteinIdentification>& protein_ids, const std::vector<PeptideIdentification>& peptide_ids, const String& document_id = "");
 
+    /**
+        @brief Transforms an idXML file while loading using the supplied IIdentificationConsumer
+
+        The identifications are not stored, but handed to the consumer as soon
+        as they are read: the document identifier first, then every protein
+        identification (run), each followed by the peptide identifications of
+        the run in batches of (at most) @p batch_size. Only the current batch
+        of peptide identifications is kept in memory, i.e. large files can be
+        processed with bounded memory (see e.g. IdXMLWritingConsumer).
+
+        The consumer receives the same objects (in the same order) as load() would return.
+
+        @param filename Filename of the idXML file to transform
+        @param consumer Consumer class to operate on the identifications
+        @param batch_size Maximum number of peptide identifications consumed at once
+
+        @exception Exception::FileNotFound is thrown if the file could not be opened
+        @exception Exception::ParseError is thrown if an error occurs during parsing
+    */
+    void transform(const String& filename, Interfaces::IIdentificationConsumer* consumer, Size batch_size = 10000);
+
 
 protected:
     // Docu in base class
@@ -122,7 +149,50 @@ protected:
       * Helper function to parse fragment annotations from string
       */  
     static void parseFragmentAnnotation_(const String& s, std::vector<PeptideHit::PeakAnnotation> & annotations);
-    
+
+    /// @name helper functions for storing data (also used by IdXMLWritingConsumer)
+    //@{
+    /// Writes the XML header and the opening IdXML tag
+    void writeHeader_(std::ostream& os, const String& document_id) const;
+
+    /// Writes the (distinct) search parameters @p params with ids "SP_<index>" (or a placeholder if there are none)
+    void writeSearchParameters_(std::ostream& os, const std::vector<ProteinIdentification::SearchParameters>& params) const;
+
+    /**
+      @brief Opens the IdentificationRun of @p prot_id and writes its ProteinIdentification
+
+      Protein hits are numbered consecutively starting at @p prot_count (which is updated), their
+      ids are added to @p accession_to_id. The IdentificationRun is left open for the peptide
+      identifications of the run.
+    */
+    void writeProteinIdentification_(std::ostream& os, const ProteinIdentification& prot_id,
+                                     const std::vector<ProteinIdentification::SearchParameters>& params,
+                                     UInt& prot_count, std::unordered_map<std::string, UInt>& accession_to_id);
+
+    /**
+      @brief Writes the PeptideIdentification @p pep_id (hits sorted by score) of the run @p run_identifier
+
+      @exception Exception::ElementNotFound is thrown if a protein accession is not contained in @p accession_to_id
+    */
+    void writePeptideIdentification_(std::ostream& os, const PeptideIdentification& pep_id, const String& run_identifier,
+                                     const std::unordered_map<std::string, UInt>& accession_to_id) const;
+    //@}
+
+    /// @name helper functions for loading data
+    //@{
+    /// Adds a protein identification (run); in transform() mode it is handed to the consumer instead
+    void addProteinIdentification_(ProteinIdentification&& prot_id);
+
+    /// Hands the pending peptide identifications to the consumer (transform() mode only)
+    void flushPeptideIdentifications_();
+
+    /// Returns the MetaInfoRegistry index of the meta value @p name (cached, avoids the synchronized registry lookup)
+    UInt metaIndex_(const String& name);
+
+    /// Resets all members used during loading
+    void resetMembers_();
+    //@}
+
 
     /// @name members for loading data
     //@{
@@ -156,6 +226,12 @@ protected:
     String* document_id_;
     /// true if a prot id is contained in the current run
     bool prot_id_in_run_;
+    /// Consumer of the identifications (transform() mode), nullptr otherwise
+    Interfaces::IIdentificationConsumer* consumer_;
+    /// Number of peptide identifications consumed at once (transform() mode)
+    Size batch_size_;
+    /// Cache of MetaInfoRegistry indices of meta value names
+    std::unordered_map<String, UInt> meta_key_index_;
     //@}
   };
 
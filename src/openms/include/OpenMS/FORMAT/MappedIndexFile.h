@@ -0,0 +1,234 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+  namespace Internal
+  {
+    /**
+      @brief File layout shared by the memory-mappable index files (DigestStore, SpectralLibraryIndex, MetaboliteSpectralLibraryIndex)
+
+      A file consists of a header, the sizes of the data sections, a
+      fingerprint of the settings the content depends on, a string pool and
+      the data sections of the format (arrays of fixed-size records), each
+      part 8-byte aligned. The header identifies the format (magic bytes and
+      version) and the source file the index was created from: by size and
+      modification time and, if those differ, by the SHA1 checksum of its
+      content (see isUpToDate()).
+
+      Files are written with Writer and mapped into memory with open().
+
+      @note The file uses the byte order of the machine it was written on.
+    */
+    class OPENMS_DLLAPI MappedIndexFile
+    {
+protected:
+
+      /// File header, followed by the section sizes (UInt64)
+      struct Header
+      {
+        char magic[8];
+        UInt32 version;
+        UInt32 nr_sections;
+        UInt64 fingerprint_size;
+        UInt64 nr_strings;
+        UInt64 string_bytes;
+        UInt64 source_size;
+        Int64 source_mtime;
+        char source_sha1[40];
+      };
+
+public:
+
+      /// Index into the string pool
+      typedef UInt32 StringIndex;
+
+      /// Describes a format
+      struct OPENMS_DLLAPI Format
+      {
+        char magic[8];
+        UInt32 version;
+        UInt32 nr_sections; ///< number of data sections
+        const char* name; ///< used in messages, e.g. "digest store"
+
+        /**
+          @brief Returns @p value as UInt32
+
+          @exception Exception::InvalidValue is thrown if @p value exceeds the limit of the format (@p items is used in the message)
+        */
+        UInt32 checkedUInt32(Size value, const char* items) const;
+      };
+
+      /// Interns strings into a pool, index 0 is the empty string
+      class OPENMS_DLLAPI StringPool
+      {
+  public:
+        explicit StringPool(const Format& format);
+
+        /**
+          @brief Returns the index of @p s, adds it if necessary
+
+          @exception Exception::InvalidValue is thrown if the pool exceeds 2^32 strings
+        */
+        StringIndex add(const std::string& s);
+
+        const std::vector<std::string>& strings() const;
+
+  private:
+        const Format& format_;
+        std::unordered_map<std::string, StringIndex> index_;
+        std::vector<std::string> strings_;
+      };
+
+      /**
+        @brief Writes a file section by section
+
+        The data are written to a temporary file, which is moved into place by
+        commit(), so concurrent readers never see a partial file.
+      */
+      class OPENMS_DLLAPI Writer
+      {
+  public:
+        /**
+          @brief Starts writing @p filename: writes @p fingerprint and the string pool
+
+          @p source_file is recorded for isUpToDate() (may be empty).
+
+          @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+        */
+        Writer(const Format& format, const String& filename, const String& source_file, const String& fingerprint, const StringPool& strings);
+
+        /// Removes the temporary file unless the file was committed
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        /// Appends @p bytes to the current section
+        void append(const void* data, UInt64 bytes);
+
+        /// Completes the current section
+        void endSection();
+
+        /// Writes @p data as one section
+        template <typename T>
+        void addSection(const std::vector<T>& data)
+        {
+          append(data.data(), data.size() * sizeof(T));
+          endSection();
+        }
+
+        /**
+          @brief Completes the file and moves it into place (all sections of the format have to be written)
+
+          @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+        */
+        void commit();
+
+  private:
+        const Format& format_;
+        String filename_;
+        String tmp_filename_;
+        std::ofstream os_;
+        Header header_;
+        std::vector<UInt64> section_sizes_;
+        UInt64 current_size_ = 0;
+        bool committed_ = false;
+      };
+
+      /// Constructor (no file opened)
+      explicit MappedIndexFile(const Format& format);
+
+      /// Destructor (unmaps the file)
+      ~MappedIndexFile();
+
+      MappedIndexFile(const MappedIndexFile&) = delete;
+      MappedIndexFile& operator=(const MappedIndexFile&) = delete;
+
+      /**
+        @brief Whether @p filename is a complete file of @p format with @p fingerprint, created from the current version of @p source_file
+
+        Returns false if no source file was recorded.
+      */
+      static bool isUpToDate(const Format& format, const String& filename, const String& source_file, const String& fingerprint);
+
+      /**
+        @brief Memory-maps a file and checks its layout
+
+        @exception Exception::FileNotFound is thrown if the file does not exist
+        @exception Exception::FileNotReadable is thrown if the file cannot be mapped
+        @exception Exception::ParseError is thrown if the file is not a valid file of the format
+      */
+      void open(const String& filename);
+
+      /// Whether a file is currently mapped
+      bool isOpen() const;
+
+      /// Unmaps the file
+      void close();
+
+      /**
+        @brief Data section @p index as array of @p T, stores its length in @p count
+
+        @exception Exception::ParseError is thrown if the section size is not a multiple of the record size
+      */
+      template <typename T>
+      const T* getSection(Size index, Size& count) const
+      {
+        checkRecordSize_(index, sizeof(T));
+        count = section_sizes_[index] / sizeof(T);
+        return reinterpret_cast<const T*>(sections_[index]);
+      }
+
+      /// Number of strings in the pool
+      Size getNrStrings() const;
+
+      /// Returns string @p index of the pool (valid as long as the file is mapped)
+      std::string_view getString(StringIndex index) const;
+
+      /// Half-open range [first, last) of the @p records (sorted by @p key) with a key in [@p min_key, @p max_key]
+      template <typename Record, typename Key>
+      static std::pair<Size, Size> getRange(const Record* records, Size count, double min_key, double max_key, Key key)
+      {
+        const Record* end = records + count;
+        const Record* first = std::partition_point(records, end, [&](const Record& r) { return key(r) < min_key; });
+        const Record* last = std::partition_point(first, end, [&](const Record& r) { return key(r) <= max_key; });
+        return {Size(first - records), Size(last - records)};
+      }
+
+protected:
+
+      /// Throws a ParseError if the size of section @p index is not a multiple of @p record_size
+      void checkRecordSize_(Size index, Size record_size) const;
+
+      const Format& format_;
+      boost::iostreams::mapped_file_source file_;
+
+      const UInt64* string_offsets_ = nullptr;
+      const char* string_data_ = nullptr;
+      Size nr_strings_ = 0;
+      std::vector<const char*> sections_;
+      std::vector<UInt64> section_sizes_;
+    };
+
+  } // namespace Internal
+} // namespace OpenMS
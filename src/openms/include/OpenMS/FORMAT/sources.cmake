@@ -61,6 +61,7 @@ MascotInfile.h
 MascotGenericFile.h
 MascotRemoteQuery.h
 MascotXMLFile.h
+MappedIndexFile.h
 MsInspectFile.h
 MzDataFile.h
 MzMLFile.h
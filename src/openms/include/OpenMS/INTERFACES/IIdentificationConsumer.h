@@ -0,0 +1,83 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/config.h>
+#include <OpenMS/CONCEPT/Types.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+  class String;
+  class ProteinIdentification;
+  class PeptideIdentification;
+
+namespace Interfaces
+{
+
+    /**
+      @brief The interface of a consumer of identification data
+
+      The identification consumer is able to consume ProteinIdentification
+      and PeptideIdentification objects and process them (it may modify
+      them). Analogous to IMSDataConsumer for spectra, it may be used when
+      identifications are read sequentially (e.g. by
+      IdXMLFile::transform()) and should be processed without ever holding
+      the full set of peptide identifications in memory.
+
+      Peptide identifications are consumed in batches. The protein
+      identification (run) a peptide identification refers to (via its
+      identifier) is always consumed @a before the peptide identification
+      itself, and all peptide identifications of a run are consumed before
+      the next run starts.
+
+      Implementations in OpenMS can be found in OpenMS/FORMAT/DATAACCESS
+
+      @note The member function setDocumentIdentifier is expected to be
+      called before consuming starts.
+    */
+    class OPENMS_DLLAPI IIdentificationConsumer
+    {
+    public:
+      virtual ~IIdentificationConsumer() {}
+
+      /**
+        @brief Set the identifier of the document the identifications are read from
+
+        @note Calling this method is optional.
+
+        @param document_id Document identifier (may be empty)
+      */
+      virtual void setDocumentIdentifier(const String& document_id) = 0;
+
+      /**
+        @brief Consume a protein identification (i.e. one identification run)
+
+        The protein identification will be consumed by the implementation and possibly modified.
+
+        @param prot_id The protein identification to be consumed
+      */
+      virtual void consumeProteinIdentification(ProteinIdentification& prot_id) = 0;
+
+      /**
+        @brief Consume a batch of peptide identifications
+
+        The peptide identifications will be consumed by the implementation and
+        possibly modified (or moved from). A batch only contains peptide
+        identifications of a single run.
+
+        @param pep_ids The peptide identifications to be consumed
+      */
+      virtual void consumePeptideIdentifications(std::vector<PeptideIdentification>& pep_ids) = 0;
+    };
+
+} //end namespace Interfaces
+} //end namespace OpenMS
+
@@ -0,0 +1,282 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/METADATA/PeptideIdentification.h>
+
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Column-oriented table of peptide-spectrum matches (PSMs)
+
+    Post-search processing (FDR estimation, score filtering, best-per-peptide
+    reduction, score switching) only needs a handful of properties of every
+    PeptideHit. This class stores them in contiguous columns with one row per
+    hit, which is much more compact than a vector of PeptideIdentification
+    and can be processed in parallel:
+
+    - row columns: score, target/decoy annotation, charge, rank, sequence and
+      spectrum (index of the PeptideIdentification the hit belongs to)
+    - sequences are interned, i.e. every distinct (modified) sequence is
+      stored once; the unmodified sequence of each entry is interned as well
+    - spectrum columns: run identifier, spectrum reference, RT and m/z
+    - meta columns: selected meta values of the hits, either numeric (double;
+      NaN if missing) or string (interned; MISSING if missing)
+
+    Rows are always grouped by spectrum (in ascending order), all row
+    operations keep this invariant.
+
+    A table is filled from and written back to the same vector of
+    PeptideIdentification (see importIDs() and exportIDs()). Properties that
+    are not part of the table (peptide evidences, other meta values, ...)
+    stay untouched in the PeptideHits, which are only reordered, removed or
+    updated on export.
+
+    See FalseDiscoveryRate, IDFilter and IDScoreSwitcherAlgorithm for
+    algorithms that work on the table.
+
+    @ingroup Metadata
+  */
+  class OPENMS_DLLAPI PSMTable
+  {
+public:
+
+    /// Target/decoy annotation of a row (meta value "target_decoy")
+    enum class TargetDecoy : uint8_t
+    {
+      UNKNOWN, ///< no annotation
+      TARGET,
+      DECOY,
+      TARGET_DECOY, ///< "target+decoy", i.e. maps to target and decoy proteins
+      INVALID ///< any other annotation
+    };
+
+    /// Marks missing entries in string columns
+    static constexpr UInt32 MISSING = std::numeric_limits<UInt32>::max();
+
+    /// Default constructor (empty table)
+    PSMTable() = default;
+
+    /// Removes all rows, spectra and columns
+    void clear();
+
+    /**
+      @brief Fills the table with all hits of @p ids
+
+      All identifications with hits must use the same score type and score
+      orientation.
+
+      @param ids The peptide identifications (one spectrum each)
+      @param meta_keys Names of meta values of the hits that are loaded as
+      meta columns. The column type is taken from the first hit that has the
+      meta value (integer and double values: numeric column, all others:
+      string column).
+
+      @exception Exception::IllegalArgument is thrown if score types or orientations differ
+    */
+    void importIDs(const std::vector<PeptideIdentification>& ids, const StringList& meta_keys = StringList());
+
+    /**
+      @brief Whether all identifications with hits in @p ids use the same score type and orientation, i.e. whether they can be imported
+
+      Results of different search engines that were merged without switching
+      to a common score do not; they have to be processed per identification.
+    */
+    static bool hasUniformScoreType(const std::vector<PeptideIdentification>& ids);
+
+    /**
+      @brief Writes the table back to the identifications it was imported from
+
+      The hits of every identification are replaced by the hits of its rows
+      (in row order) with score and rank of the row. Meta columns that were
+      added or modified (see getNumericColumn()) are stored as meta values;
+      missing values are skipped. All identifications receive the score type
+      and orientation of the table.
+
+      Afterwards the table refers to the updated hits, i.e. processing can be
+      continued and the table exported again.
+
+      @exception Exception::IllegalArgument is thrown if @p ids does not match the number of spectra
+    */
+    void exportIDs(std::vector<PeptideIdentification>& ids);
+
+    /// Number of rows (hits)
+    Size size() const;
+
+    /// Whether the table has no rows
+    bool empty() const;
+
+    /// Number of spectra (i.e. PeptideIdentifications, including those without hits)
+    Size getNrSpectra() const;
+
+    /// @name Score type
+    //@{
+    const String& getScoreType() const;
+    void setScoreType(const String& type);
+    bool isHigherScoreBetter() const;
+    void setHigherScoreBetter(bool higher_better);
+    //@}
+
+    /// @name Row columns
+    //@{
+    const std::vector<double>& getScores() const;
+    std::vector<double>& getScores();
+    const std::vector<TargetDecoy>& getTargetDecoy() const;
+    const std::vector<Int>& getCharges() const;
+    const std::vector<UInt32>& getRanks() const;
+    /// Sequence id (see getSequence()) of every row
+    const std::vector<UInt32>& getSequenceIds() const;
+    /// Spectrum index of every row
+    const std::vector<UInt32>& getSpectrumIndices() const;
+    //@}
+
+    /// @name Sequences
+    //@{
+    /// Number of distinct (modified and unmodified) sequences
+    Size getNrSequences() const;
+    /// Sequence @p id as string (AASequence::toString())
+    const String& getSequence(UInt32 id) const;
+    /// Id of the unmodified version of sequence @p id (same as @p id for unmodified sequences)
+    UInt32 getUnmodifiedSequenceId(UInt32 id) const;
+    //@}
+
+    /// @name Spectrum columns
+    //@{
+    const String& getRunIdentifier(Size spectrum) const;
+    const String& getSpectrumReference(Size spectrum) const;
+    double getRT(Size spectrum) const;
+    double getMZ(Size spectrum) const;
+    /// Index of the run (in order of first occurrence) of @p spectrum
+    UInt32 getRunIndex(Size spectrum) const;
+    /// Number of distinct run identifiers
+    Size getNrRuns() const;
+    /**
+      @brief Row offsets of the spectra
+
+      Rows of spectrum @em i are [offsets[i], offsets[i + 1]); the vector has
+      getNrSpectra() + 1 entries.
+    */
+    std::vector<Size> getSpectrumOffsets() const;
+    //@}
+
+    /// @name Meta columns
+    //@{
+    bool hasNumericColumn(const String& name) const;
+    bool hasStringColumn(const String& name) const;
+    /// Names of all meta columns (numeric and string)
+    StringList getColumnNames() const;
+
+    /**
+      @brief Returns the numeric column @p name
+
+      @exception Exception::ElementNotFound is thrown if the column does not exist
+    */
+    const std::vector<double>& getNumericColumn(const String& name) const;
+
+    /**
+      @brief Returns the numeric column @p name for modification
+
+      The column is written back by exportIDs().
+
+      @exception Exception::ElementNotFound is thrown if the column does not exist
+    */
+    std::vector<double>& getNumericColumn(const String& name);
+
+    /**
+      @brief Adds the numeric column @p name (all values missing) or returns it if it already exists
+
+      The column is written back by exportIDs(); integer columns are stored as integer meta values.
+    */
+    std::vector<double>& addNumericColumn(const String& name, bool integer = false);
+
+    /**
+      @brief Returns the string column @p name (ids for getString(), or MISSING)
+
+      @exception Exception::ElementNotFound is thrown if the column does not exist
+    */
+    const std::vector<UInt32>& getStringColumn(const String& name) const;
+
+    /// Value of a string column entry
+    const String& getString(UInt32 id) const;
+    //@}
+
+    /// @name Row operations
+    //@{
+    /**
+      @brief Keeps only the rows with nonzero @p keep entries (order is preserved)
+
+      @exception Exception::InvalidSize is thrown if @p keep does not have one entry per row
+    */
+    void filterRows(const std::vector<uint8_t>& keep);
+
+    /// Sorts the rows of every spectrum by score (best first, stable)
+    void sortHits();
+
+    /// Sorts the rows of every spectrum by score and assigns ranks (equal scores share a rank), like PeptideIdentification::assignRanks()
+    void assignRanks();
+    //@}
+
+protected:
+
+    struct NumericColumn
+    {
+      std::vector<double> values;
+      bool integer = false;
+      bool modified = false;
+    };
+
+    /// Reorders all row columns: row @em i becomes old row @p rows[i]
+    void gatherRows_(const std::vector<UInt32>& rows);
+
+    /// Returns the id of @p s in the sequence pool (adds it if necessary)
+    UInt32 internSequence_(const String& s);
+
+    /// Returns the id of @p s in the string pool (adds it if necessary)
+    UInt32 internString_(const String& s);
+
+    String score_type_;
+    bool higher_score_better_ = true;
+
+    // row columns
+    std::vector<double> score_;
+    std::vector<TargetDecoy> target_decoy_;
+    std::vector<Int> charge_;
+    std::vector<UInt32> rank_;
+    std::vector<UInt32> sequence_;
+    std::vector<UInt32> spectrum_;
+    std::vector<UInt32> hit_; ///< index of the hit in its PeptideIdentification
+
+    // interned sequences
+    std::vector<String> sequences_;
+    std::vector<UInt32> unmodified_;
+    std::unordered_map<String, UInt32> sequence_ids_;
+
+    // spectrum columns
+    std::vector<UInt32> spectrum_run_;
+    std::vector<String> spectrum_reference_;
+    std::vector<double> rt_;
+    std::vector<double> mz_;
+    std::vector<String> runs_;
+
+    // meta columns
+    std::map<String, NumericColumn> numeric_columns_;
+    std::map<String, std::vector<UInt32>> string_columns_;
+    std::vector<String> strings_;
+    std::unordered_map<String, UInt32> string_ids_;
+  };
+
+} // namespace OpenMS
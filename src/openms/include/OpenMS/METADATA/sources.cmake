@@ -33,6 +33,7 @@ Modification.h
 PeptideEvidence.h
 PeptideHit.h
 PeptideIdentification.h
+PSMTable.h
 Precursor.h
 Product.h
 ProteinHit.h
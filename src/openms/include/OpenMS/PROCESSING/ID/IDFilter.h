@@ -29,6 +29,8 @@
 
 namespace OpenMS
 {
+  class PSMTable;
+
   /**
     @brief Collection of functions for filtering peptide and protein identifications.
 
@@ -1234,6 +1236,35 @@ namespace OpenMS
     ///@}
 
 
+    /// @name Filter functions for class PSMTable
+    ///@{
+
+    /**
+      @brief Keeps only rows with a score at least as good as @p threshold_score
+
+      The score orientation of the table is taken into account.
+    */
+    static void filterHitsByScore(PSMTable& table, double threshold_score);
+
+    /// Keeps the @p n best rows of every spectrum (the rows are sorted by score)
+    static void keepNBestHits(PSMTable& table, Size n);
+
+    /// Removes rows annotated as decoys (meta value "target_decoy" is "decoy")
+    static void removeDecoyHits(PSMTable& table);
+
+    /**
+      @brief Keeps only the best row for every peptide sequence
+
+      Same as keepBestPerPeptide() for PeptideIdentifications: only the @p
+      nr_best_spectrum best rows of each spectrum (0: all) are considered,
+      ties are resolved in favor of the first row. The remaining rows are
+      annotated with "best_per_peptide" = 1.
+    */
+    static void keepBestPerPeptide(PSMTable& table, bool ignore_mods, bool ignore_charges, Size nr_best_spectrum);
+
+    ///@}
+
+
     /// @name Filter functions for class IdentificationData
     ///@{
     /*!
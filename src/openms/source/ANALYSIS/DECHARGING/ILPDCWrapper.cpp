@@ -14,7 +14,9 @@
 #include <OpenMS/DATASTRUCTURES/MassExplainer.h>
 #include <OpenMS/SYSTEM/StopWatch.h>
 #include <OpenMS/KERNEL/FeatureMap.h>
+#include <OpenMS/config.h>
 
+#include <algorithm>
 #include <fstream>
 #include <map>
 
@@ -35,8 +37,7 @@ namespace OpenMS
 
     PairsType pairs_clique_ordered;
     pairs_clique_ordered.reserve(pairs.size());
-    typedef std::vector<std::pair<Size, Size> > BinType;
-    BinType bins;
+    RangesType components; // edges of each connected component
     // check number of components for complete putative edge graph (usually not all will be set to 'active' during ILP):
     {
       //
@@ -113,46 +114,16 @@ namespace OpenMS
         }
       }
 
-      /* partition the cliques into bins, one given to the ILP at a time */
-      UInt pairs_per_bin = 1000;
-      UInt big_clique_bin_threshold = 200;
-
-      Size start(0);
-      Size count(0);
+      // lay out the edges component by component (each component is a contiguous range of edges)
       for (std::map<Size, std::set<Size> >::const_iterator it = g2pairs.begin(); it != g2pairs.end(); ++it)
       {
-        Size clique_size = it->second.size();
-        if (count > pairs_per_bin || clique_size > big_clique_bin_threshold)
-        {
-          if (count > 0) // either bin is full or we have to close it due to big clique
-          {
-            if (verbose_level > 2)
-              OPENMS_LOG_INFO << "Overstepping border of " << pairs_per_bin << " by " << SignedSize(count - pairs_per_bin) << " elements!\n";
-            bins.push_back(std::make_pair(start, pairs_clique_ordered.size()));
-            start = pairs_clique_ordered.size();
-            count = 0;
-          }
-          if (clique_size > big_clique_bin_threshold) // extra bin for this big clique
-          {
-            for (std::set<Size>::const_iterator i_p = it->second.begin(); i_p != it->second.end(); ++i_p)
-            {
-              pairs_clique_ordered.push_back(pairs[*i_p]);
-            }
-            if (verbose_level > 2)
-              OPENMS_LOG_INFO << "Extra bin for big clique (" << clique_size << ") prepended to schedule\n";
-            bins.insert(bins.begin(), std::make_pair(start, pairs_clique_ordered.size()));
-            start = pairs_clique_ordered.size();
-            continue; // next clique (this one is already processed)
-          }
-        }
-        count += clique_size;
+        const Size start = pairs_clique_ordered.size();
         for (std::set<Size>::const_iterator i_p = it->second.begin(); i_p != it->second.end(); ++i_p)
         {
           pairs_clique_ordered.push_back(pairs[*i_p]);
         }
+        components.push_back(std::make_pair(start, pairs_clique_ordered.size()));
       }
-      if (count > 0)
-        bins.push_back(std::make_pair(start, pairs_clique_ordered.size()));
     }
 
     if (pairs_clique_ordered.size() != pairs.size())
@@ -162,19 +133,89 @@ namespace OpenMS
     /* swap pairs, such that edges are order by cliques (so we can make clean cuts) */
     pairs.swap(pairs_clique_ordered);
 
-    //PairsType pt2 = pairs;
     StopWatch time1;
     time1.start();
 
-    // split problem into slices and have each one solved by the ILPS
-    double score = 0;
-// OMP currently causes spurious segfaults in Release mode; OMP fix applied, however: disable if problem persists
-//#ifdef _OPENMP
-//#pragma omp parallel for schedule(dynamic, 1), reduction(+: score)
-//#endif
+    // edge weights: log scores are good for addition in ILP - but they are < 0, thus not suitable for maximizing
+    // ... so we just add normal probabilities (multiplied with the preset score)
+#pragma omp parallel for
+    for (SignedSize i = 0; i < static_cast<SignedSize>(pairs.size()); ++i)
+    {
+      pairs[i].setEdgeScore(exp(getLogScore_(pairs[i], fm)) * pairs[i].getEdgeScore());
+    }
+
+    // components with a unique optimum that is easy to find (e.g. single edges) do not need the ILP
+    std::vector<double> component_scores(components.size(), 0.0);
+    std::vector<char> solved(components.size(), false);
+#pragma omp parallel for schedule(dynamic, 64)
+    for (SignedSize i = 0; i < static_cast<SignedSize>(components.size()); ++i)
+    {
+      solved[i] = solveTrivialComponent_(pairs, components[i].first, components[i].second, component_scores[i]);
+    }
+
+    /* partition the remaining cliques into bins, one given to the ILP at a time */
+    std::vector<RangesType> bins;
+    {
+      UInt pairs_per_bin = 1000;
+      UInt big_clique_bin_threshold = 200;
+
+      RangesType bin;
+      Size count(0);
+      for (Size i = 0; i < components.size(); ++i)
+      {
+        if (solved[i]) continue;
+        Size clique_size = components[i].second - components[i].first;
+        if (clique_size > big_clique_bin_threshold) // extra bin for this big clique
+        {
+          bins.push_back(RangesType(1, components[i]));
+          continue;
+        }
+        if (count > pairs_per_bin) // bin is full
+        {
+          if (verbose_level > 2)
+            OPENMS_LOG_INFO << "Overstepping border of " << pairs_per_bin << " by " << SignedSize(count - pairs_per_bin) << " elements!\n";
+          bins.push_back(bin);
+          bin.clear();
+          count = 0;
+        }
+        count += clique_size;
+        bin.push_back(components[i]);
+      }
+      if (count > 0)
+        bins.push_back(bin);
+    }
+    // solve the largest bins first (they take longest)
+    auto binSize = [](const RangesType& bin)
+    {
+      Size size(0);
+      for (const auto& range : bin) size += range.second - range.first;
+      return size;
+    };
+    std::stable_sort(bins.begin(), bins.end(), [&binSize](const RangesType& a, const RangesType& b) { return binSize(a) > binSize(b); });
+    if (verbose_level > 1)
+    {
+      OPENMS_LOG_INFO << "Solving " << bins.size() << " ILP(s); " << std::count(solved.begin(), solved.end(), true) << " of " << components.size() << " components were solved without ILP.\n";
+    }
+
+    // split problem into slices and have each one solved by the ILPS (one solver instance per slice);
+    // GLPK keeps its environment in global state, so only COIN-OR instances are solved in parallel
+    std::vector<double> bin_scores(bins.size(), 0.0);
+#if defined(_OPENMP) && defined(OPENMS_HAS_COINOR)
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
     for (SignedSize i = 0; i < static_cast<SignedSize>(bins.size()); ++i)
     {
-      score = computeSlice_(fm, pairs, bins[i].first, bins[i].second, verbose_level);
+      bin_scores[i] = computeSlice_(pairs, bins[i], verbose_level);
+    }
+
+    double score = 0;
+    for (Size i = 0; i < components.size(); ++i)
+    {
+      if (solved[i]) score += component_scores[i];
+    }
+    for (double bin_score : bin_scores)
+    {
+      score += bin_score;
     }
     time1.stop();
     OPENMS_LOG_INFO << " Branch and cut took " << time1.getClockTime() << " seconds, "
@@ -184,15 +225,172 @@ namespace OpenMS
     return score;
   }
 
+  bool ILPDCWrapper::solveTrivialComponent_(PairsType& pairs,
+                                            const PairsIndex margin_left,
+                                            const PairsIndex margin_right,
+                                            double& objective) const
+  {
+    // local index of the features and of their charge variants at both ends of each edge
+    const Size nr_edges = margin_right - margin_left;
+    std::map<Size, Size> feature_index;
+    std::vector<std::map<String, Size> > variants;
+    std::vector<std::pair<Size, Size> > edge_features(nr_edges), edge_variants(nr_edges);
+    for (Size e = 0; e < nr_edges; ++e)
+    {
+      const ChargePair& pair = pairs[margin_left + e];
+      // an edge with score 0 may or may not be realized by the ILP
+      if (!(pair.getEdgeScore() > 0)) return false;
+      Size f[2], v[2];
+      for (UInt side = 0; side < 2; ++side)
+      {
+        auto it = feature_index.insert(std::make_pair(pair.getElementIndex(side), variants.size())).first;
+        if (it->second == variants.size()) variants.emplace_back();
+        f[side] = it->second;
+        const String variant = pair.getCompomer().getAdductsAsString(side) + "_" + pair.getCharge(side);
+        v[side] = variants[f[side]].insert(std::make_pair(variant, variants[f[side]].size())).first->second;
+      }
+      edge_features[e] = std::make_pair(f[0], f[1]);
+      edge_variants[e] = std::make_pair(v[0], v[1]);
+    }
+    const Size nr_features = variants.size();
+
+    // no conflicting charge variants: all edges are realized
+    bool conflict_free = true;
+    for (const auto& v : variants)
+    {
+      conflict_free = conflict_free && (v.size() == 1);
+    }
+    if (conflict_free)
+    {
+      objective = 0;
+      for (Size e = 0; e < nr_edges; ++e)
+      {
+        pairs[margin_left + e].setActive(true);
+        objective += pairs[margin_left + e].getEdgeScore();
+      }
+      return true;
+    }
+
+    // otherwise, only trees (exactly one edge between two features of a path) are solved here
+    if (nr_edges + 1 != nr_features) return false;
+
+    // order the features from the root (feature 0) to the leaves
+    std::vector<std::vector<Size> > adjacent_edges(nr_features);
+    for (Size e = 0; e < nr_edges; ++e)
+    {
+      adjacent_edges[edge_features[e].first].push_back(e);
+      adjacent_edges[edge_features[e].second].push_back(e);
+    }
+    std::vector<Size> order(1, 0), parent_edge(nr_features, nr_edges);
+    std::vector<bool> visited(nr_features, false);
+    visited[0] = true;
+    for (Size i = 0; i < order.size(); ++i)
+    {
+      for (Size e : adjacent_edges[order[i]])
+      {
+        const Size other = edge_features[e].first == order[i] ? edge_features[e].second : edge_features[e].first;
+        if (visited[other]) continue;
+        visited[other] = true;
+        parent_edge[other] = e;
+        order.push_back(other);
+      }
+    }
+    if (order.size() != nr_features) return false;
+
+    // treat values within the tolerance of the ILP solvers as equal
+    auto isTie = [](double a, double b) { return fabs(a - b) <= 1e-9 * std::max(fabs(a), fabs(b)); };
+
+    // dynamic programming from the leaves: best score of the subtree of a feature, given its charge variant
+    // (and whether another realization of the edges gives the same score, in which case the ILP decides)
+    std::vector<std::vector<double> > best(nr_features);
+    std::vector<std::vector<char> > ambiguous(nr_features);
+    std::vector<Size> best_variant(nr_features);
+    for (Size f = 0; f < nr_features; ++f)
+    {
+      best[f].assign(variants[f].size(), 0.0);
+      ambiguous[f].assign(variants[f].size(), false);
+    }
+    // variant of the parent that realizes edge e, and variant of the child
+    auto edgeVariants = [&](Size child)
+    {
+      const Size e = parent_edge[child];
+      return edge_features[e].second == child ? edge_variants[e] : std::make_pair(edge_variants[e].second, edge_variants[e].first);
+    };
+    for (Size i = order.size(); i-- > 0; )
+    {
+      const Size f = order[i];
+      // best variant of f (regardless of its parent)
+      Size arg_max = 0;
+      bool tie = false;
+      for (Size v = 1; v < best[f].size(); ++v)
+      {
+        if (isTie(best[f][v], best[f][arg_max])) tie = true;
+        if (best[f][v] > best[f][arg_max])
+        {
+          tie = isTie(best[f][v], best[f][arg_max]);
+          arg_max = v;
+        }
+      }
+      best_variant[f] = arg_max;
+      const bool ambiguous_max = tie || ambiguous[f][arg_max];
+      if (i == 0)
+      {
+        if (ambiguous_max) return false;
+        break;
+      }
+      // add the subtree of f to its parent
+      const Size e = parent_edge[f];
+      const Size parent = edge_features[e].first == f ? edge_features[e].second : edge_features[e].first;
+      const std::pair<Size, Size> realizing = edgeVariants(f);
+      const double realized = best[f][realizing.second] + pairs[margin_left + e].getEdgeScore();
+      for (Size v = 0; v < best[parent].size(); ++v)
+      {
+        if (v == realizing.first && !(realized < best[f][arg_max]))
+        {
+          if (isTie(realized, best[f][arg_max])) ambiguous[parent][v] = true;
+          ambiguous[parent][v] = ambiguous[parent][v] || ambiguous[f][realizing.second];
+          best[parent][v] += realized;
+        }
+        else
+        {
+          if (v == realizing.first && isTie(realized, best[f][arg_max])) ambiguous[parent][v] = true;
+          ambiguous[parent][v] = ambiguous[parent][v] || ambiguous_max;
+          best[parent][v] += best[f][arg_max];
+        }
+      }
+    }
+
+    // realize the optimal solution from the root
+    std::vector<Size> chosen(nr_features);
+    chosen[0] = best_variant[0];
+    objective = best[0][chosen[0]];
+    for (Size i = 1; i < order.size(); ++i)
+    {
+      const Size f = order[i];
+      const Size e = parent_edge[f];
+      const Size parent = edge_features[e].first == f ? edge_features[e].second : edge_features[e].first;
+      const std::pair<Size, Size> realizing = edgeVariants(f);
+      const double realized = best[f][realizing.second] + pairs[margin_left + e].getEdgeScore();
+      if (chosen[parent] == realizing.first && !(realized < best[f][best_variant[f]]))
+      {
+        pairs[margin_left + e].setActive(true);
+        chosen[f] = realizing.second;
+      }
+      else
+      {
+        chosen[f] = best_variant[f];
+      }
+    }
+    return true;
+  }
+
   void ILPDCWrapper::updateFeatureVariant_(FeatureType_& f_set, const String& rota_l, const Size& v) const
   {
     f_set[rota_l].insert(v);
   }
 
-  double ILPDCWrapper::computeSlice_(const FeatureMap& fm,
-                                     PairsType& pairs,
-                                     const PairsIndex margin_left,
-                                     const PairsIndex margin_right,
+  double ILPDCWrapper::computeSlice_(PairsType& pairs,
+                                     const RangesType& ranges,
                                      const Size /* verbose_level */) const
   {
     // feature --> variants set  (with scores)
@@ -204,14 +402,14 @@ namespace OpenMS
     build.setObjectiveSense(LPWrapper::MAX); // maximize
 
     // add ALL edges first. Their result is what is interesting to us later
-    for (PairsIndex i = margin_left; i < margin_right; ++i)
+    std::vector<PairsIndex> edges;
+    for (const auto& range : ranges)
     {
-      // log scores are good for addition in ILP - but they are < 0, thus not suitable for maximizing
-      // ... so we just add normal probabilities...
-      double score = exp(getLogScore_(pairs[i], fm));
-      pairs[i].setEdgeScore(score * pairs[i].getEdgeScore()); // multiply with preset score
-
-      // create the column representing the edge
+      for (PairsIndex i = range.first; i < range.second; ++i) edges.push_back(i);
+    }
+    for (const PairsIndex i : edges)
+    {
+      // create the column representing the edge (weighted by the edge score, see compute())
       Int index = build.addColumn();
       build.setColumnBounds(index, 0, 1, LPWrapper::DOUBLE_BOUNDED);
       build.setColumnType(index, LPWrapper::INTEGER); // integer variable
@@ -270,12 +468,12 @@ namespace OpenMS
 
     build.solve(param);
 
-    for (UInt iColumn = 0; iColumn < margin_right - margin_left; ++iColumn)
+    for (UInt iColumn = 0; iColumn < edges.size(); ++iColumn)
     {
       double value = build.getColumnValue(iColumn);
       if (fabs(value) > 0.5)
       {
-        pairs[margin_left + iColumn].setActive(true);
+        pairs[edges[iColumn]].setActive(true);
       }
       else
       {
@@ -34,16 +34,90 @@ namespace OpenMS
       //: public std::function<unsigned long(IDBoostGraph::Graph&)>
   {
   public:
+    /// The nodes of a connected component with their type and their neighbors of lower type (i.e. "left" side)
+    struct ComponentStructure
+    {
+      bool initialized = false;
+      std::vector<IDBoostGraph::vertex_t> nodes;
+      std::vector<int> types;
+      std::vector<std::vector<IDBoostGraph::vertex_t>> in;
+    };
+
     //TODO think about restructuring the passed params (we do not need every param from the BPI class here.
     const Param& param_;
     unsigned int debug_lvl_;
     unsigned long cnt_;
-
-    explicit GraphInferenceFunctor(const Param& param, unsigned int debug_lvl):
+    /// structure of each connected component (by index), filled on first use and reused in later calls (e.g. during grid search); may be nullptr
+    std::vector<ComponentStructure>* structure_cache_;
+
+    // parameters are read once, not for every connected component
+    bool update_PSM_probabilities_;
+    bool annotate_group_posterior_;
+    bool user_defined_priors_;
+    bool regularize_;
+    double pnorm_;
+    double pep_emission_;
+    double pep_spurious_emission_;
+    double prot_prior_;
+    double pep_prior_;
+    unsigned long max_messages_;
+    double dampening_lambda_;
+    double convergence_threshold_;
+    std::string scheduler_type_;
+
+    explicit GraphInferenceFunctor(const Param& param, unsigned int debug_lvl, std::vector<ComponentStructure>* structure_cache = nullptr):
         param_(param),
         debug_lvl_(debug_lvl),
-        cnt_(0)
-    {}
+        cnt_(0),
+        structure_cache_(structure_cache),
+        update_PSM_probabilities_(param.getValue("update_PSM_probabilities").toBool()),
+        annotate_group_posterior_(param.getValue("annotate_group_probabilities").toBool()),
+        user_defined_priors_(param.getValue("user_defined_priors").toBool()),
+        regularize_(param.getValue("model_parameters:regularize").toBool()),
+        pnorm_(param.getValue("loopy_belief_propagation:p_norm_inference")),
+        pep_emission_(param.getValue("model_parameters:pep_emission")),
+        pep_spurious_emission_(param.getValue("model_parameters:pep_spurious_emission")),
+        prot_prior_(param.getValue("model_parameters:prot_prior")),
+        pep_prior_(param.getValue("model_parameters:pep_prior")),
+        max_messages_(param.getValue("loopy_belief_propagation:max_nr_iterations")),
+        dampening_lambda_(param.getValue("loopy_belief_propagation:dampening_lambda")),
+        convergence_threshold_(param.getValue("loopy_belief_propagation:convergence_threshold")),
+        scheduler_type_(param.getValue("loopy_belief_propagation:scheduling_type").toString())
+    {
+      if (pnorm_ <= 0)
+      {
+        pnorm_ = std::numeric_limits<double>::infinity();
+      }
+    }
+
+    /// collects the nodes of @p fg with their types and neighbors of lower type
+    static void extractStructure(const IDBoostGraph::Graph& fg, ComponentStructure& structure)
+    {
+      structure.nodes.clear();
+      structure.types.clear();
+      structure.in.clear();
+      IDBoostGraph::Graph::vertex_iterator ui, ui_end;
+      boost::tie(ui,ui_end) = boost::vertices(fg);
+      for (; ui != ui_end; ++ui)
+      {
+        // direct neighbors are proteins on the "left" side and peptides on the "right" side
+        // TODO Can be sped up using directed graph. Needs some restructuring in IDBoostGraph class first tho.
+        vector<IDBoostGraph::vertex_t> in{};
+        IDBoostGraph::Graph::adjacency_iterator nbIt, nbIt_end;
+        boost::tie(nbIt, nbIt_end) = boost::adjacent_vertices(*ui, fg);
+        for (; nbIt != nbIt_end; ++nbIt)
+        {
+          if (fg[*nbIt].which() < fg[*ui].which())
+          {
+            in.push_back(*nbIt);
+          }
+        }
+        structure.nodes.push_back(*ui);
+        structure.types.push_back(fg[*ui].which());
+        structure.in.push_back(std::move(in));
+      }
+      structure.initialized = true;
+    }
 
     unsigned long operator() (IDBoostGraph::Graph& fg, unsigned int idx) {
       //TODO do quick brute-force calculation if the cc is really small?
@@ -63,108 +137,85 @@ namespace OpenMS
         }
 
         bool graph_mp_ownership_acquired = false;
-        bool update_PSM_probabilities = param_.getValue("update_PSM_probabilities").toBool();
-        bool annotate_group_posterior = param_.getValue("annotate_group_probabilities").toBool();
-        bool user_defined_priors = param_.getValue("user_defined_priors").toBool();
-        bool regularize = param_.getValue("model_parameters:regularize").toBool();
-        double pnorm = param_.getValue("loopy_belief_propagation:p_norm_inference");
-        if (pnorm <= 0)
-        {
-          pnorm = std::numeric_limits<double>::infinity();
-        }
+        const double pnorm = pnorm_;
 
-        MessagePasserFactory<IDBoostGraph::vertex_t> mpf (param_.getValue("model_parameters:pep_emission"),
-                                                 param_.getValue("model_parameters:pep_spurious_emission"),
-                                                 param_.getValue("model_parameters:prot_prior"),
+        MessagePasserFactory<IDBoostGraph::vertex_t> mpf (pep_emission_,
+                                                 pep_spurious_emission_,
+                                                 prot_prior_,
                                                  pnorm,
-                                                 param_.getValue("model_parameters:pep_prior")); // the p used for marginalization: 1 = sum product, inf = max product
+                                                 pep_prior_); // the p used for marginalization: 1 = sum product, inf = max product
         evergreen::BetheInferenceGraphBuilder<IDBoostGraph::vertex_t> bigb;
 
-        IDBoostGraph::Graph::vertex_iterator ui, ui_end;
-        boost::tie(ui,ui_end) = boost::vertices(fg);
+        // the structure of a component does not change (e.g. between the parameter sets of a grid search)
+        ComponentStructure local_structure;
+        ComponentStructure& structure = (structure_cache_ != nullptr && idx < structure_cache_->size()) ? (*structure_cache_)[idx] : local_structure;
+        if (!structure.initialized)
+        {
+          extractStructure(fg, structure);
+        }
 
         // Store the IDs of the nodes for which you want the posteriors in the end
         vector<vector<IDBoostGraph::vertex_t>> posteriorVars;
 
-        // direct neighbors are proteins on the "left" side and peptides on the "right" side
-        // TODO Can be sped up using directed graph. Needs some restructuring in IDBoostGraph class first tho.
-        vector<IDBoostGraph::vertex_t> in{};
-        //std::vector<IDBoostGraph::vertex_t> out{};
-
         //TODO the try section could in theory be slimmed down a little bit. Start at first use of insertDependency maybe.
         // check performance impact.
         try
         {
-          for (; ui != ui_end; ++ui)
+          for (Size n = 0; n < structure.nodes.size(); ++n)
           {
-            IDBoostGraph::Graph::adjacency_iterator nbIt, nbIt_end;
-            boost::tie(nbIt, nbIt_end) = boost::adjacent_vertices(*ui, fg);
-
-            in.clear();
-            //out.clear(); // we don't need out edges currently
-
-            for (; nbIt != nbIt_end; ++nbIt)
-            {
-              if (fg[*nbIt].which() < fg[*ui].which())
-              {
-                in.push_back(*nbIt);
-              }
-              /*else
-              {
-                out.push_back(*nbIt);
-              }*/
-            }
+            const IDBoostGraph::vertex_t ui = structure.nodes[n];
+            const vector<IDBoostGraph::vertex_t>& in = structure.in[n];
 
             //TODO introduce an enum for the types to make it more clear.
             //Or use the static_visitor pattern: You have to pass the vertex with its neighbors as a second arg though.
 
-            if (fg[*ui].which() == 6) // pep hit = psm
+            if (structure.types[n] == 6) // pep hit = psm
             {
-              if (regularize)
+              if (regularize_)
               {
-                bigb.insert_dependency(mpf.createRegularizingSumEvidenceFactor(boost::get<PeptideHit *>(fg[*ui])
-                                                                                   ->getPeptideEvidences().size(), in[0], *ui));
+                bigb.insert_dependency(mpf.createRegularizingSumEvidenceFactor(boost::get<PeptideHit *>(fg[ui])
+                                                                                   ->getPeptideEvidences().size(), in[0], ui));
               }
               else
               {
-                bigb.insert_dependency(mpf.createSumEvidenceFactor(boost::get<PeptideHit *>(fg[*ui])
-                                                                                   ->getPeptideEvidences().size(), in[0], *ui));
+                bigb.insert_dependency(mpf.createSumEvidenceFactor(boost::get<PeptideHit *>(fg[ui])
+                                                                                   ->getPeptideEvidences().size(), in[0], ui));
               }
 
-              bigb.insert_dependency(mpf.createPeptideEvidenceFactor(*ui,
-                                                                     boost::get<PeptideHit *>(fg[*ui])->getScore()));
-              if (update_PSM_probabilities)
+              bigb.insert_dependency(mpf.createPeptideEvidenceFactor(ui,
+                                                                     boost::get<PeptideHit *>(fg[ui])->getScore()));
+              if (update_PSM_probabilities_)
               {
-                posteriorVars.push_back({*ui});
+                posteriorVars.push_back({ui});
               }
             }
-            else if (fg[*ui].which() == 2) // pep group
+            else if (structure.types[n] == 2) // pep group
             {
-              bigb.insert_dependency(mpf.createPeptideProbabilisticAdderFactor(in, *ui));
+              bigb.insert_dependency(mpf.createPeptideProbabilisticAdderFactor(in, ui));
             }
-            else if (fg[*ui].which() == 1) // prot group
+            else if (structure.types[n] == 1) // prot group
             {
-              bigb.insert_dependency(mpf.createPeptideProbabilisticAdderFactor(in, *ui));
-              if (annotate_group_posterior)
+              bigb.insert_dependency(mpf.createPeptideProbabilisticAdderFactor(in, ui));
+              if (annotate_group_posterior_)
               {
-                posteriorVars.push_back({*ui});
+                posteriorVars.push_back({ui});
               }
             }
-            else if (fg[*ui].which() == 0) // prot
+            else if (structure.types[n] == 0) // prot
             {
               //TODO modify createProteinFactor to start with a modified prior based on the number of missing
               // peptides (later tweak to include conditional prob. for that peptide
-              if (user_defined_priors)
+              if (user_defined_priors_)
               {
-                bigb.insert_dependency(mpf.createProteinFactor(*ui,
-                                                               (double) boost::get<ProteinHit *>(fg[*ui])
+                bigb.insert_dependency(mpf.createProteinFactor(ui,
+                                                               (double) boost::get<ProteinHit *>(fg[ui])
                                                                    ->getMetaValue("Prior")));
               }
               else
               {
-                bigb.insert_dependency(mpf.createProteinFactor(*ui));
+                bigb.insert_dependency(mpf.createProteinFactor(ui));
               }
-              posteriorVars.push_back({*ui});
+              posteriorVars.push_back({ui});
             }
           }
 
@@ -172,14 +223,10 @@ namespace OpenMS
           evergreen::InferenceGraph <IDBoostGraph::vertex_t> ig = bigb.to_graph();
           graph_mp_ownership_acquired = true;
 
-          unsigned long maxMessages = param_
-              .getValue("loopy_belief_propagation:max_nr_iterations");
-          double initDampeningLambda = param_
-              .getValue("loopy_belief_propagation:dampening_lambda");
-          double initConvergenceThreshold = param_.getValue(
-              "loopy_belief_propagation:convergence_threshold");
-          std::string scheduler_type = param_.getValue(
-              "loopy_belief_propagation:scheduling_type");
+          unsigned long maxMessages = max_messages_;
+          double initDampeningLambda = dampening_lambda_;
+          double initConvergenceThreshold = convergence_threshold_;
+          const std::string& scheduler_type = scheduler_type_;
 
           std::unique_ptr<evergreen::Scheduler<IDBoostGraph::vertex_t>> scheduler;
           if (scheduler_type == "priority")
@@ -462,11 +509,14 @@ namespace OpenMS
     Param& param_;
     IDBoostGraph& ibg_;
     const unsigned int debug_lvl_;
+    /// structures of the connected components, shared between all parameter sets
+    std::vector<GraphInferenceFunctor::ComponentStructure>* structure_cache_;
 
-    explicit GridSearchEvaluator(Param& param, IDBoostGraph& ibg, unsigned int debug_lvl):
+    explicit GridSearchEvaluator(Param& param, IDBoostGraph& ibg, unsigned int debug_lvl, std::vector<GraphInferenceFunctor::ComponentStructure>* structure_cache = nullptr):
         param_(param),
         ibg_(ibg),
-        debug_lvl_(debug_lvl)
+        debug_lvl_(debug_lvl),
+        structure_cache_(structure_cache)
     {}
 
     double operator() (double alpha, double beta, double gamma)
@@ -480,7 +530,7 @@ namespace OpenMS
       param_.setValue("model_parameters:prot_prior", gamma);
       param_.setValue("model_parameters:pep_emission", alpha);
       param_.setValue("model_parameters:pep_spurious_emission", beta);
-      GraphInferenceFunctor gif {param_, debug_lvl_};
+      GraphInferenceFunctor gif {param_, debug_lvl_, structure_cache_};
       ibg_.applyFunctorOnCCs(gif);
 
       FalseDiscoveryRate fdr;
@@ -885,6 +935,10 @@ namespace OpenMS
 
     std::array<size_t, 3> bestParams{{0, 0, 0}};
 
+    // the graph is built once: the structure of its connected components is only extracted for the
+    // first parameter set and reused for all other parameter sets and the final inference
+    vector<GraphInferenceFunctor::ComponentStructure> structure_cache(ibg.getNrConnectedComponents());
+
     //Save initial settings and deactivate certain features to save time during grid search and to not
     // interfere with later runs.
     // TODO We could think about optimizing PSM FDR as another goal though.
@@ -901,7 +955,7 @@ namespace OpenMS
     if (gs.getNrCombos() > 1)
     {
      OPENMS_LOG_INFO << "Testing " << gs.getNrCombos() << " param combinations." << std::endl;
-      /*double res =*/ gs.evaluate(GridSearchEvaluator(param_, ibg, debug_lvl_), -1.0, bestParams);
+      /*double res =*/ gs.evaluate(GridSearchEvaluator(param_, ibg, debug_lvl_, &structure_cache), -1.0, bestParams);
     }
     else
     {
@@ -922,7 +976,7 @@ namespace OpenMS
 
     if (!use_run_info)
     {
-      GraphInferenceFunctor gif {param_, debug_lvl_};
+      GraphInferenceFunctor gif {param_, debug_lvl_, &structure_cache};
       ibg.applyFunctorOnCCs(gif);
     }
     else
@@ -0,0 +1,286 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/DigestStore.h>
+
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/CHEMISTRY/ModificationsDB.h>
+#include <OpenMS/CHEMISTRY/ModifiedPeptideGenerator.h>
+#include <OpenMS/CHEMISTRY/ProteaseDigestion.h>
+#include <OpenMS/CHEMISTRY/ResidueDB.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/DATASTRUCTURES/StringView.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+
+#include <algorithm>
+#include <exception>
+#include <unordered_map>
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// sections: protein accessions (StringIndex), peptides (PeptideRecord, sorted by mass), protein references (UInt32)
+    enum Section { PROTEINS, PEPTIDES, PROTEIN_REFS, NR_SECTIONS };
+
+    const Internal::MappedIndexFile::Format digest_store_format = {{'O', 'M', 'S', 'D', 'I', 'G', 'S', 'T'}, 3, NR_SECTIONS, "digest store"};
+  }
+
+  String DigestStore::Parameters::getFingerprint() const
+  {
+    // the order of the modifications does not matter
+    StringList fixed = fixed_modifications;
+    StringList variable = variable_modifications;
+    std::sort(fixed.begin(), fixed.end());
+    std::sort(variable.begin(), variable.end());
+    return "enzyme=" + enzyme
+      + ";specificity=" + EnzymaticDigestion::NamesOfSpecificity[specificity]
+      + ";missed_cleavages=" + String(missed_cleavages)
+      + ";min_length=" + String(min_length)
+      + ";max_length=" + String(max_length)
+      + ";fixed=" + ListUtils::concatenate(fixed, ",")
+      + ";variable=" + ListUtils::concatenate(variable, ",")
+      + ";max_variable_mods=" + String(max_variable_mods_per_peptide);
+  }
+
+  DigestStore::DigestStore() :
+    file_(digest_store_format)
+  {
+  }
+
+  DigestStore::~DigestStore()
+  {
+    close();
+  }
+
+  void DigestStore::create(const String& filename, const String& fasta_file, const Parameters& params)
+  {
+    std::vector<FASTAFile::FASTAEntry> fasta_db;
+    FASTAFile().load(fasta_file, fasta_db);
+
+    ProteaseDigestion digestor;
+    digestor.setEnzyme(params.enzyme);
+    digestor.setSpecificity(params.specificity);
+    digestor.setMissedCleavages(params.missed_cleavages);
+
+    // digest all proteins; the unique peptides are then collected in database order (keeps the store deterministic)
+    std::vector<std::vector<std::pair<Size, Size> > > digests(fasta_db.size());
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize p = 0; p < (SignedSize)fasta_db.size(); ++p)
+    {
+      const String& protein = fasta_db[p].sequence;
+      if (params.specificity == EnzymaticDigestion::SPEC_FULL)
+      {
+        digestor.digestUnmodified(StringView(protein), digests[p], params.min_length, params.max_length);
+      }
+      else
+      { // semi- and unspecific products are not generated by digestUnmodified(): check all substrings
+        const Size max_length = (params.max_length == 0) ? protein.size() : std::min(params.max_length, protein.size());
+        for (Size start = 0; start < protein.size(); ++start)
+        {
+          for (Size length = std::max(params.min_length, Size(1)); length <= max_length && start + length <= protein.size(); ++length)
+          {
+            if (digestor.isValidProduct(protein, (int)start, (int)length, false)) digests[p].emplace_back(start, length);
+          }
+        }
+      }
+      digests[p].erase(std::remove_if(digests[p].begin(), digests[p].end(), [&protein](const std::pair<Size, Size>& d)
+      {
+        return std::string_view(protein).substr(d.first, d.second).find_first_of("XBZ") != std::string_view::npos;
+      }), digests[p].end());
+    }
+
+    std::unordered_map<std::string_view, UInt32> peptide_index;
+    std::vector<std::string_view> unique_peptides;
+    std::vector<std::vector<UInt32> > peptide_proteins;
+    for (Size p = 0; p < fasta_db.size(); ++p)
+    {
+      const UInt32 protein_index = digest_store_format.checkedUInt32(p, "proteins");
+      for (const auto& d : digests[p])
+      {
+        const std::string_view peptide = std::string_view(fasta_db[p].sequence).substr(d.first, d.second);
+        auto it = peptide_index.emplace(peptide, digest_store_format.checkedUInt32(unique_peptides.size(), "peptides"));
+        if (it.second)
+        {
+          unique_peptides.push_back(peptide);
+          peptide_proteins.emplace_back();
+        }
+        std::vector<UInt32>& proteins = peptide_proteins[it.first->second];
+        if (proteins.empty() || proteins.back() != protein_index) proteins.push_back(protein_index);
+      }
+      std::vector<std::pair<Size, Size> >().swap(digests[p]);
+    }
+    peptide_index.clear();
+
+    Internal::MappedIndexFile::StringPool pool(digest_store_format);
+    std::vector<StringIndex> proteins;
+    proteins.reserve(fasta_db.size());
+    for (const auto& entry : fasta_db)
+    {
+      proteins.push_back(pool.add(entry.identifier));
+    }
+
+    std::vector<UInt32> protein_refs;
+    for (const auto& refs : peptide_proteins)
+    {
+      protein_refs.insert(protein_refs.end(), refs.begin(), refs.end());
+    }
+    digest_store_format.checkedUInt32(protein_refs.size(), "protein references");
+
+    // generate the modified variants block-wise in parallel, but add them in database order
+    const ModifiedPeptideGenerator::MapToResidueType fixed_modifications = ModifiedPeptideGenerator::getModifications(params.fixed_modifications);
+    const ModifiedPeptideGenerator::MapToResidueType variable_modifications = ModifiedPeptideGenerator::getModifications(params.variable_modifications);
+    // all modified residues of the digest exist now: lookups in the parallel regions do not need to lock
+    ResidueDB::getInstance()->freeze();
+    ModificationsDB::getInstance()->freeze();
+    std::vector<PeptideRecord> peptides;
+    const Size block_size = 4096;
+    UInt32 first_protein_ref = 0;
+    for (Size block_start = 0; block_start < unique_peptides.size(); block_start += block_size)
+    {
+      const Size block_end = std::min(block_start + block_size, unique_peptides.size());
+      std::vector<std::vector<std::pair<double, std::string> > > block(block_end - block_start);
+      std::vector<std::exception_ptr> errors(block.size());
+
+#pragma omp parallel for schedule(dynamic)
+      for (SignedSize i = 0; i < (SignedSize)block.size(); ++i)
+      {
+        try
+        {
+          AASequence aas = AASequence::fromString(String(unique_peptides[block_start + i]));
+          std::vector<AASequence> all_modified_peptides;
+          ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
+          ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, params.max_variable_mods_per_peptide, all_modified_peptides);
+          block[i].reserve(all_modified_peptides.size());
+          for (const AASequence& candidate : all_modified_peptides)
+          {
+            block[i].emplace_back(candidate.getMonoWeight(), candidate.toString());
+          }
+        }
+        catch (...)
+        {
+          errors[i] = std::current_exception();
+        }
+      }
+
+      for (Size i = 0; i < block.size(); ++i)
+      {
+        if (errors[i])
+        {
+          std::rethrow_exception(errors[i]);
+        }
+        const UInt32 nr_protein_refs = (UInt32)peptide_proteins[block_start + i].size();
+        const StringIndex unmodified = pool.add(std::string(unique_peptides[block_start + i]));
+        for (Size v = 0; v < block[i].size(); ++v)
+        {
+          peptides.push_back({block[i][v].first, pool.add(block[i][v].second), unmodified, first_protein_ref, nr_protein_refs, (UInt32)v});
+        }
+        first_protein_ref += nr_protein_refs;
+      }
+    }
+    digest_store_format.checkedUInt32(peptides.size(), "peptides");
+    std::stable_sort(peptides.begin(), peptides.end(), [](const PeptideRecord& a, const PeptideRecord& b) { return a.mass < b.mass; });
+
+    Internal::MappedIndexFile::Writer writer(digest_store_format, filename, fasta_file, params.getFingerprint(), pool);
+    writer.addSection(proteins);
+    writer.addSection(peptides);
+    writer.addSection(protein_refs);
+    writer.commit();
+  }
+
+  bool DigestStore::isUpToDate(const String& filename, const String& fasta_file, const Parameters& params)
+  {
+    return Internal::MappedIndexFile::isUpToDate(digest_store_format, filename, fasta_file, params.getFingerprint());
+  }
+
+  void DigestStore::open(const String& filename)
+  {
+    close();
+    file_.open(filename);
+    try
+    {
+      proteins_ = file_.getSection<StringIndex>(PROTEINS, nr_proteins_);
+      peptides_ = file_.getSection<PeptideRecord>(PEPTIDES, nr_peptides_);
+      protein_refs_ = file_.getSection<UInt32>(PROTEIN_REFS, nr_protein_refs_);
+    }
+    catch (...)
+    {
+      close();
+      throw;
+    }
+  }
+
+  void DigestStore::openOrCreate(const String& filename, const String& fasta_file, const Parameters& params)
+  {
+    close(); // the file may be replaced
+    if (!isUpToDate(filename, fasta_file, params))
+    {
+      OPENMS_LOG_INFO << "Creating digest store '" << filename << "' for '" << fasta_file << "'." << std::endl;
+      create(filename, fasta_file, params);
+    }
+    open(filename);
+  }
+
+  bool DigestStore::isOpen() const
+  {
+    return file_.isOpen();
+  }
+
+  void DigestStore::close()
+  {
+    file_.close();
+    proteins_ = nullptr;
+    peptides_ = nullptr;
+    protein_refs_ = nullptr;
+    nr_proteins_ = nr_peptides_ = nr_protein_refs_ = 0;
+  }
+
+  Size DigestStore::getNrPeptides() const
+  {
+    return nr_peptides_;
+  }
+
+  Size DigestStore::getNrProteins() const
+  {
+    return nr_proteins_;
+  }
+
+  const DigestStore::PeptideRecord& DigestStore::getPeptide(Size index) const
+  {
+    OPENMS_PRECONDITION(index < nr_peptides_, "Peptide index out of range")
+    return peptides_[index];
+  }
+
+  std::string_view DigestStore::getString(StringIndex index) const
+  {
+    return file_.getString(index);
+  }
+
+  std::string_view DigestStore::getSequence(Size index) const
+  {
+    return getString(getPeptide(index).sequence);
+  }
+
+  std::string_view DigestStore::getProteinAccession(Size index) const
+  {
+    OPENMS_PRECONDITION(index < nr_proteins_, "Protein index out of range")
+    return getString(proteins_[index]);
+  }
+
+  UInt32 DigestStore::getProteinRef(Size index) const
+  {
+    OPENMS_PRECONDITION(index < nr_protein_refs_, "Protein reference index out of range")
+    return protein_refs_[index];
+  }
+
+  std::pair<Size, Size> DigestStore::getPeptideRange(double min_mass, double max_mass) const
+  {
+    return Internal::MappedIndexFile::getRange(peptides_, nr_peptides_, min_mass, max_mass, [](const PeptideRecord& r) { return r.mass; });
+  }
+
+}
@@ -15,8 +15,10 @@
 #include <OpenMS/DATASTRUCTURES/StringUtils.h>
 #include <OpenMS/PROCESSING/ID/IDFilter.h>
 #include <OpenMS/METADATA/ProteinIdentification.h>
+#include <OpenMS/METADATA/PSMTable.h>
 
 #include <algorithm>
+#include <utility>
 
 // #define FALSE_DISCOVERY_RATE_DEBUG
 // #undef  FALSE_DISCOVERY_RATE_DEBUG
@@ -404,6 +406,173 @@ namespace OpenMS
     return;
   }
 
+  void FalseDiscoveryRate::apply(PSMTable& table, bool annotate_peptide_fdr) const
+  {
+    bool q_value = !param_.getValue("no_qvalues").toBool();
+    bool use_all_hits = param_.getValue("use_all_hits").toBool();
+    bool treat_runs_separately = param_.getValue("treat_runs_separately").toBool();
+    bool split_charge_variants = param_.getValue("split_charge_variants").toBool();
+    bool add_decoy_peptides = param_.getValue("add_decoy_peptides").toBool();
+
+    if (table.getNrSpectra() == 0)
+    {
+      OPENMS_LOG_WARN << "No peptide identifications given to FalseDiscoveryRate! No calculation performed.\n";
+      return;
+    }
+
+    bool higher_score_better = table.isHigherScoreBetter();
+    if (use_all_hits)
+    {
+      table.sortHits();
+    }
+    else
+    {
+      IDFilter::keepNBestHits(table, 1);
+    }
+
+    // rows are grouped by charge variant and/or run (if requested)
+    const vector<PSMTable::TargetDecoy>& target_decoy = table.getTargetDecoy();
+    const vector<UInt32>& spectra = table.getSpectrumIndices();
+    const vector<UInt32>& sequence_ids = table.getSequenceIds();
+    const vector<Int>& charges = table.getCharges();
+    const vector<double>& scores = std::as_const(table).getScores();
+    map<pair<UInt32, Int>, UInt32> group_ids;
+    vector<pair<UInt32, Int>> group_keys;
+    vector<String> group_runs;
+    vector<UInt32> group(table.size());
+    for (Size r = 0; r < table.size(); ++r)
+    {
+      if (target_decoy[r] == PSMTable::TargetDecoy::UNKNOWN)
+      {
+        OPENMS_LOG_FATAL_ERROR << "Meta value 'target_decoy' does not exists, reindex the idXML file with 'PeptideIndexer' first (run-id='" << table.getRunIdentifier(spectra[r]) << "')!" << endl;
+        throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Meta value 'target_decoy' does not exist!");
+      }
+      if (target_decoy[r] == PSMTable::TargetDecoy::INVALID)
+      {
+        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unknown value of meta value 'target_decoy'", "not 'target', 'decoy' or 'target+decoy'");
+      }
+      const pair<UInt32, Int> key(treat_runs_separately ? table.getRunIndex(spectra[r]) : 0, split_charge_variants ? charges[r] : 0);
+      auto [group_it, inserted] = group_ids.emplace(key, UInt32(group_keys.size()));
+      if (inserted)
+      {
+        group_keys.push_back(key);
+        group_runs.push_back(table.getRunIdentifier(spectra[r]));
+      }
+      group[r] = group_it->second;
+    }
+
+    struct FDRGroup
+    {
+      vector<double> target_scores, decoy_scores;
+      unordered_map<UInt32, double> best_target, best_decoy; // best score, later FDR, per unmodified sequence
+      map<double, double> score_to_fdr;
+      bool valid = true;
+    };
+    vector<FDRGroup> groups(group_keys.size());
+    for (Size r = 0; r < table.size(); ++r)
+    {
+      FDRGroup& g = groups[group[r]];
+      const bool is_decoy = (target_decoy[r] == PSMTable::TargetDecoy::DECOY);
+      (is_decoy ? g.decoy_scores : g.target_scores).push_back(scores[r]);
+      if (annotate_peptide_fdr)
+      {
+        auto [entry_it, success] = (is_decoy ? g.best_decoy : g.best_target).emplace(table.getUnmodifiedSequenceId(sequence_ids[r]), scores[r]);
+        if (!success && isFirstBetterScore(scores[r], entry_it->second, higher_score_better))
+        {
+          entry_it->second = scores[r];
+        }
+      }
+    }
+
+    for (Size i = 0; i < groups.size(); ++i)
+    {
+      FDRGroup& g = groups[i];
+      String error_suffix;
+      if (split_charge_variants || treat_runs_separately)
+      {
+        error_suffix += "(";
+        if (split_charge_variants)
+        {
+          error_suffix += "charge_variant=" + String(group_keys[i].second) + " ";
+        }
+        if (treat_runs_separately)
+        {
+          error_suffix += "run-id=" + group_runs[i];
+        }
+        error_suffix += ")";
+      }
+      if (g.decoy_scores.empty())
+      {
+        OPENMS_LOG_ERROR << "FalseDiscoveryRate: #decoy sequences is zero! Setting all target sequences to q-value/FDR 0! " << error_suffix << std::endl;
+      }
+      if (g.target_scores.empty())
+      {
+        OPENMS_LOG_ERROR << "FalseDiscoveryRate: #target sequences is zero! Ignoring. " << error_suffix << std::endl;
+      }
+      g.valid = !g.target_scores.empty() && !g.decoy_scores.empty();
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize i = 0; i < (SignedSize)groups.size(); ++i)
+    {
+      FDRGroup& g = groups[i];
+      if (!g.valid) continue;
+      calculateFDRs_(g.score_to_fdr, g.target_scores, g.decoy_scores, q_value, higher_score_better);
+
+      if (annotate_peptide_fdr)
+      {
+        vector<double> decoy_peptide_scores, target_peptide_scores;
+        for (const auto& ps : g.best_decoy)
+        {
+          decoy_peptide_scores.push_back(ps.second);
+        }
+        for (const auto& ps : g.best_target)
+        {
+          target_peptide_scores.push_back(ps.second);
+        }
+        map<double, double> score_to_peptide_fdr;
+        calculateFDRs_(score_to_peptide_fdr, target_peptide_scores, decoy_peptide_scores, q_value, higher_score_better);
+        for (auto& ps : g.best_decoy)
+        {
+          ps.second = score_to_peptide_fdr[ps.second];
+        }
+        for (auto& ps : g.best_target)
+        {
+          ps.second = score_to_peptide_fdr[ps.second];
+        }
+      }
+    }
+
+    // annotate fdr; without targets or decoys, targets get an FDR of 0 and decoys are removed
+    vector<double>& old_scores = table.addNumericColumn(table.getScoreType() + "_score");
+    vector<double>* peptide_fdrs = annotate_peptide_fdr ? &table.addNumericColumn(q_value ? "peptide q-value" : "peptide FDR") : nullptr;
+    vector<double>& new_scores = table.getScores();
+    vector<uint8_t> keep(table.size(), 1);
+#pragma omp parallel for
+    for (SignedSize r = 0; r < (SignedSize)table.size(); ++r)
+    {
+      const FDRGroup& g = groups[group[r]];
+      const bool is_decoy = (target_decoy[r] == PSMTable::TargetDecoy::DECOY);
+      if (is_decoy && (!add_decoy_peptides || !g.valid))
+      {
+        keep[r] = 0;
+        continue;
+      }
+      if (peptide_fdrs != nullptr && g.valid)
+      {
+        (*peptide_fdrs)[r] = (is_decoy ? g.best_decoy : g.best_target).at(table.getUnmodifiedSequenceId(sequence_ids[r]));
+      }
+      old_scores[r] = new_scores[r];
+      new_scores[r] = g.valid ? g.score_to_fdr.at(new_scores[r]) : 0.0;
+    }
+    table.filterRows(keep);
+
+    // higher-score-better can be set now, calculations are finished
+    table.setScoreType(q_value ? "q-value" : "FDR");
+    table.setHigherScoreBetter(false);
+    table.assignRanks();
+  }
+
   void FalseDiscoveryRate::apply(vector<PeptideIdentification>& fwd_ids, vector<PeptideIdentification>& rev_ids) const
   {
     if (fwd_ids.empty() || rev_ids.empty())
@@ -844,12 +1013,13 @@ namespace OpenMS
       const double& ds = decoy_scores[i];
 
       // advance target index until score is better than decoy score
+      // (target scores are sorted, so the index is found by binary search unless all or none of them are worse)
+      const auto is_worse = [&ds, higher_score_better](double ts) { return higher_score_better ? ts <= ds : ts >= ds; };
       size_t k{0};
-      while (k != target_scores.size() &&
-             ((target_scores[k] <= ds && higher_score_better) ||
-              (target_scores[k] >= ds && !higher_score_better)))
+      if (!target_scores.empty() && is_worse(target_scores.front()))
       {
-        ++k;
+        k = is_worse(target_scores.back()) ? target_scores.size() :
+          std::partition_point(target_scores.begin(), target_scores.end(), is_worse) - target_scores.begin();
       }
 
       // corner cases
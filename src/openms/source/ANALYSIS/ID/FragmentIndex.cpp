@@ -0,0 +1,404 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Macros.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+namespace OpenMS
+{
+  namespace
+  {
+    const char fragment_index_magic[8] = {'O', 'M', 'S', 'F', 'I', 'D', 'X', '\0'};
+    const UInt32 fragment_index_version = 1;
+
+    /// File header, followed by the fingerprint, the sequence offsets, the sequence pool, the peptides and the fragments
+    struct FileHeader
+    {
+      char magic[8];
+      UInt32 version;
+      UInt32 header_size;
+      UInt64 fingerprint_size;
+      UInt64 nr_sequences;
+      UInt64 sequence_bytes;
+      UInt64 nr_peptides;
+      UInt64 nr_fragments;
+      UInt64 bucket_size;
+    };
+
+    bool readHeader(std::ifstream& is, FileHeader& header)
+    {
+      is.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+      return is.gcount() == sizeof(FileHeader)
+        && std::memcmp(header.magic, fragment_index_magic, sizeof(fragment_index_magic)) == 0
+        && header.version == fragment_index_version
+        && header.header_size == sizeof(FileHeader);
+    }
+
+    template <typename T>
+    bool readVector(std::ifstream& is, std::vector<T>& v, UInt64 size)
+    {
+      v.resize(size);
+      const std::streamsize bytes = static_cast<std::streamsize>(size * sizeof(T));
+      if (bytes > 0) is.read(reinterpret_cast<char*>(v.data()), bytes);
+      return bytes == 0 || is.gcount() == bytes;
+    }
+
+    template <typename T>
+    void writeVector(std::ofstream& os, const std::vector<T>& v)
+    {
+      if (!v.empty()) os.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+    }
+
+    bool isBetterCandidate(const FragmentIndex::Candidate& a, const FragmentIndex::Candidate& b)
+    {
+      if (a.score != b.score) return a.score > b.score;
+      return a.peptide < b.peptide; // deterministic order of ties
+    }
+  }
+
+  FragmentIndex::FragmentIndex()
+  {
+    clear();
+  }
+
+  void FragmentIndex::clear()
+  {
+    sequence_pool_.clear();
+    sequence_offsets_.assign(1, 0);
+    peptides_.clear();
+    fragments_.clear();
+    bucket_min_mz_.clear();
+    bucket_size_ = 0;
+    built_ = false;
+  }
+
+  UInt32 FragmentIndex::addSequence(const String& sequence)
+  {
+    if (getNrSequences() >= std::numeric_limits<UInt32>::max())
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Too many sequences for a fragment index.", String(getNrSequences()));
+    }
+    sequence_pool_ += sequence;
+    sequence_offsets_.push_back(sequence_pool_.size());
+    built_ = false;
+    return static_cast<UInt32>(getNrSequences() - 1);
+  }
+
+  void FragmentIndex::addPeptide(UInt32 sequence, UInt32 modification_index, double mass, const std::vector<double>& fragment_mz)
+  {
+    if (peptides_.size() >= std::numeric_limits<UInt32>::max())
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Too many peptides for a fragment index.", String(peptides_.size()));
+    }
+    const UInt32 peptide_index = static_cast<UInt32>(peptides_.size());
+    peptides_.push_back({sequence, modification_index, mass});
+    for (double mz : fragment_mz)
+    {
+      fragments_.push_back({static_cast<float>(mz), peptide_index});
+    }
+    built_ = false;
+  }
+
+  void FragmentIndex::addEntry(UInt32 id, double mass, const std::vector<double>& fragment_mz)
+  {
+    addPeptide(NO_SEQUENCE, id, mass, fragment_mz);
+  }
+
+  void FragmentIndex::build(Size bucket_size)
+  {
+    if (bucket_size == 0)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "The bucket size of a fragment index must be positive.", String(bucket_size));
+    }
+    bucket_size_ = bucket_size;
+
+    // sort peptides by mass (stable, so equal masses keep their insertion order) and renumber the fragments
+    std::vector<UInt32> order(peptides_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](UInt32 a, UInt32 b) { return peptides_[a].mass < peptides_[b].mass; });
+
+    std::vector<UInt32> new_index(peptides_.size());
+    std::vector<Peptide> sorted_peptides(peptides_.size());
+    for (Size i = 0; i < order.size(); ++i)
+    {
+      new_index[order[i]] = static_cast<UInt32>(i);
+      sorted_peptides[i] = peptides_[order[i]];
+    }
+    peptides_.swap(sorted_peptides);
+
+    for (Fragment& f : fragments_) f.peptide = new_index[f.peptide];
+
+    std::sort(fragments_.begin(), fragments_.end(), [](const Fragment& a, const Fragment& b)
+    {
+      if (a.mz != b.mz) return a.mz < b.mz;
+      return a.peptide < b.peptide;
+    });
+
+    // split into buckets and sort each of them by peptide index
+    const Size nr_buckets = (fragments_.size() + bucket_size_ - 1) / bucket_size_;
+    bucket_min_mz_.resize(nr_buckets);
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize b = 0; b < (SignedSize)nr_buckets; ++b)
+    {
+      auto first = fragments_.begin() + b * bucket_size_;
+      auto last = fragments_.begin() + std::min((b + 1) * bucket_size_, fragments_.size());
+      bucket_min_mz_[b] = first->mz;
+      std::sort(first, last, [](const Fragment& x, const Fragment& y)
+      {
+        if (x.peptide != y.peptide) return x.peptide < y.peptide;
+        return x.mz < y.mz;
+      });
+    }
+    built_ = true;
+  }
+
+  bool FragmentIndex::isBuilt() const
+  {
+    return built_;
+  }
+
+  Size FragmentIndex::getNrSequences() const
+  {
+    return sequence_offsets_.size() - 1;
+  }
+
+  Size FragmentIndex::getNrPeptides() const
+  {
+    return peptides_.size();
+  }
+
+  Size FragmentIndex::getNrFragments() const
+  {
+    return fragments_.size();
+  }
+
+  Size FragmentIndex::getBucketSize() const
+  {
+    return bucket_size_;
+  }
+
+  StringView FragmentIndex::getSequence(UInt32 index) const
+  {
+    const UInt64 start = sequence_offsets_[index];
+    return StringView(sequence_pool_).substr(start, sequence_offsets_[index + 1] - start);
+  }
+
+  const FragmentIndex::Peptide& FragmentIndex::getPeptide(Size index) const
+  {
+    return peptides_[index];
+  }
+
+  UInt32 FragmentIndex::getEntryId(Size index) const
+  {
+    return peptides_[index].modification_index;
+  }
+
+  std::pair<Size, Size> FragmentIndex::getPeptideRange(double min_mass, double max_mass) const
+  {
+    auto first = std::lower_bound(peptides_.begin(), peptides_.end(), min_mass, [](const Peptide& p, double m) { return p.mass < m; });
+    auto last = std::upper_bound(first, peptides_.end(), max_mass, [](double m, const Peptide& p) { return m < p.mass; });
+    return {Size(first - peptides_.begin()), Size(last - peptides_.begin())};
+  }
+
+  void FragmentIndex::query(const MSSpectrum& spectrum,
+    const std::vector<std::pair<Size, Size>>& peptide_ranges,
+    double fragment_mass_tolerance,
+    bool fragment_mass_tolerance_unit_ppm,
+    Size max_candidates,
+    Accumulator& accumulator,
+    std::vector<Candidate>& candidates) const
+  {
+    if (!built_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "FragmentIndex::build() needs to be called before querying.");
+    }
+    candidates.clear();
+
+    // merge overlapping ranges (e.g. of neighbouring isotope windows) so no fragment is counted twice
+    std::vector<std::pair<Size, Size>> ranges;
+    for (const auto& r : peptide_ranges)
+    {
+      if (r.first < r.second) ranges.push_back(r);
+    }
+    if (ranges.empty() || max_candidates == 0) return;
+    std::sort(ranges.begin(), ranges.end());
+    Size merged = 0;
+    for (Size i = 1; i < ranges.size(); ++i)
+    {
+      if (ranges[i].first <= ranges[merged].second)
+      {
+        ranges[merged].second = std::max(ranges[merged].second, ranges[i].second);
+      }
+      else
+      {
+        ranges[++merged] = ranges[i];
+      }
+    }
+    ranges.resize(merged + 1);
+
+    if (accumulator.matched_peaks.size() != peptides_.size())
+    {
+      accumulator.matched_peaks.assign(peptides_.size(), 0);
+      accumulator.summed_intensity.assign(peptides_.size(), 0.0f);
+    }
+    accumulator.touched.clear();
+
+    const Size nr_buckets = bucket_min_mz_.size();
+    for (const Peak1D& peak : spectrum)
+    {
+      const double tolerance = fragment_mass_tolerance_unit_ppm ? peak.getMZ() * fragment_mass_tolerance * 1e-6 : fragment_mass_tolerance;
+      const float mz_low = static_cast<float>(peak.getMZ() - tolerance);
+      const float mz_high = static_cast<float>(peak.getMZ() + tolerance);
+
+      // the bucket before the first one starting at or above mz_low may still contain matching fragments
+      Size b = std::lower_bound(bucket_min_mz_.begin(), bucket_min_mz_.end(), mz_low) - bucket_min_mz_.begin();
+      if (b > 0) --b;
+      for (; b < nr_buckets && bucket_min_mz_[b] <= mz_high; ++b)
+      {
+        const auto bucket_begin = fragments_.begin() + b * bucket_size_;
+        const auto bucket_end = fragments_.begin() + std::min((b + 1) * bucket_size_, fragments_.size());
+        for (const auto& r : ranges)
+        {
+          auto it = std::lower_bound(bucket_begin, bucket_end, r.first, [](const Fragment& f, Size p) { return f.peptide < p; });
+          for (; it != bucket_end && it->peptide < r.second; ++it)
+          {
+            if (it->mz < mz_low || it->mz > mz_high) continue;
+            if (accumulator.matched_peaks[it->peptide]++ == 0) accumulator.touched.push_back(it->peptide);
+            accumulator.summed_intensity[it->peptide] += peak.getIntensity();
+          }
+        }
+      }
+    }
+
+    // collect candidates and reset the accumulator for the next query
+    candidates.reserve(accumulator.touched.size());
+    for (UInt32 p : accumulator.touched)
+    {
+      const UInt32 matched = accumulator.matched_peaks[p];
+      const double score = std::log1p(accumulator.summed_intensity[p]) + std::lgamma(double(matched) + 1.0);
+      candidates.push_back({p, matched, score});
+      accumulator.matched_peaks[p] = 0;
+      accumulator.summed_intensity[p] = 0.0f;
+    }
+    accumulator.touched.clear();
+
+    if (candidates.size() > max_candidates)
+    {
+      std::partial_sort(candidates.begin(), candidates.begin() + max_candidates, candidates.end(), isBetterCandidate);
+      candidates.resize(max_candidates);
+    }
+    else
+    {
+      std::sort(candidates.begin(), candidates.end(), isBetterCandidate);
+    }
+  }
+
+  void FragmentIndex::store(const String& filename, const String& fingerprint) const
+  {
+    if (!built_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "FragmentIndex::build() needs to be called before storing.");
+    }
+    std::ofstream os(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if (!os)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, fragment_index_magic, sizeof(fragment_index_magic));
+    header.version = fragment_index_version;
+    header.header_size = sizeof(FileHeader);
+    header.fingerprint_size = fingerprint.size();
+    header.nr_sequences = getNrSequences();
+    header.sequence_bytes = sequence_pool_.size();
+    header.nr_peptides = peptides_.size();
+    header.nr_fragments = fragments_.size();
+    header.bucket_size = bucket_size_;
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+    os.write(fingerprint.data(), static_cast<std::streamsize>(fingerprint.size()));
+    writeVector(os, sequence_offsets_);
+    os.write(sequence_pool_.data(), static_cast<std::streamsize>(sequence_pool_.size()));
+    writeVector(os, peptides_);
+    writeVector(os, fragments_);
+    if (!os)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+  }
+
+  void FragmentIndex::load(const String& filename)
+  {
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    clear();
+
+    std::ifstream is(filename.c_str(), std::ios::binary);
+    FileHeader header;
+    bool ok = readHeader(is, header) && header.bucket_size > 0;
+    if (ok)
+    {
+      is.seekg(static_cast<std::streamoff>(header.fingerprint_size), std::ios::cur);
+      sequence_pool_.resize(header.sequence_bytes);
+      ok = readVector(is, sequence_offsets_, header.nr_sequences + 1);
+      if (ok && header.sequence_bytes > 0)
+      {
+        is.read(&sequence_pool_[0], static_cast<std::streamsize>(header.sequence_bytes));
+        ok = is.gcount() == static_cast<std::streamsize>(header.sequence_bytes);
+      }
+      ok = ok && readVector(is, peptides_, header.nr_peptides) && readVector(is, fragments_, header.nr_fragments);
+      ok = ok && sequence_offsets_.front() == 0 && sequence_offsets_.back() == header.sequence_bytes
+        && std::is_sorted(sequence_offsets_.begin(), sequence_offsets_.end())
+        && std::all_of(peptides_.begin(), peptides_.end(), [&header](const Peptide& p) { return p.sequence < header.nr_sequences || p.sequence == NO_SEQUENCE; })
+        && std::all_of(fragments_.begin(), fragments_.end(), [&header](const Fragment& f) { return f.peptide < header.nr_peptides; });
+    }
+    if (!ok)
+    {
+      clear();
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "File is not a valid fragment index.");
+    }
+
+    bucket_size_ = header.bucket_size;
+    const Size nr_buckets = (fragments_.size() + bucket_size_ - 1) / bucket_size_;
+    bucket_min_mz_.resize(nr_buckets);
+    for (Size b = 0; b < nr_buckets; ++b)
+    {
+      const auto first = fragments_.begin() + b * bucket_size_;
+      const auto last = fragments_.begin() + std::min((b + 1) * bucket_size_, fragments_.size());
+      bucket_min_mz_[b] = std::min_element(first, last, [](const Fragment& x, const Fragment& y) { return x.mz < y.mz; })->mz;
+    }
+    built_ = true;
+  }
+
+  bool FragmentIndex::isUpToDate(const String& filename, const String& fingerprint)
+  {
+    std::ifstream is(filename.c_str(), std::ios::binary);
+    FileHeader header;
+    if (!is || !readHeader(is, header) || header.fingerprint_size != fingerprint.size()) return false;
+    std::string stored(fingerprint.size(), '\0');
+    if (!stored.empty()) is.read(&stored[0], static_cast<std::streamsize>(stored.size()));
+    return is && stored == fingerprint;
+  }
+
+} // namespace OpenMS
@@ -183,5 +183,72 @@ namespace OpenMS
     return hyperScore;
   }
 
-}
+  double HyperScore::computeWithDetail(double fragment_mass_tolerance,
+    bool fragment_mass_tolerance_unit_ppm,
+    const PeakSpectrum& exp_spectrum,
+    const TheoreticalSpectrumGenerator::FragmentBuffer& theo_fragments,
+    PSMDetail& d)
+  {
+    if (exp_spectrum.empty() || theo_fragments.mz.empty())
+    {
+      return 0.0;
+    }
+
+    int y_ion_count = 0;
+    int b_ion_count = 0;
+    double dot_product = 0.0;
+    double abs_error = 0.0;
+
+    // same matching as MatchedIterator: for each theoretical fragment the closest experimental peak within the tolerance
+    const float tolerance = (float)fragment_mass_tolerance;
+    const Size exp_size = exp_spectrum.size();
+    Size t = 0;
+    for (Size r = 0; r < theo_fragments.mz.size(); ++r)
+    {
+      const double theo_mz = theo_fragments.mz[r];
+      const float max_dist = fragment_mass_tolerance_unit_ppm ? Math::ppmToMass(tolerance, (float)theo_mz) : tolerance;
+
+      float diff = std::numeric_limits<float>::max();
+      do
+      {
+        const float dist = fabs(theo_mz - exp_spectrum[t].getMZ());
+        if (diff > dist)
+        {
+          diff = dist;
+        }
+        else // overshot
+        {
+          --t;
+          break;
+        }
+        ++t;
+      } while (t != exp_size);
+      if (t == exp_size) --t;
 
+      if (diff > max_dist) continue;
+
+      const double exp_mz = exp_spectrum[t].getMZ();
+      abs_error += fragment_mass_tolerance_unit_ppm ? Math::getPPMAbs(exp_mz, theo_mz) : fabs(exp_mz - theo_mz);
+      dot_product += exp_spectrum[t].getIntensity();
+
+      const Residue::ResidueType ion_type = TheoreticalSpectrumGenerator::getIonType(theo_fragments.ion[r]);
+      if (ion_type == Residue::YIon)
+      {
+        ++y_ion_count;
+      }
+      else if (ion_type == Residue::BIon)
+      {
+        ++b_ion_count;
+      }
+    }
+
+    const int i_min = std::min(y_ion_count, b_ion_count);
+    const int i_max = std::max(y_ion_count, b_ion_count);
+    const double hyperScore = log1p(dot_product) + 2*logfactorial_(i_min) + logfactorial_(i_max, i_min + 1);
+    d.matched_b_ions = b_ion_count;
+    d.matched_y_ions = y_ion_count;
+    d.mean_error = (b_ion_count + y_ion_count) > 0 ? abs_error / (double)(b_ion_count + y_ion_count) : 0.0;
+    return hyperScore;
+  }
+
+}
@@ -506,7 +506,7 @@ namespace OpenMS
       if (!has_active_data)
         break; // leave while-loop
 
-      proteins.cacheChunk(PROTEIN_CACHE_SIZE);
+      proteins.prefetchChunk(PROTEIN_CACHE_SIZE);
 
 
       for (Size i = 0; i < prot_count; ++i)
@@ -585,6 +585,19 @@ namespace OpenMS
   }*/
 
 
+  vector<Size> IDBoostGraph::getCCsBySizeDescending_() const
+  {
+    vector<Size> order(ccs_.size());
+    vector<Size> sizes(ccs_.size());
+    for (Size i = 0; i < ccs_.size(); ++i)
+    {
+      order[i] = i;
+      sizes[i] = boost::num_vertices(ccs_[i]) + boost::num_edges(ccs_[i]);
+    }
+    std::stable_sort(order.begin(), order.end(), [&sizes](Size a, Size b) { return sizes[a] > sizes[b]; });
+    return order;
+  }
+
   /// Do sth on ccs
   void IDBoostGraph::applyFunctorOnCCs(const std::function<unsigned long(Graph&, unsigned int)>& functor)
   {
@@ -592,15 +605,18 @@ namespace OpenMS
       throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "No connected components annotated. Run computeConnectedComponents first!");
     }
 
-    // Use dynamic schedule because big CCs take much longer!
-    #pragma omp parallel for schedule(dynamic) default(none) shared(functor)
-    for (int i = 0; i < static_cast<int>(ccs_.size()); i += 1)
+    // Use dynamic schedule because big CCs take much longer! Start with the biggest ones, so that they do
+    // not end up running on a single thread while all other threads are already done.
+    const vector<Size> order = getCCsBySizeDescending_();
+    #pragma omp parallel for schedule(dynamic) default(none) shared(functor, order)
+    for (int j = 0; j < static_cast<int>(order.size()); j += 1)
     {
       #ifdef INFERENCE_BENCH
       StopWatch sw;
       sw.start();
       #endif
 
+      const Size i = order[j];
       Graph& curr_cc = ccs_.at(i);
 
       #ifdef INFERENCE_MT_DEBUG
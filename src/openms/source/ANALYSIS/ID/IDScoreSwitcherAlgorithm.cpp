@@ -8,7 +8,10 @@
 
 #include <OpenMS/ANALYSIS/ID/IDScoreSwitcherAlgorithm.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
+#include <OpenMS/METADATA/PSMTable.h>
+#include <cmath>
 #include <unordered_map>
+#include <utility>
 
 using namespace std;
 namespace OpenMS
@@ -39,4 +42,51 @@ namespace OpenMS
     if (new_score_type_.empty()) new_score_type_ = new_score_;
   }
 
+  void IDScoreSwitcherAlgorithm::switchScores(PSMTable& table, Size& counter)
+  {
+    if (!table.hasNumericColumn(new_score_))
+    {
+      throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                          "Meta value '" + new_score_ + "' not found in PSM table");
+    }
+    const vector<double>& new_scores = std::as_const(table).getNumericColumn(new_score_);
+    bool missing = false;
+#pragma omp parallel for reduction(||: missing)
+    for (SignedSize r = 0; r < (SignedSize)table.size(); ++r)
+    {
+      missing = missing || std::isnan(new_scores[r]);
+    }
+    if (missing)
+    {
+      throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                          "Meta value '" + new_score_ + "' not found for all PSMs");
+    }
+
+    const String old_score_meta = (old_score_.empty() ? table.getScoreType() : old_score_);
+    const bool old_score_exists = table.hasNumericColumn(old_score_meta);
+    vector<double>& old_scores = table.addNumericColumn(old_score_meta);
+    // keeps old scores that differ from an existing meta value of the same name
+    vector<double>* other_old_scores = old_score_exists ? &table.addNumericColumn(old_score_meta + "~") : nullptr;
+    vector<double>& scores = table.getScores();
+#pragma omp parallel for
+    for (SignedSize r = 0; r < (SignedSize)table.size(); ++r)
+    {
+      if (!std::isnan(old_scores[r]))
+      {
+        if (fabs((old_scores[r] - scores[r]) * 2.0 / (old_scores[r] + scores[r])) > tolerance_)
+        {
+          (*other_old_scores)[r] = scores[r];
+        }
+      }
+      else
+      {
+        old_scores[r] = scores[r];
+      }
+      scores[r] = new_scores[r];
+    }
+    counter += table.size();
+    table.setScoreType(new_score_type_);
+    table.setHigherScoreBetter(higher_better_);
+  }
+
 } // namespace OpenMS
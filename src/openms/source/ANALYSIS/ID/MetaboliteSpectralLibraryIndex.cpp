@@ -0,0 +1,207 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/MetaboliteSpectralLibraryIndex.h>
+
+#include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/CONCEPT/Macros.h>
+#include <OpenMS/FORMAT/FileHandler.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// sections: spectra (SpectrumRecord, sorted by precursor m/z), peak m/z (double), peak intensities
+    enum Section { SPECTRA, PEAK_MZ, PEAK_INTENSITY, NR_SECTIONS };
+
+    const Internal::MappedIndexFile::Format metabolite_library_index_format = {{'O', 'M', 'S', 'M', 'T', 'L', 'I', 'B'}, 2, NR_SECTIONS, "metabolite spectral library index"};
+
+    /// Meta value @p key of @p spectrum as string (empty if it is not set)
+    std::string metaString(const MSSpectrum& spectrum, const String& key)
+    {
+      return spectrum.getMetaValue(key, DataValue(String())).toString();
+    }
+  }
+
+  MetaboliteSpectralLibraryIndex::MetaboliteSpectralLibraryIndex() :
+    file_(metabolite_library_index_format)
+  {
+  }
+
+  MetaboliteSpectralLibraryIndex::~MetaboliteSpectralLibraryIndex()
+  {
+    close();
+  }
+
+  void MetaboliteSpectralLibraryIndex::create(const String& filename, const String& library_file)
+  {
+    PeakMap library;
+    FileHandler().loadExperiment(library_file, library, {FileTypes::MSP, FileTypes::MZML, FileTypes::MGF});
+    write_(filename, library, library_file);
+  }
+
+  void MetaboliteSpectralLibraryIndex::create(const String& filename, const PeakMap& library)
+  {
+    write_(filename, library, "");
+  }
+
+  void MetaboliteSpectralLibraryIndex::write_(const String& filename, const PeakMap& library, const String& library_file)
+  {
+    metabolite_library_index_format.checkedUInt32(library.size(), "spectra");
+    for (const MSSpectrum& spectrum : library)
+    {
+      if (spectrum.getPrecursors().empty())
+      {
+        throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            "Library spectrum '" + spectrum.getNativeID() + "' has no precursor.");
+      }
+      metabolite_library_index_format.checkedUInt32(spectrum.size(), "peaks per spectrum");
+    }
+
+    // sort by precursor m/z
+    std::vector<Size> order(library.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&library](Size a, Size b)
+    {
+      return library[a].getPrecursors()[0].getMZ() < library[b].getPrecursors()[0].getMZ();
+    });
+
+    Internal::MappedIndexFile::StringPool pool(metabolite_library_index_format);
+    std::vector<SpectrumRecord> spectra;
+    spectra.reserve(library.size());
+    UInt64 nr_peaks = 0;
+    for (const Size s : order)
+    {
+      const MSSpectrum& spectrum = library[s];
+      SpectrumRecord record{};
+      record.precursor_mz = spectrum.getPrecursors()[0].getMZ();
+      record.first_peak = nr_peaks;
+      record.nr_peaks = static_cast<UInt32>(spectrum.size());
+      record.charge = spectrum.getPrecursors()[0].getCharge();
+      record.library_index = static_cast<UInt32>(s);
+      record.primary_id = pool.add(metaString(spectrum, "Massbank_Accession_ID"));
+      record.secondary_id = pool.add(metaString(spectrum, "HMDB_ID"));
+      record.name = pool.add(metaString(spectrum, Constants::UserParam::MSM_METABOLITE_NAME));
+      record.sum_formula = pool.add(metaString(spectrum, Constants::UserParam::MSM_SUM_FORMULA));
+      record.inchi = pool.add(metaString(spectrum, Constants::UserParam::MSM_INCHI_STRING));
+      record.smiles = pool.add(metaString(spectrum, Constants::UserParam::MSM_SMILES_STRING));
+      record.adduct = pool.add(metaString(spectrum, Constants::UserParam::MSM_PRECURSOR_ADDUCT));
+      spectra.push_back(record);
+      nr_peaks += spectrum.size();
+    }
+
+    // peaks in the order of the spectrum records
+    Internal::MappedIndexFile::Writer writer(metabolite_library_index_format, filename, library_file, "", pool);
+    writer.addSection(spectra);
+    for (const Size s : order)
+    {
+      for (const Peak1D& p : library[s])
+      {
+        const double mz = p.getMZ();
+        writer.append(&mz, sizeof(double));
+      }
+    }
+    writer.endSection();
+    for (const Size s : order)
+    {
+      for (const Peak1D& p : library[s])
+      {
+        const Peak1D::IntensityType intensity = p.getIntensity();
+        writer.append(&intensity, sizeof(Peak1D::IntensityType));
+      }
+    }
+    writer.endSection();
+    writer.commit();
+  }
+
+  bool MetaboliteSpectralLibraryIndex::isUpToDate(const String& filename, const String& library_file)
+  {
+    return Internal::MappedIndexFile::isUpToDate(metabolite_library_index_format, filename, library_file, "");
+  }
+
+  void MetaboliteSpectralLibraryIndex::open(const String& filename)
+  {
+    close();
+    file_.open(filename);
+    try
+    {
+      Size nr_intensities = 0;
+      spectra_ = file_.getSection<SpectrumRecord>(SPECTRA, nr_spectra_);
+      peak_mz_ = file_.getSection<double>(PEAK_MZ, nr_peaks_);
+      peak_intensity_ = file_.getSection<Peak1D::IntensityType>(PEAK_INTENSITY, nr_intensities);
+      if (nr_intensities != nr_peaks_)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Metabolite spectral library index is truncated or corrupt.");
+      }
+    }
+    catch (...)
+    {
+      close();
+      throw;
+    }
+  }
+
+  void MetaboliteSpectralLibraryIndex::openOrCreate(const String& filename, const String& library_file)
+  {
+    close(); // the file may be replaced
+    if (!isUpToDate(filename, library_file))
+    {
+      OPENMS_LOG_INFO << "Creating spectral library index '" << filename << "' for '" << library_file << "'." << std::endl;
+      create(filename, library_file);
+    }
+    open(filename);
+  }
+
+  bool MetaboliteSpectralLibraryIndex::isOpen() const
+  {
+    return file_.isOpen();
+  }
+
+  void MetaboliteSpectralLibraryIndex::close()
+  {
+    file_.close();
+    spectra_ = nullptr;
+    peak_mz_ = nullptr;
+    peak_intensity_ = nullptr;
+    nr_spectra_ = nr_peaks_ = 0;
+  }
+
+  Size MetaboliteSpectralLibraryIndex::getNrSpectra() const
+  {
+    return nr_spectra_;
+  }
+
+  const MetaboliteSpectralLibraryIndex::SpectrumRecord& MetaboliteSpectralLibraryIndex::getSpectrum(Size index) const
+  {
+    OPENMS_PRECONDITION(index < nr_spectra_, "Spectrum index out of range")
+    return spectra_[index];
+  }
+
+  std::string_view MetaboliteSpectralLibraryIndex::getString(StringIndex index) const
+  {
+    return file_.getString(index);
+  }
+
+  SpectrumComparisonKernels::PeakArraysView MetaboliteSpectralLibraryIndex::getPeaks(Size index) const
+  {
+    const SpectrumRecord& record = getSpectrum(index);
+    return {peak_mz_ + record.first_peak, peak_intensity_ + record.first_peak, record.nr_peaks};
+  }
+
+  std::pair<Size, Size> MetaboliteSpectralLibraryIndex::getSpectrumRange(double min_mz, double max_mz) const
+  {
+    return Internal::MappedIndexFile::getRange(spectra_, nr_spectra_, min_mz, max_mz, [](const SpectrumRecord& r) { return r.precursor_mz; });
+  }
+
+}
@@ -8,9 +8,12 @@
 
 #include <OpenMS/ANALYSIS/ID/MetaboliteSpectralMatching.h>
 
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+#include <OpenMS/ANALYSIS/ID/MetaboliteSpectralLibraryIndex.h>
 #include <OpenMS/CONCEPT/Constants.h>
 
 #include <OpenMS/FORMAT/FileHandler.h>
+#include <OpenMS/SYSTEM/File.h>
 
 #include <numeric>
 #include <boost/math/special_functions/factorials.hpp>
@@ -272,6 +275,15 @@ namespace OpenMS
     defaults_.setValue("merge_spectra", "true", "Merge MS2 spectra with the same precursor mass.");
     defaults_.setValidStrings("merge_spectra", {"true","false"});
 
+    defaults_.setValue("analog_search", "false", "Also search for analogs: library spectra with a precursor m/z up to 'analog_max_mass_shift' away from the query, whose fragments may match either directly or shifted by the difference of the precursor m/z values (i.e. with the same neutral loss). Analog hits are reported in addition to the regular hits of a precursor (according to 'report_mode'), and the output gets the column 'opt_mass_shift'.");
+    defaults_.setValidStrings("analog_search", {"true","false"});
+
+    defaults_.setValue("analog_max_mass_shift", 200.0, "Maximum difference of the precursor m/z values (in Da) of an analog hit.", {"advanced"});
+    defaults_.setMinFloat("analog_max_mass_shift", 0.0);
+
+    defaults_.setValue("analog_max_candidates", 100, "Maximum number of library spectra per precursor that are scored in the analog search. Candidates are preselected by the number of fragment m/z values and neutral losses they share with the query.", {"advanced"});
+    defaults_.setMinInt("analog_max_candidates", 1);
+
     defaultsToParam_();
 
     this->setLogType(CMD);
@@ -410,18 +422,148 @@ namespace OpenMS
   }
 
 
-  void MetaboliteSpectralMatching::run(PeakMap& msexp, PeakMap& spec_db, MzTab& mztab_out, String& out_spectra)
+  double MetaboliteSpectralMatching::computeHyperScore_(
+    double fragment_mass_error,
+    bool fragment_mass_tolerance_unit_ppm,
+    const MSSpectrum& exp_spectrum,
+    const SpectrumComparisonKernels::PeakArraysView& db_peaks,
+    double mass_shift,
+    vector<double>& matched_db_intensity)
   {
-    sort(spec_db.begin(), spec_db.end(), PrecursorMZLess);
+    if (exp_spectrum.empty()) return 0;
+    if (matched_db_intensity.size() < exp_spectrum.size())
+    {
+      matched_db_intensity.resize(exp_spectrum.size(), -1.0);
+    }
+
+    // define m/z range to consider:
+    double min_exp_mz = exp_spectrum[0].getMZ(); // lowest experimental m/z
+    double mz_offset = fragment_mass_error;
+    if (fragment_mass_tolerance_unit_ppm)
+    {
+      mz_offset = min_exp_mz * fragment_mass_error * 1e-6;
+    }
+    const double mz_lower_bound = max(0.0, min_exp_mz - mz_offset);
+    double max_exp_mz = exp_spectrum.back().getMZ(); // highest experimental m/z
+    if (fragment_mass_tolerance_unit_ppm)
+    {
+      mz_offset = max_exp_mz * fragment_mass_error * 1e-6;
+    }
+    const double mz_upper_bound = max_exp_mz + mz_offset;
+
+    // find the closest experimental peak within the tolerance (-1 if there is none)
+    auto findMatch = [&](double db_mz)
+    {
+      const double tolerance = fragment_mass_tolerance_unit_ppm ? db_mz * fragment_mass_error * 1e-6 : fragment_mass_error;
+      return exp_spectrum.findNearest(db_mz, tolerance);
+    };
+
+    // for every DB peak in the valid m/z range, find the closest matching
+    // experimental peak; of several DB peaks matching the same experimental
+    // peak, the most intense one counts (negative: no match)
+    auto addMatch = [&matched_db_intensity](Int index, double db_intensity)
+    {
+      double& intensity = matched_db_intensity[index];
+      intensity = max(intensity, max(0.0, db_intensity));
+    };
+    const double* db_mz = db_peaks.mz;
+    if (mass_shift == 0.0)
+    {
+      const double* db_begin = lower_bound(db_mz, db_mz + db_peaks.size(), mz_lower_bound);
+      const double* db_end = upper_bound(db_mz, db_mz + db_peaks.size(), mz_upper_bound);
+      for (const double* db_it = db_begin; db_it < db_end; ++db_it)
+      {
+        const Int index = findMatch(*db_it);
+        if (index >= 0) addMatch(index, db_peaks.intensity[db_it - db_mz]);
+      }
+    }
+    else
+    {
+      // analog: DB peaks that do not match directly may match after the shift
+      for (Size i = 0; i < db_peaks.size(); ++i)
+      {
+        Int index = -1;
+        if (db_mz[i] >= mz_lower_bound && db_mz[i] <= mz_upper_bound)
+        {
+          index = findMatch(db_mz[i]);
+        }
+        const double shifted_mz = db_mz[i] + mass_shift;
+        if (index < 0 && shifted_mz >= mz_lower_bound && shifted_mz <= mz_upper_bound)
+        {
+          index = findMatch(shifted_mz);
+        }
+        if (index >= 0) addMatch(index, db_peaks.intensity[i]);
+      }
+    }
+
+    // sum up in the order of the experimental peaks (and reset the scratch space)
+    double dot_product = 0.0;
+    Size matched_ions_count = 0; // count obs. peaks only once
+    for (Size i = 0; i < exp_spectrum.size(); ++i)
+    {
+      if (matched_db_intensity[i] < 0.0) continue;
+      dot_product += matched_db_intensity[i] * exp_spectrum[i].getIntensity();
+      ++matched_ions_count;
+      matched_db_intensity[i] = -1.0;
+    }
+
+    double matched_ions_term = 0.0;
+
+    // return score 0 if too few matched ions
+    if (matched_ions_count < 3)
+    {
+      return matched_ions_term;
+    }
+
+    if (matched_ions_count <= boost::math::max_factorial<double>::value)
+    {
+      matched_ions_term = log(boost::math::factorial<double>(matched_ions_count));
+    }
+    else
+    {
+      matched_ions_term = log(boost::math::factorial<double>(boost::math::max_factorial<double>::value));
+    }
+
+    double hyperscore = log(dot_product) + matched_ions_term;
+    if (hyperscore < 0) hyperscore = 0;
 
-    vector<double> mz_keys;
+    return hyperscore;
+  }
 
-    // copy precursor m/z values to vector for searching
-    for (Size spec_idx = 0; spec_idx < spec_db.size(); ++spec_idx)
+
+  void MetaboliteSpectralMatching::buildAnalogIndex_(const MetaboliteSpectralLibraryIndex& spec_db, FragmentIndex& analog_index)
+  {
+    analog_index.clear();
+    vector<double> fragments;
+    for (Size i = 0; i < spec_db.getNrSpectra(); ++i)
     {
-      mz_keys.push_back(spec_db[spec_idx].getPrecursors()[0].getMZ());
+      const double precursor_mz = spec_db.getSpectrum(i).precursor_mz;
+      const SpectrumComparisonKernels::PeakArraysView peaks = spec_db.getPeaks(i);
+      fragments.clear();
+      for (Size k = 0; k < peaks.size(); ++k)
+      {
+        fragments.push_back(peaks.mz[k]);
+        fragments.push_back(peaks.mz[k] - precursor_mz); // neutral loss (negative, except above the precursor)
+      }
+      analog_index.addEntry((UInt32)i, precursor_mz, fragments);
     }
+    analog_index.build();
+  }
+
 
+  void MetaboliteSpectralMatching::run(PeakMap& msexp, PeakMap& spec_db, MzTab& mztab_out, String& out_spectra)
+  {
+    // index the library in a temporary file (removed at exit)
+    const String index_file = File::getTemporaryFile();
+    MetaboliteSpectralLibraryIndex::create(index_file, spec_db);
+    MetaboliteSpectralLibraryIndex index;
+    index.open(index_file);
+    run(msexp, index, mztab_out, out_spectra);
+  }
+
+
+  void MetaboliteSpectralMatching::run(PeakMap& msexp, const MetaboliteSpectralLibraryIndex& spec_db, MzTab& mztab_out, String& out_spectra)
+  {
     // remove potential noise peaks by selecting the ten most intense peak per 100 Da window
     WindowMower wm;
     Param wm_param;
@@ -448,120 +590,173 @@ namespace OpenMS
     }
 
 
-    // container storing results
-    vector<SpectralMatch> matching_results;
-
     bool fragment_error_unit_ppm(true);
     if (mz_error_unit_ == "Da") { fragment_error_unit_ppm = false; }
 
-    for (Size spec_idx = 0; spec_idx < msexp.size(); ++spec_idx)
+    // library spectra of the other ionization mode are skipped
+    const bool positive_mode = (ion_mode_ == "positive");
+    const bool negative_mode = (ion_mode_ == "negative");
+    auto ionModeMatches = [&](Int charge)
     {
-      // cout << "merged spectrum no. " << spec_idx << " with #fragment ions: " << msexp[spec_idx].size() << endl;
+      return !((positive_mode && charge < 0) || (negative_mode && charge > 0));
+    };
 
-      // iterate over all precursor masses
-      for (Size prec_idx = 0; prec_idx < msexp[spec_idx].getPrecursors().size(); ++prec_idx)
-      {
-        // get precursor m/z
-        double precursor_mz(msexp[spec_idx].getPrecursors()[prec_idx].getMZ());
+    // prefilter of the analog search
+    FragmentIndex analog_index;
+    if (analog_search_)
+    {
+      buildAnalogIndex_(spec_db, analog_index);
+    }
 
-        // cout << "precursor no. " << prec_idx << ": mz " << precursor_mz << " ";
+    // results per query spectrum, in the order of the precursors
+    vector<vector<SpectralMatch>> spectrum_results(msexp.size());
 
-        double prec_mz_lowerbound, prec_mz_upperbound;
+#pragma omp parallel
+    {
+      // per-thread buffers
+      vector<SpectralMatch> partial_results;
+      vector<double> matched_db_intensity;
+      FragmentIndex::Accumulator accumulator;
+      vector<FragmentIndex::Candidate> candidates;
+      MSSpectrum analog_query;
+
+#pragma omp for schedule(dynamic)
+      for (SignedSize spec_idx = 0; spec_idx < (SignedSize)msexp.size(); ++spec_idx)
+      {
+        const MSSpectrum& spectrum = msexp[spec_idx];
+        vector<SpectralMatch>& matching_results = spectrum_results[spec_idx];
 
-        if (!fragment_error_unit_ppm) // Da
+        auto addMatch = [&](Size search_idx, double precursor_mz, double hyperscore)
         {
-          prec_mz_lowerbound = precursor_mz - precursor_mz_error_;
-          prec_mz_upperbound = precursor_mz + precursor_mz_error_;
-        }
-        else // ppm
+          const MetaboliteSpectralLibraryIndex::SpectrumRecord& lib_spec = spec_db.getSpectrum(search_idx);
+          SpectralMatch tmp_match;
+          tmp_match.setObservedPrecursorMass(precursor_mz);
+          tmp_match.setFoundPrecursorMass(lib_spec.precursor_mz);
+          double obs_rt = floor(spectrum.getRT() * 10)/10.0;
+          tmp_match.setObservedPrecursorRT(obs_rt);
+          tmp_match.setFoundPrecursorCharge(lib_spec.charge);
+          tmp_match.setMatchingScore(hyperscore);
+          tmp_match.setObservedSpectrumIndex(spec_idx);
+          tmp_match.setMatchingSpectrumIndex(lib_spec.library_index);
+          tmp_match.setObservedSpectrumNativeID(spectrum.getNativeID());
+
+          tmp_match.setPrimaryIdentifier(String(spec_db.getString(lib_spec.primary_id)));
+          tmp_match.setSecondaryIdentifier(String(spec_db.getString(lib_spec.secondary_id)));
+          tmp_match.setSumFormula(String(spec_db.getString(lib_spec.sum_formula)));
+          tmp_match.setCommonName(String(spec_db.getString(lib_spec.name)));
+          tmp_match.setInchiString(String(spec_db.getString(lib_spec.inchi)));
+          tmp_match.setSMILESString(String(spec_db.getString(lib_spec.smiles)));
+          tmp_match.setPrecursorAdduct(String(spec_db.getString(lib_spec.adduct)));
+
+          partial_results.push_back(tmp_match);
+        };
+
+        // report the best (or top three) of partial_results
+        auto reportMatches = [&]()
         {
-          double ppm_offset(precursor_mz * 1e-6 * precursor_mz_error_);
-          prec_mz_lowerbound = precursor_mz - ppm_offset;
-          prec_mz_upperbound = precursor_mz + ppm_offset;
-        }
-
-        // cout << "lower mz: " << prec_mz_lowerbound << " ";
-        // cout << "upper mz: " << prec_mz_upperbound << endl;
-
-        vector<double>::const_iterator lower_it = lower_bound(mz_keys.begin(), mz_keys.end(), prec_mz_lowerbound);
-        vector<double>::const_iterator upper_it = upper_bound(mz_keys.begin(), mz_keys.end(), prec_mz_upperbound);
-
-        Size start_idx(lower_it - mz_keys.begin());
-        Size end_idx(upper_it - mz_keys.begin());
+          // sort results by decreasing store
+          sort(partial_results.begin(), partial_results.end(), SpectralMatchScoreGreater);
 
-        //cout << "identifying " << msexp[spec_idx].getMetaValue("Massbank_Accession_ID") << endl;
+          const Size last_result_idx = (report_mode_ == "top3") ? min(Size(3), partial_results.size()) : min(Size(1), partial_results.size());
+          matching_results.insert(matching_results.end(), partial_results.begin(), partial_results.begin() + last_result_idx);
+        };
 
-        vector<SpectralMatch> partial_results;
-
-        for (Size search_idx = start_idx; search_idx < end_idx; ++search_idx)
+        // iterate over all precursor masses
+        for (Size prec_idx = 0; prec_idx < spectrum.getPrecursors().size(); ++prec_idx)
         {
-          // do spectral matching
-          // cout << "scanning " << spec_db[search_idx].getPrecursors()[0].getMZ() << " " << spec_db[search_idx].getMetaValue("Metabolite_Name") << endl;
+          // get precursor m/z
+          double precursor_mz(spectrum.getPrecursors()[prec_idx].getMZ());
+
+          double prec_mz_lowerbound, prec_mz_upperbound;
 
-          // check for charge state of precursor ions: do they match?
-          if ( (ion_mode_ == "positive" && spec_db[search_idx].getPrecursors()[0].getCharge() < 0) || (ion_mode_ == "negative" && spec_db[search_idx].getPrecursors()[0].getCharge() > 0))
+          if (!fragment_error_unit_ppm) // Da
           {
-            continue;
+            prec_mz_lowerbound = precursor_mz - precursor_mz_error_;
+            prec_mz_upperbound = precursor_mz + precursor_mz_error_;
           }
-
-          double hyperscore(computeHyperScore(fragment_mz_error_, fragment_error_unit_ppm, msexp[spec_idx], spec_db[search_idx], 0.0));
-
-          // cout << " scored with " << hyperScore << endl;
-          if (hyperscore > 0)
+          else // ppm
           {
-            // cout << "  ** detected " << spec_db[search_idx].getMetaValue("Massbank_Accession_ID") << " " << spec_db[search_idx].getMetaValue("Metabolite_Name") << " scored with " << hyperscore << endl;
-
-            // score result temporarily
-            SpectralMatch tmp_match;
-            tmp_match.setObservedPrecursorMass(precursor_mz);
-            tmp_match.setFoundPrecursorMass(spec_db[search_idx].getPrecursors()[0].getMZ());
-            double obs_rt = floor(msexp[spec_idx].getRT() * 10)/10.0;
-            tmp_match.setObservedPrecursorRT(obs_rt);
-            tmp_match.setFoundPrecursorCharge(spec_db[search_idx].getPrecursors()[0].getCharge());
-            tmp_match.setMatchingScore(hyperscore);
-            tmp_match.setObservedSpectrumIndex(spec_idx);
-            tmp_match.setMatchingSpectrumIndex(search_idx);
-            tmp_match.setObservedSpectrumNativeID(msexp[spec_idx].getNativeID());
-
-            tmp_match.setPrimaryIdentifier(spec_db[search_idx].getMetaValue("Massbank_Accession_ID"));
-            tmp_match.setSecondaryIdentifier(spec_db[search_idx].getMetaValue("HMDB_ID"));
-            tmp_match.setSumFormula(spec_db[search_idx].getMetaValue(Constants::UserParam::MSM_SUM_FORMULA));
-            tmp_match.setCommonName(spec_db[search_idx].getMetaValue(Constants::UserParam::MSM_METABOLITE_NAME));
-            tmp_match.setInchiString(spec_db[search_idx].getMetaValue(Constants::UserParam::MSM_INCHI_STRING));
-            tmp_match.setSMILESString(spec_db[search_idx].getMetaValue(Constants::UserParam::MSM_SMILES_STRING));
-            tmp_match.setPrecursorAdduct(spec_db[search_idx].getMetaValue(Constants::UserParam::MSM_PRECURSOR_ADDUCT));
-
-            partial_results.push_back(tmp_match);
+            double ppm_offset(precursor_mz * 1e-6 * precursor_mz_error_);
+            prec_mz_lowerbound = precursor_mz - ppm_offset;
+            prec_mz_upperbound = precursor_mz + ppm_offset;
           }
-        }
 
-        // sort results by decreasing store
-        sort(partial_results.begin(), partial_results.end(), SpectralMatchScoreGreater);
-
-        // report mode: top3 or best?
-        if (report_mode_ == "top3")
-        {
-          Size num_results(partial_results.size());
+          const pair<Size, Size> range = spec_db.getSpectrumRange(prec_mz_lowerbound, prec_mz_upperbound);
 
-          Size last_result_idx = (num_results >= 3) ? 3 : num_results;
+          partial_results.clear();
+          for (Size search_idx = range.first; search_idx < range.second; ++search_idx)
+          {
+            // check for charge state of precursor ions: do they match?
+            if (!ionModeMatches(spec_db.getSpectrum(search_idx).charge))
+            {
+              continue;
+            }
+
+            double hyperscore(computeHyperScore_(fragment_mz_error_, fragment_error_unit_ppm, spectrum, spec_db.getPeaks(search_idx), 0.0, matched_db_intensity));
+
+            if (hyperscore > 0)
+            {
+              addMatch(search_idx, precursor_mz, hyperscore);
+            }
+          }
+          reportMatches();
 
-          for (Size result_idx = 0; result_idx < last_result_idx; ++result_idx)
+          if (!analog_search_ || spectrum.empty())
           {
-            // cout << "score: " << partial_results[result_idx].getMatchingScore() << " " << partial_results[result_idx].getMatchingSpectrumIndex() << endl;
-            matching_results.push_back(partial_results[result_idx]);
+            continue;
           }
-        }
 
-        if (report_mode_ == "best")
-        {
-          if (!partial_results.empty())
+          // analog search: library spectra outside of the precursor window that
+          // share fragments or neutral losses with the query (at least three
+          // shared peaks are needed for a positive hyperscore)
+          // (ranges of the analog index, its order of spectra with equal precursor m/z may differ from the library)
+          const pair<Size, Size> analog_range = analog_index.getPeptideRange(precursor_mz - analog_max_mass_shift_, precursor_mz + analog_max_mass_shift_);
+          pair<Size, Size> exact_range = analog_index.getPeptideRange(prec_mz_lowerbound, prec_mz_upperbound);
+          exact_range.first = max(exact_range.first, analog_range.first);
+          exact_range.second = min(exact_range.second, analog_range.second);
+          analog_query.clear(false);
+          for (const Peak1D& peak : spectrum)
           {
-            matching_results.push_back(partial_results[0]);
+            analog_query.emplace_back(peak.getMZ(), peak.getIntensity());
+            analog_query.emplace_back(peak.getMZ() - precursor_mz, peak.getIntensity());
           }
-        }
+          // (neutral losses are matched with the largest fragment tolerance of the spectrum)
+          const double max_fragment_mz = spectrum.back().getMZ() * (1.0 + fragment_mz_error_ * 1e-6);
+          const double analog_tolerance = fragment_error_unit_ppm ? max_fragment_mz * fragment_mz_error_ * 1e-6 : fragment_mz_error_;
+          analog_index.query(analog_query, {{analog_range.first, exact_range.first}, {exact_range.second, analog_range.second}},
+                             analog_tolerance, false, analog_max_candidates_, accumulator, candidates);
+
+          partial_results.clear();
+          for (const FragmentIndex::Candidate& candidate : candidates)
+          {
+            if (candidate.matched_peaks < 3) continue;
+            const Size search_idx = analog_index.getEntryId(candidate.peptide);
+            const MetaboliteSpectralLibraryIndex::SpectrumRecord& lib_spec = spec_db.getSpectrum(search_idx);
+            if (!ionModeMatches(lib_spec.charge))
+            {
+              continue;
+            }
+
+            double hyperscore(computeHyperScore_(fragment_mz_error_, fragment_error_unit_ppm, spectrum, spec_db.getPeaks(search_idx), precursor_mz - lib_spec.precursor_mz, matched_db_intensity));
+
+            if (hyperscore > 0)
+            {
+              addMatch(search_idx, precursor_mz, hyperscore);
+            }
+          }
+          reportMatches();
+
+        } // end precursor loop
+      } // end spectra loop
+    }
 
-      } // end precursor loop
-    } // end spectra loop
+    // container storing results
+    vector<SpectralMatch> matching_results;
+    for (vector<SpectralMatch>& results : spectrum_results)
+    {
+      matching_results.insert(matching_results.end(), results.begin(), results.end());
+      vector<SpectralMatch>().swap(results);
+    }
 
     // write final results to MzTab
     exportMzTab_(matching_results, mztab_out);
@@ -579,6 +774,9 @@ namespace OpenMS
     mz_error_unit_ = param_.getValue("mass_error_unit").toString();
     report_mode_ = param_.getValue("report_mode").toString();
     merge_spectra_ = (bool)param_.getValue("merge_spectra").toBool();
+    analog_search_ = (bool)param_.getValue("analog_search").toBool();
+    analog_max_mass_shift_ = (double)param_.getValue("analog_max_mass_shift");
+    analog_max_candidates_ = (Size)(int)param_.getValue("analog_max_candidates");
   }
 
 
@@ -776,6 +974,17 @@ namespace OpenMS
       col5.second = spec_native_id_str;
       optionals.push_back(col5);
 
+      // set precursor m/z difference (analog search)
+      if (analog_search_)
+      {
+        MzTabString mass_shift_str;
+        mass_shift_str.set(String(current_id.getObservedPrecursorMass() - current_id.getFoundPrecursorMass()));
+        MzTabOptionalColumnEntry col6;
+        col6.first = "opt_mass_shift";
+        col6.second = mass_shift_str;
+        optionals.push_back(col6);
+      }
+
       mztab_row_record.opt_ = optionals;
 
       all_sm_rows.push_back(mztab_row_record);
@@ -472,7 +472,7 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
 
         #pragma omp master
         {
-          proteins.cacheChunk(PROTEIN_CACHE_SIZE);
+          proteins.prefetchChunk(PROTEIN_CACHE_SIZE); // read the next chunk in the background, so the master thread can join the search
           protein_is_decoy.resize(proteins.getChunkOffset() + prot_count);
           for (SignedSize i = 0; i < prot_count; ++i)
           { // do this in master only, to avoid false sharing
@@ -11,6 +11,7 @@
 #include <OpenMS/config.h>
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/METADATA/PSMTable.h>
 
 #include <boost/lexical_cast.hpp>
 
@@ -745,7 +746,44 @@ namespace OpenMS
       }
     }
 
-    
+
+    void PercolatorFeatureSetHelper::checkExtraFeatures(const PSMTable& table, StringList& extra_features)
+    {
+      StringList available;
+      for (const String& ef : extra_features)
+      {
+        bool complete = true;
+        if (table.hasNumericColumn(ef))
+        {
+          const vector<double>& column = table.getNumericColumn(ef);
+#pragma omp parallel for reduction(&&: complete)
+          for (SignedSize r = 0; r < (SignedSize)column.size(); ++r)
+          {
+            complete = complete && !std::isnan(column[r]);
+          }
+        }
+        else if (table.hasStringColumn(ef))
+        {
+          const vector<UInt32>& column = table.getStringColumn(ef);
+          complete = std::find(column.begin(), column.end(), PSMTable::MISSING) == column.end();
+        }
+        else
+        {
+          complete = table.empty();
+        }
+
+        if (complete)
+        {
+          available.push_back(ef);
+        }
+        else
+        {
+          OPENMS_LOG_WARN << "A extra_feature requested (" << ef << ") was not available - removed." << endl;
+        }
+      }
+      extra_features.swap(available);
+    }
+
     // Function adapted from MSGFPlusReader in Percolator converter
     double PercolatorFeatureSetHelper::rescaleFragmentFeature_(double featureValue, int NumMatchedMainIons)
     {
@@ -8,11 +8,13 @@
 
 #include <OpenMS/ANALYSIS/ID/SimpleSearchEngineAlgorithm.h>
 
+#include <OpenMS/ANALYSIS/ID/DigestStore.h>
 #include <OpenMS/ANALYSIS/ID/PeptideIndexing.h>
 #include <OpenMS/ANALYSIS/ID/HyperScore.h>
 #include <OpenMS/CHEMISTRY/DecoyGenerator.h>
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/CHEMISTRY/ProteaseDB.h>
+#include <OpenMS/CHEMISTRY/ResidueDB.h>
 #include <OpenMS/CHEMISTRY/ResidueModification.h>
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
 #include <OpenMS/COMPARISON/SpectrumAlignment.h>
@@ -37,6 +39,7 @@
 #include <OpenMS/METADATA/SpectrumSettings.h>
 
 #include <algorithm>
+#include <filesystem>
 #include <map>
 #ifdef _OPENMP
   #include <omp.h>
@@ -120,6 +123,22 @@ namespace OpenMS
     defaults_.setValue("report:top_hits", 1, "Maximum number of top scoring hits per spectrum that are reported.");
     defaults_.setSectionDescription("report", "Reporting Options");
 
+    defaults_.setValue("search_mode", "classic", "'classic' scores every database peptide against all spectra with a matching precursor mass. "
+      "'fragment_index' precomputes the fragments of all peptides into an inverted index and only rescores the best candidates of each spectrum; "
+      "this is much faster for large databases and wide precursor mass tolerances (e.g. open searches).");
+    defaults_.setValidStrings("search_mode", {"classic", "fragment_index"});
+
+    defaults_.setValue("digest_store", "", "Optional file to keep the digested database (all peptides and their modified variants) between runs of the 'classic' search. "
+      "If it exists and was created from the same database and settings it is used, otherwise it is created. Cannot be combined with 'decoys'.", {"advanced"});
+
+    defaults_.setValue("fragment_index:candidates", 50, "Number of best candidates per spectrum (by number of matched fragments and summed intensity) that are rescored with the HyperScore.");
+    defaults_.setMinInt("fragment_index:candidates", 1);
+    defaults_.setValue("fragment_index:bucket_size", 8192, "Number of fragments per m/z bucket of the index.", {"advanced"});
+    defaults_.setMinInt("fragment_index:bucket_size", 1);
+    defaults_.setValue("fragment_index:file", "", "Optional file to keep the fragment index between runs. "
+      "If it exists and was created from the same database and settings it is loaded, otherwise the index is built and written to this file.", {"advanced"});
+    defaults_.setSectionDescription("fragment_index", "Fragment index options (only used with search_mode 'fragment_index')");
+
     defaultsToParam_();
   }
 
@@ -164,6 +183,12 @@ namespace OpenMS
 
     report_top_hits_ = param_.getValue("report:top_hits");
 
+    search_mode_ = param_.getValue("search_mode").toString();
+    fragment_index_candidates_ = (Int)param_.getValue("fragment_index:candidates");
+    fragment_index_bucket_size_ = (Int)param_.getValue("fragment_index:bucket_size");
+    fragment_index_file_ = param_.getValue("fragment_index:file").toString();
+    digest_store_file_ = param_.getValue("digest_store").toString();
+
     decoys_ = param_.getValue("decoys") == "true";
     annotate_psm_ = ListUtils::toStringList<std::string>(param_.getValue("annotate:PSM"));
   }
@@ -397,8 +422,247 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
     protein_ids[0].setSearchParameters(std::move(search_parameters));
   }
 
+  void SimpleSearchEngineAlgorithm::buildFragmentIndex_(const vector<FASTAFile::FASTAEntry>& fasta_db,
+    const String& database_name,
+    const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+    const ModifiedPeptideGenerator::MapToResidueType& variable_modifications,
+    FragmentIndex& fragment_index) const
+  {
+    // everything the content of the index depends on
+    String fingerprint = "db=" + database_name;
+    std::error_code ec;
+    if (std::filesystem::exists(database_name.c_str(), ec))
+    {
+      fingerprint += ";db_size=" + String(std::filesystem::file_size(database_name.c_str(), ec))
+        + ";db_time=" + String(Int64(std::filesystem::last_write_time(database_name.c_str(), ec).time_since_epoch().count()));
+    }
+    fingerprint += ";enzyme=" + enzyme_
+      + ";missed_cleavages=" + String(peptide_missed_cleavages_)
+      + ";min_size=" + String(peptide_min_size_)
+      + ";max_size=" + String(peptide_max_size_)
+      + ";motif=" + peptide_motif_
+      + ";fixed=" + ListUtils::concatenate(modifications_fixed_, ",")
+      + ";variable=" + ListUtils::concatenate(modifications_variable_, ",")
+      + ";max_variable_mods=" + String(modifications_max_variable_mods_per_peptide_)
+      + ";decoys=" + (decoys_ ? "true" : "false")
+      + ";bucket_size=" + String(fragment_index_bucket_size_);
+
+    if (!fragment_index_file_.empty() && FragmentIndex::isUpToDate(fragment_index_file_, fingerprint))
+    {
+      OPENMS_LOG_INFO << "Loading fragment index from '" << fragment_index_file_ << "'." << endl;
+      fragment_index.load(fragment_index_file_);
+      return;
+    }
+
+    boost::regex peptide_motif_regex(peptide_motif_);
+    ProteaseDigestion digestor;
+    digestor.setEnzyme(enzyme_);
+    digestor.setMissedCleavages(peptide_missed_cleavages_);
+
+    // digest all proteins, then collect the unique peptides in database order (keeps the index deterministic)
+    startProgress(0, 1, "Digesting database...");
+    vector<vector<StringView> > digests(fasta_db.size());
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
+    {
+      vector<StringView> current_digest;
+      digestor.digestUnmodified(fasta_db[fasta_index].sequence, current_digest, peptide_min_size_, peptide_max_size_);
+      for (const auto& c : current_digest)
+      {
+        const String current_peptide = c.getString();
+        if (current_peptide.find_first_of("XBZ") != std::string::npos) continue;
+        // if a peptide motif is provided skip all peptides without match
+        if (!peptide_motif_.empty() && !boost::regex_match(current_peptide, peptide_motif_regex)) continue;
+        digests[fasta_index].push_back(c);
+      }
+    }
+
+    set<StringView> processed_peptides;
+    vector<StringView> unique_peptides;
+    for (auto& digest : digests)
+    {
+      for (const auto& c : digest)
+      {
+        if (processed_peptides.insert(c).second) unique_peptides.push_back(c);
+      }
+      vector<StringView>().swap(digest);
+    }
+    endProgress();
+
+    // fragments used for candidate retrieval: b and y ions with charge 1 (same ion series as the scoring)
+    TheoreticalSpectrumGenerator spectrum_generator;
+    Param param(spectrum_generator.getParameters());
+    param.setValue("add_first_prefix_ion", "true");
+    spectrum_generator.setParameters(param);
+
+    struct IndexEntry
+    {
+      UInt32 modification_index;
+      double mass;
+      vector<double> fragment_mz;
+    };
+
+    // generate the modified variants block-wise in parallel, but add them to the index in database order
+    const Size block_size = 4096;
+    fragment_index.clear();
+    startProgress(0, unique_peptides.size(), "Building fragment index...");
+    for (Size block_start = 0; block_start < unique_peptides.size(); block_start += block_size)
+    {
+      const Size block_end = std::min(block_start + block_size, unique_peptides.size());
+      vector<vector<IndexEntry> > block(block_end - block_start);
+
+#pragma omp parallel for schedule(dynamic)
+      for (SignedSize i = 0; i < (SignedSize)block.size(); ++i)
+      {
+        // ResidueDB and ModificationsDB are frozen (see search()): parsing does not lock
+        vector<AASequence> all_modified_peptides;
+        AASequence aas = AASequence::fromString(unique_peptides[block_start + i].getString());
+        ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
+        ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, modifications_max_variable_mods_per_peptide_, all_modified_peptides);
+
+        TheoreticalSpectrumGenerator::PrefixSuffixMasses prefix_suffix_masses;
+        TheoreticalSpectrumGenerator::FragmentBuffer theo_fragments;
+        block[i].reserve(all_modified_peptides.size());
+        for (Size mod_pep_idx = 0; mod_pep_idx < all_modified_peptides.size(); ++mod_pep_idx)
+        {
+          const AASequence& candidate = all_modified_peptides[mod_pep_idx];
+          TheoreticalSpectrumGenerator::getPrefixSuffixMasses(candidate, prefix_suffix_masses);
+          spectrum_generator.getFragmentMZs(prefix_suffix_masses, 1, 1, theo_fragments);
+          block[i].push_back({(UInt32)mod_pep_idx, candidate.getMonoWeight(), theo_fragments.mz});
+        }
+      }
+
+      for (Size i = 0; i < block.size(); ++i)
+      {
+        const UInt32 sequence_index = fragment_index.addSequence(unique_peptides[block_start + i].getString());
+        for (const IndexEntry& entry : block[i])
+        {
+          fragment_index.addPeptide(sequence_index, entry.modification_index, entry.mass, entry.fragment_mz);
+        }
+      }
+      setProgress(block_end);
+    }
+    fragment_index.build(fragment_index_bucket_size_);
+    endProgress();
+
+    OPENMS_LOG_INFO << "Fragment index: " << fragment_index.getNrSequences() << " peptides, "
+                    << fragment_index.getNrPeptides() << " modified variants, "
+                    << fragment_index.getNrFragments() << " fragments." << endl;
+
+    if (!fragment_index_file_.empty())
+    {
+      fragment_index.store(fragment_index_file_, fingerprint);
+    }
+  }
+
+  void SimpleSearchEngineAlgorithm::searchFragmentIndex_(const PeakMap& spectra,
+    const FragmentIndex& fragment_index,
+    const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+    const ModifiedPeptideGenerator::MapToResidueType& variable_modifications,
+    const TheoreticalSpectrumGenerator& spectrum_generator,
+    vector<vector<AnnotatedHit_> >& annotated_hits) const
+  {
+    const bool precursor_mass_tolerance_unit_ppm = (precursor_mass_tolerance_unit_ == "ppm");
+    const bool fragment_mass_tolerance_unit_ppm = (fragment_mass_tolerance_unit_ == "ppm");
+
+    startProgress(0, spectra.size(), "Scoring spectra against fragment index...");
+    Size count_spectra(0);
+
+#pragma omp parallel
+    {
+      // per-thread candidate accumulator
+      FragmentIndex::Accumulator accumulator;
+      vector<FragmentIndex::Candidate> candidates;
+      vector<pair<Size, Size> > peptide_ranges;
+      TheoreticalSpectrumGenerator::PrefixSuffixMasses prefix_suffix_masses;
+      TheoreticalSpectrumGenerator::FragmentBuffer theo_fragments;
+
+#pragma omp for schedule(dynamic)
+      for (SignedSize scan_index = 0; scan_index < (SignedSize)spectra.size(); ++scan_index)
+      {
+        #pragma omp atomic
+        ++count_spectra;
+
+        IF_MASTERTHREAD
+        {
+          setProgress(count_spectra);
+        }
+
+        const PeakSpectrum& exp_spectrum = spectra[scan_index];
+        const vector<Precursor>& precursor = exp_spectrum.getPrecursors();
+
+        // same spectrum requirements as in the classic search
+        if (precursor.size() != 1 || exp_spectrum.size() < peptide_min_size_) continue;
+
+        const Size precursor_charge = precursor[0].getCharge();
+        if (precursor_charge < precursor_min_charge_ || precursor_charge > precursor_max_charge_) continue;
+
+        // peptide mass windows, one per considered isotope (the tolerance is relative to the peptide mass)
+        peptide_ranges.clear();
+        for (int isotope_number : precursor_isotopes_)
+        {
+          double precursor_mass = (double) precursor_charge * precursor[0].getMZ() - (double) precursor_charge * Constants::PROTON_MASS_U;
+          if (isotope_number != 0) { precursor_mass -= isotope_number * Constants::C13C12_MASSDIFF_U; }
+
+          if (precursor_mass_tolerance_unit_ppm)
+          {
+            const double tolerance = precursor_mass_tolerance_ * 1e-6;
+            peptide_ranges.push_back(fragment_index.getPeptideRange(precursor_mass / (1.0 + tolerance), precursor_mass / (1.0 - tolerance)));
+          }
+          else
+          {
+            peptide_ranges.push_back(fragment_index.getPeptideRange(precursor_mass - precursor_mass_tolerance_, precursor_mass + precursor_mass_tolerance_));
+          }
+        }
+
+        fragment_index.query(exp_spectrum, peptide_ranges, fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm,
+          fragment_index_candidates_, accumulator, candidates);
+
+        // exact scoring of the retrieved candidates (each spectrum is processed by one thread, so no locking is needed)
+        for (const FragmentIndex::Candidate& c : candidates)
+        {
+          const FragmentIndex::Peptide& peptide = fragment_index.getPeptide(c.peptide);
+          const StringView sequence = fragment_index.getSequence(peptide.sequence);
+
+          // ResidueDB and ModificationsDB are frozen (see search()): parsing does not lock
+          vector<AASequence> all_modified_peptides;
+          AASequence aas = AASequence::fromString(sequence.getString());
+          ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
+          ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, modifications_max_variable_mods_per_peptide_, all_modified_peptides);
+
+          TheoreticalSpectrumGenerator::getPrefixSuffixMasses(all_modified_peptides[peptide.modification_index], prefix_suffix_masses);
+          spectrum_generator.getFragmentMZs(prefix_suffix_masses, 1, 1, theo_fragments);
+
+          HyperScore::PSMDetail detail;
+          const double score = HyperScore::computeWithDetail(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_fragments, detail);
+
+          if (score == 0)
+          {
+            continue; // no hit?
+          }
+
+          AnnotatedHit_ ah;
+          ah.sequence = sequence;
+          ah.peptide_mod_index = peptide.modification_index;
+          ah.score = score;
+          ah.prefix_fraction = (double)detail.matched_b_ions/(double)sequence.size();
+          ah.suffix_fraction = (double)detail.matched_y_ions/(double)sequence.size();
+          ah.mean_error = detail.mean_error;
+          annotated_hits[scan_index].push_back(ah);
+        }
+      }
+    }
+    endProgress();
+  }
+
   SimpleSearchEngineAlgorithm::ExitCodes SimpleSearchEngineAlgorithm::search(const String& in_mzML, const String& in_db, vector<ProteinIdentification>& protein_ids, vector<PeptideIdentification>& peptide_ids) const
   {
+    if (decoys_ && !digest_store_file_.empty() && search_mode_ == "classic")
+    {
+      OPENMS_LOG_ERROR << "Decoys are generated in memory and cannot be kept in a digest store. Use a database that contains decoys instead." << endl;
+      return ExitCodes::ILLEGAL_PARAMETERS;
+    }
+
     boost::regex peptide_motif_regex(peptide_motif_);
 
     bool precursor_mass_tolerance_unit_ppm = (precursor_mass_tolerance_unit_ == "ppm");
@@ -406,6 +670,9 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
 
     ModifiedPeptideGenerator::MapToResidueType fixed_modifications = ModifiedPeptideGenerator::getModifications(modifications_fixed_);
     ModifiedPeptideGenerator::MapToResidueType variable_modifications = ModifiedPeptideGenerator::getModifications(modifications_variable_);
+    // all modified residues of the search exist now: lookups in the parallel regions do not need to lock
+    ResidueDB::getInstance()->freeze();
+    ModificationsDB::getInstance()->freeze();
 
     // load MS2 map
     PeakMap spectra;
@@ -460,7 +727,6 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
     TheoreticalSpectrumGenerator spectrum_generator;
     Param param(spectrum_generator.getParameters());
     param.setValue("add_first_prefix_ion", "true");
-    param.setValue("add_metainfo", "true");
     spectrum_generator.setParameters(param);
 
     // preallocate storage for PSMs
@@ -501,156 +767,224 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
       shuffler.portable_random_shuffle(fasta_db.begin(), fasta_db.end());
       endProgress();
     }
-    ProteaseDigestion digestor;
-    digestor.setEnzyme(enzyme_);
-    digestor.setMissedCleavages(peptide_missed_cleavages_);
-    startProgress(0, fasta_db.size(), "Scoring peptide models against spectra...");
-
-    // lookup for processed peptides. must be defined outside of omp section and synchronized
-    set<StringView> processed_petides;
 
-    Size count_proteins(0), count_peptides(0);
+    // MS2 precursors that match to a peptide mass
+    auto matchingSpectra = [&](double peptide_mass)
+    {
+      const double tolerance = precursor_mass_tolerance_unit_ppm ? peptide_mass * precursor_mass_tolerance_ * 1e-6 : precursor_mass_tolerance_;
+      return make_pair(multimap_mass_2_scan_index.lower_bound(peptide_mass - tolerance), multimap_mass_2_scan_index.upper_bound(peptide_mass + tolerance));
+    };
+
+    // scores a modified variant (number mod_pep_idx) of the unmodified peptide sequence against the matching spectra
+    auto scoreCandidate = [&](const AASequence& candidate, const StringView& sequence, SignedSize mod_pep_idx,
+      pair<multimap<double, Size>::const_iterator, multimap<double, Size>::const_iterator> matching_spectra,
+      TheoreticalSpectrumGenerator::PrefixSuffixMasses& prefix_suffix_masses, TheoreticalSpectrumGenerator::FragmentBuffer& theo_fragments)
+    {
+      // create theoretical fragments: b and y ions with charge 1, sorted by mz
+      TheoreticalSpectrumGenerator::getPrefixSuffixMasses(candidate, prefix_suffix_masses);
+      spectrum_generator.getFragmentMZs(prefix_suffix_masses, 1, 1, theo_fragments);
 
-#pragma omp parallel for schedule(static) default(none) shared(annotated_hits, spectrum_generator, multimap_mass_2_scan_index, fixed_modifications, variable_modifications, fasta_db, digestor, processed_petides, count_proteins, count_peptides, precursor_mass_tolerance_unit_ppm, fragment_mass_tolerance_unit_ppm, peptide_motif_regex, spectra, annotated_hits_lock)
-      for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
+      for (auto low_it = matching_spectra.first; low_it != matching_spectra.second; ++low_it)
       {
+        const Size& scan_index = low_it->second;
+        const PeakSpectrum& exp_spectrum = spectra[scan_index];
+        // const int& charge = exp_spectrum.getPrecursors()[0].getCharge();
+        HyperScore::PSMDetail detail;
+        const double& score = HyperScore::computeWithDetail(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_fragments, detail);
+
+        if (score == 0)
+        { 
+          continue; // no hit?
+        }
+        // add peptide hit
+        AnnotatedHit_ ah;
+        ah.sequence = sequence;
+        ah.peptide_mod_index = mod_pep_idx;
+        ah.score = score;
+        ah.prefix_fraction = (double)detail.matched_b_ions/(double)sequence.size();
+        ah.suffix_fraction = (double)detail.matched_y_ions/(double)sequence.size();
+        ah.mean_error = detail.mean_error;
 
-      #pragma omp atomic
-      ++count_proteins;
+#ifdef _OPENMP
+        omp_set_lock(&(annotated_hits_lock[scan_index]));
+        {
+#endif
+          annotated_hits[scan_index].push_back(ah);
 
-      IF_MASTERTHREAD
-      {
-        setProgress(count_proteins);
+          // prevent vector from growing indefinitely (memory) but don't shrink the vector every time
+          if (annotated_hits[scan_index].size() >= 2 * report_top_hits_)
+          {
+            std::partial_sort(annotated_hits[scan_index].begin(), annotated_hits[scan_index].begin() + report_top_hits_, annotated_hits[scan_index].end(), AnnotatedHit_::hasBetterScore);
+            annotated_hits[scan_index].resize(report_top_hits_); 
+          }
+#ifdef _OPENMP
+        }
+        omp_unset_lock(&(annotated_hits_lock[scan_index]));
+#endif
       }
+    };
 
-      vector<StringView> current_digest;
-      digestor.digestUnmodified(fasta_db[fasta_index].sequence, current_digest, peptide_min_size_, peptide_max_size_);
+    // own the peptide sequences referenced by the annotated hits in fragment index and digest store mode
+    FragmentIndex fragment_index;
+    DigestStore digest_store;
 
-      for (auto const & c : current_digest)
-      { 
-        const String current_peptide = c.getString();
-        if (current_peptide.find_first_of("XBZ") != std::string::npos)
-        {
-          continue;
-        }
+    if (search_mode_ == "fragment_index")
+    {
+      buildFragmentIndex_(fasta_db, in_db, fixed_modifications, variable_modifications, fragment_index);
+      searchFragmentIndex_(spectra, fragment_index, fixed_modifications, variable_modifications, spectrum_generator, annotated_hits);
+    }
+    else if (!digest_store_file_.empty())
+    {
+      // same peptides and variants as the digestion below, but only digested once per database and settings
+      DigestStore::Parameters store_params;
+      store_params.enzyme = enzyme_;
+      store_params.missed_cleavages = peptide_missed_cleavages_;
+      store_params.min_length = peptide_min_size_;
+      store_params.max_length = peptide_max_size_;
+      store_params.fixed_modifications = modifications_fixed_;
+      store_params.variable_modifications = modifications_variable_;
+      store_params.max_variable_mods_per_peptide = modifications_max_variable_mods_per_peptide_;
+      digest_store.openOrCreate(digest_store_file_, in_db, store_params);
+
+      startProgress(0, digest_store.getNrPeptides(), "Scoring peptide models against spectra...");
+      Size count_peptides(0);
+
+#pragma omp parallel
+      {
+        // reused for all candidates of this thread
+        TheoreticalSpectrumGenerator::PrefixSuffixMasses prefix_suffix_masses;
+        TheoreticalSpectrumGenerator::FragmentBuffer theo_fragments;
 
-        // if a peptide motif is provided skip all peptides without match
-        if (!peptide_motif_.empty() && !boost::regex_match(current_peptide, peptide_motif_regex))
-        {
-          continue;
-        }          
-      
-        bool already_processed = false;
-        #pragma omp critical (processed_peptides_access)
+#pragma omp for schedule(dynamic, 1000)
+        for (SignedSize peptide_index = 0; peptide_index < (SignedSize)digest_store.getNrPeptides(); ++peptide_index)
         {
-          // peptide (and all modified variants) already processed so skip it
-          if (processed_petides.find(c) != processed_petides.end())
+          IF_MASTERTHREAD
           {
-            already_processed = true;
+            setProgress(peptide_index);
           }
-          else
+
+          const DigestStore::PeptideRecord& peptide = digest_store.getPeptide(peptide_index);
+
+          // the store is sorted by mass: only variants with a matching precursor are parsed
+          const auto matching_spectra = matchingSpectra(peptide.mass);
+          if (matching_spectra.first == matching_spectra.second)
           {
-            processed_petides.insert(c);
+            continue;
           }
+
+          // if a peptide motif is provided skip all peptides without match
+          const std::string_view unmodified = digest_store.getString(peptide.unmodified_sequence);
+          if (!peptide_motif_.empty() && !boost::regex_match(unmodified.data(), unmodified.data() + unmodified.size(), peptide_motif_regex))
+          {
+            continue;
+          }
+
+          #pragma omp atomic
+          ++count_peptides;
+
+          // ResidueDB and ModificationsDB are frozen (see above): parsing does not lock
+          const AASequence candidate = AASequence::fromString(String(digest_store.getSequence(peptide_index)));
+
+          scoreCandidate(candidate, StringView(unmodified.data(), unmodified.size()), peptide.variant_index, matching_spectra, prefix_suffix_masses, theo_fragments);
         }
+      }
+      endProgress();
 
-        // skip peptides that have already been processed
-        if (already_processed) { continue; }
+      OPENMS_LOG_INFO << "Peptides in digest store: " << digest_store.getNrPeptides() << endl;
+      OPENMS_LOG_INFO << "Scored peptides: " << count_peptides << endl;
+    }
+    else
+    {
+      ProteaseDigestion digestor;
+      digestor.setEnzyme(enzyme_);
+      digestor.setMissedCleavages(peptide_missed_cleavages_);
+      startProgress(0, fasta_db.size(), "Scoring peptide models against spectra...");
 
-        #pragma omp atomic
-        ++count_peptides;
+      // lookup for processed peptides. must be defined outside of omp section and synchronized
+      set<StringView> processed_petides;
 
-        vector<AASequence> all_modified_peptides;
+      Size count_proteins(0), count_peptides(0);
 
-        // this critical section is because ResidueDB is not thread safe and new residues are created based on the PTMs
-        #pragma omp critical (residuedb_access)
+#pragma omp parallel for schedule(static) default(none) shared(matchingSpectra, scoreCandidate, fixed_modifications, variable_modifications, fasta_db, digestor, processed_petides, count_proteins, count_peptides, peptide_motif_regex)
+        for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
         {
-          AASequence aas = AASequence::fromString(current_peptide);
-          ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
-          ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, modifications_max_variable_mods_per_peptide_, all_modified_peptides);
-        }
 
-        for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
+        #pragma omp atomic
+        ++count_proteins;
+
+        IF_MASTERTHREAD
         {
-          const AASequence& candidate = all_modified_peptides[mod_pep_idx];
-          double current_peptide_mass = candidate.getMonoWeight();
+          setProgress(count_proteins);
+        }
 
-          // determine MS2 precursors that match to the current peptide mass
-          multimap<double, Size>::const_iterator low_it;
-          multimap<double, Size>::const_iterator up_it;
+        vector<StringView> current_digest;
+        digestor.digestUnmodified(fasta_db[fasta_index].sequence, current_digest, peptide_min_size_, peptide_max_size_);
 
-          if (precursor_mass_tolerance_unit_ppm) // ppm
-          {
-            low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - current_peptide_mass * precursor_mass_tolerance_ * 1e-6);
-            up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + current_peptide_mass * precursor_mass_tolerance_ * 1e-6);
-          }
-          else // Dalton
+        // reused for all candidates of this protein
+        TheoreticalSpectrumGenerator::PrefixSuffixMasses prefix_suffix_masses;
+        TheoreticalSpectrumGenerator::FragmentBuffer theo_fragments;
+
+        for (auto const & c : current_digest)
+        { 
+          const String current_peptide = c.getString();
+          if (current_peptide.find_first_of("XBZ") != std::string::npos)
           {
-            low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - precursor_mass_tolerance_);
-            up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + precursor_mass_tolerance_);
+            continue;
           }
 
-          // no matching precursor in data
-          if (low_it == up_it)
-          { 
+          // if a peptide motif is provided skip all peptides without match
+          if (!peptide_motif_.empty() && !boost::regex_match(current_peptide, peptide_motif_regex))
+          {
             continue;
+          }          
+      
+          bool already_processed = false;
+          #pragma omp critical (processed_peptides_access)
+          {
+            // peptide (and all modified variants) already processed so skip it
+            if (processed_petides.find(c) != processed_petides.end())
+            {
+              already_processed = true;
+            }
+            else
+            {
+              processed_petides.insert(c);
+            }
           }
 
-          // create theoretical spectrum
-          PeakSpectrum theo_spectrum;
+          // skip peptides that have already been processed
+          if (already_processed) { continue; }
 
-          // add peaks for b and y ions with charge 1
-          spectrum_generator.getSpectrum(theo_spectrum, candidate, 1, 1);
+          #pragma omp atomic
+          ++count_peptides;
 
-          // sort by mz
-          theo_spectrum.sortByPosition();
+          // ResidueDB and ModificationsDB are frozen (see above): parsing does not lock
+          vector<AASequence> all_modified_peptides;
+          AASequence aas = AASequence::fromString(current_peptide);
+          ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
+          ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, modifications_max_variable_mods_per_peptide_, all_modified_peptides);
 
-          for (; low_it != up_it; ++low_it)
+          for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
           {
-            const Size& scan_index = low_it->second;
-            const PeakSpectrum& exp_spectrum = spectra[scan_index];
-            // const int& charge = exp_spectrum.getPrecursors()[0].getCharge();
-            HyperScore::PSMDetail detail;
-            const double& score = HyperScore::computeWithDetail(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum, detail);
+            const AASequence& candidate = all_modified_peptides[mod_pep_idx];
+            const auto matching_spectra = matchingSpectra(candidate.getMonoWeight());
 
-            if (score == 0)
+            // no matching precursor in data
+            if (matching_spectra.first == matching_spectra.second)
             { 
-              continue; // no hit?
+              continue;
             }
-            // add peptide hit
-            AnnotatedHit_ ah;
-            ah.sequence = c;
-            ah.peptide_mod_index = mod_pep_idx;
-            ah.score = score;
-            ah.prefix_fraction = (double)detail.matched_b_ions/(double)c.size();
-            ah.suffix_fraction = (double)detail.matched_y_ions/(double)c.size();
-            ah.mean_error = detail.mean_error;
 
-#ifdef _OPENMP
-            omp_set_lock(&(annotated_hits_lock[scan_index]));
-            {
-#endif
-              annotated_hits[scan_index].push_back(ah);
-
-              // prevent vector from growing indefinitely (memory) but don't shrink the vector every time
-              if (annotated_hits[scan_index].size() >= 2 * report_top_hits_)
-              {
-                std::partial_sort(annotated_hits[scan_index].begin(), annotated_hits[scan_index].begin() + report_top_hits_, annotated_hits[scan_index].end(), AnnotatedHit_::hasBetterScore);
-                annotated_hits[scan_index].resize(report_top_hits_); 
-              }
-#ifdef _OPENMP
-            }
-            omp_unset_lock(&(annotated_hits_lock[scan_index]));
-#endif
+            scoreCandidate(candidate, c, mod_pep_idx, matching_spectra, prefix_suffix_masses, theo_fragments);
           }
         }
       }
-    }
-    endProgress();
+      endProgress();
 
-    OPENMS_LOG_INFO << "Proteins: " << count_proteins << endl;
-    OPENMS_LOG_INFO << "Peptides: " << count_peptides << endl;
-    OPENMS_LOG_INFO << "Processed peptides: " << processed_petides.size() << endl;
+      OPENMS_LOG_INFO << "Proteins: " << count_proteins << endl;
+      OPENMS_LOG_INFO << "Peptides: " << count_peptides << endl;
+      OPENMS_LOG_INFO << "Processed peptides: " << processed_petides.size() << endl;
+    }
 
     startProgress(0, 1, "Post-processing PSMs...");
     SimpleSearchEngineAlgorithm::postProcessHits_(spectra, 
@@ -0,0 +1,401 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
+
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/CHEMISTRY/ModificationsDB.h>
+#include <OpenMS/CHEMISTRY/ResidueModification.h>
+#include <OpenMS/COMPARISON/SpectraSTSimilarityScore.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/CONCEPT/Macros.h>
+#include <OpenMS/FORMAT/MSPFile.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/METADATA/PeptideIdentification.h>
+
+#include <Eigen/Sparse>
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <numeric>
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// sections: spectra (SpectrumRecord, sorted by precursor m/z), peak m/z (double), peak intensities, bin indices (UInt32), bin values (float), annotations (AnnotationRecord)
+    enum Section { SPECTRA, PEAK_MZ, PEAK_INTENSITY, BIN_INDEX, BIN_VALUE, ANNOTATIONS, NR_SECTIONS };
+
+    const Internal::MappedIndexFile::Format spectral_library_index_format = {{'O', 'M', 'S', 'S', 'P', 'L', 'I', 'B'}, 2, NR_SECTIONS, "spectral library index"};
+
+    /// Writes the slices [first, first + size) of @p data in the given order as one section
+    template <typename T>
+    void writeSlices(Internal::MappedIndexFile::Writer& writer, const std::vector<T>& data, const std::vector<std::pair<UInt64, UInt32> >& slices)
+    {
+      for (const auto& slice : slices)
+      {
+        writer.append(data.data() + slice.first, slice.second * sizeof(T));
+      }
+      writer.endSection();
+    }
+
+    /**
+      Whether the modifications of a library peptide agree with the search settings:
+      every residue that can carry a fixed modification carries it, and every modified
+      residue that can carry a variable modification carries that one.
+      (Multiple variable modifications with the same origin are not supported.)
+    */
+    bool hasSearchModifications(const AASequence& aaseq, const StringList& fixed_modifications, const StringList& variable_modifications)
+    {
+      ModificationsDB* mdb = ModificationsDB::getInstance();
+      if (!fixed_modifications.empty())
+      {
+        for (Size j = 0; j < aaseq.size(); ++j)
+        {
+          const Residue& mod = aaseq.getResidue(j);
+          for (const String& fixed : fixed_modifications)
+          {
+            if (mod.getOneLetterCode()[0] == mdb->getModification(fixed)->getOrigin() && fixed != mod.getModificationName())
+            {
+              return false;
+            }
+          }
+        }
+      }
+      if (aaseq.isModified() && !variable_modifications.empty())
+      {
+        for (Size j = 0; j < aaseq.size(); ++j)
+        {
+          if (!aaseq[j].isModified()) continue;
+
+          const Residue& mod = aaseq.getResidue(j);
+          for (const String& variable : variable_modifications)
+          {
+            if (mod.getOneLetterCode()[0] == mdb->getModification(variable)->getOrigin() && variable != mod.getModificationName())
+            {
+              return false;
+            }
+          }
+        }
+      }
+      return true;
+    }
+
+    /// A preprocessed library spectrum, before it is added to the index
+    struct LibraryEntry
+    {
+      bool keep = false;
+      std::vector<double> mz;
+      std::vector<Peak1D::IntensityType> intensity;
+      std::vector<UInt32> bin_index;
+      std::vector<float> bin_value;
+    };
+  }
+
+  String SpectralLibraryIndex::Parameters::getFingerprint() const
+  {
+    // the order of the modifications does not matter
+    StringList fixed = fixed_modifications;
+    StringList variable = variable_modifications;
+    std::sort(fixed.begin(), fixed.end());
+    std::sort(variable.begin(), variable.end());
+    return "remove_peaks_below_threshold=" + String(remove_peaks_below_threshold)
+      + ";fixed=" + ListUtils::concatenate(fixed, ",")
+      + ";variable=" + ListUtils::concatenate(variable, ",");
+  }
+
+  SpectralLibraryIndex::SpectralLibraryIndex() :
+    file_(spectral_library_index_format)
+  {
+  }
+
+  SpectralLibraryIndex::~SpectralLibraryIndex()
+  {
+    close();
+  }
+
+  void SpectralLibraryIndex::create(const String& filename, const String& library_file, const Parameters& params)
+  {
+    PeakMap library;
+    std::vector<PeptideIdentification> ids;
+    MSPFile().load(library_file, ids, library);
+    if (ids.size() != library.size())
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, library_file,
+          "Number of annotations (" + String(ids.size()) + ") does not match the number of spectra (" + String(library.size()) + ").");
+    }
+    spectral_library_index_format.checkedUInt32(library.size(), "spectra");
+
+    // preprocess the library spectra block-wise in parallel, but add them in library order
+    Internal::MappedIndexFile::StringPool pool(spectral_library_index_format);
+    std::vector<SpectrumRecord> spectra;
+    std::vector<AnnotationRecord> annotations;
+    std::vector<double> peak_mz;
+    std::vector<Peak1D::IntensityType> peak_intensity;
+    std::vector<UInt32> bin_index;
+    std::vector<float> bin_value;
+    const Size block_size = 4096;
+    for (Size block_start = 0; block_start < library.size(); block_start += block_size)
+    {
+      const Size block_end = std::min(block_start + block_size, library.size());
+      std::vector<LibraryEntry> block(block_end - block_start);
+      std::vector<std::exception_ptr> errors(block.size());
+
+#pragma omp parallel for schedule(dynamic)
+      for (SignedSize i = 0; i < (SignedSize)block.size(); ++i)
+      {
+        try
+        {
+          const MSSpectrum& lib_spec = library[block_start + i];
+          const PeptideIdentification& id = ids[block_start + i];
+          if (id.getHits().empty() || lib_spec.getPrecursors().empty())
+          {
+            throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, lib_spec.getNativeID(), "Library spectrum without peptide or precursor m/z.");
+          }
+          const PeptideHit& hit = id.getHits()[0];
+          if (!hasSearchModifications(hit.getSequence(), params.fixed_modifications, params.variable_modifications)) continue;
+
+          // empty array would segfault
+          const std::vector<PeptideHit::PeakAnnotation>& pa = hit.getPeakAnnotations();
+          if (pa.empty())
+          {
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Expected StringDataArray of type MSPeakInfo");
+          }
+
+          LibraryEntry& entry = block[i];
+          entry.keep = true;
+          PeakSpectrum lib_entry;
+          for (Size l = 0; l < lib_spec.size(); ++l)
+          {
+            if (lib_spec[l].getIntensity() > params.remove_peaks_below_threshold)
+            {
+              Peak1D peak;
+              // this is the "MSPPeakInfo" array, see MSPFile which creates a single StringDataArray
+              // TODO: check why this scaling is done for ? peaks (dubious peaks?)
+              if (pa[l].annotation[0] == '?')
+              {
+                peak.setIntensity(std::sqrt(0.2 * lib_spec[l].getIntensity()));
+              }
+              else
+              {
+                peak.setIntensity(std::sqrt(lib_spec[l].getIntensity()));
+              }
+              peak.setMZ(lib_spec[l].getMZ());
+              lib_entry.push_back(peak);
+              entry.mz.push_back(peak.getMZ());
+              entry.intensity.push_back(peak.getIntensity());
+            }
+          }
+          spectral_library_index_format.checkedUInt32(lib_entry.size(), "peaks per spectrum");
+
+          // binned and normalized as for the SpectraST score
+          const BinnedSpectrum binned = SpectraSTSimilarityScore().transform(lib_entry);
+          const BinnedSpectrum::SparseVectorType& bins = *binned.getBins();
+          entry.bin_index.assign(bins.innerIndexPtr(), bins.innerIndexPtr() + bins.nonZeros());
+          entry.bin_value.assign(bins.valuePtr(), bins.valuePtr() + bins.nonZeros());
+        }
+        catch (...)
+        {
+          errors[i] = std::current_exception();
+        }
+      }
+
+      for (Size i = 0; i < block.size(); ++i)
+      {
+        if (errors[i])
+        {
+          std::rethrow_exception(errors[i]);
+        }
+        LibraryEntry& entry = block[i];
+        if (!entry.keep) continue;
+
+        const MSSpectrum& lib_spec = library[block_start + i];
+        const PeptideHit& hit = ids[block_start + i].getHits()[0];
+        SpectrumRecord record;
+        record.precursor_mz = lib_spec.getPrecursors()[0].getMZ();
+        record.rt = lib_spec.getRT();
+        record.first_peak = peak_mz.size();
+        record.first_bin = bin_index.size();
+        record.first_annotation = annotations.size();
+        record.nr_peaks = (UInt32)entry.mz.size();
+        record.nr_bins = (UInt32)entry.bin_index.size();
+        record.nr_annotations = spectral_library_index_format.checkedUInt32(hit.getPeakAnnotations().size(), "peak annotations per spectrum");
+        record.charge = hit.getCharge();
+        record.sequence = pool.add(hit.getSequence().toString());
+        record.library_index = (UInt32)(block_start + i);
+        spectra.push_back(record);
+
+        peak_mz.insert(peak_mz.end(), entry.mz.begin(), entry.mz.end());
+        peak_intensity.insert(peak_intensity.end(), entry.intensity.begin(), entry.intensity.end());
+        bin_index.insert(bin_index.end(), entry.bin_index.begin(), entry.bin_index.end());
+        bin_value.insert(bin_value.end(), entry.bin_value.begin(), entry.bin_value.end());
+        for (const PeptideHit::PeakAnnotation& a : hit.getPeakAnnotations())
+        {
+          annotations.push_back({a.mz, a.intensity, a.charge, pool.add(a.annotation)});
+        }
+        entry = LibraryEntry();
+      }
+      // the raw spectra are not needed anymore
+      for (Size i = block_start; i < block_end; ++i)
+      {
+        library[i].clear(true);
+      }
+    }
+    library.clear(true);
+    ids.clear();
+
+    // sort by precursor m/z; the peaks, bins and annotations of a spectrum are written in the same order
+    std::vector<Size> order(spectra.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&spectra](Size a, Size b) { return spectra[a].precursor_mz < spectra[b].precursor_mz; });
+    std::vector<SpectrumRecord> sorted_spectra;
+    sorted_spectra.reserve(spectra.size());
+    std::vector<std::pair<UInt64, UInt32> > peak_slices, bin_slices, annotation_slices;
+    peak_slices.reserve(spectra.size());
+    bin_slices.reserve(spectra.size());
+    annotation_slices.reserve(spectra.size());
+    UInt64 first_peak = 0, first_bin = 0, first_annotation = 0;
+    for (const Size s : order)
+    {
+      SpectrumRecord record = spectra[s];
+      peak_slices.emplace_back(record.first_peak, record.nr_peaks);
+      bin_slices.emplace_back(record.first_bin, record.nr_bins);
+      annotation_slices.emplace_back(record.first_annotation, record.nr_annotations);
+      record.first_peak = first_peak;
+      record.first_bin = first_bin;
+      record.first_annotation = first_annotation;
+      first_peak += record.nr_peaks;
+      first_bin += record.nr_bins;
+      first_annotation += record.nr_annotations;
+      sorted_spectra.push_back(record);
+    }
+    std::vector<SpectrumRecord>().swap(spectra);
+
+    Internal::MappedIndexFile::Writer writer(spectral_library_index_format, filename, library_file, params.getFingerprint(), pool);
+    writer.addSection(sorted_spectra);
+    writeSlices(writer, peak_mz, peak_slices);
+    writeSlices(writer, peak_intensity, peak_slices);
+    writeSlices(writer, bin_index, bin_slices);
+    writeSlices(writer, bin_value, bin_slices);
+    writeSlices(writer, annotations, annotation_slices);
+    writer.commit();
+  }
+
+  bool SpectralLibraryIndex::isUpToDate(const String& filename, const String& library_file, const Parameters& params)
+  {
+    return Internal::MappedIndexFile::isUpToDate(spectral_library_index_format, filename, library_file, params.getFingerprint());
+  }
+
+  void SpectralLibraryIndex::open(const String& filename)
+  {
+    close();
+    file_.open(filename);
+    try
+    {
+      Size nr_intensities = 0, nr_bin_values = 0;
+      spectra_ = file_.getSection<SpectrumRecord>(SPECTRA, nr_spectra_);
+      peak_mz_ = file_.getSection<double>(PEAK_MZ, nr_peaks_);
+      peak_intensity_ = file_.getSection<Peak1D::IntensityType>(PEAK_INTENSITY, nr_intensities);
+      bin_index_ = file_.getSection<UInt32>(BIN_INDEX, nr_bins_);
+      bin_value_ = file_.getSection<float>(BIN_VALUE, nr_bin_values);
+      annotations_ = file_.getSection<AnnotationRecord>(ANNOTATIONS, nr_annotations_);
+      if (nr_intensities != nr_peaks_ || nr_bin_values != nr_bins_)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Spectral library index is truncated or corrupt.");
+      }
+    }
+    catch (...)
+    {
+      close();
+      throw;
+    }
+  }
+
+  void SpectralLibraryIndex::openOrCreate(const String& filename, const String& library_file, const Parameters& params)
+  {
+    close(); // the file may be replaced
+    if (!isUpToDate(filename, library_file, params))
+    {
+      OPENMS_LOG_INFO << "Creating spectral library index '" << filename << "' for '" << library_file << "'." << std::endl;
+      create(filename, library_file, params);
+    }
+    open(filename);
+  }
+
+  bool SpectralLibraryIndex::isOpen() const
+  {
+    return file_.isOpen();
+  }
+
+  void SpectralLibraryIndex::close()
+  {
+    file_.close();
+    spectra_ = nullptr;
+    peak_mz_ = nullptr;
+    peak_intensity_ = nullptr;
+    bin_index_ = nullptr;
+    bin_value_ = nullptr;
+    annotations_ = nullptr;
+    nr_spectra_ = nr_peaks_ = nr_bins_ = nr_annotations_ = 0;
+  }
+
+  Size SpectralLibraryIndex::getNrSpectra() const
+  {
+    return nr_spectra_;
+  }
+
+  const SpectralLibraryIndex::SpectrumRecord& SpectralLibraryIndex::getSpectrum(Size index) const
+  {
+    OPENMS_PRECONDITION(index < nr_spectra_, "Spectrum index out of range")
+    return spectra_[index];
+  }
+
+  std::string_view SpectralLibraryIndex::getString(StringIndex index) const
+  {
+    return file_.getString(index);
+  }
+
+  std::string_view SpectralLibraryIndex::getSequence(Size index) const
+  {
+    return getString(getSpectrum(index).sequence);
+  }
+
+  SpectrumComparisonKernels::PeakArraysView SpectralLibraryIndex::getPeaks(Size index) const
+  {
+    const SpectrumRecord& record = getSpectrum(index);
+    return {peak_mz_ + record.first_peak, peak_intensity_ + record.first_peak, record.nr_peaks};
+  }
+
+  SpectrumComparisonKernels::BinsView SpectralLibraryIndex::getBins(Size index) const
+  {
+    const SpectrumRecord& record = getSpectrum(index);
+    return {bin_index_ + record.first_bin, bin_value_ + record.first_bin, record.nr_bins};
+  }
+
+  std::pair<Size, Size> SpectralLibraryIndex::getSpectrumRange(double min_mz, double max_mz) const
+  {
+    return Internal::MappedIndexFile::getRange(spectra_, nr_spectra_, min_mz, max_mz, [](const SpectrumRecord& r) { return r.precursor_mz; });
+  }
+
+  PeptideHit SpectralLibraryIndex::getPeptideHit(Size index) const
+  {
+    const SpectrumRecord& record = getSpectrum(index);
+    PeptideHit hit(0, 0, record.charge, AASequence::fromString(String(getString(record.sequence))));
+    std::vector<PeptideHit::PeakAnnotation> peak_annotations;
+    peak_annotations.reserve(record.nr_annotations);
+    for (const AnnotationRecord* a = annotations_ + record.first_annotation; a != annotations_ + record.first_annotation + record.nr_annotations; ++a)
+    {
+      peak_annotations.push_back({String(getString(a->annotation)), a->charge, a->mz, a->intensity});
+    }
+    hit.setPeakAnnotations(std::move(peak_annotations));
+    return hit;
+  }
+
+}
@@ -18,9 +18,11 @@ ConsensusIDAlgorithmRanks.cpp
 ConsensusIDAlgorithmSimilarity.cpp
 ConsensusIDAlgorithmWorst.cpp
 ConsensusMapMergerAlgorithm.cpp
+DigestStore.cpp
 FalseDiscoveryRate.cpp
 FIAMSDataProcessor.cpp
 FIAMSScheduler.cpp
+FragmentIndex.cpp
 HyperScore.cpp
 IDBoostGraph.cpp
 IDConflictResolverAlgorithm.cpp
@@ -32,6 +34,7 @@ IDScoreGetterSetter.cpp
 IDScoreSwitcherAlgorithm.cpp
 IonIdentityMolecularNetworking.cpp
 MessagePasserFactory.cpp
+MetaboliteSpectralLibraryIndex.cpp
 MetaboliteSpectralMatching.cpp
 MorpheusScore.cpp
 NeighborSeq.cpp
@@ -43,6 +46,7 @@ PScore.cpp
 SimpleSearchEngineAlgorithm.cpp
 SiriusExportAlgorithm.cpp
 SiriusMSConverter.cpp
+SpectralLibraryIndex.cpp
 )
 
 ### add path to the filenames
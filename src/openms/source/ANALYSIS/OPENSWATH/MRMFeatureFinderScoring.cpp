@@ -220,20 +220,26 @@ namespace OpenMS
     }
     trgroup_picker.setParameters(trgroup_picker_param);
 
-    Size progress = 0;
-    startProgress(0, transition_group_map.size(), "picking peaks");
+    // Pick all transition groups in parallel first, then score them in the
+    // original order (scoring is parallelized internally)
+    std::vector<MRMTransitionGroupType*> picked_groups;
     for (TransitionGroupMapType::iterator trgroup_it = transition_group_map.begin(); trgroup_it != transition_group_map.end(); ++trgroup_it)
     {
-
-      setProgress(++progress);
       MRMTransitionGroupType& transition_group = trgroup_it->second;
       if (transition_group.getChromatograms().empty() || transition_group.getTransitions().empty())
       {
         continue;
       }
+      picked_groups.push_back(&transition_group);
+    }
+    trgroup_picker.pickTransitionGroups(picked_groups);
 
-      trgroup_picker.pickTransitionGroup(transition_group);
-      scorePeakgroups(trgroup_it->second, trafo, swath_maps, output);
+    Size progress = 0;
+    startProgress(0, picked_groups.size(), "scoring peaks");
+    for (MRMTransitionGroupType* transition_group : picked_groups)
+    {
+      setProgress(++progress);
+      scorePeakgroups(*transition_group, trafo, swath_maps, output);
     }
     endProgress();
 
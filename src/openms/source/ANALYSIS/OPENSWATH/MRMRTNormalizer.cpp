@@ -17,6 +17,124 @@
 namespace OpenMS
 {
 
+  namespace
+  {
+    /**
+      @brief Sufficient statistics of an unweighted linear regression
+
+      Points can be removed in constant time, and the R^2 that would result
+      from leaving out a single point can be computed without refitting. All
+      coordinates are shifted by the mean of the initial data to keep the sums
+      well-conditioned. Slope, intercept and R^2 (squared Pearson coefficient)
+      match Math::LinearRegression.
+    */
+    class RunningLinearFit
+    {
+    public:
+      RunningLinearFit(const std::vector<double>& x, const std::vector<double>& y)
+      {
+        if (!x.empty())
+        {
+          x0_ = std::accumulate(x.begin(), x.end(), 0.0) / x.size();
+          y0_ = std::accumulate(y.begin(), y.begin() + x.size(), 0.0) / x.size();
+        }
+        for (Size i = 0; i < x.size(); ++i)
+        {
+          add_(x[i], y[i], 1.0);
+        }
+      }
+
+      void remove(double x, double y)
+      {
+        add_(x, y, -1.0);
+      }
+
+      double slope() const
+      {
+        checkFit_(n_, sx_, sxx_);
+        return (sxy_ - sx_ * sy_ / n_) / (sxx_ - sx_ * sx_ / n_);
+      }
+
+      double intercept() const
+      {
+        return y0_ + sy_ / n_ - slope() * (x0_ + sx_ / n_);
+      }
+
+      double rsq() const
+      {
+        checkFit_(n_, sx_, sxx_);
+        return rsq_(n_, sx_, sy_, sxx_, syy_, sxy_);
+      }
+
+      /// R^2 of the fit without point (@p x, @p y), which must be part of the data
+      double rsqWithout(double x, double y) const
+      {
+        const double u = x - x0_, v = y - y0_;
+        const double n = n_ - 1, sx = sx_ - u, sxx = sxx_ - u * u;
+        checkFit_(n, sx, sxx);
+        return rsq_(n, sx, sy_ - v, sxx, syy_ - v * v, sxy_ - u * v);
+      }
+
+    private:
+      void add_(double x, double y, double sign)
+      {
+        const double u = x - x0_, v = y - y0_;
+        n_ += sign;
+        sx_ += sign * u;
+        sy_ += sign * v;
+        sxx_ += sign * u * u;
+        syy_ += sign * v * v;
+        sxy_ += sign * u * v;
+      }
+
+      static void checkFit_(double n, double sx, double sxx)
+      {
+        if (n < 2 || !(sxx - sx * sx / n > 0))
+        {
+          throw Exception::UnableToFit(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "UnableToFit-LinearRegression",
+            String("Could not fit a linear model to the data (") + String(n) + " points).");
+        }
+      }
+
+      static double rsq_(double n, double sx, double sy, double sxx, double syy, double sxy)
+      {
+        // as in LinearRegression, the goodness of fit is only computed for more than two points
+        if (n <= 2) return 0.0;
+        const double cov_xy = sxy - sx * sy / n;
+        const double var_x = sxx - sx * sx / n;
+        const double var_y = syy - sy * sy / n;
+        return (cov_xy * cov_xy) / (var_x * var_y);
+      }
+
+      double x0_ = 0, y0_ = 0;
+      double n_ = 0, sx_ = 0, sy_ = 0, sxx_ = 0, syy_ = 0, sxy_ = 0;
+    };
+
+    int jackknifeCandidate(const RunningLinearFit& fit, const std::vector<double>& x, const std::vector<double>& y)
+    {
+      std::vector<double> rsq_tmp;
+      rsq_tmp.reserve(x.size());
+      for (Size i = 0; i < x.size(); i++)
+      {
+        rsq_tmp.push_back(fit.rsqWithout(x[i], y[i]));
+      }
+      return max_element(rsq_tmp.begin(), rsq_tmp.end()) - rsq_tmp.begin();
+    }
+
+    int residualCandidate(const RunningLinearFit& fit, const std::vector<double>& x, const std::vector<double>& y)
+    {
+      const double intercept = fit.intercept();
+      const double slope = fit.slope();
+      std::vector<double> residuals;
+      residuals.reserve(x.size());
+      for (Size i = 0; i < x.size(); i++)
+      {
+        residuals.push_back(fabs(y[i] - (intercept + (slope * x[i]))));
+      }
+      return max_element(residuals.begin(), residuals.end()) - residuals.begin();
+    }
+  }
+
   std::vector<std::pair<double, double> > MRMRTNormalizer::removeOutliersRANSAC(
       const std::vector<std::pair<double, double> >& pairs, double rsq_limit,
       double coverage_limit, size_t max_iterations, double max_rt_threshold, size_t sampling_size)
@@ -71,21 +189,9 @@ namespace OpenMS
     // the data points with one removed pair. The combination resulting in
     // highest rsq is considered corresponding to the outlier candidate. The
     // corresponding iterator position is then returned.
-    std::vector<double> x_tmp, y_tmp, rsq_tmp;
-
-    for (Size i = 0; i < x.size(); i++)
-    {
-      x_tmp = x;
-      y_tmp = y;
-      x_tmp.erase(x_tmp.begin() + i);
-      y_tmp.erase(y_tmp.begin() + i);
-
-      Math::LinearRegression lin_reg;
-      lin_reg.computeRegression(0.95, x_tmp.begin(), x_tmp.end(), y_tmp.begin());
-
-      rsq_tmp.push_back(lin_reg.getRSquared());
-    }
-    return max_element(rsq_tmp.begin(), rsq_tmp.end()) - rsq_tmp.begin();
+    // The leave-one-out fits are derived from the sums of the full data set,
+    // so no refit is necessary.
+    return jackknifeCandidate(RunningLinearFit(x, y), x, y);
   }
 
   int MRMRTNormalizer::residualOutlierCandidate_(const std::vector<double>& x, const std::vector<double>& y)
@@ -93,18 +199,7 @@ namespace OpenMS
     // Returns candidate outlier: A linear regression and residuals are calculated for
     // the data points. The one with highest residual error is selected as the outlier candidate. The
     // corresponding iterator position is then returned.
-    Math::LinearRegression lin_reg;
-    lin_reg.computeRegression(0.95, x.begin(), x.end(), y.begin());
-
-    std::vector<double> residuals;
-
-    for (Size i = 0; i < x.size(); i++)
-    {
-      double residual = fabs(y[i] - (lin_reg.getIntercept() + (lin_reg.getSlope() * x[i])));
-      residuals.push_back(residual);
-    }
-
-    return max_element(residuals.begin(), residuals.end()) - residuals.begin();
+    return residualCandidate(RunningLinearFit(x, y), x, y);
   }
 
   std::vector<std::pair<double, double> > MRMRTNormalizer::removeOutliersIterative(
@@ -119,7 +214,6 @@ namespace OpenMS
 
     // Removes outliers from vector of pairs until upper rsq and lower coverage limits are reached.
     std::vector<double> x, y;
-    double confidence_interval = 0.95;
 
     std::vector<std::pair<double, double> > pairs_corrected;
 
@@ -133,22 +227,23 @@ namespace OpenMS
     double rsq;
     rsq = 0;
 
+    // The regression is updated incrementally: removing a point only
+    // subtracts it from the sums instead of refitting all remaining points.
+    RunningLinearFit lin_reg(x, y);
     while (x.size() >= coverage_limit * pairs.size() && rsq < rsq_limit)
     {
-      Math::LinearRegression lin_reg;
-      lin_reg.computeRegression(confidence_interval, x.begin(), x.end(), y.begin());
-
-      rsq = lin_reg.getRSquared();
+      rsq = lin_reg.rsq();
 
       if (rsq < rsq_limit)
       {
         std::vector<double> residuals;
+        residuals.reserve(pairs.size());
 
         // calculate residuals
+        const double intercept = lin_reg.intercept();
+        const double slope = lin_reg.slope();
         for (auto it = pairs.begin(); it != pairs.end(); ++it)
         {
-          double intercept = lin_reg.getIntercept();
-          double slope = (double)lin_reg.getSlope();
           residuals.push_back(fabs(it->second - (intercept + it->first * slope)));
           OPENMS_LOG_DEBUG << " RT Normalization residual is " << residuals.back() << std::endl;
         }
@@ -158,12 +253,12 @@ namespace OpenMS
         if (method == "iter_jackknife")
         {
           // get candidate outlier: removal of which datapoint results in best rsq?
-          pos = jackknifeOutlierCandidate_(x, y);
+          pos = jackknifeCandidate(lin_reg, x, y);
         }
         else if (method == "iter_residual")
         {
           // get candidate outlier: removal of datapoint with largest residual?
-          pos = residualOutlierCandidate_(x, y);
+          pos = residualCandidate(lin_reg, x, y);
         }
         else
         {
@@ -176,6 +271,7 @@ namespace OpenMS
         OPENMS_LOG_DEBUG << " Got outlier candidate " << pos << "(" << x[pos] << " / " << y[pos] << std::endl;
         if (!use_chauvenet || chauvenet(residuals, pos))
         {
+          lin_reg.remove(x[pos], y[pos]);
           x.erase(x.begin() + pos);
           y.erase(y.begin() + pos);
         }
@@ -8,12 +8,426 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>
 
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
 #include <OpenMS/FORMAT/SqliteConnector.h>
 
 #include <sqlite3.h>
 
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <variant>
+
 namespace OpenMS
 {
+  namespace
+  {
+    /// Prepared insert statements used for bulk writing
+    enum BulkStatement
+    {
+      STMT_FEATURE,
+      STMT_FEATURE_MS1,
+      STMT_FEATURE_MS2,
+      STMT_FEATURE_MS2_SONAR,
+      STMT_FEATURE_PRECURSOR,
+      STMT_FEATURE_TRANSITION,
+      STMT_FEATURE_TRANSITION_SHAPE,
+      STMT_FEATURE_TRANSITION_UIS,
+      STMT_FEATURE_TRANSITION_UIS_SHAPE,
+      SIZE_OF_BULKSTATEMENT
+    };
+
+    /// A bound SQL value (NULL, integer, real or text)
+    using BulkValue = std::variant<std::monostate, Int64, double, std::string>;
+
+    /// Typed rows for (potentially) several tables, stored in a flat value array
+    struct BulkRowBatch
+    {
+      std::vector<std::pair<BulkStatement, Size>> rows; ///< statement and offset of the first value
+      std::vector<BulkValue> values;
+
+      void beginRow(BulkStatement stmt)
+      {
+        rows.emplace_back(stmt, values.size());
+      }
+
+      void append(const BulkRowBatch& other)
+      {
+        const Size offset = values.size();
+        for (const auto& r : other.rows)
+        {
+          rows.emplace_back(r.first, r.second + offset);
+        }
+        values.insert(values.end(), other.values.begin(), other.values.end());
+      }
+    };
+
+    // (column, meta value) of the scores in FEATURE_MS1
+    const std::vector<std::pair<const char*, const char*>> ms1_score_columns =
+    {
+      {"AREA_INTENSITY", "ms1_area_intensity"},
+      {"APEX_INTENSITY", "ms1_apex_intensity"},
+      {"EXP_IM", "im_ms1_drift"},
+      {"DELTA_IM", "im_ms1_delta"},
+      {"VAR_MASSDEV_SCORE", "var_ms1_ppm_diff"},
+      {"VAR_IM_MS1_DELTA_SCORE", "var_im_ms1_delta_score"},
+      {"VAR_MI_SCORE", "var_ms1_mi_score"},
+      {"VAR_MI_CONTRAST_SCORE", "var_ms1_mi_contrast_score"},
+      {"VAR_MI_COMBINED_SCORE", "var_ms1_mi_combined_score"},
+      {"VAR_ISOTOPE_CORRELATION_SCORE", "var_ms1_isotope_correlation"},
+      {"VAR_ISOTOPE_OVERLAP_SCORE", "var_ms1_isotope_overlap"},
+      {"VAR_XCORR_COELUTION", "var_ms1_xcorr_coelution"},
+      {"VAR_XCORR_COELUTION_CONTRAST", "var_ms1_xcorr_coelution_contrast"},
+      {"VAR_XCORR_COELUTION_COMBINED", "var_ms1_xcorr_coelution_combined"},
+      {"VAR_XCORR_SHAPE", "var_ms1_xcorr_shape"},
+      {"VAR_XCORR_SHAPE_CONTRAST", "var_ms1_xcorr_shape_contrast"},
+      {"VAR_XCORR_SHAPE_COMBINED", "var_ms1_xcorr_shape_combined"}
+    };
+
+    // (column, meta value) of the scores in FEATURE_MS2 (after FEATURE_ID and AREA_INTENSITY)
+    const std::vector<std::pair<const char*, const char*>> ms2_score_columns =
+    {
+      {"TOTAL_AREA_INTENSITY", "total_xic"},
+      {"APEX_INTENSITY", "peak_apices_sum"},
+      {"EXP_IM", "im_drift"},
+      {"DELTA_IM", "im_delta"},
+      {"TOTAL_MI", "total_mi"},
+      {"VAR_BSERIES_SCORE", "var_bseries_score"},
+      {"VAR_DOTPROD_SCORE", "var_dotprod_score"},
+      {"VAR_INTENSITY_SCORE", "var_intensity_score"},
+      {"VAR_ISOTOPE_CORRELATION_SCORE", "var_isotope_correlation_score"},
+      {"VAR_ISOTOPE_OVERLAP_SCORE", "var_isotope_overlap_score"},
+      {"VAR_LIBRARY_CORR", "var_library_corr"},
+      {"VAR_LIBRARY_DOTPROD", "var_library_dotprod"},
+      {"VAR_LIBRARY_MANHATTAN", "var_library_manhattan"},
+      {"VAR_LIBRARY_RMSD", "var_library_rmsd"},
+      {"VAR_LIBRARY_ROOTMEANSQUARE", "var_library_rootmeansquare"},
+      {"VAR_LIBRARY_SANGLE", "var_library_sangle"},
+      {"VAR_LOG_SN_SCORE", "var_log_sn_score"},
+      {"VAR_MANHATTAN_SCORE", "var_manhatt_score"},
+      {"VAR_MASSDEV_SCORE", "var_massdev_score"},
+      {"VAR_MASSDEV_SCORE_WEIGHTED", "var_massdev_score_weighted"},
+      {"VAR_MI_SCORE", "var_mi_score"},
+      {"VAR_MI_WEIGHTED_SCORE", "var_mi_weighted_score"},
+      {"VAR_MI_RATIO_SCORE", "var_mi_ratio_score"},
+      {"VAR_NORM_RT_SCORE", "var_norm_rt_score"},
+      {"VAR_XCORR_COELUTION", "var_xcorr_coelution"},
+      {"VAR_XCORR_COELUTION_WEIGHTED", "var_xcorr_coelution_weighted"},
+      {"VAR_XCORR_SHAPE", "var_xcorr_shape"},
+      {"VAR_XCORR_SHAPE_WEIGHTED", "var_xcorr_shape_weighted"},
+      {"VAR_YSERIES_SCORE", "var_yseries_score"},
+      {"VAR_ELUTION_MODEL_FIT_SCORE", "var_elution_model_fit_score"},
+      {"VAR_IM_XCORR_SHAPE", "var_im_xcorr_shape"},
+      {"VAR_IM_XCORR_COELUTION", "var_im_xcorr_coelution"},
+      {"VAR_IM_DELTA_SCORE", "var_im_delta_score"}
+    };
+
+    const std::vector<std::pair<const char*, const char*>> sonar_score_columns =
+    {
+      {"VAR_SONAR_LAG", "var_sonar_lag"},
+      {"VAR_SONAR_SHAPE", "var_sonar_shape"},
+      {"VAR_SONAR_LOG_SN", "var_sonar_log_sn"},
+      {"VAR_SONAR_LOG_DIFF", "var_sonar_log_diff"},
+      {"VAR_SONAR_LOG_TREND", "var_sonar_log_trend"},
+      {"VAR_SONAR_RSQ", "var_sonar_rsq"}
+    };
+
+    // (column, meta value) of the transition-level scores of an MS2 subordinate (after FEATURE_ID .. MASSERROR_PPM, TOTAL_MI)
+    const std::vector<std::pair<const char*, const char*>> peak_shape_columns =
+    {
+      {"START_POSITION_AT_5", "start_position_at_5"},
+      {"END_POSITION_AT_5", "end_position_at_5"},
+      {"START_POSITION_AT_10", "start_position_at_10"},
+      {"END_POSITION_AT_10", "end_position_at_10"},
+      {"START_POSITION_AT_50", "start_position_at_50"},
+      {"END_POSITION_AT_50", "end_position_at_50"},
+      {"TOTAL_WIDTH", "total_width"},
+      {"TAILING_FACTOR", "tailing_factor"},
+      {"ASYMMETRY_FACTOR", "asymmetry_factor"},
+      {"SLOPE_OF_BASELINE", "slope_of_baseline"},
+      {"BASELINE_DELTA_2_HEIGHT", "baseline_delta_2_height"},
+      {"POINTS_ACROSS_BASELINE", "points_across_baseline"},
+      {"POINTS_ACROSS_HALF_HEIGHT", "points_across_half_height"}
+    };
+
+    // (column, meta value suffix after "id_target_" / "id_decoy_") of the UIS transition scores
+    const std::vector<std::pair<const char*, const char*>> uis_score_columns =
+    {
+      {"TRANSITION_ID", "transition_names"},
+      {"AREA_INTENSITY", "area_intensity"},
+      {"TOTAL_AREA_INTENSITY", "total_area_intensity"},
+      {"APEX_INTENSITY", "apex_intensity"},
+      {"APEX_RT", "peak_apex_position"},
+      {"RT_FWHM", "width_at_50"},
+      {"MASSERROR_PPM", "ind_massdev_score"},
+      {"TOTAL_MI", "total_mi"},
+      {"VAR_INTENSITY_SCORE", "intensity_score"},
+      {"VAR_INTENSITY_RATIO_SCORE", "intensity_ratio_score"},
+      {"VAR_LOG_INTENSITY", "ind_log_intensity"},
+      {"VAR_XCORR_COELUTION", "ind_xcorr_coelution"},
+      {"VAR_XCORR_SHAPE", "ind_xcorr_shape"},
+      {"VAR_LOG_SN_SCORE", "ind_log_sn_score"},
+      {"VAR_MASSDEV_SCORE", "ind_massdev_score"},
+      {"VAR_MI_SCORE", "ind_mi_score"},
+      {"VAR_MI_RATIO_SCORE", "ind_mi_ratio_score"},
+      {"VAR_ISOTOPE_CORRELATION_SCORE", "ind_isotope_correlation"},
+      {"VAR_ISOTOPE_OVERLAP_SCORE", "ind_isotope_overlap"}
+    };
+
+    String buildInsert(const String& table, const std::vector<String>& columns)
+    {
+      String placeholders;
+      for (Size i = 0; i < columns.size(); ++i)
+      {
+        placeholders += (i == 0 ? "?" : ", ?");
+      }
+      return "INSERT INTO " + table + " (" + ListUtils::concatenate(columns, ", ") + ") VALUES (" + placeholders + ");";
+    }
+
+    std::vector<String> columnNames(std::vector<String> prefix, const std::vector<std::pair<const char*, const char*>>& columns)
+    {
+      for (const auto& c : columns) prefix.emplace_back(c.first);
+      return prefix;
+    }
+
+    /// SQL and number of bound values for each BulkStatement
+    const std::vector<std::pair<String, Size>>& bulkStatements()
+    {
+      static const std::vector<std::pair<String, Size>> statements = []()
+      {
+        std::vector<std::vector<String>> columns(SIZE_OF_BULKSTATEMENT);
+        std::vector<String> tables(SIZE_OF_BULKSTATEMENT);
+
+        tables[STMT_FEATURE] = "FEATURE";
+        columns[STMT_FEATURE] = {"ID", "RUN_ID", "PRECURSOR_ID", "EXP_RT", "EXP_IM", "NORM_RT", "DELTA_RT", "LEFT_WIDTH", "RIGHT_WIDTH"};
+        tables[STMT_FEATURE_MS1] = "FEATURE_MS1";
+        columns[STMT_FEATURE_MS1] = columnNames({"FEATURE_ID"}, ms1_score_columns);
+        tables[STMT_FEATURE_MS2] = "FEATURE_MS2";
+        columns[STMT_FEATURE_MS2] = columnNames({"FEATURE_ID", "AREA_INTENSITY"}, ms2_score_columns);
+        tables[STMT_FEATURE_MS2_SONAR] = "FEATURE_MS2";
+        columns[STMT_FEATURE_MS2_SONAR] = columnNames(columns[STMT_FEATURE_MS2], sonar_score_columns);
+        tables[STMT_FEATURE_PRECURSOR] = "FEATURE_PRECURSOR";
+        columns[STMT_FEATURE_PRECURSOR] = {"FEATURE_ID", "ISOTOPE", "AREA_INTENSITY", "APEX_INTENSITY"};
+        tables[STMT_FEATURE_TRANSITION] = "FEATURE_TRANSITION";
+        columns[STMT_FEATURE_TRANSITION] = {"FEATURE_ID", "TRANSITION_ID", "AREA_INTENSITY", "TOTAL_AREA_INTENSITY", "APEX_INTENSITY", "APEX_RT", "RT_FWHM", "MASSERROR_PPM", "TOTAL_MI"};
+        tables[STMT_FEATURE_TRANSITION_SHAPE] = "FEATURE_TRANSITION";
+        columns[STMT_FEATURE_TRANSITION_SHAPE] = columnNames(columns[STMT_FEATURE_TRANSITION], peak_shape_columns);
+        tables[STMT_FEATURE_TRANSITION_UIS] = "FEATURE_TRANSITION";
+        columns[STMT_FEATURE_TRANSITION_UIS] = columnNames({"FEATURE_ID"}, uis_score_columns);
+        tables[STMT_FEATURE_TRANSITION_UIS_SHAPE] = "FEATURE_TRANSITION";
+        columns[STMT_FEATURE_TRANSITION_UIS_SHAPE] = columnNames(columns[STMT_FEATURE_TRANSITION_UIS], peak_shape_columns);
+
+        std::vector<std::pair<String, Size>> result;
+        for (Size i = 0; i < SIZE_OF_BULKSTATEMENT; ++i)
+        {
+          result.emplace_back(buildInsert(tables[i], columns[i]), columns[i].size());
+        }
+        return result;
+      }();
+      return statements;
+    }
+
+    /// Same semantics as OpenSwathOSWWriter::getScore: missing and NaN values become NULL
+    BulkValue toBulkValue(const String& s)
+    {
+      String lower = s;
+      lower.toLower();
+      if (s.empty() || lower == "null" || lower == "nan" || lower == "-nan") return std::monostate();
+      return std::string(s);
+    }
+
+    BulkValue toBulkValue(double d)
+    {
+      if (std::isnan(d)) return std::monostate();
+      return d;
+    }
+
+    BulkValue toBulkValue(const DataValue& dv)
+    {
+      switch (dv.valueType())
+      {
+        case DataValue::INT_VALUE:
+          return Int64(dv);
+        case DataValue::DOUBLE_VALUE:
+          return toBulkValue(double(dv));
+        case DataValue::STRING_VALUE:
+          return toBulkValue(String(dv.toString()));
+        case DataValue::EMPTY_VALUE:
+          return std::monostate();
+        default: // lists are stored in their string representation (as in prepareLine)
+          return std::string(dv.toString());
+      }
+    }
+
+    /// Element @p i of a list-valued meta value (see OpenSwathOSWWriter::getSeparateScore)
+    BulkValue toBulkValue(const DataValue& dv, Size i)
+    {
+      switch (dv.valueType())
+      {
+        case DataValue::INT_LIST:
+        {
+          const IntList& l = dv.toIntList();
+          return i < l.size() ? BulkValue(Int64(l[i])) : BulkValue();
+        }
+        case DataValue::DOUBLE_LIST:
+        {
+          const DoubleList& l = dv.toDoubleList();
+          return i < l.size() ? toBulkValue(l[i]) : BulkValue();
+        }
+        case DataValue::STRING_LIST:
+        {
+          const StringList& l = dv.toStringList();
+          return i < l.size() ? toBulkValue(l[i]) : BulkValue();
+        }
+        default:
+          return i == 0 ? toBulkValue(dv) : BulkValue();
+      }
+    }
+
+    void bindBulkValue(sqlite3_stmt* stmt, int pos, const BulkValue& value)
+    {
+      int rc;
+      switch (value.index())
+      {
+        case 1:
+          rc = sqlite3_bind_int64(stmt, pos, std::get<Int64>(value));
+          break;
+        case 2:
+          rc = sqlite3_bind_double(stmt, pos, std::get<double>(value));
+          break;
+        case 3:
+        {
+          const std::string& s = std::get<std::string>(value);
+          rc = sqlite3_bind_text(stmt, pos, s.c_str(), static_cast<int>(s.size()), SQLITE_STATIC);
+          break;
+        }
+        default:
+          rc = sqlite3_bind_null(stmt, pos);
+      }
+      if (rc != SQLITE_OK)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            String("Binding value to SQL statement failed: ") + sqlite3_errstr(rc));
+      }
+    }
+  }
+
+  struct OpenSwathOSWWriter::BulkWriter_
+  {
+    std::mutex mutex;
+    std::condition_variable queue_not_empty;
+    std::condition_variable queue_not_full;
+    std::deque<BulkRowBatch> queue;
+    Size queued_rows = 0;
+    bool closed = false;
+    std::exception_ptr error;
+    std::thread thread;
+
+    ~BulkWriter_()
+    {
+      close();
+    }
+
+    /// Signals the writer thread that no more data will arrive and waits for it
+    void close()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+      }
+      queue_not_empty.notify_all();
+      if (thread.joinable()) thread.join();
+    }
+
+    void run(const String& filename, Size rows_per_transaction, bool synchronous)
+    {
+      std::vector<sqlite3_stmt*> stmts(SIZE_OF_BULKSTATEMENT, nullptr);
+      try
+      {
+        SqliteConnector conn(filename);
+        sqlite3* db = conn.getDB();
+        if (!synchronous)
+        {
+          // faster, but a crash during the bulk load can corrupt the file (see enableBulkWrite())
+          conn.executeStatement("PRAGMA synchronous = OFF; PRAGMA journal_mode = MEMORY;");
+        }
+
+        const auto& statements = bulkStatements();
+        for (Size i = 0; i < statements.size(); ++i)
+        {
+          SqliteConnector::prepareStatement(db, &stmts[i], statements[i].first);
+        }
+
+        Size rows_in_transaction = 0;
+        while (true)
+        {
+          BulkRowBatch batch;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            queue_not_empty.wait(lock, [this]() { return closed || !queue.empty(); });
+            if (queue.empty()) break; // closed and drained
+            batch = std::move(queue.front());
+            queue.pop_front();
+            queued_rows -= batch.rows.size();
+          }
+          queue_not_full.notify_all();
+
+          if (rows_in_transaction == 0) conn.executeStatement("BEGIN TRANSACTION");
+          for (Size r = 0; r < batch.rows.size(); ++r)
+          {
+            const BulkStatement s = batch.rows[r].first;
+            sqlite3_stmt* stmt = stmts[s];
+            const Size first = batch.rows[r].second;
+            for (Size k = 0; k < statements[s].second; ++k)
+            {
+              bindBulkValue(stmt, static_cast<int>(k + 1), batch.values[first + k]);
+            }
+            if (sqlite3_step(stmt) != SQLITE_DONE)
+            {
+              throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                  String("Inserting row failed: ") + sqlite3_errmsg(db) + "\nStatement: " + statements[s].first);
+            }
+            sqlite3_reset(stmt);
+          }
+          rows_in_transaction += batch.rows.size();
+          if (rows_in_transaction >= rows_per_transaction)
+          {
+            conn.executeStatement("END TRANSACTION");
+            rows_in_transaction = 0;
+          }
+        }
+        if (rows_in_transaction > 0) conn.executeStatement("END TRANSACTION");
+
+        for (auto& stmt : stmts) sqlite3_finalize(stmt);
+        stmts.clear();
+
+        // indices are only built after the bulk load (much faster than updating them on every insert)
+        conn.executeStatement(
+          "CREATE INDEX IF NOT EXISTS idx_feature_precursor_id ON FEATURE (PRECURSOR_ID);"
+          "CREATE INDEX IF NOT EXISTS idx_feature_run_id ON FEATURE (RUN_ID);"
+          "CREATE INDEX IF NOT EXISTS idx_feature_ms1_feature_id ON FEATURE_MS1 (FEATURE_ID);"
+          "CREATE INDEX IF NOT EXISTS idx_feature_ms2_feature_id ON FEATURE_MS2 (FEATURE_ID);"
+          "CREATE INDEX IF NOT EXISTS idx_feature_precursor_feature_id ON FEATURE_PRECURSOR (FEATURE_ID);"
+          "CREATE INDEX IF NOT EXISTS idx_feature_transition_feature_id ON FEATURE_TRANSITION (FEATURE_ID);"
+          "CREATE INDEX IF NOT EXISTS idx_feature_transition_transition_id ON FEATURE_TRANSITION (TRANSITION_ID);");
+      }
+      catch (...)
+      {
+        for (auto& stmt : stmts) sqlite3_finalize(stmt);
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+        // drop everything that is still queued and release blocked producers
+        queue.clear();
+        queued_rows = 0;
+        closed = true;
+      }
+      queue_not_full.notify_all();
+    }
+  };
+
   OpenSwathOSWWriter::OpenSwathOSWWriter(const String& output_filename, const UInt64 run_id, const String& input_filename, bool uis_scores) :
     output_filename_(output_filename),
     input_filename_(input_filename),
@@ -27,6 +441,18 @@ namespace OpenMS
     return doWrite_;
   }
 
+  void OpenSwathOSWWriter::enableBulkWrite(Size rows_per_transaction, Size max_queued_rows, bool synchronous)
+  {
+    bulk_rows_per_transaction_ = std::max(rows_per_transaction, Size(1));
+    bulk_max_queued_rows_ = std::max(max_queued_rows, Size(1));
+    bulk_synchronous_ = synchronous;
+  }
+
+  bool OpenSwathOSWWriter::isBulkWriting() const
+  {
+    return bulk_writer_ != nullptr;
+  }
+
   void OpenSwathOSWWriter::writeHeader()
   {
     // Open database
@@ -170,6 +596,12 @@ namespace OpenMS
 
     // Execute SQL insert statement
     conn.executeStatement(sql_run.str());
+
+    if (doWrite_ && bulk_rows_per_transaction_ > 0)
+    {
+      bulk_writer_ = std::make_shared<BulkWriter_>();
+      bulk_writer_->thread = std::thread(&BulkWriter_::run, bulk_writer_.get(), output_filename_, bulk_rows_per_transaction_, bulk_synchronous_);
+    }
   }
 
   String OpenSwathOSWWriter::getScore(const Feature& feature, const std::string& score_name) const
@@ -618,5 +1050,162 @@ namespace OpenMS
     }
     conn.executeStatement("END TRANSACTION");
   }
-}
 
+  bool OpenSwathOSWWriter::enqueueFeatures(const FeatureMap& output, const String& id)
+  {
+    if (bulk_writer_ == nullptr)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Bulk writing was not started (call enableBulkWrite() before writeHeader()).");
+    }
+
+    // build all rows outside of the lock, in the same table order as prepareLine()
+    BulkRowBatch features, ms1, precursors, ms2, transitions, uis_transitions;
+    for (const auto& feature_it : output)
+    {
+      const Int64 feature_id = Internal::SqliteHelper::clearSignBit(feature_it.getUniqueId());
+
+      const DataValue& masserror_ppm = feature_it.getMetaValue("masserror_ppm");
+      const auto& subordinates = feature_it.getSubordinates();
+      for (Size i = 0; i < subordinates.size(); i++)
+      {
+        const auto& sub_it = subordinates[i];
+        if (!sub_it.metaValueExists("FeatureLevel")) continue;
+
+        if (sub_it.getMetaValue("FeatureLevel") == "MS2")
+        {
+          const bool peak_shape = sub_it.metaValueExists("start_position_at_5");
+          transitions.beginRow(peak_shape ? STMT_FEATURE_TRANSITION_SHAPE : STMT_FEATURE_TRANSITION);
+          auto& v = transitions.values;
+          v.emplace_back(feature_id);
+          v.push_back(toBulkValue(sub_it.getMetaValue("native_id")));
+          v.push_back(toBulkValue(double(sub_it.getIntensity())));
+          v.push_back(toBulkValue(sub_it.getMetaValue("total_xic")));
+          v.push_back(toBulkValue(sub_it.getMetaValue("peak_apex_int")));
+          v.push_back(toBulkValue(sub_it.getMetaValue("peak_apex_position")));
+          v.push_back(toBulkValue(sub_it.getMetaValue("width_at_50")));
+          v.push_back(toBulkValue(masserror_ppm, i));
+          v.push_back(toBulkValue(sub_it.getMetaValue("total_mi")));
+          if (peak_shape)
+          {
+            for (const auto& c : peak_shape_columns) v.push_back(toBulkValue(sub_it.getMetaValue(c.second)));
+          }
+        }
+        else if (sub_it.getMetaValue("FeatureLevel") == "MS1" && sub_it.getIntensity() > 0.0)
+        {
+          std::vector<String> precursor_id;
+          String(sub_it.getMetaValue("native_id")).split(String("Precursor_i"), precursor_id);
+          precursors.beginRow(STMT_FEATURE_PRECURSOR);
+          auto& v = precursors.values;
+          v.emplace_back(feature_id);
+          v.push_back(precursor_id.size() > 1 ? toBulkValue(precursor_id[1]) : BulkValue());
+          v.push_back(toBulkValue(double(sub_it.getIntensity())));
+          v.push_back(toBulkValue(sub_it.getMetaValue("peak_apex_int")));
+        }
+      }
+
+      // these will be missing if RT scoring is disabled
+      double norm_rt = -1, delta_rt = -1;
+      if (feature_it.metaValueExists("norm_RT")) norm_rt = feature_it.getMetaValue("norm_RT");
+      if (feature_it.metaValueExists("delta_rt")) delta_rt = feature_it.getMetaValue("delta_rt");
+
+      features.beginRow(STMT_FEATURE);
+      features.values.emplace_back(feature_id);
+      features.values.emplace_back(Int64(run_id_));
+      features.values.push_back(toBulkValue(id));
+      features.values.push_back(toBulkValue(feature_it.getRT()));
+      features.values.push_back(toBulkValue(feature_it.getMetaValue("im_drift")));
+      features.values.push_back(toBulkValue(norm_rt));
+      features.values.push_back(toBulkValue(delta_rt));
+      features.values.push_back(toBulkValue(feature_it.getMetaValue("leftWidth")));
+      features.values.push_back(toBulkValue(feature_it.getMetaValue("rightWidth")));
+
+      const bool sonar = feature_it.metaValueExists("var_sonar_lag");
+      ms2.beginRow(sonar ? STMT_FEATURE_MS2_SONAR : STMT_FEATURE_MS2);
+      ms2.values.emplace_back(feature_id);
+      ms2.values.push_back(toBulkValue(double(feature_it.getIntensity())));
+      for (const auto& c : ms2_score_columns) ms2.values.push_back(toBulkValue(feature_it.getMetaValue(c.second)));
+      if (sonar)
+      {
+        for (const auto& c : sonar_score_columns) ms2.values.push_back(toBulkValue(feature_it.getMetaValue(c.second)));
+      }
+
+      if (feature_it.metaValueExists("var_ms1_ppm_diff")) // only write MS1 scores if they are present
+      {
+        ms1.beginRow(STMT_FEATURE_MS1);
+        ms1.values.emplace_back(feature_id);
+        for (const auto& c : ms1_score_columns) ms1.values.push_back(toBulkValue(feature_it.getMetaValue(c.second)));
+      }
+
+      if (enable_uis_scoring_)
+      {
+        // peak shape metrics are reported for target and decoy transitions if present for the targets
+        const std::vector<String> target_start_5 = getSeparateScore(feature_it, "id_target_ind_start_position_at_5");
+        const bool peak_shape = !target_start_5.empty() && target_start_5[0] != "0";
+
+        for (const String prefix : {"id_target_", "id_decoy_"})
+        {
+          if (!feature_it.metaValueExists(prefix + "num_transitions")) continue;
+
+          std::vector<const DataValue*> scores;
+          for (const auto& c : uis_score_columns) scores.push_back(&feature_it.getMetaValue(prefix + c.second));
+          if (peak_shape)
+          {
+            for (const auto& c : peak_shape_columns) scores.push_back(&feature_it.getMetaValue(prefix + "ind_" + c.second));
+          }
+
+          const int num_transitions = feature_it.getMetaValue(prefix + "num_transitions");
+          for (int k = 0; k < num_transitions; ++k)
+          {
+            uis_transitions.beginRow(peak_shape ? STMT_FEATURE_TRANSITION_UIS_SHAPE : STMT_FEATURE_TRANSITION_UIS);
+            uis_transitions.values.emplace_back(feature_id);
+            for (const DataValue* score : scores) uis_transitions.values.push_back(toBulkValue(*score, k));
+          }
+        }
+      }
+    }
+
+    BulkRowBatch batch = std::move(features);
+    batch.append(ms1);
+    batch.append(precursors);
+    batch.append(ms2);
+    batch.append((enable_uis_scoring_ && !uis_transitions.rows.empty()) ? uis_transitions : transitions);
+    if (batch.rows.empty()) return true;
+
+    const Size nr_rows = batch.rows.size();
+    {
+      std::unique_lock<std::mutex> lock(bulk_writer_->mutex);
+      // always accept a batch into an empty queue, even if it exceeds the limit by itself
+      bulk_writer_->queue_not_full.wait(lock, [this]()
+      {
+        return bulk_writer_->closed || bulk_writer_->queue.empty() || bulk_writer_->queued_rows < bulk_max_queued_rows_;
+      });
+      if (bulk_writer_->error)
+      {
+        return false; // rethrown by finishBulkWrite()
+      }
+      if (bulk_writer_->closed)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            "Bulk writing was already finished.");
+      }
+      bulk_writer_->queue.push_back(std::move(batch));
+      bulk_writer_->queued_rows += nr_rows;
+    }
+    bulk_writer_->queue_not_empty.notify_one();
+    return true;
+  }
+
+  void OpenSwathOSWWriter::finishBulkWrite()
+  {
+    if (bulk_writer_ == nullptr) return;
+
+    bulk_writer_->close();
+    std::exception_ptr error = bulk_writer_->error;
+    bulk_writer_.reset();
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+}
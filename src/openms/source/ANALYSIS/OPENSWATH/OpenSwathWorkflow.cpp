@@ -257,6 +257,9 @@ namespace OpenMS
     SwathMapMassCorrection mc;
     mc.setParameters(calibration_param);
 
+    // two passes over the calibrants: the ion mobility calibration integrates
+    // the fragment (or precursor) m/z windows in the m/z-corrected maps that
+    // correctMZ installs, so its points depend on the m/z fit
     mc.correctMZ(trgrmap_final, targeted_exp, swath_maps, pasef);
     mc.correctIM(trgrmap_final, targeted_exp, swath_maps, pasef, im_trafo);
 
@@ -808,6 +811,7 @@ namespace OpenMS
 
     }
     this->endProgress();
+    osw_writer.finishBulkWrite(); // flush remaining rows and build indices
 
 #ifdef _OPENMP
 #ifdef MT_ENABLE_NESTED_OPENMP
@@ -964,6 +968,7 @@ namespace OpenMS
     }
 
     std::vector<String> to_tsv_output, to_osw_output;
+    MRMTransitionGroupPicker::Workspace picker_workspace;
     ///////////////////////////////////
     // Start of main function
     // Iterating over all the assays
@@ -1032,7 +1037,7 @@ namespace OpenMS
       }
 
       // 3. / 4. Process the MRMTransitionGroup: find peakgroups and score them
-      trgroup_picker.pickTransitionGroup(transition_group);
+      trgroup_picker.pickTransitionGroup(transition_group, picker_workspace);
       featureFinder.scorePeakgroups(transition_group, trafo, swath_maps, output, ms1only);
 
       // Ensure that a detection transition is used to derive features for output
@@ -1049,8 +1054,13 @@ namespace OpenMS
         to_tsv_output.push_back(tsv_writer.prepareLine(pep, detection_assay_it, output, id));
       }
 
-      // 6. Add to the output osw if given
-      if (osw_writer.isActive() && !output.empty()) // implies that detection_assay_it was set
+      // 6. Add to the output osw if given (either directly to the writer thread or collect for writing below)
+      if (osw_writer.isBulkWriting() && !output.empty())
+      {
+        // does not throw if the writer thread failed (we may be inside a parallel region): the error is rethrown by finishBulkWrite()
+        osw_writer.enqueueFeatures(output, id);
+      }
+      else if (osw_writer.isActive() && !output.empty()) // implies that detection_assay_it was set
       {
         const OpenSwath::LightCompound pep;
         to_osw_output.push_back(osw_writer.prepareLine(OpenSwath::LightCompound(), // not used currently: transition_exp.getCompounds()[ assay_peptide_map[id] ],
@@ -1072,7 +1082,7 @@ namespace OpenMS
     }
 
     // Only write at the very end since this is a step that needs a barrier
-    if (osw_writer.isActive())
+    if (osw_writer.isActive() && !osw_writer.isBulkWriting())
     {
 #ifdef _OPENMP
 #pragma omp critical (osw_write_tsv)
@@ -1330,6 +1340,7 @@ namespace OpenMS
         this->setProgress(++progress);
       }
       this->endProgress();
+      osw_writer.finishBulkWrite(); // flush remaining rows and build indices
     }
 
 
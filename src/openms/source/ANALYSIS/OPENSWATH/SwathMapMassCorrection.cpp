@@ -18,6 +18,10 @@
 
 #include <fstream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #define SWATHMAPMASSCORRECTION_DEBUG
 
 namespace OpenMS
@@ -53,6 +57,42 @@ namespace OpenMS
     return used_maps;
   }
 
+  namespace
+  {
+    // Creates one set of light clones of the SWATH maps per thread, so that
+    // spectra can be fetched from all threads concurrently
+    std::vector<std::vector<OpenSwath::SwathMap> > cloneSwathMapsPerThread(const std::vector< OpenSwath::SwathMap > & swath_maps)
+    {
+      int nr_threads = 1;
+#ifdef _OPENMP
+      nr_threads = omp_get_max_threads();
+#endif
+      std::vector<std::vector<OpenSwath::SwathMap> > thread_maps(nr_threads, swath_maps);
+      for (auto& maps : thread_maps)
+      {
+        for (auto& m : maps) {m.sptr = m.sptr->lightClone();}
+      }
+      return thread_maps;
+    }
+
+    // Returns the library drift time of a peptide (0 if unknown); does not
+    // modify the map, so it can be used from multiple threads
+    double lookupDriftTime(const std::map<std::string, double>& pep_im_map, const std::string& pepref)
+    {
+      auto it = pep_im_map.find(pepref);
+      return it != pep_im_map.end() ? it->second : 0.0;
+    }
+
+    int currentThreadIndex()
+    {
+#ifdef _OPENMP
+      return omp_get_thread_num();
+#else
+      return 0;
+#endif
+    }
+  }
+
   // Computes the SwathMaps for PASEF data in which windows can have the same m/z but differ by ion mobility
   // NOTE: swathMap is stored as a vector to enable compatibility with downstream function calls (as SONAR) can have multiple windows
   std::vector<OpenSwath::SwathMap> SwathMapMassCorrection::findSwathMapsPasef(const OpenMS::MRMFeatureFinderScoring::MRMTransitionGroupType& transition_group,
@@ -170,11 +210,25 @@ namespace OpenMS
     std::vector<double> exp_im;
     std::vector<double> theo_im;
 
+    // Collect the calibration points of all transition groups in a single
+    // parallel pass. Each thread reads spectra through its own light clones
+    // of the SWATH maps; the points are merged afterwards in the order of the
+    // transition groups, so the result does not depend on the thread count.
+    struct IMCalibrationPoint
+    {
+      double precursor_mz, im, drift_target, rt, intensity;
+    };
+    std::vector<std::vector<IMCalibrationPoint> > points_per_group(trgr_ids.size());
+    std::vector<std::vector<OpenSwath::SwathMap> > thread_maps = cloneSwathMapsPerThread(swath_maps);
+
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic)
 #endif
     for (SignedSize k = 0; k < (SignedSize)trgr_ids.size(); k++)
     {
+      const std::vector<OpenSwath::SwathMap>& maps = thread_maps[currentThreadIndex()];
+      std::vector<IMCalibrationPoint>& points = points_per_group[k];
+
       // we need at least one feature to find the best one
       auto transition_group = transition_group_map.at(trgr_ids[k]);
       if (transition_group->getFeatures().empty()) continue;
@@ -186,16 +240,16 @@ namespace OpenMS
       std::vector<OpenSwath::SwathMap> used_maps;
       if (!pasef)
       {
-        used_maps = findSwathMaps(*transition_group, swath_maps);
+        used_maps = findSwathMaps(*transition_group, maps);
       }
       // If pasef then have to check for overlap across IM
       else
       {
-        used_maps = findSwathMapsPasef(*transition_group, swath_maps);
+        used_maps = findSwathMapsPasef(*transition_group, maps);
       }
 
       std::vector<OpenSwath::SwathMap> ms1_maps;
-      for (const auto& m : swath_maps) {if (m.ms1) ms1_maps.push_back(m);}
+      for (const auto& m : maps) {if (m.ms1) ms1_maps.push_back(m);}
 
       if (used_maps.empty())
       {
@@ -204,24 +258,19 @@ namespace OpenMS
 
       // Get the spectrum for this RT and extract raw data points for all the
       // calibrating transitions (fragment m/z values) from the spectrum
-      // Note that we are not using light clones of the underlying data here,
-      // so access to the data needs to be in a critical section.
       OpenSwath::SpectrumPtr sp_ms1;
       OpenSwath::SpectrumPtr sp_ms2;
-#ifdef _OPENMP
-#pragma omp critical
-#endif
       {
         RangeMobility im_range;
         if (ms1_im_)
         {
           std::vector<OpenSwath::SpectrumPtr> fetchSpectrumArr = OpenSwathScoring().fetchSpectrumSwath(ms1_maps, bestRT, 1, im_range);
-          sp_ms1 = (!fetchSpectrumArr.empty()) ? fetchSpectrumArr[0] : *new(OpenSwath::SpectrumPtr);
+          if (!fetchSpectrumArr.empty()) sp_ms1 = fetchSpectrumArr[0];
         }
         else
         {
           std::vector<OpenSwath::SpectrumPtr> fetchSpectrumArr = OpenSwathScoring().fetchSpectrumSwath(used_maps, bestRT, 1, im_range);
-          sp_ms2 = (!fetchSpectrumArr.empty()) ? fetchSpectrumArr[0] : *new(OpenSwath::SpectrumPtr);
+          if (!fetchSpectrumArr.empty()) sp_ms2 = fetchSpectrumArr[0];
         }
       }
 
@@ -234,7 +283,7 @@ namespace OpenMS
         // get drift time upper/lower offset (this assumes that all chromatograms
         // are derived from the same precursor with the same drift time)
         auto pepref = tr.getPeptideRef();
-        double drift_target = pep_im_map[pepref];
+        double drift_target = lookupDriftTime(pep_im_map, pepref);
         RangeMobility im_range;
         if (im_extraction_win != -1 ) // im_extraction_win is set
         {
@@ -243,7 +292,7 @@ namespace OpenMS
         }
 
         // Check that the spectrum really has a drift time array
-        if (sp_ms2->getDriftTimeArray() == nullptr)
+        if (sp_ms2 == nullptr || sp_ms2->getDriftTimeArray() == nullptr)
         {
           OPENMS_LOG_DEBUG << "Did not find a drift time array for peptide " << pepref << " at RT " << bestRT  << std::endl;
           for (const auto& m : used_maps)
@@ -261,19 +310,8 @@ namespace OpenMS
           continue;
         }
 
-#ifdef _OPENMP
-#pragma omp critical
-#endif
-        {
-          // store result drift time
-          data_im.push_back(std::make_pair(im, drift_target));
-          exp_im.push_back(im);
-          theo_im.push_back(drift_target);
-          if (!debug_im_file_.empty())
-          {
-            os_im << tr.precursor_mz << "\t" << im << "\t" << drift_target << "\t" << bestRT << "\t" << intensity << std::endl;
-          }
-        }
+        // store result drift time
+        points.push_back({tr.precursor_mz, im, drift_target, bestRT, intensity});
         OPENMS_LOG_DEBUG << tr.precursor_mz << "\t" << im << "\t" << drift_target << "\t" << bestRT << "\t" << intensity << std::endl;
       }
 
@@ -287,14 +325,14 @@ namespace OpenMS
         // get drift time upper/lower offset (this assumes that all chromatograms
         // are derived from the same precursor with the same drift time)
         auto pepref = tr.getPeptideRef();
-        double drift_target = pep_im_map[pepref];
+        double drift_target = lookupDriftTime(pep_im_map, pepref);
 
         // do not need to check for IM because we are correcting IM
         RangeMobility im_range(drift_target);
         im_range.minSpanIfSingular(im_extraction_win);
 
         // Check that the spectrum really has a drift time array
-        if (sp_ms1->getDriftTimeArray() == nullptr)
+        if (sp_ms1 == nullptr || sp_ms1->getDriftTimeArray() == nullptr)
         {
           OPENMS_LOG_DEBUG << "Did not find a drift time array for peptide " << pepref << " at RT " << bestRT  << std::endl;
           for (const auto& m : used_maps)
@@ -312,20 +350,23 @@ namespace OpenMS
           continue;
         }
 
-#ifdef _OPENMP
-#pragma omp critical
-#endif
+        // store result drift time
+        points.push_back({tr.precursor_mz, im, drift_target, bestRT, intensity});
+        OPENMS_LOG_DEBUG << tr.precursor_mz << "\t" << im << "\t" << drift_target << "\t" << bestRT << "\t" << intensity << std::endl;
+      }
+    }
+
+    for (const auto& points : points_per_group)
+    {
+      for (const auto& p : points)
+      {
+        data_im.push_back(std::make_pair(p.im, p.drift_target));
+        exp_im.push_back(p.im);
+        theo_im.push_back(p.drift_target);
+        if (!debug_im_file_.empty())
         {
-          // store result drift time
-          data_im.push_back(std::make_pair(im, drift_target));
-          exp_im.push_back(im);
-          theo_im.push_back(drift_target);
-          if (!debug_im_file_.empty())
-          {
-            os_im << tr.precursor_mz << "\t" << im << "\t" << drift_target << "\t" << bestRT << "\t" << intensity << std::endl;
-          }
+          os_im << p.precursor_mz << "\t" << p.im << "\t" << p.drift_target << "\t" << p.rt << "\t" << p.intensity << std::endl;
         }
-        OPENMS_LOG_DEBUG << tr.precursor_mz << "\t" << im << "\t" << drift_target << "\t" << bestRT << "\t" << intensity << std::endl;
       }
     }
 
@@ -401,14 +442,36 @@ namespace OpenMS
       pep_im_map[cmp.id] = cmp.drift_time;
     }
 
-    for (auto & trgroup_it : transition_group_map)
+    // Collect the calibration points of all transition groups in a single
+    // parallel pass (see correctIM); the points are merged in the order of
+    // the transition groups.
+    struct MZCalibrationPoint
+    {
+      double mz, theo_mz, intensity, drift_target, rt;
+    };
+    std::vector<const OpenMS::MRMFeatureFinderScoring::MRMTransitionGroupType*> transition_groups;
+    transition_groups.reserve(transition_group_map.size());
+    for (const auto& trgroup_it : transition_group_map)
     {
+      transition_groups.push_back(trgroup_it.second);
+    }
+    std::vector<std::vector<MZCalibrationPoint> > points_per_group(transition_groups.size());
+    std::vector<std::vector<OpenSwath::SwathMap> > thread_maps = cloneSwathMapsPerThread(swath_maps);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (SignedSize k = 0; k < (SignedSize)transition_groups.size(); k++)
+    {
+      const std::vector<OpenSwath::SwathMap>& maps = thread_maps[currentThreadIndex()];
+      std::vector<MZCalibrationPoint>& points = points_per_group[k];
+
       // we need at least one feature to find the best one
-      auto transition_group = trgroup_it.second;
+      auto transition_group = transition_groups[k];
 
       const auto& tr = transition_group->getTransitions()[0];
       auto pepref = tr.getPeptideRef();
-      double drift_target = pep_im_map[pepref];
+      double drift_target = lookupDriftTime(pep_im_map, pepref);
 
       if (transition_group->getFeatures().empty()) continue;
 
@@ -419,12 +482,12 @@ namespace OpenMS
       std::vector<OpenSwath::SwathMap> used_maps;
       if (!pasef)
       {
-        used_maps = findSwathMaps(*transition_group, swath_maps);
+        used_maps = findSwathMaps(*transition_group, maps);
       }
       // If pasef then have to check for overlap across IM
       else
       {
-        used_maps = findSwathMapsPasef(*transition_group, swath_maps);
+        used_maps = findSwathMapsPasef(*transition_group, maps);
       }
 
       if (used_maps.empty())
@@ -443,7 +506,11 @@ namespace OpenMS
       // Get the spectrum for this RT and extract raw data points for all the
       // calibrating transitions (fragment m/z values) from the spectrum
       std::vector<OpenSwath::SpectrumPtr> spArr = OpenSwathScoring().fetchSpectrumSwath(used_maps, bestRT, 1, im_range);
-      OpenSwath::SpectrumPtr sp = (!spArr.empty()) ? spArr[0] : *new(OpenSwath::SpectrumPtr);
+      if (spArr.empty())
+      {
+        continue;
+      }
+      OpenSwath::SpectrumPtr sp = spArr[0];
       for (const auto& tr : transition_group->getTransitions())
       {
         double mz, intensity, im;
@@ -459,22 +526,30 @@ namespace OpenMS
           continue;
         }
 
+        points.push_back({mz, tr.product_mz, intensity, drift_target, bestRT});
+      }
+    }
+
+    for (const auto& points : points_per_group)
+    {
+      for (const auto& p : points)
+      {
         // store result masses
-        data_all.push_back(std::make_pair(mz, tr.product_mz));
+        data_all.push_back(std::make_pair(p.mz, p.theo_mz));
         // regression weight is the log2 intensity
-        weights.push_back( log(intensity) / log(2.0) );
-        exp_mz.push_back( mz );
+        weights.push_back( log(p.intensity) / log(2.0) );
+        exp_mz.push_back( p.mz );
         // y = target = theoretical
-        theo_mz.push_back( tr.product_mz );
-        double diff_ppm = (mz - tr.product_mz) * 1000000 / mz;
+        theo_mz.push_back( p.theo_mz );
+        double diff_ppm = (p.mz - p.theo_mz) * 1000000 / p.mz;
         // y = target = delta-ppm
         delta_ppm.push_back(diff_ppm);
 
         if (!debug_mz_file_.empty())
         {
-          os << mz << "\t" << tr.product_mz << "\t" << drift_target << "\t" << diff_ppm << "\t" << log(intensity) / log(2.0) << "\t" << bestRT << std::endl;
+          os << p.mz << "\t" << p.theo_mz << "\t" << p.drift_target << "\t" << diff_ppm << "\t" << log(p.intensity) / log(2.0) << "\t" << p.rt << std::endl;
         }
-        OPENMS_LOG_DEBUG << mz << "\t" << tr.product_mz << "\t" << diff_ppm << "\t" << log(intensity) / log(2.0) << "\t" << bestRT << std::endl;
+        OPENMS_LOG_DEBUG << p.mz << "\t" << p.theo_mz << "\t" << diff_ppm << "\t" << log(p.intensity) / log(2.0) << "\t" << p.rt << std::endl;
       }
     }
 
@@ -0,0 +1,291 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/TransitionBinaryFile.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Macros.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// sections: proteins, compounds, protein references, modifications, transitions, transition indices sorted by precursor m/z (UInt32)
+    enum Section { PROTEINS, COMPOUNDS, PROTEIN_REFS, MODIFICATIONS, TRANSITIONS, PRECURSOR_MZ_ORDER, NR_SECTIONS };
+
+    const Internal::MappedIndexFile::Format binary_library_format = {{'O', 'S', 'W', 'B', 'L', 'I', 'B', '\0'}, 2, NR_SECTIONS, "binary assay library"};
+  }
+
+  TransitionBinaryFile::TransitionBinaryFile() :
+    file_(binary_library_format)
+  {
+  }
+
+  TransitionBinaryFile::~TransitionBinaryFile()
+  {
+    close();
+  }
+
+  void TransitionBinaryFile::store(const String& filename, const OpenSwath::LightTargetedExperiment& exp, const String& source_file, const String& fingerprint)
+  {
+    Internal::MappedIndexFile::StringPool pool(binary_library_format);
+
+    std::vector<ProteinRecord> proteins;
+    proteins.reserve(exp.proteins.size());
+    for (const auto& p : exp.proteins)
+    {
+      proteins.push_back({pool.add(p.id), pool.add(p.sequence)});
+    }
+
+    std::vector<CompoundRecord> compounds;
+    std::vector<StringIndex> protein_refs;
+    std::vector<OpenSwath::LightModification> modifications;
+    compounds.reserve(exp.compounds.size());
+    for (const auto& c : exp.compounds)
+    {
+      CompoundRecord r{};
+      r.rt = c.rt;
+      r.drift_time = c.drift_time;
+      r.charge = c.charge;
+      r.id = pool.add(c.id);
+      r.sequence = pool.add(c.sequence);
+      r.peptide_group_label = pool.add(c.peptide_group_label);
+      r.gene_name = pool.add(c.gene_name);
+      r.sum_formula = pool.add(c.sum_formula);
+      r.compound_name = pool.add(c.compound_name);
+      r.first_protein_ref = binary_library_format.checkedUInt32(protein_refs.size(), "protein references");
+      r.nr_protein_refs = binary_library_format.checkedUInt32(c.protein_refs.size(), "protein references");
+      for (const auto& ref : c.protein_refs) protein_refs.push_back(pool.add(ref));
+      r.first_modification = binary_library_format.checkedUInt32(modifications.size(), "modifications");
+      r.nr_modifications = binary_library_format.checkedUInt32(c.modifications.size(), "modifications");
+      modifications.insert(modifications.end(), c.modifications.begin(), c.modifications.end());
+      compounds.push_back(r);
+    }
+
+    std::vector<TransitionRecord> transitions;
+    transitions.reserve(exp.transitions.size());
+    binary_library_format.checkedUInt32(exp.transitions.size(), "transitions");
+    for (const auto& t : exp.transitions)
+    {
+      TransitionRecord r{};
+      r.library_intensity = t.library_intensity;
+      r.product_mz = t.product_mz;
+      r.precursor_mz = t.precursor_mz;
+      r.precursor_im = t.precursor_im;
+      r.transition_name = pool.add(t.transition_name);
+      r.peptide_ref = pool.add(t.peptide_ref);
+      r.fragment_charge = t.fragment_charge;
+      r.flags = (t.decoy ? FLAG_DECOY : 0) | (t.detecting_transition ? FLAG_DETECTING : 0) |
+                (t.quantifying_transition ? FLAG_QUANTIFYING : 0) | (t.identifying_transition ? FLAG_IDENTIFYING : 0);
+      transitions.push_back(r);
+    }
+
+    // the m/z index used to select the transitions of a SWATH window
+    std::vector<UInt32> precursor_mz_order(transitions.size());
+    std::iota(precursor_mz_order.begin(), precursor_mz_order.end(), 0);
+    std::stable_sort(precursor_mz_order.begin(), precursor_mz_order.end(), [&transitions](UInt32 a, UInt32 b)
+    {
+      return std::tie(transitions[a].precursor_mz, transitions[a].product_mz) < std::tie(transitions[b].precursor_mz, transitions[b].product_mz);
+    });
+
+    Internal::MappedIndexFile::Writer writer(binary_library_format, filename, source_file, fingerprint, pool);
+    writer.addSection(proteins);
+    writer.addSection(compounds);
+    writer.addSection(protein_refs);
+    writer.addSection(modifications);
+    writer.addSection(transitions);
+    writer.addSection(precursor_mz_order);
+    writer.commit();
+  }
+
+  bool TransitionBinaryFile::isUpToDate(const String& filename, const String& source_file, const String& fingerprint)
+  {
+    return Internal::MappedIndexFile::isUpToDate(binary_library_format, filename, source_file, fingerprint);
+  }
+
+  void TransitionBinaryFile::open(const String& filename)
+  {
+    close();
+    file_.open(filename);
+    try
+    {
+      Size nr_order = 0;
+      proteins_ = file_.getSection<ProteinRecord>(PROTEINS, nr_proteins_);
+      compounds_ = file_.getSection<CompoundRecord>(COMPOUNDS, nr_compounds_);
+      protein_refs_ = file_.getSection<StringIndex>(PROTEIN_REFS, nr_protein_refs_);
+      modifications_ = file_.getSection<OpenSwath::LightModification>(MODIFICATIONS, nr_modifications_);
+      transitions_ = file_.getSection<TransitionRecord>(TRANSITIONS, nr_transitions_);
+      precursor_mz_order_ = file_.getSection<UInt32>(PRECURSOR_MZ_ORDER, nr_order);
+      if (nr_order != nr_transitions_)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Binary assay library is truncated or corrupt.");
+      }
+    }
+    catch (...)
+    {
+      close();
+      throw;
+    }
+  }
+
+  bool TransitionBinaryFile::isOpen() const
+  {
+    return file_.isOpen();
+  }
+
+  void TransitionBinaryFile::close()
+  {
+    file_.close();
+    proteins_ = nullptr;
+    compounds_ = nullptr;
+    protein_refs_ = nullptr;
+    modifications_ = nullptr;
+    transitions_ = nullptr;
+    precursor_mz_order_ = nullptr;
+    nr_proteins_ = nr_compounds_ = nr_protein_refs_ = nr_modifications_ = nr_transitions_ = 0;
+  }
+
+  void TransitionBinaryFile::toLightTargetedExperiment(OpenSwath::LightTargetedExperiment& exp) const
+  {
+    exp = OpenSwath::LightTargetedExperiment();
+
+    exp.proteins.resize(nr_proteins_);
+    exp.compounds.resize(nr_compounds_);
+    exp.transitions.resize(nr_transitions_);
+
+#pragma omp parallel
+    {
+#pragma omp for schedule(static) nowait
+      for (SignedSize i = 0; i < (SignedSize)nr_proteins_; ++i)
+      {
+        const ProteinRecord& r = proteins_[i];
+        exp.proteins[i].id = getString(r.id);
+        exp.proteins[i].sequence = getString(r.sequence);
+      }
+
+#pragma omp for schedule(static) nowait
+      for (SignedSize i = 0; i < (SignedSize)nr_compounds_; ++i)
+      {
+        const CompoundRecord& r = compounds_[i];
+        OpenSwath::LightCompound& c = exp.compounds[i];
+        c.rt = r.rt;
+        c.drift_time = r.drift_time;
+        c.charge = r.charge;
+        c.id = getString(r.id);
+        c.sequence = getString(r.sequence);
+        c.peptide_group_label = getString(r.peptide_group_label);
+        c.gene_name = getString(r.gene_name);
+        c.sum_formula = getString(r.sum_formula);
+        c.compound_name = getString(r.compound_name);
+        c.protein_refs.reserve(r.nr_protein_refs);
+        for (UInt32 k = 0; k < r.nr_protein_refs; ++k)
+        {
+          c.protein_refs.emplace_back(getString(protein_refs_[r.first_protein_ref + k]));
+        }
+        c.modifications.assign(modifications_ + r.first_modification, modifications_ + r.first_modification + r.nr_modifications);
+      }
+
+#pragma omp for schedule(static)
+      for (SignedSize i = 0; i < (SignedSize)nr_transitions_; ++i)
+      {
+        const TransitionRecord& r = transitions_[i];
+        OpenSwath::LightTransition& t = exp.transitions[i];
+        t.transition_name = getString(r.transition_name);
+        t.peptide_ref = getString(r.peptide_ref);
+        t.library_intensity = r.library_intensity;
+        t.product_mz = r.product_mz;
+        t.precursor_mz = r.precursor_mz;
+        t.precursor_im = r.precursor_im;
+        t.fragment_charge = r.fragment_charge;
+        t.decoy = (r.flags & FLAG_DECOY) != 0;
+        t.detecting_transition = (r.flags & FLAG_DETECTING) != 0;
+        t.quantifying_transition = (r.flags & FLAG_QUANTIFYING) != 0;
+        t.identifying_transition = (r.flags & FLAG_IDENTIFYING) != 0;
+      }
+    }
+  }
+
+  void TransitionBinaryFile::load(const String& filename, OpenSwath::LightTargetedExperiment& exp)
+  {
+    open(filename);
+    toLightTargetedExperiment(exp);
+  }
+
+  Size TransitionBinaryFile::getNrStrings() const
+  {
+    return file_.getNrStrings();
+  }
+
+  Size TransitionBinaryFile::getNrTransitions() const
+  {
+    return nr_transitions_;
+  }
+
+  Size TransitionBinaryFile::getNrCompounds() const
+  {
+    return nr_compounds_;
+  }
+
+  Size TransitionBinaryFile::getNrProteins() const
+  {
+    return nr_proteins_;
+  }
+
+  std::string_view TransitionBinaryFile::getString(StringIndex index) const
+  {
+    return file_.getString(index);
+  }
+
+  const TransitionBinaryFile::TransitionRecord& TransitionBinaryFile::getTransition(Size index) const
+  {
+    OPENMS_PRECONDITION(index < nr_transitions_, "Transition index out of range")
+    return transitions_[index];
+  }
+
+  const TransitionBinaryFile::CompoundRecord& TransitionBinaryFile::getCompound(Size index) const
+  {
+    OPENMS_PRECONDITION(index < nr_compounds_, "Compound index out of range")
+    return compounds_[index];
+  }
+
+  const TransitionBinaryFile::ProteinRecord& TransitionBinaryFile::getProtein(Size index) const
+  {
+    OPENMS_PRECONDITION(index < nr_proteins_, "Protein index out of range")
+    return proteins_[index];
+  }
+
+  TransitionBinaryFile::StringIndex TransitionBinaryFile::getProteinRef(Size index) const
+  {
+    OPENMS_PRECONDITION(index < nr_protein_refs_, "Protein reference index out of range")
+    return protein_refs_[index];
+  }
+
+  const OpenSwath::LightModification& TransitionBinaryFile::getModification(Size index) const
+  {
+    OPENMS_PRECONDITION(index < nr_modifications_, "Modification index out of range")
+    return modifications_[index];
+  }
+
+  const UInt32* TransitionBinaryFile::getPrecursorMZOrder() const
+  {
+    return precursor_mz_order_;
+  }
+
+  std::pair<Size, Size> TransitionBinaryFile::getPrecursorMZRange(double mz_start, double mz_end) const
+  {
+    const UInt32* begin = precursor_mz_order_;
+    const UInt32* end = precursor_mz_order_ + nr_transitions_;
+    const UInt32* first = std::partition_point(begin, end, [this, mz_start](UInt32 i) { return transitions_[i].precursor_mz < mz_start; });
+    const UInt32* last = std::partition_point(first, end, [this, mz_end](UInt32 i) { return transitions_[i].precursor_mz < mz_end; });
+    return {Size(first - begin), Size(last - begin)};
+  }
+
+}
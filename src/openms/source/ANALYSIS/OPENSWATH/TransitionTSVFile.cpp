@@ -12,78 +12,248 @@
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/CHEMISTRY/ResidueDB.h>
 #include <OpenMS/CONCEPT/LogStream.h>
-#include <OpenMS/FORMAT/TextFile.h>
+#include <OpenMS/SYSTEM/File.h>
 
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <exception>
+#include <filesystem>
+#include <iterator>
+#include <sstream>
+#include <unordered_set>
 #include <utility>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
 
-  template<class T>   // primary template
-  bool extractName(T& value, const std::string& header_name,
-                   const std::vector<std::string>& tmp_line,
-                   const std::map<std::string, int>& header_dict)
+  namespace
   {
-    auto tmp = header_dict.find( header_name );
-    if (tmp != header_dict.end())
-    {
-      value = tmp_line[ tmp->second ];
-      // perform cleanup
-      value = value.remove('"');
-      value = value.remove('\'');
-      value = value.remove(',');
+    /// Extracts a string field, removing quotes and commas
+    bool extractField(String& value, std::string_view field)
+    {
+      value.clear();
+      value.reserve(field.size());
+      for (char c : field)
+      {
+        if (c != '"' && c != '\'' && c != ',')
+        {
+          value.push_back(c);
+        }
+      }
       return true;
     }
-    return false;
-  }
 
-  template<>   // specialization for int
-  bool extractName<int>(int& value, const std::string& header_name,
-                        const std::vector<std::string>& tmp_line,
-                        const std::map<std::string, int>& header_dict)
-  {
-    auto tmp = header_dict.find( header_name );
-    if (tmp != header_dict.end() && !String(tmp_line[ tmp->second ]).empty())
+    /// Extracts an integer field, returns false if the field is empty
+    bool extractField(int& value, std::string_view field)
     {
-      value = String(tmp_line[ tmp->second ]).toInt();
+      if (field.empty())
+      {
+        return false;
+      }
+      value = String(field).toInt();
       return true;
     }
-    return false;
-  }
 
-  template<>   // specialization for double
-  bool extractName<double>(double& value, const std::string& header_name,
-                        const std::vector<std::string>& tmp_line,
-                        const std::map<std::string, int>& header_dict)
-  {
-    auto tmp = header_dict.find(header_name);
-    if (tmp != header_dict.end() && !String(tmp_line[ tmp->second ]).empty())
+    /// Extracts a floating point field, returns false if the field is empty
+    bool extractField(double& value, std::string_view field)
     {
-      value = String(tmp_line[ tmp->second ]).toDouble();
+      if (field.empty())
+      {
+        return false;
+      }
+      value = String(field).toDouble();
       return true;
     }
-    return false;
-  }
 
-  template<>   // specialization for bool
-  bool extractName<bool>(bool& value, const std::string& header_name,
-                        const std::vector<std::string>& tmp_line,
-                        const std::map<std::string, int>& header_dict)
-  {
-    auto tmp = header_dict.find( header_name );
-    if (tmp != header_dict.end() && !String(tmp_line[ tmp->second ]).empty())
+    /// Extracts a boolean field ("0", "1", "true" or "false"), returns false if the field is empty or invalid
+    bool extractField(bool& value, std::string_view field)
     {
-      OpenMS::String str_value = tmp_line[ tmp->second ];
-      if (str_value == "1" || str_value.toUpper() == "TRUE") value = true;
-      else if (str_value == "0" || str_value.toUpper() == "FALSE") value = false;
+      if (field.empty())
+      {
+        return false;
+      }
+      String str_value(field);
+      str_value.toUpper();
+      if (str_value == "1" || str_value == "TRUE") value = true;
+      else if (str_value == "0" || str_value == "FALSE") value = false;
       else return false;
 
       // all went well, we set the value and can return
       return true;
     }
-    return false;
+
+    /// Extracts the first field in @p columns (a list of synonyms, in order of preference) that can be interpreted
+    template<class T>
+    bool extractName(T& value, const std::vector<Size>& columns, const std::vector<std::string_view>& tmp_line)
+    {
+      for (Size column : columns)
+      {
+        if (extractField(value, tmp_line[column]))
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /// Returns the start of the line following the one that contains @p pos (handles '\n', '\r\n' and '\r' line endings)
+    const char* nextLineStart(const char* pos, const char* end)
+    {
+      while (pos < end && *pos != '\n' && *pos != '\r')
+      {
+        ++pos;
+      }
+      if (pos < end)
+      {
+        if (*pos == '\r' && pos + 1 < end && pos[1] == '\n')
+        {
+          ++pos;
+        }
+        ++pos;
+      }
+      return pos;
+    }
+
+    /// Returns the end of the line starting at @p pos (excluding the line ending)
+    const char* lineEnd(const char* pos, const char* end)
+    {
+      while (pos < end && *pos != '\n' && *pos != '\r')
+      {
+        ++pos;
+      }
+      return pos;
+    }
+
+    /// Splits @p line at @p delimiter (an empty last column is kept)
+    void splitLine(std::string_view line, char delimiter, std::vector<std::string_view>& fields)
+    {
+      fields.clear();
+      Size start = 0;
+      for (Size pos = line.find(delimiter); pos != std::string_view::npos; pos = line.find(delimiter, start))
+      {
+        fields.push_back(line.substr(start, pos - start));
+        start = pos + 1;
+      }
+      fields.push_back(line.substr(start));
+    }
+  }
+
+  struct TransitionTSVFile::TSVColumns
+  {
+    typedef std::vector<Size> Columns;
+
+    explicit TSVColumns(const std::map<std::string, int>& header_dict);
+
+    Size nr_columns;
+
+    Columns precursor_mz;
+    Columns product_mz;
+    Columns library_intensity;
+    Columns rt;
+    Columns spectrast_rt;
+    Columns precursor_charge;
+    Columns fragment_type;
+    Columns fragment_charge;
+    Columns fragment_nr;
+    Columns drift_time;
+    Columns fragment_mzdelta;
+    Columns fragment_modification;
+    Columns gene_name;
+    Columns protein_name;
+    Columns peptide_group_label;
+    Columns label_type;
+    Columns peptide_sequence;
+    Columns full_peptide_name;
+    Columns detecting_transition;
+    Columns identifying_transition;
+    Columns quantifying_transition;
+    Columns peptidoforms;
+    Columns compound_name;
+    Columns sum_formula;
+    Columns smiles;
+    Columns adducts;
+    Columns annotation;
+    Columns uniprot_id;
+    Columns ce;
+    Columns decoy;
+    Columns spectrast_annotation;
+    Columns spectrast_full_peptide_name;
+    Columns transition_name;
+    Columns group_id;
+  };
+
+  TransitionTSVFile::TSVColumns::TSVColumns(const std::map<std::string, int>& header_dict) :
+    nr_columns(header_dict.size())
+  {
+    // all synonyms of a field which are present in the header, in order of preference
+    auto find = [&header_dict](std::initializer_list<const char*> names)
+    {
+      Columns columns;
+      for (const char* name : names)
+      {
+        auto it = header_dict.find(name);
+        if (it != header_dict.end())
+        {
+          columns.push_back(it->second);
+        }
+      }
+      return columns;
+    };
+
+    precursor_mz = find({"PrecursorMz"});
+    product_mz = find({"ProductMz", "FragmentMz"}); // Spectronaut
+    library_intensity = find({"LibraryIntensity", "RelativeIntensity", "RelativeFragmentIntensity"}); // Spectronaut
+    rt = find({"RetentionTimeCalculatorScore", // Skyline
+               "iRT", // Spectronaut
+               "NormalizedRetentionTime", "RetentionTime", "Tr_recalibrated"});
+    spectrast_rt = find({"SpectraSTRetentionTime"});
+    precursor_charge = find({"PrecursorCharge", "Charge"}); // charge is assumed to be the charge of the precursor
+    fragment_type = find({"FragmentType", "FragmentIonType"}); // Skyline
+    fragment_charge = find({"FragmentCharge", "ProductCharge"});
+    fragment_nr = find({"FragmentSeriesNumber", "FragmentNumber", "FragmentIonOrdinal"});
+    drift_time = find({"PrecursorIonMobility"});
+    fragment_mzdelta = find({"FragmentMzDelta"});
+    fragment_modification = find({"FragmentModification"});
+    gene_name = find({"GeneName"});
+    protein_name = find({"ProteinName", "ProteinId"}); // Spectronaut
+    peptide_group_label = find({"PeptideGroupLabel"});
+    label_type = find({"LabelType"});
+    peptide_sequence = find({"PeptideSequence",
+                             "Sequence", // Skyline
+                             "StrippedSequence"}); // Spectronaut
+    full_peptide_name = find({"FullUniModPeptideName", "FullPeptideName",
+                              "ModifiedSequence", // Spectronaut
+                              "ModifiedPeptideSequence"});
+    detecting_transition = find({"detecting_transition", "DetectingTransition"});
+    identifying_transition = find({"identifying_transition", "IdentifyingTransition"});
+    quantifying_transition = find({"quantifying_transition", "QuantifyingTransition",
+                                   "Quantitative"}); // Skyline
+    peptidoforms = find({"Peptidoforms"});
+    compound_name = find({"CompoundName"});
+    sum_formula = find({"SumFormula"});
+    smiles = find({"SMILES"});
+    adducts = find({"Adducts"});
+    annotation = find({"Annotation"});
+    uniprot_id = find({"UniprotId", "UniprotID"});
+    ce = find({"CE", "CollisionEnergy"});
+    decoy = find({"decoy", "Decoy", "IsDecoy"});
+    spectrast_annotation = find({"SpectraSTAnnotation"});
+    spectrast_full_peptide_name = find({"SpectraSTFullPeptideName"});
+    transition_name = find({"transition_name", "TransitionName", "TransitionId"});
+    group_id = find({"transition_group_id", "TransitionGroupId", "TransitionGroupName"});
   }
 
+  struct TransitionTSVFile::LightConversionState
+  {
+    std::unordered_set<String> compounds;
+    std::unordered_set<String> proteins;
+    std::unordered_map<String, String> label_sequences;
+  };
+
   TransitionTSVFile::TransitionTSVFile() :
     DefaultParamHandler("TransitionTSVFile")
   {
@@ -191,14 +361,34 @@ namespace OpenMS
 
   void TransitionTSVFile::readUnstructuredTSVInput_(const char* filename, FileTypes::Type filetype, std::vector<TSVTransition>& transition_list)
   {
-    std::ifstream data(filename);
-    std::string   line;
-    std::string   tmp;
+    readTSVInput_(filename, filetype, [&transition_list](std::vector<TSVTransition>& transitions)
+    {
+      transition_list.insert(transition_list.end(), std::make_move_iterator(transitions.begin()), std::make_move_iterator(transitions.end()));
+    });
+  }
+
+  void TransitionTSVFile::readTSVInput_(const char* filename, FileTypes::Type filetype, const std::function<void(std::vector<TSVTransition>&)>& consumer)
+  {
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+
+    // empty files cannot be mapped
+    boost::iostreams::mapped_file_source file;
+    const char* data_begin = nullptr;
+    const char* data_end = nullptr;
+    if (std::filesystem::file_size(filename) > 0)
+    {
+      file.open(filename);
+      data_begin = file.data();
+      data_end = data_begin + file.size();
+    }
 
     // read header
-    std::vector<std::string>   tmp_line;
     std::map<std::string, int> header_dict;
     char delimiter = ',';
+    const char* body_begin = data_begin;
 
     // SpectraST MRM Files do not have a header
     if (filetype == FileTypes::MRM)
@@ -222,247 +412,291 @@ namespace OpenMS
     // Read header for TSV input
     else
     {
-      TextFile::getLine(data, line);
+      std::string line(data_begin, lineEnd(data_begin, data_end));
+      body_begin = nextLineStart(data_begin, data_end);
       getTSVHeader_(line, delimiter, header_dict);
     }
+    const TSVColumns columns(header_dict);
 
-    bool spectrast_legacy = false; // we will check below if SpectraST was run in legacy (<5.0) mode or if the RT normalization was forgotten.
-    int cnt = 0;
-    while (TextFile::getLine(data, line)) // make sure line endings are handled correctly
-    {
-      line.push_back(delimiter); // avoid losing last column if it is empty
-      std::stringstream lineStream(line);
+    // The body is processed in batches of chunks: the chunks of a batch are
+    // parsed in parallel and then handed to the consumer in file order, which
+    // bounds the memory needed for the parsed (but not yet consumed) transitions.
+    const Size chunk_size = Size(1) << 22; // 4 MB
+    Size batch_size = 1;
+#ifdef _OPENMP
+    batch_size = 2 * omp_get_max_threads();
+#endif
 
-      while (std::getline(lineStream, tmp, delimiter)) // default getline is fine here, we only want to split the line
+    bool spectrast_legacy = false; // we will check below if SpectraST was run in legacy (<5.0) mode or if the RT normalization was forgotten.
+    int cnt = 0; // number of lines read so far
+    const char* batch_begin = body_begin;
+    startProgress(0, data_end - body_begin, "reading transition list");
+    while (batch_begin < data_end)
+    {
+      // split the batch into chunks which start at the beginning of a line
+      std::vector<const char*> chunk_bounds(1, batch_begin);
+      while (chunk_bounds.size() <= batch_size && chunk_bounds.back() < data_end)
       {
-        tmp_line.push_back(tmp);
+        const Size remaining = data_end - chunk_bounds.back();
+        chunk_bounds.push_back(remaining <= chunk_size ? data_end : nextLineStart(chunk_bounds.back() + chunk_size, data_end));
       }
-      cnt++;
+      const Size nr_chunks = chunk_bounds.size() - 1;
 
-#ifdef TRANSITIONTSVREADER_TESTING
-      for (Size i = 0; i < tmp_line.size(); i++)
+      // find the lines of each chunk (required to number them before parsing)
+      std::vector<std::vector<std::string_view> > chunk_lines(nr_chunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+      for (SignedSize c = 0; c < (SignedSize)nr_chunks; ++c)
       {
-        std::cout << "line " << i << " " << tmp_line[i] << std::endl;
+        const char* chunk_end = chunk_bounds[c + 1];
+        for (const char* pos = chunk_bounds[c]; pos < chunk_end; pos = nextLineStart(pos, chunk_end))
+        {
+          chunk_lines[c].emplace_back(pos, lineEnd(pos, chunk_end) - pos);
+        }
       }
 
-      for (const auto& iter : header_dict)
+      std::vector<int> first_line(nr_chunks);
+      for (Size c = 0; c < nr_chunks; ++c)
       {
-        std::cout << "header " << iter.first << " " << iter.second << std::endl;
+        first_line[c] = cnt;
+        cnt += (int)chunk_lines[c].size();
       }
-#endif
 
-      if (tmp_line.size() != header_dict.size())
+      // parse the chunks; the first error (in file order) is rethrown below
+      std::vector<std::vector<TSVTransition> > chunk_transitions(nr_chunks);
+      std::vector<std::exception_ptr> chunk_errors(nr_chunks);
+      std::vector<char> chunk_spectrast_legacy(nr_chunks, false);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (SignedSize c = 0; c < (SignedSize)nr_chunks; ++c)
       {
-        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-                                         "Error reading the file on line " + String(cnt) + ": length of the header and length of the line" +
-                                         " do not match: " + String(tmp_line.size()) + " != " + String(header_dict.size()));
+        try
+        {
+          std::vector<std::string_view> tmp_line;
+          bool legacy = false;
+          chunk_transitions[c].reserve(chunk_lines[c].size());
+          for (Size i = 0; i < chunk_lines[c].size(); ++i)
+          {
+            splitLine(chunk_lines[c][i], delimiter, tmp_line);
+            const int line_nr = first_line[c] + (int)i + 1;
+
+            if (tmp_line.size() != columns.nr_columns)
+            {
+              throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                               "Error reading the file on line " + String(line_nr) + ": length of the header and length of the line" +
+                                               " do not match: " + String(tmp_line.size()) + " != " + String(columns.nr_columns));
+            }
+
+            TSVTransition mytransition;
+            if (parseTSVRow_(columns, tmp_line, filetype, line_nr, mytransition, legacy))
+            {
+              chunk_transitions[c].push_back(std::move(mytransition));
+            }
+          }
+          chunk_spectrast_legacy[c] = legacy;
+        }
+        catch (...)
+        {
+          chunk_errors[c] = std::current_exception();
+        }
       }
 
-      TSVTransition mytransition;
-      bool skip_transition = false; // skip unannotated transitions in SpectraST MRM files
-
-      //// Required columns (they are guaranteed to be present, see getTSVHeader_)
-      // PrecursorMz
-      mytransition.precursor = String(tmp_line[header_dict["PrecursorMz"]]).toDouble();
-
-      // ProductMz
-      if (!extractName<double>(mytransition.product, "ProductMz", tmp_line, header_dict) &&
-          !extractName<double>(mytransition.product, "FragmentMz", tmp_line, header_dict)) // Spectronaut
+      for (Size c = 0; c < nr_chunks; ++c)
       {
-        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-                                         "Expected a header named ProductMz or FragmentMz but found none");
+        if (chunk_errors[c])
+        {
+          std::rethrow_exception(chunk_errors[c]);
+        }
       }
 
-      // LibraryIntensity
-      if (!extractName<double>(mytransition.library_intensity, "LibraryIntensity", tmp_line, header_dict) &&
-          !extractName<double>(mytransition.library_intensity, "RelativeIntensity", tmp_line, header_dict) && // Spectronaut
-          !extractName<double>(mytransition.library_intensity, "RelativeFragmentIntensity", tmp_line, header_dict)) // Spectronaut
+      for (Size c = 0; c < nr_chunks; ++c)
       {
-        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-                                         "Expected a header named LibraryIntensity or RelativeFragmentIntensity but found none");
+        spectrast_legacy = spectrast_legacy || chunk_spectrast_legacy[c];
+        consumer(chunk_transitions[c]);
+        std::vector<TSVTransition>().swap(chunk_transitions[c]);
       }
 
-      //// Additional columns for both proteomics and metabolomics
-      // NormalizedRetentionTime
-      if (!extractName<double>(mytransition.rt_calibrated, "RetentionTimeCalculatorScore", tmp_line, header_dict) && // Skyline
-          !extractName<double>(mytransition.rt_calibrated, "iRT", tmp_line, header_dict) && // Spectronaut
-          !extractName<double>(mytransition.rt_calibrated, "NormalizedRetentionTime", tmp_line, header_dict) &&
-          !extractName<double>(mytransition.rt_calibrated, "RetentionTime", tmp_line, header_dict) &&
-          !extractName<double>(mytransition.rt_calibrated, "Tr_recalibrated", tmp_line, header_dict))
-      {
-        if (header_dict.find("SpectraSTRetentionTime") != header_dict.end())
-        {
-          spectrastRTExtract(tmp_line[header_dict["SpectraSTRetentionTime"]], mytransition.rt_calibrated, spectrast_legacy);
-        }
-        else
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-                                           "Expected a header named RetentionTime, NormalizedRetentionTime, iRT, RetentionTimeCalculatorScore, Tr_recalibrated or SpectraSTRetentionTime but found none");
-        }
-      }
+      batch_begin = chunk_bounds.back();
+      setProgress(batch_begin - body_begin);
+    }
+    endProgress();
 
-      // PrecursorCharge
-      void(!extractName(mytransition.precursor_charge, "PrecursorCharge", tmp_line, header_dict) &&
-      !extractName(mytransition.precursor_charge, "Charge", tmp_line, header_dict)); // charge is assumed to be the charge of the precursor
+    if (spectrast_legacy && retentionTimeInterpretation_ == "iRT")
+    {
+      std::cout << "Warning: SpectraST was not run in RT normalization mode but the converted list was interpreted to have iRT units. Check whether you need to adapt the parameter -algorithm:retentionTimeInterpretation. You can ignore this warning if you used a legacy SpectraST 4.0 file." << std::endl;
 
-      void(!extractName(mytransition.fragment_type, "FragmentType", tmp_line, header_dict) &&
-      !extractName(mytransition.fragment_type, "FragmentIonType", tmp_line, header_dict)); // Skyline
+    }
+  }
 
-      void(!extractName(mytransition.fragment_charge, "FragmentCharge", tmp_line, header_dict) &&
-      !extractName(mytransition.fragment_charge, "ProductCharge", tmp_line, header_dict));
+  bool TransitionTSVFile::parseTSVRow_(const TSVColumns& columns, const std::vector<std::string_view>& tmp_line, FileTypes::Type filetype,
+                                       int line_nr, TSVTransition& mytransition, bool& spectrast_legacy)
+  {
+#ifdef TRANSITIONTSVREADER_TESTING
+    for (Size i = 0; i < tmp_line.size(); i++)
+    {
+      std::cout << "line " << i << " " << tmp_line[i] << std::endl;
+    }
+#endif
 
-      void(!extractName<int>(mytransition.fragment_nr, "FragmentSeriesNumber", tmp_line, header_dict) &&
-      !extractName<int>(mytransition.fragment_nr, "FragmentNumber", tmp_line, header_dict) &&
-      !extractName<int>(mytransition.fragment_nr, "FragmentIonOrdinal", tmp_line, header_dict));
+    bool skip_transition = false; // skip unannotated transitions in SpectraST MRM files
 
-      void(extractName<double>(mytransition.drift_time, "PrecursorIonMobility", tmp_line, header_dict));
-      void(extractName<double>(mytransition.fragment_mzdelta, "FragmentMzDelta", tmp_line, header_dict));
-      void(extractName<int>(mytransition.fragment_modification, "FragmentModification", tmp_line, header_dict));
+    //// Required columns
+    // PrecursorMz
+    if (columns.precursor_mz.empty())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                       "Expected a header named PrecursorMz but found none");
+    }
+    mytransition.precursor = String(tmp_line[columns.precursor_mz[0]]).toDouble();
 
-      //// Proteomics
-      extractName(mytransition.GeneName, "GeneName", tmp_line, header_dict);
+    // ProductMz
+    if (!extractName(mytransition.product, columns.product_mz, tmp_line))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                       "Expected a header named ProductMz or FragmentMz but found none");
+    }
 
-      String proteins;
-      void(!extractName(proteins, "ProteinName", tmp_line, header_dict) &&
-      !extractName(proteins, "ProteinId", tmp_line, header_dict)); // Spectronaut
-      if (proteins != "NA" && !proteins.empty())
+    // LibraryIntensity
+    if (!extractName(mytransition.library_intensity, columns.library_intensity, tmp_line))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                       "Expected a header named LibraryIntensity or RelativeFragmentIntensity but found none");
+    }
+
+    //// Additional columns for both proteomics and metabolomics
+    // NormalizedRetentionTime
+    if (!extractName(mytransition.rt_calibrated, columns.rt, tmp_line))
+    {
+      if (!columns.spectrast_rt.empty())
       {
-        proteins.split(';', mytransition.ProteinName);
+        spectrastRTExtract(String(tmp_line[columns.spectrast_rt[0]]), mytransition.rt_calibrated, spectrast_legacy);
       }
+      else
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                         "Expected a header named RetentionTime, NormalizedRetentionTime, iRT, RetentionTimeCalculatorScore, Tr_recalibrated or SpectraSTRetentionTime but found none");
+      }
+    }
 
-      void(extractName(mytransition.peptide_group_label, "PeptideGroupLabel", tmp_line, header_dict));
-
-      void(extractName(mytransition.label_type, "LabelType", tmp_line, header_dict));
+    extractName(mytransition.precursor_charge, columns.precursor_charge, tmp_line);
+    extractName(mytransition.fragment_type, columns.fragment_type, tmp_line);
+    extractName(mytransition.fragment_charge, columns.fragment_charge, tmp_line);
+    extractName(mytransition.fragment_nr, columns.fragment_nr, tmp_line);
+    extractName(mytransition.drift_time, columns.drift_time, tmp_line);
+    extractName(mytransition.fragment_mzdelta, columns.fragment_mzdelta, tmp_line);
+    extractName(mytransition.fragment_modification, columns.fragment_modification, tmp_line);
 
-      void(!extractName(mytransition.PeptideSequence, "PeptideSequence", tmp_line, header_dict) &&
-      !extractName(mytransition.PeptideSequence, "Sequence", tmp_line, header_dict) && // Skyline
-      !extractName(mytransition.PeptideSequence, "StrippedSequence", tmp_line, header_dict)); // Spectronaut
+    //// Proteomics
+    extractName(mytransition.GeneName, columns.gene_name, tmp_line);
 
-      void(!extractName(mytransition.FullPeptideName, "FullUniModPeptideName", tmp_line, header_dict) &&
-      !extractName(mytransition.FullPeptideName, "FullPeptideName", tmp_line, header_dict) &&
-      !extractName(mytransition.FullPeptideName, "ModifiedSequence", tmp_line, header_dict) && // Spectronaut
-      !extractName(mytransition.FullPeptideName, "ModifiedPeptideSequence", tmp_line, header_dict));
+    String proteins;
+    extractName(proteins, columns.protein_name, tmp_line);
+    if (proteins != "NA" && !proteins.empty())
+    {
+      proteins.split(';', mytransition.ProteinName);
+    }
 
-      //// IPF
-      String peptidoforms;
-      void(!extractName<bool>(mytransition.detecting_transition, "detecting_transition", tmp_line, header_dict) &&
-      !extractName<bool>(mytransition.detecting_transition, "DetectingTransition", tmp_line, header_dict));
+    extractName(mytransition.peptide_group_label, columns.peptide_group_label, tmp_line);
+    extractName(mytransition.label_type, columns.label_type, tmp_line);
+    extractName(mytransition.PeptideSequence, columns.peptide_sequence, tmp_line);
+    extractName(mytransition.FullPeptideName, columns.full_peptide_name, tmp_line);
 
-      void(!extractName<bool>(mytransition.identifying_transition, "identifying_transition", tmp_line, header_dict) &&
-      !extractName<bool>(mytransition.identifying_transition, "IdentifyingTransition", tmp_line, header_dict));
+    //// IPF
+    extractName(mytransition.detecting_transition, columns.detecting_transition, tmp_line);
+    extractName(mytransition.identifying_transition, columns.identifying_transition, tmp_line);
+    extractName(mytransition.quantifying_transition, columns.quantifying_transition, tmp_line);
 
-      void(!extractName<bool>(mytransition.quantifying_transition, "quantifying_transition", tmp_line, header_dict) &&
-      !extractName<bool>(mytransition.quantifying_transition, "QuantifyingTransition", tmp_line, header_dict) &&
-      !extractName<bool>(mytransition.quantifying_transition, "Quantitative", tmp_line, header_dict)); // Skyline
+    String peptidoforms;
+    extractName(peptidoforms, columns.peptidoforms, tmp_line);
+    peptidoforms.split('|', mytransition.peptidoforms);
 
-      void(extractName(peptidoforms, "Peptidoforms", tmp_line, header_dict));
-      peptidoforms.split('|', mytransition.peptidoforms);
+    //// Targeted Metabolomics
+    extractName(mytransition.CompoundName, columns.compound_name, tmp_line);
+    extractName(mytransition.SumFormula, columns.sum_formula, tmp_line);
+    extractName(mytransition.SMILES, columns.smiles, tmp_line);
+    extractName(mytransition.Adducts, columns.adducts, tmp_line);
 
-      //// Targeted Metabolomics
-      void(extractName(mytransition.CompoundName, "CompoundName", tmp_line, header_dict));
-      void(extractName(mytransition.SumFormula, "SumFormula", tmp_line, header_dict));
-      void(extractName(mytransition.SMILES, "SMILES", tmp_line, header_dict));
-      void(extractName(mytransition.Adducts, "Adducts", tmp_line, header_dict));
+    //// Meta
+    extractName(mytransition.Annotation, columns.annotation, tmp_line);
 
-      //// Meta
-      void(extractName(mytransition.Annotation, "Annotation", tmp_line, header_dict));
-      
-      // UniprotId
-      String uniprot_ids;
-      void(!extractName(uniprot_ids, "UniprotId", tmp_line, header_dict) &&
-      !extractName(uniprot_ids, "UniprotID", tmp_line, header_dict));
-      if (uniprot_ids != "NA" && !uniprot_ids.empty())
-      {
-        uniprot_ids.split(';', mytransition.uniprot_id);
-      }
+    // UniprotId
+    String uniprot_ids;
+    extractName(uniprot_ids, columns.uniprot_id, tmp_line);
+    if (uniprot_ids != "NA" && !uniprot_ids.empty())
+    {
+      uniprot_ids.split(';', mytransition.uniprot_id);
+    }
 
-      void(!extractName<double>(mytransition.CE, "CE", tmp_line, header_dict) &&
-      !extractName<double>(mytransition.CE, "CollisionEnergy", tmp_line, header_dict));
+    extractName(mytransition.CE, columns.ce, tmp_line);
 
-      // Decoy
-      void(!extractName<bool>(mytransition.decoy, "decoy", tmp_line, header_dict) &&
-      !extractName<bool>(mytransition.decoy, "Decoy", tmp_line, header_dict) &&
-      !extractName<bool>(mytransition.decoy, "IsDecoy", tmp_line, header_dict));
+    // Decoy
+    extractName(mytransition.decoy, columns.decoy, tmp_line);
 
-      if (header_dict.find("SpectraSTAnnotation") != header_dict.end())
-      {
-        skip_transition = spectrastAnnotationExtract(tmp_line[header_dict["SpectraSTAnnotation"]], mytransition);
-      }
+    if (!columns.spectrast_annotation.empty())
+    {
+      skip_transition = spectrastAnnotationExtract(String(tmp_line[columns.spectrast_annotation[0]]), mytransition);
+    }
 
-      //// Generate Group IDs
-      // SpectraST
-      if (filetype == FileTypes::MRM)
-      {
-        std::vector<String> substrings;
-        String(tmp_line[header_dict["SpectraSTFullPeptideName"]]).split("/", substrings);
-        AASequence peptide = AASequence::fromString(substrings[0]);
+    //// Generate Group IDs
+    // SpectraST
+    if (filetype == FileTypes::MRM)
+    {
+      std::vector<String> substrings;
+      String(tmp_line[columns.spectrast_full_peptide_name[0]]).split("/", substrings);
+      AASequence peptide = AASequence::fromStringCached(substrings[0]);
 
-        mytransition.FullPeptideName = peptide.toString();
-        mytransition.PeptideSequence = peptide.toUnmodifiedString();
-        mytransition.precursor_charge = substrings[1];
+      mytransition.FullPeptideName = peptide.toString();
+      mytransition.PeptideSequence = peptide.toUnmodifiedString();
+      mytransition.precursor_charge = substrings[1];
 
-        mytransition.transition_name = String(cnt);
+      mytransition.transition_name = String(line_nr);
 
-        mytransition.group_id = mytransition.FullPeptideName + String("_") + String(mytransition.precursor_charge);
-      }
-      // Generate transition_group_id and transition_name if not defined
-      else
+      mytransition.group_id = mytransition.FullPeptideName + String("_") + String(mytransition.precursor_charge);
+    }
+    // Generate transition_group_id and transition_name if not defined
+    else
+    {
+      // Use TransitionId if available, else generate from attributes
+      if (!extractName(mytransition.transition_name, columns.transition_name, tmp_line))
       {
-        // Use TransitionId if available, else generate from attributes
-        if (!extractName(mytransition.transition_name, "transition_name", tmp_line, header_dict) &&
-            !extractName(mytransition.transition_name, "TransitionName", tmp_line, header_dict) &&
-            !extractName(mytransition.transition_name, "TransitionId", tmp_line, header_dict))
-        {
-          mytransition.transition_name = String(cnt);
-        }
-
-        // Use TransitionGroupId if available, else generate from attributes
-        if (!extractName(mytransition.group_id, "transition_group_id", tmp_line, header_dict) &&
-            !extractName(mytransition.group_id, "TransitionGroupId", tmp_line, header_dict) &&
-            !extractName(mytransition.group_id, "TransitionGroupName", tmp_line, header_dict))
-        {
-          mytransition.group_id = AASequence::fromString(mytransition.FullPeptideName).toString() + String("_") + String(mytransition.precursor_charge);
-        }
+        mytransition.transition_name = String(line_nr);
       }
 
-      cleanupTransitions_(mytransition);
-
-      if (!skip_transition)
+      // Use TransitionGroupId if available, else generate from attributes
+      if (!extractName(mytransition.group_id, columns.group_id, tmp_line))
       {
-        transition_list.push_back(mytransition);
+        mytransition.group_id = AASequence::fromStringCached(mytransition.FullPeptideName).toString() + String("_") + String(mytransition.precursor_charge);
       }
+    }
+
+    cleanupTransitions_(mytransition);
 
 #ifdef TRANSITIONTSVREADER_TESTING
-      std::cout << mytransition.precursor << std::endl;
-      std::cout << mytransition.product << std::endl;
-      std::cout << mytransition.rt_calibrated << std::endl;
-      std::cout << mytransition.transition_name << std::endl;
-      std::cout << mytransition.CE << std::endl;
-      std::cout << mytransition.library_intensity << std::endl;
-      std::cout << mytransition.group_id << std::endl;
-      std::cout << mytransition.decoy << std::endl;
-      std::cout << mytransition.PeptideSequence << std::endl;
-      std::cout << mytransition.ProteinName << std::endl;
-      std::cout << mytransition.Annotation << std::endl;
-      std::cout << mytransition.FullPeptideName << std::endl;
-      std::cout << mytransition.precursor_charge << std::endl;
-      std::cout << mytransition.peptide_group_label << std::endl;
-      std::cout << mytransition.fragment_charge << std::endl;
-      std::cout << mytransition.fragment_nr << std::endl;
-      std::cout << mytransition.fragment_mzdelta << std::endl;
-      std::cout << mytransition.fragment_modification << std::endl;
-      std::cout << mytransition.fragment_type << std::endl;
-      std::cout << mytransition.uniprot_id << std::endl;
+    std::cout << mytransition.precursor << std::endl;
+    std::cout << mytransition.product << std::endl;
+    std::cout << mytransition.rt_calibrated << std::endl;
+    std::cout << mytransition.transition_name << std::endl;
+    std::cout << mytransition.CE << std::endl;
+    std::cout << mytransition.library_intensity << std::endl;
+    std::cout << mytransition.group_id << std::endl;
+    std::cout << mytransition.decoy << std::endl;
+    std::cout << mytransition.PeptideSequence << std::endl;
+    std::cout << mytransition.ProteinName << std::endl;
+    std::cout << mytransition.Annotation << std::endl;
+    std::cout << mytransition.FullPeptideName << std::endl;
+    std::cout << mytransition.precursor_charge << std::endl;
+    std::cout << mytransition.peptide_group_label << std::endl;
+    std::cout << mytransition.fragment_charge << std::endl;
+    std::cout << mytransition.fragment_nr << std::endl;
+    std::cout << mytransition.fragment_mzdelta << std::endl;
+    std::cout << mytransition.fragment_modification << std::endl;
+    std::cout << mytransition.fragment_type << std::endl;
+    std::cout << mytransition.uniprot_id << std::endl;
 #endif
 
-      tmp_line.clear();
-    }
-
-    if (spectrast_legacy && retentionTimeInterpretation_ == "iRT")
-    {
-      std::cout << "Warning: SpectraST was not run in RT normalization mode but the converted list was interpreted to have iRT units. Check whether you need to adapt the parameter -algorithm:retentionTimeInterpretation. You can ignore this warning if you used a legacy SpectraST 4.0 file." << std::endl;
-
-    }
+    return !skip_transition;
   }
 
   void TransitionTSVFile::spectrastRTExtract(const String& str_inp, double & value, bool & spectrast_legacy)
@@ -648,37 +882,24 @@ namespace OpenMS
 
   void TransitionTSVFile::TSVToTargetedExperiment_(std::vector<TSVTransition>& transition_list, OpenSwath::LightTargetedExperiment& exp)
   {
-    std::map<String, int> compound_map;
-    std::map<String, int> protein_map;
-
-    resolveMixedSequenceGroups_(transition_list);
+    LightConversionState state;
+    exp.transitions.reserve(exp.transitions.size() + transition_list.size());
 
-    Size progress = 0;
     startProgress(0, transition_list.size(), "conversion to internal data representation");
-    for (auto tr_it = transition_list.cbegin(); tr_it != transition_list.cend(); ++tr_it)
-    {
-      OpenSwath::LightTransition transition;
-      transition.transition_name  = tr_it->transition_name;
-      transition.peptide_ref  = tr_it->group_id;
-      transition.library_intensity  = tr_it->library_intensity;
-      transition.precursor_mz  = tr_it->precursor;
-      transition.product_mz  = tr_it->product;
-      transition.precursor_im = tr_it->drift_time;
-      transition.fragment_charge = 0; // use zero for charge that is not set
-      if (!tr_it->fragment_charge.empty() && tr_it->fragment_charge != "NA")
-      {
-        transition.fragment_charge = tr_it->fragment_charge.toInt();
-      }
+    addToLightTargetedExperiment_(transition_list, state, exp);
+    endProgress();
 
-      transition.decoy = tr_it->decoy;
-      transition.detecting_transition = tr_it->detecting_transition;
-      transition.identifying_transition = tr_it->identifying_transition;
-      transition.quantifying_transition = tr_it->quantifying_transition;
+    OPENMS_POSTCONDITION(exp.transitions.size() == transition_list.size(), "Input and output list need to have equal size.")
+  }
 
-      exp.transitions.push_back(transition);
+  void TransitionTSVFile::addToLightTargetedExperiment_(std::vector<TSVTransition>& transitions, LightConversionState& state, OpenSwath::LightTargetedExperiment& exp)
+  {
+    for (auto tr_it = transitions.begin(); tr_it != transitions.end(); ++tr_it)
+    {
+      resolveMixedSequenceGroup_(*tr_it, state.label_sequences);
 
       // check whether we need a new compound
-      if (compound_map.find(tr_it->group_id) == compound_map.end())
+      if (state.compounds.find(tr_it->group_id) == state.compounds.end())
       {
         OpenSwath::LightCompound compound;
         if (tr_it->isPeptide())
@@ -693,76 +914,83 @@ namespace OpenMS
           createCompound_(tr_it, tramlcompound);
           OpenSwathDataAccessHelper::convertTargetedCompound(tramlcompound, compound);
         }
-        exp.compounds.push_back(compound);
-        compound_map[compound.id] = 0;
+        state.compounds.insert(compound.id);
+        exp.compounds.push_back(std::move(compound));
       }
 
       // check whether we need new proteins
       for (Size i = 0; i < tr_it->ProteinName.size(); ++i)
       {
-        if (tr_it->isPeptide() && protein_map.find(tr_it->ProteinName[i]) == protein_map.end())
+        if (tr_it->isPeptide() && state.proteins.find(tr_it->ProteinName[i]) == state.proteins.end())
         {
           OpenSwath::LightProtein protein;
           protein.id = tr_it->ProteinName[i];
           protein.sequence = "";
           exp.proteins.push_back(protein);
-          protein_map[tr_it->ProteinName[i]] = 0;
+          state.proteins.insert(tr_it->ProteinName[i]);
         }
       }
 
-      setProgress(progress++);
-    }
-    endProgress();
+      OpenSwath::LightTransition transition;
+      transition.transition_name = std::move(tr_it->transition_name);
+      transition.peptide_ref = std::move(tr_it->group_id);
+      transition.library_intensity = tr_it->library_intensity;
+      transition.precursor_mz = tr_it->precursor;
+      transition.product_mz = tr_it->product;
+      transition.precursor_im = tr_it->drift_time;
+      transition.fragment_charge = 0; // use zero for charge that is not set
+      if (!tr_it->fragment_charge.empty() && tr_it->fragment_charge != "NA")
+      {
+        transition.fragment_charge = tr_it->fragment_charge.toInt();
+      }
 
-    OPENMS_POSTCONDITION(exp.transitions.size() == transition_list.size(), "Input and output list need to have equal size.")
+      transition.decoy = tr_it->decoy;
+      transition.detecting_transition = tr_it->detecting_transition;
+      transition.identifying_transition = tr_it->identifying_transition;
+      transition.quantifying_transition = tr_it->quantifying_transition;
+
+      exp.transitions.push_back(std::move(transition));
+    }
   }
 
   void TransitionTSVFile::resolveMixedSequenceGroups_(std::vector<TransitionTSVFile::TSVTransition>& transition_list) const
   {
-    // Create temporary map by group label
-    std::map<String, std::vector<TSVTransition*> > label_transition_map;
-    for (auto & tr_it : transition_list)
+    std::unordered_map<String, String> label_sequences;
+    for (auto& tr : transition_list)
     {
-      if (!tr_it.peptide_group_label.empty())
-      {
-        label_transition_map[tr_it.peptide_group_label].push_back(&tr_it);
-      }
+      resolveMixedSequenceGroup_(tr, label_sequences);
     }
+  }
 
-    // Iterate through all the group labels and perform sanity check whether
-    // the peptide sequence is the same for all of them
-    for (auto & pep_it : label_transition_map)
+  void TransitionTSVFile::resolveMixedSequenceGroup_(TSVTransition& transition, std::unordered_map<String, String>& label_sequences) const
+  {
+    if (transition.peptide_group_label.empty())
     {
-      String curr_sequence;
-      if (!pep_it.second.empty())
-      { 
-        curr_sequence = (*pep_it.second.begin())->PeptideSequence;
-      }
+      return;
+    }
+
+    // the first transition of a peptide label group determines its sequence
+    const String& curr_sequence = label_sequences.emplace(transition.peptide_group_label, transition.PeptideSequence).first->second;
 
-      for (auto & tr_it : pep_it.second)
+    // Sanity check: different peptide sequence in the same peptide label
+    // group means that something is probably wrong ...
+    if (!curr_sequence.empty() && transition.PeptideSequence != curr_sequence)
+    {
+      if (override_group_label_check_)
       {
-        // Sanity check: different peptide sequence in the same peptide label
-        // group means that something is probably wrong ...
-        if (!curr_sequence.empty() && tr_it->PeptideSequence != curr_sequence)
-        {
-          if (override_group_label_check_)
-          {
-            // We wont fix it but give out a warning
-            OPENMS_LOG_WARN << "Warning: Found multiple peptide sequences for peptide label group " << pep_it.first << 
-              ". Since 'override_group_label_check' is on, nothing will be changed." << std::endl;
-          }
-          else
-          {
-            // Lets fix it and inform the user
-            OPENMS_LOG_WARN << "Warning: Found multiple peptide sequences for peptide label group " << pep_it.first << 
-              ". This is most likely an error and to fix this, a new peptide label group will be inferred - " << 
-              "to override this decision, please use the override_group_label_check parameter." << std::endl;
-            tr_it->peptide_group_label = tr_it->group_id;
-          }
-        }
+        // We wont fix it but give out a warning
+        OPENMS_LOG_WARN << "Warning: Found multiple peptide sequences for peptide label group " << transition.peptide_group_label <<
+          ". Since 'override_group_label_check' is on, nothing will be changed." << std::endl;
+      }
+      else
+      {
+        // Lets fix it and inform the user
+        OPENMS_LOG_WARN << "Warning: Found multiple peptide sequences for peptide label group " << transition.peptide_group_label <<
+          ". This is most likely an error and to fix this, a new peptide label group will be inferred - " <<
+          "to override this decision, please use the override_group_label_check parameter." << std::endl;
+        transition.peptide_group_label = transition.group_id;
       }
     }
-
   }
 
   void TransitionTSVFile::createTransition_(std::vector<TSVTransition>::iterator& tr_it, OpenMS::ReactionMonitoringTransition& rm_trans)
@@ -1060,14 +1288,14 @@ namespace OpenMS
     if (sequence.empty()) sequence = tr_it->PeptideSequence;
     try
     {
-      aa_sequence = AASequence::fromString(sequence);
+      aa_sequence = AASequence::fromStringCached(sequence);
     } catch (Exception::InvalidValue & e)
     {
       if (force_invalid_mods_)
       {
         // fallback: parse the "naked" peptide sequence which should always work
         OPENMS_LOG_DEBUG << "Invalid sequence when parsing '" << tr_it->FullPeptideName << "'" << std::endl;
-        aa_sequence = AASequence::fromString(tr_it->PeptideSequence);
+        aa_sequence = AASequence::fromStringCached(tr_it->PeptideSequence);
       }
       else
       {
@@ -1479,9 +1707,12 @@ namespace OpenMS
 
   void TransitionTSVFile::convertTSVToTargetedExperiment(const char* filename, FileTypes::Type filetype, OpenSwath::LightTargetedExperiment& targeted_exp)
   {
-    std::vector<TSVTransition> transition_list;
-    readUnstructuredTSVInput_(filename, filetype, transition_list);
-    TSVToTargetedExperiment_(transition_list, targeted_exp);
+    // convert chunk by chunk instead of holding the full transition list in memory
+    LightConversionState state;
+    readTSVInput_(filename, filetype, [&](std::vector<TSVTransition>& transitions)
+    {
+      addToLightTargetedExperiment_(transitions, state, targeted_exp);
+    });
   }
 
   void TransitionTSVFile::validateTargetedExperiment(const OpenMS::TargetedExperiment& targeted_exp)
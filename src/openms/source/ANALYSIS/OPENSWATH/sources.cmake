@@ -37,6 +37,7 @@ set(sources_list
   SwathQC.cpp
   SpectrumAddition.cpp
   TargetedSpectraExtractor.cpp
+  TransitionBinaryFile.cpp
   TransitionTSVFile.cpp
   TransitionPQPFile.cpp
 )
@@ -17,6 +17,8 @@
 #include <OpenMS/KERNEL/ConsensusMap.h>
 #include <OpenMS/MATH/StatisticFunctions.h>
 
+#include <exception>
+
 // #define ISOBARIC_CHANNEL_EXTRACTOR_DEBUG
 // #undef ISOBARIC_CHANNEL_EXTRACTOR_DEBUG
 
@@ -42,6 +44,71 @@ namespace OpenMS
   };
 
 
+  /// the non-zero peak closest to the expected position of a reporter ion
+  struct ReporterPeak
+  {
+    bool found{false}; ///< a non-zero peak was found within the search window
+    bool not_unique{false}; ///< more than one non-zero peak within the allowed reporter mass shift
+    double mz_delta{0.0}; ///< expected minus observed m/z of the closest peak
+    Peak1D::IntensityType intensity{0}; ///< intensity of the closest peak
+  };
+
+  /**
+    @brief Finds the non-zero peak closest to @p center within +/- @p window in the (sorted) spectrum @p spec
+
+    Searches outwards from @p center instead of scanning the whole window; if several peaks are equally close,
+    the first one (lowest m/z) is used, i.e., the result is the one of a linear scan over the window.
+  */
+  ReporterPeak findReporterPeak(const MSSpectrum& spec, double center, double window, double reporter_mass_shift)
+  {
+    typedef MSSpectrum::ConstIterator PeakIt;
+    const PeakIt begin = spec.MZBegin(center - window);
+    const PeakIt end = spec.MZEnd(center + window);
+    const PeakIt mid = spec.MZBegin(begin, center, end);
+
+    // closest non-zero peak at or above the center (the distance can only grow to the right)
+    PeakIt right = mid;
+    while (right != end && right->getIntensity() == 0) ++right; // ignore 0-intensity shoulder peaks -- could be detrimental when de-calibrated
+
+    // closest non-zero peak below the center (the distance can only grow to the left; continue over equally close peaks)
+    PeakIt left = end;
+    for (PeakIt it = mid; it != begin; )
+    {
+      --it;
+      if (it->getIntensity() == 0) continue;
+      if (left != end && std::fabs(it->getMZ() - center) > std::fabs(left->getMZ() - center)) break;
+      left = it;
+    }
+
+    PeakIt nearest = left;
+    if (right != end && (nearest == end || std::fabs(right->getMZ() - center) < std::fabs(nearest->getMZ() - center)))
+    {
+      nearest = right;
+    }
+
+    ReporterPeak reporter;
+    if (nearest == end) return reporter;
+
+    reporter.found = true;
+    reporter.mz_delta = center - nearest->getMZ();
+    reporter.intensity = nearest->getIntensity();
+
+    // count peaks in user window -- should be only one, otherwise window is too large
+    int peak_count(0);
+    for (PeakIt it = mid; it != end && std::fabs(it->getMZ() - center) < reporter_mass_shift; ++it)
+    {
+      if (it->getIntensity() != 0) ++peak_count;
+    }
+    for (PeakIt it = mid; it != begin && peak_count <= 1; )
+    {
+      --it;
+      if (!(std::fabs(it->getMZ() - center) < reporter_mass_shift)) break;
+      if (it->getIntensity() != 0) ++peak_count;
+    }
+    reporter.not_unique = peak_count > 1;
+    return reporter;
+  }
+
   IsobaricChannelExtractor::PuritySate_::PuritySate_(const PeakMap& targetExp) :
     baseExperiment(targetExp)
   {
@@ -479,17 +546,17 @@ namespace OpenMS
     // --> assign peaks to channels
     UInt64 element_index(0);
 
-    // remember the current precursor spectrum
-    PuritySate_ pState(ms_exp_data);
-
     typedef std::map<String, ChannelQC > ChannelQCSet;
     ChannelQCSet channel_mz_delta;
     const double qc_dist_mz = 0.5; // fixed! Do not change!
 
     Size number_of_channels = quant_method_->getNumberOfChannels();
+    const IsobaricQuantitationMethod::IsobaricChannelList& channels = quant_method_->getChannelInformation();
 
-    PeakMap::ConstIterator it_last_MS2 = ms_exp_data.end(); // remember last MS2 spec, to get precursor in MS1 (also if quant is in MS3)
-    bool ms3 = false;
+    // first pass: select the spectra to quantify and remember their neighbouring MS1 scans (the state of the
+    // purity computation), so that the expensive parts (purity, reporter ions) can be computed in parallel
+    std::vector<std::pair<PeakMap::ConstIterator, PuritySate_> > quant_spectra;
+    PuritySate_ pState(ms_exp_data);
     for (PeakMap::ConstIterator it = ms_exp_data.begin(); it != ms_exp_data.end(); ++it)
     {
       // remember the last MS1 spectra as we assume it to be the precursor spectrum
@@ -497,8 +564,6 @@ namespace OpenMS
       {
         // remember potential precursor and continue
         pState.precursorScan = it;
-        // reset last MS2 -- we expect to see a new one soon and the old one should not be used for the following MS3 (if any)
-        it_last_MS2 = ms_exp_data.end();
         continue;
       }
 
@@ -512,153 +577,193 @@ namespace OpenMS
         // advance iterator
         pState.advanceFollowUp(it->getRT());
       }
+      quant_spectra.emplace_back(it, pState);
+    }
 
-      // check precursor constraints
-      if (!isValidPrecursor_(it->getPrecursors()[0]))
-      {
-        OPENMS_LOG_DEBUG << "Skip spectrum " << it->getNativeID() << ": Precursor doesn't fulfill all constraints." << std::endl;
-        continue;
-      }
-
-      // check precursor purity if we have a valid precursor ..
+    // results of the parallel pass for one spectrum
+    struct SpectrumResult
+    {
+      bool valid_precursor = false;
       double precursor_purity = -1.0;
-      if (pState.precursorScan != ms_exp_data.end())
+      std::exception_ptr purity_error;
+      std::vector<ReporterPeak> reporters;
+    };
+
+    // spectra are processed in blocks to limit the memory needed for intermediate results;
+    // features are built in the order of the spectra, so the result does not depend on the number of threads
+    const Size block_size = 4096;
+    std::vector<SpectrumResult> results;
+    bool ms3 = false;
+    for (Size block_start = 0; block_start < quant_spectra.size(); block_start += block_size)
+    {
+      const Size block_end = std::min(block_start + block_size, quant_spectra.size());
+      results.assign(block_end - block_start, SpectrumResult());
+
+#pragma omp parallel for schedule(dynamic, 16)
+      for (SignedSize i = SignedSize(block_start); i < SignedSize(block_end); ++i)
       {
-        precursor_purity = computePrecursorPurity_(it, pState);
-        // check if purity is high enough
-        if (precursor_purity < min_precursor_purity_)
+        const PeakMap::ConstIterator& it = quant_spectra[i].first;
+        const PuritySate_& spectrum_state = quant_spectra[i].second;
+        SpectrumResult& result = results[i - block_start];
+
+        result.valid_precursor = isValidPrecursor_(it->getPrecursors()[0]);
+        if (!result.valid_precursor) continue;
+
+        if (spectrum_state.precursorScan != ms_exp_data.end())
         {
-          OPENMS_LOG_DEBUG << "Skip spectrum " << it->getNativeID() << ": Precursor purity is below the threshold. [purity = " << precursor_purity << "]" << std::endl;
-          continue;
+          try
+          {
+            result.precursor_purity = computePrecursorPurity_(it, spectrum_state);
+          }
+          catch (...)
+          {
+            // exceptions can't leave the parallel region -- rethrown below, in the order of the spectra
+            result.purity_error = std::current_exception();
+            continue;
+          }
+          if (result.precursor_purity < min_precursor_purity_) continue;
         }
-      }
-      else
-      {
-        OPENMS_LOG_INFO << "No precursor available for spectrum: " << it->getNativeID() << std::endl;
-      }
-
-      if (it->getMSLevel() == 3)
-      {
-        ms3 = true;
-        // we cannot save just the last MS2 but need to compare to the precursor info stored in the (potential MS3 spectrum)
-        it_last_MS2 = ms_exp_data.getPrecursorSpectrum(it);
 
-        if (it_last_MS2 == ms_exp_data.end())
-        { // this only happens if an MS3 spec does not have a preceding MS2
-          throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("No MS2 precursor information given for MS3 scan native ID ") + it->getNativeID() + " with RT " + String(it->getRT()));
+        result.reporters.reserve(channels.size());
+        for (const IsobaricQuantitationMethod::IsobaricChannelInformation& channel : channels)
+        {
+          result.reporters.push_back(findReporterPeak(*it, channel.center, qc_dist_mz, reporter_mass_shift_));
         }
       }
-      else
-      {
-        it_last_MS2 = it;
-      }
 
-      // check if MS1 precursor info is available
-      if (it_last_MS2->getPrecursors().empty())
+      for (Size i = block_start; i < block_end; ++i)
       {
-        throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("No precursor information given for scan native ID ") + it->getNativeID() + " with RT " + String(it->getRT()));
-      }
+        const PeakMap::ConstIterator& it = quant_spectra[i].first;
+        const PeakMap::ConstIterator& precursor_scan = quant_spectra[i].second.precursorScan;
+        const SpectrumResult& result = results[i - block_start];
 
-      // store RT of MS2 scan and MZ of MS1 precursor ion as centroid of ConsensusFeature
-      ConsensusFeature cf;
-      cf.setUniqueId();
-      cf.setRT(it_last_MS2->getRT());
-      cf.setMZ(it_last_MS2->getPrecursors()[0].getMZ());
-
-      Peak2D channel_value;
-      channel_value.setRT(it->getRT());
-      // for each each channel
-      UInt64 map_index = 0;
-      Peak2D::IntensityType overall_intensity = 0;
-
-      for (IsobaricQuantitationMethod::IsobaricChannelList::const_iterator cl_it = quant_method_->getChannelInformation().begin();
-            cl_it != quant_method_->getChannelInformation().end();
-            ++cl_it)
-      {
-        // set mz-position of channel
-        channel_value.setMZ(cl_it->center);
-        // reset intensity
-        channel_value.setIntensity(0);
-
-        // as every evaluation requires time, we cache the MZEnd iterator
-        const PeakMap::SpectrumType::ConstIterator mz_end = it->MZEnd(cl_it->center + qc_dist_mz);
-
-        // search for the non-zero signal closest to theoretical position
-        // & check for closest signal within reasonable distance (0.5 Da) -- might find neighbouring TMT channel, but that should not confuse anyone
-        int peak_count(0); // count peaks in user window -- should be only one, otherwise Window is too large
-        PeakMap::SpectrumType::ConstIterator idx_nearest(mz_end);
-        for (PeakMap::SpectrumType::ConstIterator mz_it = it->MZBegin(cl_it->center - qc_dist_mz);
-              mz_it != mz_end;
-              ++mz_it)
+        // check precursor constraints
+        if (!result.valid_precursor)
+        {
+          OPENMS_LOG_DEBUG << "Skip spectrum " << it->getNativeID() << ": Precursor doesn't fulfill all constraints." << std::endl;
+          continue;
+        }
+
+        // check precursor purity if we have a valid precursor ..
+        double precursor_purity = result.precursor_purity;
+        if (precursor_scan != ms_exp_data.end())
         {
-          if (mz_it->getIntensity() == 0) continue; // ignore 0-intensity shoulder peaks -- could be detrimental when de-calibrated
-          double dist_mz = fabs(mz_it->getMZ() - cl_it->center);
-          if (dist_mz < reporter_mass_shift_) ++peak_count;
-          if (idx_nearest == mz_end // first peak
-              || ((dist_mz < fabs(idx_nearest->getMZ() - cl_it->center)))) // closer to best candidate
+          if (result.purity_error)
+          {
+            std::rethrow_exception(result.purity_error);
+          }
+          // check if purity is high enough
+          if (precursor_purity < min_precursor_purity_)
           {
-            idx_nearest = mz_it;
+            OPENMS_LOG_DEBUG << "Skip spectrum " << it->getNativeID() << ": Precursor purity is below the threshold. [purity = " << precursor_purity << "]" << std::endl;
+            continue;
           }
         }
-        if (idx_nearest != mz_end)
+        else
         {
-          double mz_delta = cl_it->center - idx_nearest->getMZ();
-          // stats: we don't care what shift the user specified
-          channel_mz_delta[cl_it->name].mz_deltas.push_back(mz_delta);
-          if (peak_count > 1) ++channel_mz_delta[cl_it->name].signal_not_unique;
-          // pass user threshold
-          if (std::fabs(mz_delta) < reporter_mass_shift_)
-          {
-            channel_value.setIntensity(idx_nearest->getIntensity());
+          OPENMS_LOG_INFO << "No precursor available for spectrum: " << it->getNativeID() << std::endl;
+        }
+
+        // the MS2 spectrum, to get the precursor in MS1 (also if quant is in MS3)
+        PeakMap::ConstIterator it_last_MS2 = it;
+        if (it->getMSLevel() == 3)
+        {
+          ms3 = true;
+          // we cannot save just the last MS2 but need to compare to the precursor info stored in the (potential MS3 spectrum)
+          it_last_MS2 = ms_exp_data.getPrecursorSpectrum(it);
+
+          if (it_last_MS2 == ms_exp_data.end())
+          { // this only happens if an MS3 spec does not have a preceding MS2
+            throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("No MS2 precursor information given for MS3 scan native ID ") + it->getNativeID() + " with RT " + String(it->getRT()));
           }
         }
 
-        // discard contribution of this channel as it is below the required intensity threshold
-        if (channel_value.getIntensity() < min_reporter_intensity_)
+        // check if MS1 precursor info is available
+        if (it_last_MS2->getPrecursors().empty())
         {
-          channel_value.setIntensity(0);
+          throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("No precursor information given for scan native ID ") + it->getNativeID() + " with RT " + String(it->getRT()));
         }
 
-        overall_intensity += channel_value.getIntensity();
-        // add channel to ConsensusFeature
-        cf.insert(map_index, channel_value, element_index);
-        ++map_index;
-      } // ! channel_iterator
+        // store RT of MS2 scan and MZ of MS1 precursor ion as centroid of ConsensusFeature
+        ConsensusFeature cf;
+        cf.setUniqueId();
+        cf.setRT(it_last_MS2->getRT());
+        cf.setMZ(it_last_MS2->getPrecursors()[0].getMZ());
 
-      // check if we keep this feature or if it contains low-intensity quantifications
-      if (remove_low_intensity_quantifications_ && hasLowIntensityReporter_(cf))
-      {
-        continue;
-      }
+        Peak2D channel_value;
+        channel_value.setRT(it->getRT());
+        // for each each channel
+        UInt64 map_index = 0;
+        Peak2D::IntensityType overall_intensity = 0;
 
-      // check featureHandles are not empty
-      if (overall_intensity <= 0)
-      {
-        cf.setMetaValue("all_empty", String("true"));
-      }
-      // add purity information if we could compute it
-      if (precursor_purity > 0.0)
-      {
-        cf.setMetaValue("precursor_purity", precursor_purity);
-      }
+        for (Size channel_index = 0; channel_index < channels.size(); ++channel_index)
+        {
+          const IsobaricQuantitationMethod::IsobaricChannelInformation& channel = channels[channel_index];
+          const ReporterPeak& reporter = result.reporters[channel_index];
+          // set mz-position of channel
+          channel_value.setMZ(channel.center);
+          // reset intensity
+          channel_value.setIntensity(0);
 
-      // embed the id of the scan from which the quantitative information was extracted
-      cf.setMetaValue("scan_id", it->getNativeID());
-      // embed the id of the scan from which the ID information should be extracted
-      // helpful for mapping later
-      if (ms3)
-      {
-        cf.setMetaValue("id_scan_id", it_last_MS2->getNativeID());
-      }
-      // ...as well as additional meta information
-      cf.setMetaValue("precursor_intensity", it->getPrecursors()[0].getIntensity());
+          if (reporter.found)
+          {
+            // stats: we don't care what shift the user specified
+            channel_mz_delta[channel.name].mz_deltas.push_back(reporter.mz_delta);
+            if (reporter.not_unique) ++channel_mz_delta[channel.name].signal_not_unique;
+            // pass user threshold
+            if (std::fabs(reporter.mz_delta) < reporter_mass_shift_)
+            {
+              channel_value.setIntensity(reporter.intensity);
+            }
+          }
 
-      cf.setCharge(it_last_MS2->getPrecursors()[0].getCharge());
-      cf.setIntensity(overall_intensity);
-      consensus_map.push_back(cf);
+          // discard contribution of this channel as it is below the required intensity threshold
+          if (channel_value.getIntensity() < min_reporter_intensity_)
+          {
+            channel_value.setIntensity(0);
+          }
+
+          overall_intensity += channel_value.getIntensity();
+          // add channel to ConsensusFeature
+          cf.insert(map_index, channel_value, element_index);
+          ++map_index;
+        } // ! channel_iterator
 
-      // the tandem-scan in the order they appear in the experiment
-      ++element_index;
+        // check if we keep this feature or if it contains low-intensity quantifications
+        if (remove_low_intensity_quantifications_ && hasLowIntensityReporter_(cf))
+        {
+          continue;
+        }
+
+        // check featureHandles are not empty
+        if (overall_intensity <= 0)
+        {
+          cf.setMetaValue("all_empty", String("true"));
+        }
+        // add purity information if we could compute it
+        if (precursor_purity > 0.0)
+        {
+          cf.setMetaValue("precursor_purity", precursor_purity);
+        }
+
+        // embed the id of the scan from which the quantitative information was extracted
+        cf.setMetaValue("scan_id", it->getNativeID());
+        // embed the id of the scan from which the ID information should be extracted
+        // helpful for mapping later
+        if (ms3)
+        {
+          cf.setMetaValue("id_scan_id", it_last_MS2->getNativeID());
+        }
+        // ...as well as additional meta information
+        cf.setMetaValue("precursor_intensity", it->getPrecursors()[0].getIntensity());
+
+        cf.setCharge(it_last_MS2->getPrecursors()[0].getCharge());
+        cf.setIntensity(overall_intensity);
+        consensus_map.push_back(cf);
+
+        // the tandem-scan in the order they appear in the experiment
+        ++element_index;
+      }
     } // ! Experiment iterator
 
     // print stats about m/z calibration / presence of signal
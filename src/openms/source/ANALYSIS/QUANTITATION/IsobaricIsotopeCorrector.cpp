@@ -19,6 +19,9 @@
 #include <Eigen/Core>
 #include <Eigen/LU>
 
+#include <algorithm>
+#include <exception>
+
 // #define ISOBARIC_QUANT_DEBUG
 
 namespace OpenMS
@@ -50,10 +53,10 @@ namespace OpenMS
     }
     
     Eigen::FullPivLU<Eigen::MatrixXd> ludecomp(correction_matrix.getEigenMatrix());
+    const Size n_channels = quant_method->getNumberOfChannels();
     Eigen::VectorXd b;
-    b.resize(quant_method->getNumberOfChannels());
+    b.resize(n_channels);
     b.setZero();
-    std::vector<double> x(quant_method->getNumberOfChannels(), 0);
 
     if (!ludecomp.isInvertible())
     {
@@ -62,34 +65,84 @@ namespace OpenMS
     }
 
     // data structures for NNLS
-    Matrix<double> m_b(quant_method->getNumberOfChannels(), 1);
-    Matrix<double> m_x(quant_method->getNumberOfChannels(), 1);
-
-    // correct all consensus elements
-    for (ConsensusMap::size_type i = 0; i < consensus_map_out.size(); ++i)
+    Matrix<double> m_b(n_channels, 1);
+    Matrix<double> m_x(n_channels, 1);
+
+    // The consensus elements are corrected in blocks: the input vectors are filled in order (channels missing in
+    // an element keep the intensity of the previous one), the independent solves run in parallel, and the output
+    // map and statistics are updated in order again. The result does not depend on the number of threads.
+    const Size block_size = 4096;
+    std::vector<double> block_b; // input vectors (n_channels values per element)
+    std::vector<double> block_x; // solutions by matrix inversion
+    std::vector<double> block_nnls; // NNLS solutions
+    std::vector<std::exception_ptr> block_errors;
+    for (ConsensusMap::size_type block_start = 0; block_start < consensus_map_out.size(); block_start += block_size)
     {
+      const Size block_end = std::min(block_start + block_size, consensus_map_out.size());
+      const Size n_elements = block_end - block_start;
+      block_b.resize(n_elements * n_channels);
+      block_x.resize(n_elements * n_channels);
+      block_nnls.resize(n_elements * n_channels);
+      block_errors.assign(n_elements, std::exception_ptr());
+
+      for (Size i = block_start; i < block_end; ++i)
+      {
+        // fill b vector
+        fillInputVector_(b, m_b, consensus_map_in[i], consensus_map_in);
+        Eigen::VectorXd::Map(&block_b[(i - block_start) * n_channels], n_channels) = b;
+      }
+
+#pragma omp parallel for schedule(dynamic, 64)
+      for (SignedSize k = 0; k < SignedSize(n_elements); ++k)
+      {
+        const Eigen::VectorXd element_b = Eigen::VectorXd::Map(&block_b[k * n_channels], n_channels);
+        Matrix<double> element_m_b(n_channels, 1);
+        element_m_b.getEigenMatrix() = element_b;
+        Matrix<double> element_m_x(n_channels, 1);
+
+        //solve
+        Eigen::MatrixXd e_mx = ludecomp.solve(element_b);
+        try
+        {
+          if (!(correction_matrix.getEigenMatrix() * e_mx).isApprox(element_b))
+          {
+            throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "IsobaricIsotopeCorrector: Cannot multiply!");
+          }
+          solveNNLS_(correction_matrix, element_m_b, element_m_x);
+        }
+        catch (...)
+        {
+          // exceptions can't leave the parallel region -- rethrown below, in the order of the elements
+          block_errors[k] = std::current_exception();
+          continue;
+        }
+        Eigen::VectorXd::Map(&block_x[k * n_channels], n_channels) = e_mx.col(0);
+        Eigen::VectorXd::Map(&block_nnls[k * n_channels], n_channels) = element_m_x.getEigenMatrix().col(0);
+      }
+
+      for (Size i = block_start; i < block_end; ++i)
+      {
+        const Size k = i - block_start;
 #ifdef ISOBARIC_QUANT_DEBUG
-      std::cout << "\nMAP element  #### " << i << " #### \n" << std::endl;
+        std::cout << "\nMAP element  #### " << i << " #### \n" << std::endl;
 #endif
-      // delete only the consensus handles from the output map
-      consensus_map_out[i].clear();
+        if (block_errors[k])
+        {
+          std::rethrow_exception(block_errors[k]);
+        }
 
-      // fill b vector
-      fillInputVector_(b, m_b, consensus_map_in[i], consensus_map_in);
+        // delete only the consensus handles from the output map
+        consensus_map_out[i].clear();
 
-      //solve
-      Eigen::MatrixXd e_mx = ludecomp.solve(b);
-      if (!(correction_matrix.getEigenMatrix() * e_mx).isApprox(b))
-      {
-        throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "IsobaricIsotopeCorrector: Cannot multiply!");
-      }
-      solveNNLS_(correction_matrix, m_b, m_x);
+        Eigen::MatrixXd e_mx = Eigen::VectorXd::Map(&block_x[k * n_channels], n_channels);
+        m_x.getEigenMatrix() = Eigen::VectorXd::Map(&block_nnls[k * n_channels], n_channels);
 
-      // update the output consensus map with the corrected intensities
-      float cf_intensity = updateOutpuMap_(consensus_map_in, consensus_map_out, i, m_x);
+        // update the output consensus map with the corrected intensities
+        float cf_intensity = updateOutpuMap_(consensus_map_in, consensus_map_out, i, m_x);
 
-      // check consistency
-      computeStats_(m_x, e_mx, cf_intensity, quant_method, stats);    
+        // check consistency
+        computeStats_(m_x, e_mx, cf_intensity, quant_method, stats);
+      }
     }
 
     return stats;
@@ -1024,8 +1024,7 @@ namespace OpenMS
         Size j = getBinNumber_(log(m), mass_bin_min_value_, bin_mul_factors_[ms_level_ - 1]);
         if (j >= bin_offset && j < previously_deconved_mass_bins_for_dummy_.size() - bin_offset - 1)
         {
-          for (int k = -bin_offset; k <= (int) bin_offset; k++)
-            previously_deconved_mass_bins_for_dummy_[j + k] = true;
+          previously_deconved_mass_bins_for_dummy_.set(j - bin_offset, 2 * bin_offset + 1, true); // whole blocks at once
         }
       }
     }
@@ -1052,9 +1051,7 @@ namespace OpenMS
             break;
           }
 
-          target_mass_bins_[j - 1] = true;
-          target_mass_bins_[j] = true;
-          target_mass_bins_[j + 1] = true;
+          target_mass_bins_.set(j - 1, 3, true);
         }
       }
     }
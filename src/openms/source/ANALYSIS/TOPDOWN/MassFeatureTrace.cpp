@@ -34,6 +34,16 @@ namespace OpenMS
   }
 
   std::vector<FLASHDeconvHelperStructs::MassFeature> MassFeatureTrace::findFeatures(const PrecalculatedAveragine& averagine)
+  {
+    return findFeatures_(averagine, false);
+  }
+
+  std::vector<FLASHDeconvHelperStructs::MassFeature> MassFeatureTrace::findClosedFeatures(const PrecalculatedAveragine& averagine)
+  {
+    return findFeatures_(averagine, true);
+  }
+
+  std::vector<FLASHDeconvHelperStructs::MassFeature> MassFeatureTrace::findFeatures_(const PrecalculatedAveragine& averagine, bool closed_only)
   {
     MSExperiment map;
     std::map<int, MSSpectrum> index_spec_map;
@@ -75,8 +85,31 @@ namespace OpenMS
     mtdet.run(map, m_traces); // m_traces : output of this function
     int charge_range = max_abs_charge - min_abs_charge + 1;
 
+    // a trace is closed if more than trace_termination_outliers_ spectra follow its last peak: the extension of the trace has stopped before the spectra still to come
+    double closing_rt = map[map.size() - 1].getRT();
+    if (closed_only)
+    {
+      if (map.size() < trace_termination_outliers_ + 2)
+      {
+        return mass_features;
+      }
+      closing_rt = map[map.size() - trace_termination_outliers_ - 2].getRT();
+    }
+    double open_trace_start_rt = closing_rt;
+    std::vector<const MassTrace*> closed_traces;
+
     for (auto& mt : m_traces)
     {
+      if (closed_only)
+      {
+        if (mt.rbegin()->getRT() > closing_rt)
+        {
+          open_trace_start_rt = std::min(open_trace_start_rt, mt.begin()->getRT());
+          continue;
+        }
+        closed_traces.push_back(&mt);
+      }
+
       double max_qscore = .0;
       int min_feature_abs_charge = INT_MAX; // min feature charge
       int max_feature_abs_charge = INT_MIN; // max feature charge
@@ -165,6 +198,22 @@ namespace OpenMS
       mass_feature.rep_charge = rep_pg.getRepAbsCharge();
       mass_features.push_back(mass_feature);
     }
+
+    if (closed_only)
+    {
+      for (const auto* mt : closed_traces)
+      {
+        for (const auto& p : *mt)
+        {
+          peak_group_map_[p.getRT()].erase(p.getMZ());
+        }
+      }
+      // Peaks further back than the open traces can only be reached by a future trace if they are within its termination window,
+      // or if they belong to a trace that is still too short to be reported. Older spectra are discarded.
+      Size keep_index = map.size() > 2 * trace_termination_outliers_ + 2 ? map.size() - 2 * trace_termination_outliers_ - 2 : 0;
+      double keep_rt = std::min(open_trace_start_rt, map[keep_index].getRT() - min_trace_length_);
+      peak_group_map_.erase(peak_group_map_.begin(), peak_group_map_.lower_bound(keep_rt));
+    }
     return mass_features;
   }
 
@@ -189,5 +238,7 @@ namespace OpenMS
   void MassFeatureTrace::updateMembers_()
   {
     min_isotope_cosine_ = param_.getValue("min_isotope_cosine");
+    trace_termination_outliers_ = (Size)param_.getValue("trace_termination_outliers");
+    min_trace_length_ = param_.getValue("min_trace_length");
   }
 } // namespace OpenMS
@@ -15,6 +15,7 @@
 #include <OpenMS/DATASTRUCTURES/ListUtilsIO.h>
 #include <OpenMS/DATASTRUCTURES/StringView.h>
 
+#include <algorithm>
 #include <utility>
 
 #ifdef _OPENMP
@@ -29,14 +30,227 @@ using namespace std;
 
 namespace OpenMS
 {
+  OPXLHelper::LinearIonSpectrumCache::LinearIonSpectrumCache(const SimpleTSGXLMS& spec_gen, Size max_entries) :
+    spec_gen_(spec_gen),
+    max_entries_per_shard_(0),
+    shards_(std::max<Size>(1, std::min<Size>(64, max_entries))),
+    hits_(0),
+    misses_(0)
+  {
+    // never hold more than max_entries spectra in total
+    max_entries_per_shard_ = max_entries / shards_.size();
+  }
+
+  std::size_t OPXLHelper::LinearIonSpectrumCache::KeyHash::operator()(const Key& key) const
+  {
+    std::size_t seed = std::hash<const AASequence*>()(key.peptide);
+    auto combine = [&seed](std::size_t value) { seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2); };
+    combine(key.link_pos);
+    combine(key.link_pos_2);
+    combine(static_cast<std::size_t>(key.charge));
+    return seed;
+  }
+
+  OPXLHelper::LinearIonSpectrumCache::SpectrumPtr OPXLHelper::LinearIonSpectrumCache::get(const AASequence& peptide, Size link_pos, int charge, Size link_pos_2)
+  {
+    const Key key{&peptide, link_pos, link_pos_2, charge};
+    Shard& shard = shards_[KeyHash()(key) % shards_.size()];
+
+    if (max_entries_per_shard_ > 0)
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto it = shard.entries.find(key);
+      if (it != shard.entries.end())
+      {
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second.second);
+        ++hits_;
+        return it->second.first;
+      }
+    }
+    ++misses_;
+
+    // generate outside of the lock, other threads can use the shard in the meantime
+    AASequence seq = peptide;
+    auto spectrum = std::make_shared<std::vector<SimpleTSGXLMS::SimplePeak>>();
+    spec_gen_.getLinearIonSpectrum(*spectrum, seq, link_pos, charge, link_pos_2);
+    SpectrumPtr result = std::move(spectrum);
+
+    if (max_entries_per_shard_ > 0)
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto it = shard.entries.find(key);
+      if (it != shard.entries.end())
+      {
+        // another thread was faster, keep its spectrum
+        return it->second.first;
+      }
+      if (shard.entries.size() >= max_entries_per_shard_)
+      {
+        shard.entries.erase(shard.lru.back());
+        shard.lru.pop_back();
+      }
+      shard.lru.push_front(key);
+      shard.entries.emplace(key, std::make_pair(result, shard.lru.begin()));
+    }
+    return result;
+  }
+
+  Size OPXLHelper::LinearIonSpectrumCache::getHits() const
+  {
+    return hits_;
+  }
+
+  Size OPXLHelper::LinearIonSpectrumCache::getMisses() const
+  {
+    return misses_;
+  }
+
+  Size OPXLHelper::LinearIonSpectrumCache::size() const
+  {
+    Size n = 0;
+    for (const Shard& shard : shards_)
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      n += shard.entries.size();
+    }
+    return n;
+  }
+
+  OPXLHelper::LinearFragmentFilter::LinearFragmentFilter(const std::vector<OPXLDataStructs::AASeqWithMass>& peptides, const SimpleTSGXLMS& spec_gen, double fragment_mass_tolerance,
+                                                         bool fragment_mass_tolerance_unit_ppm, int max_charge, Size min_matches) :
+    peptides_(peptides),
+    spec_gen_(spec_gen),
+    fragment_mass_tolerance_(fragment_mass_tolerance),
+    fragment_mass_tolerance_unit_ppm_(fragment_mass_tolerance_unit_ppm),
+    max_charge_(max_charge),
+    min_matches_(min_matches),
+    state_(peptides.size()) // value-initialized to 0: no spectrum yet
+  {
+  }
+
+  OPXLHelper::LinearFragmentFilter::LinearFragmentFilter(const std::vector<OPXLDataStructs::AASeqWithMass>& peptides, LinearIonSpectrumCache& cache, const SimpleTSGXLMS& spec_gen,
+                                                         double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, int max_charge, Size min_matches) :
+    LinearFragmentFilter(peptides, spec_gen, fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, max_charge, min_matches)
+  {
+    cache_ = &cache;
+  }
+
+  void OPXLHelper::LinearFragmentFilter::setSpectrum(const PeakSpectrum& linear_peaks)
+  {
+    linear_peaks_ = &linear_peaks;
+    // invalidates the states of all peptides at once
+    ++spectrum_generation_;
+  }
+
+  bool OPXLHelper::LinearFragmentFilter::operator()(Size index)
+  {
+    const Size state = state_[index].load(std::memory_order_relaxed);
+    if ((state >> 1) == spectrum_generation_)
+    {
+      return (state & 1) != 0;
+    }
+    // threads racing for the same peptide compute the same result, so it does not matter which store wins
+    const bool accepted = countMatchesUpperBound(peptides_[index].peptide_seq) >= min_matches_;
+    state_[index].store((spectrum_generation_ << 1) | static_cast<Size>(accepted), std::memory_order_relaxed);
+    return accepted;
+  }
+
+  Size OPXLHelper::LinearFragmentFilter::countMatchesUpperBound(const AASequence& peptide) const
+  {
+    if (linear_peaks_ == nullptr || linear_peaks_->empty() || peptide.empty())
+    {
+      return 0;
+    }
+
+    // with the link at the last residue, all prefix ions are linear, with the link at the first residue, all suffix ions.
+    // the linear ions of any other link position are a subset of both together.
+    LinearIonSpectrumCache::SpectrumPtr prefix_ions;
+    LinearIonSpectrumCache::SpectrumPtr suffix_ions;
+    if (cache_ != nullptr)
+    {
+      prefix_ions = cache_->get(peptide, peptide.size() - 1, max_charge_);
+      suffix_ions = cache_->get(peptide, 0, max_charge_);
+    }
+    else
+    {
+      AASequence seq = peptide;
+      auto prefix = std::make_shared<std::vector< SimpleTSGXLMS::SimplePeak >>();
+      auto suffix = std::make_shared<std::vector< SimpleTSGXLMS::SimplePeak >>();
+      spec_gen_.getLinearIonSpectrum(*prefix, seq, seq.size() - 1, max_charge_);
+      spec_gen_.getLinearIonSpectrum(*suffix, seq, 0, max_charge_);
+      prefix_ions = std::move(prefix);
+      suffix_ions = std::move(suffix);
+    }
+
+    // count theoretical peaks with an experimental peak in the tolerance window, the same criterion as in OPXLSpectrumProcessingAlgorithms::getSpectrumAlignmentSimple
+    // (but ignoring charges). Every matched theoretical peak is aligned at most once, so this is an upper bound for the size of the alignment.
+    const PeakSpectrum& exp_spectrum = *linear_peaks_;
+    auto count_matches = [&](const std::vector< SimpleTSGXLMS::SimplePeak >& theo_spectrum)
+    {
+      Size matches = 0;
+      Size e = 0;
+      for (const SimpleTSGXLMS::SimplePeak& theo_peak : theo_spectrum)
+      {
+        const double max_dist_dalton = fragment_mass_tolerance_unit_ppm_ ? theo_peak.mz * fragment_mass_tolerance_ * 1e-6 : fragment_mass_tolerance_;
+        while (e < exp_spectrum.size() && exp_spectrum[e].getMZ() - theo_peak.mz < -max_dist_dalton)
+        {
+          ++e;
+        }
+        if (e == exp_spectrum.size())
+        {
+          break;
+        }
+        if (exp_spectrum[e].getMZ() - theo_peak.mz <= max_dist_dalton)
+        {
+          ++matches;
+        }
+      }
+      return matches;
+    };
+    return count_matches(*prefix_ions) + count_matches(*suffix_ions);
+  }
+
   vector<OPXLDataStructs::XLPrecursor> OPXLHelper::enumerateCrossLinksAndMasses(const vector<OPXLDataStructs::AASeqWithMass>& peptides, double cross_link_mass, const DoubleList& cross_link_mass_mono_link, const StringList& cross_link_residue1, const StringList& cross_link_residue2, const vector< double >& spectrum_precursors, vector< int >& precursor_correction_positions, double precursor_mass_tolerance, bool precursor_mass_tolerance_unit_ppm)
   {
     // initialize empty vector for the results
     vector<OPXLDataStructs::XLPrecursor> mass_to_candidates;
 
+    forEachCrossLinkCandidate(peptides, cross_link_mass, cross_link_mass_mono_link, cross_link_residue1, cross_link_residue2, spectrum_precursors, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm, std::function<bool(Size)>(),
+      [&](Size alpha_index, Size beta_index, double precursor_mass, int precursor_correction_position)
+      {
+        OPXLDataStructs::XLPrecursor precursor;
+        precursor.precursor_mass = precursor_mass;
+        precursor.alpha_index = alpha_index;
+        precursor.beta_index = beta_index;
+        precursor.alpha_seq = peptides[alpha_index].unmodified_seq;
+        if (beta_index < peptides.size())
+        {
+          precursor.beta_seq = peptides[beta_index].unmodified_seq;
+        }
+        mass_to_candidates.push_back(precursor);
+        precursor_correction_positions.push_back(precursor_correction_position);
+      });
+    return mass_to_candidates;
+  }
+
+  void OPXLHelper::forEachCrossLinkCandidate(const vector<OPXLDataStructs::AASeqWithMass>& peptides, double cross_link_mass, const DoubleList& cross_link_mass_mono_link, const StringList& cross_link_residue1, const StringList& cross_link_residue2, const vector< double >& spectrum_precursors, double precursor_mass_tolerance, bool precursor_mass_tolerance_unit_ppm,
+                                             const std::function<bool(Size)>& peptide_filter, const std::function<void(Size, Size, double, int)>& candidate_callback)
+  {
+    if (peptides.empty() || spectrum_precursors.empty())
+    {
+      return;
+    }
+
+    auto accepted = [&peptide_filter](Size index)
+    {
+      return !peptide_filter || peptide_filter(index);
+    };
+
     double max_precursor = spectrum_precursors[spectrum_precursors.size()-1];
 
     Size peptides_size = peptides.size();
+    // an out-of-range index to represent an empty index
+    Size no_beta_index = peptides_size + 1;
 
     // compute a very conservative total upper bound, based on the heaviest possible linear peptide
     // can be used instead of peptides.end() in all cases for this precursor mass
@@ -75,11 +289,10 @@ namespace OpenMS
       first_loop = lower_bound(first_loop, conservative_upper_bound, min_peptide_mass, OPXLDataStructs::AASeqWithMassComparator());
       last_loop = upper_bound(last_loop, conservative_upper_bound, max_peptide_mass, OPXLDataStructs::AASeqWithMassComparator());
 
-      int first_index = first_loop - peptides.cbegin();
-      int last_index = last_loop - peptides.cbegin();
+      Size first_index = first_loop - peptides.cbegin();
+      Size last_index = last_loop - peptides.cbegin();
 
-#pragma omp parallel for
-      for (int p1 = first_index; p1 < last_index; ++p1)
+      for (Size p1 = first_index; p1 < last_index; ++p1)
       {
         const String& seq_first = peptides[p1].unmodified_seq;
         // test if this peptide could have loop-links: one cross-link with both sides attached to the same peptide
@@ -87,43 +300,29 @@ namespace OpenMS
         bool second_res = false; // is there a residue the second side of the linker can attach to?
         for (Size k = 0; k < seq_first.size()-1; ++k)
         {
-         for (Size i = 0; i < cross_link_residue1.size(); ++i)
-         {
-           if (cross_link_residue1[i].size() == 1 && string(1, seq_first[k]) == cross_link_residue1[i])
-           {
-             first_res = true;
-           }
-         }
-         for (Size i = 0; i < cross_link_residue2.size(); ++i)
-         {
-           if (cross_link_residue2[i].size() == 1 && string(1, seq_first[k]) == cross_link_residue2[i])
-           {
-             second_res = true;
-           }
-         }
+          for (Size i = 0; i < cross_link_residue1.size(); ++i)
+          {
+            if (cross_link_residue1[i].size() == 1 && string(1, seq_first[k]) == cross_link_residue1[i])
+            {
+              first_res = true;
+            }
+          }
+          for (Size i = 0; i < cross_link_residue2.size(); ++i)
+          {
+            if (cross_link_residue2[i].size() == 1 && string(1, seq_first[k]) == cross_link_residue2[i])
+            {
+              second_res = true;
+            }
+          }
         }
 
         // If both sides of a cross-linker can link to this peptide, generate the loop-link
-        if (first_res && second_res)
+        if (first_res && second_res && accepted(p1))
         {
-         // Monoisotopic weight of the peptide + cross-linker
-         double cross_linked_peptide_mass = peptides[p1].peptide_mass + cross_link_mass;
-
-         // also only one peptide
-         OPXLDataStructs::XLPrecursor precursor;
-         precursor.precursor_mass = cross_linked_peptide_mass;
-         precursor.alpha_index = p1;
-         precursor.beta_index = peptides_size + 1; // an out-of-range index to represent an empty index
-         precursor.alpha_seq = seq_first;
-         precursor.beta_seq = "";
-
-#pragma omp critical (mass_to_candidates_access)
-         {
-           mass_to_candidates.push_back(precursor);
-           precursor_correction_positions.push_back(pm);
-         }
+          // Monoisotopic weight of the peptide + cross-linker, only one peptide
+          candidate_callback(p1, no_beta_index, peptides[p1].peptide_mass + cross_link_mass, pm);
         }
-      } // end of parallel loop over loop-link candidates
+      } // end of loop over loop-link candidates
 
       // ################################ Enumerate Mono-Links #################
       for (Size i = 0; i < cross_link_mass_mono_link.size(); i++)
@@ -141,25 +340,13 @@ namespace OpenMS
         first_index = first_mono - peptides.cbegin();
         last_index = last_mono - peptides.cbegin();
 
-#pragma omp parallel for
-        for (int p1 = first_index; p1 < last_index; ++p1)
+        for (Size p1 = first_index; p1 < last_index; ++p1)
         {
-          // Monoisotopic weight of the peptide + cross-linker
-          double cross_linked_peptide_mass = peptides[p1].peptide_mass + mono_link_mass;
-
-          // Make sure it is clear only one peptide is considered here. Use an out-of-range value for the second peptide.
-          OPXLDataStructs::XLPrecursor precursor;
-          precursor.precursor_mass = cross_linked_peptide_mass;
-          precursor.alpha_index = p1;
-          precursor.beta_index = peptides_size + 1; // an out-of-range index to represent an empty index
-          precursor.alpha_seq = peptides[p1].unmodified_seq;
-          precursor.beta_seq = "";
-
-#pragma omp critical (mass_to_candidates_access)
-         {
-           mass_to_candidates.push_back(precursor);
-           precursor_correction_positions.push_back(pm);
-         }
+          if (accepted(p1))
+          {
+            // Monoisotopic weight of the peptide + cross-linker, only one peptide
+            candidate_callback(p1, no_beta_index, peptides[p1].peptide_mass + mono_link_mass, pm);
+          }
         } // end of loop over candidates for a specific mono-link mass
       } // end of loop over mono-link masses
 
@@ -169,49 +356,75 @@ namespace OpenMS
       // maximal mass: difference between precursor mass and the smallest peptide + cross-linker
       max_peptide_mass = precursor_mass - cross_link_mass - peptides[0].peptide_mass + allowed_error;
       last_alpha = upper_bound(last_alpha, conservative_upper_bound, max_peptide_mass, OPXLDataStructs::AASeqWithMassComparator());
-      int last_alpha_index = last_alpha - peptides.cbegin();
-
-#pragma omp parallel for
-      for (int p1 = 0; p1 < last_alpha_index; ++p1)
+      Size last_alpha_index = last_alpha - peptides.cbegin();
+
+      // Two-pointer sweep: as the alpha peptide gets heavier, the mass window for the beta peptide moves towards lighter peptides.
+      // first_beta and last_beta are the lower and upper bound of that window among the peptides not lighter than alpha (beta >= alpha avoids duplicate pairs).
+      // The alpha peptides are swept in chunks in parallel, each chunk starts with a binary search for its window. The pairs of a chunk are collected
+      // and passed on in chunk order afterwards, so the order of the candidates does not depend on the number of threads.
+      const Size chunk_size = 256;
+      const SignedSize nr_chunks = static_cast<SignedSize>((last_alpha_index + chunk_size - 1) / chunk_size);
+      std::vector< std::vector< std::pair<Size, Size> > > chunk_pairs(nr_chunks);
+
+#pragma omp parallel for schedule(dynamic)
+      for (SignedSize chunk = 0; chunk < nr_chunks; ++chunk)
       {
-        // Constrain search for beta
-        double min_peptide_mass_beta = precursor_mass - cross_link_mass - peptides[p1].peptide_mass - allowed_error;
-        double max_peptide_mass_beta = precursor_mass - cross_link_mass - peptides[p1].peptide_mass + allowed_error;
+        const Size chunk_begin = static_cast<Size>(chunk) * chunk_size;
+        const Size chunk_end = std::min(chunk_begin + chunk_size, last_alpha_index);
+        std::vector< std::pair<Size, Size> >& pairs = chunk_pairs[chunk];
+
+        const double max_beta_mass_start = precursor_mass - cross_link_mass - peptides[chunk_begin].peptide_mass + allowed_error;
+        const double min_beta_mass_start = precursor_mass - cross_link_mass - peptides[chunk_begin].peptide_mass - allowed_error;
+        auto window_begin = peptides.cbegin() + chunk_begin;
+        auto window_end = peptides.cbegin() + last_alpha_index;
+        Size last_beta = upper_bound(window_begin, window_end, max_beta_mass_start, OPXLDataStructs::AASeqWithMassComparator()) - peptides.cbegin();
+        Size first_beta = lower_bound(window_begin, window_end, min_beta_mass_start, OPXLDataStructs::AASeqWithMassComparator()) - peptides.cbegin();
+
+        for (Size p1 = chunk_begin; p1 < chunk_end; ++p1)
+        {
+          // Constrain search for beta
+          double min_peptide_mass_beta = precursor_mass - cross_link_mass - peptides[p1].peptide_mass - allowed_error;
+          double max_peptide_mass_beta = precursor_mass - cross_link_mass - peptides[p1].peptide_mass + allowed_error;
 
-        // the last_alpha upper bound is also a conservative upper bound here
-        vector<OPXLDataStructs::AASeqWithMass>::const_iterator first_beta = lower_bound(peptides.cbegin()+p1, last_alpha, min_peptide_mass_beta, OPXLDataStructs::AASeqWithMassComparator());
-        vector<OPXLDataStructs::AASeqWithMass>::const_iterator last_beta = upper_bound(peptides.cbegin()+p1, last_alpha, max_peptide_mass_beta, OPXLDataStructs::AASeqWithMassComparator());
+          while (last_beta > p1 && peptides[last_beta - 1].peptide_mass > max_peptide_mass_beta)
+          {
+            --last_beta;
+          }
+          if (last_beta <= p1)
+          {
+            // all remaining peptides are too heavy for an alpha peptide with a beta peptide at least as heavy
+            break;
+          }
+          first_beta = std::max(first_beta, p1);
+          while (first_beta > p1 && peptides[first_beta - 1].peptide_mass >= min_peptide_mass_beta)
+          {
+            --first_beta;
+          }
 
-        if (first_beta == last_beta)
-        {
-          continue;
-        }
+          if (first_beta == last_beta || !accepted(p1))
+          {
+            continue;
+          }
 
-        Size first_beta_index = first_beta - peptides.begin();
-        Size last_beta_index = last_beta - peptides.begin();
+          for (Size p2 = first_beta; p2 < last_beta; ++p2)
+          {
+            if (accepted(p2))
+            {
+              pairs.emplace_back(p1, p2);
+            }
+          } // end of loop over betas
+        } // end of loop over alphas
+      } // end of parallel loop over alpha chunks
 
-        for (Size p2 = first_beta_index; p2 < last_beta_index; ++p2)
+      for (const std::vector< std::pair<Size, Size> >& pairs : chunk_pairs)
+      {
+        for (const std::pair<Size, Size>& pair : pairs)
         {
           // Monoisotopic weight of the first peptide + the second peptide + cross-linker
-          double cross_linked_pair_mass = peptides[p1].peptide_mass + peptides[p2].peptide_mass + cross_link_mass;
-
-          // this time both peptides have valid indices
-          OPXLDataStructs::XLPrecursor precursor;
-          precursor.precursor_mass = cross_linked_pair_mass;
-          precursor.alpha_index = p1;
-          precursor.beta_index = p2;
-          precursor.alpha_seq = peptides[p1].unmodified_seq;
-          precursor.beta_seq = peptides[p2].unmodified_seq;
-
-#pragma omp critical (mass_to_candidates_access)
-         {
-           mass_to_candidates.push_back(precursor);
-           precursor_correction_positions.push_back(pm);
-         }
-        } // end of loop over betas
-      } // end of parallel loop over alphas
+          candidate_callback(pair.first, pair.second, peptides[pair.first].peptide_mass + peptides[pair.second].peptide_mass + cross_link_mass, pm);
+        }
+      }
     } // end of loop over precursor masses
-    return mass_to_candidates;
   }
 
   std::vector<OPXLDataStructs::AASeqWithMass> OPXLHelper::digestDatabase(
@@ -1302,7 +1515,8 @@ namespace OpenMS
                                                                                                 const StringList& cross_link_residue2,
                                                                                                 String cross_link_name,
                                                                                                 bool use_sequence_tags,
-                                                                                                const std::vector<std::string>& tags)
+                                                                                                const std::vector<std::string>& tags,
+                                                                                                const std::function<bool(Size)>& peptide_filter)
   {
     // determine candidates
     std::vector< OPXLDataStructs::XLPrecursor > candidates;
@@ -1334,7 +1548,22 @@ namespace OpenMS
     if ( (use_sequence_tags && !tags.empty()) ||
          !use_sequence_tags)
     {
-      candidates = OPXLHelper::enumerateCrossLinksAndMasses(filtered_peptide_masses, cross_link_mass, cross_link_mass_mono_link, cross_link_residue1, cross_link_residue2, spectrum_precursor_vector, precursor_correction_positions, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm);
+      // peptide pairs rejected by the filter are never stored
+      OPXLHelper::forEachCrossLinkCandidate(filtered_peptide_masses, cross_link_mass, cross_link_mass_mono_link, cross_link_residue1, cross_link_residue2, spectrum_precursor_vector, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm, peptide_filter,
+        [&](Size alpha_index, Size beta_index, double candidate_mass, int precursor_correction_position)
+        {
+          OPXLDataStructs::XLPrecursor precursor;
+          precursor.precursor_mass = candidate_mass;
+          precursor.alpha_index = alpha_index;
+          precursor.beta_index = beta_index;
+          precursor.alpha_seq = filtered_peptide_masses[alpha_index].unmodified_seq;
+          if (beta_index < filtered_peptide_masses.size())
+          {
+            precursor.beta_seq = filtered_peptide_masses[beta_index].unmodified_seq;
+          }
+          candidates.push_back(precursor);
+          precursor_correction_positions.push_back(precursor_correction_position);
+        });
     }
 
     // an empty vector of sequence tags implies no filtering should be done in this case
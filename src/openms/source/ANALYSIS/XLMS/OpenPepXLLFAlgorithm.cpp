@@ -17,6 +17,7 @@
 #include <OpenMS/CHEMISTRY/ModifiedPeptideGenerator.h>
 #include <OpenMS/CHEMISTRY/ProteaseDB.h>
 #include <OpenMS/CHEMISTRY/ProteaseDigestion.h>
+#include <OpenMS/CHEMISTRY/ResidueDB.h>
 #include <OpenMS/CHEMISTRY/SimpleTSGXLMS.h>
 #include <OpenMS/CHEMISTRY/Tagger.h>
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGeneratorXLMS.h>
@@ -89,6 +90,8 @@ using namespace OpenMS;
     std::vector<std::string> deisotope_strings = std::vector<std::string>({"true", "false", "auto"});
     defaults_.setValue("algorithm:deisotope", "auto", "Set to true, if the input spectra should be deisotoped before any other processing steps. If set to auto the spectra will be deisotoped, if the fragment mass tolerance is < 0.1 Da or < 100 ppm (0.1 Da at a mass of 1000)", std::vector<std::string>({"advanced"}));
     defaults_.setValidStrings("algorithm:deisotope", deisotope_strings);
+    defaults_.setValue("algorithm:linear_fragment_cache_size", 100000, "Maximal number of linear fragment spectra of candidate peptides kept in memory to be reused for other spectra (0 disables the cache). The hit rate of the cache is reported at the end of the search.", std::vector<std::string>({"advanced"}));
+    defaults_.setMinInt("algorithm:linear_fragment_cache_size", 0);
     defaults_.setValue("algorithm:use_sequence_tags", "false", "Use sequence tags (de novo sequencing of short fragments) to filter out candidates before scoring. This will make the search faster, but can impact the sensitivity positively or negatively, depending on the dataset.");
     defaults_.setValidStrings("algorithm:use_sequence_tags", bool_strings);
     defaults_.setValue("algorithm:sequence_tag_min_length", 2, "Minimal length of sequence tags to use for filtering candidates. Longer tags will make the search faster but much less sensitive. Ignored if 'algorithm:use_sequence_tags' is false.", std::vector<std::string>({"advanced"}));
@@ -145,6 +148,7 @@ using namespace OpenMS;
 
     number_top_hits_ = static_cast<Int>(param_.getValue("algorithm:number_top_hits"));
     deisotope_mode_ = static_cast<String>(param_.getValue("algorithm:deisotope").toString());
+    linear_fragment_cache_size_ = static_cast<Size>(param_.getValue("algorithm:linear_fragment_cache_size"));
     use_sequence_tags_ = param_.getValue("algorithm:use_sequence_tags") == "true";
     sequence_tag_min_length_ = static_cast<Size>(param_.getValue("algorithm:sequence_tag_min_length"));
 
@@ -190,6 +194,9 @@ using namespace OpenMS;
     }
     ModifiedPeptideGenerator::MapToResidueType fixed_modifications = ModifiedPeptideGenerator::getModifications(fixedModNames_);
     ModifiedPeptideGenerator::MapToResidueType variable_modifications = ModifiedPeptideGenerator::getModifications(varModNames_);
+    // all modified residues of the search exist now: lookups in the parallel regions do not need to lock
+    ResidueDB::getInstance()->freeze();
+    ModificationsDB::getInstance()->freeze();
 
     protein_ids[0].setPrimaryMSRunPath({}, unprocessed_spectra);
 
@@ -370,6 +377,12 @@ using namespace OpenMS;
     vector<OPXLDataStructs::AASeqWithMass> filtered_peptide_masses;
     filtered_peptide_masses.assign(peptide_masses.begin(), last);
 
+    // linear fragment spectra of the candidate peptides, shared by all spectra and threads
+    OPXLHelper::LinearIonSpectrumCache linear_ion_cache(specGen_mainscore, linear_fragment_cache_size_);
+
+    // discards peptide pairs with too few linear fragment matches while enumerating the candidates of a spectrum (the same check as in the scoring loop below)
+    OPXLHelper::LinearFragmentFilter linear_fragment_filter(filtered_peptide_masses, linear_ion_cache, specGen_mainscore, fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm_);
+
     // iterate over all spectra
     progresslogger.startProgress(0, 1, "Matching to theoretical spectra and scoring...");
 
@@ -391,7 +404,8 @@ using namespace OpenMS;
       }
 
       vector< OPXLDataStructs::CrossLinkSpectrumMatch > top_csms_spectrum;
-      vector< OPXLDataStructs::ProteinProteinCrossLink > cross_link_candidates = OPXLHelper::collectPrecursorCandidates(precursor_correction_steps_, precursor_mass, precursor_mass_tolerance_, precursor_mass_tolerance_unit_ppm_, filtered_peptide_masses, cross_link_mass_, cross_link_mass_mono_link_, cross_link_residue1_, cross_link_residue2_, cross_link_name_, use_sequence_tags_, tags);
+      linear_fragment_filter.setSpectrum(spectrum);
+      vector< OPXLDataStructs::ProteinProteinCrossLink > cross_link_candidates = OPXLHelper::collectPrecursorCandidates(precursor_correction_steps_, precursor_mass, precursor_mass_tolerance_, precursor_mass_tolerance_unit_ppm_, filtered_peptide_masses, cross_link_mass_, cross_link_mass_mono_link_, cross_link_residue1_, cross_link_residue2_, cross_link_name_, use_sequence_tags_, tags, std::ref(linear_fragment_filter));
       all_candidates_count += cross_link_candidates.size();
 
 #ifdef DEBUG_OPENPEPXLLFALGO
@@ -416,9 +430,6 @@ using namespace OpenMS;
       {
         OPXLDataStructs::ProteinProteinCrossLink cross_link_candidate = cross_link_candidates[i];
 
-        std::vector< SimpleTSGXLMS::SimplePeak > theoretical_spec_linear_alpha;
-        theoretical_spec_linear_alpha.reserve(1500);
-        std::vector< SimpleTSGXLMS::SimplePeak > theoretical_spec_linear_beta;
         std::vector< SimpleTSGXLMS::SimplePeak > theoretical_spec_xlinks_alpha;
         std::vector< SimpleTSGXLMS::SimplePeak > theoretical_spec_xlinks_beta;
 
@@ -434,12 +445,20 @@ using namespace OpenMS;
         if (cross_link_candidate.alpha) { alpha = *cross_link_candidate.alpha; }
         if (cross_link_candidate.beta) { beta = *cross_link_candidate.beta; }
 
-        specGen_mainscore.getLinearIonSpectrum(theoretical_spec_linear_alpha, alpha, cross_link_candidate.cross_link_position.first, 2, link_pos_B);
-        if (type_is_cross_link)
+        // the linear fragments only depend on the peptide and the link position, so they are reused for other candidates and spectra
+        const std::vector< SimpleTSGXLMS::SimplePeak > no_peaks;
+        OPXLHelper::LinearIonSpectrumCache::SpectrumPtr linear_alpha;
+        OPXLHelper::LinearIonSpectrumCache::SpectrumPtr linear_beta;
+        if (cross_link_candidate.alpha)
         {
-          theoretical_spec_linear_beta.reserve(1500);
-          specGen_mainscore.getLinearIonSpectrum(theoretical_spec_linear_beta, beta, cross_link_candidate.cross_link_position.second, 2);
+          linear_alpha = linear_ion_cache.get(*cross_link_candidate.alpha, cross_link_candidate.cross_link_position.first, 2, link_pos_B);
+        }
+        if (type_is_cross_link && cross_link_candidate.beta)
+        {
+          linear_beta = linear_ion_cache.get(*cross_link_candidate.beta, cross_link_candidate.cross_link_position.second, 2);
         }
+        const std::vector< SimpleTSGXLMS::SimplePeak >& theoretical_spec_linear_alpha = linear_alpha ? *linear_alpha : no_peaks;
+        const std::vector< SimpleTSGXLMS::SimplePeak >& theoretical_spec_linear_beta = linear_beta ? *linear_beta : no_peaks;
 
         // Something like this can happen, e.g. with a loop link connecting the first and last residue of a peptide
         if ( theoretical_spec_linear_alpha.empty() )
@@ -945,6 +964,7 @@ using namespace OpenMS;
 
     // end of matching / scoring
     progresslogger.endProgress();
+    OPENMS_LOG_INFO << "Linear fragment cache: " << linear_ion_cache.getHits() << " hits, " << linear_ion_cache.getMisses() << " misses (" << linear_ion_cache.size() << " of at most " << linear_fragment_cache_size_ << " spectra cached)" << std::endl;
 
     // Add protein identifications
     PeptideIndexing pep_indexing;
@@ -18,9 +18,12 @@
 #include <OpenMS/CONCEPT/Macros.h>
 #include <OpenMS/CONCEPT/PrecisionWrapper.h>
 
+#include <array>
 #include <cmath>
 #include <algorithm>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 
 using namespace std;
 
@@ -1691,4 +1694,59 @@ namespace OpenMS
     return aas;
   }
 
+  namespace
+  {
+    /**
+      @brief Global cache of parsed sequences (see AASequence::fromStringCached)
+
+      Entries are distributed over independently locked shards, so that
+      concurrent readers rarely wait for each other. Parsing happens outside
+      of the locks. A shard is cleared when it is full.
+    */
+    class AASequenceParseCache
+    {
+    public:
+      AASequence get(const String& s, bool permissive)
+      {
+        Shard& shard = shards_[std::hash<String>()(s) % NUMBER_OF_SHARDS];
+        auto& sequences = shard.sequences[permissive ? 1 : 0];
+        {
+          std::lock_guard<std::mutex> lock(shard.mutex);
+          const auto it = sequences.find(s);
+          if (it != sequences.end())
+          {
+            return it->second;
+          }
+        }
+        // throws for invalid strings (which are not cached)
+        AASequence aas = AASequence::fromString(s, permissive);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (sequences.size() >= MAX_SHARD_SIZE)
+        {
+          sequences.clear();
+        }
+        sequences.emplace(s, aas);
+        return aas;
+      }
+
+    private:
+      static constexpr Size NUMBER_OF_SHARDS = 64;
+      static constexpr Size MAX_SHARD_SIZE = 16384; // approx. one million sequences in total
+
+      struct Shard
+      {
+        std::mutex mutex;
+        std::unordered_map<String, AASequence> sequences[2]; // not permissive / permissive
+      };
+
+      std::array<Shard, NUMBER_OF_SHARDS> shards_;
+    };
+  }
+
+  AASequence AASequence::fromStringCached(const String& s, bool permissive)
+  {
+    static AASequenceParseCache cache;
+    return cache.get(s, permissive);
+  }
+
 }
@@ -22,6 +22,7 @@ namespace OpenMS
     mods_.clear();
     modification_names_.clear();
     readFromOBOFile("CHEMISTRY/XLMOD.obo"); //TODO please comment why this is needed! Why not use the one from ModificationsDB
+    buildIndices_();
   }
 
 
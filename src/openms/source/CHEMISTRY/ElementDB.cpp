@@ -54,16 +54,21 @@ namespace OpenMS
 
   const Element* ElementDB::getElement(const string& name) const
   {
-    if (auto entry = symbols_.find(name); entry != symbols_.end())
+    if (const Size index = symbolIndex_(name); index < symbol_table_.size())
+    {
+      // symbol_table_ holds all short symbols, no need to search symbols_
+      if (symbol_table_[index] != nullptr)
+      {
+        return symbol_table_[index];
+      }
+    }
+    else if (auto entry = symbols_.find(name); entry != symbols_.end())
     {
       return entry->second;
     }
-    else
+    if (auto entry = names_.find(name); entry != names_.end())
     {
-      if (auto entry = names_.find(name); entry != names_.end())
-      {
-        return entry->second;
-      }
+      return entry->second;
     }
     return nullptr;
   }
@@ -99,6 +104,39 @@ namespace OpenMS
       throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("Element with atomic number ") + an + " already exists");
     }
     buildElement_(name, symbol, an, abundance, mass);
+    updateSymbolTable_();
+  }
+
+  Size ElementDB::symbolIndex_(const string& symbol)
+  {
+    // upper case letter, optionally followed by a lower case letter
+    const Size not_found = 26 * 27;
+    if (symbol.empty() || symbol.size() > 2 || symbol[0] < 'A' || symbol[0] > 'Z')
+    {
+      return not_found;
+    }
+    Size index = Size(symbol[0] - 'A') * 27;
+    if (symbol.size() == 2)
+    {
+      if (symbol[1] < 'a' || symbol[1] > 'z')
+      {
+        return not_found;
+      }
+      index += Size(symbol[1] - 'a') + 1;
+    }
+    return index;
+  }
+
+  void ElementDB::updateSymbolTable_()
+  {
+    symbol_table_.fill(nullptr);
+    for (const auto& entry : symbols_)
+    {
+      if (const Size index = symbolIndex_(entry.first); index < symbol_table_.size())
+      {
+        symbol_table_[index] = entry.second;
+      }
+    }
   }
 
   double ElementDB::calculateAvgWeight_(const map<unsigned int, double>& abundance, const map<unsigned int, double>& mass)
@@ -585,6 +623,7 @@ namespace OpenMS
     symbols_["D"] = deuterium;
     const Element* tritium = getElement("(3)H");
     symbols_["T"] = tritium;
+    updateSymbolTable_();
 
     // Pu, Am, Cm, Bk, Cf, Es, Fm, Md, No, Lr, Rf, Db, Sg, Bh, Hs, Mt, Ds, Rg, Cn, Nh, Fl, Mc, Lv, Ts and Og Abundances are not known.
 
@@ -699,6 +738,7 @@ namespace OpenMS
     names_.clear();
     symbols_.clear();
     atomic_numbers_.clear();
+    symbol_table_.fill(nullptr);
   }
 
 } // namespace OpenMS
@@ -80,32 +80,29 @@ namespace OpenMS
   /// Convert an OpenMS EmpiricalFormula to the input format for IsoSpec
   Iso _OMS_IsoFromEmpiricalFormula(const EmpiricalFormula& formula) 
   {
-    // Use our own isotopic tables
+    // Use our own isotopic tables, stored consecutively for all elements
+    // (avoids one allocation per element, IsoSpec copies the tables)
     std::vector<int> isotopeNumbers, atomCounts;
-    std::vector<std::vector<double> > isotopeMasses, isotopeProbabilities;
+    std::vector<double> isotopeMasses, isotopeProbabilities;
 
     // Iterate through all elements in the molecular formula
     for (const auto& elem : formula)
     {
       atomCounts.push_back(elem.second);
 
-      std::vector<double> masses;
-      std::vector<double> probs;
+      // For each element store how many isotopes it has and their masses/probabilities
+      int nr_isotopes = 0;
       for (const auto& iso : elem.first->getIsotopeDistribution())
       {
         if (iso.getIntensity() <= 0.0) continue; // Note: there will be a segfault if one of the intensities is zero!
-        masses.push_back(iso.getMZ());
-        probs.push_back(iso.getIntensity());
+        isotopeMasses.push_back(iso.getMZ());
+        isotopeProbabilities.push_back(iso.getIntensity());
+        ++nr_isotopes;
       }
-
-      // For each element store how many isotopes it has and their masses/probabilities
-      isotopeNumbers.push_back( masses.size() );
-      isotopeMasses.push_back(masses);
-      isotopeProbabilities.push_back(probs);
+      isotopeNumbers.push_back(nr_isotopes);
     }
 
-    // Store the data in a IsotopeDistribution
-    return _OMS_IsoFromParameters(isotopeNumbers, atomCounts, isotopeMasses, isotopeProbabilities);
+    return Iso(isotopeNumbers.size(), isotopeNumbers.data(), atomCounts.data(), isotopeMasses.data(), isotopeProbabilities.data());
   }
 
   IsoSpecThresholdGeneratorWrapper::IsoSpecThresholdGeneratorWrapper(const std::vector<int>& isotopeNr,
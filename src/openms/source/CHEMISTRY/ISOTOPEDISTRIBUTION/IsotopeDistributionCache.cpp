@@ -0,0 +1,171 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Rost $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/IsotopeDistributionCache.h>
+
+#include <OpenMS/CHEMISTRY/Element.h>
+#include <OpenMS/CHEMISTRY/EmpiricalFormula.h>
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/FineIsotopePatternGenerator.h>
+
+#include <algorithm>
+
+namespace OpenMS
+{
+  namespace
+  {
+    const Size MAX_SHARDS = 64;
+
+    template <typename T>
+    void appendBytes(std::string& key, const T& value)
+    {
+      key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+  }
+
+  IsotopeDistributionCache::IsotopeDistributionCache(Size max_entries) :
+    shards_(MAX_SHARDS),
+    nr_shards_(1),
+    max_entries_(0),
+    max_entries_per_shard_(0),
+    hits_(0),
+    misses_(0)
+  {
+    setMaxEntries(max_entries);
+  }
+
+  IsotopeDistributionCache& IsotopeDistributionCache::getInstance()
+  {
+    static IsotopeDistributionCache instance;
+    return instance;
+  }
+
+  IsotopeDistributionCache::Key IsotopeDistributionCache::makeKey_(const EmpiricalFormula& formula, const FineIsotopePatternGenerator& generator)
+  {
+    Key key;
+    appendBytes(key, generator.getThreshold());
+    appendBytes(key, generator.getTotalProbability());
+    appendBytes(key, generator.getAbsolute());
+    // elements are identified by their isotopes, entries stay correct if an element of the ElementDB is changed
+    for (const auto& element : formula)
+    {
+      appendBytes(key, element.second);
+      const IsotopeDistribution& isotopes = element.first->getIsotopeDistribution();
+      appendBytes(key, isotopes.size());
+      for (const Peak1D& isotope : isotopes)
+      {
+        appendBytes(key, isotope.getMZ());
+        appendBytes(key, isotope.getIntensity());
+      }
+    }
+    return key;
+  }
+
+  IsotopeDistributionCache::DistributionPtr IsotopeDistributionCache::get(const EmpiricalFormula& formula, const FineIsotopePatternGenerator& generator)
+  {
+    FineIsotopePatternGenerator uncached(generator);
+    uncached.setCaching(false);
+    if (max_entries_per_shard_ == 0)
+    {
+      ++misses_;
+      return std::make_shared<const IsotopeDistribution>(uncached.run(formula));
+    }
+
+    Key key = makeKey_(formula, generator);
+    Shard& shard = shards_[std::hash<Key>()(key) % nr_shards_];
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto it = shard.entries.find(key);
+      if (it != shard.entries.end())
+      {
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second.second);
+        ++hits_;
+        return it->second.first;
+      }
+    }
+    ++misses_;
+
+    // compute outside of the lock, other threads can use the shard in the meantime
+    DistributionPtr result = std::make_shared<const IsotopeDistribution>(uncached.run(formula));
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end())
+    {
+      // another thread was faster, keep its distribution
+      return it->second.first;
+    }
+    trim_(shard, max_entries_per_shard_ - 1);
+    shard.lru.push_front(key);
+    shard.entries.emplace(std::move(key), std::make_pair(result, shard.lru.begin()));
+    return result;
+  }
+
+  void IsotopeDistributionCache::trim_(Shard& shard, Size max_entries)
+  {
+    while (shard.entries.size() > max_entries)
+    {
+      shard.entries.erase(shard.lru.back());
+      shard.lru.pop_back();
+    }
+  }
+
+  void IsotopeDistributionCache::setMaxEntries(Size max_entries)
+  {
+    Size nr_shards = std::max<Size>(1, std::min<Size>(MAX_SHARDS, max_entries / MIN_ENTRIES_PER_SHARD));
+    // never hold more than max_entries distributions in total
+    Size max_entries_per_shard = max_entries / nr_shards;
+    for (Shard& shard : shards_)
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      // entries are assigned to shards by the number of shards, redistributing them is not worth it
+      trim_(shard, nr_shards == nr_shards_ ? max_entries_per_shard : 0);
+    }
+    nr_shards_ = nr_shards;
+    max_entries_ = max_entries;
+    max_entries_per_shard_ = max_entries_per_shard;
+  }
+
+  Size IsotopeDistributionCache::getMaxEntries() const
+  {
+    return max_entries_;
+  }
+
+  Size IsotopeDistributionCache::getHits() const
+  {
+    return hits_;
+  }
+
+  Size IsotopeDistributionCache::getMisses() const
+  {
+    return misses_;
+  }
+
+  Size IsotopeDistributionCache::size() const
+  {
+    Size n = 0;
+    for (const Shard& shard : shards_)
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      n += shard.entries.size();
+    }
+    return n;
+  }
+
+  void IsotopeDistributionCache::clear()
+  {
+    for (Shard& shard : shards_)
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.entries.clear();
+      shard.lru.clear();
+    }
+    hits_ = 0;
+    misses_ = 0;
+  }
+
+} // namespace OpenMS
@@ -16,6 +16,7 @@
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/CONCEPT/Macros.h>
 
+#include <algorithm>
 #include <fstream>
 #include <limits>
 #include <utility>
@@ -92,6 +93,8 @@ namespace OpenMS
     {
       readFromOBOFile(xlmod_file);
     }
+    buildIndices_();
+    constructed_ = true;
     is_instantiated_ = true;
   }
 
@@ -102,6 +105,10 @@ namespace OpenMS
     {
       delete *it;
     }
+    for (auto* mod : runtime_mods_)
+    {
+      delete mod;
+    }
   }
 
   bool ModificationsDB::isInstantiated()
@@ -109,17 +116,129 @@ namespace OpenMS
     return is_instantiated_;
   }
 
+  template <typename FunctionType>
+  void ModificationsDB::forEachPart_(FunctionType&& f) const
+  {
+    // the frozen part is only changed by freeze() (and during construction)
+    f(mods_, modification_names_, Size(0));
+    if (has_runtime_mods_.load(std::memory_order_acquire))
+    {
+      #pragma omp critical(OpenMS_ModificationsDB)
+      {
+        f(runtime_mods_, runtime_modification_names_, mods_.size());
+      }
+    }
+  }
+
+  namespace
+  {
+    /// record id of a UniMod accession in canonical form ("UniMod:<id>"), 0 for all other strings
+    Size parseUniModRecordId(const String& name)
+    {
+      static const std::string prefix = "UniMod:";
+      if (name.size() <= prefix.size() || name.size() > prefix.size() + 9 ||
+          name.compare(0, prefix.size(), prefix) != 0 || name[prefix.size()] == '0')
+      {
+        return 0;
+      }
+      Size id = 0;
+      for (Size i = prefix.size(); i < name.size(); ++i)
+      {
+        if (name[i] < '0' || name[i] > '9')
+        {
+          return 0;
+        }
+        id = id * 10 + (name[i] - '0');
+      }
+      return id;
+    }
+  }
+
+  const set<const ResidueModification*>* ModificationsDB::findByName_(const unordered_map<String, set<const ResidueModification*> >& names, const String& mod_name) const
+  {
+    if (&names == &modification_names_ && !unimod_index_.empty())
+    {
+      if (const Size id = parseUniModRecordId(mod_name); id > 0)
+      {
+        // unimod_index_ contains all UniMod accessions of the frozen part
+        return id < unimod_index_.size() ? unimod_index_[id] : nullptr;
+      }
+    }
+    auto it = names.find(mod_name);
+    return it == names.end() ? nullptr : &it->second;
+  }
+
+  void ModificationsDB::buildIndices_()
+  {
+    unimod_index_.clear();
+    for (const auto& entry : modification_names_)
+    {
+      if (const Size id = parseUniModRecordId(entry.first); id > 0)
+      {
+        if (id >= unimod_index_.size())
+        {
+          unimod_index_.resize(id + 1, nullptr);
+        }
+        unimod_index_[id] = &entry.second;
+      }
+    }
+
+    mass_index_.clear();
+    for (auto& by_origin : mass_index_by_origin_)
+    {
+      by_origin.clear();
+    }
+    for (Size i = 0; i < mods_.size(); ++i)
+    {
+      const auto entry = make_pair(mods_[i]->getDiffMonoMass(), i);
+      mass_index_.push_back(entry);
+      mass_index_by_origin_[static_cast<unsigned char>(mods_[i]->getOrigin())].push_back(entry);
+    }
+    sort(mass_index_.begin(), mass_index_.end());
+    for (auto& by_origin : mass_index_by_origin_)
+    {
+      sort(by_origin.begin(), by_origin.end());
+    }
+  }
+
+  void ModificationsDB::freeze()
+  {
+    #pragma omp critical(OpenMS_ModificationsDB)
+    {
+      mods_.insert(mods_.end(), runtime_mods_.begin(), runtime_mods_.end());
+      for (const auto& entry : runtime_modification_names_)
+      {
+        modification_names_[entry.first].insert(entry.second.begin(), entry.second.end());
+      }
+      runtime_mods_.clear();
+      runtime_modification_names_.clear();
+      has_runtime_mods_.store(false, std::memory_order_release);
+      buildIndices_();
+    }
+  }
+
+  const ResidueModification* ModificationsDB::addRuntimeModification_(ResidueModification* new_mod)
+  {
+    runtime_modification_names_[new_mod->getFullId()].insert(new_mod);
+    runtime_modification_names_[new_mod->getId()].insert(new_mod);
+    runtime_modification_names_[new_mod->getFullName()].insert(new_mod);
+    runtime_modification_names_[new_mod->getUniModAccession()].insert(new_mod);
+    runtime_mods_.push_back(new_mod);
+    has_runtime_mods_.store(true, std::memory_order_release);
+    return new_mod;
+  }
+
   Size ModificationsDB::getNumberOfModifications() const
   {
     Size s;
     #pragma omp critical (OpenMS_ModificationsDB)
     {
-      s = mods_.size();
+      s = mods_.size() + runtime_mods_.size();
     }
     return s;
   }
 
-  const ResidueModification* ModificationsDB::searchModificationsFast(const String& mod_name_,
+  const ResidueModification* ModificationsDB::searchModificationsFast(const String& mod_name,
                                                                       bool& multiple_matches,
                                                                       const String& residue,
                                                                       ResidueModification::TermSpecificity term_spec
@@ -127,48 +246,48 @@ namespace OpenMS
   {
     const ResidueModification* mod(nullptr);
 
-    String mod_name = mod_name_;
     multiple_matches = false;
 
     char res = '?'; // empty
     if (!residue.empty()) res = residue[0];
 
-    #pragma omp critical(OpenMS_ModificationsDB)
+    // Try to fix things, Skyline for example uses unimod:10 and not UniMod:10 syntax
+    String fixed_name;
+    if (mod_name.size() > 6 && String(mod_name.prefix(6)).toLower() == "unimod")
     {
-      bool found = true;
-      auto modifications = modification_names_.find(mod_name);
-      if (modifications == modification_names_.end())
-      {
-        // Try to fix things, Skyline for example uses unimod:10 and not UniMod:10 syntax
-        if (mod_name.size() > 6 && mod_name.prefix(6).toLower() == "unimod")
-        {
-          mod_name = "UniMod" + mod_name.substr(6, mod_name.size() - 6);
-        }
+      fixed_name = "UniMod" + mod_name.substr(6, mod_name.size() - 6);
+    }
 
-        modifications = modification_names_.find(mod_name);
-        if (modifications == modification_names_.end())
-        {
-          OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << mod_name << endl;
-          found = false; 
-        }
+    bool found = false;
+    int nr_mods = 0;
+    forEachPart_([&](const auto&, const auto& names, Size)
+    {
+      const auto* modifications = findByName_(names, mod_name);
+      if (modifications == nullptr && !fixed_name.empty())
+      {
+        modifications = findByName_(names, fixed_name);
       }
-
-      int nr_mods = 0;
-      if (found)
+      if (modifications == nullptr)
+      {
+        return;
+      }
+      found = true;
+      for (const auto& it : *modifications)
       {
-        for (const auto& it : modifications->second)
+        if ( residuesMatch_(res, it) &&
+             (term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY ||
+             (term_spec == it->getTermSpecificity())))
         {
-          if ( residuesMatch_(res, it) &&
-               (term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY ||
-               (term_spec == it->getTermSpecificity())))
-          {
-            mod = it;
-            nr_mods++;
-          }
+          mod = it;
+          nr_mods++;
         }
       }
-      if (nr_mods > 1) multiple_matches = true;
+    });
+    if (!found)
+    {
+      OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << (fixed_name.empty() ? mod_name : fixed_name) << endl;
     }
+    if (nr_mods > 1) multiple_matches = true;
     return mod;
   }
 
@@ -178,83 +297,90 @@ namespace OpenMS
 
     const String& mod_name = mod_in.getFullId();
 
-    #pragma omp critical(OpenMS_ModificationsDB)
+    bool found = false;
+    forEachPart_([&](const auto&, const auto& names, Size)
     {
-      bool found = true;
-      auto modifications = modification_names_.find(mod_name);
-
-      if (modifications == modification_names_.end())
+      const auto* modifications = findByName_(names, mod_name);
+      if (modifications == nullptr)
       {
-        OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << mod_name << endl;
-        found = false; 
+        return;
       }
-
-      if (found)
+      found = true;
+      for (const auto& mod_indb : *modifications)
       {
-        for (const auto& mod_indb : modifications->second)
+        if (mod == nullptr && mod_in == *mod_indb)
         {
-          if (mod_in == *mod_indb)
-          {
-            mod = mod_indb;
-            break;
-          }
+          mod = mod_indb;
+          break;
         }
       }
+    });
+    if (!found)
+    {
+      OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << mod_name << endl;
     }
     return mod;
   }
 
   const ResidueModification* ModificationsDB::getModification(Size index) const
   {
-    OPENMS_PRECONDITION(index < mods_.size(), "Index out of bounds in ModificationsDB::getModification(Size index)." );
-    return mods_[index];
+    OPENMS_PRECONDITION(index < getNumberOfModifications(), "Index out of bounds in ModificationsDB::getModification(Size index)." );
+    if (index < mods_.size())
+    {
+      return mods_[index];
+    }
+    const ResidueModification* mod(nullptr);
+    #pragma omp critical(OpenMS_ModificationsDB)
+    {
+      mod = runtime_mods_[index - mods_.size()];
+    }
+    return mod;
   }
 
   void ModificationsDB::searchModifications(set<const ResidueModification*>& mods,
-                                            const String& mod_name_,
+                                            const String& mod_name,
                                             const String& residue,
                                             ResidueModification::TermSpecificity term_spec) const
   {
     mods.clear();
 
-    String mod_name = mod_name_;
-
     char res = '?'; // empty
     if (!residue.empty()) res = residue[0];
 
-    #pragma omp critical(OpenMS_ModificationsDB)
+    // Try to fix things, Skyline for example uses unimod:10 and not UniMod:10 syntax
+    String fixed_name;
+    if (mod_name.size() > 6 && String(mod_name.prefix(6)).toLower() == "unimod")
     {
-      bool found = true;
-      auto modifications = modification_names_.find(mod_name);
-      if (modifications == modification_names_.end())
-      {
-        // Try to fix things, Skyline for example uses unimod:10 and not UniMod:10 syntax
-        if (mod_name.size() > 6 && mod_name.prefix(6).toLower() == "unimod")
-        {
-          mod_name = "UniMod" + mod_name.substr(6, mod_name.size() - 6);
-        }
+      fixed_name = "UniMod" + mod_name.substr(6, mod_name.size() - 6);
+    }
 
-        modifications = modification_names_.find(mod_name);
-        if (modifications == modification_names_.end())
-        {
-          OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << mod_name << endl;
-          found = false; 
-        }
+    bool found = false;
+    forEachPart_([&](const auto&, const auto& names, Size)
+    {
+      const auto* modifications = findByName_(names, mod_name);
+      if (modifications == nullptr && !fixed_name.empty())
+      {
+        modifications = findByName_(names, fixed_name);
       }
-
-      if (found)
+      if (modifications == nullptr)
+      {
+        return;
+      }
+      found = true;
+      for (const auto& it : *modifications)
       {
-        for (const auto& it : modifications->second)
+        if ( residuesMatch_(res, it) &&
+             (term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY ||
+             (term_spec == it->getTermSpecificity())))
         {
-          if ( residuesMatch_(res, it) &&
-               (term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY ||
-               (term_spec == it->getTermSpecificity())))
-          {
-            mods.insert(it);
-          }
+          mods.insert(it);
         }
       }
-    } 
+    });
+    if (!found)
+    {
+      OPENMS_LOG_WARN << OPENMS_PRETTY_FUNCTION << "Modification not found: " << (fixed_name.empty() ? mod_name : fixed_name) << endl;
+    }
   }
 
   const ResidueModification* ModificationsDB::getModification(const String& mod_name, const String& residue, ResidueModification::TermSpecificity term_spec) const
@@ -291,47 +417,46 @@ namespace OpenMS
 
   bool ModificationsDB::has(const String & modification) const
   {
-    bool has_mod;
-    #pragma omp critical(OpenMS_ModificationsDB)
+    bool has_mod = false;
+    forEachPart_([&](const auto&, const auto& names, Size)
     {
-      has_mod = (modification_names_.find(modification) != modification_names_.end());
-    }
+      has_mod = has_mod || (findByName_(names, modification) != nullptr);
+    });
     return has_mod;
   }
 
   Size ModificationsDB::findModificationIndex(const String & mod_name) const
   {
-    if (!has(mod_name))
-    {
-      throw Exception::ElementNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Modification not found: " + mod_name);
-    }
-
-    bool one_mod(true);
-    #pragma omp critical(OpenMS_ModificationsDB)
+    Size nr_mods(0);
+    const ResidueModification* mod(nullptr);
+    forEachPart_([&](const auto&, const auto& names, Size)
     {
-      if (modification_names_.find(mod_name)->second.size() > 1)
+      if (const auto* modifications = findByName_(names, mod_name))
       {
-        one_mod = false;
+        nr_mods += modifications->size();
+        if (mod == nullptr) mod = *modifications->begin();
       }
+    });
+    if (nr_mods == 0)
+    {
+      throw Exception::ElementNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Modification not found: " + mod_name);
     }
-    if (!one_mod) 
+    if (nr_mods > 1) 
     {
       throw Exception::ElementNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "More than one modification with name: " + mod_name);
     }
 
     Size index(numeric_limits<Size>::max());
-    #pragma omp critical(OpenMS_ModificationsDB)
+    forEachPart_([&](const auto& mods, const auto&, Size offset)
     {
-      const ResidueModification* mod = *(modification_names_.find(mod_name)->second.begin());
-      for (Size i = 0; i != mods_.size(); ++i)
+      for (Size i = 0; index == numeric_limits<Size>::max() && i != mods.size(); ++i)
       {
-        if (mods_[i] == mod)
+        if (mods[i] == mod)
         {
-          index = i;
-          break;
+          index = offset + i;
         }
       }
-    }
+    });
 
     if (index == numeric_limits<Size>::max())
     {
@@ -340,96 +465,103 @@ namespace OpenMS
     return index;
   }
 
-  void ModificationsDB::searchModificationsByDiffMonoMass(vector<String>& mods, double mass, double max_error, const String& residue, ResidueModification::TermSpecificity term_spec)
+  void ModificationsDB::searchByDiffMonoMass_(vector<const ResidueModification*>& mods, double mass, double max_error, char res, ResidueModification::TermSpecificity term_spec) const
   {
     mods.clear();
-    char res = '?'; // empty
-    if (!residue.empty()) res = residue[0];
-    #pragma omp critical(OpenMS_ModificationsDB)
+    auto matches = [&](const ResidueModification* m)
+    {
+      return (fabs(m->getDiffMonoMass() - mass) <= max_error) &&
+             residuesMatch_(res, m) &&
+             ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
+              (term_spec == m->getTermSpecificity()));
+    };
+
+    // frozen part: binary search in the mass indices (of all modifications or of the ones that can match the residue)
+    vector<Size> indices;
+    auto collect = [&](const vector<pair<double, Size> >& mass_index)
     {
-      for (auto const & m : mods_)
+      // slightly larger window, the exact criterion is checked by matches()
+      const double tolerance = max_error + 1e-6;
+      auto it = lower_bound(mass_index.begin(), mass_index.end(), make_pair(mass - tolerance, Size(0)));
+      for (; it != mass_index.end() && it->first <= mass + tolerance; ++it)
       {
-        if ((fabs(m->getDiffMonoMass() - mass) <= max_error) &&
-            residuesMatch_(res, m) &&
-            ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
-             (term_spec == m->getTermSpecificity())))
-        {
-          mods.push_back(m->getFullId());
-        }
+        if (matches(mods_[it->second])) indices.push_back(it->second);
+      }
+    };
+    if (mass_index_.size() != mods_.size()) // indices not built yet (during construction)
+    {
+      for (Size i = 0; i < mods_.size(); ++i)
+      {
+        if (matches(mods_[i])) indices.push_back(i);
       }
     }
-  }
+    else if (res == 'X' || res == '.' || res == '?')
+    {
+      collect(mass_index_);
+    }
+    else
+    {
+      collect(mass_index_by_origin_[static_cast<unsigned char>(res)]);
+      collect(mass_index_by_origin_[static_cast<unsigned char>('X')]);
+    }
+    // report in order of appearance in the DB
+    sort(indices.begin(), indices.end());
+    for (Size i : indices)
+    {
+      mods.push_back(mods_[i]);
+    }
 
-  void ModificationsDB::searchModificationsByDiffMonoMass(vector<const ResidueModification*>& mods, double mass, double max_error, const String& residue, ResidueModification::TermSpecificity term_spec)
-  {
-    mods.clear();
-    char res = '?'; // empty
-    if (!residue.empty()) res = residue[0];
-    #pragma omp critical(OpenMS_ModificationsDB)
+    if (has_runtime_mods_.load(std::memory_order_acquire))
     {
-      for (auto const & m : mods_)
+      #pragma omp critical(OpenMS_ModificationsDB)
       {
-        if ((fabs(m->getDiffMonoMass() - mass) <= max_error) &&
-            residuesMatch_(res, m) &&
-            ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
-             (term_spec == m->getTermSpecificity())))
+        for (auto const & m : runtime_mods_)
         {
-          mods.push_back(m);
+          if (matches(m)) mods.push_back(m);
         }
       }
     }
   }
 
-  void ModificationsDB::searchModificationsByDiffMonoMassSorted(vector<String>& mods, double mass, double max_error, const String& residue, ResidueModification::TermSpecificity term_spec)
+  void ModificationsDB::searchModificationsByDiffMonoMass(vector<String>& mods, double mass, double max_error, const String& residue, ResidueModification::TermSpecificity term_spec)
   {
     mods.clear();
-    std::map<std::pair<double,Size>, const String&> diff_idx2mods;
-    char res = '?'; // empty
-    if (!residue.empty()) res = residue[0];
-    double diff = 0;
-    Size cnt = 0;
-    #pragma omp critical(OpenMS_ModificationsDB)
+    vector<const ResidueModification*> found;
+    searchModificationsByDiffMonoMass(found, mass, max_error, residue, term_spec);
+    for (auto const & m : found)
     {
-      for (auto const & m : mods_)
-      {
-        diff = fabs(m->getDiffMonoMass() - mass);
-        if ((diff <= max_error) &&
-            residuesMatch_(res, m) &&
-            ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
-             (term_spec == m->getTermSpecificity())))
-        {
-          diff_idx2mods.emplace(make_pair(diff, cnt++), m->getFullId());
-        }
-      }
+      mods.push_back(m->getFullId());
     }
-    for (const auto& foo_mod : diff_idx2mods)
+  }
+
+  void ModificationsDB::searchModificationsByDiffMonoMass(vector<const ResidueModification*>& mods, double mass, double max_error, const String& residue, ResidueModification::TermSpecificity term_spec)
+  {
+    char res = '?'; // empty
+    if (!residue.empty()) res = residue[0];
+    searchByDiffMonoMass_(mods, mass, max_error, res, term_spec);
+  }
+
+  void ModificationsDB::searchModificationsByDiffMonoMassSorted(vector<String>& mods, double mass, double max_error, const String& residue, ResidueModification::TermSpecificity term_spec)
+  {
+    mods.clear();
+    vector<const ResidueModification*> found;
+    searchModificationsByDiffMonoMassSorted(found, mass, max_error, residue, term_spec);
+    for (auto const & m : found)
     {
-      mods.push_back(foo_mod.second);
+      mods.push_back(m->getFullId());
     }
   }
 
   void ModificationsDB::searchModificationsByDiffMonoMassSorted(vector<const ResidueModification*>& mods, double mass, double max_error, const String& residue, ResidueModification::TermSpecificity term_spec)
   {
-    mods.clear();
     std::map<std::pair<double,Size>, const ResidueModification*> diff_idx2mods;
-    char res = '?'; // empty
-    if (!residue.empty()) res = residue[0];
-    double diff = 0;
     Size cnt = 0;
-    #pragma omp critical(OpenMS_ModificationsDB)
+    searchModificationsByDiffMonoMass(mods, mass, max_error, residue, term_spec);
+    for (auto const & m : mods)
     {
-      for (auto const & m : mods_)
-      {
-        diff = fabs(m->getDiffMonoMass() - mass);
-        if ((diff <= max_error) &&
-            residuesMatch_(res, m) &&
-            ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
-             (term_spec == m->getTermSpecificity())))
-        {
-          diff_idx2mods.emplace(make_pair(diff, cnt++), m);
-        }
-      }
+      diff_idx2mods.emplace(make_pair(fabs(m->getDiffMonoMass() - mass), cnt++), m);
     }
+    mods.clear();
     for (const auto& foo_mod : diff_idx2mods)
     {
       mods.push_back(foo_mod.second);
@@ -441,27 +573,18 @@ namespace OpenMS
   {
     double min_error = max_error;
     const ResidueModification* mod = nullptr;
-    char res = '?'; // empty
-    if (!residue.empty())
-    {
-      res = residue[0];
-    }
-    #pragma omp critical(OpenMS_ModificationsDB)
+    vector<const ResidueModification*> found;
+    searchModificationsByDiffMonoMass(found, mass, max_error, residue, term_spec);
+    for (auto const & m : found)
     {
-      for (auto const & m : mods_)
+      // using less instead of less-or-equal will pick the first matching
+      // modification of equally heavy modifications (in our case this is the
+      // first matching UniMod entry)
+      double mass_error = fabs(m->getDiffMonoMass() - mass);
+      if (mass_error < min_error)
       {
-        // using less instead of less-or-equal will pick the first matching
-        // modification of equally heavy modifications (in our case this is the
-        // first matching UniMod entry)
-        double mass_error = fabs(m->getDiffMonoMass() - mass);
-        if ((mass_error < min_error) &&
-            residuesMatch_(res, m) &&
-            ((term_spec == ResidueModification::NUMBER_OF_TERM_SPECIFICITY) ||
-             (term_spec == m->getTermSpecificity())))
-        {
-          min_error = mass_error;
-          mod = m;
-        }
+        min_error = mass_error;
+        mod = m;
       }
     }
     return mod;
@@ -479,15 +602,23 @@ namespace OpenMS
 
       #pragma omp critical(OpenMS_ModificationsDB)
       {
-        // e.g. Oxidation (M)
-        modification_names_[m->getFullId()].insert(m);
-        // e.g. Oxidation
-        modification_names_[m->getId()].insert(m);
-        // e.g. Oxidized
-        modification_names_[m->getFullName()].insert(m);
-        // e.g. UniMod:312
-        modification_names_[m->getUniModAccession()].insert(m);
-        mods_.push_back(m);
+        if (constructed_)
+        {
+          // the frozen part is read without locking, add to the runtime part instead
+          addRuntimeModification_(m);
+        }
+        else
+        {
+          // e.g. Oxidation (M)
+          modification_names_[m->getFullId()].insert(m);
+          // e.g. Oxidation
+          modification_names_[m->getId()].insert(m);
+          // e.g. Oxidized
+          modification_names_[m->getFullName()].insert(m);
+          // e.g. UniMod:312
+          modification_names_[m->getUniModAccession()].insert(m);
+          mods_.push_back(m);
+        }
       }
     }
   }
@@ -497,21 +628,16 @@ namespace OpenMS
     const ResidueModification* ret;
     #pragma omp critical(OpenMS_ModificationsDB)
     {
-      auto it = modification_names_.find(new_mod->getFullId());
-      if (it != modification_names_.end())
+      const auto* existing = findByName_(modification_names_, new_mod->getFullId());
+      if (existing == nullptr) existing = findByName_(runtime_modification_names_, new_mod->getFullId());
+      if (existing != nullptr)
       {
         OPENMS_LOG_WARN << "Modification already exists in ModificationsDB. Skipping." << new_mod->getFullId() << endl;
-        ret = *(it->second.begin()); // returning from omp critical is not allowed
+        ret = *(existing->begin()); // returning from omp critical is not allowed
       }
       else
       {
-        modification_names_[new_mod->getFullId()].insert(new_mod.get());
-        modification_names_[new_mod->getId()].insert(new_mod.get());
-        modification_names_[new_mod->getFullName()].insert(new_mod.get());
-        modification_names_[new_mod->getUniModAccession()].insert(new_mod.get());
-        mods_.push_back(new_mod.get());
-        new_mod.release(); // do not delete the object;
-        ret = mods_.back();
+        ret = addRuntimeModification_(new_mod.release()); // do not delete the object
       }
     }
     return ret;
@@ -519,39 +645,16 @@ namespace OpenMS
 
   const ResidueModification* ModificationsDB::addModification(const ResidueModification& new_mod)
   {
-    const ResidueModification* ret = new ResidueModification(new_mod);
-    #pragma omp critical(OpenMS_ModificationsDB)
-    {
-      auto it = modification_names_.find(new_mod.getFullId());
-      if (it != modification_names_.end())
-      {
-        OPENMS_LOG_WARN << "Modification already exists in ModificationsDB. Skipping." << new_mod.getFullId() << endl;
-        ret = *(it->second.begin()); // returning from omp critical is not allowed
-      }
-      else
-      {
-        modification_names_[ret->getFullId()].insert(ret);
-        modification_names_[ret->getId()].insert(ret);
-        modification_names_[ret->getFullName()].insert(ret);
-        modification_names_[ret->getUniModAccession()].insert(ret);
-        mods_.push_back(const_cast<ResidueModification*>(ret));
-        ret = mods_.back();
-      }
-    }
-    return ret;
+    return addModification(std::make_unique<ResidueModification>(new_mod));
   }
 
   const ResidueModification* ModificationsDB::addNewModification_(const ResidueModification& new_mod)
   {
-    const ResidueModification* ret = new ResidueModification(new_mod);
+    ResidueModification* mod = new ResidueModification(new_mod);
+    const ResidueModification* ret;
     #pragma omp critical(OpenMS_ModificationsDB)
     {
-      modification_names_[ret->getFullId()].insert(ret);
-      modification_names_[ret->getId()].insert(ret);
-      modification_names_[ret->getFullName()].insert(ret);
-      modification_names_[ret->getUniModAccession()].insert(ret);
-      mods_.push_back(const_cast<ResidueModification*>(ret));
-      ret = mods_.back();
+      ret = addRuntimeModification_(mod);
     }
     return ret;
   }
@@ -813,17 +916,25 @@ namespace OpenMS
     // now use the term and all synonyms to build the database
     #pragma omp critical(OpenMS_ModificationsDB)
     {
+      // the frozen part is read without locking, after construction add to the runtime part instead
+      vector<ResidueModification*>& target_mods = constructed_ ? runtime_mods_ : mods_;
+      unordered_map<String, set<const ResidueModification*> >& target_names = constructed_ ? runtime_modification_names_ : modification_names_;
       for (multimap<String, ResidueModification>::const_iterator it = all_mods.begin(); it != all_mods.end(); ++it)
       {
         // check whether a unimod definition already exists, then simply add synonyms to it
         if (it->second.getUniModRecordId() > 0)
         {
           //cerr << "Found UniMod PSI-MOD mapping: " << it->second.getPSIMODAccession() << " " << it->second.getUniModAccession() << endl;
-          set<const ResidueModification*> mods = modification_names_[it->second.getUniModAccession()];
+          set<const ResidueModification*> mods;
+          for (const auto* names : {&modification_names_, &runtime_modification_names_})
+          {
+            auto mod_it = names->find(it->second.getUniModAccession());
+            if (mod_it != names->end()) mods.insert(mod_it->second.begin(), mod_it->second.end());
+          }
           for (set<const ResidueModification*>::const_iterator mit = mods.begin(); mit != mods.end(); ++mit)
           {
             //cerr << "Adding PSIMOD accession: " << it->second.getPSIMODAccession() << " " << it->second.getUniModAccession() << endl;
-            modification_names_[it->second.getPSIMODAccession()].insert(*mit);
+            target_names[it->second.getPSIMODAccession()].insert(*mit);
           }
         }
         else
@@ -834,7 +945,7 @@ namespace OpenMS
              ((it->second.getTermSpecificity() != ResidueModification::ANYWHERE) &&
              (it->second.getDiffMonoMass() != 0)))
           {
-            mods_.push_back(new ResidueModification(it->second));
+            target_mods.push_back(new ResidueModification(it->second));
 
             set<String> synonyms = it->second.getSynonyms();
             synonyms.insert(it->first);
@@ -842,19 +953,23 @@ namespace OpenMS
             //synonyms.insert(it->second.getUniModAccession());
             synonyms.insert(it->second.getPSIMODAccession());
             // full ID is auto-generated based on (short) ID, but we want the name instead:
-            mods_.back()->setId(it->second.getFullName());
-            mods_.back()->setFullId();
-            mods_.back()->setId(it->second.getId());
-            synonyms.insert(mods_.back()->getFullId());
+            target_mods.back()->setId(it->second.getFullName());
+            target_mods.back()->setFullId();
+            target_mods.back()->setId(it->second.getId());
+            synonyms.insert(target_mods.back()->getFullId());
 
             // now check each of the names and link it to the residue modification
             for (set<String>::const_iterator nit = synonyms.begin(); nit != synonyms.end(); ++nit)
             {
-              modification_names_[*nit].insert(mods_.back());
+              target_names[*nit].insert(target_mods.back());
             }
           }
         }
       }
+      if (constructed_ && !runtime_modification_names_.empty())
+      {
+        has_runtime_mods_.store(true, std::memory_order_release);
+      }
     }
   }
 
@@ -862,16 +977,16 @@ namespace OpenMS
   {
     modifications.clear();
 
-    #pragma omp critical(OpenMS_ModificationsDB)
+    forEachPart_([&](const auto& mods, const auto&, Size)
     {
-      for (auto const & m : mods_)
+      for (auto const & m : mods)
       {
         if (m->getUniModRecordId() > 0)
         {
           modifications.push_back(m->getFullId());
         }
       }
-    }
+    });
 
     // sort by name (case INsensitive)
     sort(modifications.begin(), modifications.end(), [&](const String& a, const String& b) {
@@ -896,11 +1011,14 @@ namespace OpenMS
     std::ofstream ofs(filename, std::ofstream::out);
     ofs << "FullId\tFullName\tUnimodAccession\tOrigin/AA\tTerminusSpecificity\tDiffMonoMass\n";
     ResidueModification tmp;
-    for (const auto& mod : mods_)
+    forEachPart_([&](const auto& mods, const auto&, Size)
     {
-      ofs << mod->getFullId() << "\t" << mod->getFullName() << "\t" << mod->getUniModAccession() << "\t" << mod->getOrigin() << "\t"
-      << tmp.getTermSpecificityName(mod->getTermSpecificity()) << "\t"
-      << mod->getDiffMonoMass() << "\n";
-    }
+      for (const auto& mod : mods)
+      {
+        ofs << mod->getFullId() << "\t" << mod->getFullName() << "\t" << mod->getUniModAccession() << "\t" << mod->getOrigin() << "\t"
+        << tmp.getTermSpecificityName(mod->getTermSpecificity()) << "\t"
+        << mod->getDiffMonoMass() << "\n";
+      }
+    });
   }
 } // namespace OpenMS
@@ -44,9 +44,14 @@ namespace OpenMS
       throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "No residue specified.", "");
     }
 
+    // residue_names_ is not changed after construction: no lock required
     const Residue* r{};
-    #pragma omp critical (ResidueDB)
-    {   
+    if (name.size() == 1)
+    {
+      r = residue_by_one_letter_code_[static_cast<unsigned char>(name[0])];
+    }
+    if (r == nullptr)
+    {
       auto it = residue_names_.find(name);
       if (it != residue_names_.end()) 
       { 
@@ -69,12 +74,7 @@ namespace OpenMS
 
   Size ResidueDB::getNumberOfResidues() const
   {
-    Size s;
-    #pragma omp critical (ResidueDB)
-    {
-      s = const_residues_.size();
-    } 
-    return s;
+    return const_residues_.size();
   }
 
   Size ResidueDB::getNumberOfModifiedResidues() const
@@ -90,14 +90,11 @@ namespace OpenMS
   const set<const Residue*> ResidueDB::getResidues(const String& residue_set) const
   {
     set<const Residue*> s;
-    #pragma omp critical (ResidueDB)
+    auto it = residues_by_set_.find(residue_set);
+    if (it != residues_by_set_.end())
     {
-      auto it = residues_by_set_.find(residue_set);
-      if (it != residues_by_set_.end())
-      {
-        s = it->second;
-      }
-    } 
+      s = it->second;
+    }
 
     if (s.empty()) 
     {
@@ -128,21 +125,19 @@ namespace OpenMS
 
   bool ResidueDB::hasResidue(const String& res_name) const
   {
-    bool found = false;
-    #pragma omp critical (ResidueDB)
-    {
-      found = residue_names_.find(res_name) != residue_names_.end();
-    }  
-    return found;
+    return residue_names_.find(res_name) != residue_names_.end();
   }
 
   bool ResidueDB::hasResidue(const Residue* residue) const
   {
+    if (const_residues_.find(residue) != const_residues_.end())
+    {
+      return true;
+    }
     bool found = false;
     #pragma omp critical (ResidueDB)
     {
-      found = (const_residues_.find(residue) != const_residues_.end() ||
-          const_modified_residues_.find(residue) != const_modified_residues_.end());
+      found = const_modified_residues_.find(residue) != const_modified_residues_.end();
     } 
     return found;
   }
@@ -273,12 +268,7 @@ namespace OpenMS
 
   const set<String> ResidueDB::getResidueSets() const
   {
-    set<String> rs;
-    #pragma omp critical (ResidueDB)
-    {
-      rs = residue_sets_; 
-    }
-    return rs;
+    return residue_sets_;
   }
 
   void ResidueDB::addModifiedResidueNames_(const Residue* r)
@@ -314,7 +304,7 @@ namespace OpenMS
       for (const String& m : mod_names)
       {
         if (m.empty()) continue;
-        residue_mod_names_[n][m] = r;
+        runtime_residue_mod_names_[n][m] = r;
       }
     }
   }
@@ -357,102 +347,53 @@ namespace OpenMS
   const Residue* ResidueDB::getModifiedResidue(const Residue* residue, const String& modification)
   {
     OPENMS_PRECONDITION(!modification.empty(), "Modification cannot be empty")
-    // search if the mod already exists
     const String & res_name = residue->getName();
-    Residue* res{};
-    bool residue_found(true), mod_found(true);
-    #pragma omp critical (ResidueDB)
+    // residue_names_ is not changed after construction: no lock required
+    if (residue_names_.find(res_name) == residue_names_.end())
     {
-      // Perform a single lookup of the residue name in our database, we assume
-      // that if it is present in residue_mod_names_ then we have seen it
-      // before and can directly grab it. If its not present, we may have as
-      // unmodified residue in residue_names_ but need to create a new entry as
-      // modified residue. If the residue itself is unknown, we will throw (see
-      // below).
-      const auto& rm_entry = residue_mod_names_.find(res_name);
-      if (rm_entry == residue_mod_names_.end())
-      {
-        if (residue_names_.find(res_name) == residue_names_.end())
-        {
-          residue_found = false;
-        }
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Residue not found: ", res_name);
+    }
 
-      if (residue_found)
+    const ResidueModification* mod{};
+    try
+    {
+      static const ModificationsDB* mdb = ModificationsDB::getInstance();
+      if (modification.hasSubstring("-term "))
       {
-        const ResidueModification* mod{};
-                  
-        try
+        // handle terminal modifications of format: "MOD_NAME (Protein {N|C}-term RESIDUE_NAME)"
+        if (modification.hasSubstring("Protein N-term"))
         {
-          static const ModificationsDB* mdb = ModificationsDB::getInstance();
-          if (modification.hasSubstring("-term "))
-          {
-            // handle terminal modifications of format: "MOD_NAME (Protein {N|C}-term RESIDUE_NAME)"
-            if (modification.hasSubstring("Protein N-term"))
-            {
-              mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::PROTEIN_N_TERM); 
-            } 
-            else if (modification.hasSubstring("Protein C-term"))
-            {
-              mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::PROTEIN_C_TERM); 
-            }
-            // handle terminal modifications of format: "MOD_NAME ({N|C}-term RESIDUE_NAME)"
-            else if (modification.hasSubstring("N-term"))
-            {
-              mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::N_TERM); 
-            } 
-            else if (modification.hasSubstring("C-term"))
-            {
-              mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::C_TERM); 
-            }
-          }
-          else
-          {
-            mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::ANYWHERE);
-          }  
-        }
-        catch (...)
+          mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::PROTEIN_N_TERM); 
+        } 
+        else if (modification.hasSubstring("Protein C-term"))
         {
-          mod_found = false;
+          mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::PROTEIN_C_TERM); 
         }
-
-        // check if modification in ResidueDB
-        if (mod_found)
+        // handle terminal modifications of format: "MOD_NAME ({N|C}-term RESIDUE_NAME)"
+        else if (modification.hasSubstring("N-term"))
         {
-          // check if modified residue is already present in ResidueDB
-          bool found = false;
-          if (rm_entry != residue_mod_names_.end())
-          {
-            const String& id = mod->getId().empty() ? mod->getFullId() : mod->getId();
-            const auto& inner = rm_entry->second.find(id);
-            if (inner != rm_entry->second.end())
-            {
-              res = const_cast<Residue*>(inner->second);
-              found = true;
-            }
-          }
-          if (!found)
-          {
-            // create and register this modified residue
-            res = new Residue(*residue_names_.at(res_name));
-            res->setModification(mod);
-            addResidue_(res);            
-          }
+          mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::N_TERM); 
+        } 
+        else if (modification.hasSubstring("C-term"))
+        {
+          mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::C_TERM); 
         }
       }
+      else
+      {
+        mod = mdb->getModification(modification, residue->getOneLetterCode(), ResidueModification::ANYWHERE);
+      }  
     }
-
-    // throwing (uncaught) exceptions needs to happen outside of critical section (see OpenMP reference manual)
-    if (!residue_found)
+    catch (...)
     {
-      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Residue not found: ", res_name);
+      mod = nullptr;
     }
-    else if (!mod_found)
+    if (mod == nullptr)
     {
       throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Modification not found: ", modification);
     }
-    
-    return res;
+
+    return getOrCreateModifiedResidue_(res_name, mod);
   }
 
   const Residue* ResidueDB::getModifiedResidue(const Residue* residue, const ResidueModification* mod)
@@ -460,62 +401,68 @@ namespace OpenMS
     OPENMS_PRECONDITION(mod != nullptr, "Mod cannot be nullptr")
     OPENMS_PRECONDITION(mod->getTermSpecificity() == ResidueModification::ANYWHERE, "Mod's term specificity needs to be ANYWHERE to attach it to Residues");
     OPENMS_PRECONDITION(mod->getOrigin() == residue->getOneLetterCode()[0], "Mod's AA origin needs to match residues one-letter-code");
-    // search if the mod already exists
     const String & res_name = residue->getName();
-    Residue* res{};
-    bool residue_found(true);
-    #pragma omp critical (ResidueDB)
+    // residue_names_ is not changed after construction: no lock required
+    if (residue_names_.find(res_name) == residue_names_.end())
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Residue not found: ", res_name);
+    }
+    if (mod == nullptr)
     {
-      // Perform a single lookup of the residue name in our database, we assume
-      // that if it is present in residue_mod_names_ then we have seen it
-      // before and can directly grab it. If its not present, we may have as
-      // unmodified residue in residue_names_ but need to create a new entry as
-      // modified residue. If the residue itself is unknown, we will throw (see
-      // below).
-      const auto& rm_entry = residue_mod_names_.find(res_name);
-      if (rm_entry == residue_mod_names_.end())
+      return nullptr;
+    }
+    return getOrCreateModifiedResidue_(res_name, mod);
+  }
+
+  namespace
+  {
+    const Residue* findModifiedResidue(const map<String, map<String, const Residue*> >& residue_mod_names, const String& res_name, const String& mod_name)
+    {
+      const auto rm_entry = residue_mod_names.find(res_name);
+      if (rm_entry == residue_mod_names.end())
       {
-        if (residue_names_.find(res_name) == residue_names_.end())
-        {
-          residue_found = false;
-        }
+        return nullptr;
       }
+      const auto inner = rm_entry->second.find(mod_name);
+      return inner == rm_entry->second.end() ? nullptr : inner->second;
+    }
+  }
 
-      if (residue_found)
-      {
+  const Residue* ResidueDB::getOrCreateModifiedResidue_(const String& res_name, const ResidueModification* mod)
+  {
+    const String& id = mod->getId().empty() ? mod->getFullId() : mod->getId();
+    // residue_mod_names_ is only changed by freeze(): no lock required
+    const Residue* res = findModifiedResidue(residue_mod_names_, res_name, id);
+    if (res != nullptr)
+    {
+      return res;
+    }
 
-        // check if modification in ResidueDB
-        if (mod != nullptr)
-        {
-          // check if modified residue is already present in ResidueDB
-          bool found = false;
-          if (rm_entry != residue_mod_names_.end())
-          {
-            const String& id = mod->getId().empty() ? mod->getFullId() : mod->getId();
-            const auto& inner = rm_entry->second.find(id);
-            if (inner != rm_entry->second.end())
-            {
-              res = const_cast<Residue*>(inner->second);
-              found = true;
-            }
-          }
-          if (!found)
-          {
-            // create and register this modified residue
-            res = new Residue(*residue_names_.at(res_name));
-            res->setModification(mod);
-            addResidue_(res);            
-          }
-        }
+    #pragma omp critical (ResidueDB)
+    {
+      res = findModifiedResidue(runtime_residue_mod_names_, res_name, id);
+      if (res == nullptr)
+      {
+        // create and register this modified residue
+        Residue* new_res = new Residue(*residue_names_.at(res_name));
+        new_res->setModification(mod);
+        addResidue_(new_res);
+        res = new_res;
       }
     }
+    return res;
+  }
 
-    // throwing (uncaught) exceptions needs to happen outside of critical section (see OpenMP reference manual)
-    if (!residue_found)
+  void ResidueDB::freeze()
+  {
+    #pragma omp critical (ResidueDB)
     {
-      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Residue not found: ", res_name);
+      for (const auto& entry : runtime_residue_mod_names_)
+      {
+        // entries of the frozen part take precedence (they were found first by lookups)
+        residue_mod_names_[entry.first].insert(entry.second.begin(), entry.second.end());
+      }
+      runtime_residue_mod_names_.clear();
     }
-    
-    return res;
   }
 }
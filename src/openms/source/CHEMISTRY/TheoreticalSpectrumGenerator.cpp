@@ -21,6 +21,16 @@ using namespace std;
 
 namespace OpenMS
 {
+  namespace
+  {
+    // the formulas of fragment ions repeat across peptides, their fine isotope distributions are cached
+    FineIsotopePatternGenerator cachedFineGenerator(double max_isotope_probability)
+    {
+      FineIsotopePatternGenerator generator(max_isotope_probability);
+      generator.setCaching(true);
+      return generator;
+    }
+  }
 
   TheoreticalSpectrumGenerator::TheoreticalSpectrumGenerator() :
     DefaultParamHandler("TheoreticalSpectrumGenerator")
@@ -400,7 +410,7 @@ namespace OpenMS
     }
     else if (isotope_model_ == 2)
     {
-      dist = f.getIsotopeDistribution(FineIsotopePatternGenerator(max_isotope_probability_));
+      dist = f.getIsotopeDistribution(cachedFineGenerator(max_isotope_probability_));
     }
 
     for (const auto& it : dist)
@@ -513,7 +523,7 @@ namespace OpenMS
         }
         else if (isotope_model_ == 2)
         {
-          dist = loss_ion.getIsotopeDistribution(FineIsotopePatternGenerator(max_isotope_probability_));
+          dist = loss_ion.getIsotopeDistribution(cachedFineGenerator(max_isotope_probability_));
         }
 
         for (const auto& iso : dist)
@@ -820,7 +830,7 @@ namespace OpenMS
       }
       else if (isotope_model_ == 2)
       {
-        dist = formula.getIsotopeDistribution(FineIsotopePatternGenerator(max_isotope_probability_));
+        dist = formula.getIsotopeDistribution(cachedFineGenerator(max_isotope_probability_));
       }
 
       for (IsotopeDistribution::ConstIterator it = dist.begin(); it != dist.end(); ++it)
@@ -860,7 +870,7 @@ namespace OpenMS
       }
       else if (isotope_model_ == 2)
       {
-        dist = ion.getIsotopeDistribution(FineIsotopePatternGenerator(max_isotope_probability_));
+        dist = ion.getIsotopeDistribution(cachedFineGenerator(max_isotope_probability_));
       }
 
       for (IsotopeDistribution::ConstIterator it = dist.begin(); it != dist.end(); ++it)
@@ -900,7 +910,7 @@ namespace OpenMS
       }
       else if (isotope_model_ == 2)
       {
-        dist = ion.getIsotopeDistribution(FineIsotopePatternGenerator(max_isotope_probability_));
+        dist = ion.getIsotopeDistribution(cachedFineGenerator(max_isotope_probability_));
       }
 
       for (IsotopeDistribution::ConstIterator it = dist.begin(); it != dist.end(); ++it)
@@ -924,6 +934,113 @@ namespace OpenMS
     }
   }
 
+  void TheoreticalSpectrumGenerator::getPrefixSuffixMasses(const AASequence& peptide, PrefixSuffixMasses& masses)
+  {
+    const Size n = peptide.size();
+    masses.prefix.resize(n);
+    masses.suffix.resize(n);
+
+    double mass = peptide.hasNTerminalModification() ? peptide.getNTerminalModification()->getDiffMonoMass() : 0.0;
+    for (Size i = 0; i < n; ++i)
+    {
+      mass += peptide[i].getMonoWeight(Residue::Internal);
+      masses.prefix[i] = mass;
+    }
+
+    mass = peptide.hasCTerminalModification() ? peptide.getCTerminalModification()->getDiffMonoMass() : 0.0;
+    for (Size i = 0; i < n; ++i)
+    {
+      mass += peptide[n - 1 - i].getMonoWeight(Residue::Internal);
+      masses.suffix[i] = mass;
+    }
+  }
+
+  void TheoreticalSpectrumGenerator::getFragmentMZs(const PrefixSuffixMasses& masses, Int min_charge, Int max_charge, FragmentBuffer& buffer) const
+  {
+    buffer.mz.clear();
+    buffer.ion.clear();
+    buffer.series.clear();
+
+    // as in addPeaks_(): no fragments of the full peptide
+    const Size n = masses.prefix.size();
+    if (n < 2) return;
+
+    static const double stat_a = Residue::getInternalToAIon().getMonoWeight();
+    static const double stat_b = Residue::getInternalToBIon().getMonoWeight();
+    static const double stat_c = Residue::getInternalToCIon().getMonoWeight();
+    static const double stat_x = Residue::getInternalToXIon().getMonoWeight();
+    static const double stat_y = Residue::getInternalToYIon().getMonoWeight();
+    static const double stat_z = Residue::getInternalToZIon().getMonoWeight();
+    static const double stat_zp1 = Residue::getInternalToZp1Ion().getMonoWeight();
+    static const double stat_zp2 = Residue::getInternalToZp2Ion().getMonoWeight();
+
+    const Size first_prefix = add_first_prefix_ion_ ? 0 : 1;
+    Size total = 0;
+
+    auto addSeries = [&](bool prefix, Residue::ResidueType res_type, double ion_offset, Int charge)
+    {
+      FragmentBuffer::Series s;
+      s.mass = prefix ? masses.prefix.data() : masses.suffix.data();
+      s.pos = prefix ? first_prefix : 0;
+      s.end = n - 1;
+      s.offset = ion_offset + Constants::PROTON_MASS_U * charge;
+      s.charge = charge;
+      s.current_mz = (s.mass[s.pos] + s.offset) / s.charge;
+      s.code = encodeIon(res_type, 0, charge);
+      if (s.pos < s.end)
+      {
+        total += s.end - s.pos;
+        buffer.series.push_back(s);
+      }
+    };
+
+    // same order of ion series as getSpectrum() (relevant for ties)
+    for (Int z = min_charge; z <= max_charge; ++z)
+    {
+      if (add_b_ions_) addSeries(true, Residue::BIon, stat_b, z);
+      if (add_y_ions_) addSeries(false, Residue::YIon, stat_y, z);
+      if (add_a_ions_) addSeries(true, Residue::AIon, stat_a, z);
+      if (add_c_ions_) addSeries(true, Residue::CIon, stat_c, z);
+      if (add_x_ions_) addSeries(false, Residue::XIon, stat_x, z);
+      if (add_z_ions_) addSeries(false, Residue::ZIon, stat_z, z);
+      if (add_zp1_ions_) addSeries(false, Residue::Zp1Ion, stat_zp1, z);
+      if (add_zp2_ions_) addSeries(false, Residue::Zp2Ion, stat_zp2, z);
+    }
+
+    buffer.mz.reserve(total);
+    buffer.ion.reserve(total);
+
+    // k-way merge of the (ascending) ion series; k is small, so a linear scan for the smallest head is fastest
+    std::vector<FragmentBuffer::Series>& series = buffer.series;
+    while (!series.empty())
+    {
+      Size best = 0;
+      for (Size k = 1; k < series.size(); ++k)
+      {
+        if (series[k].current_mz < series[best].current_mz) best = k;
+      }
+      FragmentBuffer::Series& s = series[best];
+      buffer.mz.push_back(s.current_mz);
+      buffer.ion.push_back(s.code | UInt32(s.pos + 1)); // ordinal = number of residues
+      if (++s.pos < s.end)
+      {
+        s.current_mz = (s.mass[s.pos] + s.offset) / s.charge;
+      }
+      else
+      {
+        series.erase(series.begin() + best); // keeps the order of the remaining series
+      }
+    }
+  }
+
+  String TheoreticalSpectrumGenerator::getIonName(UInt32 ion)
+  {
+    String name(Residue::residueTypeToIonLetter(getIonType(ion)));
+    name.reserve(name.size() + 3 + getIonCharge(ion));
+    (name += getIonOrdinal(ion)) += String(Size(getIonCharge(ion)), '+');
+    return name;
+  }
+
   void TheoreticalSpectrumGenerator::updateMembers_()
   {
     add_b_ions_ = param_.getValue("add_b_ions").toBool();
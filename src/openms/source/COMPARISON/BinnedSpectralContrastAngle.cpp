@@ -9,6 +9,8 @@
 
 #include <OpenMS/COMPARISON/BinnedSpectralContrastAngle.h>
 
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
+
 #include <Eigen/Sparse>
 
 using namespace std;
@@ -52,12 +54,26 @@ namespace OpenMS
     OPENMS_PRECONDITION(BinnedSpectrum::isCompatible(spec1, spec2), "Binned spectra have different bin size or spread");
 
     // resulting score standardized to interval [0,1]
-    const double sum1 = spec1.getBins()->dot(*spec1.getBins());
-    const double sum2 = spec2.getBins()->dot(*spec2.getBins());
-    const double numerator = spec1.getBins()->dot(*spec2.getBins());
+    const double sum1 = SpectrumComparisonKernels::sparseDot(*spec1.getBins(), *spec1.getBins());
+    const double sum2 = SpectrumComparisonKernels::sparseDot(*spec2.getBins(), *spec2.getBins());
+    const double numerator = SpectrumComparisonKernels::sparseDot(*spec1.getBins(), *spec2.getBins());
     const double score = numerator / (sqrt(sum1 * sum2));
 
     return score;
   }
+
+  void BinnedSpectralContrastAngle::batchCompare(const BinnedSpectrum& query, const std::vector<const BinnedSpectrum*>& library, std::vector<double>& scores) const
+  {
+    const SpectrumComparisonKernels::DenseBins query_bins(*query.getBins());
+    const double sum1 = SpectrumComparisonKernels::sparseDot(*query.getBins(), *query.getBins());
+    scores.resize(library.size());
+    for (Size k = 0; k < library.size(); ++k)
+    {
+      OPENMS_PRECONDITION(BinnedSpectrum::isCompatible(query, *library[k]), "Binned spectra have different bin size or spread");
+      const double sum2 = SpectrumComparisonKernels::sparseDot(*library[k]->getBins(), *library[k]->getBins());
+      const double numerator = query_bins.dot(*library[k]->getBins());
+      scores[k] = numerator / (sqrt(sum1 * sum2));
+    }
+  }
 }
 
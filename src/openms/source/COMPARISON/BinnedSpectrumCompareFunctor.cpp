@@ -33,4 +33,13 @@ namespace OpenMS
     return *this;
   }
 
+  void BinnedSpectrumCompareFunctor::batchCompare(const BinnedSpectrum& query, const std::vector<const BinnedSpectrum*>& library, std::vector<double>& scores) const
+  {
+    scores.resize(library.size());
+    for (Size i = 0; i < library.size(); ++i)
+    {
+      scores[i] = (*this)(query, *library[i]);
+    }
+  }
+
 }
@@ -14,6 +14,7 @@
 #include <OpenMS/COMPARISON/SpectrumAlignmentScore.h>
 #include <OpenMS/COMPARISON/SteinScottImproveScore.h>
 #include <OpenMS/COMPARISON/PeakAlignment.h>
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
 
 using namespace std;
 
@@ -37,4 +38,30 @@ namespace OpenMS
     return *this;
   }
 
+  void PeakSpectrumCompareFunctor::batchCompare(const PeakSpectrum & query, const std::vector<const PeakSpectrum*> & library, std::vector<double> & scores) const
+  {
+    scores.resize(library.size());
+    for (Size i = 0; i < library.size(); ++i)
+    {
+      scores[i] = (*this)(query, *library[i]);
+    }
+  }
+
+  void PeakSpectrumCompareFunctor::batchCompareViews(const PeakSpectrum & query, const std::vector<SpectrumComparisonKernels::PeakArraysView> & library, std::vector<double> & scores) const
+  {
+    scores.resize(library.size());
+    PeakSpectrum spec;
+    for (Size i = 0; i < library.size(); ++i)
+    {
+      const SpectrumComparisonKernels::PeakArraysView& peaks = library[i];
+      spec.clear(false);
+      spec.reserve(peaks.size());
+      for (Size k = 0; k < peaks.size(); ++k)
+      {
+        spec.emplace_back(peaks.mz[k], peaks.intensity[k]);
+      }
+      scores[i] = (*this)(query, spec);
+    }
+  }
+
 }
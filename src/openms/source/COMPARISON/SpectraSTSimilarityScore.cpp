@@ -8,6 +8,8 @@
 
 #include <OpenMS/COMPARISON/SpectraSTSimilarityScore.h>
 
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
+
 #include <Eigen/Sparse>
 
 using namespace std;
@@ -42,18 +44,23 @@ namespace OpenMS
   double SpectraSTSimilarityScore::operator()(const PeakSpectrum & s1, const PeakSpectrum & s2) const
   {
     // TODO: check if this operator makes sense (as it doesn't allow to fine tune resolution)
-    BinnedSpectrum bin1(s1, 1, false, 1, BinnedSpectrum::DEFAULT_BIN_OFFSET_LOWRES);
-    BinnedSpectrum bin2(s2, 1, false, 1, BinnedSpectrum::DEFAULT_BIN_OFFSET_LOWRES);
-
     // normalized dot product
-    *bin1.getBins() /= bin1.getBins()->norm();
-    *bin2.getBins() /= bin2.getBins()->norm();
-    return bin1.getBins()->dot(*bin2.getBins());
+    return SpectrumComparisonKernels::sparseDot(*binAndNormalize_(s1).getBins(), *binAndNormalize_(s2).getBins());
   }
 
   double SpectraSTSimilarityScore::operator()(const BinnedSpectrum & bin1, const BinnedSpectrum & bin2) const
   {
-    return bin1.getBins()->dot(*bin2.getBins());
+    return SpectrumComparisonKernels::sparseDot(*bin1.getBins(), *bin2.getBins());
+  }
+
+  void SpectraSTSimilarityScore::batchCompare(const PeakSpectrum & query, const std::vector<const PeakSpectrum*> & library, std::vector<double> & scores) const
+  {
+    const SpectrumComparisonKernels::DenseBins query_bins(*binAndNormalize_(query).getBins());
+    scores.resize(library.size());
+    for (Size k = 0; k < library.size(); ++k)
+    {
+      scores[k] = query_bins.dot(*binAndNormalize_(*library[k]).getBins());
+    }
   }
 
   bool SpectraSTSimilarityScore::preprocess(PeakSpectrum & spec,
@@ -91,6 +98,11 @@ namespace OpenMS
   }
 
   BinnedSpectrum SpectraSTSimilarityScore::transform(const PeakSpectrum & spec)
+  {
+    return binAndNormalize_(spec);
+  }
+
+  BinnedSpectrum SpectraSTSimilarityScore::binAndNormalize_(const PeakSpectrum & spec)
   {
     // TODO: resolution seems rather low. Check with current original implementations.
     BinnedSpectrum bin(spec, 1, false, 1, BinnedSpectrum::DEFAULT_BIN_OFFSET_LOWRES);
@@ -112,6 +124,19 @@ namespace OpenMS
     }
   }
 
+  double SpectraSTSimilarityScore::dot_bias(const SpectrumComparisonKernels::DenseBins & query, const SpectrumComparisonKernels::BinsView & library, double dot_product) const
+  {
+    double numerator = query.productNorm(library);
+    if (dot_product != 0)
+    {
+      return (double)numerator / dot_product;
+    }
+    else
+    {
+      return (double)numerator / query.dot(library);
+    }
+  }
+
   double SpectraSTSimilarityScore::delta_D(double top_hit, double runner_up)
   {
     if (top_hit == 0)
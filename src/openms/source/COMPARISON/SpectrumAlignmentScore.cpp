@@ -8,6 +8,8 @@
 
 #include <OpenMS/COMPARISON/SpectrumAlignmentScore.h>
 
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
+
 using namespace std;
 
 namespace OpenMS
@@ -46,18 +48,38 @@ namespace OpenMS
 
   double SpectrumAlignmentScore::operator()(const PeakSpectrum & s1, const PeakSpectrum & s2) const
   {
-    const double tolerance = (double)param_.getValue("tolerance");
-    const bool is_relative_tolerance = param_.getValue("is_relative_tolerance").toBool();
-    const bool use_linear_factor = param_.getValue("use_linear_factor").toBool();
-    const bool use_gaussian_factor = param_.getValue("use_gaussian_factor").toBool();
+    return compare_(s1, SpectrumComparisonKernels::sumOfSquaredIntensities(s1), s2, getAligner_());
+  }
 
-    OPENMS_PRECONDITION(!(use_linear_factor && use_gaussian_factor), "SpectrumAlignmentScore, use either 'use_linear_factor' or 'use_gaussian_factor")
+  void SpectrumAlignmentScore::batchCompare(const PeakSpectrum & query, const std::vector<const PeakSpectrum*> & library, std::vector<double> & scores) const
+  {
+    const SpectrumAlignment aligner = getAligner_();
+    const double sum1 = SpectrumComparisonKernels::sumOfSquaredIntensities(query);
+    scores.resize(library.size());
+    for (Size k = 0; k < library.size(); ++k)
+    {
+      scores[k] = compare_(query, sum1, *library[k], aligner);
+    }
+  }
 
+  SpectrumAlignment SpectrumAlignmentScore::getAligner_() const
+  {
     SpectrumAlignment aligner;
     Param p;
-    p.setValue("tolerance", tolerance);
+    p.setValue("tolerance", param_.getValue("tolerance"));
     p.setValue("is_relative_tolerance", param_.getValue("is_relative_tolerance"));
     aligner.setParameters(p);
+    return aligner;
+  }
+
+  double SpectrumAlignmentScore::compare_(const PeakSpectrum & s1, double sum1, const PeakSpectrum & s2, const SpectrumAlignment & aligner) const
+  {
+    const double tolerance = (double)param_.getValue("tolerance");
+    const bool is_relative_tolerance = param_.getValue("is_relative_tolerance").toBool();
+    const bool use_linear_factor = param_.getValue("use_linear_factor").toBool();
+    const bool use_gaussian_factor = param_.getValue("use_gaussian_factor").toBool();
+
+    OPENMS_PRECONDITION(!(use_linear_factor && use_gaussian_factor), "SpectrumAlignmentScore, use either 'use_linear_factor' or 'use_gaussian_factor")
 
     vector<pair<Size, Size>> alignment;
     aligner.getSpectrumAlignment(alignment, s1, s2);
@@ -65,17 +87,8 @@ namespace OpenMS
     double score(0), sum(0);
     
     // calculate sum of squared intensities
-    double sum1(0);
-    for (auto const & p : s1)
-    { 
-      sum1 += pow(p.getIntensity(), 2);
-    }
+    const double sum2 = SpectrumComparisonKernels::sumOfSquaredIntensities(s2);
 
-    double sum2(0);
-    for (auto const & p : s2)
-    { 
-      sum2 += pow(p.getIntensity(), 2);
-    }
     for (auto const & ap : alignment)
     {
       const double mz_tolerance = is_relative_tolerance ? tolerance * s1[ap.first].getMZ() * 1e-6 : tolerance;
@@ -0,0 +1,188 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
+
+#include <Eigen/Sparse>
+
+namespace OpenMS
+{
+  namespace SpectrumComparisonKernels
+  {
+    PeakArrays::PeakArrays(const PeakSpectrum& spec)
+    {
+      assign(spec);
+    }
+
+    void PeakArrays::assign(const PeakSpectrum& spec)
+    {
+      mz.resize(spec.size());
+      intensity.resize(spec.size());
+      for (Size i = 0; i != spec.size(); ++i)
+      {
+        mz[i] = spec[i].getMZ();
+        intensity[i] = spec[i].getIntensity();
+      }
+    }
+
+    double sumOfIntensities(const PeakArrays& peaks)
+    {
+      double sum(0);
+      for (const Peak1D::IntensityType i : peaks.intensity)
+      {
+        sum += i;
+      }
+      return sum;
+    }
+
+    double sumOfIntensities(const PeakSpectrum& peaks)
+    {
+      double sum(0);
+      for (const Peak1D& p : peaks)
+      {
+        sum += p.getIntensity();
+      }
+      return sum;
+    }
+
+    double sumOfIntensities(const PeakArraysView& peaks)
+    {
+      double sum(0);
+      for (Size i = 0; i != peaks.nr_peaks; ++i)
+      {
+        sum += peaks.intensity[i];
+      }
+      return sum;
+    }
+
+    double sumOfSquaredIntensities(const PeakArrays& peaks)
+    {
+      double sum(0);
+      for (const double i : peaks.intensity)
+      {
+        sum += i * i;
+      }
+      return sum;
+    }
+
+    double sumOfSquaredIntensities(const PeakSpectrum& peaks)
+    {
+      double sum(0);
+      for (const Peak1D& p : peaks)
+      {
+        const double i = p.getIntensity();
+        sum += i * i;
+      }
+      return sum;
+    }
+
+    float sparseDot(const BinnedSpectrum::SparseVectorType& a, const BinnedSpectrum::SparseVectorType& b)
+    {
+      // raw arrays of the (index-sorted) non-zero entries
+      const int* a_index = a.innerIndexPtr();
+      const float* a_value = a.valuePtr();
+      const int* b_index = b.innerIndexPtr();
+      const float* b_value = b.valuePtr();
+      const Size a_size = a.nonZeros();
+      const Size b_size = b.nonZeros();
+
+      float res(0);
+      Size i = 0, j = 0;
+      while (i < a_size && j < b_size)
+      {
+        if (a_index[i] == b_index[j])
+        {
+          res += a_value[i] * b_value[j];
+          ++i;
+          ++j;
+        }
+        else if (a_index[i] < b_index[j])
+        {
+          ++i;
+        }
+        else
+        {
+          ++j;
+        }
+      }
+      return res;
+    }
+
+    DenseBins::DenseBins(const BinnedSpectrum::SparseVectorType& bins)
+    {
+      assign(bins);
+    }
+
+    void DenseBins::assign(const BinnedSpectrum::SparseVectorType& bins)
+    {
+      // reset only what the previous query set
+      for (const Size i : non_zero_)
+      {
+        values_[i] = 0;
+      }
+      non_zero_.clear();
+
+      const int* index = bins.innerIndexPtr();
+      const float* value = bins.valuePtr();
+      const Size size = bins.nonZeros();
+      if (size == 0) return;
+      if (values_.size() <= Size(index[size - 1]))
+      {
+        values_.resize(index[size - 1] + 1, 0);
+      }
+      non_zero_.reserve(size);
+      for (Size k = 0; k != size; ++k)
+      {
+        values_[index[k]] = value[k];
+        non_zero_.push_back(index[k]);
+      }
+    }
+
+    float DenseBins::dot(const BinnedSpectrum::SparseVectorType& bins) const
+    {
+      const int* index = bins.innerIndexPtr();
+      const float* value = bins.valuePtr();
+      const Size size = bins.nonZeros();
+      const Size dense_size = values_.size();
+
+      // bins missing in the query contribute exact zeros (x + 0 == x), so the
+      // result equals the merge in sparseDot()
+      float res(0);
+      for (Size k = 0; k != size && Size(index[k]) < dense_size; ++k)
+      {
+        res += values_[index[k]] * value[k];
+      }
+      return res;
+    }
+  
+    float DenseBins::dot(const BinsView& bins) const
+    {
+      const Size dense_size = values_.size();
+      float res(0);
+      for (Size k = 0; k != bins.nr_bins && Size(bins.index[k]) < dense_size; ++k)
+      {
+        res += values_[bins.index[k]] * bins.value[k];
+      }
+      return res;
+    }
+
+    float DenseBins::productNorm(const BinsView& bins) const
+    {
+      // Eigen sums the squared products of the common bins in index order;
+      // bins missing in the query add exact zeros
+      const Size dense_size = values_.size();
+      float res(0);
+      for (Size k = 0; k != bins.nr_bins && Size(bins.index[k]) < dense_size; ++k)
+      {
+        const float product = values_[bins.index[k]] * bins.value[k];
+        res += product * product;
+      }
+      return std::sqrt(res);
+    }
+  }
+}
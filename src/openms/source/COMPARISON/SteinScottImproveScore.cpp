@@ -8,6 +8,8 @@
 //
 #include <OpenMS/COMPARISON/SteinScottImproveScore.h>
 
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
+
 #include <OpenMS/KERNEL/MSSpectrum.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
@@ -35,10 +37,17 @@ namespace OpenMS
     if (this != &source)
     {
       PeakSpectrumCompareFunctor::operator=(source);
+      updateMembers_();
     }
     return *this;
   }
 
+  void SteinScottImproveScore::updateMembers_()
+  {
+    tolerance_ = (double)param_.getValue("tolerance");
+    threshold_ = (float)param_.getValue("threshold");
+  }
+
   /**
   @brief Similarity pairwise score itself
 
@@ -63,56 +72,39 @@ namespace OpenMS
   */
   double SteinScottImproveScore::operator()(const PeakSpectrum & s1, const PeakSpectrum & s2) const
   {
-    const double epsilon = (double)param_.getValue("tolerance");
-    const double constant = epsilon / 10000;
-
-    //const double c(0.0004);
-    double score(0), sum(0), sum1(0), sum2(0), sum3(0), sum4(0);
-    /* std::cout << s1 << std::endl;
-    std::cout << std::endl;
-    std::cout << s2 << std::endl;*/
+    const SpectrumComparisonKernels::PeakArrays p1(s1);
+    return compare_(p1, SpectrumComparisonKernels::sumOfSquaredIntensities(p1), SpectrumComparisonKernels::sumOfIntensities(p1), s2);
+  }
 
-    for (const Peak1D& it1 : s1)
+  void SteinScottImproveScore::batchCompare(const PeakSpectrum & query, const std::vector<const PeakSpectrum*> & library, std::vector<double> & scores) const
+  {
+    const SpectrumComparisonKernels::PeakArrays q(query);
+    const double sum_squared = SpectrumComparisonKernels::sumOfSquaredIntensities(q);
+    const double sum = SpectrumComparisonKernels::sumOfIntensities(q);
+    scores.resize(library.size());
+    for (Size k = 0; k < library.size(); ++k)
     {
-      double temp = it1.getIntensity();
-      sum1 += temp * temp;
-      sum3 += temp;
+      scores[k] = compare_(q, sum_squared, sum, *library[k]);
     }
+  }
 
-    for (const Peak1D& it1 : s2)
-    {
-      double temp = it1.getIntensity();
-      sum2 += temp * temp;
-      sum4 += temp;
-    }
-    double z = constant * (sum3 * sum4);
-    Size j_left(0);
-    for (Size i = 0; i != s1.size(); ++i)
+  double SteinScottImproveScore::compare_(const SpectrumComparisonKernels::PeakArrays & s1, double sum1, double sum3, const PeakSpectrum & s2) const
+  {
+    const double epsilon = tolerance_;
+    const double constant = epsilon / 10000;
+
+    const double sum2 = SpectrumComparisonKernels::sumOfSquaredIntensities(s2);
+    const double sum4 = SpectrumComparisonKernels::sumOfIntensities(s2);
+    const double z = constant * (sum3 * sum4);
+
+    double sum(0);
+    SpectrumComparisonKernels::forEachMatch<true>(s1, s2, 2 * epsilon, [&](Size i, Size j)
     {
-      for (Size j = j_left; j != s2.size(); ++j)
-      {
-        double pos1(s1[i].getMZ()), pos2(s2[j].getMZ());
-        if (std::abs(pos1 - pos2) <= 2 * epsilon)
-        {
-          sum += s1[i].getIntensity() * s2[j].getIntensity();
-        }
-        else
-        {
-          if (pos2 > pos1)
-          {
-            break;
-          }
-          else
-          {
-            j_left = j;
-          }
-        }
-      }
-    }
-    //std::cout<< sum << " Sum " << z << " z " << std::endl;
-    score = (sum - z) / (std::sqrt((sum1 * sum2)));
-    // std::cout<<score<< " score" << std::endl;
-    if (score < (float)param_.getValue("threshold"))
+      sum += s1.intensity[i] * s2[j].getIntensity();
+    });
+
+    double score = (sum - z) / (std::sqrt((sum1 * sum2)));
+    if (score < threshold_)
     {
       score = 0;
     }
@@ -8,6 +8,8 @@
 
 #include <OpenMS/COMPARISON/ZhangSimilarityScore.h>
 
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
+
 #include <OpenMS/KERNEL/MSSpectrum.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
@@ -40,10 +42,19 @@ namespace OpenMS
     if (this != &source)
     {
       PeakSpectrumCompareFunctor::operator=(source);
+      updateMembers_();
     }
     return *this;
   }
 
+  void ZhangSimilarityScore::updateMembers_()
+  {
+    tolerance_ = (double)param_.getValue("tolerance");
+    is_relative_tolerance_ = param_.getValue("is_relative_tolerance").toBool();
+    use_linear_factor_ = param_.getValue("use_linear_factor").toBool();
+    use_gaussian_factor_ = param_.getValue("use_gaussian_factor").toBool();
+  }
+
   double ZhangSimilarityScore::operator()(const PeakSpectrum & spec) const
   {
     return operator()(spec, spec);
@@ -51,144 +62,67 @@ namespace OpenMS
 
   double ZhangSimilarityScore::operator()(const PeakSpectrum & s1, const PeakSpectrum & s2) const
   {
-    const double tolerance = (double)param_.getValue("tolerance");
-    bool use_linear_factor = param_.getValue("use_linear_factor").toBool();
-    bool use_gaussian_factor = param_.getValue("use_gaussian_factor").toBool();
-    double score(0), sum(0), sum1(0), sum2(0) /*, squared_sum1(0), squared_sum2(0)*/;
-
     // TODO remove parameter 
-    if (param_.getValue("is_relative_tolerance").toBool() )
+    if (is_relative_tolerance_)
     {
       throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
     }
 
-    for (const Peak1D& it1 : s1)
-    {
-      sum1 += it1.getIntensity();
-      /*
-for (PeakSpectrum::ConstIterator it2 = s1.begin(); it2 != s1.end(); ++it2)
-{
-  if (abs(it1->getPosition()[0] - it2->getPosition()[0]) <= 2 * tolerance)
-  {
-    squared_sum1 += it1->getIntensity() * it2->getIntensity();
+    const SpectrumComparisonKernels::PeakArrays p1(s1);
+    return compare_(p1, SpectrumComparisonKernels::sumOfIntensities(p1), s2);
   }
-}*/
-    }
 
-/*
-        UInt i_left(0);
-        for (Size i = 0; i != s1.size(); ++i)
-        {
-            sum1 += s1[i].getIntensity();
-            for (Size j = i_left; j != s1.size(); ++j)
-            {
-                double pos1(s1[i].getPosition()[0]), pos2(s1[j].getPosition()[0]);
-                if (abs(pos1 - pos2) <= 2 * tolerance)
-                {
-                    squared_sum1 += s1[i].getIntensity() * s1[j].getIntensity();
-                }
-                else
-                {
-                    if (pos2 > pos1)
-                    {
-                        break;
-                    }
-                    else
-                    {
-                        i_left = i;
-                    }
-                }
-            }
-        }*/
-
-/*
-    i_left = 0;
-    for (Size i = 0; i != s2.size(); ++i)
+  void ZhangSimilarityScore::batchCompare(const PeakSpectrum & query, const std::vector<const PeakSpectrum*> & library, std::vector<double> & scores) const
+  {
+    if (is_relative_tolerance_)
     {
-      sum2 += s2[i].getIntensity();
-      for (Size j = i_left; j != s2.size(); ++j)
-      {
-        double pos1(s2[i].getPosition()[0]), pos2(s2[j].getPosition()[0]);
-        if (abs(pos1 - pos2) <= 2 * tolerance)
-        {
-          squared_sum1 += s2[i].getIntensity() * s2[j].getIntensity();
-        }
-        else
-        {
-          if (pos2 > pos1)
-          {
-            break;
-          }
-          else
-          {
-            i_left = i;
-          }
-        }
-      }
-    }*/
+      throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
+    }
 
-    for (const Peak1D& it1 : s2)
+    const SpectrumComparisonKernels::PeakArrays q(query);
+    const double sum_query = SpectrumComparisonKernels::sumOfIntensities(q);
+    scores.resize(library.size());
+    for (Size k = 0; k < library.size(); ++k)
     {
-      sum2 += it1.getIntensity();
-      /*
-for (PeakSpectrum::ConstIterator it2 = s2.begin(); it2 != s2.end(); ++it2)
-{
-  if (abs(it1->getPosition()[0] - it2->getPosition()[0]) <= 2 * tolerance)
-  {
-    squared_sum2 += it1->getIntensity() * it2->getIntensity();
-  }
-}
-      */
+      scores[k] = compare_(q, sum_query, *library[k]);
     }
+  }
 
-    Size j_left(0);
-    for (Size i = 0; i != s1.size(); ++i)
+  void ZhangSimilarityScore::batchCompareViews(const PeakSpectrum & query, const std::vector<SpectrumComparisonKernels::PeakArraysView> & library, std::vector<double> & scores) const
+  {
+    if (is_relative_tolerance_)
     {
-      for (Size j = j_left; j != s2.size(); ++j)
-      {
-        double pos1(s1[i].getMZ()), pos2(s2[j].getMZ());
-        if (fabs(pos1 - pos2) < tolerance)
-        {
-          //double factor((tolerance - fabs(pos1 - pos2)) / tolerance);
-          double factor = 1.0;
-
-          if (use_linear_factor || use_gaussian_factor)
-          {
-            factor = getFactor_(tolerance, fabs(pos1 - pos2), use_gaussian_factor);
-          }
-          sum += sqrt(s1[i].getIntensity() * s2[j].getIntensity() * factor);
-        }
-        else
-        {
-          if (pos2 > pos1)
-          {
-            break;
-          }
-          else
-          {
-            j_left = j;
-          }
-        }
-      }
+      throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
     }
 
-
-    /*
-for (PeakSpectrum::ConstIterator it1 = s1.begin(); it1 != s1.end(); ++it1)
-{
-  for (PeakSpectrum::ConstIterator it2 = s2.begin(); it2 != s2.end(); ++it2)
-  {
-    if (abs(it1->getPosition()[0] - it2->getPosition()[0]) <= 2 * tolerance)
+    const SpectrumComparisonKernels::PeakArrays q(query);
+    const double sum_query = SpectrumComparisonKernels::sumOfIntensities(q);
+    scores.resize(library.size());
+    for (Size k = 0; k < library.size(); ++k)
     {
-      sum += sqrt(it1->getIntensity() * it2->getIntensity());
+      scores[k] = compare_(q, sum_query, library[k]);
     }
   }
-}*/
 
-    score = sum / (sqrt(sum1 * sum2));
+  template <typename LibraryPeaks>
+  double ZhangSimilarityScore::compare_(const SpectrumComparisonKernels::PeakArrays & s1, double sum1, const LibraryPeaks & s2) const
+  {
+    using SpectrumComparisonKernels::getMZ;
+    using SpectrumComparisonKernels::getIntensity;
 
-    return score;
+    const double sum2 = SpectrumComparisonKernels::sumOfIntensities(s2);
+    double sum(0);
+    SpectrumComparisonKernels::forEachMatch<false>(s1, s2, tolerance_, [&](Size i, Size j)
+    {
+      double factor = 1.0;
+      if (use_linear_factor_ || use_gaussian_factor_)
+      {
+        factor = getFactor_(tolerance_, fabs(s1.mz[i] - getMZ(s2, j)), use_gaussian_factor_);
+      }
+      sum += sqrt(s1.intensity[i] * getIntensity(s2, j) * factor);
+    });
 
+    return sum / (sqrt(sum1 * sum2));
   }
 
   double ZhangSimilarityScore::getFactor_(double mz_tolerance, double mz_difference, bool is_gaussian) const
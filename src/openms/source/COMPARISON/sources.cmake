@@ -13,6 +13,7 @@ SpectraSTSimilarityScore.cpp
 SpectrumAlignment.cpp
 SpectrumAlignmentScore.cpp
 SpectrumCheapDPCorr.cpp
+SpectrumComparisonKernels.cpp
 SpectrumPrecursorComparator.cpp
 SteinScottImproveScore.cpp
 ZhangSimilarityScore.cpp
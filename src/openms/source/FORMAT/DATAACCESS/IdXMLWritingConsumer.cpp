@@ -0,0 +1,178 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/DATAACCESS/IdXMLWritingConsumer.h>
+
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/FORMAT/FileHandler.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace OpenMS
+{
+
+  IdXMLWritingConsumer::IdXMLWritingConsumer(const String& filename) :
+    filename_(filename),
+    prot_count_(0),
+    pep_ids_written_(0),
+    count_empty_(0),
+    count_unknown_run_(0),
+    closed_(false)
+  {
+    if (!FileHandler::hasValidExtension(filename, FileTypes::IDXML))
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename,
+          "invalid file extension, expected '" + FileTypes::typeToName(FileTypes::IDXML) + "'");
+    }
+    // set filename for the handler (error messages)
+    handler_.file_ = filename;
+
+    // open the output right away to fail early
+    ofs_.open(filename.c_str());
+    if (!ofs_)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    ofs_.precision(writtenDigits<double>(0.0));
+  }
+
+  IdXMLWritingConsumer::~IdXMLWritingConsumer()
+  {
+    close();
+  }
+
+  void IdXMLWritingConsumer::setDocumentIdentifier(const String& document_id)
+  {
+    document_id_ = document_id;
+  }
+
+  void IdXMLWritingConsumer::consumeProteinIdentification(ProteinIdentification& prot_id)
+  {
+    if (closed_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Cannot consume identifications after closing the file.");
+    }
+    // throws if protIDs are not unique, i.e. PeptideIDs will be randomly assigned (bad!)
+    if (!run_index_.emplace(prot_id.getIdentifier(), runs_.size()).second)
+    {
+      handler_.fatalError(Internal::XMLHandler::STORE, "ProteinIdentification run identifiers are not unique. This can lead to loss of unique PeptideIdentification assignment. Duplicated Protein-ID is:" +
+                                                       prot_id.getIdentifier());
+    }
+
+    // search parameters are numbered in order of first occurrence (like in IdXMLFile::store())
+    if (std::find(params_.begin(), params_.end(), prot_id.getSearchParameters()) == params_.end())
+    {
+      params_.push_back(prot_id.getSearchParameters());
+    }
+
+    auto run = std::make_unique<Run_>();
+    run->identifier = prot_id.getIdentifier();
+
+    // protein hits are numbered now, so that the following peptide ids can refer to them
+    std::ostringstream os;
+    os.precision(writtenDigits<double>(0.0));
+    handler_.writeProteinIdentification_(os, prot_id, params_, prot_count_, accession_to_id_);
+    run->protein_xml = os.str();
+
+    run->spool_file = File::getTemporaryFile();
+    run->spool.open(run->spool_file.c_str());
+    if (!run->spool)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, run->spool_file);
+    }
+    run->spool.precision(writtenDigits<double>(0.0));
+    runs_.push_back(std::move(run));
+  }
+
+  void IdXMLWritingConsumer::consumePeptideIdentifications(std::vector<PeptideIdentification>& pep_ids)
+  {
+    if (closed_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Cannot consume identifications after closing the file.");
+    }
+    // every peptide id is rendered completely before it is written (no partial elements on errors)
+    std::ostringstream os;
+    os.precision(writtenDigits<double>(0.0));
+    Run_* run = nullptr;
+    for (const PeptideIdentification& pep_id : pep_ids)
+    {
+      // batches usually belong to a single run
+      if (run == nullptr || run->identifier != pep_id.getIdentifier())
+      {
+        const auto it = run_index_.find(pep_id.getIdentifier());
+        if (it == run_index_.end())
+        {
+          run = nullptr;
+          ++count_unknown_run_;
+          continue;
+        }
+        run = runs_[it->second].get();
+      }
+      if (pep_id.getHits().empty())
+      {
+        ++count_empty_;
+        continue;
+      }
+      os.str("");
+      handler_.writePeptideIdentification_(os, pep_id, run->identifier, accession_to_id_);
+      run->spool << os.str();
+      ++pep_ids_written_;
+    }
+  }
+
+  void IdXMLWritingConsumer::close()
+  {
+    if (closed_)
+    {
+      return;
+    }
+    closed_ = true;
+
+    handler_.writeHeader_(ofs_, document_id_);
+    handler_.writeSearchParameters_(ofs_, params_);
+
+    for (auto& run : runs_)
+    {
+      ofs_ << run->protein_xml;
+      run->spool.close();
+      {
+        std::ifstream spool(run->spool_file.c_str());
+        if (spool.peek() != std::ifstream::traits_type::eof())
+        {
+          ofs_ << spool.rdbuf();
+        }
+      }
+      File::remove(run->spool_file);
+      ofs_ << "\t</IdentificationRun>\n";
+    }
+
+    // empty protein ids  parameters
+    if (runs_.empty())
+    {
+      ofs_ << "<IdentificationRun date=\"1900-01-01T01:01:01.0Z\" search_engine=\"Unknown\" search_parameters_ref=\"ID_1\" search_engine_version=\"0\"/>\n";
+    }
+
+    // write footer
+    ofs_ << "</IdXML>\n";
+    ofs_.close();
+
+    if (count_empty_) OPENMS_LOG_WARN << "Omitted writing of " << count_empty_ << " peptide identifications due to empty hits." << std::endl;
+    if (count_unknown_run_)
+    {
+      handler_.warning(Internal::XMLHandler::STORE, "Omitting " + String(count_unknown_run_) + " peptide identification(s) because of missing ProteinIdentification while writing '" + filename_ + "'!");
+    }
+  }
+
+  Size IdXMLWritingConsumer::getNrPeptideIdentificationsWritten() const
+  {
+    return pep_ids_written_;
+  }
+
+} // namespace OpenMS
@@ -14,11 +14,139 @@
 
 #include <OpenMS/CONCEPT/LogStream.h>
 
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstring>
+#include <filesystem>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace OpenMS
 {
   using namespace std;
 
+  namespace
+  {
+    /// start of the line following the one containing @p pos (or @p end)
+    const char* nextLineStart(const char* pos, const char* end)
+    {
+      const char* nl = static_cast<const char*>(memchr(pos, '\n', end - pos));
+      return nl == nullptr ? end : nl + 1;
+    }
+
+    /**
+      @brief Reads a protein entry from the buffer [@p pos, @p end) and advances @p pos behind it
+
+      Same rules as FASTAFile::readEntry_(), but on an in-memory buffer.
+      @return true if the entry was read successfully, false otherwise
+    */
+    bool parseEntry(const char*& pos, const char* end, std::string& id, std::string& description, std::string& seq)
+    {
+      if (pos == end || *pos++ != '>')
+      {
+        return false; // was in wrong position for reading ID
+      }
+      bool description_exists = true;
+      bool keep_reading = true;
+      while (keep_reading) // reading the ID
+      {
+        if (pos == end) return false;
+        const char c = *pos++;
+        switch (c)
+        {
+          case ' ':
+          case '\t':
+            if (!id.empty())
+            {
+              keep_reading = false; // ID finished
+            }
+            break;
+          case '\n': // ID finished and no description available
+            keep_reading = false;
+            description_exists = false;
+            break;
+          case '\r':
+            break;
+          default:
+            id += c;
+        }
+      }
+
+      if (id.empty())
+      {
+        return false;
+      }
+
+      // reading the description
+      keep_reading = description_exists;
+      while (keep_reading)
+      {
+        if (pos == end) return false;
+        const char c = *pos++;
+        switch (c)
+        {
+          case '\n': // description finished
+            keep_reading = false;
+            break;
+          case '\r':
+          case '\t':
+            break;
+          default:
+            description += c;
+        }
+      }
+
+      // reading the sequence
+      const char* line = pos;
+      while (pos != end)
+      {
+        const char* line_end = static_cast<const char*>(memchr(line, '\n', end - line));
+        if (line_end == nullptr) line_end = end;
+        for (const char* c = line; c != line_end; ++c)
+        {
+          if (*c != '\r' && *c != ' ' && *c != '\t') // not saving white spaces
+          {
+            seq += *c;
+          }
+        }
+        pos = (line_end == end) ? end : line_end + 1;
+        line = pos;
+        if (pos != end && *pos == '>') // reaching the beginning of the next protein-entry
+        {
+          break;
+        }
+      }
+      return !seq.empty();
+    }
+
+    /**
+      @brief Finds the start of an entry at or after @p pos
+
+      Entries start with a '>' at the beginning of a line. Since a line starting with '>' directly
+      after a header line is read as sequence (see FASTAFile::readEntry_()), only positions
+      behind a line which is not a header are considered.
+      @return the position of the '>', or @p end if there is none
+    */
+    const char* nextEntryStart(const char* pos, const char* begin, const char* end)
+    {
+      // the beginning of the line containing @p pos
+      const char* line = pos;
+      while (line > begin && *(line - 1) != '\n') --line;
+      while (line < end)
+      {
+        const char* next = nextLineStart(line, end);
+        if (next < end && *next == '>' && *line != '>' && next > pos)
+        {
+          return next;
+        }
+        line = next;
+      }
+      return end;
+    }
+  }
+
   bool FASTAFile::readEntry_(std::string& id, std::string& description, std::string& seq)
   {
     std::streambuf* sb = infile_.rdbuf();
@@ -224,14 +352,101 @@ namespace OpenMS
 
   void FASTAFile::load(const String &filename, vector<FASTAEntry> &data) const
   {
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+
+    if (!File::readable(filename))
+    {
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+
     startProgress(0, 1, "Loading FASTA file");
     data.clear();
-    FASTAEntry p;
-    FASTAFile f;
-    f.readStart(filename);
-    while (f.readNext(p))
+
+    // empty files cannot be mapped
+    boost::iostreams::mapped_file_source file;
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    if (std::filesystem::file_size(filename.c_str()) > 0)
+    {
+      file.open(filename);
+      begin = file.data();
+      end = begin + file.size();
+    }
+
+    while (begin < end && *begin == '#') // Skip the header of PEFF files (http://www.psidev.info/peff)
+    {
+      begin = nextLineStart(begin, end);
+    }
+
+    // split the file into chunks which start with an entry; chunks are parsed in parallel
+    const Size min_chunk_size = Size(1) << 20; // 1 MB
+    Size nr_chunks = 1;
+#ifdef _OPENMP
+    nr_chunks = 4 * omp_get_max_threads();
+#endif
+    nr_chunks = std::max(Size(1), std::min(nr_chunks, Size(end - begin) / min_chunk_size));
+    std::vector<const char*> chunk_bounds(1, begin);
+    for (Size c = 1; c < nr_chunks; ++c)
+    {
+      const char* target = begin + (end - begin) * c / nr_chunks;
+      if (target > chunk_bounds.back())
+      {
+        const char* bound = nextEntryStart(target, begin, end);
+        if (bound > chunk_bounds.back() && bound < end)
+        {
+          chunk_bounds.push_back(bound);
+        }
+      }
+    }
+    chunk_bounds.push_back(end);
+    nr_chunks = chunk_bounds.size() - 1;
+
+    // parse the chunks; the first error (in file order) is reported below
+    std::vector<std::vector<FASTAEntry> > chunk_entries(nr_chunks);
+    std::vector<char> chunk_failed(nr_chunks, false);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize c = 0; c < (SignedSize)nr_chunks; ++c)
+    {
+      FASTAEntry entry;
+      const char* pos = chunk_bounds[c];
+      do // at least one entry (even if the file is empty)
+      {
+        entry.identifier.clear();
+        entry.description.clear();
+        entry.sequence.clear();
+        if (!parseEntry(pos, chunk_bounds[c + 1], entry.identifier, entry.description, entry.sequence))
+        {
+          chunk_failed[c] = true;
+          break;
+        }
+        chunk_entries[c].push_back(std::move(entry));
+      } while (pos < chunk_bounds[c + 1]);
+    }
+
+    Size entries_read(0);
+    for (Size c = 0; c < nr_chunks; ++c)
+    {
+      entries_read += chunk_entries[c].size();
+      if (chunk_failed[c])
+      {
+        String msg = (entries_read == 0 ? String("The first entry could not be read!")
+                                         : "Only " + String(entries_read) + " proteins could be read. Parsing next record failed.");
+        data.clear();
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "",
+                                    "Error while parsing FASTA file! " + msg + " Please check the file!");
+      }
+    }
+
+    data.reserve(entries_read);
+    for (auto& entries : chunk_entries)
     {
-      data.push_back(std::move(p));
+      std::move(entries.begin(), entries.end(), std::back_inserter(data));
+      std::vector<FASTAEntry>().swap(entries);
     }
     endProgress();
   }
@@ -0,0 +1,332 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/MappedIndexFile.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Macros.h>
+#include <OpenMS/FORMAT/FileHandler.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <cstring>
+#include <filesystem>
+#include <limits>
+
+namespace OpenMS
+{
+  namespace Internal
+  {
+    namespace
+    {
+      UInt64 padded(UInt64 bytes)
+      {
+        return (bytes + 7) & ~UInt64(7);
+      }
+
+      /// Size and modification time of @p filename (zero if it does not exist)
+      std::pair<UInt64, Int64> sourceStamp(const String& filename)
+      {
+        std::error_code ec;
+        if (filename.empty() || !std::filesystem::exists(filename.c_str(), ec)) return {0, 0};
+        const UInt64 size = std::filesystem::file_size(filename.c_str(), ec);
+        const auto mtime = std::filesystem::last_write_time(filename.c_str(), ec);
+        return {ec ? 0 : size, ec ? 0 : Int64(mtime.time_since_epoch().count())};
+      }
+    }
+
+    UInt32 MappedIndexFile::Format::checkedUInt32(Size value, const char* items) const
+    {
+      if (value > std::numeric_limits<UInt32>::max())
+      {
+        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            String("Too many ") + items + " for a " + name + ".", String(value));
+      }
+      return static_cast<UInt32>(value);
+    }
+
+    MappedIndexFile::StringPool::StringPool(const Format& format) :
+      format_(format)
+    {
+      add(std::string());
+    }
+
+    MappedIndexFile::StringIndex MappedIndexFile::StringPool::add(const std::string& s)
+    {
+      auto it = index_.find(s);
+      if (it != index_.end()) return it->second;
+      const StringIndex idx = format_.checkedUInt32(strings_.size(), "distinct strings");
+      index_.emplace(s, idx);
+      strings_.push_back(s);
+      return idx;
+    }
+
+    const std::vector<std::string>& MappedIndexFile::StringPool::strings() const
+    {
+      return strings_;
+    }
+
+    MappedIndexFile::Writer::Writer(const Format& format, const String& filename, const String& source_file, const String& fingerprint, const StringPool& strings) :
+      format_(format),
+      filename_(filename),
+      tmp_filename_(filename + "." + File::getUniqueName(false) + ".tmp"),
+      header_{}
+    {
+      const auto& pool = strings.strings();
+      std::vector<UInt64> string_offsets(pool.size() + 1, 0);
+      for (Size i = 0; i < pool.size(); ++i)
+      {
+        string_offsets[i + 1] = string_offsets[i] + pool[i].size();
+      }
+
+      std::memcpy(header_.magic, format_.magic, sizeof(header_.magic));
+      header_.version = format_.version;
+      header_.nr_sections = format_.nr_sections;
+      header_.fingerprint_size = fingerprint.size();
+      header_.nr_strings = pool.size();
+      header_.string_bytes = string_offsets.back();
+      if (!source_file.empty())
+      {
+        std::tie(header_.source_size, header_.source_mtime) = sourceStamp(source_file);
+        const String sha1 = FileHandler::computeFileHash(source_file);
+        std::memcpy(header_.source_sha1, sha1.c_str(), std::min(sha1.size(), sizeof(header_.source_sha1)));
+      }
+
+      os_.open(tmp_filename_.c_str(), std::ios::binary | std::ios::trunc);
+      if (!os_)
+      {
+        throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_);
+      }
+      // the header and the section sizes are rewritten by commit()
+      append(&header_, sizeof(Header));
+      endSection();
+      const std::vector<UInt64> section_sizes(format_.nr_sections, 0);
+      addSection(section_sizes);
+      append(fingerprint.data(), fingerprint.size());
+      endSection();
+      addSection(string_offsets);
+      for (const auto& s : pool)
+      {
+        append(s.data(), s.size());
+      }
+      endSection();
+      section_sizes_.clear();
+    }
+
+    MappedIndexFile::Writer::~Writer()
+    {
+      if (!committed_)
+      {
+        os_.close();
+        std::error_code ec;
+        std::filesystem::remove(tmp_filename_.c_str(), ec);
+      }
+    }
+
+    void MappedIndexFile::Writer::append(const void* data, UInt64 bytes)
+    {
+      if (bytes > 0) os_.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+      current_size_ += bytes;
+    }
+
+    void MappedIndexFile::Writer::endSection()
+    {
+      static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      os_.write(zeros, static_cast<std::streamsize>(padded(current_size_) - current_size_));
+      section_sizes_.push_back(current_size_);
+      current_size_ = 0;
+    }
+
+    void MappedIndexFile::Writer::commit()
+    {
+      OPENMS_PRECONDITION(section_sizes_.size() == format_.nr_sections, "All sections have to be written")
+      os_.seekp(0);
+      os_.write(reinterpret_cast<const char*>(&header_), sizeof(Header));
+      os_.seekp(padded(sizeof(Header)));
+      os_.write(reinterpret_cast<const char*>(section_sizes_.data()), static_cast<std::streamsize>(section_sizes_.size() * sizeof(UInt64)));
+      os_.close();
+      if (!os_)
+      {
+        throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, String("Error while writing ") + format_.name);
+      }
+      std::error_code ec;
+      std::filesystem::rename(tmp_filename_.c_str(), filename_.c_str(), ec);
+      if (ec)
+      {
+        throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, ec.message());
+      }
+      committed_ = true;
+    }
+
+    MappedIndexFile::MappedIndexFile(const Format& format) :
+      format_(format)
+    {
+    }
+
+    MappedIndexFile::~MappedIndexFile()
+    {
+      close();
+    }
+
+    namespace
+    {
+      /// Total file size implied by a header and the section sizes
+      UInt64 expectedFileSize(const MappedIndexFile::Format& format, UInt64 fingerprint_size, UInt64 nr_strings, UInt64 string_bytes, const UInt64* section_sizes)
+      {
+        UInt64 size = padded(fingerprint_size) + padded((nr_strings + 1) * sizeof(UInt64)) + padded(string_bytes);
+        for (UInt32 i = 0; i < format.nr_sections; ++i)
+        {
+          size += padded(section_sizes[i]);
+        }
+        return size;
+      }
+    }
+
+    bool MappedIndexFile::isUpToDate(const Format& format, const String& filename, const String& source_file, const String& fingerprint)
+    {
+      if (!File::exists(filename)) return false;
+      const UInt64 file_size = File::fileSize(filename);
+      const UInt64 layout_size = padded(sizeof(Header)) + padded(format.nr_sections * sizeof(UInt64));
+      if (file_size < layout_size) return false;
+
+      std::ifstream is(filename.c_str(), std::ios::binary);
+      Header header;
+      if (!is.read(reinterpret_cast<char*>(&header), sizeof(Header))) return false;
+      if (std::memcmp(header.magic, format.magic, sizeof(header.magic)) != 0 ||
+          header.version != format.version ||
+          header.nr_sections != format.nr_sections ||
+          header.fingerprint_size != fingerprint.size())
+      {
+        return false;
+      }
+      std::vector<UInt64> section_sizes(format.nr_sections);
+      std::string stored_fingerprint(fingerprint.size(), '\0');
+      is.seekg(padded(sizeof(Header)));
+      if (!is.read(reinterpret_cast<char*>(section_sizes.data()), static_cast<std::streamsize>(section_sizes.size() * sizeof(UInt64))) ||
+          layout_size + expectedFileSize(format, header.fingerprint_size, header.nr_strings, header.string_bytes, section_sizes.data()) != file_size)
+      {
+        return false;
+      }
+      is.seekg(layout_size);
+      if (!stored_fingerprint.empty() && !is.read(&stored_fingerprint[0], static_cast<std::streamsize>(stored_fingerprint.size()))) return false;
+      if (stored_fingerprint != fingerprint) return false;
+
+      const auto stamp = sourceStamp(source_file);
+      if (stamp.first == 0 || stamp.first != header.source_size) return false;
+      if (stamp.second == header.source_mtime) return true;
+      // the source file was touched: compare its content
+      const String sha1 = FileHandler::computeFileHash(source_file);
+      return sha1.size() == sizeof(header.source_sha1) && std::memcmp(sha1.c_str(), header.source_sha1, sizeof(header.source_sha1)) == 0;
+    }
+
+    void MappedIndexFile::open(const String& filename)
+    {
+      close();
+      if (!File::exists(filename))
+      {
+        throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+      }
+      try
+      {
+        file_.open(filename);
+      }
+      catch (std::exception& e)
+      {
+        throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename + " (" + e.what() + ")");
+      }
+
+      try
+      {
+        const UInt64 layout_size = padded(sizeof(Header)) + padded(format_.nr_sections * sizeof(UInt64));
+        if (file_.size() < layout_size)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, String("File is too small to be a ") + format_.name + ".");
+        }
+        Header header;
+        std::memcpy(&header, file_.data(), sizeof(Header));
+        if (std::memcmp(header.magic, format_.magic, sizeof(header.magic)) != 0)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, String("File is not a ") + format_.name + ".");
+        }
+        if (header.version != format_.version || header.nr_sections != format_.nr_sections)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename,
+              String("Unsupported ") + format_.name + " version " + String(header.version) + " (expected " + String(format_.version) + "). Please regenerate the file.");
+        }
+        section_sizes_.resize(format_.nr_sections);
+        std::memcpy(section_sizes_.data(), file_.data() + padded(sizeof(Header)), section_sizes_.size() * sizeof(UInt64));
+        if (layout_size + expectedFileSize(format_, header.fingerprint_size, header.nr_strings, header.string_bytes, section_sizes_.data()) != file_.size())
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, String("The ") + format_.name + " is truncated or corrupt.");
+        }
+
+        const char* p = file_.data() + layout_size;
+        auto next = [&p](UInt64 bytes)
+        {
+          const char* section = p;
+          p += padded(bytes);
+          return section;
+        };
+        next(header.fingerprint_size);
+        nr_strings_ = header.nr_strings;
+        string_offsets_ = reinterpret_cast<const UInt64*>(next((nr_strings_ + 1) * sizeof(UInt64)));
+        string_data_ = next(header.string_bytes);
+        for (const UInt64 bytes : section_sizes_)
+        {
+          sections_.push_back(next(bytes));
+        }
+
+        if (string_offsets_[nr_strings_] != header.string_bytes)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, String("The ") + format_.name + " has an inconsistent string pool.");
+        }
+      }
+      catch (...)
+      {
+        close();
+        throw;
+      }
+    }
+
+    bool MappedIndexFile::isOpen() const
+    {
+      return file_.is_open();
+    }
+
+    void MappedIndexFile::close()
+    {
+      if (file_.is_open()) file_.close();
+      string_offsets_ = nullptr;
+      string_data_ = nullptr;
+      nr_strings_ = 0;
+      sections_.clear();
+      section_sizes_.clear();
+    }
+
+    void MappedIndexFile::checkRecordSize_(Size index, Size record_size) const
+    {
+      OPENMS_PRECONDITION(index < sections_.size(), "Section index out of range")
+      if (section_sizes_[index] % record_size != 0)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String(section_sizes_[index]),
+            String("The ") + format_.name + " has an inconsistent section " + String(index) + ".");
+      }
+    }
+
+    Size MappedIndexFile::getNrStrings() const
+    {
+      return nr_strings_;
+    }
+
+    std::string_view MappedIndexFile::getString(StringIndex index) const
+    {
+      OPENMS_PRECONDITION(index < nr_strings_, "String index out of range")
+      return std::string_view(string_data_ + string_offsets_[index], string_offsets_[index + 1] - string_offsets_[index]);
+    }
+
+  } // namespace Internal
+} // namespace OpenMS
@@ -163,7 +163,7 @@ namespace OpenMS
     replacement = "[+$1";
     peptide = boost::regex_replace(peptide, re, replacement);
 
-    seq = AASequence::fromString(peptide);
+    seq = AASequence::fromStringCached(peptide);
   }
 
 
@@ -48,6 +48,7 @@ MascotInfile.cpp
 MascotGenericFile.cpp
 MascotRemoteQuery.cpp
 MascotXMLFile.cpp
+MappedIndexFile.cpp
 MsInspectFile.cpp
 MzDataFile.cpp
 MzIdentMLFile.cpp
@@ -0,0 +1,574 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/METADATA/PSMTable.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/METADATA/MetaInfoRegistry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+using namespace std;
+
+namespace OpenMS
+{
+
+  namespace
+  {
+    template <typename T>
+    void gatherColumn(vector<T>& column, const vector<UInt32>& rows)
+    {
+      vector<T> result(rows.size());
+#pragma omp parallel for
+      for (SignedSize i = 0; i < (SignedSize)rows.size(); ++i)
+      {
+        result[i] = column[rows[i]];
+      }
+      column.swap(result);
+    }
+
+    PSMTable::TargetDecoy toTargetDecoy(const DataValue& value)
+    {
+      if (value.isEmpty())
+      {
+        return PSMTable::TargetDecoy::UNKNOWN;
+      }
+      const String td = value.toString();
+      if (td == "target") return PSMTable::TargetDecoy::TARGET;
+      if (td == "decoy") return PSMTable::TargetDecoy::DECOY;
+      if (td == "target+decoy") return PSMTable::TargetDecoy::TARGET_DECOY;
+      return PSMTable::TargetDecoy::INVALID;
+    }
+  }
+
+  void PSMTable::clear()
+  {
+    *this = PSMTable();
+  }
+
+  bool PSMTable::hasUniformScoreType(const vector<PeptideIdentification>& ids)
+  {
+    const PeptideIdentification* first = nullptr;
+    for (const PeptideIdentification& id : ids)
+    {
+      if (id.getHits().empty()) continue;
+      if (first == nullptr)
+      {
+        first = &id;
+      }
+      else if (id.getScoreType() != first->getScoreType() || id.isHigherScoreBetter() != first->isHigherScoreBetter())
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void PSMTable::importIDs(const vector<PeptideIdentification>& ids, const StringList& meta_keys)
+  {
+    clear();
+
+    if (!hasUniformScoreType(ids))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "All peptide identifications must use the same score type and orientation.");
+    }
+
+    // row offsets of the spectra, common score type
+    vector<Size> offsets(ids.size() + 1, 0);
+    bool score_type_set = false;
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      const PeptideIdentification& id = ids[i];
+      offsets[i + 1] = offsets[i] + id.getHits().size();
+      if (!score_type_set && !id.getHits().empty())
+      {
+        score_type_ = id.getScoreType();
+        higher_score_better_ = id.isHigherScoreBetter();
+        score_type_set = true;
+      }
+    }
+    if (!score_type_set && !ids.empty())
+    {
+      score_type_ = ids[0].getScoreType();
+      higher_score_better_ = ids[0].isHigherScoreBetter();
+    }
+    const Size n_rows = offsets.back();
+    if (n_rows >= Size(MISSING))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Too many peptide hits for a PSMTable.");
+    }
+
+    // spectrum columns
+    spectrum_run_.resize(ids.size());
+    spectrum_reference_.resize(ids.size());
+    rt_.resize(ids.size());
+    mz_.resize(ids.size());
+    unordered_map<String, UInt32> run_ids;
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      auto [run_it, inserted] = run_ids.emplace(ids[i].getIdentifier(), UInt32(runs_.size()));
+      if (inserted) runs_.push_back(ids[i].getIdentifier());
+      spectrum_run_[i] = run_it->second;
+      spectrum_reference_[i] = ids[i].getSpectrumReference();
+      rt_[i] = ids[i].getRT();
+      mz_[i] = ids[i].getMZ();
+    }
+
+    // meta columns: the type is taken from the first hit with the meta value
+    MetaInfoRegistry& registry = MetaInfoInterface::metaRegistry();
+    const UInt td_index = registry.registerName("target_decoy");
+    vector<UInt> meta_indices;
+    vector<NumericColumn*> numeric(meta_keys.size(), nullptr);
+    vector<vector<String>> string_values(meta_keys.size());
+    vector<vector<uint8_t>> string_present(meta_keys.size());
+    for (Size k = 0; k < meta_keys.size(); ++k)
+    {
+      meta_indices.push_back(registry.registerName(meta_keys[k]));
+      DataValue::DataType type = DataValue::EMPTY_VALUE;
+      for (Size i = 0; i < ids.size() && type == DataValue::EMPTY_VALUE; ++i)
+      {
+        for (const PeptideHit& hit : ids[i].getHits())
+        {
+          type = hit.getMetaValue(meta_indices.back()).valueType();
+          if (type != DataValue::EMPTY_VALUE) break;
+        }
+      }
+      if (type == DataValue::INT_VALUE || type == DataValue::DOUBLE_VALUE || type == DataValue::EMPTY_VALUE)
+      {
+        NumericColumn& column = numeric_columns_[meta_keys[k]];
+        column.values.assign(n_rows, numeric_limits<double>::quiet_NaN());
+        column.integer = (type == DataValue::INT_VALUE);
+        numeric[k] = &column;
+      }
+      else
+      {
+        string_values[k].resize(n_rows);
+        string_present[k].assign(n_rows, 0);
+      }
+    }
+
+    // row columns
+    score_.resize(n_rows);
+    target_decoy_.resize(n_rows);
+    charge_.resize(n_rows);
+    rank_.resize(n_rows);
+    spectrum_.resize(n_rows);
+    hit_.resize(n_rows);
+    vector<String> sequence_strings(n_rows);
+
+#pragma omp parallel for schedule(dynamic, 64)
+    for (SignedSize i = 0; i < (SignedSize)ids.size(); ++i)
+    {
+      const vector<PeptideHit>& hits = ids[i].getHits();
+      for (Size h = 0; h < hits.size(); ++h)
+      {
+        const PeptideHit& hit = hits[h];
+        const Size r = offsets[i] + h;
+        score_[r] = hit.getScore();
+        target_decoy_[r] = toTargetDecoy(hit.getMetaValue(td_index));
+        charge_[r] = hit.getCharge();
+        rank_[r] = hit.getRank();
+        spectrum_[r] = UInt32(i);
+        hit_[r] = UInt32(h);
+        sequence_strings[r] = hit.getSequence().toString();
+        for (Size k = 0; k < meta_indices.size(); ++k)
+        {
+          const DataValue& value = hit.getMetaValue(meta_indices[k]);
+          if (value.isEmpty()) continue;
+          if (numeric[k] != nullptr)
+          {
+            if (value.valueType() == DataValue::INT_VALUE || value.valueType() == DataValue::DOUBLE_VALUE)
+            {
+              numeric[k]->values[r] = double(value);
+            }
+          }
+          else
+          {
+            string_values[k][r] = value.toString();
+            string_present[k][r] = 1;
+          }
+        }
+      }
+    }
+
+    // intern sequences; unmodified sequences are computed once per distinct sequence
+    sequence_.resize(n_rows);
+    vector<UInt32> representative;
+    for (Size r = 0; r < n_rows; ++r)
+    {
+      const Size n_before = sequences_.size();
+      sequence_[r] = internSequence_(sequence_strings[r]);
+      if (sequences_.size() > n_before) representative.push_back(UInt32(r));
+    }
+    vector<String>().swap(sequence_strings);
+    vector<String> unmodified(representative.size());
+#pragma omp parallel for schedule(dynamic, 64)
+    for (SignedSize s = 0; s < (SignedSize)representative.size(); ++s)
+    {
+      const Size r = representative[s];
+      unmodified[s] = ids[spectrum_[r]].getHits()[hit_[r]].getSequence().toUnmodifiedString();
+    }
+    for (Size s = 0; s < representative.size(); ++s) // ids of the hit sequences are 0, 1, ...
+    {
+      const UInt32 id = internSequence_(unmodified[s]);
+      unmodified_[s] = id;
+    }
+
+    // intern string meta values
+    for (Size k = 0; k < meta_keys.size(); ++k)
+    {
+      if (numeric[k] != nullptr) continue;
+      vector<UInt32>& column = string_columns_[meta_keys[k]];
+      column.assign(n_rows, MISSING);
+      for (Size r = 0; r < n_rows; ++r)
+      {
+        if (string_present[k][r]) column[r] = internString_(string_values[k][r]);
+      }
+    }
+  }
+
+  void PSMTable::exportIDs(vector<PeptideIdentification>& ids)
+  {
+    if (ids.size() != getNrSpectra())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Number of peptide identifications (" + String(ids.size()) + ") does not match the table (" + String(getNrSpectra()) + ").");
+    }
+
+    // modified meta columns are written back
+    vector<pair<UInt, const NumericColumn*>> written;
+    for (const auto& [name, column] : numeric_columns_)
+    {
+      if (column.modified)
+      {
+        written.emplace_back(MetaInfoInterface::metaRegistry().registerName(name), &column);
+      }
+    }
+
+    const vector<Size> offsets = getSpectrumOffsets();
+#pragma omp parallel for schedule(dynamic, 64)
+    for (SignedSize i = 0; i < (SignedSize)ids.size(); ++i)
+    {
+      vector<PeptideHit> old_hits;
+      old_hits.swap(ids[i].getHits());
+      vector<PeptideHit> hits;
+      hits.reserve(offsets[i + 1] - offsets[i]);
+      for (Size r = offsets[i]; r < offsets[i + 1]; ++r)
+      {
+        PeptideHit& hit = hits.emplace_back(std::move(old_hits[hit_[r]]));
+        hit.setScore(score_[r]);
+        hit.setRank(rank_[r]);
+        for (const auto& [index, column] : written)
+        {
+          const double value = column->values[r];
+          if (std::isnan(value)) continue;
+          if (column->integer)
+          {
+            hit.setMetaValue(index, Int(value));
+          }
+          else
+          {
+            hit.setMetaValue(index, value);
+          }
+        }
+        hit_[r] = UInt32(r - offsets[i]);
+      }
+      ids[i].setHits(std::move(hits));
+      ids[i].setScoreType(score_type_);
+      ids[i].setHigherScoreBetter(higher_score_better_);
+    }
+  }
+
+  Size PSMTable::size() const
+  {
+    return score_.size();
+  }
+
+  bool PSMTable::empty() const
+  {
+    return score_.empty();
+  }
+
+  Size PSMTable::getNrSpectra() const
+  {
+    return spectrum_run_.size();
+  }
+
+  const String& PSMTable::getScoreType() const
+  {
+    return score_type_;
+  }
+
+  void PSMTable::setScoreType(const String& type)
+  {
+    score_type_ = type;
+  }
+
+  bool PSMTable::isHigherScoreBetter() const
+  {
+    return higher_score_better_;
+  }
+
+  void PSMTable::setHigherScoreBetter(bool higher_better)
+  {
+    higher_score_better_ = higher_better;
+  }
+
+  const vector<double>& PSMTable::getScores() const
+  {
+    return score_;
+  }
+
+  vector<double>& PSMTable::getScores()
+  {
+    return score_;
+  }
+
+  const vector<PSMTable::TargetDecoy>& PSMTable::getTargetDecoy() const
+  {
+    return target_decoy_;
+  }
+
+  const vector<Int>& PSMTable::getCharges() const
+  {
+    return charge_;
+  }
+
+  const vector<UInt32>& PSMTable::getRanks() const
+  {
+    return rank_;
+  }
+
+  const vector<UInt32>& PSMTable::getSequenceIds() const
+  {
+    return sequence_;
+  }
+
+  const vector<UInt32>& PSMTable::getSpectrumIndices() const
+  {
+    return spectrum_;
+  }
+
+  Size PSMTable::getNrSequences() const
+  {
+    return sequences_.size();
+  }
+
+  const String& PSMTable::getSequence(UInt32 id) const
+  {
+    return sequences_[id];
+  }
+
+  UInt32 PSMTable::getUnmodifiedSequenceId(UInt32 id) const
+  {
+    return unmodified_[id];
+  }
+
+  const String& PSMTable::getRunIdentifier(Size spectrum) const
+  {
+    return runs_[spectrum_run_[spectrum]];
+  }
+
+  const String& PSMTable::getSpectrumReference(Size spectrum) const
+  {
+    return spectrum_reference_[spectrum];
+  }
+
+  double PSMTable::getRT(Size spectrum) const
+  {
+    return rt_[spectrum];
+  }
+
+  double PSMTable::getMZ(Size spectrum) const
+  {
+    return mz_[spectrum];
+  }
+
+  UInt32 PSMTable::getRunIndex(Size spectrum) const
+  {
+    return spectrum_run_[spectrum];
+  }
+
+  Size PSMTable::getNrRuns() const
+  {
+    return runs_.size();
+  }
+
+  vector<Size> PSMTable::getSpectrumOffsets() const
+  {
+    vector<Size> offsets(getNrSpectra() + 1, 0);
+    for (UInt32 s : spectrum_)
+    {
+      ++offsets[s + 1];
+    }
+    partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    return offsets;
+  }
+
+  bool PSMTable::hasNumericColumn(const String& name) const
+  {
+    return numeric_columns_.find(name) != numeric_columns_.end();
+  }
+
+  bool PSMTable::hasStringColumn(const String& name) const
+  {
+    return string_columns_.find(name) != string_columns_.end();
+  }
+
+  StringList PSMTable::getColumnNames() const
+  {
+    StringList names;
+    for (const auto& column : numeric_columns_) names.push_back(column.first);
+    for (const auto& column : string_columns_) names.push_back(column.first);
+    return names;
+  }
+
+  const vector<double>& PSMTable::getNumericColumn(const String& name) const
+  {
+    auto it = numeric_columns_.find(name);
+    if (it == numeric_columns_.end())
+    {
+      throw Exception::ElementNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, name);
+    }
+    return it->second.values;
+  }
+
+  vector<double>& PSMTable::getNumericColumn(const String& name)
+  {
+    auto it = numeric_columns_.find(name);
+    if (it == numeric_columns_.end())
+    {
+      throw Exception::ElementNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, name);
+    }
+    it->second.modified = true;
+    return it->second.values;
+  }
+
+  vector<double>& PSMTable::addNumericColumn(const String& name, bool integer)
+  {
+    auto [it, inserted] = numeric_columns_.emplace(name, NumericColumn());
+    if (inserted)
+    {
+      it->second.values.assign(size(), numeric_limits<double>::quiet_NaN());
+      it->second.integer = integer;
+    }
+    it->second.modified = true;
+    return it->second.values;
+  }
+
+  const vector<UInt32>& PSMTable::getStringColumn(const String& name) const
+  {
+    auto it = string_columns_.find(name);
+    if (it == string_columns_.end())
+    {
+      throw Exception::ElementNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, name);
+    }
+    return it->second;
+  }
+
+  const String& PSMTable::getString(UInt32 id) const
+  {
+    return strings_[id];
+  }
+
+  void PSMTable::filterRows(const vector<uint8_t>& keep)
+  {
+    if (keep.size() != size())
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, keep.size());
+    }
+    vector<UInt32> rows;
+    rows.reserve(size());
+    for (Size r = 0; r < keep.size(); ++r)
+    {
+      if (keep[r]) rows.push_back(UInt32(r));
+    }
+    if (rows.size() != size()) gatherRows_(rows);
+  }
+
+  void PSMTable::sortHits()
+  {
+    const vector<Size> offsets = getSpectrumOffsets();
+    vector<UInt32> order(size());
+    iota(order.begin(), order.end(), 0);
+    bool reordered = false;
+    const bool higher_better = higher_score_better_;
+    const auto better = [this, higher_better](UInt32 a, UInt32 b)
+    {
+      return higher_better ? score_[a] > score_[b] : score_[a] < score_[b];
+    };
+#pragma omp parallel for schedule(dynamic, 256) reduction(||: reordered)
+    for (SignedSize i = 0; i < (SignedSize)getNrSpectra(); ++i)
+    {
+      auto first = order.begin() + offsets[i], last = order.begin() + offsets[i + 1];
+      if (!is_sorted(first, last, better))
+      {
+        stable_sort(first, last, better);
+        reordered = true;
+      }
+    }
+    if (reordered) gatherRows_(order);
+  }
+
+  void PSMTable::assignRanks()
+  {
+    sortHits();
+    const vector<Size> offsets = getSpectrumOffsets();
+#pragma omp parallel for schedule(dynamic, 256)
+    for (SignedSize i = 0; i < (SignedSize)getNrSpectra(); ++i)
+    {
+      UInt32 rank = 1;
+      for (Size r = offsets[i]; r < offsets[i + 1]; ++r)
+      {
+        if (r > offsets[i] && score_[r] != score_[r - 1]) ++rank;
+        rank_[r] = rank;
+      }
+    }
+  }
+
+  void PSMTable::gatherRows_(const vector<UInt32>& rows)
+  {
+    gatherColumn(score_, rows);
+    gatherColumn(target_decoy_, rows);
+    gatherColumn(charge_, rows);
+    gatherColumn(rank_, rows);
+    gatherColumn(sequence_, rows);
+    gatherColumn(spectrum_, rows);
+    gatherColumn(hit_, rows);
+    for (auto& column : numeric_columns_)
+    {
+      gatherColumn(column.second.values, rows);
+    }
+    for (auto& column : string_columns_)
+    {
+      gatherColumn(column.second, rows);
+    }
+  }
+
+  UInt32 PSMTable::internSequence_(const String& s)
+  {
+    auto [it, inserted] = sequence_ids_.emplace(s, UInt32(sequences_.size()));
+    if (inserted)
+    {
+      sequences_.push_back(s);
+      unmodified_.push_back(it->second);
+    }
+    return it->second;
+  }
+
+  UInt32 PSMTable::internString_(const String& s)
+  {
+    auto [it, inserted] = string_ids_.emplace(s, UInt32(strings_.size()));
+    if (inserted) strings_.push_back(s);
+    return it->second;
+  }
+
+} // namespace OpenMS
@@ -32,6 +32,7 @@ Modification.cpp
 PeptideEvidence.cpp
 PeptideHit.cpp
 PeptideIdentification.cpp
+PSMTable.cpp
 Precursor.cpp
 Product.cpp
 ProteinHit.cpp
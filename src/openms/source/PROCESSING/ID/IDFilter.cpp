@@ -8,7 +8,14 @@
 
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/PROCESSING/ID/IDFilter.h>
+#include <OpenMS/METADATA/PSMTable.h>
 #include <regex>
+#include <unordered_map>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace std;
 
@@ -760,6 +767,97 @@ namespace OpenMS
     peptides.resize(n);
   }
 
+  void IDFilter::filterHitsByScore(PSMTable& table, double threshold_score)
+  {
+    const vector<double>& scores = std::as_const(table).getScores();
+    const bool higher_better = table.isHigherScoreBetter();
+    vector<uint8_t> keep(table.size());
+#pragma omp parallel for
+    for (SignedSize r = 0; r < (SignedSize)table.size(); ++r)
+    {
+      keep[r] = higher_better ? scores[r] >= threshold_score : scores[r] <= threshold_score;
+    }
+    table.filterRows(keep);
+  }
+
+  void IDFilter::keepNBestHits(PSMTable& table, Size n)
+  {
+    table.sortHits();
+    const vector<Size> offsets = table.getSpectrumOffsets();
+    vector<uint8_t> keep(table.size(), 0);
+#pragma omp parallel for schedule(dynamic, 256)
+    for (SignedSize i = 0; i < (SignedSize)table.getNrSpectra(); ++i)
+    {
+      const Size end = std::min(offsets[i + 1], offsets[i] + n);
+      std::fill(keep.begin() + offsets[i], keep.begin() + end, 1);
+    }
+    table.filterRows(keep);
+  }
+
+  void IDFilter::removeDecoyHits(PSMTable& table)
+  {
+    const vector<PSMTable::TargetDecoy>& target_decoy = table.getTargetDecoy();
+    vector<uint8_t> keep(table.size());
+#pragma omp parallel for
+    for (SignedSize r = 0; r < (SignedSize)table.size(); ++r)
+    {
+      keep[r] = target_decoy[r] != PSMTable::TargetDecoy::DECOY;
+    }
+    table.filterRows(keep);
+  }
+
+  void IDFilter::keepBestPerPeptide(PSMTable& table, bool ignore_mods, bool ignore_charges, Size nr_best_spectrum)
+  {
+    // make sure that first = best hit
+    table.sortHits();
+
+    // lookup key of every candidate row: (unmodified) sequence and (optionally) charge
+    constexpr UInt64 no_candidate = std::numeric_limits<UInt64>::max();
+    const vector<UInt32>& sequence_ids = table.getSequenceIds();
+    const vector<Int>& charges = table.getCharges();
+    const vector<Size> offsets = table.getSpectrumOffsets();
+    vector<UInt64> keys(table.size(), no_candidate);
+#pragma omp parallel for schedule(dynamic, 256)
+    for (SignedSize i = 0; i < (SignedSize)table.getNrSpectra(); ++i)
+    {
+      const Size end = nr_best_spectrum == 0 ? offsets[i + 1] : std::min(offsets[i + 1], offsets[i] + nr_best_spectrum);
+      for (Size r = offsets[i]; r < end; ++r)
+      {
+        const UInt64 sequence = ignore_mods ? table.getUnmodifiedSequenceId(sequence_ids[r]) : sequence_ids[r];
+        keys[r] = (sequence << 32) | UInt32(ignore_charges ? 0 : charges[r]);
+      }
+    }
+
+    // the keys are partitioned between threads; each thread finds the best rows of its keys
+    const vector<double>& scores = std::as_const(table).getScores();
+    const bool higher_better = table.isHigherScoreBetter();
+    vector<uint8_t> keep(table.size(), 0);
+    int n_parts = 1;
+#ifdef _OPENMP
+    n_parts = omp_get_max_threads();
+#endif
+#pragma omp parallel for schedule(static, 1)
+    for (int part = 0; part < n_parts; ++part)
+    {
+      unordered_map<UInt64, Size> best;
+      for (Size r = 0; r < keys.size(); ++r)
+      {
+        if (keys[r] == no_candidate || (keys[r] * 0x9E3779B97F4A7C15ULL >> 32) % n_parts != UInt64(part)) continue;
+        auto [it, inserted] = best.emplace(keys[r], r);
+        if (!inserted && (higher_better ? scores[r] > scores[it->second] : scores[r] < scores[it->second]))
+        {
+          it->second = r;
+        }
+      }
+      for (const auto& entry : best)
+      {
+        keep[entry.second] = 1;
+      }
+    }
+    table.filterRows(keep);
+    table.addNumericColumn("best_per_peptide", true).assign(table.size(), 1.0);
+  }
+
   void IDFilter::keepBestMatchPerObservation(IdentificationData& id_data, IdentificationData::ScoreTypeRef score_ref)
   {
     if (id_data.getObservationMatches().size() <= 1)
@@ -132,6 +132,5 @@ cdef extern from "<OpenMS/CHEMISTRY/AASequence.h>" namespace "OpenMS::AASequence
         
         # static members
         AASequence fromString(String s, bool permissive) except + nogil   # wrap-attach:AASequence wrap-as:fromStringPermissive
-        
-        # static members
         AASequence fromString(String s) except + nogil   # wrap-attach:AASequence
+        AASequence fromStringCached(String s) except + nogil   # wrap-attach:AASequence
@@ -72,6 +72,7 @@ cdef extern from "<OpenMS/CHEMISTRY/ModificationsDB.h>" namespace "OpenMS":
                 #  :return: A pointer to the best matching modification (or NULL if none was found)
 
         void getAllSearchModifications(libcpp_vector[ String ] & modifications) except + nogil  # wrap-doc:Collects all modifications that can be used for identification searches
+        void freeze() except + nogil  # wrap-doc:Moves all modifications added at runtime into the frozen (lock-free) part of the database. Not thread-safe
 
         bool isInstantiated() except + nogil  # wrap-doc:Check whether ModificationsDB was instantiated before
 
@@ -11,6 +11,15 @@ cdef extern from "<OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>" namespace "O
         OpenSwathOSWWriter(OpenSwathOSWWriter &) except + nogil  # compiler
 
         bool isActive() except + nogil 
+        void enableBulkWrite(Size rows_per_transaction, Size max_queued_rows, bool synchronous) except + nogil
+            # wrap-doc:
+                #  Enables bulk writing through a dedicated writer thread (call before writeHeader)
+                #  
+                #  
+                #  :param rows_per_transaction: Number of inserted rows after which the current transaction is committed
+                #  :param max_queued_rows: Number of rows which may wait for the writer thread before enqueueFeatures blocks
+                #  :param synchronous: If false, SQLite neither waits for the data to reach the disk nor keeps its journal on disk (faster, but a crash can leave a corrupt file)
+        bool isBulkWriting() except + nogil  # wrap-doc:Whether the writer thread is running (i.e. enqueueFeatures should be used)
         void writeHeader() except + nogil  # wrap-doc:Initializes file by generating SQLite tables
         String prepareLine(LightCompound & compound, LightTransition * tr, FeatureMap & output, String id_) except + nogil 
             # wrap-doc:
@@ -34,3 +43,13 @@ cdef extern from "<OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>" namespace "O
                 #  
                 #  :param to_osw_output: Statements generated by prepareLine
 
+        bool enqueueFeatures(const FeatureMap & output, const String & id_) except + nogil 
+            # wrap-doc:
+                #  Hand features to the writer thread (bulk writing only)
+                #  
+                #  
+                #  :param output: The feature map containing all features (each feature will generate one entry in the output)
+                #  :param id: The transition group identifier (peptide/metabolite id)
+                #  :return: Whether the features were queued (false if the writer thread has failed, the error is raised by finishBulkWrite)
+
+        void finishBulkWrite() except + nogil  # wrap-doc:Flushes all queued rows, stops the writer thread and creates the table indices
@@ -17,6 +17,7 @@ cdef extern from "<OpenMS/CHEMISTRY/ResidueDB.h>" namespace "OpenMS":
         const Residue * getModifiedResidue(Residue * residue, const String & name) except + nogil  # wrap-doc:Returns a pointer to a modified residue given a residue and a modification name
         libcpp_set[ const Residue * ] getResidues(const String & residue_set) except + nogil  # wrap-doc:Returns a set of all residues stored in this residue db
         libcpp_set[ String ] getResidueSets() except + nogil  # wrap-doc:Returns all residue sets that are registered which this instance
+        void freeze() except + nogil  # wrap-doc:Moves all modified residues created so far into the frozen (lock-free) part of the database. Not thread-safe
         bool hasResidue(const String & name) except + nogil  # wrap-doc:Returns true if the db contains a residue with the given name
         # bool hasResidue(Residue * residue) except + nogil  # does not really work as the ptr is different
 
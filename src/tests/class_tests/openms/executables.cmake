@@ -106,6 +106,7 @@ set(metadata_executables_list
   PeptideEvidence_test
   PeptideHit_test
   PeptideIdentification_test
+  PSMTable_test
   Precursor_test
   Product_test
   ProteinHit_test
@@ -188,6 +189,7 @@ set(format_executables_list
   GzipInputStream_test
   IBSpectraFile_test
   IdXMLFile_test
+  IdXMLWritingConsumer_test
   IndentedStream_test
   IndexedMzMLDecoder_test
   IndexedMzMLFile_test
@@ -203,6 +205,7 @@ set(format_executables_list
   MascotInfile_test
   MascotRemoteQuery_test
   MascotXMLFile_test
+  MappedIndexFile_test
   #MSDataWritingConsumer_test
   MRMFeaturePickerFile_test
   MsInspectFile_test
@@ -367,6 +370,7 @@ set(comparison_executables_list
   SpectrumAlignmentScore_test
   SpectrumAlignment_test
   SpectrumCheapDPCorr_test
+  SpectrumComparisonKernels_test
   SpectrumPrecursorComparator_test
   SteinScottImproveScore_test
   ZhangSimilarityScore_test
@@ -392,6 +396,7 @@ set(chemistry_executables_list
   IntegerMassDecomposer_test
   IsoSpec_test
   IsotopeDistribution_test
+  IsotopeDistributionCache_test
   MassDecomposer_test
   ModificationDefinition_test
   ModificationDefinitionsSet_test
@@ -498,6 +503,7 @@ set(analysis_executables_list
   MassDecomposition_test
   MassFeatureTrace_test
   MetaboliteFeatureDeconvolution_test
+  MetaboliteSpectralLibraryIndex_test
   MetaboliteSpectralMatching_test
   ModifiedPeptideGenerator_test
   NeedlemanWunsch_test
@@ -508,6 +514,9 @@ set(analysis_executables_list
   PeakGroup_test
   PScore_test
   HyperScore_test
+  FragmentIndex_test
+  DigestStore_test
+  SpectralLibraryIndex_test
   MorpheusScore_test
   OpenPepXLAlgorithm_test
   OpenPepXLLFAlgorithm_test
@@ -594,12 +603,14 @@ if(NOT DISABLE_OPENSWATH)
     MRMIonSeries_test
     MRMRTNormalizer_test
     TransitionTSVFile_test
+    TransitionBinaryFile_test
     TransitionPQPFile_test
     ChromatogramExtractor_test
     ChromatogramExtractorAlgorithm_test
     OpenSwathHelper_test
     OpenSwathScoring_test
     OpenSwathScores_test
+    OpenSwathOSWWriter_test
     PeakIntegrator_test
     PeakPickerChromatogram_test
     MRMTransitionGroupPicker_test
@@ -294,6 +294,37 @@ START_SECTION(AASequence fromString(const String& s, bool permissive = true))
 }
 END_SECTION
 
+START_SECTION(AASequence fromStringCached(const String& s, bool permissive = true))
+{
+  for (const String& seq : {"PEPTIDE", "PEPM[+15.995]TIDE", ".[+42.011]PEPTIDEK[+8.014].", "PEPTIDE"})
+  {
+    AASequence aas = AASequence::fromStringCached(seq);
+    TEST_EQUAL(aas, AASequence::fromString(seq))
+    TEST_EQUAL(aas.toString(), AASequence::fromString(seq).toString())
+  }
+  // cached results are independent copies
+  AASequence aas = AASequence::fromStringCached("PEPTIDE");
+  aas += ResidueDB::getInstance()->getResidue('K');
+  TEST_EQUAL(AASequence::fromStringCached("PEPTIDE").size(), 7)
+
+  // parsing options are part of the key
+  TEST_EQUAL(AASequence::fromStringCached("PEP TIDE").toString(), "PEPTIDE")
+  TEST_EXCEPTION(Exception::ParseError, AASequence::fromStringCached("PEP TIDE", false))
+  // invalid strings are not cached
+  TEST_EXCEPTION(Exception::ParseError, AASequence::fromStringCached("PEPTIDE[+"))
+  TEST_EXCEPTION(Exception::ParseError, AASequence::fromStringCached("PEPTIDE[+"))
+
+  int n_different = 0;
+#pragma omp parallel for reduction (+: n_different)
+  for (int k = 0; k < 2000; ++k)
+  {
+    String seq = "TEST[+" + String(k % 20) + ".5]PEPTIDE";
+    if (AASequence::fromStringCached(seq) != AASequence::fromString(seq)) ++n_different;
+  }
+  TEST_EQUAL(n_different, 0)
+}
+END_SECTION
+
 START_SECTION(AASequence& operator=(const AASequence& rhs))
   AASequence seq = AASequence::fromString("AAA");
   AASequence seq2 = AASequence::fromString("AAA");
@@ -80,6 +80,22 @@ START_SECTION((double operator()(const BinnedSpectrum &spec) const ))
 }
 END_SECTION
 
+START_SECTION((void batchCompare(const BinnedSpectrum& query, const std::vector<const BinnedSpectrum*>& library, std::vector<double>& scores) const))
+{
+  PeakSpectrum s1;
+  DTAFile().load(OPENMS_GET_TEST_DATA_PATH("PILISSequenceDB_DFPIANGER_1.dta"), s1);
+  PeakSpectrum s2(s1);
+  s2.resize(50);
+  BinnedSpectrum bs1 (s1, 1.5, false, 2, BinnedSpectrum::DEFAULT_BIN_OFFSET_LOWRES);
+  BinnedSpectrum bs2 (s2, 1.5, false, 2, BinnedSpectrum::DEFAULT_BIN_OFFSET_LOWRES);
+  // query shorter than the library spectrum
+  std::vector<double> scores;
+  ptr->batchCompare(bs2, {&bs1}, scores);
+  TEST_EQUAL(scores.size(), 1)
+  TEST_EQUAL(scores[0], (*ptr)(bs2, bs1))
+}
+END_SECTION
+
 delete ptr;
 
 /////////////////////////////////////////////////////////////
@@ -0,0 +1,222 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/DigestStore.h>
+///////////////////////////
+
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(DigestStore, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+DigestStore* ptr = nullptr;
+DigestStore* nullPointer = nullptr;
+
+START_SECTION(DigestStore())
+{
+  ptr = new DigestStore();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOpen(), false)
+  TEST_EQUAL(ptr->getNrPeptides(), 0)
+}
+END_SECTION
+
+START_SECTION(~DigestStore())
+{
+  delete ptr;
+}
+END_SECTION
+
+// small database: one shared peptide, one peptide with a methionine and one with an ambiguous residue
+String fasta_file;
+NEW_TMP_FILE(fasta_file)
+{
+  ofstream os(fasta_file.c_str());
+  os << ">P1 first protein\nPEPTIDEKAAMAAR\n>P2 second protein\nPEPTIDEKCCCCCR\n>P3 third protein\nAAXAAR\n";
+}
+
+DigestStore::Parameters params;
+params.missed_cleavages = 0;
+params.min_length = 4;
+params.variable_modifications = {"Oxidation (M)"};
+
+String store_file;
+NEW_TMP_FILE(store_file)
+
+START_SECTION(String Parameters::getFingerprint() const)
+{
+  DigestStore::Parameters other = params;
+  TEST_EQUAL(params.getFingerprint(), other.getFingerprint())
+  other.missed_cleavages = 2;
+  TEST_NOT_EQUAL(params.getFingerprint(), other.getFingerprint())
+}
+END_SECTION
+
+START_SECTION((static void create(const String& filename, const String& fasta_file, const Parameters& params)))
+{
+  DigestStore::create(store_file, fasta_file, params);
+  TEST_EQUAL(File::exists(store_file), true)
+  TEST_EXCEPTION(Exception::FileNotFound, DigestStore::create(store_file, "this_file_does_not_exist.fasta", params))
+}
+END_SECTION
+
+START_SECTION((static bool isUpToDate(const String& filename, const String& fasta_file, const Parameters& params)))
+{
+  TEST_EQUAL(DigestStore::isUpToDate(store_file, fasta_file, params), true)
+  DigestStore::Parameters other = params;
+  other.variable_modifications.clear();
+  TEST_EQUAL(DigestStore::isUpToDate(store_file, fasta_file, other), false)
+  TEST_EQUAL(DigestStore::isUpToDate("this_file_does_not_exist.digest", fasta_file, params), false)
+  TEST_EQUAL(DigestStore::isUpToDate(fasta_file, fasta_file, params), false)
+}
+END_SECTION
+
+DigestStore store;
+
+START_SECTION(void open(const String& filename))
+{
+  store.open(store_file);
+  TEST_EQUAL(store.isOpen(), true)
+  TEST_EXCEPTION(Exception::FileNotFound, DigestStore().open("this_file_does_not_exist.digest"))
+  TEST_EXCEPTION(Exception::ParseError, DigestStore().open(fasta_file))
+}
+END_SECTION
+
+START_SECTION(Size getNrProteins() const)
+{
+  TEST_EQUAL(store.getNrProteins(), 3)
+}
+END_SECTION
+
+START_SECTION(std::string_view getProteinAccession(Size index) const)
+{
+  TEST_EQUAL(String(store.getProteinAccession(0)), "P1")
+  TEST_EQUAL(String(store.getProteinAccession(2)), "P3")
+}
+END_SECTION
+
+START_SECTION(Size getNrPeptides() const)
+{
+  // PEPTIDEK, AAMAAR, AAM(Oxidation)AAR, CCCCCR (AAXAAR is skipped)
+  TEST_EQUAL(store.getNrPeptides(), 4)
+}
+END_SECTION
+
+START_SECTION(const PeptideRecord& getPeptide(Size index) const)
+{
+  for (Size i = 1; i < store.getNrPeptides(); ++i)
+  {
+    TEST_EQUAL(store.getPeptide(i - 1).mass <= store.getPeptide(i).mass, true)
+  }
+}
+END_SECTION
+
+START_SECTION(std::string_view getSequence(Size index) const)
+{
+  for (Size i = 0; i < store.getNrPeptides(); ++i)
+  {
+    TEST_REAL_SIMILAR(store.getPeptide(i).mass, AASequence::fromString(String(store.getSequence(i))).getMonoWeight())
+  }
+}
+END_SECTION
+
+START_SECTION(std::string_view getString(StringIndex index) const)
+{
+  TEST_EQUAL(String(store.getString(0)), "")
+  for (Size i = 0; i < store.getNrPeptides(); ++i)
+  {
+    const auto& pep = store.getPeptide(i);
+    if (store.getSequence(i) == "AAM(Oxidation)AAR")
+    {
+      TEST_EQUAL(String(store.getString(pep.unmodified_sequence)), "AAMAAR")
+      TEST_EQUAL(pep.variant_index, 1)
+    }
+    else if (store.getSequence(i) == "AAMAAR")
+    {
+      TEST_EQUAL(pep.variant_index, 0)
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(UInt32 getProteinRef(Size index) const)
+{
+  for (Size i = 0; i < store.getNrPeptides(); ++i)
+  {
+    const auto& pep = store.getPeptide(i);
+    if (store.getSequence(i) == "PEPTIDEK")
+    {
+      TEST_EQUAL(pep.nr_protein_refs, 2)
+      TEST_EQUAL(store.getProteinRef(pep.first_protein_ref), 0)
+      TEST_EQUAL(store.getProteinRef(pep.first_protein_ref + 1), 1)
+    }
+    else if (store.getSequence(i) == "CCCCCR")
+    {
+      TEST_EQUAL(pep.nr_protein_refs, 1)
+      TEST_EQUAL(store.getProteinRef(pep.first_protein_ref), 1)
+    }
+  }
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getPeptideRange(double min_mass, double max_mass) const))
+{
+  const double mass = AASequence::fromString("PEPTIDEK").getMonoWeight();
+  auto range = store.getPeptideRange(mass - 0.01, mass + 0.01);
+  TEST_EQUAL(range.second - range.first, 1)
+  TEST_EQUAL(String(store.getSequence(range.first)), "PEPTIDEK")
+  range = store.getPeptideRange(0.0, 1e6);
+  TEST_EQUAL(range.first, 0)
+  TEST_EQUAL(range.second, 4)
+  range = store.getPeptideRange(10.0, 20.0);
+  TEST_EQUAL(range.first, range.second)
+}
+END_SECTION
+
+START_SECTION(void close())
+{
+  store.close();
+  TEST_EQUAL(store.isOpen(), false)
+  TEST_EQUAL(store.getNrPeptides(), 0)
+}
+END_SECTION
+
+START_SECTION((void openOrCreate(const String& filename, const String& fasta_file, const Parameters& params)))
+{
+  String new_store;
+  NEW_TMP_FILE(new_store)
+  DigestStore s;
+  s.openOrCreate(new_store, fasta_file, params);
+  TEST_EQUAL(s.isOpen(), true)
+  TEST_EQUAL(s.getNrPeptides(), 4)
+  s.close();
+
+  // other settings: the store is recreated
+  DigestStore::Parameters other = params;
+  other.variable_modifications.clear();
+  s.openOrCreate(new_store, fasta_file, other);
+  TEST_EQUAL(s.getNrPeptides(), 3)
+  TEST_EQUAL(DigestStore::isUpToDate(new_store, fasta_file, other), true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -75,6 +75,17 @@ START_SECTION(const Element* getElement(const string& name) const)
   const Element * e2 = e_ptr->getElement("H");
   TEST_EQUAL(e1, e2);
   TEST_NOT_EQUAL(e1, elem_nullPointer);
+
+  // short symbols (lookup table) agree with the symbol map
+  for (const auto& entry : e_ptr->getSymbols())
+  {
+    TEST_EQUAL(e_ptr->getElement(entry.first), entry.second)
+  }
+  TEST_EQUAL(e_ptr->getElement("Cl")->getName(), "Chlorine")
+  TEST_EQUAL(e_ptr->getElement("D"), e_ptr->getElement("(2)H"))
+  TEST_EQUAL(e_ptr->getElement("Xx"), elem_nullPointer)
+  TEST_EQUAL(e_ptr->getElement("cl"), elem_nullPointer)
+  TEST_EQUAL(e_ptr->getElement(""), elem_nullPointer)
 END_SECTION
 
 START_SECTION(const Element* getElement(unsigned int atomic_number) const)
@@ -80,6 +80,38 @@ START_SECTION(bool cacheChunk(int suggested_size))
   TEST_EQUAL(fv.cacheChunk(333), 0)
 END_SECTION
 
+START_SECTION(void prefetchChunk(int suggested_size))
+  FCVec fv(fev);
+  fv.prefetchChunk(333);
+  TEST_EQUAL(fv.activateCache(), 1)
+  TEST_EQUAL(fv.chunkSize(), 4)
+
+  // read the file in chunks of two entries, always prefetching the next chunk
+  FCFile f(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  f.prefetchChunk(2);
+  std::vector<FASTAFile::FASTAEntry> entries;
+  while (f.activateCache())
+  {
+    f.prefetchChunk(2);
+    for (Size i = 0; i < f.chunkSize(); ++i)
+    {
+      entries.push_back(f.chunkAt(i));
+    }
+  }
+  TEST_EQUAL(entries.size(), 5)
+  TEST_EQUAL(f.size(), 5)
+  TEST_EQUAL(entries[4].identifier, "test")
+  FASTAFile::FASTAEntry pe;
+  TEST_EQUAL(f.readAt(pe, 2), true);
+  TEST_TRUE(pe == entries[2])
+
+  // a prefetch which is not activated is finished before reset() and destruction
+  f.reset();
+  f.prefetchChunk(3);
+  f.reset();
+  f.prefetchChunk(3);
+END_SECTION
+
 START_SECTION(size_t chunkSize() const)
   // FCFile: tested below
   FCVec fv(fev);
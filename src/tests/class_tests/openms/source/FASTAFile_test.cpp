@@ -18,6 +18,7 @@
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/CHEMISTRY/AASequence.h>
 
+#include <fstream>
 #include <vector>
 
 ///////////////////////////
@@ -269,6 +270,34 @@ START_SECTION([EXTRA] test_position)
   }
 END_SECTION
 
+START_SECTION([EXTRA] load() of a large file gives the same result as readNext())
+  // large enough to be split into several chunks which are parsed in parallel
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  {
+    ofstream os(tmp_filename.c_str());
+    for (Size i = 0; i < 40000; ++i)
+    {
+      os << ">prot_" << i << " description " << i << "\n";
+      if (i % 1000 == 0) os << ">sequence_starting_with_gt\n"; // directly after the header, this line is part of the sequence
+      os << String(i % 100 + 1, "ACDEFGHIKLMNPQRSTVWY"[i % 20]) << "\n" << "PEPTIDE\n";
+    }
+  }
+  vector<FASTAFile::FASTAEntry> data, data2;
+  FASTAFile file;
+  file.load(tmp_filename, data);
+  file.readStart(tmp_filename);
+  FASTAFile::FASTAEntry entry;
+  while (file.readNext(entry))
+  {
+    data2.push_back(entry);
+  }
+  TEST_EQUAL(data.size(), 40000)
+  TEST_TRUE(data == data2)
+  TEST_EQUAL(data[1000].sequence, ">sequence_starting_with_gt" + String(1, 'A') + "PEPTIDE")
+
+  TEST_EXCEPTION(Exception::ParseError, file.load(OPENMS_GET_TEST_DATA_PATH("degenerate_cases/empty.fasta"), data))
+END_SECTION
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
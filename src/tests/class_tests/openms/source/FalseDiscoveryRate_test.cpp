@@ -9,6 +9,7 @@
 #include <OpenMS/CONCEPT/ClassTest.h>
 #include <OpenMS/test_config.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/METADATA/PSMTable.h>
 
 ///////////////////////////
 #include <OpenMS/ANALYSIS/ID/FalseDiscoveryRate.h>
@@ -151,6 +152,64 @@ START_SECTION((void apply(std::vector<PeptideIdentification> &id)))
 }
 END_SECTION
 
+START_SECTION((void apply(PSMTable& table, bool annotate_peptide_fdr = false) const))
+{
+  vector<ProteinIdentification> prot_ids;
+  vector<PeptideIdentification> orig_ids;
+  IdXMLFile().load(OPENMS_GET_TEST_DATA_PATH("FalseDiscoveryRate_OMSSA.idXML"), prot_ids, orig_ids);
+
+  // same results as the vector version for all grouping options
+  for (Size option = 0; option < 4; ++option)
+  {
+    FalseDiscoveryRate fdr;
+    Param p = fdr.getParameters();
+    p.setValue("use_all_hits", option == 1 ? "true" : "false");
+    p.setValue("split_charge_variants", option == 2 ? "true" : "false");
+    p.setValue("add_decoy_peptides", option == 3 ? "true" : "false");
+    fdr.setParameters(p);
+
+    vector<PeptideIdentification> expected = orig_ids, pep_ids = orig_ids;
+    fdr.apply(expected, true);
+    PSMTable table;
+    table.importIDs(pep_ids);
+    fdr.apply(table, true);
+    TEST_EQUAL(table.getScoreType(), "q-value")
+    TEST_EQUAL(table.isHigherScoreBetter(), false)
+    table.exportIDs(pep_ids);
+
+    TEST_EQUAL(pep_ids.size(), expected.size())
+    ABORT_IF(pep_ids.size() != expected.size())
+    for (Size i = 0; i < pep_ids.size(); ++i)
+    {
+      TEST_EQUAL(pep_ids[i].getScoreType(), expected[i].getScoreType())
+      TEST_EQUAL(pep_ids[i].getHits().size(), expected[i].getHits().size())
+      ABORT_IF(pep_ids[i].getHits().size() != expected[i].getHits().size())
+      for (Size j = 0; j < pep_ids[i].getHits().size(); ++j)
+      {
+        const PeptideHit& hit = pep_ids[i].getHits()[j];
+        const PeptideHit& exp_hit = expected[i].getHits()[j];
+        TEST_EQUAL(hit.getSequence(), exp_hit.getSequence())
+        TEST_REAL_SIMILAR(hit.getScore(), exp_hit.getScore())
+        TEST_EQUAL(hit.getRank(), exp_hit.getRank())
+        TEST_REAL_SIMILAR(hit.getMetaValue("OMSSA_score"), exp_hit.getMetaValue("OMSSA_score"))
+        TEST_EQUAL(hit.metaValueExists("peptide q-value"), exp_hit.metaValueExists("peptide q-value"))
+        if (exp_hit.metaValueExists("peptide q-value"))
+        {
+          TEST_REAL_SIMILAR(hit.getMetaValue("peptide q-value"), exp_hit.getMetaValue("peptide q-value"))
+        }
+      }
+    }
+  }
+
+  // no target/decoy annotation
+  vector<PeptideIdentification> pep_ids(1);
+  pep_ids[0].getHits().resize(1);
+  PSMTable table;
+  table.importIDs(pep_ids);
+  TEST_EXCEPTION(Exception::MissingInformation, ptr->apply(table))
+}
+END_SECTION
+
 START_SECTION((void apply(std::vector<ProteinIdentification>& ids)))
 {
   vector<ProteinIdentification> fwd_prot_ids, rev_prot_ids, prot_ids;
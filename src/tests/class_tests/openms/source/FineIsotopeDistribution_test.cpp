@@ -435,6 +435,26 @@ START_SECTION(( void setAbsolute(bool absolute) ))
 }
 END_SECTION
 
+START_SECTION(( void setCaching(bool caching) ))
+{
+  FineIsotopePatternGenerator gen(0.01, false, false);
+  TEST_EQUAL(gen.getCaching(), false)
+
+  // the cached distribution is identical to the computed one
+  EmpiricalFormula ef ("C520H817N139O147S8");
+  IsotopeDistribution computed = gen.run(ef);
+  gen.setCaching(true);
+  IsotopeDistribution cached = gen.run(ef);
+  cached = gen.run(ef);
+  TEST_EQUAL(cached.size(), computed.size())
+  ABORT_IF(cached.size() != computed.size())
+  for (Size i = 0; i < computed.size(); ++i)
+  {
+    TEST_EQUAL(cached[i].getMZ(), computed[i].getMZ())
+    TEST_EQUAL(cached[i].getIntensity(), computed[i].getIntensity())
+  }
+}
+END_SECTION
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
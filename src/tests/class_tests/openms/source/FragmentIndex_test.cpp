@@ -0,0 +1,251 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+///////////////////////////
+
+#include <OpenMS/SYSTEM/File.h>
+
+#include <cmath>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(FragmentIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+FragmentIndex* ptr = nullptr;
+FragmentIndex* nullPointer = nullptr;
+
+START_SECTION(FragmentIndex())
+{
+  ptr = new FragmentIndex();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getNrPeptides(), 0)
+  TEST_EQUAL(ptr->isBuilt(), false)
+}
+END_SECTION
+
+START_SECTION(~FragmentIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+// two sequences, the first one with two (modified) variants
+FragmentIndex index;
+
+START_SECTION(UInt32 addSequence(const String& sequence))
+{
+  TEST_EQUAL(index.addSequence("AAAK"), 0)
+  TEST_EQUAL(index.addSequence("CCR"), 1)
+  TEST_EQUAL(index.getNrSequences(), 2)
+}
+END_SECTION
+
+START_SECTION((void addPeptide(UInt32 sequence, UInt32 modification_index, double mass, const std::vector<double>& fragment_mz)))
+{
+  index.addPeptide(0, 0, 500.0, {300.0, 100.0, 200.0});
+  index.addPeptide(0, 1, 516.0, {100.0, 216.0, 316.0});
+  index.addPeptide(1, 0, 450.0, {150.0, 200.0, 250.0});
+  TEST_EQUAL(index.getNrPeptides(), 3)
+  TEST_EQUAL(index.getNrFragments(), 9)
+  TEST_EQUAL(index.isBuilt(), false)
+}
+END_SECTION
+
+START_SECTION(void build(Size bucket_size = 8192))
+{
+  index.build(2);
+  TEST_EQUAL(index.isBuilt(), true)
+  TEST_EQUAL(index.getBucketSize(), 2)
+  TEST_EXCEPTION(Exception::InvalidValue, FragmentIndex().build(0))
+}
+END_SECTION
+
+START_SECTION(const Peptide& getPeptide(Size index) const)
+{
+  // sorted by mass
+  TEST_REAL_SIMILAR(index.getPeptide(0).mass, 450.0)
+  TEST_EQUAL(index.getPeptide(0).sequence, 1)
+  TEST_REAL_SIMILAR(index.getPeptide(1).mass, 500.0)
+  TEST_EQUAL(index.getPeptide(1).modification_index, 0)
+  TEST_REAL_SIMILAR(index.getPeptide(2).mass, 516.0)
+  TEST_EQUAL(index.getPeptide(2).sequence, 0)
+  TEST_EQUAL(index.getPeptide(2).modification_index, 1)
+}
+END_SECTION
+
+START_SECTION(StringView getSequence(UInt32 index) const)
+{
+  TEST_EQUAL(index.getSequence(0).getString(), "AAAK")
+  TEST_EQUAL(index.getSequence(1).getString(), "CCR")
+  TEST_EQUAL(index.getSequence(index.getPeptide(0).sequence).size(), 3)
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getPeptideRange(double min_mass, double max_mass) const))
+{
+  std::pair<Size, Size> range = index.getPeptideRange(490.0, 510.0);
+  TEST_EQUAL(range.first, 1)
+  TEST_EQUAL(range.second, 2)
+  range = index.getPeptideRange(450.0, 516.0);
+  TEST_EQUAL(range.first, 0)
+  TEST_EQUAL(range.second, 3)
+  range = index.getPeptideRange(600.0, 700.0);
+  TEST_EQUAL(range.first, range.second)
+}
+END_SECTION
+
+START_SECTION((void query(const MSSpectrum& spectrum, const std::vector<std::pair<Size, Size>>& peptide_ranges, double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, Size max_candidates, Accumulator& accumulator, std::vector<Candidate>& candidates) const))
+{
+  MSSpectrum spec;
+  spec.emplace_back(100.0, 1.0f);
+  spec.emplace_back(200.0, 2.0f);
+  spec.emplace_back(300.02, 3.0f);
+
+  FragmentIndex::Accumulator acc;
+  vector<FragmentIndex::Candidate> candidates;
+  index.query(spec, {{0, 3}}, 0.5, false, 10, acc, candidates);
+  TEST_EQUAL(candidates.size(), 3)
+  ABORT_IF(candidates.size() != 3)
+  TEST_EQUAL(candidates[0].peptide, 1)
+  TEST_EQUAL(candidates[0].matched_peaks, 3)
+  TEST_REAL_SIMILAR(candidates[0].score, std::log1p(6.0) + std::log(6.0))
+  TEST_EQUAL(candidates[1].peptide, 0)
+  TEST_EQUAL(candidates[1].matched_peaks, 1)
+  TEST_EQUAL(candidates[2].peptide, 2)
+  TEST_REAL_SIMILAR(candidates[2].score, std::log1p(1.0))
+
+  // the accumulator is reset after each query
+  index.query(spec, {{0, 3}}, 0.5, false, 2, acc, candidates);
+  TEST_EQUAL(candidates.size(), 2)
+  TEST_EQUAL(candidates[0].matched_peaks, 3)
+
+  // overlapping ranges do not count fragments twice, peptides outside of the ranges are ignored
+  index.query(spec, {{1, 3}, {1, 2}}, 0.5, false, 10, acc, candidates);
+  TEST_EQUAL(candidates.size(), 2)
+  TEST_EQUAL(candidates[0].peptide, 1)
+  TEST_EQUAL(candidates[0].matched_peaks, 3)
+  TEST_EQUAL(candidates[1].peptide, 2)
+
+  // ppm tolerance: 300.02 is 67 ppm away from 300
+  index.query(spec, {{1, 2}}, 50.0, true, 10, acc, candidates);
+  TEST_EQUAL(candidates.size(), 1)
+  TEST_EQUAL(candidates[0].matched_peaks, 2)
+  index.query(spec, {{1, 2}}, 100.0, true, 10, acc, candidates);
+  TEST_EQUAL(candidates[0].matched_peaks, 3)
+
+  index.query(spec, {{2, 2}}, 0.5, false, 10, acc, candidates);
+  TEST_EQUAL(candidates.empty(), true)
+
+  TEST_EXCEPTION(Exception::IllegalArgument, FragmentIndex().query(spec, {{0, 3}}, 0.5, false, 10, acc, candidates))
+}
+END_SECTION
+
+String tmp_file;
+NEW_TMP_FILE(tmp_file)
+
+START_SECTION((void store(const String& filename, const String& fingerprint) const))
+{
+  index.store(tmp_file, "enzyme=Trypsin");
+  TEST_EQUAL(File::exists(tmp_file), true)
+  TEST_EXCEPTION(Exception::IllegalArgument, FragmentIndex().store(tmp_file + "_unbuilt", ""))
+}
+END_SECTION
+
+START_SECTION((static bool isUpToDate(const String& filename, const String& fingerprint)))
+{
+  TEST_EQUAL(FragmentIndex::isUpToDate(tmp_file, "enzyme=Trypsin"), true)
+  TEST_EQUAL(FragmentIndex::isUpToDate(tmp_file, "enzyme=Lys-C"), false)
+  TEST_EQUAL(FragmentIndex::isUpToDate("this_file_does_not_exist.bin", "enzyme=Trypsin"), false)
+}
+END_SECTION
+
+START_SECTION(void load(const String& filename))
+{
+  FragmentIndex loaded;
+  loaded.load(tmp_file);
+  TEST_EQUAL(loaded.isBuilt(), true)
+  TEST_EQUAL(loaded.getNrSequences(), 2)
+  TEST_EQUAL(loaded.getNrPeptides(), 3)
+  TEST_EQUAL(loaded.getNrFragments(), 9)
+  TEST_EQUAL(loaded.getBucketSize(), 2)
+  TEST_EQUAL(loaded.getSequence(1).getString(), "CCR")
+  TEST_REAL_SIMILAR(loaded.getPeptide(2).mass, 516.0)
+
+  MSSpectrum spec;
+  spec.emplace_back(200.0, 2.0f);
+  spec.emplace_back(250.0, 1.0f);
+  FragmentIndex::Accumulator acc;
+  vector<FragmentIndex::Candidate> candidates, expected;
+  loaded.query(spec, {{0, 3}}, 0.5, false, 10, acc, candidates);
+  index.query(spec, {{0, 3}}, 0.5, false, 10, acc, expected);
+  TEST_EQUAL(candidates.size(), expected.size())
+  TEST_EQUAL(candidates[0].peptide, 0)
+  TEST_EQUAL(candidates[0].matched_peaks, 2)
+
+  FragmentIndex g;
+  TEST_EXCEPTION(Exception::FileNotFound, g.load("this_file_does_not_exist.bin"))
+  TEST_EXCEPTION(Exception::ParseError, g.load(OPENMS_GET_TEST_DATA_PATH("ExperimentalDesign_input_1.tsv")))
+  TEST_EQUAL(g.isBuilt(), false)
+}
+END_SECTION
+
+// entries without a sequence, e.g. library spectra
+FragmentIndex entry_index;
+
+START_SECTION((void addEntry(UInt32 id, double mass, const std::vector<double>& fragment_mz)))
+{
+  entry_index.addEntry(7, 300.0, {100.0, 150.0});
+  entry_index.addEntry(3, 200.0, {100.0, 120.0});
+  TEST_EQUAL(entry_index.getNrSequences(), 0)
+  TEST_EQUAL(entry_index.getNrPeptides(), 2)
+  TEST_EQUAL(entry_index.getNrFragments(), 4)
+  entry_index.build();
+  TEST_EQUAL(entry_index.getPeptide(0).sequence, FragmentIndex::NO_SEQUENCE)
+}
+END_SECTION
+
+START_SECTION(UInt32 getEntryId(Size index) const)
+{
+  // sorted by mass
+  TEST_EQUAL(entry_index.getEntryId(0), 3)
+  TEST_EQUAL(entry_index.getEntryId(1), 7)
+  // for peptides, the modification index
+  TEST_EQUAL(index.getEntryId(2), 1)
+
+  MSSpectrum spec;
+  spec.emplace_back(150.0, 1.0f);
+  FragmentIndex::Accumulator acc;
+  vector<FragmentIndex::Candidate> candidates;
+  entry_index.query(spec, {{0, 2}}, 0.5, false, 10, acc, candidates);
+  TEST_EQUAL(candidates.size(), 1)
+  ABORT_IF(candidates.size() != 1)
+  TEST_EQUAL(entry_index.getEntryId(candidates[0].peptide), 7)
+
+  // entries survive storing and loading
+  String entry_file;
+  NEW_TMP_FILE(entry_file)
+  entry_index.store(entry_file, "");
+  FragmentIndex loaded;
+  loaded.load(entry_file);
+  TEST_EQUAL(loaded.getNrPeptides(), 2)
+  TEST_EQUAL(loaded.getEntryId(1), 7)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -91,6 +91,56 @@ START_SECTION((static double compute(double fragment_mass_tolerance, bool fragme
 }
 END_SECTION
 
+START_SECTION((static double computeWithDetail(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const PeakSpectrum& exp_spectrum, const TheoreticalSpectrumGenerator::FragmentBuffer& theo_fragments, PSMDetail& d)))
+{
+  PeakSpectrum exp_spectrum;
+  PeakSpectrum theo_spectrum;
+  TheoreticalSpectrumGenerator::PrefixSuffixMasses masses;
+  TheoreticalSpectrumGenerator::FragmentBuffer theo_fragments;
+  HyperScore::PSMDetail d, d_spec;
+
+  AASequence peptide = AASequence::fromString("PEPTIDE");
+  TheoreticalSpectrumGenerator::getPrefixSuffixMasses(peptide, masses);
+
+  // empty spectrum
+  tsg.getFragmentMZs(masses, 1, 1, theo_fragments);
+  TEST_REAL_SIMILAR(HyperScore::computeWithDetail(0.1, false, exp_spectrum, theo_fragments, d), 0.0);
+
+  // full match, same result as for the theoretical spectrum
+  tsg.getSpectrum(exp_spectrum, peptide, 1, 1);
+  TEST_REAL_SIMILAR(HyperScore::computeWithDetail(0.1, false, exp_spectrum, theo_fragments, d), 13.8516496);
+  TEST_REAL_SIMILAR(HyperScore::computeWithDetail(10, true, exp_spectrum, theo_fragments, d), 13.8516496);
+  TEST_EQUAL(d.matched_b_ions, 5)
+  TEST_EQUAL(d.matched_y_ions, 6)
+
+  // partial match with errors and intensities
+  exp_spectrum.clear(true);
+  tsg.getSpectrum(exp_spectrum, peptide, 1, 3);
+  for (Size i = 0; i < exp_spectrum.size(); ++i)
+  {
+    exp_spectrum[i].setMZ(exp_spectrum[i].getMZ() + (i % 3) * 0.004);
+    exp_spectrum[i].setIntensity(1.0 + i);
+  }
+  tsg.getSpectrum(theo_spectrum, peptide, 1, 2);
+  tsg.getFragmentMZs(masses, 1, 2, theo_fragments);
+  for (double tolerance : {0.001, 0.005, 0.01})
+  {
+    const double expected = HyperScore::computeWithDetail(tolerance, false, exp_spectrum, theo_spectrum, d_spec);
+    TEST_REAL_SIMILAR(HyperScore::computeWithDetail(tolerance, false, exp_spectrum, theo_fragments, d), expected)
+    TEST_EQUAL(d.matched_b_ions, d_spec.matched_b_ions)
+    TEST_EQUAL(d.matched_y_ions, d_spec.matched_y_ions)
+    TEST_REAL_SIMILAR(d.mean_error, d_spec.mean_error)
+  }
+  for (double tolerance : {2.0, 10.0})
+  {
+    const double expected = HyperScore::computeWithDetail(tolerance, true, exp_spectrum, theo_spectrum, d_spec);
+    TEST_REAL_SIMILAR(HyperScore::computeWithDetail(tolerance, true, exp_spectrum, theo_fragments, d), expected)
+    TEST_EQUAL(d.matched_b_ions + d.matched_y_ions, d_spec.matched_b_ions + d_spec.matched_y_ions)
+    TEST_REAL_SIMILAR(d.mean_error, d_spec.mean_error)
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -18,6 +18,7 @@
 #include <OpenMS/PROCESSING/ID/IDFilter.h>
 #include <OpenMS/DATASTRUCTURES/String.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
+#include <OpenMS/METADATA/PSMTable.h>
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/CHEMISTRY/AASequence.h>
@@ -1036,6 +1037,104 @@ START_SECTION((template<class PeakT> static void keepHitsMatchingProteins(MSExpe
 }
 END_SECTION
 
+START_SECTION((static void filterHitsByScore(PSMTable& table, double threshold_score)))
+{
+  vector<PeptideIdentification> peptides = global_peptides, expected = global_peptides;
+  PSMTable table;
+  table.importIDs(peptides);
+  IDFilter::filterHitsByScore(table, 33);
+  TEST_EQUAL(table.size(), 5);
+  table.exportIDs(peptides);
+  IDFilter::filterHitsByScore(expected, 33);
+  TEST_EQUAL(peptides[0].getHits().size(), expected[0].getHits().size());
+  ABORT_IF(peptides[0].getHits().size() != expected[0].getHits().size());
+  for (Size i = 0; i < expected[0].getHits().size(); ++i)
+  {
+    TEST_EQUAL(peptides[0].getHits()[i].getSequence(), expected[0].getHits()[i].getSequence());
+    TEST_REAL_SIMILAR(peptides[0].getHits()[i].getScore(), expected[0].getHits()[i].getScore());
+  }
+  IDFilter::filterHitsByScore(table, 41);
+  TEST_EQUAL(table.empty(), true);
+  TEST_EQUAL(table.getNrSpectra(), 1);
+}
+END_SECTION
+
+START_SECTION((static void keepNBestHits(PSMTable& table, Size n)))
+{
+  vector<PeptideIdentification> peptides = global_peptides;
+  PSMTable table;
+  table.importIDs(peptides);
+  IDFilter::keepNBestHits(table, 3);
+  table.exportIDs(peptides);
+  vector<PeptideHit>& peptide_hits = peptides[0].getHits();
+  TEST_EQUAL(peptide_hits.size(), 3);
+  TEST_EQUAL(peptide_hits[0].getSequence().toString(), "FINFGVNVEVLSRFQTK");
+  TEST_EQUAL(peptide_hits[1].getSequence().toString(), "MSLLSNMISIVKVGYNAR");
+  TEST_EQUAL(peptide_hits[2].getSequence().toString(), "THPYGHAIVAGIERYPSK");
+  TEST_REAL_SIMILAR(peptide_hits[2].getScore(), 39);
+}
+END_SECTION
+
+START_SECTION((static void removeDecoyHits(PSMTable& table)))
+{
+  vector<PeptideIdentification> peptides(1);
+  peptides[0].getHits().resize(4);
+  peptides[0].getHits()[0].setMetaValue("target_decoy", "target");
+  peptides[0].getHits()[1].setMetaValue("target_decoy", "decoy");
+  peptides[0].getHits()[2].setMetaValue("target_decoy", "target+decoy");
+  // no meta value on hit 3
+  PSMTable table;
+  table.importIDs(peptides);
+  IDFilter::removeDecoyHits(table);
+  TEST_EQUAL(table.size(), 3);
+  table.exportIDs(peptides);
+  TEST_EQUAL(peptides[0].getHits().size(), 3);
+  TEST_EQUAL(peptides[0].getHits()[0].getMetaValue("target_decoy"), "target");
+  TEST_EQUAL(peptides[0].getHits()[1].getMetaValue("target_decoy"), "target+decoy");
+  TEST_EQUAL(peptides[0].getHits()[2].metaValueExists("target_decoy"), false);
+}
+END_SECTION
+
+START_SECTION((static void keepBestPerPeptide(PSMTable& table, bool ignore_mods, bool ignore_charges, Size nr_best_spectrum)))
+{
+  // same peptide in three spectra, with different charges and modifications
+  vector<PeptideIdentification> peptides(3);
+  peptides[0].getHits().push_back(PeptideHit(10.0, 1, 2, AASequence::fromString("PEPTIDEK")));
+  peptides[0].getHits().push_back(PeptideHit(5.0, 2, 2, AASequence::fromString("ELVISK")));
+  peptides[1].getHits().push_back(PeptideHit(20.0, 1, 2, AASequence::fromString("PEPT[+79.966]IDEK")));
+  peptides[2].getHits().push_back(PeptideHit(15.0, 1, 3, AASequence::fromString("PEPTIDEK")));
+  peptides[2].getHits().push_back(PeptideHit(1.0, 2, 2, AASequence::fromString("ELVISK")));
+  for (PeptideIdentification& pep : peptides)
+  {
+    pep.setScoreType("score");
+    pep.setHigherScoreBetter(true);
+  }
+
+  PSMTable table;
+  table.importIDs(peptides);
+  IDFilter::keepBestPerPeptide(table, false, false, 0);
+  TEST_EQUAL(table.size(), 4); // ELVISK/2 from spectrum 2 is removed
+
+  table.clear();
+  table.importIDs(peptides);
+  IDFilter::keepBestPerPeptide(table, true, true, 0);
+  TEST_EQUAL(table.size(), 2);
+  vector<PeptideIdentification> result = peptides;
+  table.exportIDs(result);
+  TEST_EQUAL(result[0].getHits().size(), 1);
+  TEST_EQUAL(result[0].getHits()[0].getSequence().toString(), "ELVISK");
+  TEST_EQUAL(result[0].getHits()[0].getMetaValue("best_per_peptide"), 1);
+  TEST_EQUAL(result[1].getHits().size(), 1);
+  TEST_EQUAL(result[2].getHits().size(), 0);
+
+  // only the best hit of every spectrum is considered
+  table.clear();
+  table.importIDs(peptides);
+  IDFilter::keepBestPerPeptide(table, false, true, 1);
+  TEST_EQUAL(table.size(), 2); // PEPTIDEK (spectrum 2) and PEPT[+79.966]IDEK
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 
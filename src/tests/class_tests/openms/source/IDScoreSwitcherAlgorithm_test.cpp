@@ -13,6 +13,7 @@
 #include <OpenMS/ANALYSIS/ID/IDScoreSwitcherAlgorithm.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
 #include <OpenMS/METADATA/ProteinIdentification.h>
+#include <OpenMS/METADATA/PSMTable.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 
 #include <vector>
@@ -60,6 +61,54 @@ START_SECTION(switchToGeneralScoreType)
 END_SECTION
 
 
+START_SECTION((void switchScores(PSMTable& table, Size& counter)))
+{
+  vector<PeptideIdentification> peptides(2);
+  peptides[0].getHits().resize(2);
+  peptides[0].getHits()[0].setScore(30.0);
+  peptides[0].getHits()[0].setMetaValue("q-value", 0.01);
+  peptides[0].getHits()[1].setScore(20.0);
+  peptides[0].getHits()[1].setMetaValue("q-value", 0.05);
+  peptides[1].getHits().resize(1);
+  peptides[1].getHits()[0].setScore(25.0);
+  peptides[1].getHits()[0].setMetaValue("q-value", 0.02);
+  peptides[1].getHits()[0].setMetaValue("XTandem", 12.0); // old score differs from meta value
+  for (PeptideIdentification& pep : peptides)
+  {
+    pep.setScoreType("XTandem");
+    pep.setHigherScoreBetter(true);
+  }
+
+  IDScoreSwitcherAlgorithm switcher;
+  Param p = switcher.getParameters();
+  p.setValue("new_score", "q-value");
+  p.setValue("new_score_orientation", "lower_better");
+  switcher.setParameters(p);
+
+  PSMTable table;
+  table.importIDs(peptides, {"q-value", "XTandem"});
+  Size counter = 0;
+  switcher.switchScores(table, counter);
+  TEST_EQUAL(counter, 3)
+  TEST_EQUAL(table.getScoreType(), "q-value")
+  TEST_EQUAL(table.isHigherScoreBetter(), false)
+  table.exportIDs(peptides);
+
+  TEST_EQUAL(peptides[0].getScoreType(), "q-value")
+  TEST_REAL_SIMILAR(peptides[0].getHits()[0].getScore(), 0.01)
+  TEST_REAL_SIMILAR(peptides[0].getHits()[0].getMetaValue("XTandem"), 30.0)
+  TEST_REAL_SIMILAR(peptides[0].getHits()[1].getMetaValue("XTandem"), 20.0)
+  TEST_REAL_SIMILAR(peptides[1].getHits()[0].getScore(), 0.02)
+  TEST_REAL_SIMILAR(peptides[1].getHits()[0].getMetaValue("XTandem"), 12.0)
+  TEST_REAL_SIMILAR(peptides[1].getHits()[0].getMetaValue("XTandem~"), 25.0)
+
+  // new score not available
+  PSMTable no_score;
+  no_score.importIDs(peptides);
+  TEST_EXCEPTION(Exception::MissingInformation, switcher.switchScores(no_score, counter))
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
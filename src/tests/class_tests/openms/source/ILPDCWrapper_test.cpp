@@ -14,6 +14,7 @@
 ///////////////////////////
 
 #include <OpenMS/DATASTRUCTURES/ChargePair.h>
+#include <OpenMS/DATASTRUCTURES/Compomer.h>
 #include <OpenMS/DATASTRUCTURES/MassExplainer.h>
 #include <OpenMS/KERNEL/FeatureMap.h>
 #include <OpenMS/CHEMISTRY/EmpiricalFormula.h>
@@ -58,7 +59,21 @@ START_SECTION((double compute(const FeatureMap fm, PairsType &pairs, Size verbos
   // check that it runs without pairs (i.e. all clusters are singletons)
   TEST_EQUAL(pairs.size(), 0);
 
-  // real data test
+  // components that are solved without ILP: a chain of features 0-1-2-3, where feature 1 is
+  // either charge 1 (edge 0-1) or charge 2 (edge 1-2), and a single edge 4-5
+  fm.resize(6);
+  pairs.push_back(ChargePair(0, 1, 1, 1, Compomer(0, 0.0, -0.1), 0.0, false));
+  pairs.push_back(ChargePair(1, 2, 2, 1, Compomer(0, 0.0, -1.0), 0.0, false));
+  pairs.push_back(ChargePair(2, 3, 1, 1, Compomer(0, 0.0, -0.5), 0.0, false));
+  pairs.push_back(ChargePair(4, 5, 1, 2, Compomer(0, 0.0, -2.0), 0.0, false));
+  double score = iw.compute(fm, pairs, 1);
+  TEST_REAL_SIMILAR(score, exp(-0.1) + exp(-0.5) + exp(-2.0))
+  TEST_EQUAL(pairs.size(), 4)
+  for (const ChargePair& pair : pairs)
+  {
+    // all edges except 1-2 are realized
+    TEST_EQUAL(pair.isActive(), pair.getElementIndex(0) != 1)
+  }
 
 
 }
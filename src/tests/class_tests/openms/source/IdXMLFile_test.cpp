@@ -16,6 +16,44 @@
 
 ///////////////////////////
 
+using namespace OpenMS;
+
+// collects everything it consumes
+class CollectingIdentificationConsumer :
+  public Interfaces::IIdentificationConsumer
+{
+public:
+  void setDocumentIdentifier(const String& document_id) override
+  {
+    document_id_ = document_id;
+  }
+
+  void consumeProteinIdentification(ProteinIdentification& prot_id) override
+  {
+    protein_ids_.push_back(prot_id);
+  }
+
+  void consumePeptideIdentifications(std::vector<PeptideIdentification>& pep_ids) override
+  {
+    batch_sizes_.push_back(pep_ids.size());
+    for (const auto& pep_id : pep_ids)
+    {
+      // peptides always belong to the most recent run
+      if (pep_id.getIdentifier() != protein_ids_.back().getIdentifier())
+      {
+        ++wrong_run_;
+      }
+      peptide_ids_.push_back(pep_id);
+    }
+  }
+
+  String document_id_;
+  std::vector<ProteinIdentification> protein_ids_;
+  std::vector<PeptideIdentification> peptide_ids_;
+  std::vector<Size> batch_sizes_;
+  Size wrong_run_ = 0;
+};
+
 START_TEST(IdXMLFile, "$Id$")
 
 /////////////////////////////////////////////////////////////
@@ -198,6 +236,59 @@ START_SECTION(void store(String filename, const std::vector<ProteinIdentificatio
   TEST_EQUAL(result, true);
 END_SECTION
 
+START_SECTION(void transform(const String& filename, Interfaces::IIdentificationConsumer* consumer, Size batch_size = 10000))
+{
+  std::vector<ProteinIdentification> protein_ids;
+  std::vector<PeptideIdentification> peptide_ids;
+  String document_id;
+  IdXMLFile().load(OPENMS_GET_TEST_DATA_PATH("IdXMLFile_whole.idXML"), protein_ids, peptide_ids, document_id);
+
+  for (Size batch_size : {Size(1), Size(2), Size(10000)})
+  {
+    CollectingIdentificationConsumer consumer;
+    IdXMLFile().transform(OPENMS_GET_TEST_DATA_PATH("IdXMLFile_whole.idXML"), &consumer, batch_size);
+    TEST_STRING_EQUAL(consumer.document_id_, document_id)
+    TEST_EQUAL(consumer.protein_ids_.size(), protein_ids.size())
+    TEST_EQUAL(consumer.peptide_ids_.size(), peptide_ids.size())
+    TEST_EQUAL(consumer.wrong_run_, 0)
+    ABORT_IF(consumer.protein_ids_.size() != protein_ids.size() || consumer.peptide_ids_.size() != peptide_ids.size())
+
+    // identifiers contain a random number when loaded; make them equal for the comparison
+    for (Size i = 0; i < protein_ids.size(); ++i)
+    {
+      for (auto& pep : consumer.peptide_ids_)
+      {
+        if (pep.getIdentifier() == consumer.protein_ids_[i].getIdentifier())
+        {
+          pep.setIdentifier(protein_ids[i].getIdentifier());
+        }
+      }
+      consumer.protein_ids_[i].setIdentifier(protein_ids[i].getIdentifier());
+    }
+    TEST_TRUE(consumer.protein_ids_ == protein_ids)
+    TEST_TRUE(consumer.peptide_ids_ == peptide_ids)
+  }
+
+  // batches are limited in size and never span runs
+  CollectingIdentificationConsumer consumer;
+  IdXMLFile().transform(OPENMS_GET_TEST_DATA_PATH("IdXMLFile_no_proteinhits.idXML"), &consumer, 3);
+  TEST_EQUAL(consumer.protein_ids_.size(), 1)
+  TEST_EQUAL(consumer.peptide_ids_.size(), 10)
+  TEST_EQUAL(consumer.batch_sizes_.size(), 4)
+  TEST_EQUAL(consumer.batch_sizes_.back(), 1)
+
+  // the same instance can be used for loading afterwards
+  IdXMLFile f;
+  CollectingIdentificationConsumer consumer2;
+  f.transform(OPENMS_GET_TEST_DATA_PATH("IdXMLFile_whole.idXML"), &consumer2, 1);
+  TEST_EQUAL(consumer2.batch_sizes_.size(), 3)
+  f.load(OPENMS_GET_TEST_DATA_PATH("IdXMLFile_whole.idXML"), protein_ids, peptide_ids);
+  TEST_EQUAL(protein_ids.size(), 2)
+  TEST_EQUAL(peptide_ids.size(), 3)
+  TEST_EQUAL(consumer2.peptide_ids_.size(), 3)
+}
+END_SECTION
+
 
 START_SECTION([EXTRA] static bool isValid(const String& filename))
   std::vector<ProteinIdentification> protein_ids, protein_ids2;
@@ -0,0 +1,142 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/DATAACCESS/IdXMLWritingConsumer.h>
+///////////////////////////
+
+#include <OpenMS/CONCEPT/FuzzyStringComparator.h>
+#include <OpenMS/FORMAT/IdXMLFile.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(IdXMLWritingConsumer, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+IdXMLWritingConsumer* ptr = nullptr;
+IdXMLWritingConsumer* nullPointer = nullptr;
+
+START_SECTION((IdXMLWritingConsumer(const String& filename)))
+{
+  String filename;
+  NEW_TMP_FILE(filename)
+  ptr = new IdXMLWritingConsumer(filename);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getNrPeptideIdentificationsWritten(), 0)
+
+  TEST_EXCEPTION(Exception::UnableToCreateFile, IdXMLWritingConsumer("invalid_extension.mzML"))
+}
+END_SECTION
+
+START_SECTION((~IdXMLWritingConsumer()))
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((void consumeProteinIdentification(ProteinIdentification& prot_id)))
+{
+  String filename;
+  NEW_TMP_FILE(filename)
+  IdXMLWritingConsumer consumer(filename);
+  ProteinIdentification prot_id;
+  prot_id.setIdentifier("run_1");
+  consumer.consumeProteinIdentification(prot_id);
+  TEST_EXCEPTION(Exception::ParseError, consumer.consumeProteinIdentification(prot_id))
+}
+END_SECTION
+
+START_SECTION((void consumePeptideIdentifications(std::vector<PeptideIdentification>& pep_ids)))
+{
+  String filename;
+  NEW_TMP_FILE(filename)
+  IdXMLWritingConsumer consumer(filename);
+  ProteinIdentification prot_id;
+  prot_id.setIdentifier("run_1");
+  prot_id.getHits().push_back(ProteinHit(0.0, 1, "PROT1", ""));
+  consumer.consumeProteinIdentification(prot_id);
+
+  vector<PeptideIdentification> pep_ids(3);
+  PeptideHit hit(1.0, 1, 2, AASequence::fromString("PEPTIDE"));
+  PeptideEvidence pe;
+  pe.setProteinAccession("PROT1");
+  hit.addPeptideEvidence(pe);
+  pep_ids[0].setIdentifier("run_1");
+  pep_ids[0].insertHit(hit);
+  pep_ids[1].setIdentifier("run_1"); // no hits: omitted
+  pep_ids[2].setIdentifier("run_2"); // unknown run: omitted
+  pep_ids[2].insertHit(hit);
+  consumer.consumePeptideIdentifications(pep_ids);
+  TEST_EQUAL(consumer.getNrPeptideIdentificationsWritten(), 1)
+
+  // unknown protein accession
+  pe.setProteinAccession("PROT2");
+  hit.setPeptideEvidences({pe});
+  pep_ids.resize(1);
+  pep_ids[0].setHits({hit});
+  TEST_EXCEPTION(Exception::ElementNotFound, consumer.consumePeptideIdentifications(pep_ids))
+  consumer.close();
+
+  vector<ProteinIdentification> protein_ids;
+  vector<PeptideIdentification> peptide_ids;
+  IdXMLFile().load(filename, protein_ids, peptide_ids);
+  TEST_EQUAL(protein_ids.size(), 1)
+  TEST_EQUAL(peptide_ids.size(), 1)
+  TEST_EQUAL(peptide_ids[0].getHits()[0].getSequence().toString(), "PEPTIDE")
+}
+END_SECTION
+
+START_SECTION((void close()))
+{
+  // transforming into the writing consumer gives the same file as load and store
+  for (const String& file : {"IdXMLFile_whole.idXML", "IdXMLFile_no_proteinhits.idXML"})
+  {
+    vector<ProteinIdentification> protein_ids;
+    vector<PeptideIdentification> peptide_ids;
+    String document_id;
+    IdXMLFile().load(OPENMS_GET_TEST_DATA_PATH(file), protein_ids, peptide_ids, document_id);
+    String expected_file;
+    NEW_TMP_FILE(expected_file)
+    IdXMLFile().store(expected_file, protein_ids, peptide_ids, document_id);
+
+    String actual_file;
+    NEW_TMP_FILE(actual_file)
+    IdXMLWritingConsumer consumer(actual_file);
+    IdXMLFile().transform(OPENMS_GET_TEST_DATA_PATH(file), &consumer, 2);
+    consumer.close();
+    consumer.close(); // no effect
+    TEST_EXCEPTION(Exception::IllegalArgument, consumer.consumePeptideIdentifications(peptide_ids))
+
+    FuzzyStringComparator fuzzy;
+    fuzzy.setWhitelist(ListUtils::create<String>("<?xml-stylesheet"));
+    TEST_EQUAL(fuzzy.compareFiles(actual_file, expected_file), true)
+  }
+
+  // no identifications at all
+  String empty_file;
+  NEW_TMP_FILE(empty_file)
+  {
+    IdXMLWritingConsumer consumer(empty_file);
+  }
+  vector<ProteinIdentification> protein_ids;
+  vector<PeptideIdentification> peptide_ids;
+  IdXMLFile().load(empty_file, protein_ids, peptide_ids);
+  TEST_EQUAL(protein_ids.size(), 1)
+  TEST_EQUAL(peptide_ids.size(), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -13,12 +13,18 @@
 #include <OpenMS/ANALYSIS/QUANTITATION/IsobaricChannelExtractor.h>
 ///////////////////////////
 
+#include <OpenMS/ANALYSIS/QUANTITATION/IsobaricIsotopeCorrector.h>
+#include <OpenMS/ANALYSIS/QUANTITATION/IsobaricQuantifierStatistics.h>
 #include <OpenMS/ANALYSIS/QUANTITATION/ItraqFourPlexQuantitationMethod.h>
 #include <OpenMS/ANALYSIS/QUANTITATION/TMTTenPlexQuantitationMethod.h>
 #include <OpenMS/FORMAT/ConsensusXMLFile.h>
 #include <OpenMS/FORMAT/MzDataFile.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 using namespace OpenMS;
 using namespace std;
 
@@ -725,6 +731,106 @@ START_SECTION(([EXTRA] TMT 10plex support))
 }
 END_SECTION
 
+// extraction and isotope correction run in parallel: the result must not depend on the number of threads
+START_SECTION(([EXTRA] extractChannels and correctIsotopicImpurities are independent of the number of threads))
+{
+  // survey scans with a precursor and an interfering peak in the isolation window, followed by
+  // HCD scans with reporter ions (including close neighbours, so the nearest-peak selection is exercised)
+  PeakMap exp;
+  const Size nr_cycles = 40;
+  const Size nr_ms2 = 8;
+  const double reporter_mz[4] = {114.1112, 115.1083, 116.1116, 117.1150};
+  for (Size c = 0; c < nr_cycles; ++c)
+  {
+    MSSpectrum ms1;
+    ms1.setMSLevel(1);
+    ms1.setRT(100.0 + 10.0 * c);
+    for (Size k = 0; k < nr_ms2; ++k)
+    {
+      const double mz = 500.0 + 20.0 * k;
+      ms1.push_back(Peak1D(mz - 0.5014, 300.0 + 7.0 * ((c + k) % 11)));
+      ms1.push_back(Peak1D(mz, 1000.0 + 13.0 * ((c * k) % 17)));
+      ms1.push_back(Peak1D(mz + 0.31, 200.0 + 5.0 * ((c + 3 * k) % 7)));
+    }
+    exp.addSpectrum(ms1);
+
+    for (Size k = 0; k < nr_ms2; ++k)
+    {
+      MSSpectrum ms2;
+      ms2.setMSLevel(2);
+      ms2.setRT(ms1.getRT() + 1.0 + k);
+      ms2.setNativeID(String("scan=") + String(c * (nr_ms2 + 1) + k + 2));
+      Precursor prec;
+      prec.setMZ(500.0 + 20.0 * k);
+      prec.setCharge(2);
+      prec.setIntensity(1000.0);
+      prec.setIsolationWindowLowerOffset(1.0);
+      prec.setIsolationWindowUpperOffset(1.0);
+      prec.setActivationMethods({Precursor::ActivationMethod::HCD});
+      ms2.getPrecursors().push_back(prec);
+      for (Size r = 0; r < 4; ++r)
+      {
+        // leave a channel empty now and then, and add a second candidate peak in the window of others
+        if ((c + k + r) % 13 == 0) continue;
+        const double shift = 0.0001 * (double((c + 2 * k + r) % 9) - 4.0);
+        ms2.push_back(Peak1D(reporter_mz[r] + shift, 50.0 + 37.0 * ((3 * c + k + 5 * r) % 23)));
+        if ((c + r) % 3 == 0)
+        {
+          ms2.push_back(Peak1D(reporter_mz[r] - shift + 0.0015, 40.0 + 11.0 * ((c + k) % 5)));
+        }
+      }
+      ms2.sortByPosition();
+      exp.addSpectrum(ms2);
+    }
+  }
+
+  ItraqFourPlexQuantitationMethod itraq;
+  auto quantify = [&](int nr_threads)
+  {
+#ifdef _OPENMP
+    omp_set_num_threads(nr_threads);
+#endif
+    IsobaricChannelExtractor extractor(&itraq);
+    Param p = extractor.getParameters();
+    p.setValue("min_precursor_purity", 0.5);
+    extractor.setParameters(p);
+    ConsensusMap extracted;
+    extractor.extractChannels(exp, extracted);
+    ConsensusMap corrected = extracted;
+    IsobaricIsotopeCorrector::correctIsotopicImpurities(extracted, corrected, &itraq);
+
+    std::vector<double> intensities;
+    for (const ConsensusMap* cm : {&extracted, &corrected})
+    {
+      for (const ConsensusFeature& cf : *cm)
+      {
+        intensities.push_back(cf.getIntensity());
+        intensities.push_back(cf.getMetaValue("precursor_purity"));
+        for (const FeatureHandle& fh : cf)
+        {
+          intensities.push_back(fh.getIntensity());
+        }
+      }
+    }
+    return intensities;
+  };
+
+#ifdef _OPENMP
+  const int max_threads = omp_get_max_threads();
+#endif
+  const std::vector<double> serial = quantify(1);
+  TEST_EQUAL(serial.empty(), false)
+  for (int nr_threads : {2, 4, 7})
+  {
+    // exact comparison on purpose: the parallel passes must not change a single bit
+    TEST_EQUAL(quantify(nr_threads) == serial, true)
+  }
+#ifdef _OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+}
+END_SECTION
+
 delete q_method;
 
 /////////////////////////////////////////////////////////////
@@ -0,0 +1,230 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Rost $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/IsotopeDistributionCache.h>
+///////////////////////////
+
+#include <OpenMS/CHEMISTRY/EmpiricalFormula.h>
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/FineIsotopePatternGenerator.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(IsotopeDistributionCache, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+IsotopeDistributionCache* ptr = nullptr;
+IsotopeDistributionCache* nullPointer = nullptr;
+
+START_SECTION(IsotopeDistributionCache(Size max_entries = DEFAULT_MAX_ENTRIES))
+{
+  ptr = new IsotopeDistributionCache();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getMaxEntries(), IsotopeDistributionCache::DEFAULT_MAX_ENTRIES)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->getHits(), 0)
+  TEST_EQUAL(ptr->getMisses(), 0)
+}
+END_SECTION
+
+START_SECTION(~IsotopeDistributionCache())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(static IsotopeDistributionCache& getInstance())
+{
+  IsotopeDistributionCache& instance = IsotopeDistributionCache::getInstance();
+  TEST_EQUAL(&instance, &IsotopeDistributionCache::getInstance())
+  TEST_EQUAL(instance.getMaxEntries(), IsotopeDistributionCache::DEFAULT_MAX_ENTRIES)
+
+  // used by FineIsotopePatternGenerator if caching is enabled
+  instance.clear();
+  FineIsotopePatternGenerator cached(0.01);
+  cached.setCaching(true);
+  EmpiricalFormula("C6H12O6").getIsotopeDistribution(cached);
+  EmpiricalFormula("C6H12O6").getIsotopeDistribution(cached);
+  TEST_EQUAL(instance.getMisses(), 1)
+  TEST_EQUAL(instance.getHits(), 1)
+  EmpiricalFormula("C6H12O6").getIsotopeDistribution(FineIsotopePatternGenerator(0.01));
+  TEST_EQUAL(instance.getMisses(), 1)
+  TEST_EQUAL(instance.getHits(), 1)
+}
+END_SECTION
+
+START_SECTION((DistributionPtr get(const EmpiricalFormula& formula, const FineIsotopePatternGenerator& generator)))
+{
+  IsotopeDistributionCache cache(100);
+  FineIsotopePatternGenerator gen(0.01, false, false);
+  gen.setCaching(false);
+  EmpiricalFormula ef("C520H817N139O147S8");
+
+  IsotopeDistributionCache::DistributionPtr first = cache.get(ef, gen);
+  TEST_EQUAL(cache.getMisses(), 1)
+  TEST_EQUAL(cache.getHits(), 0)
+  IsotopeDistribution expected = gen.run(ef);
+  TEST_EQUAL(first->size(), 267)
+  TEST_EQUAL(*first == expected, true)
+
+  IsotopeDistributionCache::DistributionPtr second = cache.get(ef, gen);
+  TEST_EQUAL(cache.getMisses(), 1)
+  TEST_EQUAL(cache.getHits(), 1)
+  TEST_EQUAL(first.get(), second.get())
+
+  // the charge does not change the distribution
+  cache.get(EmpiricalFormula("C520H817N139O147S8+"), gen);
+  TEST_EQUAL(cache.getHits(), 2)
+  TEST_EQUAL(cache.size(), 1)
+
+  // other parameters are cached separately
+  gen.setAbsolute(true);
+  IsotopeDistributionCache::DistributionPtr absolute = cache.get(ef, gen);
+  TEST_EQUAL(absolute->size(), 21)
+  gen.setThreshold(1e-3);
+  TEST_EQUAL(cache.get(ef, gen)->size(), 151)
+  gen.setTotalProbability(true);
+  TEST_EQUAL(*cache.get(ef, gen) == gen.run(ef), true)
+  TEST_EQUAL(cache.getMisses(), 4)
+  TEST_EQUAL(cache.size(), 4)
+  // caching of the generator itself does not matter
+  gen.setCaching(true);
+  cache.get(ef, gen);
+  TEST_EQUAL(cache.getHits(), 3)
+
+  // disabled cache
+  IsotopeDistributionCache disabled(0);
+  TEST_EQUAL(*disabled.get(ef, gen) == gen.run(ef), true)
+  disabled.get(ef, gen);
+  TEST_EQUAL(disabled.getHits(), 0)
+  TEST_EQUAL(disabled.getMisses(), 2)
+  TEST_EQUAL(disabled.size(), 0)
+
+  // concurrent requests
+  IsotopeDistributionCache shared(1000);
+  vector<EmpiricalFormula> formulas;
+  for (Size i = 1; i <= 20; ++i)
+  {
+    formulas.push_back(EmpiricalFormula("C" + String(i) + "H" + String(2 * i + 2) + "O" + String(i % 3)));
+  }
+  Size mismatches = 0;
+#pragma omp parallel for reduction(+: mismatches)
+  for (SignedSize i = 0; i < 400; ++i)
+  {
+    const EmpiricalFormula& formula = formulas[i % formulas.size()];
+    FineIsotopePatternGenerator local(0.01);
+    local.setCaching(false);
+    if (!(*shared.get(formula, local) == local.run(formula))) ++mismatches;
+  }
+  TEST_EQUAL(mismatches, 0)
+  TEST_EQUAL(shared.size(), 20)
+  TEST_EQUAL(shared.getHits() + shared.getMisses(), 400)
+  TEST_EQUAL(shared.getMisses() >= 20, true)
+}
+END_SECTION
+
+START_SECTION(void setMaxEntries(Size max_entries))
+{
+  FineIsotopePatternGenerator gen(0.01);
+  IsotopeDistributionCache cache(1000);
+  for (Size i = 1; i <= 100; ++i)
+  {
+    cache.get(EmpiricalFormula("C" + String(i)), gen);
+  }
+  TEST_EQUAL(cache.size(), 100)
+  cache.setMaxEntries(10);
+  TEST_EQUAL(cache.getMaxEntries(), 10)
+  TEST_EQUAL(cache.size() <= 10, true)
+  for (Size i = 1; i <= 100; ++i)
+  {
+    cache.get(EmpiricalFormula("C" + String(i)), gen);
+  }
+  TEST_EQUAL(cache.size() <= 10, true)
+
+  // least recently used entries are evicted first
+  IsotopeDistributionCache single(1);
+  single.get(EmpiricalFormula("C10"), gen);
+  single.get(EmpiricalFormula("C10"), gen);
+  TEST_EQUAL(single.getHits(), 1)
+  single.get(EmpiricalFormula("C11"), gen);
+  single.get(EmpiricalFormula("C10"), gen);
+  TEST_EQUAL(single.getHits(), 1)
+  TEST_EQUAL(single.size(), 1)
+
+  // the most recently touched entry survives the eviction
+  IsotopeDistributionCache lru(3);
+  lru.get(EmpiricalFormula("C10"), gen);
+  lru.get(EmpiricalFormula("C11"), gen);
+  lru.get(EmpiricalFormula("C12"), gen);
+  lru.get(EmpiricalFormula("C10"), gen); // C11 is now the least recently used entry
+  TEST_EQUAL(lru.getHits(), 1)
+  lru.get(EmpiricalFormula("C13"), gen);
+  TEST_EQUAL(lru.size(), 3)
+  lru.get(EmpiricalFormula("C10"), gen);
+  lru.get(EmpiricalFormula("C12"), gen);
+  lru.get(EmpiricalFormula("C13"), gen);
+  TEST_EQUAL(lru.getHits(), 4)
+  TEST_EQUAL(lru.getMisses(), 4)
+  lru.get(EmpiricalFormula("C11"), gen);
+  TEST_EQUAL(lru.getHits(), 4)
+  TEST_EQUAL(lru.getMisses(), 5)
+
+  single.setMaxEntries(0);
+  TEST_EQUAL(single.size(), 0)
+  single.get(EmpiricalFormula("C10"), gen);
+  TEST_EQUAL(single.size(), 0)
+}
+END_SECTION
+
+START_SECTION(Size getMaxEntries() const)
+{
+  TEST_EQUAL(IsotopeDistributionCache(5).getMaxEntries(), 5)
+}
+END_SECTION
+
+START_SECTION(Size getHits() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Size getMisses() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Size size() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(void clear())
+{
+  IsotopeDistributionCache cache(10);
+  FineIsotopePatternGenerator gen(0.01);
+  cache.get(EmpiricalFormula("C10"), gen);
+  cache.get(EmpiricalFormula("C10"), gen);
+  cache.clear();
+  TEST_EQUAL(cache.size(), 0)
+  TEST_EQUAL(cache.getHits(), 0)
+  TEST_EQUAL(cache.getMisses(), 0)
+  TEST_EQUAL(cache.getMaxEntries(), 10)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -13,9 +13,83 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMRTNormalizer.h>
 ///////////////////////////
 
+#include <OpenMS/ML/REGRESSION/LinearRegression.h>
+
 using namespace std;
 using namespace OpenMS;
 
+// reference implementation of removeOutliersIterative: full refit of the remaining points in every iteration
+vector<pair<double, double> > refitOutliersIterative(const vector<pair<double, double> >& pairs, double rsq_limit,
+                                                     double coverage_limit, bool use_chauvenet, const String& method)
+{
+  vector<double> x, y;
+  for (const auto& p : pairs)
+  {
+    x.push_back(p.first);
+    y.push_back(p.second);
+  }
+  double rsq = 0;
+  while (x.size() >= coverage_limit * pairs.size() && rsq < rsq_limit)
+  {
+    Math::LinearRegression lin_reg;
+    lin_reg.computeRegression(0.95, x.begin(), x.end(), y.begin());
+    rsq = lin_reg.getRSquared();
+    if (rsq >= rsq_limit) break;
+
+    vector<double> residuals;
+    for (const auto& p : pairs)
+    {
+      residuals.push_back(fabs(p.second - (lin_reg.getIntercept() + p.first * lin_reg.getSlope())));
+    }
+
+    Size pos = 0;
+    if (method == "iter_jackknife")
+    {
+      double best_rsq = -1.0;
+      for (Size i = 0; i < x.size(); ++i)
+      {
+        vector<double> x_tmp = x, y_tmp = y;
+        x_tmp.erase(x_tmp.begin() + i);
+        y_tmp.erase(y_tmp.begin() + i);
+        Math::LinearRegression lin_reg_tmp;
+        lin_reg_tmp.computeRegression(0.95, x_tmp.begin(), x_tmp.end(), y_tmp.begin());
+        if (lin_reg_tmp.getRSquared() > best_rsq)
+        {
+          best_rsq = lin_reg_tmp.getRSquared();
+          pos = i;
+        }
+      }
+    }
+    else
+    {
+      double max_residual = -1.0;
+      for (Size i = 0; i < x.size(); ++i)
+      {
+        double residual = fabs(y[i] - (lin_reg.getIntercept() + lin_reg.getSlope() * x[i]));
+        if (residual > max_residual)
+        {
+          max_residual = residual;
+          pos = i;
+        }
+      }
+    }
+
+    if (use_chauvenet && !MRMRTNormalizer::chauvenet(residuals, pos)) break;
+    x.erase(x.begin() + pos);
+    y.erase(y.begin() + pos);
+  }
+  if (rsq < rsq_limit)
+  {
+    throw Exception::UnableToFit(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "UnableToFit", "rsq below limit");
+  }
+  vector<pair<double, double> > result;
+  for (Size i = 0; i < x.size(); ++i)
+  {
+    result.emplace_back(x[i], y[i]);
+  }
+  return result;
+}
+
 ///////////////////////////
 
 START_TEST(MRMRTNormalizer, "$Id$")
@@ -230,6 +304,58 @@ START_SECTION((static std::vector<std::pair<double, double> > removeOutliersIter
   TEST_EQUAL( output3[18].first,  input3[18].first );
   TEST_EQUAL( output3[19].second, input3[21].second );
   }
+
+  {
+  // the incremental fit removes the same points as a full refit in every iteration
+  // (line with noise and a few or many outliers)
+  for (Size outlier_distance : {7, 20})
+  {
+  std::vector<std::pair<double, double> > input4;
+  UInt32 seed = 42;
+  auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return double(seed >> 8) / double(1u << 24); };
+  for (Size i = 0; i < 60; i++)
+  {
+    double x = 10.0 + i * 1.5;
+    double y = 0.8 * x - 3.0 + (next() - 0.5);
+    if (i % outlier_distance == 3)
+    {
+      y += (next() < 0.5 ? -1.0 : 1.0) * (10.0 + 20.0 * next());
+    }
+    input4.push_back(std::make_pair(x, y));
+  }
+
+  for (const std::string method : {"iter_residual", "iter_jackknife"})
+  {
+    for (bool use_chauvenet : {false, true})
+    {
+      for (double rsq_limit : {0.9, 0.95, 0.99, 0.999})
+      {
+        std::vector<std::pair<double, double> > expected, output4;
+        bool expected_fit = true, fit = true;
+        try
+        {
+          expected = refitOutliersIterative(input4, rsq_limit, 0.6, use_chauvenet, method);
+        }
+        catch (Exception::UnableToFit&)
+        {
+          expected_fit = false;
+        }
+        try
+        {
+          output4 = MRMRTNormalizer::removeOutliersIterative(input4, rsq_limit, 0.6, use_chauvenet, method);
+        }
+        catch (Exception::UnableToFit&)
+        {
+          fit = false;
+        }
+        TEST_EQUAL(fit, expected_fit)
+        TEST_EQUAL(output4.size(), expected.size())
+        TEST_EQUAL(output4 == expected, true)
+      }
+    }
+  }
+  }
+  }
 }
 END_SECTION
 
@@ -471,6 +471,94 @@ START_SECTION((template < typename SpectrumT, typename TransitionT > void pickTr
 }
 END_SECTION
 
+START_SECTION((template <typename SpectrumT, typename TransitionT> void pickTransitionGroup(MRMTransitionGroup<SpectrumT, TransitionT>& transition_group, Workspace& workspace)))
+{
+  MRMTransitionGroupPicker trgroup_picker;
+  Param picker_param = trgroup_picker.getDefaults();
+  picker_param.setValue("PeakPickerChromatogram:method", "legacy"); // old parameters
+  picker_param.setValue("PeakPickerChromatogram:peak_width", 40.0); // old parameters
+  trgroup_picker.setParameters(picker_param);
+
+  // the same workspace used for groups of different size yields the same results as a fresh one
+  MRMTransitionGroupPicker::Workspace workspace;
+  for (Size i = 0; i < 3; ++i)
+  {
+    MRMTransitionGroupType transition_group, transition_group_ref;
+    if (i == 1)
+    {
+      setup_transition_group2(transition_group);
+      setup_transition_group2(transition_group_ref);
+    }
+    else
+    {
+      setup_transition_group(transition_group);
+      setup_transition_group(transition_group_ref);
+    }
+    trgroup_picker.pickTransitionGroup(transition_group, workspace);
+    trgroup_picker.pickTransitionGroup(transition_group_ref);
+
+    TEST_EQUAL(transition_group.getFeatures().size(), transition_group_ref.getFeatures().size())
+    for (Size k = 0; k < transition_group.getFeatures().size(); ++k)
+    {
+      const MRMFeature& f = transition_group.getFeatures()[k];
+      const MRMFeature& f_ref = transition_group_ref.getFeatures()[k];
+      TEST_REAL_SIMILAR(f.getRT(), f_ref.getRT())
+      TEST_REAL_SIMILAR(f.getIntensity(), f_ref.getIntensity())
+      TEST_REAL_SIMILAR(f.getMetaValue("leftWidth"), f_ref.getMetaValue("leftWidth"))
+      TEST_REAL_SIMILAR(f.getMetaValue("rightWidth"), f_ref.getMetaValue("rightWidth"))
+      TEST_EQUAL(f.getFeatures().size(), f_ref.getFeatures().size())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION((template <typename SpectrumT, typename TransitionT> void pickTransitionGroups(std::vector<MRMTransitionGroup<SpectrumT, TransitionT> >& transition_groups)))
+{
+  MRMTransitionGroupPicker trgroup_picker;
+  Param picker_param = trgroup_picker.getDefaults();
+  picker_param.setValue("PeakPickerChromatogram:method", "legacy"); // old parameters
+  picker_param.setValue("PeakPickerChromatogram:peak_width", 40.0); // old parameters
+  trgroup_picker.setParameters(picker_param);
+
+  std::vector<MRMTransitionGroupType> transition_groups(50);
+  for (Size i = 0; i < transition_groups.size(); ++i)
+  {
+    if (i % 2 == 0) setup_transition_group(transition_groups[i]);
+    else setup_transition_group2(transition_groups[i]);
+  }
+  trgroup_picker.pickTransitionGroups(transition_groups);
+
+  MRMTransitionGroupType ref1, ref2;
+  setup_transition_group(ref1);
+  setup_transition_group2(ref2);
+  trgroup_picker.pickTransitionGroup(ref1);
+  trgroup_picker.pickTransitionGroup(ref2);
+
+  TEST_EQUAL(transition_groups[0].getFeatures().size(), 1)
+  TEST_REAL_SIMILAR(transition_groups[0].getFeatures()[0].getIntensity(), 567375)
+  for (Size i = 0; i < transition_groups.size(); ++i)
+  {
+    const MRMTransitionGroupType& ref = (i % 2 == 0) ? ref1 : ref2;
+    TEST_EQUAL(transition_groups[i].getFeatures().size(), ref.getFeatures().size())
+    for (Size k = 0; k < ref.getFeatures().size(); ++k)
+    {
+      TEST_REAL_SIMILAR(transition_groups[i].getFeatures()[k].getRT(), ref.getFeatures()[k].getRT())
+      TEST_REAL_SIMILAR(transition_groups[i].getFeatures()[k].getIntensity(), ref.getFeatures()[k].getIntensity())
+    }
+  }
+
+  // errors in one of the groups are propagated
+  Param non_consensus = picker_param;
+  non_consensus.setValue("use_consensus", "false");
+  trgroup_picker.setParameters(non_consensus);
+  std::vector<MRMTransitionGroupType> failing(2);
+  setup_transition_group2(failing[0]);
+  setup_transition_group2(failing[1]);
+  failing[1].getTransitionsMuteable()[0].setDetectingTransition(false);
+  TEST_EXCEPTION(Exception::IllegalArgument, trgroup_picker.pickTransitionGroups(failing))
+}
+END_SECTION
+
 START_SECTION((template <typename SpectrumT, typename TransitionT> MRMFeature createMRMFeature(MRMTransitionGroup<SpectrumT, TransitionT>& transition_group, std::vector<SpectrumT>& picked_chroms, std::vector<SpectrumT>& smoothed_chroms, int& chr_idx, int& peak_idx)))
 {
   MRMTransitionGroupType transition_group;
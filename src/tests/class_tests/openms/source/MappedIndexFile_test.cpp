@@ -0,0 +1,255 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/MappedIndexFile.h>
+///////////////////////////
+
+#include <OpenMS/SYSTEM/File.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace OpenMS;
+using namespace OpenMS::Internal;
+using namespace std;
+
+struct TestRecord
+{
+  double key;
+  MappedIndexFile::StringIndex name;
+  UInt32 count;
+};
+
+START_TEST(MappedIndexFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+const MappedIndexFile::Format format = {{'O', 'M', 'S', 'T', 'E', 'S', 'T', ' '}, 1, 2, "test index"};
+
+MappedIndexFile* ptr = nullptr;
+MappedIndexFile* nullPointer = nullptr;
+
+START_SECTION(MappedIndexFile(const Format& format))
+{
+  ptr = new MappedIndexFile(format);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOpen(), false)
+  TEST_EQUAL(ptr->getNrStrings(), 0)
+}
+END_SECTION
+
+START_SECTION(~MappedIndexFile())
+{
+  delete ptr;
+}
+END_SECTION
+
+String source_file;
+NEW_TMP_FILE(source_file)
+{
+  ofstream os(source_file.c_str());
+  os << "source data\n";
+}
+
+String index_file;
+NEW_TMP_FILE(index_file)
+
+vector<TestRecord> records;
+vector<UInt32> values = {1, 2, 3};
+{
+  MappedIndexFile::StringPool pool(format);
+  records.push_back({100.0, pool.add("first"), 1});
+  records.push_back({200.0, pool.add("second"), 2});
+  records.push_back({200.0, pool.add("first"), 3});
+  records.push_back({300.5, pool.add(""), 4});
+  MappedIndexFile::Writer writer(format, index_file, source_file, "param=1", pool);
+  writer.addSection(records);
+  writer.append(values.data(), 2 * sizeof(UInt32));
+  writer.append(values.data() + 2, sizeof(UInt32));
+  writer.endSection();
+  writer.commit();
+}
+
+START_SECTION(UInt32 Format::checkedUInt32(Size value, const char* items) const)
+{
+  TEST_EQUAL(format.checkedUInt32(12345, "records"), 12345)
+  TEST_EXCEPTION(Exception::InvalidValue, format.checkedUInt32(Size(std::numeric_limits<UInt32>::max()) + 1, "records"))
+}
+END_SECTION
+
+START_SECTION(StringIndex StringPool::add(const std::string& s))
+{
+  MappedIndexFile::StringPool pool(format);
+  TEST_EQUAL(pool.add(""), 0)
+  TEST_EQUAL(pool.add("abc"), 1)
+  TEST_EQUAL(pool.add("def"), 2)
+  TEST_EQUAL(pool.add("abc"), 1)
+  TEST_EQUAL(pool.strings().size(), 3)
+  TEST_EQUAL(pool.strings()[2], "def")
+}
+END_SECTION
+
+START_SECTION(Writer(const Format& format, const String& filename, const String& source_file, const String& fingerprint, const StringPool& strings))
+{
+  TEST_EQUAL(File::exists(index_file), true)
+  // the file is only moved into place by commit()
+  String uncommitted;
+  NEW_TMP_FILE(uncommitted)
+  {
+    MappedIndexFile::StringPool pool(format);
+    MappedIndexFile::Writer writer(format, uncommitted, source_file, "", pool);
+    writer.addSection(values);
+  }
+  TEST_EQUAL(File::exists(uncommitted), false)
+}
+END_SECTION
+
+START_SECTION(void commit())
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(static bool isUpToDate(const Format& format, const String& filename, const String& source_file, const String& fingerprint))
+{
+  TEST_EQUAL(MappedIndexFile::isUpToDate(format, index_file, source_file, "param=1"), true)
+  TEST_EQUAL(MappedIndexFile::isUpToDate(format, index_file, source_file, "param=2"), false)
+  TEST_EQUAL(MappedIndexFile::isUpToDate(format, index_file, source_file, ""), false)
+  MappedIndexFile::Format other = format;
+  other.version = 2;
+  TEST_EQUAL(MappedIndexFile::isUpToDate(other, index_file, source_file, "param=1"), false)
+  TEST_EQUAL(MappedIndexFile::isUpToDate(format, index_file + ".missing", source_file, "param=1"), false)
+
+  // only the modification time changed: the content is compared
+  std::filesystem::last_write_time(source_file.c_str(), std::filesystem::last_write_time(source_file.c_str()) + std::chrono::hours(1));
+  TEST_EQUAL(MappedIndexFile::isUpToDate(format, index_file, source_file, "param=1"), true)
+  // same size, different content
+  {
+    ofstream os(source_file.c_str());
+    os << "source DATA\n";
+  }
+  TEST_EQUAL(MappedIndexFile::isUpToDate(format, index_file, source_file, "param=1"), false)
+
+  // no source file recorded
+  String no_source;
+  NEW_TMP_FILE(no_source)
+  {
+    MappedIndexFile::StringPool pool(format);
+    MappedIndexFile::Writer writer(format, no_source, "", "", pool);
+    writer.addSection(values);
+    writer.addSection(values);
+    writer.commit();
+  }
+  TEST_EQUAL(MappedIndexFile::isUpToDate(format, no_source, source_file, ""), false)
+}
+END_SECTION
+
+START_SECTION(void open(const String& filename))
+{
+  MappedIndexFile file(format);
+  file.open(index_file);
+  TEST_EQUAL(file.isOpen(), true)
+
+  TEST_EXCEPTION(Exception::FileNotFound, file.open(index_file + ".missing"))
+  TEST_EQUAL(file.isOpen(), false)
+
+  // wrong format
+  MappedIndexFile::Format other = format;
+  other.magic[7] = 'X';
+  MappedIndexFile other_file(other);
+  TEST_EXCEPTION(Exception::ParseError, other_file.open(index_file))
+  TEST_EQUAL(other_file.isOpen(), false)
+  other = format;
+  other.version = 2;
+  MappedIndexFile other_version(other);
+  TEST_EXCEPTION(Exception::ParseError, other_version.open(index_file))
+
+  // truncated file
+  String truncated;
+  NEW_TMP_FILE(truncated)
+  std::filesystem::copy_file(index_file.c_str(), truncated.c_str(), std::filesystem::copy_options::overwrite_existing);
+  std::filesystem::resize_file(truncated.c_str(), File::fileSize(index_file) - 8);
+  TEST_EXCEPTION(Exception::ParseError, file.open(truncated))
+  TEST_EQUAL(MappedIndexFile::isUpToDate(format, truncated, source_file, "param=1"), false)
+  std::filesystem::resize_file(truncated.c_str(), 16);
+  TEST_EXCEPTION(Exception::ParseError, file.open(truncated))
+  TEST_EQUAL(file.isOpen(), false)
+}
+END_SECTION
+
+MappedIndexFile file(format);
+file.open(index_file);
+
+START_SECTION(template <typename T> const T* getSection(Size index, Size& count) const)
+{
+  Size count = 0;
+  const TestRecord* stored = file.getSection<TestRecord>(0, count);
+  TEST_EQUAL(count, 4)
+  TEST_REAL_SIMILAR(stored[1].key, 200.0)
+  TEST_EQUAL(stored[3].count, 4)
+  const UInt32* stored_values = file.getSection<UInt32>(1, count);
+  TEST_EQUAL(count, 3)
+  TEST_EQUAL(stored_values[2], 3)
+  // 12 bytes are not a multiple of 8
+  TEST_EXCEPTION(Exception::ParseError, file.getSection<double>(1, count))
+}
+END_SECTION
+
+START_SECTION(Size getNrStrings() const)
+{
+  TEST_EQUAL(file.getNrStrings(), 3)
+}
+END_SECTION
+
+START_SECTION(std::string_view getString(StringIndex index) const)
+{
+  Size count = 0;
+  const TestRecord* stored = file.getSection<TestRecord>(0, count);
+  TEST_EQUAL(String(file.getString(stored[0].name)), "first")
+  TEST_EQUAL(String(file.getString(stored[1].name)), "second")
+  TEST_EQUAL(stored[2].name, stored[0].name)
+  TEST_EQUAL(file.getString(stored[3].name).empty(), true)
+}
+END_SECTION
+
+START_SECTION((template <typename Record, typename Key> static std::pair<Size, Size> getRange(const Record* records, Size count, double min_key, double max_key, Key key)))
+{
+  Size count = 0;
+  const TestRecord* stored = file.getSection<TestRecord>(0, count);
+  auto key = [](const TestRecord& r) { return r.key; };
+  TEST_EQUAL(MappedIndexFile::getRange(stored, count, 150.0, 250.0, key).first, 1)
+  TEST_EQUAL(MappedIndexFile::getRange(stored, count, 150.0, 250.0, key).second, 3)
+  TEST_EQUAL(MappedIndexFile::getRange(stored, count, 100.0, 300.5, key).first, 0)
+  TEST_EQUAL(MappedIndexFile::getRange(stored, count, 100.0, 300.5, key).second, 4)
+  TEST_EQUAL(MappedIndexFile::getRange(stored, count, 400.0, 500.0, key).first, 4)
+  TEST_EQUAL(MappedIndexFile::getRange(stored, count, 400.0, 500.0, key).second, 4)
+}
+END_SECTION
+
+START_SECTION(bool isOpen() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(void close())
+{
+  file.close();
+  TEST_EQUAL(file.isOpen(), false)
+  TEST_EQUAL(file.getNrStrings(), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -164,6 +164,69 @@ START_SECTION((std::vector<FLASHDeconvHelperStructs::MassFeature> findFeatures(c
 }
 END_SECTION
 
+START_SECTION((std::vector<FLASHDeconvHelperStructs::MassFeature> findClosedFeatures(const PrecalculatedAveragine &averagine)))
+{
+  FLASHDeconvAlgorithm fd = FLASHDeconvAlgorithm();
+  Param fd_param;
+  fd_param.setValue("min_charge", 5);
+  fd_param.setValue("max_charge", 20);
+  fd_param.setValue("max_mass", 50000.);
+  fd.setParameters(fd_param);
+  fd.calculateAveragine(false);
+  FLASHDeconvHelperStructs::PrecalculatedAveragine averagine = fd.getAveragine();
+
+  PeakGroup pg1 = tmp_pg;
+  pg1.updateMonoMassAndIsotopeIntensities();
+  PeakGroup pg2 = pg1;
+  pg2.setMonoisotopicMass(pg1.getMonoMass() + 1000.0);
+
+  // the first mass is present in spectra 0 to 9, the second one in all spectra
+  MassFeatureTrace tracer, streaming_tracer;
+  Param mf_param = tracer.getParameters();
+  mf_param.setValue("min_isotope_cosine", .0);
+  tracer.setParameters(mf_param);
+  streaming_tracer.setParameters(mf_param);
+
+  std::vector<FLASHDeconvHelperStructs::MassFeature> streamed_features;
+  for (int i = 0; i < 40; ++i)
+  {
+    sample_spec.setRT(10.0 * i);
+    DeconvolvedSpectrum deconv_spec(i + 1);
+    deconv_spec.setOriginalSpectrum(sample_spec);
+    if (i < 10)
+    {
+      deconv_spec.push_back(pg1);
+    }
+    deconv_spec.push_back(pg2);
+    tracer.storeInformationFromDeconvolvedSpectrum(deconv_spec);
+    streaming_tracer.storeInformationFromDeconvolvedSpectrum(deconv_spec);
+
+    // the trace of the first mass is closed once more than trace_termination_outliers (5) spectra follow its last peak
+    auto closed_features = streaming_tracer.findClosedFeatures(averagine);
+    TEST_EQUAL(closed_features.size(), i == 15 ? 1 : 0)
+    streamed_features.insert(streamed_features.end(), closed_features.begin(), closed_features.end());
+  }
+  TEST_EQUAL(streamed_features.size(), 1)
+  // the trace of the second mass is still open
+  auto remaining_features = streaming_tracer.findFeatures(averagine);
+  TEST_EQUAL(remaining_features.size(), 1)
+  streamed_features.insert(streamed_features.end(), remaining_features.begin(), remaining_features.end());
+
+  auto all_features = tracer.findFeatures(averagine);
+  TEST_EQUAL(all_features.size(), 2)
+  ABORT_IF(all_features.size() != 2 || streamed_features.size() != 2)
+  auto by_mass = [](const FLASHDeconvHelperStructs::MassFeature& a, const FLASHDeconvHelperStructs::MassFeature& b) { return a.avg_mass < b.avg_mass; };
+  std::sort(all_features.begin(), all_features.end(), by_mass);
+  std::sort(streamed_features.begin(), streamed_features.end(), by_mass);
+  for (Size i = 0; i < 2; ++i)
+  {
+    TEST_REAL_SIMILAR(streamed_features[i].mt.getCentroidMZ(), all_features[i].mt.getCentroidMZ())
+    TEST_EQUAL(streamed_features[i].mt.getSize(), all_features[i].mt.getSize())
+    TEST_EQUAL(streamed_features[i].scan_number, all_features[i].scan_number)
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
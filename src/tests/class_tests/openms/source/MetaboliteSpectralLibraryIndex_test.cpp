@@ -0,0 +1,241 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/MetaboliteSpectralLibraryIndex.h>
+///////////////////////////
+
+#include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/FORMAT/FileHandler.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/SYSTEM/File.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(MetaboliteSpectralLibraryIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+MetaboliteSpectralLibraryIndex* ptr = nullptr;
+MetaboliteSpectralLibraryIndex* nullPointer = nullptr;
+
+START_SECTION(MetaboliteSpectralLibraryIndex())
+{
+  ptr = new MetaboliteSpectralLibraryIndex();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOpen(), false)
+  TEST_EQUAL(ptr->getNrSpectra(), 0)
+}
+END_SECTION
+
+START_SECTION(~MetaboliteSpectralLibraryIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+// small library: five spectra, two of them with the same precursor m/z, one without annotations
+auto addSpectrum = [](PeakMap& library, double precursor_mz, Int charge, const String& id, const String& name)
+{
+  MSSpectrum spectrum;
+  Precursor precursor;
+  precursor.setMZ(precursor_mz);
+  precursor.setCharge(charge);
+  spectrum.setPrecursors({precursor});
+  spectrum.setNativeID("index=" + String(library.size()));
+  for (Size i = 1; i <= library.size() + 3; ++i)
+  {
+    spectrum.emplace_back(precursor_mz / 10.0 * i, 100.0f * i);
+  }
+  if (!id.empty())
+  {
+    spectrum.setMetaValue("Massbank_Accession_ID", id);
+    spectrum.setMetaValue("HMDB_ID", "HMDB" + id);
+    spectrum.setMetaValue(Constants::UserParam::MSM_METABOLITE_NAME, name);
+    spectrum.setMetaValue(Constants::UserParam::MSM_SUM_FORMULA, "C6H12O6");
+    spectrum.setMetaValue(Constants::UserParam::MSM_INCHI_STRING, "InChI=" + name);
+    spectrum.setMetaValue(Constants::UserParam::MSM_SMILES_STRING, "OC" + name);
+    spectrum.setMetaValue(Constants::UserParam::MSM_PRECURSOR_ADDUCT, charge > 0 ? "[M+H]+" : "[M-H]-");
+  }
+  library.addSpectrum(spectrum);
+};
+
+PeakMap library;
+addSpectrum(library, 300.0, 1, "MB001", "first");
+addSpectrum(library, 181.07, 1, "MB002", "second");
+addSpectrum(library, 179.056, -1, "MB003", "third");
+addSpectrum(library, 181.07, 1, "MB004", "fourth");
+addSpectrum(library, 250.0, 1, "", "");
+
+String library_file;
+NEW_TMP_FILE(library_file)
+library_file += ".mzML";
+FileHandler().storeExperiment(library_file, library, {FileTypes::MZML});
+
+String index_file;
+NEW_TMP_FILE(index_file)
+
+START_SECTION((static void create(const String& filename, const String& library_file)))
+{
+  MetaboliteSpectralLibraryIndex::create(index_file, library_file);
+  TEST_EQUAL(File::exists(index_file), true)
+  TEST_EXCEPTION(Exception::FileNotFound, MetaboliteSpectralLibraryIndex::create(index_file, "this_file_does_not_exist.mzML"))
+}
+END_SECTION
+
+START_SECTION((static void create(const String& filename, const PeakMap& library)))
+{
+  String other_index;
+  NEW_TMP_FILE(other_index)
+  MetaboliteSpectralLibraryIndex::create(other_index, library);
+  MetaboliteSpectralLibraryIndex other;
+  other.open(other_index);
+  TEST_EQUAL(other.getNrSpectra(), 5)
+  TEST_EQUAL(MetaboliteSpectralLibraryIndex::isUpToDate(other_index, library_file), false)
+
+  PeakMap no_precursor = library;
+  no_precursor[2].getPrecursors().clear();
+  TEST_EXCEPTION(Exception::MissingInformation, MetaboliteSpectralLibraryIndex::create(other_index, no_precursor))
+}
+END_SECTION
+
+START_SECTION((static bool isUpToDate(const String& filename, const String& library_file)))
+{
+  TEST_EQUAL(MetaboliteSpectralLibraryIndex::isUpToDate(index_file, library_file), true)
+  TEST_EQUAL(MetaboliteSpectralLibraryIndex::isUpToDate("this_file_does_not_exist.idx", library_file), false)
+  TEST_EQUAL(MetaboliteSpectralLibraryIndex::isUpToDate(library_file, library_file), false)
+}
+END_SECTION
+
+MetaboliteSpectralLibraryIndex index;
+
+START_SECTION(void open(const String& filename))
+{
+  index.open(index_file);
+  TEST_EQUAL(index.isOpen(), true)
+  TEST_EXCEPTION(Exception::FileNotFound, MetaboliteSpectralLibraryIndex().open("this_file_does_not_exist.idx"))
+  TEST_EXCEPTION(Exception::ParseError, MetaboliteSpectralLibraryIndex().open(library_file))
+}
+END_SECTION
+
+START_SECTION(bool isOpen() const)
+{
+  TEST_EQUAL(index.isOpen(), true)
+  TEST_EQUAL(MetaboliteSpectralLibraryIndex().isOpen(), false)
+}
+END_SECTION
+
+START_SECTION(Size getNrSpectra() const)
+{
+  TEST_EQUAL(index.getNrSpectra(), 5)
+}
+END_SECTION
+
+START_SECTION(const SpectrumRecord& getSpectrum(Size index) const)
+{
+  // sorted by precursor m/z, spectra with the same precursor m/z keep the order of the library
+  const vector<UInt32> expected_order = {2, 1, 3, 4, 0};
+  for (Size i = 0; i < index.getNrSpectra(); ++i)
+  {
+    const auto& rec = index.getSpectrum(i);
+    TEST_EQUAL(rec.library_index, expected_order[i])
+    TEST_REAL_SIMILAR(rec.precursor_mz, library[rec.library_index].getPrecursors()[0].getMZ())
+    TEST_EQUAL(rec.charge, library[rec.library_index].getPrecursors()[0].getCharge())
+    TEST_EQUAL(rec.nr_peaks, library[rec.library_index].size())
+  }
+}
+END_SECTION
+
+START_SECTION(std::string_view getString(StringIndex index) const)
+{
+  TEST_EQUAL(String(index.getString(0)), "")
+  const auto& rec = index.getSpectrum(0); // MB003
+  TEST_EQUAL(String(index.getString(rec.primary_id)), "MB003")
+  TEST_EQUAL(String(index.getString(rec.secondary_id)), "HMDBMB003")
+  TEST_EQUAL(String(index.getString(rec.name)), "third")
+  TEST_EQUAL(String(index.getString(rec.sum_formula)), "C6H12O6")
+  TEST_EQUAL(String(index.getString(rec.inchi)), "InChI=third")
+  TEST_EQUAL(String(index.getString(rec.smiles)), "OCthird")
+  TEST_EQUAL(String(index.getString(rec.adduct)), "[M-H]-")
+  // missing annotations are empty
+  const auto& unannotated = index.getSpectrum(3);
+  TEST_EQUAL(unannotated.library_index, 4)
+  TEST_EQUAL(String(index.getString(unannotated.primary_id)), "")
+  TEST_EQUAL(String(index.getString(unannotated.name)), "")
+}
+END_SECTION
+
+START_SECTION(SpectrumComparisonKernels::PeakArraysView getPeaks(Size index) const)
+{
+  for (Size i = 0; i < index.getNrSpectra(); ++i)
+  {
+    const MSSpectrum& spec = library[index.getSpectrum(i).library_index];
+    auto peaks = index.getPeaks(i);
+    TEST_EQUAL(peaks.size(), spec.size())
+    for (Size k = 0; k < peaks.size(); ++k)
+    {
+      TEST_REAL_SIMILAR(peaks.mz[k], spec[k].getMZ())
+      TEST_REAL_SIMILAR(peaks.intensity[k], spec[k].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getSpectrumRange(double min_mz, double max_mz) const))
+{
+  auto range = index.getSpectrumRange(181.07 - 0.001, 181.07 + 0.001);
+  TEST_EQUAL(range.first, 1)
+  TEST_EQUAL(range.second, 3)
+  range = index.getSpectrumRange(0.0, 1e6);
+  TEST_EQUAL(range.first, 0)
+  TEST_EQUAL(range.second, 5)
+  range = index.getSpectrumRange(10.0, 20.0);
+  TEST_EQUAL(range.first, range.second)
+  range = index.getSpectrumRange(260.0, 270.0);
+  TEST_EQUAL(range.first, 4)
+  TEST_EQUAL(range.second, 4)
+}
+END_SECTION
+
+START_SECTION(void close())
+{
+  index.close();
+  TEST_EQUAL(index.isOpen(), false)
+  TEST_EQUAL(index.getNrSpectra(), 0)
+}
+END_SECTION
+
+START_SECTION((void openOrCreate(const String& filename, const String& library_file)))
+{
+  String new_index;
+  NEW_TMP_FILE(new_index)
+  MetaboliteSpectralLibraryIndex s;
+  s.openOrCreate(new_index, library_file);
+  TEST_EQUAL(s.isOpen(), true)
+  TEST_EQUAL(s.getNrSpectra(), 5)
+  s.close();
+
+  // the library changed: the index is recreated
+  PeakMap extended = library;
+  addSpectrum(extended, 400.0, 1, "MB006", "sixth");
+  FileHandler().storeExperiment(library_file, extended, {FileTypes::MZML});
+  TEST_EQUAL(MetaboliteSpectralLibraryIndex::isUpToDate(new_index, library_file), false)
+  s.openOrCreate(new_index, library_file);
+  TEST_EQUAL(s.getNrSpectra(), 6)
+  TEST_EQUAL(MetaboliteSpectralLibraryIndex::isUpToDate(new_index, library_file), true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
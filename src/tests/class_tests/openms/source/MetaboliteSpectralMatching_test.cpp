@@ -12,6 +12,10 @@
 #include <OpenMS/ANALYSIS/ID/MetaboliteSpectralMatching.h>
 ///////////////////////////
 
+#include <OpenMS/ANALYSIS/ID/MetaboliteSpectralLibraryIndex.h>
+#include <OpenMS/FORMAT/MzTab.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
 using namespace OpenMS;
 using namespace std;
 
@@ -53,6 +57,96 @@ START_SECTION((void run(PeakMap &, MzTab &)))
 }
 END_SECTION
 
+// small library (charge 1, intensities 100, 200, ...)
+auto makeSpectrum = [](double precursor_mz, const vector<double>& mzs, const String& id)
+{
+  MSSpectrum spectrum;
+  Precursor precursor;
+  precursor.setMZ(precursor_mz);
+  precursor.setCharge(1);
+  spectrum.setPrecursors({precursor});
+  for (Size i = 0; i < mzs.size(); ++i)
+  {
+    spectrum.emplace_back(mzs[i], 100.0f * (i + 1));
+  }
+  spectrum.setMetaValue("Massbank_Accession_ID", id);
+  return spectrum;
+};
+PeakMap library;
+library.addSpectrum(makeSpectrum(200.0, {60.0, 91.0, 120.0, 154.0, 182.0}, "MB001"));
+library.addSpectrum(makeSpectrum(300.0, {75.0, 133.0, 160.0, 236.0, 282.0}, "MB002"));
+library.addSpectrum(makeSpectrum(410.0, {60.0, 91.0, 134.0, 300.0, 350.0}, "MB003"));
+String index_file;
+NEW_TMP_FILE(index_file)
+MetaboliteSpectralLibraryIndex::create(index_file, library);
+MetaboliteSpectralLibraryIndex index;
+index.open(index_file);
+
+START_SECTION((void run(PeakMap& msexp, const MetaboliteSpectralLibraryIndex& spec_db, MzTab& mztab_out, String& out_spectra)))
+{
+  // query: MB001 with a modification of +14 Da on the part that keeps the precursor charge
+  PeakMap query;
+  MSSpectrum spectrum = makeSpectrum(214.0, {60.0, 91.0, 134.0, 168.0, 196.0}, "");
+  spectrum.setNativeID("scan=1");
+  query.addSpectrum(spectrum);
+
+  MetaboliteSpectralMatching msm;
+  Param param = msm.getParameters();
+  param.setValue("merge_spectra", "false");
+  msm.setParameters(param);
+  String out_spectra;
+  MzTab result;
+  PeakMap query_copy = query;
+  msm.run(query_copy, index, result, out_spectra);
+  TEST_EQUAL(result.getSmallMoleculeSectionRows().size(), 0)
+
+  // analog search: MB001 matches with two fragments and three neutral losses,
+  // MB003 (shifted by -196 Da) only with three fragments
+  param.setValue("analog_search", "true");
+  msm.setParameters(param);
+  result = MzTab();
+  query_copy = query;
+  msm.run(query_copy, index, result, out_spectra);
+  const MzTabSmallMoleculeSectionRows& rows = result.getSmallMoleculeSectionRows();
+  TEST_EQUAL(rows.size(), 2)
+  ABORT_IF(rows.size() != 2)
+  TEST_EQUAL(rows[0].identifier.get()[0].get(), "MB001")
+  TEST_EQUAL(rows[1].identifier.get()[0].get(), "MB003")
+  TEST_EQUAL(rows[0].opt_.back().first, "opt_mass_shift")
+  TEST_REAL_SIMILAR(rows[0].opt_.back().second.get().toDouble(), 14.0)
+  TEST_REAL_SIMILAR(rows[1].opt_.back().second.get().toDouble(), -196.0)
+
+  // the shift is limited by 'analog_max_mass_shift'
+  param.setValue("analog_max_mass_shift", 100.0);
+  msm.setParameters(param);
+  result = MzTab();
+  query_copy = query;
+  msm.run(query_copy, index, result, out_spectra);
+  TEST_EQUAL(result.getSmallMoleculeSectionRows().size(), 1)
+
+  // spectra inside the precursor window are not reported again by the analog search
+  // (library with equal precursor m/z, not sorted by precursor)
+  PeakMap tied_library;
+  tied_library.addSpectrum(makeSpectrum(300.0, {50.0, 70.0, 90.0, 110.0, 130.0}, "MB004"));
+  tied_library.addSpectrum(makeSpectrum(300.0, {75.0, 133.0, 160.0, 236.0, 282.0}, "MB002"));
+  tied_library.addSpectrum(makeSpectrum(200.0, {60.0, 91.0, 120.0, 154.0, 182.0}, "MB001"));
+  String tied_file;
+  NEW_TMP_FILE(tied_file)
+  MetaboliteSpectralLibraryIndex::create(tied_file, tied_library);
+  MetaboliteSpectralLibraryIndex tied_index;
+  tied_index.open(tied_file);
+  PeakMap exact_query;
+  exact_query.addSpectrum(tied_library[1]);
+  param.setValue("analog_max_mass_shift", 500.0);
+  msm.setParameters(param);
+  result = MzTab();
+  msm.run(exact_query, tied_index, result, out_spectra);
+  TEST_EQUAL(result.getSmallMoleculeSectionRows().size(), 1)
+  ABORT_IF(result.getSmallMoleculeSectionRows().empty())
+  TEST_EQUAL(result.getSmallMoleculeSectionRows()[0].identifier.get()[0].get(), "MB002")
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
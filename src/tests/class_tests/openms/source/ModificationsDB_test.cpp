@@ -246,8 +246,26 @@ START_SECTION(void readFromOBOFile(const String& filename))
 END_SECTION
 
 START_SECTION(void readFromUnimodXMLFile(const String& filename))
-	// just provided for convenience at the moment
-	NOT_TESTABLE
+{
+  // after construction, the modifications are added to the runtime part
+  Size nr_mods = ptr->getNumberOfModifications();
+  TEST_EQUAL(ptr->has("UniMod:99990"), false)
+  ptr->readFromUnimodXMLFile(OPENMS_GET_TEST_DATA_PATH("ModificationsDB_custom_unimod.xml"));
+  TEST_EQUAL(ptr->getNumberOfModifications(), nr_mods + 2)
+  const ResidueModification* mod = ptr->getModification("UniMod:99990", "S");
+  TEST_EQUAL(mod->getFullId(), "TESTMOD (S)")
+  TEST_REAL_SIMILAR(mod->getDiffMonoMass(), 42.010565)
+  TEST_EQUAL(ptr->getModification("UniMod:99990", "T")->getFullId(), "TESTMOD (T)")
+  TEST_EQUAL(ptr->getModification("TESTMOD (T)"), ptr->getModification("UniMod:99990", "T"))
+  vector<const ResidueModification*> found;
+  ptr->searchModificationsByDiffMonoMass(found, 42.010565, 0.0001, "S");
+  TEST_EQUAL(find(found.begin(), found.end(), mod) != found.end(), true)
+
+  // still found after freezing
+  ptr->freeze();
+  TEST_EQUAL(ptr->getNumberOfModifications(), nr_mods + 2)
+  TEST_EQUAL(ptr->getModification("UniMod:99990", "S"), mod)
+}
 END_SECTION
 
 START_SECTION((void getAllSearchModifications(std::vector<String>& modifications)))
@@ -277,6 +295,54 @@ START_SECTION((bool addModification(ResidueModification* modification)))
 }
 END_SECTION
 
+START_SECTION(void freeze())
+{
+  Size nr_mods = ptr->getNumberOfModifications();
+  TEST_EQUAL(ptr->has("Phospho (A)"), true); // added at runtime above
+  Size index = ptr->findModificationIndex("Phospho (A)");
+  const ResidueModification* mod = ptr->getModification(index);
+
+  ptr->freeze();
+  TEST_EQUAL(ptr->getNumberOfModifications(), nr_mods)
+  TEST_EQUAL(ptr->has("Phospho (A)"), true)
+  TEST_EQUAL(ptr->findModificationIndex("Phospho (A)"), index)
+  TEST_EQUAL(ptr->getModification(index), mod)
+
+  // UniMod accessions (index), also in non-canonical spelling
+  set<const ResidueModification*> mods;
+  ptr->searchModifications(mods, "UniMod:21", "S");
+  TEST_EQUAL(mods.size(), 1)
+  TEST_EQUAL((*mods.begin())->getFullId(), "Phospho (S)")
+  ptr->searchModifications(mods, "unimod:21", "S");
+  TEST_EQUAL(mods.size(), 1)
+  ptr->searchModifications(mods, "UniMod:021", "S");
+  TEST_EQUAL(mods.size(), 0)
+  ptr->searchModifications(mods, "UniMod:99999999", "S");
+  TEST_EQUAL(mods.size(), 0)
+
+  // mass indices give the same results as a linear scan
+  vector<const ResidueModification*> found;
+  for (const String& residue : {"", "S", "X", "M", "C"})
+  {
+    ptr->searchModificationsByDiffMonoMass(found, 79.97, 0.1, residue);
+    vector<const ResidueModification*> expected;
+    for (Size i = 0; i < ptr->getNumberOfModifications(); ++i)
+    {
+      const ResidueModification* m = ptr->getModification(i);
+      set<const ResidueModification*> matching;
+      ptr->searchModifications(matching, m->getFullId(), residue);
+      if (fabs(m->getDiffMonoMass() - 79.97) <= 0.1 && matching.count(m) > 0)
+      {
+        expected.push_back(m);
+      }
+    }
+    TEST_EQUAL(found.size(), expected.size())
+    TEST_EQUAL(found == expected, true)
+  }
+  TEST_EQUAL(ptr->getBestModificationByDiffMonoMass(15.9949, 0.01, "M")->getFullId(), "Oxidation (M)")
+}
+END_SECTION
+
 START_SECTION([EXTRA] multithreaded example)
 {
   // All measurements are best of three (wall time, Linux, 8 threads)
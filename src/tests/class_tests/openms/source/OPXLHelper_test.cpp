@@ -25,6 +25,13 @@
 #include <OpenMS/CHEMISTRY/Tagger.h>
 #include <QStringList>
 
+#include <set>
+#include <tuple>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 using namespace OpenMS;
 
 START_TEST(OPXLHelper, "$Id$")
@@ -124,6 +131,154 @@ START_SECTION(static std::vector<OPXLDataStructs::XLPrecursor> enumerateCrossLin
 
 END_SECTION
 
+START_SECTION(static void forEachCrossLinkCandidate(const std::vector<OPXLDataStructs::AASeqWithMass>& peptides, double cross_link_mass_light, const DoubleList& cross_link_mass_mono_link, const StringList& cross_link_residue1, const StringList& cross_link_residue2, const std::vector< double >& spectrum_precursors, double precursor_mass_tolerance, bool precursor_mass_tolerance_unit_ppm, const std::function<bool(Size)>& peptide_filter, const std::function<void(Size, Size, double, int)>& candidate_callback))
+
+  std::vector< int > spectrum_precursor_correction_positions;
+  std::vector<OPXLDataStructs::XLPrecursor> precursors = OPXLHelper::enumerateCrossLinksAndMasses(peptides, cross_link_mass, cross_link_mass_mono_link, cross_link_residue1, cross_link_residue2, spectrum_precursors, spectrum_precursor_correction_positions, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm);
+  std::set< std::tuple<Size, Size, int> > expected;
+  for (Size i = 0; i < precursors.size(); ++i)
+  {
+    expected.insert(std::make_tuple(precursors[i].alpha_index, precursors[i].beta_index, spectrum_precursor_correction_positions[i]));
+  }
+
+  std::set< std::tuple<Size, Size, int> > enumerated;
+  Size count(0);
+  OPXLHelper::forEachCrossLinkCandidate(peptides, cross_link_mass, cross_link_mass_mono_link, cross_link_residue1, cross_link_residue2, spectrum_precursors, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm, std::function<bool(Size)>(),
+    [&](Size alpha_index, Size beta_index, double, int precursor_correction_position)
+    {
+      enumerated.insert(std::make_tuple(alpha_index, beta_index, precursor_correction_position));
+      ++count;
+    });
+  TEST_EQUAL(count, 9604)
+  TEST_EQUAL(enumerated == expected, true)
+
+  // with a filter, no candidate contains a rejected peptide
+  Size filtered_count(0);
+  bool rejected_peptide_found = false;
+  OPXLHelper::forEachCrossLinkCandidate(peptides, cross_link_mass, cross_link_mass_mono_link, cross_link_residue1, cross_link_residue2, spectrum_precursors, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm,
+    [](Size index) { return index % 2 == 0; },
+    [&](Size alpha_index, Size beta_index, double, int)
+    {
+      rejected_peptide_found |= alpha_index % 2 != 0 || (beta_index < peptides.size() && beta_index % 2 != 0);
+      ++filtered_count;
+    });
+  TEST_EQUAL(filtered_count > 0, true)
+  TEST_EQUAL(filtered_count < count, true)
+  TEST_EQUAL(rejected_peptide_found, false)
+
+#ifdef _OPENMP
+  // the cross-links are enumerated in parallel, but passed on in the same order with any number of threads
+  auto enumerate_in_order = [&](int nr_threads)
+  {
+    omp_set_num_threads(nr_threads);
+    std::vector< std::tuple<Size, Size, int> > in_order;
+    OPXLHelper::forEachCrossLinkCandidate(peptides, cross_link_mass, cross_link_mass_mono_link, cross_link_residue1, cross_link_residue2, spectrum_precursors, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm, std::function<bool(Size)>(),
+      [&](Size alpha_index, Size beta_index, double, int precursor_correction_position)
+      {
+        in_order.emplace_back(alpha_index, beta_index, precursor_correction_position);
+      });
+    return in_order;
+  };
+  const int max_threads = omp_get_max_threads();
+  const std::vector< std::tuple<Size, Size, int> > serial_order = enumerate_in_order(1);
+  TEST_EQUAL(serial_order.size(), 9604)
+  TEST_EQUAL(enumerate_in_order(4) == serial_order, true)
+  omp_set_num_threads(max_threads);
+#endif
+
+END_SECTION
+
+START_SECTION(LinearFragmentFilter)
+
+  SimpleTSGXLMS spec_gen;
+  double fragment_mass_tolerance = 0.02;
+  OPXLHelper::LinearFragmentFilter filter(peptides, spec_gen, fragment_mass_tolerance, false);
+
+  // experimental spectrum: three fragments of the peptide at index 500
+  AASequence seq = peptides[500].peptide_seq;
+  std::vector< SimpleTSGXLMS::SimplePeak > ladder;
+  spec_gen.getLinearIonSpectrum(ladder, seq, seq.size() - 1, 2);
+  PeakSpectrum linear_peaks;
+  for (Size i = 0; i < ladder.size(); i += ladder.size() / 3)
+  {
+    linear_peaks.push_back(Peak1D(ladder[i].mz + 0.005, 1000.0));
+  }
+  linear_peaks.sortByPosition();
+  filter.setSpectrum(linear_peaks);
+
+  TEST_EQUAL(filter.countMatchesUpperBound(seq) >= 3, true)
+  TEST_EQUAL(filter(500), true)
+
+  // the bound holds for the linear fragments at every link position
+  DataArrays::IntegerDataArray exp_charges;
+  for (Size index = 0; index < peptides.size(); index += 10)
+  {
+    AASequence peptide = peptides[index].peptide_seq;
+    Size bound = filter.countMatchesUpperBound(peptide);
+    TEST_EQUAL(filter(index), bound >= 2)
+    for (Size link_pos = 0; link_pos < peptide.size(); ++link_pos)
+    {
+      std::vector< SimpleTSGXLMS::SimplePeak > theo_spectrum;
+      spec_gen.getLinearIonSpectrum(theo_spectrum, peptide, link_pos, 2);
+      std::vector< std::pair< Size, Size > > alignment;
+      OPXLSpectrumProcessingAlgorithms::getSpectrumAlignmentSimple(alignment, fragment_mass_tolerance, false, theo_spectrum, linear_peaks, exp_charges);
+      TEST_EQUAL(alignment.size() <= bound, true)
+    }
+  }
+
+  // without peaks, all peptides are rejected
+  PeakSpectrum empty_spectrum;
+  filter.setSpectrum(empty_spectrum);
+  TEST_EQUAL(filter(500), false)
+
+END_SECTION
+
+START_SECTION(LinearIonSpectrumCache)
+
+  SimpleTSGXLMS spec_gen;
+  OPXLHelper::LinearIonSpectrumCache cache(spec_gen, 100);
+
+  // cached spectra are the ones of the generator
+  const AASequence& peptide = peptides[500].peptide_seq;
+  AASequence seq = peptide;
+  std::vector< SimpleTSGXLMS::SimplePeak > expected;
+  spec_gen.getLinearIonSpectrum(expected, seq, 2, 2);
+  OPXLHelper::LinearIonSpectrumCache::SpectrumPtr spectrum = cache.get(peptide, 2, 2);
+  TEST_EQUAL(spectrum->size(), expected.size())
+  for (Size i = 0; i < expected.size(); ++i)
+  {
+    TEST_REAL_SIMILAR((*spectrum)[i].mz, expected[i].mz)
+    TEST_EQUAL((*spectrum)[i].charge, expected[i].charge)
+  }
+  TEST_EQUAL(cache.getHits(), 0)
+  TEST_EQUAL(cache.getMisses(), 1)
+
+  // the second request is answered from the cache, other link positions and charges are separate entries
+  TEST_EQUAL(cache.get(peptide, 2, 2) == spectrum, true)
+  TEST_EQUAL(cache.get(peptide, 3, 2) == spectrum, false)
+  TEST_EQUAL(cache.get(peptide, 2, 1) == spectrum, false)
+  TEST_EQUAL(cache.getHits(), 1)
+  TEST_EQUAL(cache.getMisses(), 3)
+  TEST_EQUAL(cache.size(), 3)
+
+  // the size is bounded, evicted spectra stay valid
+  for (Size index = 0; index < 300; ++index)
+  {
+    cache.get(peptides[index].peptide_seq, 0, 2);
+  }
+  TEST_EQUAL(cache.size() <= 100, true)
+  TEST_EQUAL(spectrum->size(), expected.size())
+
+  // a size of 0 disables the cache
+  OPXLHelper::LinearIonSpectrumCache no_cache(spec_gen, 0);
+  no_cache.get(peptide, 2, 2);
+  TEST_EQUAL(no_cache.get(peptide, 2, 2)->size(), expected.size())
+  TEST_EQUAL(no_cache.getHits(), 0)
+  TEST_EQUAL(no_cache.getMisses(), 2)
+  TEST_EQUAL(no_cache.size(), 0)
+
+END_SECTION
+
 // building more data structures required in the following test
 std::cout << std::endl;
 std::vector< int > spectrum_precursor_correction_positions;
@@ -0,0 +1,248 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: George Rosenberger $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/SqliteConnector.h>
+
+#include <sqlite3.h>
+
+#include <limits>
+
+using namespace OpenMS;
+using namespace std;
+
+// all rows of a table (in a defined order) in their text representation
+vector<String> dumpTable(const String& filename, const String& table, const String& order_by)
+{
+  SqliteConnector conn(filename);
+  sqlite3_stmt* stmt;
+  conn.prepareStatement(&stmt, "SELECT * FROM " + table + " ORDER BY " + order_by + ";");
+  vector<String> rows;
+  while (sqlite3_step(stmt) == SQLITE_ROW)
+  {
+    String row;
+    for (int i = 0; i < sqlite3_column_count(stmt); ++i)
+    {
+      const unsigned char* value = sqlite3_column_text(stmt, i);
+      row += String(sqlite3_column_type(stmt, i)) + ":" + (value == nullptr ? String("NULL") : String(reinterpret_cast<const char*>(value))) + "|";
+    }
+    rows.push_back(row);
+  }
+  sqlite3_finalize(stmt);
+  return rows;
+}
+
+const vector<pair<String, String> > tables =
+{
+  {"FEATURE", "ID"},
+  {"FEATURE_MS1", "FEATURE_ID"},
+  {"FEATURE_MS2", "FEATURE_ID"},
+  {"FEATURE_PRECURSOR", "FEATURE_ID, ISOTOPE"},
+  {"FEATURE_TRANSITION", "FEATURE_ID, TRANSITION_ID"}
+};
+
+// feature with two transitions and one precursor trace (values are exactly representable in the SQL text)
+Feature makeFeature(UInt64 unique_id, double rt, bool ms1_scores)
+{
+  Feature f;
+  f.setUniqueId(unique_id);
+  f.setRT(rt);
+  f.setIntensity(1000.0f);
+  f.setMetaValue("leftWidth", rt - 10.0);
+  f.setMetaValue("rightWidth", rt + 10.0);
+  f.setMetaValue("norm_RT", 25.5);
+  f.setMetaValue("im_drift", std::numeric_limits<double>::quiet_NaN()); // written as NULL
+  f.setMetaValue("total_xic", 2000.0);
+  f.setMetaValue("peak_apices_sum", 300.0);
+  f.setMetaValue("var_xcorr_shape", 0.75);
+  f.setMetaValue("var_library_corr", -0.5);
+  f.setMetaValue("masserror_ppm", DoubleList{1.5, -2.25});
+  if (ms1_scores)
+  {
+    f.setMetaValue("var_ms1_ppm_diff", 3.5);
+    f.setMetaValue("ms1_area_intensity", 400.0);
+    f.setMetaValue("ms1_apex_intensity", 40.0);
+  }
+
+  vector<Feature> subordinates(3);
+  for (Size i = 0; i < 2; ++i)
+  {
+    subordinates[i].setMetaValue("FeatureLevel", "MS2");
+    subordinates[i].setMetaValue("native_id", String(unique_id % 1000 * 10 + i));
+    subordinates[i].setIntensity(100.0f * (i + 1));
+    subordinates[i].setMetaValue("total_xic", 500.0);
+    subordinates[i].setMetaValue("peak_apex_int", 20.0 * (i + 1));
+    subordinates[i].setMetaValue("peak_apex_position", rt + 0.5);
+    subordinates[i].setMetaValue("width_at_50", 4.0);
+  }
+  subordinates[0].setMetaValue("total_mi", 1.25);
+  subordinates[2].setMetaValue("FeatureLevel", "MS1");
+  subordinates[2].setMetaValue("native_id", "PEPTIDE_Precursor_i0");
+  subordinates[2].setIntensity(50.0f);
+  subordinates[2].setMetaValue("peak_apex_int", 5.0);
+  f.setSubordinates(subordinates);
+  return f;
+}
+
+START_TEST(OpenSwathOSWWriter, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+OpenSwathOSWWriter* ptr = nullptr;
+OpenSwathOSWWriter* nullPointer = nullptr;
+
+START_SECTION(OpenSwathOSWWriter(const String& output_filename, const UInt64 run_id, const String& input_filename = "inputfile", bool uis_scores = false))
+{
+  ptr = new OpenSwathOSWWriter("", 1);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isActive(), false)
+  TEST_EQUAL(ptr->isBulkWriting(), false)
+}
+END_SECTION
+
+START_SECTION(~OpenSwathOSWWriter())
+{
+  delete ptr;
+}
+END_SECTION
+
+FeatureMap features;
+features.push_back(makeFeature(101, 100.0, true));
+features.push_back(makeFeature(102, 200.0, false));
+FeatureMap more_features;
+more_features.push_back(makeFeature(103, 300.0, true));
+
+START_SECTION(bool enqueueFeatures(const FeatureMap& output, const String& id))
+{
+  // the bulk writer produces the same tables as prepareLine() / writeLines()
+  String lines_file, bulk_file;
+  NEW_TMP_FILE(lines_file)
+  NEW_TMP_FILE(bulk_file)
+
+  OpenSwathOSWWriter lines_writer(lines_file, 42, "run.mzML");
+  lines_writer.writeHeader();
+  TEST_EQUAL(lines_writer.isBulkWriting(), false)
+  lines_writer.writeLines({lines_writer.prepareLine(OpenSwath::LightCompound(), nullptr, features, "7"),
+                           lines_writer.prepareLine(OpenSwath::LightCompound(), nullptr, more_features, "8")});
+
+  OpenSwathOSWWriter bulk_writer(bulk_file, 42, "run.mzML");
+  bulk_writer.enableBulkWrite(2, 1); // several transactions, producer has to wait for the writer thread
+  bulk_writer.writeHeader();
+  TEST_EQUAL(bulk_writer.isBulkWriting(), true)
+  TEST_EQUAL(bulk_writer.enqueueFeatures(features, "7"), true)
+  TEST_EQUAL(bulk_writer.enqueueFeatures(more_features, "8"), true)
+  TEST_EQUAL(bulk_writer.enqueueFeatures(FeatureMap(), "9"), true)
+  bulk_writer.finishBulkWrite();
+  TEST_EQUAL(bulk_writer.isBulkWriting(), false)
+  TEST_EXCEPTION(Exception::IllegalArgument, bulk_writer.enqueueFeatures(features, "7"))
+
+  for (const auto& table : tables)
+  {
+    const vector<String> expected = dumpTable(lines_file, table.first, table.second);
+    const vector<String> rows = dumpTable(bulk_file, table.first, table.second);
+    TEST_EQUAL(rows.size(), expected.size())
+    ABORT_IF(rows.size() != expected.size())
+    for (Size i = 0; i < rows.size(); ++i)
+    {
+      TEST_STRING_EQUAL(rows[i], expected[i])
+    }
+  }
+  TEST_EQUAL(dumpTable(bulk_file, "FEATURE", "ID").size(), 3)
+  TEST_EQUAL(dumpTable(bulk_file, "FEATURE_MS1", "FEATURE_ID").size(), 2)
+  TEST_EQUAL(dumpTable(bulk_file, "FEATURE_PRECURSOR", "FEATURE_ID").size(), 3)
+  TEST_EQUAL(dumpTable(bulk_file, "FEATURE_TRANSITION", "FEATURE_ID").size(), 6)
+
+  // identification (UIS) transitions replace the detecting transitions
+  Feature uis_feature = makeFeature(104, 400.0, false);
+  uis_feature.setMetaValue("id_target_num_transitions", 2);
+  uis_feature.setMetaValue("id_target_transition_names", StringList{"1041", "1042"});
+  for (const String& score : {"area_intensity", "total_area_intensity", "apex_intensity", "peak_apex_position", "width_at_50", "total_mi",
+                              "intensity_score", "intensity_ratio_score", "ind_log_intensity", "ind_xcorr_coelution", "ind_xcorr_shape",
+                              "ind_log_sn_score", "ind_massdev_score", "ind_mi_score", "ind_mi_ratio_score", "ind_isotope_correlation",
+                              "ind_isotope_overlap"})
+  {
+    uis_feature.setMetaValue("id_target_" + score, DoubleList{0.5, 2.0});
+  }
+  FeatureMap uis_features;
+  uis_features.push_back(uis_feature);
+
+  String uis_lines_file, uis_bulk_file;
+  NEW_TMP_FILE(uis_lines_file)
+  NEW_TMP_FILE(uis_bulk_file)
+  OpenSwathOSWWriter uis_lines_writer(uis_lines_file, 42, "run.mzML", true);
+  uis_lines_writer.writeHeader();
+  uis_lines_writer.writeLines({uis_lines_writer.prepareLine(OpenSwath::LightCompound(), nullptr, uis_features, "10")});
+  OpenSwathOSWWriter uis_bulk_writer(uis_bulk_file, 42, "run.mzML", true);
+  uis_bulk_writer.enableBulkWrite();
+  uis_bulk_writer.writeHeader();
+  uis_bulk_writer.enqueueFeatures(uis_features, "10");
+  uis_bulk_writer.finishBulkWrite();
+
+  for (const auto& table : tables)
+  {
+    TEST_EQUAL(ListUtils::concatenate(dumpTable(uis_bulk_file, table.first, table.second), "\n"),
+               ListUtils::concatenate(dumpTable(uis_lines_file, table.first, table.second), "\n"))
+  }
+  TEST_EQUAL(dumpTable(uis_bulk_file, "FEATURE_TRANSITION", "FEATURE_ID").size(), 2)
+
+  // not started
+  OpenSwathOSWWriter inactive("", 42);
+  inactive.enableBulkWrite();
+  inactive.writeHeader();
+  TEST_EQUAL(inactive.isBulkWriting(), false)
+  TEST_EXCEPTION(Exception::IllegalArgument, inactive.enqueueFeatures(features, "7"))
+}
+END_SECTION
+
+START_SECTION(void finishBulkWrite())
+{
+  // a failing insert (duplicate feature id) stops the writer thread: further features
+  // are dropped without an exception and the error is reported by finishBulkWrite()
+  String bulk_file;
+  NEW_TMP_FILE(bulk_file)
+  OpenSwathOSWWriter bulk_writer(bulk_file, 42, "run.mzML");
+  bulk_writer.enableBulkWrite(100, 1, false);
+  bulk_writer.writeHeader();
+  Size nr_enqueued = 0;
+  while (bulk_writer.enqueueFeatures(features, "7"))
+  {
+    ++nr_enqueued;
+  }
+  TEST_EQUAL(nr_enqueued >= 2, true)
+  TEST_EQUAL(bulk_writer.enqueueFeatures(features, "7"), false)
+  TEST_EXCEPTION(Exception::IllegalArgument, bulk_writer.finishBulkWrite())
+  TEST_EQUAL(bulk_writer.isBulkWriting(), false)
+
+  // nothing to do
+  OpenSwathOSWWriter lines_writer("", 42);
+  lines_writer.finishBulkWrite();
+}
+END_SECTION
+
+START_SECTION(void enableBulkWrite(Size rows_per_transaction = 100000, Size max_queued_rows = 1000000, bool synchronous = true))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(bool isBulkWriting() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,439 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/METADATA/PSMTable.h>
+///////////////////////////
+
+#include <cmath>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(PSMTable, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+PSMTable* ptr = nullptr;
+PSMTable* nullPointer = nullptr;
+
+START_SECTION(PSMTable())
+{
+  ptr = new PSMTable();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+  TEST_EQUAL(ptr->getNrSpectra(), 0)
+}
+END_SECTION
+
+START_SECTION(~PSMTable())
+{
+  delete ptr;
+}
+END_SECTION
+
+// three spectra (the second one without hits) from two runs
+vector<PeptideIdentification> ids(3);
+ids[0].setIdentifier("run1");
+ids[0].setRT(100.0);
+ids[0].setMZ(500.0);
+ids[0].setSpectrumReference("scan=1");
+ids[0].getHits().push_back(PeptideHit(10.0, 2, 2, AASequence::fromString("PEPTIDEK")));
+ids[0].getHits().push_back(PeptideHit(20.0, 1, 2, AASequence::fromString("PEPT[+79.966]IDEK")));
+ids[0].getHits()[0].setMetaValue("target_decoy", "target");
+ids[0].getHits()[0].setMetaValue("protein", "P1");
+ids[0].getHits()[0].setMetaValue("count", 3);
+ids[0].getHits()[1].setMetaValue("target_decoy", "decoy");
+ids[0].getHits()[1].setMetaValue("pep", 0.5);
+ids[1].setIdentifier("run2");
+ids[2].setIdentifier("run1");
+ids[2].setRT(200.0);
+ids[2].getHits().push_back(PeptideHit(5.0, 1, 3, AASequence::fromString("PEPTIDEK")));
+ids[2].getHits()[0].setMetaValue("target_decoy", "target+decoy");
+ids[2].getHits()[0].setMetaValue("protein", "P2");
+ids[2].getHits()[0].setMetaValue("count", 7);
+for (PeptideIdentification& id : ids)
+{
+  id.setScoreType("score");
+  id.setHigherScoreBetter(true);
+}
+
+START_SECTION((void importIDs(const std::vector<PeptideIdentification>& ids, const StringList& meta_keys = StringList())))
+{
+  PSMTable table;
+  table.importIDs(ids, {"pep", "protein", "count", "unknown"});
+  TEST_EQUAL(table.size(), 3)
+  TEST_EQUAL(table.getNrSpectra(), 3)
+  TEST_EQUAL(table.getScoreType(), "score")
+  TEST_EQUAL(table.isHigherScoreBetter(), true)
+
+  // mixed score types
+  vector<PeptideIdentification> mixed = ids;
+  mixed[2].setScoreType("other");
+  TEST_EXCEPTION(Exception::IllegalArgument, table.importIDs(mixed))
+
+  // identifications without hits do not count
+  mixed[2].getHits().clear();
+  table.importIDs(mixed);
+  TEST_EQUAL(table.size(), 2)
+}
+END_SECTION
+
+START_SECTION(static bool hasUniformScoreType(const std::vector<PeptideIdentification>& ids))
+{
+  TEST_EQUAL(PSMTable::hasUniformScoreType(ids), true)
+  TEST_EQUAL(PSMTable::hasUniformScoreType(vector<PeptideIdentification>()), true)
+
+  vector<PeptideIdentification> mixed = ids;
+  mixed[2].setScoreType("other");
+  TEST_EQUAL(PSMTable::hasUniformScoreType(mixed), false)
+  mixed[2].setScoreType("score");
+  mixed[2].setHigherScoreBetter(false);
+  TEST_EQUAL(PSMTable::hasUniformScoreType(mixed), false)
+
+  // identifications without hits do not count
+  mixed[1].setScoreType("other");
+  mixed[2].getHits().clear();
+  TEST_EQUAL(PSMTable::hasUniformScoreType(mixed), true)
+}
+END_SECTION
+
+PSMTable table;
+table.importIDs(ids, {"pep", "protein", "count"});
+
+START_SECTION(void clear())
+{
+  PSMTable tmp = table;
+  tmp.clear();
+  TEST_EQUAL(tmp.size(), 0)
+  TEST_EQUAL(tmp.getNrSpectra(), 0)
+  TEST_EQUAL(tmp.getNrSequences(), 0)
+  TEST_EQUAL(tmp.getColumnNames().empty(), true)
+}
+END_SECTION
+
+START_SECTION(const std::vector<double>& getScores() const)
+{
+  TEST_EQUAL(table.getScores().size(), 3)
+  TEST_REAL_SIMILAR(table.getScores()[0], 10.0)
+  TEST_REAL_SIMILAR(table.getScores()[1], 20.0)
+  TEST_REAL_SIMILAR(table.getScores()[2], 5.0)
+}
+END_SECTION
+
+START_SECTION(const std::vector<TargetDecoy>& getTargetDecoy() const)
+{
+  TEST_EQUAL(table.getTargetDecoy()[0] == PSMTable::TargetDecoy::TARGET, true)
+  TEST_EQUAL(table.getTargetDecoy()[1] == PSMTable::TargetDecoy::DECOY, true)
+  TEST_EQUAL(table.getTargetDecoy()[2] == PSMTable::TargetDecoy::TARGET_DECOY, true)
+}
+END_SECTION
+
+START_SECTION(const std::vector<Int>& getCharges() const)
+{
+  TEST_EQUAL(table.getCharges()[0], 2)
+  TEST_EQUAL(table.getCharges()[2], 3)
+}
+END_SECTION
+
+START_SECTION(const std::vector<UInt32>& getRanks() const)
+{
+  TEST_EQUAL(table.getRanks()[0], 2)
+  TEST_EQUAL(table.getRanks()[1], 1)
+}
+END_SECTION
+
+START_SECTION(const std::vector<UInt32>& getSpectrumIndices() const)
+{
+  TEST_EQUAL(table.getSpectrumIndices()[0], 0)
+  TEST_EQUAL(table.getSpectrumIndices()[1], 0)
+  TEST_EQUAL(table.getSpectrumIndices()[2], 2)
+}
+END_SECTION
+
+START_SECTION(std::vector<Size> getSpectrumOffsets() const)
+{
+  vector<Size> offsets = table.getSpectrumOffsets();
+  TEST_EQUAL(offsets.size(), 4)
+  TEST_EQUAL(offsets[0], 0)
+  TEST_EQUAL(offsets[1], 2)
+  TEST_EQUAL(offsets[2], 2)
+  TEST_EQUAL(offsets[3], 3)
+}
+END_SECTION
+
+START_SECTION(const std::vector<UInt32>& getSequenceIds() const)
+{
+  // equal sequences share an id
+  TEST_EQUAL(table.getSequenceIds()[0], table.getSequenceIds()[2])
+  TEST_NOT_EQUAL(table.getSequenceIds()[0], table.getSequenceIds()[1])
+}
+END_SECTION
+
+START_SECTION(Size getNrSequences() const)
+{
+  TEST_EQUAL(table.getNrSequences(), 2) // unmodified version of the modified sequence is already known
+}
+END_SECTION
+
+START_SECTION(const String& getSequence(UInt32 id) const)
+{
+  TEST_EQUAL(table.getSequence(table.getSequenceIds()[0]), "PEPTIDEK")
+  TEST_EQUAL(table.getSequence(table.getSequenceIds()[1]), AASequence::fromString("PEPT[+79.966]IDEK").toString())
+}
+END_SECTION
+
+START_SECTION(UInt32 getUnmodifiedSequenceId(UInt32 id) const)
+{
+  TEST_EQUAL(table.getUnmodifiedSequenceId(table.getSequenceIds()[0]), table.getSequenceIds()[0])
+  TEST_EQUAL(table.getUnmodifiedSequenceId(table.getSequenceIds()[1]), table.getSequenceIds()[0])
+}
+END_SECTION
+
+START_SECTION(const String& getRunIdentifier(Size spectrum) const)
+{
+  TEST_EQUAL(table.getRunIdentifier(0), "run1")
+  TEST_EQUAL(table.getRunIdentifier(1), "run2")
+  TEST_EQUAL(table.getRunIdentifier(2), "run1")
+}
+END_SECTION
+
+START_SECTION(UInt32 getRunIndex(Size spectrum) const)
+{
+  TEST_EQUAL(table.getRunIndex(0), 0)
+  TEST_EQUAL(table.getRunIndex(1), 1)
+  TEST_EQUAL(table.getRunIndex(2), 0)
+}
+END_SECTION
+
+START_SECTION(Size getNrRuns() const)
+{
+  TEST_EQUAL(table.getNrRuns(), 2)
+}
+END_SECTION
+
+START_SECTION(const String& getSpectrumReference(Size spectrum) const)
+{
+  TEST_EQUAL(table.getSpectrumReference(0), "scan=1")
+  TEST_EQUAL(table.getSpectrumReference(2), "")
+}
+END_SECTION
+
+START_SECTION(double getRT(Size spectrum) const)
+{
+  TEST_REAL_SIMILAR(table.getRT(0), 100.0)
+  TEST_REAL_SIMILAR(table.getRT(2), 200.0)
+}
+END_SECTION
+
+START_SECTION(double getMZ(Size spectrum) const)
+{
+  TEST_REAL_SIMILAR(table.getMZ(0), 500.0)
+}
+END_SECTION
+
+START_SECTION(bool hasNumericColumn(const String& name) const)
+{
+  TEST_EQUAL(table.hasNumericColumn("pep"), true)
+  TEST_EQUAL(table.hasNumericColumn("count"), true)
+  TEST_EQUAL(table.hasNumericColumn("protein"), false)
+  TEST_EQUAL(table.hasNumericColumn("unknown"), false)
+}
+END_SECTION
+
+START_SECTION(bool hasStringColumn(const String& name) const)
+{
+  TEST_EQUAL(table.hasStringColumn("protein"), true)
+  TEST_EQUAL(table.hasStringColumn("pep"), false)
+}
+END_SECTION
+
+START_SECTION(StringList getColumnNames() const)
+{
+  StringList names = table.getColumnNames();
+  TEST_EQUAL(names.size(), 3)
+  TEST_EQUAL(ListUtils::contains(names, "pep"), true)
+  TEST_EQUAL(ListUtils::contains(names, "protein"), true)
+  TEST_EQUAL(ListUtils::contains(names, "count"), true)
+}
+END_SECTION
+
+START_SECTION(const std::vector<double>& getNumericColumn(const String& name) const)
+{
+  const PSMTable& const_table = table;
+  const vector<double>& pep = const_table.getNumericColumn("pep");
+  TEST_EQUAL(std::isnan(pep[0]), true)
+  TEST_REAL_SIMILAR(pep[1], 0.5)
+  TEST_REAL_SIMILAR(const_table.getNumericColumn("count")[2], 7.0)
+  TEST_EXCEPTION(Exception::ElementNotFound, const_table.getNumericColumn("protein"))
+}
+END_SECTION
+
+START_SECTION(std::vector<double>& getNumericColumn(const String& name))
+{
+  PSMTable tmp = table;
+  tmp.getNumericColumn("pep")[0] = 0.25;
+  TEST_REAL_SIMILAR(tmp.getNumericColumn("pep")[0], 0.25)
+  TEST_EXCEPTION(Exception::ElementNotFound, tmp.getNumericColumn("unknown"))
+}
+END_SECTION
+
+START_SECTION((std::vector<double>& addNumericColumn(const String& name, bool integer = false)))
+{
+  PSMTable tmp = table;
+  vector<double>& column = tmp.addNumericColumn("new");
+  TEST_EQUAL(column.size(), 3)
+  TEST_EQUAL(std::isnan(column[0]), true)
+  TEST_EQUAL(tmp.hasNumericColumn("new"), true)
+  // existing columns are returned
+  TEST_REAL_SIMILAR(tmp.addNumericColumn("pep")[1], 0.5)
+}
+END_SECTION
+
+START_SECTION(const std::vector<UInt32>& getStringColumn(const String& name) const)
+{
+  const vector<UInt32>& protein = table.getStringColumn("protein");
+  TEST_EQUAL(protein[1], PSMTable::MISSING)
+  TEST_NOT_EQUAL(protein[0], protein[2])
+  TEST_EXCEPTION(Exception::ElementNotFound, table.getStringColumn("pep"))
+}
+END_SECTION
+
+START_SECTION(const String& getString(UInt32 id) const)
+{
+  TEST_EQUAL(table.getString(table.getStringColumn("protein")[0]), "P1")
+  TEST_EQUAL(table.getString(table.getStringColumn("protein")[2]), "P2")
+}
+END_SECTION
+
+START_SECTION(void setScoreType(const String& type))
+{
+  PSMTable tmp;
+  tmp.setScoreType("q-value");
+  TEST_EQUAL(tmp.getScoreType(), "q-value")
+}
+END_SECTION
+
+START_SECTION(void setHigherScoreBetter(bool higher_better))
+{
+  PSMTable tmp;
+  tmp.setHigherScoreBetter(false);
+  TEST_EQUAL(tmp.isHigherScoreBetter(), false)
+}
+END_SECTION
+
+START_SECTION(void sortHits())
+{
+  PSMTable tmp = table;
+  tmp.sortHits();
+  TEST_REAL_SIMILAR(tmp.getScores()[0], 20.0)
+  TEST_REAL_SIMILAR(tmp.getScores()[1], 10.0)
+  TEST_REAL_SIMILAR(tmp.getNumericColumn("pep")[0], 0.5)
+  TEST_EQUAL(tmp.getTargetDecoy()[0] == PSMTable::TargetDecoy::DECOY, true)
+  // rows stay with their spectrum
+  TEST_EQUAL(tmp.getSpectrumIndices()[2], 2)
+
+  tmp.setHigherScoreBetter(false);
+  tmp.sortHits();
+  TEST_REAL_SIMILAR(tmp.getScores()[0], 10.0)
+}
+END_SECTION
+
+START_SECTION(void assignRanks())
+{
+  PSMTable tmp = table;
+  tmp.getScores()[0] = 20.0; // tie
+  tmp.assignRanks();
+  TEST_EQUAL(tmp.getRanks()[0], 1)
+  TEST_EQUAL(tmp.getRanks()[1], 1)
+  TEST_EQUAL(tmp.getRanks()[2], 1)
+  tmp.getScores()[1] = 30.0;
+  tmp.assignRanks();
+  TEST_REAL_SIMILAR(tmp.getScores()[0], 30.0)
+  TEST_EQUAL(tmp.getRanks()[0], 1)
+  TEST_EQUAL(tmp.getRanks()[1], 2)
+}
+END_SECTION
+
+START_SECTION(void filterRows(const std::vector<uint8_t>& keep))
+{
+  PSMTable tmp = table;
+  tmp.filterRows({0, 1, 1});
+  TEST_EQUAL(tmp.size(), 2)
+  TEST_EQUAL(tmp.getNrSpectra(), 3)
+  TEST_REAL_SIMILAR(tmp.getScores()[0], 20.0)
+  TEST_EQUAL(tmp.getSpectrumIndices()[1], 2)
+  TEST_EQUAL(tmp.getNumericColumn("pep").size(), 2)
+  TEST_EQUAL(tmp.getStringColumn("protein").size(), 2)
+  TEST_EQUAL(tmp.getSpectrumOffsets()[1], 1)
+  TEST_EXCEPTION(Exception::InvalidSize, tmp.filterRows({1}))
+}
+END_SECTION
+
+START_SECTION(void exportIDs(std::vector<PeptideIdentification>& ids))
+{
+  // unchanged table: same hits
+  vector<PeptideIdentification> result = ids;
+  PSMTable tmp = table;
+  tmp.exportIDs(result);
+  TEST_EQUAL(result[0].getHits().size(), 2)
+  TEST_EQUAL(result[0].getHits()[0].getSequence().toString(), "PEPTIDEK")
+  TEST_EQUAL(result[0].getHits()[0].getMetaValue("protein"), "P1")
+  TEST_EQUAL(result[1].getHits().empty(), true)
+
+  // filtered and sorted, new and modified columns
+  tmp.filterRows({1, 1, 0});
+  tmp.setScoreType("new score");
+  tmp.setHigherScoreBetter(false);
+  tmp.getScores()[1] = 1.0;
+  tmp.assignRanks();
+  tmp.getNumericColumn("pep")[0] = 0.75; // rows are sorted by assignRanks()
+  tmp.addNumericColumn("flag", true)[1] = 1.0;
+  tmp.exportIDs(result);
+  TEST_EQUAL(result[0].getScoreType(), "new score")
+  TEST_EQUAL(result[0].isHigherScoreBetter(), false)
+  TEST_EQUAL(result[2].getScoreType(), "new score")
+  TEST_EQUAL(result[2].getHits().empty(), true)
+  ABORT_IF(result[0].getHits().size() != 2)
+  // the modified hit is the best one now
+  const PeptideHit& best = result[0].getHits()[0];
+  TEST_REAL_SIMILAR(best.getScore(), 1.0)
+  TEST_EQUAL(best.getRank(), 1)
+  TEST_EQUAL(best.getSequence().toString(), AASequence::fromString("PEPT[+79.966]IDEK").toString())
+  TEST_REAL_SIMILAR(best.getMetaValue("pep"), 0.75)
+  TEST_EQUAL(best.metaValueExists("flag"), false) // missing values are not written
+  const PeptideHit& second = result[0].getHits()[1];
+  TEST_REAL_SIMILAR(second.getScore(), 10.0)
+  TEST_EQUAL(second.getRank(), 2)
+  TEST_EQUAL(second.getSequence().toString(), "PEPTIDEK")
+  TEST_EQUAL(second.getMetaValue("protein"), "P1") // other meta values are kept
+  TEST_EQUAL(second.getMetaValue("flag"), 1)
+  TEST_EQUAL(second.getMetaValue("flag").valueType(), DataValue::INT_VALUE)
+  TEST_EQUAL(second.metaValueExists("pep"), false)
+
+  // the table can be exported again
+  tmp.getScores()[0] = 2.0;
+  tmp.exportIDs(result);
+  TEST_REAL_SIMILAR(result[0].getHits()[0].getScore(), 2.0)
+  TEST_REAL_SIMILAR(result[0].getHits()[0].getMetaValue("pep"), 0.75)
+  TEST_REAL_SIMILAR(result[0].getHits()[1].getScore(), 10.0)
+  TEST_EQUAL(result[0].getHits()[1].getSequence().toString(), "PEPTIDEK")
+
+  vector<PeptideIdentification> wrong_size(2);
+  TEST_EXCEPTION(Exception::IllegalArgument, tmp.exportIDs(wrong_size))
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -15,6 +15,11 @@
 #include <OpenMS/CHEMISTRY/ResidueDB.h>
 #include <OpenMS/CHEMISTRY/Residue.h>
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
 using namespace OpenMS;
 using namespace std;
 
@@ -118,6 +123,56 @@ START_SECTION(Size getNumberOfModifiedResidues() const)
 	TEST_EQUAL(ptr->getNumberOfModifiedResidues(), 6) // + C(Carbamidomethyl)
 END_SECTION
 
+START_SECTION(void freeze())
+{
+	const Residue* mod_res = ptr->getModifiedResidue("Carbamidomethyl (C)");
+	Size nr_mod_residues = ptr->getNumberOfModifiedResidues();
+	ptr->freeze();
+	TEST_EQUAL(ptr->getModifiedResidue("Carbamidomethyl (C)"), mod_res)
+	TEST_EQUAL(ptr->getModifiedResidue(ptr->getResidue('C'), "Carbamidomethyl"), mod_res)
+	TEST_EQUAL(ptr->getNumberOfModifiedResidues(), nr_mod_residues)
+	TEST_EQUAL(ptr->hasResidue(mod_res), true)
+
+	// new modified residues can still be created
+	const Residue* ox_res = ptr->getModifiedResidue(ptr->getResidue('W'), "Oxidation");
+	TEST_EQUAL(ox_res->getModificationName(), "Oxidation")
+	TEST_EQUAL(ptr->getNumberOfModifiedResidues(), nr_mod_residues + 1)
+
+	// lookups from several threads return the same residues
+	int wrong = 0;
+#pragma omp parallel for reduction (+: wrong)
+	for (int i = 0; i < 1000; ++i)
+	{
+		if (ptr->getModifiedResidue(ptr->getResidue("C"), "Carbamidomethyl") != mod_res) ++wrong;
+		if (ptr->getModifiedResidue(ptr->getResidue("W"), "Oxidation") != ox_res) ++wrong;
+	}
+	TEST_EQUAL(wrong, 0)
+	TEST_EXCEPTION(Exception::InvalidValue, ptr->getModifiedResidue(ptr->getResidue('C'), "NoSuchModification"))
+
+#ifdef _OPENMP
+	// after freezing, the lookup of a residue created at runtime does not take the lock:
+	// it finishes while another thread holds the critical section of the database
+	ptr->freeze();
+	std::atomic<bool> locked{false}, release{false};
+	std::thread lock_holder([&]()
+	{
+		#pragma omp critical (ResidueDB)
+		{
+			locked = true;
+			while (!release) std::this_thread::yield();
+		}
+	});
+	while (!locked) std::this_thread::yield();
+	auto lookup = std::async(std::launch::async, [&]() { return ptr->getModifiedResidue(ptr->getResidue('W'), "Oxidation"); });
+	bool lock_free = lookup.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+	release = true;
+	lock_holder.join();
+	TEST_EQUAL(lock_free, true)
+	TEST_EQUAL(lookup.get(), ox_res)
+#endif
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
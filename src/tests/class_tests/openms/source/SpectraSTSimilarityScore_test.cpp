@@ -252,6 +252,20 @@ START_SECTION(double dot_bias(const BinnedSpectrum &bin1, const BinnedSpectrum &
   TEST_REAL_SIMILAR(ptr->dot_bias(bin1, bin2, 1), 98.585);
   TEST_REAL_SIMILAR(ptr->dot_bias(bin2, bin1, 1), 98.585);
 END_SECTION
+
+START_SECTION(void batchCompare(const PeakSpectrum& query, const std::vector<const PeakSpectrum*>& library, std::vector<double>& scores) const)
+{
+  PeakMap exp;
+  std::vector< PeptideIdentification > ids;
+  MSPFile().load(OPENMS_GET_TEST_DATA_PATH("SpectraSTSimilarityScore_1.msp"), ids, exp);
+
+  std::vector<double> scores;
+  ptr->batchCompare(exp[0], {&exp[1]}, scores);
+  TEST_EQUAL(scores.size(), 1)
+  TEST_EQUAL(scores[0], (*ptr)(exp[0], exp[1]))
+}
+END_SECTION
+
 START_SECTION(BinnedSpectrum transform(const PeakSpectrum& spec))
   PeakSpectrum s1;
   Peak1D peak;
@@ -0,0 +1,252 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
+///////////////////////////
+
+#include <OpenMS/COMPARISON/SpectraSTSimilarityScore.h>
+#include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/FORMAT/MSPFile.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/METADATA/PeptideIdentification.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <Eigen/Sparse>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectralLibraryIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SpectralLibraryIndex* ptr = nullptr;
+SpectralLibraryIndex* nullPointer = nullptr;
+
+START_SECTION(SpectralLibraryIndex())
+{
+  ptr = new SpectralLibraryIndex();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOpen(), false)
+  TEST_EQUAL(ptr->getNrSpectra(), 0)
+}
+END_SECTION
+
+START_SECTION(~SpectralLibraryIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+// 7 spectra: 4 x AAFDIFVLGAEDGCISTK (charge 2 and 3), one with an oxidized methionine and two with N-terminal acetylation
+const String library_file = OPENMS_GET_TEST_DATA_PATH("MSPFile_test.msp");
+
+SpectralLibraryIndex::Parameters params;
+
+String index_file;
+NEW_TMP_FILE(index_file)
+
+START_SECTION(String Parameters::getFingerprint() const)
+{
+  SpectralLibraryIndex::Parameters other = params;
+  TEST_EQUAL(params.getFingerprint(), other.getFingerprint())
+  other.remove_peaks_below_threshold = 100.0;
+  TEST_NOT_EQUAL(params.getFingerprint(), other.getFingerprint())
+  other = params;
+  other.variable_modifications = {"Oxidation (M)"};
+  TEST_NOT_EQUAL(params.getFingerprint(), other.getFingerprint())
+}
+END_SECTION
+
+START_SECTION((static void create(const String& filename, const String& library_file, const Parameters& params)))
+{
+  SpectralLibraryIndex::create(index_file, library_file, params);
+  TEST_EQUAL(File::exists(index_file), true)
+  TEST_EXCEPTION(Exception::FileNotFound, SpectralLibraryIndex::create(index_file, "this_file_does_not_exist.msp", params))
+}
+END_SECTION
+
+START_SECTION((static bool isUpToDate(const String& filename, const String& library_file, const Parameters& params)))
+{
+  TEST_EQUAL(SpectralLibraryIndex::isUpToDate(index_file, library_file, params), true)
+  SpectralLibraryIndex::Parameters other = params;
+  other.remove_peaks_below_threshold = 100.0;
+  TEST_EQUAL(SpectralLibraryIndex::isUpToDate(index_file, library_file, other), false)
+  TEST_EQUAL(SpectralLibraryIndex::isUpToDate("this_file_does_not_exist.slib", library_file, params), false)
+  TEST_EQUAL(SpectralLibraryIndex::isUpToDate(library_file, library_file, params), false)
+}
+END_SECTION
+
+SpectralLibraryIndex index;
+
+START_SECTION(void open(const String& filename))
+{
+  index.open(index_file);
+  TEST_EQUAL(index.isOpen(), true)
+  TEST_EXCEPTION(Exception::FileNotFound, SpectralLibraryIndex().open("this_file_does_not_exist.slib"))
+  TEST_EXCEPTION(Exception::ParseError, SpectralLibraryIndex().open(library_file))
+}
+END_SECTION
+
+// reference: the library as read by MSPFile
+vector<PeptideIdentification> ids;
+PeakMap library;
+MSPFile().load(library_file, ids, library);
+
+START_SECTION(Size getNrSpectra() const)
+{
+  TEST_EQUAL(index.getNrSpectra(), 7)
+}
+END_SECTION
+
+START_SECTION(const SpectrumRecord& getSpectrum(Size index) const)
+{
+  for (Size i = 1; i < index.getNrSpectra(); ++i)
+  {
+    TEST_EQUAL(index.getSpectrum(i - 1).precursor_mz <= index.getSpectrum(i).precursor_mz, true)
+  }
+  for (Size i = 0; i < index.getNrSpectra(); ++i)
+  {
+    const auto& rec = index.getSpectrum(i);
+    TEST_REAL_SIMILAR(rec.precursor_mz, library[rec.library_index].getPrecursors()[0].getMZ())
+    TEST_EQUAL(rec.charge, ids[rec.library_index].getHits()[0].getCharge())
+  }
+  // spectra with the same precursor m/z keep the order of the library
+  for (Size i = 1; i < index.getNrSpectra(); ++i)
+  {
+    if (index.getSpectrum(i - 1).precursor_mz == index.getSpectrum(i).precursor_mz)
+    {
+      TEST_EQUAL(index.getSpectrum(i - 1).library_index < index.getSpectrum(i).library_index, true)
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(std::string_view getSequence(Size index) const)
+{
+  for (Size i = 0; i < index.getNrSpectra(); ++i)
+  {
+    TEST_EQUAL(String(index.getSequence(i)), ids[index.getSpectrum(i).library_index].getHits()[0].getSequence().toString())
+  }
+}
+END_SECTION
+
+START_SECTION(std::string_view getString(StringIndex index) const)
+{
+  TEST_EQUAL(String(index.getString(index.getSpectrum(0).sequence)), String(index.getSequence(0)))
+}
+END_SECTION
+
+START_SECTION(SpectrumComparisonKernels::PeakArraysView getPeaks(Size index) const)
+{
+  for (Size i = 0; i < index.getNrSpectra(); ++i)
+  {
+    const PeakSpectrum& spec = library[index.getSpectrum(i).library_index];
+    const auto& annotations = ids[index.getSpectrum(i).library_index].getHits()[0].getPeakAnnotations();
+    auto peaks = index.getPeaks(i);
+    Size k = 0;
+    for (Size l = 0; l < spec.size(); ++l)
+    {
+      if (spec[l].getIntensity() <= params.remove_peaks_below_threshold) continue;
+      TEST_REAL_SIMILAR(peaks.mz[k], spec[l].getMZ())
+      const double factor = annotations[l].annotation[0] == '?' ? 0.2 : 1.0;
+      TEST_REAL_SIMILAR(peaks.intensity[k], sqrt(factor * spec[l].getIntensity()))
+      ++k;
+    }
+    TEST_EQUAL(peaks.size(), k)
+  }
+}
+END_SECTION
+
+START_SECTION(SpectrumComparisonKernels::BinsView getBins(Size index) const)
+{
+  SpectraSTSimilarityScore spectrast;
+  for (Size i = 0; i < index.getNrSpectra(); ++i)
+  {
+    auto peaks = index.getPeaks(i);
+    PeakSpectrum spec;
+    for (Size k = 0; k < peaks.size(); ++k)
+    {
+      spec.emplace_back(peaks.mz[k], peaks.intensity[k]);
+    }
+    BinnedSpectrum binned = spectrast.transform(spec);
+    auto bins = index.getBins(i);
+    TEST_EQUAL(bins.nr_bins, Size(binned.getBins()->nonZeros()))
+    for (Size k = 0; k < bins.nr_bins; ++k)
+    {
+      TEST_EQUAL(bins.index[k], UInt32(binned.getBins()->innerIndexPtr()[k]))
+      TEST_REAL_SIMILAR(bins.value[k], binned.getBins()->valuePtr()[k])
+    }
+  }
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getSpectrumRange(double min_mz, double max_mz) const))
+{
+  // AAFDIFVLGAEDGCISTK/2 (three times) and AM(O)FDIFVLGAEDGCISTK/2, all with MW 1857.918 in the library
+  const double mz = (1857.918 + 2 * Constants::PROTON_MASS_U) / 2;
+  auto range = index.getSpectrumRange(mz - 0.01, mz + 0.01);
+  TEST_EQUAL(range.second - range.first, 4)
+  TEST_EQUAL(String(index.getSequence(range.first)), "AAFDIFVLGAEDGCISTK")
+  TEST_EQUAL(String(index.getSequence(range.second - 1)), "AM(Oxidation)FDIFVLGAEDGCISTK")
+  range = index.getSpectrumRange(0.0, 1e6);
+  TEST_EQUAL(range.first, 0)
+  TEST_EQUAL(range.second, 7)
+  range = index.getSpectrumRange(10.0, 20.0);
+  TEST_EQUAL(range.first, range.second)
+}
+END_SECTION
+
+START_SECTION(PeptideHit getPeptideHit(Size index) const)
+{
+  for (Size i = 0; i < index.getNrSpectra(); ++i)
+  {
+    const PeptideHit& ref = ids[index.getSpectrum(i).library_index].getHits()[0];
+    PeptideHit hit = index.getPeptideHit(i);
+    TEST_EQUAL(hit.getSequence(), ref.getSequence())
+    TEST_EQUAL(hit.getCharge(), ref.getCharge())
+    TEST_EQUAL(hit.getPeakAnnotations() == ref.getPeakAnnotations(), true)
+  }
+}
+END_SECTION
+
+START_SECTION(void close())
+{
+  index.close();
+  TEST_EQUAL(index.isOpen(), false)
+  TEST_EQUAL(index.getNrSpectra(), 0)
+}
+END_SECTION
+
+START_SECTION((void openOrCreate(const String& filename, const String& library_file, const Parameters& params)))
+{
+  String new_index;
+  NEW_TMP_FILE(new_index)
+  SpectralLibraryIndex s;
+  s.openOrCreate(new_index, library_file, params);
+  TEST_EQUAL(s.isOpen(), true)
+  TEST_EQUAL(s.getNrSpectra(), 7)
+  s.close();
+
+  // other settings: the index is recreated (the two spectra with an oxidized methionine do not match the fixed modification)
+  SpectralLibraryIndex::Parameters other = params;
+  other.fixed_modifications = {"Dioxidation (M)"};
+  s.openOrCreate(new_index, library_file, other);
+  TEST_EQUAL(s.getNrSpectra(), 5)
+  TEST_EQUAL(SpectralLibraryIndex::isUpToDate(new_index, library_file, other), true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -109,6 +109,19 @@ START_SECTION(double operator()(const PeakSpectrum &spec) const)
 	
 END_SECTION
 
+START_SECTION(void batchCompare(const PeakSpectrum& query, const std::vector<const PeakSpectrum*>& library, std::vector<double>& scores) const)
+{
+  PeakSpectrum s1;
+  DTAFile().load(OPENMS_GET_TEST_DATA_PATH("PILISSequenceDB_DFPIANGER_1.dta"), s1);
+  PeakSpectrum s2(s1);
+  s2.resize(100);
+  std::vector<double> scores;
+  ptr->batchCompare(s1, {&s2}, scores);
+  TEST_EQUAL(scores.size(), 1)
+  TEST_EQUAL(scores[0], (*ptr)(s1, s2))
+}
+END_SECTION
+
 delete ptr;
 
 /////////////////////////////////////////////////////////////
@@ -0,0 +1,348 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
+///////////////////////////
+
+#include <OpenMS/COMPARISON/BinnedSpectralContrastAngle.h>
+#include <OpenMS/COMPARISON/SpectraSTSimilarityScore.h>
+#include <OpenMS/COMPARISON/SteinScottImproveScore.h>
+#include <OpenMS/COMPARISON/ZhangSimilarityScore.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#include <Eigen/Sparse>
+
+#include <random>
+
+using namespace OpenMS;
+using namespace std;
+using namespace SpectrumComparisonKernels;
+
+namespace
+{
+  PeakSpectrum makeSpectrum(const vector<pair<double, float>>& peaks)
+  {
+    PeakSpectrum spec;
+    for (const auto& p : peaks)
+    {
+      spec.emplace_back(p.first, p.second);
+    }
+    return spec;
+  }
+
+  PeakSpectrum randomSpectrum(std::mt19937& rng, Size nr_peaks)
+  {
+    std::uniform_real_distribution<double> mz(100.0, 2000.0);
+    std::uniform_real_distribution<float> intensity(1.0f, 1000.0f);
+    PeakSpectrum spec;
+    for (Size i = 0; i < nr_peaks; ++i)
+    {
+      spec.emplace_back(mz(rng), intensity(rng));
+    }
+    spec.sortByPosition();
+    return spec;
+  }
+
+  // former scalar implementations of the functors (reference for the benchmark)
+  double referenceZhang(const PeakSpectrum& s1, const PeakSpectrum& s2, double tolerance)
+  {
+    double sum(0), sum1(0), sum2(0);
+    for (const Peak1D& p : s1) sum1 += p.getIntensity();
+    for (const Peak1D& p : s2) sum2 += p.getIntensity();
+    Size j_left(0);
+    for (Size i = 0; i != s1.size(); ++i)
+    {
+      for (Size j = j_left; j != s2.size(); ++j)
+      {
+        double pos1(s1[i].getMZ()), pos2(s2[j].getMZ());
+        if (fabs(pos1 - pos2) < tolerance)
+        {
+          sum += sqrt(s1[i].getIntensity() * s2[j].getIntensity() * 1.0);
+        }
+        else if (pos2 > pos1)
+        {
+          break;
+        }
+        else
+        {
+          j_left = j;
+        }
+      }
+    }
+    return sum / (sqrt(sum1 * sum2));
+  }
+
+  double referenceSteinScott(const PeakSpectrum& s1, const PeakSpectrum& s2, double epsilon, double threshold)
+  {
+    const double constant = epsilon / 10000;
+    double sum(0), sum1(0), sum2(0), sum3(0), sum4(0);
+    for (const Peak1D& p : s1)
+    {
+      double temp = p.getIntensity();
+      sum1 += temp * temp;
+      sum3 += temp;
+    }
+    for (const Peak1D& p : s2)
+    {
+      double temp = p.getIntensity();
+      sum2 += temp * temp;
+      sum4 += temp;
+    }
+    double z = constant * (sum3 * sum4);
+    Size j_left(0);
+    for (Size i = 0; i != s1.size(); ++i)
+    {
+      for (Size j = j_left; j != s2.size(); ++j)
+      {
+        double pos1(s1[i].getMZ()), pos2(s2[j].getMZ());
+        if (std::abs(pos1 - pos2) <= 2 * epsilon)
+        {
+          sum += s1[i].getIntensity() * s2[j].getIntensity();
+        }
+        else if (pos2 > pos1)
+        {
+          break;
+        }
+        else
+        {
+          j_left = j;
+        }
+      }
+    }
+    double score = (sum - z) / (std::sqrt((sum1 * sum2)));
+    return score < (float)threshold ? 0 : score;
+  }
+
+  double referenceSpectraST(const PeakSpectrum& s1, const PeakSpectrum& s2)
+  {
+    BinnedSpectrum bin1(s1, 1, false, 1, BinnedSpectrum::DEFAULT_BIN_OFFSET_LOWRES);
+    BinnedSpectrum bin2(s2, 1, false, 1, BinnedSpectrum::DEFAULT_BIN_OFFSET_LOWRES);
+    *bin1.getBins() /= bin1.getBins()->norm();
+    *bin2.getBins() /= bin2.getBins()->norm();
+    return bin1.getBins()->dot(*bin2.getBins());
+  }
+
+  double referenceContrastAngle(const BinnedSpectrum& spec1, const BinnedSpectrum& spec2)
+  {
+    const double sum1 = spec1.getBins()->dot(*spec1.getBins());
+    const double sum2 = spec2.getBins()->dot(*spec2.getBins());
+    const double numerator = spec1.getBins()->dot(*spec2.getBins());
+    return numerator / (sqrt(sum1 * sum2));
+  }
+}
+
+START_TEST(SpectrumComparisonKernels, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+const PeakSpectrum s1 = makeSpectrum({{100.0, 1.0f}, {200.0, 2.0f}, {300.0, 3.0f}});
+const PeakSpectrum s2 = makeSpectrum({{100.05, 4.0f}, {199.9, 5.0f}, {200.1, 6.0f}, {400.0, 7.0f}});
+
+START_SECTION(void PeakArrays::assign(const PeakSpectrum& spec))
+{
+  PeakArrays p;
+  TEST_EQUAL(p.size(), 0)
+  p.assign(s2);
+  TEST_EQUAL(p.size(), 4)
+  TEST_REAL_SIMILAR(p.mz[1], 199.9)
+  TEST_REAL_SIMILAR(p.intensity[3], 7.0)
+  p.assign(s1);
+  TEST_EQUAL(p.size(), 3)
+  TEST_EQUAL(PeakArrays(s1).size(), 3)
+}
+END_SECTION
+
+START_SECTION(double sumOfIntensities(const PeakArrays& peaks))
+{
+  TEST_REAL_SIMILAR(sumOfIntensities(PeakArrays(s1)), 6.0)
+  TEST_REAL_SIMILAR(sumOfIntensities(PeakArrays()), 0.0)
+}
+END_SECTION
+
+START_SECTION(double sumOfIntensities(const PeakSpectrum& peaks))
+{
+  TEST_REAL_SIMILAR(sumOfIntensities(s1), 6.0)
+  TEST_REAL_SIMILAR(sumOfIntensities(PeakSpectrum()), 0.0)
+}
+END_SECTION
+
+START_SECTION(double sumOfSquaredIntensities(const PeakArrays& peaks))
+{
+  TEST_REAL_SIMILAR(sumOfSquaredIntensities(PeakArrays(s1)), 14.0)
+}
+END_SECTION
+
+START_SECTION(double sumOfSquaredIntensities(const PeakSpectrum& peaks))
+{
+  TEST_REAL_SIMILAR(sumOfSquaredIntensities(s1), 14.0)
+}
+END_SECTION
+
+START_SECTION((template <bool Inclusive, typename Peaks1, typename Peaks2, typename MatchFunctor> void forEachMatch(const Peaks1& s1, const Peaks2& s2, double tolerance, MatchFunctor&& f)))
+{
+  const PeakArrays p1(s1), p2(s2);
+  vector<pair<Size, Size>> matches;
+  forEachMatch<false>(p1, p2, 0.2, [&matches](Size i, Size j) { matches.emplace_back(i, j); });
+  TEST_EQUAL(matches.size(), 3)
+  TEST_EQUAL(matches[0].first, 0)
+  TEST_EQUAL(matches[0].second, 0)
+  TEST_EQUAL(matches[1].first, 1)
+  TEST_EQUAL(matches[1].second, 1)
+  TEST_EQUAL(matches[2].first, 1)
+  TEST_EQUAL(matches[2].second, 2)
+
+  // directly on the spectra
+  vector<pair<Size, Size>> matches_spectra;
+  forEachMatch<false>(p1, s2, 0.2, [&matches_spectra](Size i, Size j) { matches_spectra.emplace_back(i, j); });
+  TEST_EQUAL(matches_spectra == matches, true)
+  matches_spectra.clear();
+  forEachMatch<false>(s1, s2, 0.2, [&matches_spectra](Size i, Size j) { matches_spectra.emplace_back(i, j); });
+  TEST_EQUAL(matches_spectra == matches, true)
+
+  // tolerance of exactly the distance of two peaks
+  const PeakArrays a(makeSpectrum({{100.0, 1.0f}})), b(makeSpectrum({{100.5, 1.0f}}));
+  matches.clear();
+  forEachMatch<false>(a, b, 0.5, [&matches](Size i, Size j) { matches.emplace_back(i, j); });
+  TEST_EQUAL(matches.size(), 0)
+  forEachMatch<true>(a, b, 0.5, [&matches](Size i, Size j) { matches.emplace_back(i, j); });
+  TEST_EQUAL(matches.size(), 1)
+
+  // empty input
+  matches.clear();
+  forEachMatch<true>(PeakArrays(), p2, 0.5, [&matches](Size i, Size j) { matches.emplace_back(i, j); });
+  forEachMatch<true>(p1, PeakArrays(), 0.5, [&matches](Size i, Size j) { matches.emplace_back(i, j); });
+  TEST_EQUAL(matches.size(), 0)
+}
+END_SECTION
+
+const BinnedSpectrum b1(s1, 1.0, false, 1, BinnedSpectrum::DEFAULT_BIN_OFFSET_LOWRES);
+const BinnedSpectrum b2(s2, 1.0, false, 1, BinnedSpectrum::DEFAULT_BIN_OFFSET_LOWRES);
+
+START_SECTION(float sparseDot(const BinnedSpectrum::SparseVectorType& a, const BinnedSpectrum::SparseVectorType& b))
+{
+  TEST_EQUAL(sparseDot(*b1.getBins(), *b2.getBins()), b1.getBins()->dot(*b2.getBins()))
+  TEST_EQUAL(sparseDot(*b1.getBins(), *b1.getBins()), b1.getBins()->dot(*b1.getBins()))
+  TEST_EQUAL(sparseDot(*b2.getBins(), *b1.getBins()), b2.getBins()->dot(*b1.getBins()))
+}
+END_SECTION
+
+START_SECTION(float DenseBins::dot(const BinnedSpectrum::SparseVectorType& bins) const)
+{
+  DenseBins d(*b1.getBins());
+  TEST_EQUAL(d.dot(*b2.getBins()), sparseDot(*b1.getBins(), *b2.getBins()))
+  TEST_EQUAL(d.dot(*b1.getBins()), sparseDot(*b1.getBins(), *b1.getBins()))
+  // reuse for another query (with more bins)
+  d.assign(*b2.getBins());
+  TEST_EQUAL(d.dot(*b1.getBins()), sparseDot(*b2.getBins(), *b1.getBins()))
+  TEST_EQUAL(d.dot(*b2.getBins()), sparseDot(*b2.getBins(), *b2.getBins()))
+  // ... and back to a shorter one: no leftovers of the previous query
+  d.assign(*b1.getBins());
+  TEST_EQUAL(d.dot(*b2.getBins()), sparseDot(*b1.getBins(), *b2.getBins()))
+  TEST_EQUAL(DenseBins().dot(*b1.getBins()), 0.0f)
+}
+END_SECTION
+
+START_SECTION([EXTRA] scores and speed of the ported functors against their former implementation)
+{
+  std::mt19937 rng(42);
+  const Size nr_library = 2000;
+  const PeakSpectrum query = randomSpectrum(rng, 150);
+  vector<PeakSpectrum> library;
+  vector<const PeakSpectrum*> library_ptr;
+  for (Size i = 0; i < nr_library; ++i)
+  {
+    library.push_back(randomSpectrum(rng, 150));
+  }
+  library.push_back(query); // one perfect match
+  for (const auto& l : library) library_ptr.push_back(&l);
+
+  ZhangSimilarityScore zhang;
+  SteinScottImproveScore stein_scott;
+  SpectraSTSimilarityScore spectrast;
+  BinnedSpectralContrastAngle contrast_angle;
+  const double zhang_tolerance = zhang.getParameters().getValue("tolerance");
+  const double stein_scott_tolerance = stein_scott.getParameters().getValue("tolerance");
+  const double stein_scott_threshold = stein_scott.getParameters().getValue("threshold");
+
+  StopWatch sw;
+  vector<double> reference(library.size()), scores;
+  Size nr_different = 0;
+
+  // Zhang
+  sw.start();
+  for (Size i = 0; i < library.size(); ++i) reference[i] = referenceZhang(query, library[i], zhang_tolerance);
+  sw.stop();
+  double t_ref = sw.getClockTime();
+  sw.reset();
+  sw.start();
+  zhang.batchCompare(query, library_ptr, scores);
+  sw.stop();
+  STATUS("ZhangSimilarityScore: former " << t_ref << " s, batch " << sw.getClockTime() << " s")
+  sw.reset();
+  for (Size i = 0; i < library.size(); ++i) nr_different += (reference[i] != scores[i]) + (reference[i] != zhang(query, library[i]));
+
+  // Stein & Scott
+  sw.start();
+  for (Size i = 0; i < library.size(); ++i) reference[i] = referenceSteinScott(query, library[i], stein_scott_tolerance, stein_scott_threshold);
+  sw.stop();
+  t_ref = sw.getClockTime();
+  sw.reset();
+  sw.start();
+  stein_scott.batchCompare(query, library_ptr, scores);
+  sw.stop();
+  STATUS("SteinScottImproveScore: former " << t_ref << " s, batch " << sw.getClockTime() << " s")
+  sw.reset();
+  for (Size i = 0; i < library.size(); ++i) nr_different += (reference[i] != scores[i]) + (reference[i] != stein_scott(query, library[i]));
+
+  // SpectraST
+  sw.start();
+  for (Size i = 0; i < library.size(); ++i) reference[i] = referenceSpectraST(query, library[i]);
+  sw.stop();
+  t_ref = sw.getClockTime();
+  sw.reset();
+  sw.start();
+  spectrast.batchCompare(query, library_ptr, scores);
+  sw.stop();
+  STATUS("SpectraSTSimilarityScore: former " << t_ref << " s, batch " << sw.getClockTime() << " s")
+  sw.reset();
+  for (Size i = 0; i < library.size(); ++i) nr_different += (reference[i] != scores[i]) + (reference[i] != spectrast(query, library[i]));
+
+  // contrast angle on high resolution bins (binning is not part of the comparison)
+  const BinnedSpectrum binned_query(query, BinnedSpectrum::DEFAULT_BIN_WIDTH_HIRES, false, 1, BinnedSpectrum::DEFAULT_BIN_OFFSET_HIRES);
+  vector<BinnedSpectrum> binned_library;
+  vector<const BinnedSpectrum*> binned_library_ptr;
+  for (const auto& l : library)
+  {
+    binned_library.emplace_back(l, BinnedSpectrum::DEFAULT_BIN_WIDTH_HIRES, false, 1, BinnedSpectrum::DEFAULT_BIN_OFFSET_HIRES);
+  }
+  for (const auto& l : binned_library) binned_library_ptr.push_back(&l);
+  sw.start();
+  for (Size i = 0; i < library.size(); ++i) reference[i] = referenceContrastAngle(binned_query, binned_library[i]);
+  sw.stop();
+  t_ref = sw.getClockTime();
+  sw.reset();
+  sw.start();
+  contrast_angle.batchCompare(binned_query, binned_library_ptr, scores);
+  sw.stop();
+  STATUS("BinnedSpectralContrastAngle: former " << t_ref << " s, batch " << sw.getClockTime() << " s")
+  for (Size i = 0; i < library.size(); ++i) nr_different += (reference[i] != scores[i]) + (reference[i] != contrast_angle(binned_query, binned_library[i]));
+
+  // bit-identical scores
+  TEST_EQUAL(nr_different, 0)
+  TEST_REAL_SIMILAR(scores.back(), 1.0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -19,6 +19,12 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 #include <OpenMS/IONMOBILITY/IMDataConverter.h>
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+#include <fstream>
+
 using namespace OpenMS;
 
 typedef OpenSwath::LightTransition TransitionType;
@@ -405,6 +411,118 @@ START_SECTION( void correctMZ(OpenMS::MRMFeatureFinderScoring::TransitionGroupMa
       TEST_REAL_SIMILAR(data[3], -0.00428216 + 0.999986 * 800.02) // 800.004284734697
   }
 
+  {
+    // the calibration points are collected in parallel, but used in the order of the
+    // transition groups: results and debug file do not depend on the number of threads
+    const Size nr_groups = 40;
+    std::vector<OpenMS::MRMFeatureFinderScoring::MRMTransitionGroupType> groups(nr_groups);
+    OpenSwath::LightTargetedExperiment many_exp;
+    std::map<String, OpenMS::MRMFeatureFinderScoring::MRMTransitionGroupType *> many_group_map;
+    std::vector<double> expected_theo_mz;
+    for (Size i = 0; i < nr_groups; ++i)
+    {
+      MRMFeature f;
+      f.setRT(1000.0 + 10.0 * i);
+      groups[i].addFeature(f);
+      for (Size j = 0; j < 3; ++j)
+      {
+        TransitionType tr;
+        tr.product_mz = 300.0 + 10.0 * i + 2.0 * j;
+        tr.precursor_mz = 412;
+        tr.peptide_ref = "pep_" + String(i);
+        tr.transition_name = "tr_" + String(i) + "_" + String(j);
+        groups[i].addTransition(tr, tr.transition_name);
+        many_exp.transitions.push_back(tr);
+        expected_theo_mz.push_back(tr.product_mz);
+      }
+      OpenSwath::LightCompound cmp;
+      cmp.id = "pep_" + String(i);
+      many_exp.compounds.push_back(cmp);
+      many_group_map[String("group_") + (i < 10 ? "0" : "") + String(i)] = &groups[i];
+    }
+
+    auto createMap = [&]()
+    {
+      boost::shared_ptr<PeakMap> many_spectra(new PeakMap);
+      for (Size i = 0; i < nr_groups; ++i)
+      {
+        MSSpectrum spec;
+        for (Size j = 0; j < 3; ++j)
+        {
+          spec.push_back(Peak1D(300.0 + 10.0 * i + 2.0 * j + 0.001 * ((i + j) % 5) - 0.002, 100.0 + 10.0 * j));
+        }
+        spec.setRT(1001.0 + 10.0 * i);
+        many_spectra->addSpectrum(spec);
+      }
+      OpenSwath::SwathMap m = map;
+      m.sptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(many_spectra);
+      return std::vector<OpenSwath::SwathMap>(1, m);
+    };
+
+    auto correct = [&](int nr_threads, const String& debug_file)
+    {
+#ifdef _OPENMP
+      omp_set_num_threads(nr_threads);
+#endif
+      SwathMapMassCorrection many_mc;
+      auto p = many_mc.getDefaults();
+      p.setValue("mz_correction_function", "quadratic_regression_delta_ppm");
+      p.setValue("mz_extraction_window", 0.05);
+      p.setValue("debug_mz_file", debug_file);
+      many_mc.setParameters(p);
+      std::vector<OpenSwath::SwathMap> swath_maps = createMap();
+      many_mc.correctMZ(many_group_map, many_exp, swath_maps, false);
+      std::vector<double> corrected;
+      for (Size i = 0; i < nr_groups; ++i)
+      {
+        const std::vector<double> mz = swath_maps[0].sptr->getSpectrumById(i)->getMZArray()->data;
+        corrected.insert(corrected.end(), mz.begin(), mz.end());
+      }
+      return corrected;
+    };
+
+    auto readLines = [](const String& filename)
+    {
+      std::vector<String> lines;
+      std::ifstream is(filename.c_str());
+      std::string line;
+      while (std::getline(is, line))
+      {
+        lines.push_back(line);
+      }
+      return lines;
+    };
+
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+#endif
+    String debug_serial, debug_parallel;
+    NEW_TMP_FILE(debug_serial)
+    NEW_TMP_FILE(debug_parallel)
+    std::vector<double> serial = correct(1, debug_serial);
+    std::vector<String> serial_lines = readLines(debug_serial);
+    for (int nr_threads : {2, 4, 7})
+    {
+      std::vector<double> parallel = correct(nr_threads, debug_parallel);
+      TEST_EQUAL(parallel == serial, true)
+      TEST_EQUAL(readLines(debug_parallel) == serial_lines, true)
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+
+    // header and one calibration point per transition, in the order of the transition groups
+    TEST_EQUAL(serial_lines.size(), expected_theo_mz.size() + 1)
+    ABORT_IF(serial_lines.size() != expected_theo_mz.size() + 1)
+    for (Size i = 0; i < expected_theo_mz.size(); ++i)
+    {
+      std::vector<String> columns;
+      serial_lines[i + 1].split('\t', columns);
+      TEST_REAL_SIMILAR(columns[1].toDouble(), expected_theo_mz[i])
+    }
+    TEST_EQUAL(serial.size(), 3 * nr_groups)
+  }
+
 }
 END_SECTION
 
@@ -882,6 +882,97 @@ START_SECTION(([EXTRA] test first prefix loss))
 }
 END_SECTION
 
+START_SECTION(static void getPrefixSuffixMasses(const AASequence& peptide, PrefixSuffixMasses& masses))
+{
+  TheoreticalSpectrumGenerator::PrefixSuffixMasses masses;
+  TheoreticalSpectrumGenerator::getPrefixSuffixMasses(peptide, masses);
+  TEST_EQUAL(masses.prefix.size(), 7)
+  TEST_EQUAL(masses.suffix.size(), 7)
+  TEST_REAL_SIMILAR(masses.prefix[1], peptide.getPrefix(2).getMonoWeight(Residue::Internal))
+  TEST_REAL_SIMILAR(masses.suffix[2], peptide.getSuffix(3).getMonoWeight(Residue::Internal))
+  TEST_REAL_SIMILAR(masses.prefix[6], masses.suffix[6])
+
+  // terminal modifications are part of the first prefix / suffix
+  AASequence mod_peptide = AASequence::fromString(".(Acetyl)IFSQVGK.(Amidated)");
+  TheoreticalSpectrumGenerator::getPrefixSuffixMasses(mod_peptide, masses);
+  TEST_EQUAL(masses.prefix.size(), 7)
+  TEST_REAL_SIMILAR(masses.prefix[0], mod_peptide[0].getMonoWeight(Residue::Internal) + mod_peptide.getNTerminalModification()->getDiffMonoMass())
+  TEST_REAL_SIMILAR(masses.suffix[0], mod_peptide[6].getMonoWeight(Residue::Internal) + mod_peptide.getCTerminalModification()->getDiffMonoMass())
+
+  TheoreticalSpectrumGenerator::getPrefixSuffixMasses(AASequence(), masses);
+  TEST_EQUAL(masses.prefix.empty(), true)
+}
+END_SECTION
+
+START_SECTION((void getFragmentMZs(const PrefixSuffixMasses& masses, Int min_charge, Int max_charge, FragmentBuffer& buffer) const))
+{
+  // same fragments and annotations as getSpectrum() for all ion types, charges and modifications
+  vector<String> ion_types = {"add_b_ions", "add_y_ions", "add_a_ions", "add_c_ions", "add_x_ions", "add_z_ions", "add_zp1_ions", "add_zp2_ions"};
+  vector<AASequence> peptides = {peptide, AASequence::fromString(".(Acetyl)PEPTM(Oxidation)IDEK.(Amidated)"), AASequence::fromString("SC(Carbamidomethyl)R")};
+
+  TheoreticalSpectrumGenerator::PrefixSuffixMasses masses;
+  TheoreticalSpectrumGenerator::FragmentBuffer buffer;
+  for (const AASequence& seq : peptides)
+  {
+    TheoreticalSpectrumGenerator::getPrefixSuffixMasses(seq, masses);
+    for (Size t = 0; t < ion_types.size(); ++t)
+    {
+      for (const String& first_prefix : {"true", "false"})
+      {
+        TheoreticalSpectrumGenerator t_gen;
+        Param params = t_gen.getParameters();
+        for (Size u = 0; u < ion_types.size(); ++u)
+        {
+          params.setValue(ion_types[u], (u == t || u == (t + 3) % ion_types.size()) ? "true" : "false");
+        }
+        params.setValue("add_first_prefix_ion", first_prefix);
+        params.setValue("add_metainfo", "true");
+        t_gen.setParameters(params);
+
+        PeakSpectrum spec;
+        t_gen.getSpectrum(spec, seq, 1, 3);
+        t_gen.getFragmentMZs(masses, 1, 3, buffer);
+
+        TEST_EQUAL(buffer.mz.size(), spec.size())
+        TEST_EQUAL(buffer.ion.size(), spec.size())
+        ABORT_IF(buffer.mz.size() != spec.size())
+        TEST_EQUAL(std::is_sorted(buffer.mz.begin(), buffer.mz.end()), true)
+        for (Size i = 0; i < spec.size(); ++i)
+        {
+          TEST_REAL_SIMILAR(buffer.mz[i], spec[i].getMZ())
+          // the relative order of coinciding peaks may differ from getSpectrum()
+          if ((i == 0 || spec[i - 1].getMZ() != spec[i].getMZ()) && (i + 1 == spec.size() || spec[i + 1].getMZ() != spec[i].getMZ()))
+          {
+            TEST_EQUAL(TheoreticalSpectrumGenerator::getIonName(buffer.ion[i]), spec.getStringDataArrays()[0][i])
+            TEST_EQUAL(TheoreticalSpectrumGenerator::getIonCharge(buffer.ion[i]), spec.getIntegerDataArrays()[0][i])
+          }
+        }
+      }
+    }
+  }
+
+  // buffer is reused: content is replaced
+  TheoreticalSpectrumGenerator default_gen;
+  default_gen.getFragmentMZs(masses, 1, 1, buffer);
+  TEST_EQUAL(buffer.mz.size(), 3) // b2, y1, y2 of SC(Carbamidomethyl)R
+  TheoreticalSpectrumGenerator::getPrefixSuffixMasses(AASequence::fromString("K"), masses);
+  default_gen.getFragmentMZs(masses, 1, 1, buffer);
+  TEST_EQUAL(buffer.mz.empty(), true)
+  TEST_EQUAL(buffer.ion.empty(), true)
+}
+END_SECTION
+
+START_SECTION(static String getIonName(UInt32 ion))
+{
+  const UInt32 ion = TheoreticalSpectrumGenerator::encodeIon(Residue::YIon, 12, 3);
+  TEST_EQUAL(TheoreticalSpectrumGenerator::getIonType(ion), Residue::YIon)
+  TEST_EQUAL(TheoreticalSpectrumGenerator::getIonOrdinal(ion), 12)
+  TEST_EQUAL(TheoreticalSpectrumGenerator::getIonCharge(ion), 3)
+  TEST_STRING_EQUAL(TheoreticalSpectrumGenerator::getIonName(ion), "y12+++")
+  TEST_STRING_EQUAL(TheoreticalSpectrumGenerator::getIonName(TheoreticalSpectrumGenerator::encodeIon(Residue::Zp1Ion, 2, 1)), "z.2+")
+}
+END_SECTION
+
 delete ptr;
 
 /////////////////////////////////////////////////////////////
@@ -0,0 +1,265 @@
+// Copyright (c) 2002-present, The OpenMS Team -- EKU Tuebingen, ETH Zurich, and FU Berlin
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/TransitionBinaryFile.h>
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
+#include <OpenMS/ANALYSIS/TARGETED/TargetedExperiment.h>
+#include <OpenMS/FORMAT/TraMLFile.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <filesystem>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(TransitionBinaryFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+TransitionBinaryFile* ptr = nullptr;
+TransitionBinaryFile* nullPointer = nullptr;
+
+START_SECTION(TransitionBinaryFile())
+{
+  ptr = new TransitionBinaryFile();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOpen(), false)
+}
+END_SECTION
+
+START_SECTION(~TransitionBinaryFile())
+{
+  delete ptr;
+}
+END_SECTION
+
+// small library: two peptides in two different precursor windows
+OpenSwath::LightTargetedExperiment exp;
+{
+  OpenSwath::LightProtein protein;
+  protein.id = "PROT_1";
+  exp.proteins.push_back(protein);
+
+  OpenSwath::LightCompound pep;
+  pep.id = "PEPTIDE_2";
+  pep.sequence = "PEPTIDE";
+  pep.rt = 44.5;
+  pep.charge = 2;
+  pep.drift_time = 0.9;
+  pep.protein_refs.push_back("PROT_1");
+  pep.modifications.push_back({3, 35});
+  exp.compounds.push_back(pep);
+
+  OpenSwath::LightCompound pep2;
+  pep2.id = "ELVIS_2";
+  pep2.sequence = "ELVIS";
+  pep2.rt = 12.0;
+  pep2.charge = 2;
+  pep2.protein_refs.push_back("PROT_1");
+  exp.compounds.push_back(pep2);
+
+  for (int i = 0; i < 4; ++i)
+  {
+    OpenSwath::LightTransition tr;
+    tr.transition_name = "tr_" + String(i);
+    tr.peptide_ref = (i < 3 ? "PEPTIDE_2" : "ELVIS_2");
+    tr.precursor_mz = (i < 3 ? 500.0 : 300.0);
+    tr.product_mz = 700.0 - 100.0 * i;
+    tr.library_intensity = 10.0 * (i + 1);
+    tr.fragment_charge = 1;
+    tr.decoy = (i == 3);
+    tr.detecting_transition = true;
+    tr.quantifying_transition = (i != 0);
+    tr.identifying_transition = false;
+    exp.transitions.push_back(tr);
+  }
+}
+
+String tmp_file;
+NEW_TMP_FILE(tmp_file)
+
+START_SECTION((static void store(const String& filename, const OpenSwath::LightTargetedExperiment& exp, const String& source_file = "", const String& fingerprint = "")))
+{
+  TransitionBinaryFile::store(tmp_file, exp, OPENMS_GET_TEST_DATA_PATH("ChromatogramExtractor_input.TraML"));
+  TEST_EQUAL(File::exists(tmp_file), true)
+}
+END_SECTION
+
+START_SECTION((static bool isUpToDate(const String& filename, const String& source_file, const String& fingerprint = "")))
+{
+  TEST_EQUAL(TransitionBinaryFile::isUpToDate(tmp_file, OPENMS_GET_TEST_DATA_PATH("ChromatogramExtractor_input.TraML")), true)
+  TEST_EQUAL(TransitionBinaryFile::isUpToDate(tmp_file, OPENMS_GET_TEST_DATA_PATH("ExperimentalDesign_input_1.tsv")), false)
+  TEST_EQUAL(TransitionBinaryFile::isUpToDate(OPENMS_GET_TEST_DATA_PATH("ChromatogramExtractor_input.TraML"), OPENMS_GET_TEST_DATA_PATH("ChromatogramExtractor_input.TraML")), false)
+
+  // the settings used to read the source file are part of the cache key
+  String source_file, cache_file;
+  NEW_TMP_FILE(source_file)
+  NEW_TMP_FILE(cache_file)
+  std::filesystem::copy_file(OPENMS_GET_TEST_DATA_PATH("ChromatogramExtractor_input.TraML"), source_file.c_str(), std::filesystem::copy_options::overwrite_existing);
+  TransitionBinaryFile::store(cache_file, exp, source_file, "type=tsv;retentionTimeInterpretation=iRT;");
+  TEST_EQUAL(TransitionBinaryFile::isUpToDate(cache_file, source_file, "type=tsv;retentionTimeInterpretation=iRT;"), true)
+  TEST_EQUAL(TransitionBinaryFile::isUpToDate(cache_file, source_file, "type=tsv;retentionTimeInterpretation=seconds;"), false)
+  TEST_EQUAL(TransitionBinaryFile::isUpToDate(cache_file, source_file, "type=traml;"), false)
+  TEST_EQUAL(TransitionBinaryFile::isUpToDate(cache_file, source_file), false)
+
+  // a touched source file with unchanged content is still up to date
+  std::filesystem::last_write_time(source_file.c_str(), std::filesystem::last_write_time(source_file.c_str()) + std::chrono::hours(1));
+  TEST_EQUAL(TransitionBinaryFile::isUpToDate(cache_file, source_file, "type=tsv;retentionTimeInterpretation=iRT;"), true)
+}
+END_SECTION
+
+START_SECTION(void open(const String& filename))
+{
+  TransitionBinaryFile f;
+  f.open(tmp_file);
+  TEST_EQUAL(f.isOpen(), true)
+  TEST_EQUAL(f.getNrTransitions(), 4)
+  TEST_EQUAL(f.getNrCompounds(), 2)
+  TEST_EQUAL(f.getNrProteins(), 1)
+
+  TransitionBinaryFile g;
+  TEST_EXCEPTION(Exception::FileNotFound, g.open("this_file_does_not_exist.bin"))
+  TEST_EXCEPTION(Exception::ParseError, g.open(OPENMS_GET_TEST_DATA_PATH("ChromatogramExtractor_input.TraML")))
+  TEST_EQUAL(g.isOpen(), false)
+}
+END_SECTION
+
+START_SECTION(void close())
+{
+  TransitionBinaryFile f;
+  f.open(tmp_file);
+  f.close();
+  TEST_EQUAL(f.isOpen(), false)
+  TEST_EQUAL(f.getNrTransitions(), 0)
+}
+END_SECTION
+
+START_SECTION(void toLightTargetedExperiment(OpenSwath::LightTargetedExperiment& exp) const)
+{
+  TransitionBinaryFile f;
+  f.open(tmp_file);
+  OpenSwath::LightTargetedExperiment loaded;
+  f.toLightTargetedExperiment(loaded);
+
+  TEST_EQUAL(loaded.transitions.size(), exp.transitions.size())
+  for (Size i = 0; i < exp.transitions.size(); ++i)
+  {
+    TEST_EQUAL(loaded.transitions[i].transition_name, exp.transitions[i].transition_name)
+    TEST_EQUAL(loaded.transitions[i].peptide_ref, exp.transitions[i].peptide_ref)
+    TEST_REAL_SIMILAR(loaded.transitions[i].precursor_mz, exp.transitions[i].precursor_mz)
+    TEST_REAL_SIMILAR(loaded.transitions[i].product_mz, exp.transitions[i].product_mz)
+    TEST_REAL_SIMILAR(loaded.transitions[i].library_intensity, exp.transitions[i].library_intensity)
+    TEST_REAL_SIMILAR(loaded.transitions[i].precursor_im, exp.transitions[i].precursor_im)
+    TEST_EQUAL(loaded.transitions[i].fragment_charge, exp.transitions[i].fragment_charge)
+    TEST_EQUAL(loaded.transitions[i].decoy, exp.transitions[i].decoy)
+    TEST_EQUAL(loaded.transitions[i].detecting_transition, exp.transitions[i].detecting_transition)
+    TEST_EQUAL(loaded.transitions[i].quantifying_transition, exp.transitions[i].quantifying_transition)
+    TEST_EQUAL(loaded.transitions[i].identifying_transition, exp.transitions[i].identifying_transition)
+  }
+
+  TEST_EQUAL(loaded.compounds.size(), 2)
+  TEST_EQUAL(loaded.compounds[0].id, "PEPTIDE_2")
+  TEST_EQUAL(loaded.compounds[0].sequence, "PEPTIDE")
+  TEST_REAL_SIMILAR(loaded.compounds[0].rt, 44.5)
+  TEST_REAL_SIMILAR(loaded.compounds[0].drift_time, 0.9)
+  TEST_EQUAL(loaded.compounds[0].charge, 2)
+  TEST_EQUAL(loaded.compounds[0].isPeptide(), true)
+  TEST_EQUAL(loaded.compounds[0].protein_refs.size(), 1)
+  TEST_EQUAL(loaded.compounds[0].protein_refs[0], "PROT_1")
+  TEST_EQUAL(loaded.compounds[0].modifications.size(), 1)
+  TEST_EQUAL(loaded.compounds[0].modifications[0].location, 3)
+  TEST_EQUAL(loaded.compounds[0].modifications[0].unimod_id, 35)
+  TEST_EQUAL(loaded.compounds[1].id, "ELVIS_2")
+  TEST_EQUAL(loaded.compounds[1].modifications.size(), 0)
+
+  TEST_EQUAL(loaded.proteins.size(), 1)
+  TEST_EQUAL(loaded.proteins[0].id, "PROT_1")
+  TEST_EQUAL(loaded.getCompoundByRef("ELVIS_2").sequence, "ELVIS")
+}
+END_SECTION
+
+START_SECTION((void load(const String& filename, OpenSwath::LightTargetedExperiment& exp)))
+{
+  OpenSwath::LightTargetedExperiment loaded;
+  TransitionBinaryFile().load(tmp_file, loaded);
+  TEST_EQUAL(loaded.transitions.size(), 4)
+  TEST_EQUAL(loaded.transitions[3].transition_name, "tr_3")
+}
+END_SECTION
+
+START_SECTION(std::string_view getString(StringIndex index) const)
+{
+  TransitionBinaryFile f;
+  f.open(tmp_file);
+  TEST_EQUAL(f.getString(0).empty(), true)
+  TEST_EQUAL(String(f.getString(f.getCompound(1).sequence)), "ELVIS")
+  TEST_EQUAL(String(f.getString(f.getProtein(0).id)), "PROT_1")
+  // interned: identical strings share one entry
+  TEST_EQUAL(f.getTransition(0).peptide_ref, f.getCompound(0).id)
+  TEST_EQUAL(f.getProteinRef(0), f.getProteinRef(1))
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getPrecursorMZRange(double mz_start, double mz_end) const))
+{
+  TransitionBinaryFile f;
+  f.open(tmp_file);
+  const UInt32* order = f.getPrecursorMZOrder();
+  // sorted by precursor m/z, then product m/z
+  TEST_EQUAL(order[0], 3)
+  TEST_EQUAL(order[1], 2)
+  TEST_EQUAL(order[2], 1)
+  TEST_EQUAL(order[3], 0)
+
+  std::pair<Size, Size> range = f.getPrecursorMZRange(400.0, 525.0);
+  TEST_EQUAL(range.first, 1)
+  TEST_EQUAL(range.second, 4)
+  range = f.getPrecursorMZRange(200.0, 400.0);
+  TEST_EQUAL(range.first, 0)
+  TEST_EQUAL(range.second, 1)
+  range = f.getPrecursorMZRange(600.0, 700.0);
+  TEST_EQUAL(range.first, range.second)
+}
+END_SECTION
+
+START_SECTION([EXTRA] roundtrip of a TraML library)
+{
+  TargetedExperiment targeted_exp;
+  TraMLFile().load(OPENMS_GET_TEST_DATA_PATH("ChromatogramExtractor_input.TraML"), targeted_exp);
+  OpenSwath::LightTargetedExperiment pqp_exp, loaded;
+  OpenSwathDataAccessHelper::convertTargetedExp(targeted_exp, pqp_exp);
+  String tmp_pqp_bin;
+  NEW_TMP_FILE(tmp_pqp_bin)
+  TransitionBinaryFile::store(tmp_pqp_bin, pqp_exp);
+  TransitionBinaryFile().load(tmp_pqp_bin, loaded);
+  TEST_EQUAL(loaded.transitions.size(), pqp_exp.transitions.size())
+  TEST_EQUAL(loaded.compounds.size(), pqp_exp.compounds.size())
+  TEST_EQUAL(loaded.proteins.size(), pqp_exp.proteins.size())
+  for (Size i = 0; i < pqp_exp.transitions.size(); ++i)
+  {
+    TEST_EQUAL(loaded.transitions[i].transition_name, pqp_exp.transitions[i].transition_name)
+    TEST_EQUAL(loaded.transitions[i].peptide_ref, pqp_exp.transitions[i].peptide_ref)
+  }
+  for (Size i = 0; i < pqp_exp.compounds.size(); ++i)
+  {
+    TEST_EQUAL(loaded.compounds[i].sequence, pqp_exp.compounds[i].sequence)
+    TEST_EQUAL(loaded.compounds[i].protein_refs.size(), pqp_exp.compounds[i].protein_refs.size())
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -60,6 +60,75 @@ START_SECTION( void validateTargetedExperiment(OpenMS::TargetedExperiment & targ
 }
 END_SECTION
 
+// small transition list with Windows line endings and no final line break
+String tsv_file;
+NEW_TMP_FILE(tsv_file)
+{
+  std::ofstream os(tsv_file.c_str(), std::ios::binary);
+  os << "PrecursorMz\tProductMz\tNormalizedRetentionTime\tLibraryIntensity\tPeptideSequence\tModifiedPeptideSequence\tPrecursorCharge\tProductCharge\tProteinId\tDecoy\r\n"
+     << "500.5\t600.1\t44.0\t100\tPEPTIDE\tPEPTIDE\t2\t1\tPROT_1;PROT_2\t0\r\n"
+     << "500.5\t700.2\t44.0\t50\tPEPTIDE\tPEPTIDE\t2\t\tPROT_1;PROT_2\t0\r\n"
+     << "300.3\t400.4\t12.0\t10\tELVIS\tELVIS\t3\t2\tPROT_2\tTRUE";
+}
+
+START_SECTION(void convertTSVToTargetedExperiment(const char* filename, FileTypes::Type filetype, OpenSwath::LightTargetedExperiment& targeted_exp))
+{
+  TransitionTSVFile tsv_reader;
+  OpenSwath::LightTargetedExperiment exp;
+  tsv_reader.convertTSVToTargetedExperiment(tsv_file.c_str(), FileTypes::TSV, exp);
+
+  TEST_EQUAL(exp.transitions.size(), 3)
+  // transitions without identifier are named after their line
+  TEST_EQUAL(exp.transitions[0].transition_name, "1")
+  TEST_EQUAL(exp.transitions[2].transition_name, "3")
+  TEST_EQUAL(exp.transitions[0].peptide_ref, "PEPTIDE_2")
+  TEST_EQUAL(exp.transitions[2].peptide_ref, "ELVIS_3")
+  TEST_REAL_SIMILAR(exp.transitions[1].product_mz, 700.2)
+  TEST_REAL_SIMILAR(exp.transitions[1].library_intensity, 50)
+  TEST_EQUAL(exp.transitions[0].fragment_charge, 1)
+  TEST_EQUAL(exp.transitions[1].fragment_charge, 0)
+  TEST_EQUAL(exp.transitions[1].decoy, false)
+  TEST_EQUAL(exp.transitions[2].decoy, true)
+
+  TEST_EQUAL(exp.compounds.size(), 2)
+  TEST_EQUAL(exp.compounds[0].id, "PEPTIDE_2")
+  TEST_EQUAL(exp.compounds[0].sequence, "PEPTIDE")
+  TEST_EQUAL(exp.compounds[0].charge, 2)
+  TEST_EQUAL(exp.compounds[0].protein_refs.size(), 2)
+  TEST_EQUAL(exp.compounds[1].id, "ELVIS_3")
+  TEST_EQUAL(exp.proteins.size(), 2)
+  TEST_EQUAL(exp.proteins[0].id, "PROT_1")
+  TEST_EQUAL(exp.proteins[1].id, "PROT_2")
+
+  // same result as the conversion through the full data structure
+  TargetedExperiment targeted_exp;
+  tsv_reader.convertTSVToTargetedExperiment(tsv_file.c_str(), FileTypes::TSV, targeted_exp);
+  TEST_EQUAL(targeted_exp.getTransitions().size(), exp.transitions.size())
+  TEST_EQUAL(targeted_exp.getPeptides().size(), exp.compounds.size())
+  TEST_EQUAL(targeted_exp.getProteins().size(), exp.proteins.size())
+  for (Size i = 0; i < exp.transitions.size(); ++i)
+  {
+    TEST_EQUAL(targeted_exp.getTransitions()[i].getNativeID(), exp.transitions[i].transition_name)
+    TEST_EQUAL(targeted_exp.getTransitions()[i].getPeptideRef(), exp.transitions[i].peptide_ref)
+  }
+
+  OpenSwath::LightTargetedExperiment exp_missing;
+  TEST_EXCEPTION(Exception::FileNotFound, tsv_reader.convertTSVToTargetedExperiment("this_file_does_not_exist.tsv", FileTypes::TSV, exp_missing))
+
+  String tsv_file_invalid;
+  NEW_TMP_FILE(tsv_file_invalid)
+  {
+    std::ofstream os(tsv_file_invalid.c_str());
+    os << "PrecursorMz\tProductMz\tNormalizedRetentionTime\tLibraryIntensity\tPeptideSequence\tModifiedPeptideSequence\tPrecursorCharge\tProteinId\n"
+       << "500.5\t600.1\t44.0\t100\tPEPTIDE\tPEPTIDE\t2\tPROT_1\n"
+       << "500.5\t700.2\t44.0\t50\tPEPTIDE\tPEPTIDE\t2\n";
+  }
+  OpenSwath::LightTargetedExperiment exp_invalid;
+  TEST_EXCEPTION_WITH_MESSAGE(Exception::IllegalArgument, tsv_reader.convertTSVToTargetedExperiment(tsv_file_invalid.c_str(), FileTypes::TSV, exp_invalid),
+    "Error reading the file on line 2: length of the header and length of the line do not match: 7 != 8")
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
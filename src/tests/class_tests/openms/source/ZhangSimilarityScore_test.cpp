@@ -14,6 +14,7 @@
 #include <iostream>
 
 #include <OpenMS/COMPARISON/ZhangSimilarityScore.h>
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
 #include <OpenMS/FORMAT/DTAFile.h>
 #include <OpenMS/PROCESSING/SCALING/Normalizer.h>
 
@@ -93,6 +94,38 @@ START_SECTION(double operator () (const PeakSpectrum& spec1, const PeakSpectrum&
   TEST_REAL_SIMILAR(score, 0.328749)
 END_SECTION
 
+START_SECTION(void batchCompare(const PeakSpectrum& query, const std::vector<const PeakSpectrum*>& library, std::vector<double>& scores) const)
+{
+  PeakSpectrum s1;
+  DTAFile().load(OPENMS_GET_TEST_DATA_PATH("PILISSequenceDB_DFPIANGER_1.dta"), s1);
+  PeakSpectrum s2(s1);
+  s2.resize(100);
+  std::vector<double> scores;
+  ptr->batchCompare(s1, {&s2}, scores);
+  TEST_EQUAL(scores.size(), 1)
+  TEST_EQUAL(scores[0], (*ptr)(s1, s2))
+}
+END_SECTION
+
+START_SECTION(void batchCompareViews(const PeakSpectrum& query, const std::vector<SpectrumComparisonKernels::PeakArraysView>& library, std::vector<double>& scores) const)
+{
+  PeakSpectrum s1;
+  DTAFile().load(OPENMS_GET_TEST_DATA_PATH("PILISSequenceDB_DFPIANGER_1.dta"), s1);
+  PeakSpectrum s2(s1);
+  s2.resize(100);
+  // library spectrum as separate m/z and intensity arrays
+  SpectrumComparisonKernels::PeakArrays peaks(s2);
+  SpectrumComparisonKernels::PeakArraysView view;
+  view.mz = peaks.mz.data();
+  view.intensity = peaks.intensity.data();
+  view.nr_peaks = peaks.size();
+  std::vector<double> scores;
+  ptr->batchCompareViews(s1, {view}, scores);
+  TEST_EQUAL(scores.size(), 1)
+  TEST_EQUAL(scores[0], (*ptr)(s1, s2))
+}
+END_SECTION
+
 delete ptr;
 
 /////////////////////////////////////////////////////////////
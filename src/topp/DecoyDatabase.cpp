@@ -352,122 +352,165 @@ protected:
     MRMDecoy m;
     m.setParameters(decoy_param);
 
-    Math::RandomShuffler shuffler(seed);
-    for (const auto& file_fasta : in)
+    // creates the decoy of a single entry; only depends on the entry itself (and the seed), so entries can be processed in parallel
+    auto createDecoy = [&](const FASTAFile::FASTAEntry& target) -> FASTAFile::FASTAEntry
     {
-      /// in neighbor-peptide mode: write relevant peptides to the output file
-      const bool write_relevant = neighbor_mode && file_fasta == in_relevant_proteins;
+      FASTAFile::FASTAEntry entry = target;
 
-      f.readStart(file_fasta);
-      FASTAFile::FASTAEntry entry;
-      OpenMS::TargetedExperiment::Peptide p;
+      // new decoy identifier
+      entry.identifier = getDecoyIdentifier_(entry.identifier, decoy_string, decoy_string_position_prefix);
 
-      //-------------------------------------------------------------
-      // calculations
-      //-------------------------------------------------------------
-      while (f.readNext(entry))
+      // new decoy sequence
+      if (input_type == SeqType::RNA)
       {
-        if (identifiers.find(entry.identifier) != identifiers.end())
+        string quick_seq = entry.sequence;
+        bool five_p = (entry.sequence.front() == 'p');
+        bool three_p = (entry.sequence.back() == 'p');
+        if (five_p) // we don't want to reverse terminal phosphates
         {
-          OPENMS_LOG_WARN << "DecoyDatabase: Warning, identifier '" << entry.identifier << "' occurs more than once!" << endl;
+          quick_seq.erase(0, 1);
         }
-        identifiers.insert(entry.identifier);
+        if (three_p) { quick_seq.pop_back(); }
 
-        if (append)
+        vector<String> tokenized;
+        std::smatch m;
+        std::string pattern = R"([^\[]|(\[[^\[\]]*\]))";
+        std::regex re(pattern);
+
+        while (std::regex_search(quick_seq, m, re))
         {
-          f.writeNext(entry);
-          if (write_relevant)
-          {
-            fasta_out_relevant.writeNext(entry);
-          }
+          tokenized.emplace_back(m.str(0));
+          quick_seq = m.suffix();
         }
 
-        // new decoy identifier
-        entry.identifier = getDecoyIdentifier_(entry.identifier, decoy_string, decoy_string_position_prefix);
-
-        // new decoy sequence
-        if (input_type == SeqType::RNA)
+        if (shuffle)
+        {
+          Math::RandomShuffler shuffler(seed); // identical sequences are shuffled the same way
+          shuffler.portable_random_shuffle(tokenized.begin(), tokenized.end());
+        }
+        else // reverse
+        {
+          reverse(tokenized.begin(), tokenized.end()); // reverse the tokens
+        }
+        if (five_p) // add back 5'
         {
-          string quick_seq = entry.sequence;
-          bool five_p = (entry.sequence.front() == 'p');
-          bool three_p = (entry.sequence.back() == 'p');
-          if (five_p) // we don't want to reverse terminal phosphates
+          tokenized.insert(tokenized.begin(), String("p"));
+        }
+        if (three_p) // add back 3'
+        {
+          tokenized.emplace_back("p");
+        }
+        entry.sequence = ListUtils::concatenate(tokenized, "");
+      }
+      else // protein input
+      {
+        // if (terminal_aminos != "none")
+        if (enzyme != "no cleavage" && (keepN || keepC))
+        {
+          std::vector<AASequence> peptides;
+          digestion.digest(AASequence::fromString(entry.sequence), peptides);
+          OpenMS::TargetedExperiment::Peptide p;
+          String new_sequence = "";
+          for (auto const& peptide : peptides)
           {
-            quick_seq.erase(0, 1);
+            p.sequence = peptide.toString();
+            // TODO why are the functions from TargetedExperiment and MRMDecoy not anywhere more general?
+            //  No soul would look there.
+            auto decoy_p = shuffle ? m.shufflePeptide(p, identity_threshold, seed, max_attempts) 
+                                   : MRMDecoy::reversePeptide(p, keepN, keepC, keep_const_pattern);
+            new_sequence += decoy_p.sequence;
           }
-          if (three_p) { quick_seq.pop_back(); }
-
-          vector<String> tokenized;
-          std::smatch m;
-          std::string pattern = R"([^\[]|(\[[^\[\]]*\]))";
-          std::regex re(pattern);
-
-          while (std::regex_search(quick_seq, m, re))
+          entry.sequence = new_sequence;
+        }
+        else // no cleavage
+        {
+          // sequence
+          if (shuffle)
           {
-            tokenized.emplace_back(m.str(0));
-            quick_seq = m.suffix();
+            Math::RandomShuffler shuffler(seed); // identical proteins are shuffled the same way
+            shuffler.portable_random_shuffle(entry.sequence.begin(), entry.sequence.end());
           }
-
-          if (shuffle) { shuffler.portable_random_shuffle(tokenized.begin(), tokenized.end()); }
           else // reverse
           {
-            reverse(tokenized.begin(), tokenized.end()); // reverse the tokens
+            entry.sequence.reverse();
           }
-          if (five_p) // add back 5'
+        }
+      } // protein entry
+      return entry;
+    };
+
+    // proteins are read chunk-wise (the next chunk is read in the background);
+    // decoys of a chunk are created in parallel and written in input order
+    const int PROTEIN_CACHE_SIZE = 10000;
+    for (const auto& file_fasta : in)
+    {
+      /// in neighbor-peptide mode: write relevant peptides to the output file
+      const bool write_relevant = neighbor_mode && file_fasta == in_relevant_proteins;
+
+      FASTAContainer<TFI_File> proteins(file_fasta);
+      proteins.prefetchChunk(PROTEIN_CACHE_SIZE);
+      vector<FASTAFile::FASTAEntry> decoys;
+
+      //-------------------------------------------------------------
+      // calculations
+      //-------------------------------------------------------------
+      while (proteins.activateCache())
+      {
+        proteins.prefetchChunk(PROTEIN_CACHE_SIZE);
+        const SignedSize chunk_size = (SignedSize)proteins.chunkSize();
+        decoys.resize(chunk_size);
+
+        // the first error (in input order) is rethrown below
+        vector<std::exception_ptr> errors(chunk_size);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+        for (SignedSize i = 0; i < chunk_size; ++i)
+        {
+          try
           {
-            tokenized.insert(tokenized.begin(), String("p"));
+            decoys[i] = createDecoy(proteins.chunkAt(i));
           }
-          if (three_p) // add back 3'
+          catch (...)
           {
-            tokenized.emplace_back("p");
+            errors[i] = std::current_exception();
           }
-          entry.sequence = ListUtils::concatenate(tokenized, "");
         }
-        else // protein input
+
+        //-------------------------------------------------------------
+        // writing output
+        //-------------------------------------------------------------
+        for (SignedSize i = 0; i < chunk_size; ++i)
         {
-          // if (terminal_aminos != "none")
-          if (enzyme != "no cleavage" && (keepN || keepC))
+          const FASTAFile::FASTAEntry& entry = proteins.chunkAt(i);
+          if (identifiers.find(entry.identifier) != identifiers.end())
           {
-            std::vector<AASequence> peptides;
-            digestion.digest(AASequence::fromString(entry.sequence), peptides);
-            String new_sequence = "";
-            for (auto const& peptide : peptides)
-            {
-              p.sequence = peptide.toString();
-              // TODO why are the functions from TargetedExperiment and MRMDecoy not anywhere more general?
-              //  No soul would look there.
-              auto decoy_p = shuffle ? m.shufflePeptide(p, identity_threshold, seed, max_attempts) 
-                                     : MRMDecoy::reversePeptide(p, keepN, keepC, keep_const_pattern);
-              new_sequence += decoy_p.sequence;
-            }
-            entry.sequence = new_sequence;
+            OPENMS_LOG_WARN << "DecoyDatabase: Warning, identifier '" << entry.identifier << "' occurs more than once!" << endl;
+          }
+          identifiers.insert(entry.identifier);
+
+          if (errors[i])
+          {
+            std::rethrow_exception(errors[i]);
           }
-          else // no cleavage
+
+          if (append)
           {
-            // sequence
-            if (shuffle)
-            {
-              shuffler.seed(seed); // identical proteins are shuffled the same way -> re-seed
-              shuffler.portable_random_shuffle(entry.sequence.begin(), entry.sequence.end());
-            }
-            else // reverse
+            f.writeNext(entry);
+            if (write_relevant)
             {
-              entry.sequence.reverse();
+              fasta_out_relevant.writeNext(entry);
             }
           }
-        } // protein entry
 
-        //-------------------------------------------------------------
-        // writing output
-        //-------------------------------------------------------------
-        f.writeNext(entry);
-        // optional: if in neighbor mode: T+D of relevant peptides (if requested)
-        if (write_relevant)
-        {
-          fasta_out_relevant.writeNext(entry);
-        }
-
-      } // next protein
+          f.writeNext(decoys[i]);
+          // optional: if in neighbor mode: T+D of relevant peptides (if requested)
+          if (write_relevant)
+          {
+            fasta_out_relevant.writeNext(decoys[i]);
+          }
+        } // next protein
+      }
     }   // input files
     
     return EXECUTION_OK;
@@ -17,6 +17,9 @@
 #include <OpenMS/FORMAT/FLASHDeconvSpectrumFile.h>
 #include <OpenMS/FORMAT/FileTypes.h>
 #include <OpenMS/FORMAT/FileHandler.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataTransformingConsumer.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataWritingConsumer.h>
 #include <OpenMS/METADATA/SpectrumLookup.h>
 
 #ifdef _OPENMP
@@ -25,6 +28,11 @@
 
 #include <QFileInfo>
 
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <memory>
+
 using namespace OpenMS;
 using namespace std;
 
@@ -170,6 +178,15 @@ protected:
     setMinInt_("report_FDR", 0);
     setMaxInt_("report_FDR", 1);
 
+    registerIntOption_("streaming", "<1:true 0:false>", 0,
+                       "If set to 1, the input is read block by block (in two passes) and deconvolved spectra are written as soon as they are available. "
+                       "Mass features are traced over a sliding RT window. Reduces the memory use for large datasets. "
+                       "Mass features at the borders of the tracing window may differ slightly. Cannot be combined with -report_FDR 1 (qvalues require all spectra) "
+                       "or -merging_method (merging requires all spectra).",
+                       false, true);
+    setMinInt_("streaming", 0);
+    setMaxInt_("streaming", 1);
+
     registerIntOption_("use_RNA_averagine", "", 0, "If set to 1, RNA averagine model is used", false, true);
     setMinInt_("use_RNA_averagine", 0);
     setMaxInt_("use_RNA_averagine", 1);
@@ -220,60 +237,155 @@ protected:
   {
     for (auto& it : map)
     {
-      double threshold;
-      if (it.getType(false) == SpectrumSettings::CENTROID)
+      if (!filterLowPeaks(it, count))
+      {
+        return;
+      }
+    }
+  }
+
+  /// removes the low intensity peaks of a single spectrum; returns false if the following spectra are not to be filtered (a centroided spectrum with few peaks was found)
+  static bool filterLowPeaks(MSSpectrum& it, Size count)
+  {
+    double threshold;
+    if (it.getType(false) == SpectrumSettings::CENTROID)
+    {
+      if (it.size() <= count)
       {
-        if (it.size() <= count)
+        return false;
+      }
+      it.sortByIntensity(true);
+      threshold = it[count].getIntensity();
+    }
+    else
+    {
+      if (it.size() <= count)
+      {
+        return true;
+      }
+
+      it.sortByIntensity(true);
+      double max_intensity = log10(it[0].getIntensity());
+      double min_intensity = 0;
+      for (auto& p : it)
+      {
+        if (p.getIntensity() <= 0)
         {
-          return;
+          break;
         }
-        it.sortByIntensity(true);
-        threshold = it[count].getIntensity();
+        min_intensity = log10(p.getIntensity());
       }
-      else
+      Size bin_size = 500;
+      std::vector<int> freq(bin_size + 1, 0);
+      for (auto& p : it)
       {
-        if (it.size() <= count)
+        if (p.getIntensity() <= 0)
         {
-          continue;
+          break;
         }
+        Size bin = round((log10(p.getIntensity()) - min_intensity) / (max_intensity - min_intensity) * bin_size);
+        freq[bin]++;
+      }
 
-        it.sortByIntensity(true);
-        double max_intensity = log10(it[0].getIntensity());
-        double min_intensity = 0;
-        for (auto& p : it)
-        {
-          if (p.getIntensity() <= 0)
-          {
-            break;
-          }
-          min_intensity = log10(p.getIntensity());
-        }
-        Size bin_size = 500;
-        std::vector<int> freq(bin_size + 1, 0);
-        for (auto& p : it)
+      int mod_bin = std::distance(freq.begin(), std::max_element(freq.begin(), freq.end())); // most frequent intensity is the threshold to distinguish between signal and noise
+
+      threshold =
+        3.0 * (pow(10.0, (double)mod_bin / bin_size * (max_intensity - min_intensity) +
+                           min_intensity)); // multiply by 3 to the most frequent intensity to make sure more signal component remains. Later this could be determined to use signal-to-noise ratio.
+    }
+    // pop back the low intensity peaks using threshold
+    while (it.size() > 0 && it[it.size() - 1].getIntensity() <= threshold)
+    {
+      it.pop_back();
+    }
+
+    it.sortByPosition();
+    return true;
+  }
+
+  /// the FLASHDeconvAlgorithm instances used by one thread. The dummy instances refer to the deconvolved spectrum of fd, so a worker must not be copied once set up.
+  struct DeconvolutionWorker
+  {
+    FLASHDeconvAlgorithm fd;
+    FLASHDeconvAlgorithm fd_charge_dummy, fd_noise_dummy, fd_iso_dummy;
+  };
+
+  /// a spectrum scheduled for deconvolution, and its results
+  struct SpectrumTask
+  {
+    Size index = 0;                                       ///< index of the spectrum in the input map
+    int scan_number = 0;
+    uint ms_level = 0;
+    std::vector<const DeconvolvedSpectrum*> survey_scans; ///< the preceding deconvolved MSn-1 spectra (for MSn spectra)
+    DeconvolvedSpectrum deconvolved_spectrum;
+    DeconvolvedSpectrum dummy_deconvolved_spectrum;
+  };
+
+  /// deconvolve the spectrum of @p task with the instances of @p worker and store the results in @p task
+  static void deconvolveSpectrum_(DeconvolutionWorker& worker, const MSSpectrum& spec, SpectrumTask& task, bool report_dummy, int target_precursor_charge,
+                                  const std::map<int, std::vector<std::vector<float>>>& precursor_map_for_real_time_acquisition)
+  {
+    std::vector<DeconvolvedSpectrum> precursor_specs;
+    precursor_specs.reserve(task.survey_scans.size());
+    for (const auto* survey_scan : task.survey_scans)
+    {
+      precursor_specs.push_back(*survey_scan);
+    }
+
+    worker.fd.performSpectrumDeconvolution(spec, precursor_specs, task.scan_number, precursor_map_for_real_time_acquisition);
+    auto& deconvolved_spectrum = worker.fd.getDeconvolvedSpectrum();
+    if (deconvolved_spectrum.empty())
+    {
+      return;
+    }
+
+    if (task.ms_level > 1 && target_precursor_charge != 0)
+    {
+      auto precursor = spec.getPrecursors()[0];
+      double target_precursor_mass = (precursor.getMZ() - FLASHDeconvHelperStructs::getChargeMass(target_precursor_charge > 0)) * std::abs(target_precursor_charge);
+      PeakGroup precursorPeakGroup(1, std::abs(target_precursor_charge), target_precursor_charge > 0);
+      precursorPeakGroup.push_back(FLASHDeconvHelperStructs::LogMzPeak());
+      precursorPeakGroup.setMonoisotopicMass(target_precursor_mass);
+      precursorPeakGroup.setSNR(1.0);
+
+      precursorPeakGroup.setChargeSNR(std::abs(target_precursor_charge), 1.0);
+      precursorPeakGroup.Qscore(1.0);
+      deconvolved_spectrum.setPrecursor(precursor);
+      deconvolved_spectrum.setPrecursorPeakGroup(precursorPeakGroup);
+    }
+
+    if (report_dummy)
+    {
+      // the dummy runs refer to the deconvolved spectrum of worker.fd
+      worker.fd_charge_dummy.performSpectrumDeconvolution(spec, precursor_specs, task.scan_number, precursor_map_for_real_time_acquisition);
+      worker.fd_noise_dummy.performSpectrumDeconvolution(spec, precursor_specs, task.scan_number, precursor_map_for_real_time_acquisition);
+      worker.fd_iso_dummy.performSpectrumDeconvolution(spec, precursor_specs, task.scan_number, precursor_map_for_real_time_acquisition);
+
+      DeconvolvedSpectrum dummy_deconvolved_spectrum(task.scan_number);
+      deconvolved_spectrum.sortByQscore();
+      float qscore_threshold_for_dummy = deconvolved_spectrum[deconvolved_spectrum.size() - 1].getQscore();
+      dummy_deconvolved_spectrum.setOriginalSpectrum(spec);
+      dummy_deconvolved_spectrum.reserve(worker.fd_iso_dummy.getDeconvolvedSpectrum().size() + worker.fd_charge_dummy.getDeconvolvedSpectrum().size() +
+                                         worker.fd_noise_dummy.getDeconvolvedSpectrum().size());
+
+      for (auto* dummy_fd : {&worker.fd_charge_dummy, &worker.fd_iso_dummy, &worker.fd_noise_dummy})
+      {
+        for (auto& pg : dummy_fd->getDeconvolvedSpectrum())
         {
-          if (p.getIntensity() <= 0)
+          if (pg.getQscore() < qscore_threshold_for_dummy)
           {
-            break;
+            continue;
           }
-          Size bin = round((log10(p.getIntensity()) - min_intensity) / (max_intensity - min_intensity) * bin_size);
-          freq[bin]++;
+          dummy_deconvolved_spectrum.push_back(pg);
         }
-
-        int mod_bin = std::distance(freq.begin(), std::max_element(freq.begin(), freq.end())); // most frequent intensity is the threshold to distinguish between signal and noise
-
-        threshold =
-          3.0 * (pow(10.0, (double)mod_bin / bin_size * (max_intensity - min_intensity) +
-                             min_intensity)); // multiply by 3 to the most frequent intensity to make sure more signal component remains. Later this could be determined to use signal-to-noise ratio.
-      }
-      // pop back the low intensity peaks using threshold
-      while (it.size() > 0 && it[it.size() - 1].getIntensity() <= threshold)
-      {
-        it.pop_back();
       }
 
-      it.sortByPosition();
+      deconvolved_spectrum.sort();
+      dummy_deconvolved_spectrum.sort();
+      task.dummy_deconvolved_spectrum = std::move(dummy_deconvolved_spectrum);
     }
+    // the state of worker.fd is reset by its next performSpectrumDeconvolution() call
+    task.deconvolved_spectrum = std::move(deconvolved_spectrum);
   }
 
   // the main_ function is called after all parameters are read
@@ -302,6 +414,7 @@ protected:
     bool write_detail = getIntOption_("write_detail") > 0;
     int mzml_charge = getIntOption_("mzml_mass_charge");
     bool report_dummy = getIntOption_("report_FDR") == 1;
+    bool streaming = getIntOption_("streaming") == 1;
     double min_mz = getDoubleOption_("Algorithm:min_mz");
     double max_mz = getDoubleOption_("Algorithm:max_mz");
     double min_rt = getDoubleOption_("Algorithm:min_rt");
@@ -309,7 +422,17 @@ protected:
     double min_intensity = getDoubleOption_("Algorithm:min_intensity");
     int target_precursor_charge = getIntOption_("target_precursor_charge");
     double target_precursor_mz = target_precursor_charge != 0 ? getDoubleOption_("target_precursor_mz") : .0;
-    double target_precursor_mass = .0;
+
+    if (streaming && report_dummy)
+    {
+      writeLogError_("Error: -streaming 1 cannot be combined with -report_FDR 1. Aborting!");
+      return ILLEGAL_PARAMETERS;
+    }
+    if (streaming && merge != 0)
+    {
+      writeLogError_("Error: -streaming 1 cannot be combined with -merging_method. Aborting!");
+      return ILLEGAL_PARAMETERS;
+    }
 
     fstream out_stream, out_promex_stream;
     std::vector<fstream> out_spec_streams, out_topfd_streams, out_topfd_feature_streams;
@@ -362,7 +485,8 @@ protected:
     // reading input
     //-------------------------------------------------------------
 
-    MSExperiment map;
+    MSExperiment map; // all input spectra (stays empty in streaming mode, where the spectra are read block by block)
+    ExperimentalSettings input_settings;
     FileHandler mzml;
 
     double expected_identification_count = .0;
@@ -386,7 +510,6 @@ protected:
       opt.setIntensityRange(DRange<1> {min_intensity, 1e200});
     }
     mzml.setOptions(opt);
-    mzml.loadExperiment(in_file, map, {FileTypes::MZML}, log_type_);
 
     uint current_max_ms_level = 0;
     uint current_min_ms_level = 1000;
@@ -401,10 +524,12 @@ protected:
     std::map<int, double> scan_rt_map;
     std::map<int, PeakGroup> precursor_peak_groups; // MS2 scan number, peak group
 
-    // read input dataset once to count spectra
     double gradient_rt = .0;
-    for (auto& it : map)
-    {
+    Size nr_spectra = 0;
+
+    // adjusts MS level and precursor of an input spectrum as requested and updates the MS level range and the gradient length;
+    // returns false if the precursor of an MSn spectrum is needed but unknown. Calling it twice for a spectrum has no further effect.
+    auto prepare_spectrum = [&](MSSpectrum& it) {
       gradient_rt = std::max(gradient_rt, it.getRT());
       // if forced_ms_level > 0, force MS level of all spectra to 1.
       if (forced_ms_level > 0)
@@ -414,12 +539,12 @@ protected:
 
       if (it.empty())
       {
-        continue;
+        return true;
       }
 
       if (it.getMSLevel() > max_ms_level)
       {
-        continue;
+        return true;
       }
 
       uint ms_level = it.getMSLevel();
@@ -433,7 +558,7 @@ protected:
           if (target_precursor_mz == 0)
           {
             OPENMS_LOG_INFO << "Target precursor charge is set but no precursor is found in MS2 spectra. Specify target precursor m/z with -target_precursor_mz option" << std::endl;
-            return EXTERNAL_PROGRAM_ERROR;
+            return false;
           }
           else
           {
@@ -452,14 +577,51 @@ protected:
           }
         }
       }
-
-      if (min_rt > 0 && it.getRT() < min_rt)
+      return true;
+    };
+
+    // in streaming mode, the input is read twice: once to determine the MS levels and once to deconvolve the spectra
+    MzMLFile mzml_stream;
+    mzml_stream.setOptions(opt);
+    mzml_stream.setLogType(log_type_);
+    if (streaming)
+    {
+      bool precursor_missing = false;
+      bool after_max_rt = false; // as in the non-streaming survey, spectra after the first one beyond max_rt are not considered
+      MSDataTransformingConsumer input_survey;
+      input_survey.setExperimentalSettingsFunc([&](const ExperimentalSettings& settings) { input_settings = settings; });
+      input_survey.setSpectraProcessingFunc([&](MSSpectrum& spec) {
+        ++nr_spectra;
+        if (after_max_rt || precursor_missing)
+        {
+          return;
+        }
+        precursor_missing = !prepare_spectrum(spec);
+        after_max_rt = max_rt > 0 && spec.getRT() > max_rt;
+      });
+      mzml_stream.transform(in_file, &input_survey, true);
+      if (precursor_missing)
       {
-        continue;
+        return EXTERNAL_PROGRAM_ERROR;
       }
-      if (max_rt > 0 && it.getRT() > max_rt)
+    }
+    else
+    {
+      mzml.loadExperiment(in_file, map, {FileTypes::MZML}, log_type_);
+      input_settings = map;
+      nr_spectra = map.size();
+
+      // read input dataset once to count spectra
+      for (auto& it : map)
       {
-        break;
+        if (!prepare_spectrum(it))
+        {
+          return EXTERNAL_PROGRAM_ERROR;
+        }
+        if (max_rt > 0 && it.getRT() > max_rt)
+        {
+          break;
+        }
       }
     }
     // Max MS Level is adjusted according to the input dataset
@@ -472,15 +634,36 @@ protected:
       num_last_deconvolved_spectra = 50; // if FLASHIda log file exists, keep up to 50 survey scans.
     }
 
-    auto last_deconvolved_spectra = std::unordered_map<UInt, std::vector<DeconvolvedSpectrum>>();
-    MSExperiment exp(map), exp_annotated(map);
-    exp.clear(false);
-    exp_annotated.clear(false);
+    // per MS level, the last num_last_deconvolved_spectra deconvolved spectra (the survey scans of the following MSn+1 spectra)
+    auto last_deconvolved_spectra = std::vector<std::deque<DeconvolvedSpectrum>>(current_max_ms_level + 1);
+    // the deconvolved and annotated spectra, collected for the whole run unless they are written as they are produced (streaming mode)
+    MSExperiment exp, exp_annotated;
+    std::unique_ptr<PlainMSDataWritingConsumer> exp_writer, exp_annotated_writer;
+    if (streaming)
+    {
+      // the number of written spectra is not known in advance, the spectrum count in the files is an upper bound
+      if (!out_mzml_file.empty())
+      {
+        exp_writer = std::make_unique<PlainMSDataWritingConsumer>(out_mzml_file);
+        exp_writer->setExperimentalSettings(input_settings);
+        exp_writer->setExpectedSize(nr_spectra, 0);
+      }
+      if (!out_anno_mzml_file.empty())
+      {
+        exp_annotated_writer = std::make_unique<PlainMSDataWritingConsumer>(out_anno_mzml_file);
+        exp_annotated_writer->setExperimentalSettings(input_settings);
+        exp_annotated_writer->setExpectedSize(nr_spectra, 0);
+      }
+    }
+    else
+    {
+      exp = map;
+      exp.clear(false);
+      exp_annotated = exp;
+    }
 
     auto fd = FLASHDeconvAlgorithm();
 
-    FLASHDeconvAlgorithm fd_charge_dummy, fd_noise_dummy, fd_iso_dummy;
-
     Param fd_param = getParam_().copy("Algorithm:", true);
     DoubleList tols = fd_param.getValue("tol");
 
@@ -541,19 +724,29 @@ protected:
     fd.calculateAveragine(use_RNA_averagine);
     auto avg = fd.getAveragine();
 
-    if (report_dummy)
+    // one set of FLASHDeconvAlgorithm instances per thread (the instances keep the state of the spectrum being deconvolved)
+    int nr_threads = 1;
+#ifdef _OPENMP
+    nr_threads = omp_get_max_threads();
+#endif
+    std::vector<DeconvolutionWorker> workers(nr_threads);
+    for (auto& worker : workers)
     {
-      fd_charge_dummy.setParameters(fd_param);
-      fd_charge_dummy.setAveragine(avg);
-      fd_charge_dummy.setTargetDummyType(PeakGroup::TargetDummyType::charge_dummy, fd.getDeconvolvedSpectrum()); // charge
+      worker.fd = fd;
+      if (report_dummy)
+      {
+        worker.fd_charge_dummy.setParameters(fd_param);
+        worker.fd_charge_dummy.setAveragine(avg);
+        worker.fd_charge_dummy.setTargetDummyType(PeakGroup::TargetDummyType::charge_dummy, worker.fd.getDeconvolvedSpectrum()); // charge
 
-      fd_noise_dummy.setParameters(fd_param);
-      fd_noise_dummy.setAveragine(avg);
-      fd_noise_dummy.setTargetDummyType(PeakGroup::TargetDummyType::noise_dummy, fd.getDeconvolvedSpectrum()); // noise
+        worker.fd_noise_dummy.setParameters(fd_param);
+        worker.fd_noise_dummy.setAveragine(avg);
+        worker.fd_noise_dummy.setTargetDummyType(PeakGroup::TargetDummyType::noise_dummy, worker.fd.getDeconvolvedSpectrum()); // noise
 
-      fd_iso_dummy.setParameters(fd_param);
-      fd_iso_dummy.setAveragine(avg);
-      fd_iso_dummy.setTargetDummyType(PeakGroup::TargetDummyType::isotope_dummy, fd.getDeconvolvedSpectrum()); // isotope
+        worker.fd_iso_dummy.setParameters(fd_param);
+        worker.fd_iso_dummy.setAveragine(avg);
+        worker.fd_iso_dummy.setTargetDummyType(PeakGroup::TargetDummyType::isotope_dummy, worker.fd.getDeconvolvedSpectrum()); // isotope
+      }
     }
 
     auto mass_tracer = MassFeatureTrace();
@@ -578,106 +771,189 @@ protected:
 
     ProgressLogger progresslogger;
     progresslogger.setLogType(log_type_);
-    progresslogger.startProgress(0, (SignedSize)map.size(), "running FLASHDeconv");
+    progresslogger.startProgress(0, (SignedSize)nr_spectra, "running FLASHDeconv");
 
-    std::vector<DeconvolvedSpectrum> deconvolved_spectra;
-    deconvolved_spectra.reserve(map.size());
+    // in streaming mode, deconvolved spectra are written per block and mass features are collected as their traces are closed
+    std::vector<FLASHDeconvHelperStructs::MassFeature> mass_features;
+    auto write_deconvolved_spectrum = [&](DeconvolvedSpectrum& deconvolved_spectrum) {
+      uint ms_level = deconvolved_spectrum.getOriginalSpectrum().getMSLevel();
+      if (ms_level == 1)
+      {
+        mass_tracer.storeInformationFromDeconvolvedSpectrum(deconvolved_spectrum); // add deconvolved mass in mass_tracer
+      }
+      if (out_spec_streams.size() + 1 > ms_level)
+      {
+        FLASHDeconvSpectrumFile::writeDeconvolvedMasses(deconvolved_spectrum, deconvolved_spectrum, out_spec_streams[ms_level - 1], in_file, avg, tols[ms_level - 1], write_detail, report_dummy);
+      }
+      if (out_topfd_streams.size() + 1 > ms_level)
+      {
+        FLASHDeconvSpectrumFile::writeTopFD(deconvolved_spectrum, out_topfd_streams[ms_level - 1], topFD_SNR_threshold, current_min_ms_level, false,
+                                            false); //, 1, (float)rand() / (float)RAND_MAX * 10 + 10);
+      }
+    };
 
+    std::vector<DeconvolvedSpectrum> deconvolved_spectra;
     std::vector<DeconvolvedSpectrum> dummy_deconvolved_spectra;
-    dummy_deconvolved_spectra.reserve(map.size() * 3); // there are 3 different kinds of dummy spectra. And we reserve for them.
-
-    for (auto it = map.begin(); it != map.end(); ++it)
+    if (!streaming)
     {
-      int scan_number = map.getSourceFiles().empty() ? -1 : SpectrumLookup::extractScanNumber(it->getNativeID(), map.getSourceFiles()[0].getNativeIDTypeAccession());
+      deconvolved_spectra.reserve(map.size());
+      dummy_deconvolved_spectra.reserve(map.size() * 3); // there are 3 different kinds of dummy spectra. And we reserve for them.
+    }
 
-      if (scan_number < 0)
-      {
-        scan_number = (int)std::distance(map.begin(), it) + 1;
-      }
+    // The spectra are deconvolved block by block. Within a block, the spectra are deconvolved in parallel one MS level after the other:
+    // an MSn spectrum only depends on the deconvolved MSn-1 spectra preceding it, which are complete once their MS level is done.
+    // The results are then processed in input order, thus the output does not depend on the number of threads.
+    const Size block_size = 64 * (Size)nr_threads;
+    std::vector<SpectrumTask> tasks;
+    tasks.reserve(block_size);
 
-      progresslogger.nextProgress();
+    // deconvolves the input spectra first_index, ..., first_index + count - 1 (stored at spectra) and processes the results;
+    // returns false if the precursor of an MSn spectrum is needed but unknown
+    auto process_block = [&](MSSpectrum* spectra, Size count, Size first_index) {
+      Size block_end = first_index + count;
+      tasks.clear();
 
-      if (it->empty())
+      for (Size index = first_index; index < block_end; ++index)
       {
-        continue;
-      }
+        const auto& spec = spectra[index - first_index];
+        int scan_number = input_settings.getSourceFiles().empty() ? -1 : SpectrumLookup::extractScanNumber(spec.getNativeID(), input_settings.getSourceFiles()[0].getNativeIDTypeAccession());
 
-      uint ms_level = it->getMSLevel();
-      if (ms_level > current_max_ms_level)
-      {
-        continue;
-      }
+        if (scan_number < 0)
+        {
+          scan_number = (int)index + 1;
+        }
 
-      if (ms_level > 1 && target_precursor_charge != 0 && it->getPrecursors().size() == 0)
-      {
-        OPENMS_LOG_INFO << "Target precursor charge is set but no precursor m/z is found in MS2 spectra. Specify target precursor m/z with -target_precursor_mz option" << std::endl;
-        return EXTERNAL_PROGRAM_ERROR;
-      }
+        if (spec.empty())
+        {
+          continue;
+        }
 
-      spec_cntr[ms_level - 1]++;
-      auto deconv_begin = clock();
-      auto deconv_t_start = chrono::high_resolution_clock::now();
+        uint ms_level = spec.getMSLevel();
+        if (ms_level > current_max_ms_level)
+        {
+          continue;
+        }
 
-      // for MS>1 spectrum, register precursor
-      std::vector<DeconvolvedSpectrum> precursor_specs;
+        if (ms_level > 1 && target_precursor_charge != 0 && spec.getPrecursors().size() == 0)
+        {
+          OPENMS_LOG_INFO << "Target precursor charge is set but no precursor m/z is found in MS2 spectra. Specify target precursor m/z with -target_precursor_mz option" << std::endl;
+          return false;
+        }
 
-      if (ms_level > 1 && last_deconvolved_spectra.find(ms_level - 1) != last_deconvolved_spectra.end())
-      {
-        precursor_specs = (last_deconvolved_spectra[ms_level - 1]);
+        spec_cntr[ms_level - 1]++;
+        tasks.emplace_back();
+        tasks.back().index = index;
+        tasks.back().scan_number = scan_number;
+        tasks.back().ms_level = ms_level;
       }
 
-      fd.performSpectrumDeconvolution(*it, precursor_specs, scan_number, precursor_map_for_real_time_acquisition);
-      auto& deconvolved_spectrum = fd.getDeconvolvedSpectrum();
-      if (deconvolved_spectrum.empty())
+      for (uint ms_level = 1; ms_level <= current_max_ms_level; ms_level++)
       {
-        continue;
-      }
+        // for MS>1 spectra, collect the preceding survey scans
+        std::vector<Size> level_tasks;
+        std::deque<const DeconvolvedSpectrum*> survey_scans;
+        if (ms_level > 1)
+        {
+          for (const auto& survey_scan : last_deconvolved_spectra[ms_level - 1])
+          {
+            survey_scans.push_back(&survey_scan);
+          }
+        }
+        for (Size t = 0; t < tasks.size(); t++)
+        {
+          auto& task = tasks[t];
+          if (task.ms_level == ms_level)
+          {
+            task.survey_scans.assign(survey_scans.begin(), survey_scans.end());
+            level_tasks.push_back(t);
+          }
+          else if (task.ms_level + 1 == ms_level && !task.deconvolved_spectrum.empty())
+          {
+            survey_scans.push_back(&task.deconvolved_spectrum);
+            if ((int)survey_scans.size() > num_last_deconvolved_spectra)
+            {
+              survey_scans.pop_front();
+            }
+          }
+        }
+        if (level_tasks.empty())
+        {
+          continue;
+        }
 
-      if (ms_level > 1 && target_precursor_charge != 0)
-      {
-        auto precursor = it->getPrecursors()[0];
-        target_precursor_mass = (precursor.getMZ() - FLASHDeconvHelperStructs::getChargeMass(target_precursor_charge > 0)) * std::abs(target_precursor_charge);
-        // precursor.setCharge(target_precursor_charge);
-        PeakGroup precursorPeakGroup(1, std::abs(target_precursor_charge), target_precursor_charge > 0);
-        precursorPeakGroup.push_back(FLASHDeconvHelperStructs::LogMzPeak());
-        precursorPeakGroup.setMonoisotopicMass(target_precursor_mass);
-        precursorPeakGroup.setSNR(1.0);
+        auto deconv_begin = clock();
+        auto deconv_t_start = chrono::high_resolution_clock::now();
+        std::vector<std::exception_ptr> errors(level_tasks.size());
 
-        precursorPeakGroup.setChargeSNR(std::abs(target_precursor_charge), 1.0);
-        precursorPeakGroup.Qscore(1.0);
-        deconvolved_spectrum.setPrecursor(precursor);
-        deconvolved_spectrum.setPrecursorPeakGroup(precursorPeakGroup);
+#pragma omp parallel for schedule(dynamic)
+        for (SignedSize k = 0; k < (SignedSize)level_tasks.size(); k++)
+        {
+          try
+          {
+            int thread_num = 0;
+#ifdef _OPENMP
+            thread_num = omp_get_thread_num();
+#endif
+            auto& task = tasks[level_tasks[k]];
+            deconvolveSpectrum_(workers[thread_num], spectra[task.index - first_index], task, report_dummy, target_precursor_charge, precursor_map_for_real_time_acquisition);
+          }
+          catch (...)
+          {
+            errors[k] = std::current_exception();
+          }
+        }
+        for (const auto& error : errors)
+        {
+          if (error)
+          {
+            std::rethrow_exception(error);
+          }
+        }
+
+        elapsed_deconv_cpu_secs[ms_level - 1] += double(clock() - deconv_begin) / CLOCKS_PER_SEC;
+        elapsed_deconv_wall_secs[ms_level - 1] += chrono::duration<double>(chrono::high_resolution_clock::now() - deconv_t_start).count();
       }
 
-      if (it->getMSLevel() > 1 && !deconvolved_spectrum.getPrecursorPeakGroup().empty())
+      // collect the results in input order
+      for (auto& task : tasks)
       {
-        precursor_peak_groups[scan_number] = deconvolved_spectrum.getPrecursorPeakGroup();
-        if (deconvolved_spectrum.getPrecursorPeakGroup().getChargeSNR(std::abs(deconvolved_spectrum.getPrecursorCharge())) >= topFD_SNR_threshold)
+        auto& deconvolved_spectrum = task.deconvolved_spectrum;
+        if (deconvolved_spectrum.empty())
         {
-          expected_identification_count += deconvolved_spectrum.getPrecursorPeakGroup().getQscore();
+          continue;
         }
-      }
-      bool deconved_mzML_written = false;
-      if (!out_mzml_file.empty())
-      {
-        if (!deconvolved_spectrum.empty())
+        const auto& spec = spectra[task.index - first_index];
+        uint ms_level = task.ms_level;
+
+        if (ms_level > 1 && !deconvolved_spectrum.getPrecursorPeakGroup().empty())
+        {
+          precursor_peak_groups[task.scan_number] = deconvolved_spectrum.getPrecursorPeakGroup();
+          if (deconvolved_spectrum.getPrecursorPeakGroup().getChargeSNR(std::abs(deconvolved_spectrum.getPrecursorCharge())) >= topFD_SNR_threshold)
+          {
+            expected_identification_count += deconvolved_spectrum.getPrecursorPeakGroup().getQscore();
+          }
+        }
+        bool deconved_mzML_written = false;
+        if (!out_mzml_file.empty())
         {
           auto dspec = deconvolved_spectrum.toSpectrum(mzml_charge, current_min_ms_level, tols[ms_level - 1], false);
           if (dspec.size() > 0)
           {
-            exp.addSpectrum(dspec);
+            if (exp_writer)
+            {
+              exp_writer->consumeSpectrum(dspec);
+            }
+            else
+            {
+              exp.addSpectrum(dspec);
+            }
             deconved_mzML_written = true;
           }
         }
-      }
 
-      if (!out_anno_mzml_file.empty())
-      {
-        if (out_mzml_file.empty() || deconved_mzML_written)
+        if (!out_anno_mzml_file.empty())
         {
-          auto anno_spec = MSSpectrum(*it);
-
-          if (!deconvolved_spectrum.empty())
+          if (out_mzml_file.empty() || deconved_mzML_written)
           {
             std::stringstream val {};
 
@@ -687,7 +963,7 @@ protected:
               for (size_t k = 0; k < pg.size(); k++)
               {
                 auto& p = pg[k];
-                auto pindex = anno_spec.findNearest(p.mz);
+                auto pindex = spec.findNearest(p.mz);
                 val << pindex;
                 if (k < pg.size() - 1)
                 {
@@ -696,80 +972,103 @@ protected:
               }
               val << ";";
             }
+            auto anno_spec = MSSpectrum(spec);
             anno_spec.setMetaValue("DeconvMassPeakIndices", val.str());
-            exp_annotated.addSpectrum(anno_spec);
+            if (exp_annotated_writer)
+            {
+              exp_annotated_writer->consumeSpectrum(anno_spec);
+            }
+            else
+            {
+              exp_annotated.addSpectrum(anno_spec);
+            }
           }
         }
-      }
-      if (ms_level < current_max_ms_level)
-      {
-        if ((int)last_deconvolved_spectra[ms_level].size() >= num_last_deconvolved_spectra)
+        if (ms_level < current_max_ms_level)
         {
-          last_deconvolved_spectra.erase(last_deconvolved_spectra.begin());
+          auto& survey_scans = last_deconvolved_spectra[ms_level];
+          survey_scans.push_back(deconvolved_spectrum);
+          if ((int)survey_scans.size() > num_last_deconvolved_spectra)
+          {
+            survey_scans.pop_front();
+          }
         }
-        last_deconvolved_spectra[ms_level].push_back(deconvolved_spectrum);
-      }
 
-      if (merge != 2)
+        if (merge != 2)
+        {
+          scan_rt_map[deconvolved_spectrum.getScanNumber()] = spec.getRT();
+        }
+
+        if (report_dummy)
+        {
+          dummy_deconvolved_spectra.push_back(std::move(task.dummy_deconvolved_spectrum));
+        }
+        qspec_cntr[ms_level - 1]++;
+        mass_cntr[ms_level - 1] += deconvolved_spectrum.size();
+        if (streaming)
+        {
+          write_deconvolved_spectrum(deconvolved_spectrum);
+        }
+        else
+        {
+          deconvolved_spectra.push_back(std::move(deconvolved_spectrum));
+        }
+      }
+      if (streaming)
       {
-        scan_rt_map[deconvolved_spectrum.getScanNumber()] = it->getRT();
+        auto closed_features = mass_tracer.findClosedFeatures(avg);
+        mass_features.insert(mass_features.end(), closed_features.begin(), closed_features.end());
       }
+      progresslogger.setProgress((SignedSize)block_end);
+      return true;
+    };
 
-      if (report_dummy)
-      {
-#pragma omp parallel sections default(none) shared(fd_charge_dummy, fd_noise_dummy, fd_iso_dummy, it, precursor_specs, scan_number, precursor_map_for_real_time_acquisition)
+    if (streaming)
+    {
+      // only the spectra of the current block are kept in memory
+      std::vector<MSSpectrum> block;
+      block.reserve(block_size);
+      Size block_begin = 0;
+      bool filter_low_peaks = true;
+      bool precursor_missing = false;
+      MSDataTransformingConsumer input_reader;
+      input_reader.setSpectraProcessingFunc([&](MSSpectrum& spec) {
+        if (precursor_missing)
         {
-#pragma omp section
-          fd_charge_dummy.performSpectrumDeconvolution(*it, precursor_specs, scan_number, precursor_map_for_real_time_acquisition);
-#pragma omp section
-          fd_noise_dummy.performSpectrumDeconvolution(*it, precursor_specs, scan_number, precursor_map_for_real_time_acquisition);
-#pragma omp section
-          fd_iso_dummy.performSpectrumDeconvolution(*it, precursor_specs, scan_number, precursor_map_for_real_time_acquisition);
+          return;
         }
-        DeconvolvedSpectrum dummy_deconvolved_spectrum(scan_number);
-        deconvolved_spectrum.sortByQscore();
-        float qscore_threshold_for_dummy = deconvolved_spectrum[deconvolved_spectrum.size() - 1].getQscore();
-        dummy_deconvolved_spectrum.setOriginalSpectrum(*it);
-        dummy_deconvolved_spectrum.reserve(fd_iso_dummy.getDeconvolvedSpectrum().size() + fd_charge_dummy.getDeconvolvedSpectrum().size() + fd_noise_dummy.getDeconvolvedSpectrum().size());
-
-        for (auto& pg : fd_charge_dummy.getDeconvolvedSpectrum())
+        prepare_spectrum(spec);
+        block.push_back(spec);
+        if (filter_low_peaks)
         {
-          if (pg.getQscore() < qscore_threshold_for_dummy)
-          {
-            continue;
-          }
-          dummy_deconvolved_spectrum.push_back(pg);
+          filter_low_peaks = filterLowPeaks(block.back(), max_peak_count_);
         }
-
-        for (auto& pg : fd_iso_dummy.getDeconvolvedSpectrum())
+        if (block.size() == block_size)
         {
-          if (pg.getQscore() < qscore_threshold_for_dummy)
-          {
-            continue;
-          }
-          dummy_deconvolved_spectrum.push_back(pg);
+          precursor_missing = !process_block(block.data(), block.size(), block_begin);
+          block_begin += block.size();
+          block.clear();
         }
-
-        for (auto& pg : fd_noise_dummy.getDeconvolvedSpectrum())
+      });
+      mzml_stream.transform(in_file, &input_reader, true, true);
+      if (!precursor_missing && !block.empty())
+      {
+        precursor_missing = !process_block(block.data(), block.size(), block_begin);
+      }
+      if (precursor_missing)
+      {
+        return EXTERNAL_PROGRAM_ERROR;
+      }
+    }
+    else
+    {
+      for (Size block_begin = 0; block_begin < map.size(); block_begin += block_size)
+      {
+        if (!process_block(&map[block_begin], std::min(block_size, map.size() - block_begin), block_begin))
         {
-          if (pg.getQscore() < qscore_threshold_for_dummy)
-          {
-            continue;
-          }
-          dummy_deconvolved_spectrum.push_back(pg);
+          return EXTERNAL_PROGRAM_ERROR;
         }
-
-        deconvolved_spectrum.sort();
-        dummy_deconvolved_spectrum.sort();
-
-        dummy_deconvolved_spectra.push_back(dummy_deconvolved_spectrum);
       }
-      qspec_cntr[ms_level - 1]++;
-      mass_cntr[ms_level - 1] += deconvolved_spectrum.size();
-      deconvolved_spectra.push_back(deconvolved_spectrum);
-
-      elapsed_deconv_cpu_secs[ms_level - 1] += double(clock() - deconv_begin) / CLOCKS_PER_SEC;
-      elapsed_deconv_wall_secs[ms_level - 1] += chrono::duration<double>(chrono::high_resolution_clock::now() - deconv_t_start).count();
     }
     progresslogger.endProgress();
 
@@ -779,20 +1078,7 @@ protected:
 
     for (auto& deconvolved_spectrum : deconvolved_spectra)
     {
-      uint ms_level = deconvolved_spectrum.getOriginalSpectrum().getMSLevel();
-      if (ms_level == 1)
-      {
-        mass_tracer.storeInformationFromDeconvolvedSpectrum(deconvolved_spectrum); // add deconvolved mass in mass_tracer
-      }
-      if (out_spec_streams.size() + 1 > ms_level)
-      {
-        FLASHDeconvSpectrumFile::writeDeconvolvedMasses(deconvolved_spectrum, deconvolved_spectrum, out_spec_streams[ms_level - 1], in_file, avg, tols[ms_level - 1], write_detail, report_dummy);
-      }
-      if (out_topfd_streams.size() + 1 > ms_level)
-      {
-        FLASHDeconvSpectrumFile::writeTopFD(deconvolved_spectrum, out_topfd_streams[ms_level - 1], topFD_SNR_threshold, current_min_ms_level, false,
-                                            false); //, 1, (float)rand() / (float)RAND_MAX * 10 + 10);
-      }
+      write_deconvolved_spectrum(deconvolved_spectrum);
     }
     if (report_dummy)
     {
@@ -813,7 +1099,8 @@ protected:
     // mass_tracer run
     if (merge != 2) // unless spectra are merged into a single one
     {
-      auto mass_features = mass_tracer.findFeatures(fd.getAveragine());
+      auto remaining_features = mass_tracer.findFeatures(fd.getAveragine());
+      mass_features.insert(mass_features.end(), remaining_features.begin(), remaining_features.end());
       feature_cntr = mass_features.size();
       if (feature_cntr > 0)
       {
@@ -830,13 +1117,33 @@ protected:
       }
     }
 
-    if (!out_mzml_file.empty())
+    // the streaming writers complete their files when they are destroyed, they do not write anything if no spectrum was written
+    auto finish_writer = [&input_settings](std::unique_ptr<PlainMSDataWritingConsumer>& writer, const String& file) {
+      bool empty = writer->getNrSpectraWritten() == 0;
+      writer.reset();
+      if (empty)
+      {
+        MSExperiment no_spectra;
+        no_spectra.ExperimentalSettings::operator=(input_settings);
+        FileHandler().storeExperiment(file, no_spectra, {FileTypes::MZML});
+      }
+    };
+
+    if (exp_writer)
+    {
+      finish_writer(exp_writer, out_mzml_file);
+    }
+    else if (!out_mzml_file.empty())
     {
       FileHandler mzml_file;
       mzml_file.storeExperiment(out_mzml_file, exp, {FileTypes::MZML});
     }
 
-    if (!out_anno_mzml_file.empty())
+    if (exp_annotated_writer)
+    {
+      finish_writer(exp_annotated_writer, out_anno_mzml_file);
+    }
+    else if (!out_anno_mzml_file.empty())
     {
       FileHandler mzml_file;
       mzml_file.storeExperiment(out_anno_mzml_file, exp_annotated, {FileTypes::MZML});
@@ -8,6 +8,7 @@
 
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 #include <OpenMS/ANALYSIS/ID/FalseDiscoveryRate.h>
+#include <OpenMS/METADATA/PSMTable.h>
 #include <OpenMS/PROCESSING/ID/IDFilter.h>
 #include <OpenMS/KERNEL/StandardTypes.h>
 #include <OpenMS/FORMAT/FileTypes.h>
@@ -183,9 +184,26 @@ protected:
       bool peptide_level_fdr = getStringOption_("peptide") == "true";
       bool psm_level_fdr = getStringOption_("PSM") == "true";
 
-      if (psm_level_fdr || peptide_level_fdr)
+      if ((psm_level_fdr || peptide_level_fdr) && !PSMTable::hasUniformScoreType(pep_ids))
       {
+        // e.g. merged results of different search engines: scored together as before, but not on the PSM table
+        OPENMS_LOG_WARN << "Warning: The peptide identifications use different score types or orientations. "
+          "The FDR is only meaningful if their scores are comparable." << endl;
         fdr.apply(pep_ids, peptide_level_fdr);
+        filter_applied = true;
+
+        if (psm_fdr < 1)
+        {
+          OPENMS_LOG_INFO << "FDR control: Filtering PSMs..." << endl;
+          IDFilter::filterHitsByScore(pep_ids, psm_fdr);
+        }
+      }
+      else if (psm_level_fdr || peptide_level_fdr)
+      {
+        // columnar view of the PSMs: FDR estimation and filtering run on it in parallel
+        PSMTable psms;
+        psms.importIDs(pep_ids);
+        fdr.apply(psms, peptide_level_fdr);
         // TODO If no decoys are removed in the param settings, we shouldn't need cleanups
         //  but then all tests need to be changed since cleanup sorts.
         //if (alg_param.getValue("add_decoy_peptides").toBool())
@@ -198,8 +216,9 @@ protected:
         {
           filter_applied = true;
           OPENMS_LOG_INFO << "FDR control: Filtering PSMs..." << endl;
-          IDFilter::filterHitsByScore(pep_ids, psm_fdr);
+          IDFilter::filterHitsByScore(psms, psm_fdr);
         }
+        psms.exportIDs(pep_ids);
       }
     }
     catch (Exception::MissingInformation& e)
@@ -13,11 +13,15 @@
 #include <OpenMS/CHEMISTRY/ProteaseDigestion.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
 #include <OpenMS/FORMAT/FileHandler.h>
+#include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/FORMAT/DATAACCESS/IdXMLWritingConsumer.h>
+#include <OpenMS/INTERFACES/IIdentificationConsumer.h>
 #include <OpenMS/ANALYSIS/ID/IDRipper.h>
 #include <OpenMS/PROCESSING/ID/IDFilter.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
 #include <OpenMS/SYSTEM/File.h>
 
+#include <functional>
 #include <limits>
 
 using namespace OpenMS;
@@ -84,6 +88,11 @@ If necessary, use @ref TOPP_PeptideIndexer to generate protein references for pe
 
 @note Currently mzIdentML (mzid) is not directly supported as an input/output format of this tool. Convert mzid files to/from idXML using @ref TOPP_IDFileConverter if necessary.
 
+<b>Low memory processing</b> (@p processOption @p lowmemory):
+idXML files can be filtered while they are read, without loading all peptide identifications into memory.
+This is supported for the filters that decide for each peptide identification on its own (precursor RT, m/z, length and charge, PSM score, best/ranked peptide hits, mass error, duplicate and shared peptides) and the subsequent clean-up of protein hits.
+If unreferenced protein hits are removed (the default), the input file is read twice.
+
 <B>The command line parameters of this tool are:</B>
 @verbinclude TOPP_IDFilter.cli
 <B>INI file documentation of this tool:</B>
@@ -211,6 +220,329 @@ protected:
     registerFlag_("delete_unreferenced_peptide_hits", "Peptides not referenced by any protein are deleted in the IDs. Usually used in combination with 'score:protein' or 'thresh:prot'.");
 
     registerStringList_("remove_peptide_hits_by_metavalue", "<name> 'lt|eq|gt|ne' <value>", StringList(), "Expects a 3-tuple (=3 entries in the list), i.e. <name> 'lt|eq|gt|ne' <value>; the first is the name of meta value, followed by the comparison operator (equal, less, greater, not equal) and the value to compare to. All comparisons are done after converting the given value to the corresponding data value type of the meta value (for lists, this simply compares length, not content!)!", false, true);
+
+    registerStringOption_("processOption", "<name>", "inmemory", "Whether to load all identifications and process them in-memory or whether to process them on the fly (lowmemory) without loading the whole file into memory first (idXML only, peptide-level filters only)", false, true);
+    setValidStrings_("processOption", {"inmemory", "lowmemory"});
+  }
+
+  /**
+    @brief Filters the identifications of an idXML file while it is read (processOption 'lowmemory')
+
+    Peptide identifications are filtered batch by batch and passed on to the
+    next consumer (usually an IdXMLWritingConsumer), together with the runs
+    they belong to. Without a next consumer, only the protein accessions
+    referenced by the filtered peptide hits are collected (first pass if
+    unreferenced protein hits are removed). Runs are identified by their
+    position in the file, because identifiers may be generated when reading.
+  */
+  class IDFilterConsumer :
+    public Interfaces::IIdentificationConsumer
+  {
+  public:
+    typedef std::function<void(vector<PeptideIdentification>&)> PeptideFilter;
+    typedef vector<unordered_set<String>> AccessionsPerRun;
+
+    /// Counts of runs and hits
+    struct Counts
+    {
+      Size prot_ids = 0, prot_hits = 0, pep_ids = 0, pep_hits = 0;
+    };
+
+    /**
+      @brief Constructor
+
+      @param filter The peptide-level filters
+      @param next Consumer of the filtered identifications (nullptr: only collect referenced accessions)
+      @param referenced Protein accessions to keep per run, in file order (nullptr: keep all protein hits)
+      @param delete_unreferenced_peptide_hits Remove peptide hits without reference to a protein of their run
+    */
+    IDFilterConsumer(const PeptideFilter& filter, Interfaces::IIdentificationConsumer* next, const AccessionsPerRun* referenced,
+                     bool delete_unreferenced_peptide_hits) :
+      filter_(filter),
+      next_(next),
+      referenced_(referenced),
+      delete_unreferenced_peptide_hits_(delete_unreferenced_peptide_hits)
+    {
+    }
+
+    void setDocumentIdentifier(const String& document_id) override
+    {
+      if (next_ != nullptr) next_->setDocumentIdentifier(document_id);
+    }
+
+    void consumeProteinIdentification(ProteinIdentification& prot_id) override
+    {
+      const Size run_index = before_.prot_ids++;
+      before_.prot_hits += prot_id.getHits().size();
+      if (next_ == nullptr)
+      {
+        run_index_[prot_id.getIdentifier()] = run_index;
+        referenced_accessions_.resize(run_index + 1);
+        return;
+      }
+
+      if (referenced_ != nullptr)
+      {
+        static const unordered_set<String> none;
+        IDFilter::keepMatchingItems(prot_id.getHits(), IDFilter::HasMatchingAccessionUnordered<ProteinHit>(run_index < referenced_->size() ? (*referenced_)[run_index] : none));
+      }
+
+      // propagate filter from protein level to protein group level
+      if (!IDFilter::updateProteinGroups(prot_id.getProteinGroups(), prot_id.getHits()))
+      {
+        OPENMS_LOG_WARN << "Warning: While updating protein groups, some proteins were removed from groups that are still present. The new grouping (especially the group probabilities) may not be completely valid any more." << endl;
+      }
+      if (!IDFilter::updateProteinGroups(prot_id.getIndistinguishableProteins(), prot_id.getHits()))
+      {
+        OPENMS_LOG_WARN << "Warning: While updating indistinguishable proteins, some proteins were removed from groups that are still present. The new grouping (especially the group probabilities) may not be completely valid any more." << endl;
+      }
+      prot_id.assignRanks();
+
+      // protein references of the peptides are checked against the remaining hits
+      runs_.push_back(prot_id);
+      ++after_.prot_ids;
+      after_.prot_hits += prot_id.getHits().size();
+      next_->consumeProteinIdentification(prot_id);
+    }
+
+    void consumePeptideIdentifications(vector<PeptideIdentification>& pep_ids) override
+    {
+      before_.pep_ids += pep_ids.size();
+      before_.pep_hits += IDFilter::countHits(pep_ids);
+      filter_(pep_ids);
+
+      if (next_ == nullptr)
+      {
+        for (const PeptideIdentification& pep : pep_ids)
+        {
+          const auto it = run_index_.find(pep.getIdentifier());
+          if (it == run_index_.end()) continue; // not written
+          unordered_set<String>& accessions = referenced_accessions_[it->second];
+          for (const PeptideHit& hit : pep.getHits())
+          {
+            const set<String> hit_accessions = hit.extractProteinAccessionsSet();
+            accessions.insert(hit_accessions.begin(), hit_accessions.end());
+          }
+        }
+        return;
+      }
+
+      IDFilter::updateProteinReferences(pep_ids, runs_, delete_unreferenced_peptide_hits_);
+      IDFilter::removeEmptyIdentifications(pep_ids);
+      IDFilter::updateHitRanks(pep_ids);
+      after_.pep_ids += pep_ids.size();
+      after_.pep_hits += IDFilter::countHits(pep_ids);
+      next_->consumePeptideIdentifications(pep_ids);
+    }
+
+    /// Protein accessions referenced by the filtered peptide hits (without next consumer)
+    const AccessionsPerRun& getReferencedAccessions() const
+    {
+      return referenced_accessions_;
+    }
+
+    /// Counts of the consumed identifications
+    const Counts& getCountsBefore() const
+    {
+      return before_;
+    }
+
+    /// Counts of the identifications passed on
+    const Counts& getCountsAfter() const
+    {
+      return after_;
+    }
+
+  private:
+    PeptideFilter filter_;
+    Interfaces::IIdentificationConsumer* next_;
+    const AccessionsPerRun* referenced_;
+    bool delete_unreferenced_peptide_hits_;
+    vector<ProteinIdentification> runs_;
+    map<String, Size> run_index_;
+    AccessionsPerRun referenced_accessions_;
+    Counts before_, after_;
+  };
+
+  /// Name of the first active option that processOption 'lowmemory' does not support (empty if there is none)
+  String getUnsupportedLowMemoryOption_() const
+  {
+    const vector<pair<String, bool>> options =
+    {
+      {"score:protein", !std::isnan(getDoubleOption_("score:protein"))},
+      {"score:proteingroup", !std::isnan(getDoubleOption_("score:proteingroup"))},
+      {"whitelist:proteins", !getStringOption_("whitelist:proteins").trim().empty()},
+      {"whitelist:protein_accessions", !getStringList_("whitelist:protein_accessions").empty()},
+      {"whitelist:peptides", !getStringOption_("whitelist:peptides").trim().empty()},
+      {"whitelist:modifications", !getStringList_("whitelist:modifications").empty()},
+      {"blacklist:proteins", !getStringOption_("blacklist:proteins").trim().empty()},
+      {"blacklist:protein_accessions", !getStringList_("blacklist:protein_accessions").empty()},
+      {"blacklist:peptides", !getStringOption_("blacklist:peptides").trim().empty()},
+      {"blacklist:modifications", !getStringList_("blacklist:modifications").empty()},
+      {"blacklist:RegEx", !getStringOption_("blacklist:RegEx").empty()},
+      {"in_silico_digestion:fasta", !getStringOption_("in_silico_digestion:fasta").trim().empty()},
+      {"missed_cleavages:number_of_missed_cleavages", getStringOption_("missed_cleavages:number_of_missed_cleavages") != ":"},
+      {"rt:p_value", getDoubleOption_("rt:p_value") > 0},
+      {"rt:p_value_1st_dim", getDoubleOption_("rt:p_value_1st_dim") > 0},
+      {"best:n_spectra", getIntOption_("best:n_spectra") > 0},
+      {"best:spectrum_per_peptide", getStringOption_("best:spectrum_per_peptide") != "false"},
+      {"best:n_protein_hits", getIntOption_("best:n_protein_hits") > 0},
+      {"var_mods", getFlag_("var_mods")},
+      {"remove_decoys", getFlag_("remove_decoys")},
+      {"remove_peptide_hits_by_metavalue", !getStringList_("remove_peptide_hits_by_metavalue").empty()}
+    };
+    for (const auto& option : options)
+    {
+      if (option.second) return option.first;
+    }
+    return "";
+  }
+
+  ExitCodes doLowMemAlgorithm_(const String& inputfile_name, const String& outputfile_name)
+  {
+    if (FileHandler::getType(inputfile_name) != FileTypes::IDXML)
+    {
+      writeLogError_("Error: processOption 'lowmemory' is only supported for idXML files.");
+      return ILLEGAL_PARAMETERS;
+    }
+    const String unsupported = getUnsupportedLowMemoryOption_();
+    if (!unsupported.empty())
+    {
+      writeLogError_("Error: processOption 'lowmemory' only supports peptide-level filters, but '" + unsupported + "' is set. Use processOption 'inmemory'.");
+      return ILLEGAL_PARAMETERS;
+    }
+
+    // peptide-level filters in the same order as in main_()
+    vector<IDFilterConsumer::PeptideFilter> filters;
+
+    double rt_high = numeric_limits<double>::infinity(), rt_low = -rt_high;
+    if (parseRange_(getStringOption_("precursor:rt"), rt_low, rt_high))
+    {
+      OPENMS_LOG_INFO << "Filtering peptide IDs by precursor RT..." << endl;
+      filters.emplace_back([rt_low, rt_high](vector<PeptideIdentification>& peptides) { IDFilter::filterPeptidesByRT(peptides, rt_low, rt_high); });
+    }
+
+    double mz_high = numeric_limits<double>::infinity(), mz_low = -mz_high;
+    if (parseRange_(getStringOption_("precursor:mz"), mz_low, mz_high))
+    {
+      OPENMS_LOG_INFO << "Filtering peptide IDs by precursor m/z..." << endl;
+      filters.emplace_back([mz_low, mz_high](vector<PeptideIdentification>& peptides) { IDFilter::filterPeptidesByMZ(peptides, mz_low, mz_high); });
+    }
+
+    if (getFlag_("remove_duplicate_psm"))
+    {
+      OPENMS_LOG_INFO << "Removing duplicated psms..." << endl;
+      filters.emplace_back([](vector<PeptideIdentification>& peptides) { IDFilter::removeDuplicatePeptideHits(peptides); });
+    }
+
+    if (getFlag_("remove_shared_peptides"))
+    {
+      OPENMS_LOG_INFO << "Filtering peptides by unique match to a protein..." << endl;
+      filters.emplace_back([](vector<PeptideIdentification>& peptides) { IDFilter::keepUniquePeptidesPerProtein(peptides); });
+    }
+
+    if (getFlag_("best:strict"))
+    {
+      OPENMS_LOG_INFO << "Filtering by best peptide hits..." << endl;
+      filters.emplace_back([](vector<PeptideIdentification>& peptides) { IDFilter::keepBestPeptideHits(peptides, true); });
+    }
+
+    Int min_length = 0, max_length = 0;
+    if (parseRange_(getStringOption_("precursor:length"), min_length, max_length))
+    {
+      OPENMS_LOG_INFO << "Filtering by peptide length..." << endl;
+      if ((min_length < 0) || (max_length < 0))
+      {
+        OPENMS_LOG_ERROR << "Fatal error: negative values are not allowed for parameter 'precursor:length'" << endl;
+        return ILLEGAL_PARAMETERS;
+      }
+      filters.emplace_back([min_length, max_length](vector<PeptideIdentification>& peptides) { IDFilter::filterPeptidesByLength(peptides, Size(min_length), Size(max_length)); });
+    }
+
+    double psm_score = getDoubleOption_("score:psm");
+    if (!std::isnan(psm_score))
+    {
+      OPENMS_LOG_INFO << "Filtering by PSM score (better than " << psm_score << ")..." << endl;
+      filters.emplace_back([psm_score](vector<PeptideIdentification>& peptides) { IDFilter::filterHitsByScore(peptides, psm_score); });
+    }
+
+    Int min_charge = numeric_limits<Int>::min(), max_charge = numeric_limits<Int>::max();
+    if (parseRange_(getStringOption_("precursor:charge"), min_charge, max_charge))
+    {
+      OPENMS_LOG_INFO << "Filtering by peptide charge..." << endl;
+      filters.emplace_back([min_charge, max_charge](vector<PeptideIdentification>& peptides) { IDFilter::filterPeptidesByCharge(peptides, min_charge, max_charge); });
+    }
+
+    Size best_n_pep = getIntOption_("best:n_peptide_hits");
+    if (best_n_pep > 0)
+    {
+      OPENMS_LOG_INFO << "Filtering by best n peptide hits..." << endl;
+      filters.emplace_back([best_n_pep](vector<PeptideIdentification>& peptides) { IDFilter::keepNBestHits(peptides, best_n_pep); });
+    }
+
+    Int min_rank = 0, max_rank = 0;
+    if (parseRange_(getStringOption_("best:n_to_m_peptide_hits"), min_rank, max_rank))
+    {
+      OPENMS_LOG_INFO << "Filtering by peptide hit ranks..." << endl;
+      if ((min_rank < 0) || (max_rank < 0))
+      {
+        OPENMS_LOG_ERROR << "Fatal error: negative values are not allowed for parameter 'best:n_to_m_peptide_hits'" << endl;
+        return ILLEGAL_PARAMETERS;
+      }
+      filters.emplace_back([min_rank, max_rank](vector<PeptideIdentification>& peptides) { IDFilter::filterHitsByRank(peptides, Size(min_rank), Size(max_rank)); });
+    }
+
+    double mz_error = getDoubleOption_("mz:error");
+    if (mz_error > 0)
+    {
+      OPENMS_LOG_INFO << "Filtering by mass error..." << endl;
+      bool unit_ppm = (getStringOption_("mz:unit") == "ppm");
+      filters.emplace_back([mz_error, unit_ppm](vector<PeptideIdentification>& peptides) { IDFilter::filterPeptidesByMZError(peptides, mz_error, unit_ppm); });
+    }
+
+    auto filter = [&filters](vector<PeptideIdentification>& peptides)
+    {
+      for (const auto& f : filters) f(peptides);
+    };
+    bool rm_pep = getFlag_("delete_unreferenced_peptide_hits");
+
+    // first pass: protein accessions referenced after filtering
+    IDFilterConsumer::AccessionsPerRun referenced;
+    bool remove_unreferenced = !getFlag_("keep_unreferenced_protein_hits");
+    if (remove_unreferenced)
+    {
+      OPENMS_LOG_INFO << "Collecting protein references..." << endl;
+      IDFilterConsumer collector(filter, nullptr, nullptr, false);
+      IdXMLFile().transform(inputfile_name, &collector);
+      referenced = collector.getReferencedAccessions();
+      OPENMS_LOG_INFO << "Removing unreferenced protein hits..." << endl;
+    }
+    if (rm_pep)
+    {
+      OPENMS_LOG_INFO << "Removing peptide hits without protein references..." << endl;
+    }
+
+    IdXMLWritingConsumer writer(outputfile_name);
+    IDFilterConsumer consumer(filter, &writer, remove_unreferenced ? &referenced : nullptr, rm_pep);
+    IdXMLFile id_file;
+    id_file.setLogType(log_type_);
+    id_file.transform(inputfile_name, &consumer);
+    writer.close();
+
+    const IDFilterConsumer::Counts& before = consumer.getCountsBefore();
+    const IDFilterConsumer::Counts& after = consumer.getCountsAfter();
+    OPENMS_LOG_INFO << "Before filtering:\n"
+             << before.prot_ids << " identification runs with "
+             << before.prot_hits << " proteins,\n"
+             << before.pep_ids << " spectra identified with "
+             << before.pep_hits << " spectrum matches.\n"
+             << "After filtering:\n"
+             << after.prot_ids << " identification runs with "
+             << after.prot_hits << " proteins,\n"
+             << after.pep_ids << " spectra identified with "
+             << after.pep_hits << " spectrum matches." << endl;
+
+    return EXECUTION_OK;
   }
 
 
@@ -220,6 +552,11 @@ protected:
     String inputfile_name = getStringOption_("in");
     String outputfile_name = getStringOption_("out");
 
+    if (getStringOption_("processOption") == "lowmemory")
+    {
+      return doLowMemAlgorithm_(inputfile_name, outputfile_name);
+    }
+
     vector<ProteinIdentification> proteins;
     vector<PeptideIdentification> peptides;
 
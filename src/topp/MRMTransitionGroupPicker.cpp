@@ -211,32 +211,41 @@ protected:
                                        "Not all assays could be mapped to chromatograms");
     }
 
-    // Iterating over all the assays
-    for (MRMGroupMapper::AssayMapT::iterator assay_it = m.assay_map.begin(); assay_it != m.assay_map.end(); ++assay_it)
+    // Iterating over all the assays, the transition groups are created and
+    // processed in parallel in batches (only one batch is kept in memory)
+    const Size batch_size = 1024;
+    std::vector<MRMTransitionGroupType> transition_groups;
+    MRMGroupMapper::AssayMapT::iterator assay_it = m.assay_map.begin();
+    while (assay_it != m.assay_map.end())
     {
-      String id = assay_it->first;
-
-      // Create new transition group if there is none for this peptide
-      MRMTransitionGroupType transition_group;
-      m.getTransitionGroup(input, transition_group, id);
+      transition_groups.clear();
+      for (; assay_it != m.assay_map.end() && transition_groups.size() < batch_size; ++assay_it)
+      {
+        // Create new transition group for this peptide
+        transition_groups.emplace_back();
+        m.getTransitionGroup(input, transition_groups.back(), assay_it->first);
+      }
 
-      // Process the transition_group
-      trgroup_picker.pickTransitionGroup(transition_group);
+      // Process the transition groups
+      trgroup_picker.pickTransitionGroups(transition_groups);
 
-      // Add to output
-      for (Size i = 0; i < transition_group.getFeatures().size(); i++)
+      for (const MRMTransitionGroupType& transition_group : transition_groups)
       {
-        MRMFeature mrmfeature = transition_group.getFeatures()[i];
-        // Prepare the subordinates for the mrmfeature (process all current
-        // features and then append all precursor subordinate features)
-        std::vector<Feature> allFeatures = mrmfeature.getFeatures();
-        for (std::vector<Feature>::iterator f_it = allFeatures.begin(); f_it != allFeatures.end(); ++f_it)
+        // Add to output
+        for (Size i = 0; i < transition_group.getFeatures().size(); i++)
         {
-          f_it->getConvexHulls().clear();
-          f_it->ensureUniqueId();
+          MRMFeature mrmfeature = transition_group.getFeatures()[i];
+          // Prepare the subordinates for the mrmfeature (process all current
+          // features and then append all precursor subordinate features)
+          std::vector<Feature> allFeatures = mrmfeature.getFeatures();
+          for (std::vector<Feature>::iterator f_it = allFeatures.begin(); f_it != allFeatures.end(); ++f_it)
+          {
+            f_it->getConvexHulls().clear();
+            f_it->ensureUniqueId();
+          }
+          mrmfeature.setSubordinates(allFeatures); // add all the subfeatures as subordinates
+          output.push_back(mrmfeature);
         }
-        mrmfeature.setSubordinates(allFeatures); // add all the subfeatures as subordinates
-        output.push_back(mrmfeature);
       }
     }
   }
@@ -16,6 +16,7 @@
 #include <OpenMS/FORMAT/MzTabFile.h>
 #include <OpenMS/SYSTEM/File.h>
 
+#include <OpenMS/ANALYSIS/ID/MetaboliteSpectralLibraryIndex.h>
 #include <OpenMS/ANALYSIS/ID/MetaboliteSpectralMatching.h>
 
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
@@ -51,6 +52,8 @@ using namespace std;
 By default, MS2 spectra with similar precursor mass are merged before comparison with database spectra, for example when a mass at the beginning of the peak and on the peak apex is selected twice as precursor.
 Merging can also have disadvantages, for example, for isobaric or isomeric compounds that have similar/same masses but can have different retention times and MS2 spectra.
 
+The spectral library is indexed by precursor m/z before the search. For large libraries (e.g. from GNPS or MoNA), the index can be kept (see the advanced option @p database_index) and is then reused as long as the library does not change.
+
 <B>The command line parameters of this tool are:</B>
 @verbinclude TOPP_MetaboliteSpectralMatcher.cli
 <B>INI file documentation of this tool:</B>
@@ -77,6 +80,7 @@ protected:
     setValidFormats_("in", ListUtils::create<String>("mzML"));
     registerInputFile_("database", "<file>", "", "Default spectral database.", true);
     setValidFormats_("database", {"mzML", "msp", "mgf"});
+    registerStringOption_("database_index", "<file>", "", "Binary index of '-database' (see MetaboliteSpectralLibraryIndex). Used instead of loading '-database' if it is up to date with the database, otherwise (re-)generated. Keep it next to large databases to avoid parsing them for every search.", false, true);
     registerOutputFile_("out", "<file>", "", "mzTab file");
     setValidFormats_("out", ListUtils::create<String>("mzTab"));
     registerOutputFile_("out_spectra", "<file>", "", "Output spectra as mzML file. Can be useful to inspect the peak map after spectra merging.", false);
@@ -140,10 +144,11 @@ protected:
     //-------------------------------------------------------------
     // load database
     //-------------------------------------------------------------
-    PeakMap spec_db;
-    FileHandler().loadExperiment(spec_db_filename, spec_db, {FileTypes::MSP, FileTypes::MZML, FileTypes::MGF});
+    // (without -database_index, a temporary index is created)
+    MetaboliteSpectralLibraryIndex spec_db;
+    spec_db.openOrCreate(File::getTemporaryFile(getStringOption_("database_index")), spec_db_filename);
 
-    if (spec_db.empty())
+    if (spec_db.getNrSpectra() == 0)
     {
       OPENMS_LOG_WARN << "The spectral library does not contain any spectra.";
       return INCOMPATIBLE_INPUT_DATA;
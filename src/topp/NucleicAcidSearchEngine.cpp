@@ -260,6 +260,37 @@ protected:
 
   typedef multimap<double, AnnotatedHit, greater<double>> HitsByScore;
 
+  // precursor masses (sorted) with information about the MS2 precursors
+  typedef vector<pair<double, PrecursorInfo>> PrecursorTable;
+
+  // add a hit to the list of hits for a spectrum, if it is among the top hits
+  // (all hits tied with the worst score are kept); returns the position of the
+  // new hit (data has to be filled in) or "scan_hits.end()" if it was rejected
+  static HitsByScore::iterator insertHit_(HitsByScore& scan_hits, double score,
+                                          Size report_top_hits)
+  {
+    HitsByScore::iterator pos = scan_hits.end();
+    if ((report_top_hits == 0) || (scan_hits.size() < report_top_hits))
+    {
+      pos = scan_hits.insert(make_pair(score, AnnotatedHit()));
+    }
+    else // already have enough hits for this spectrum - replace one?
+    {
+      double worst_score = (--scan_hits.end())->first;
+      if (score >= worst_score)
+      {
+        pos = scan_hits.insert(make_pair(score, AnnotatedHit()));
+        // prune list of hits if possible (careful about tied scores):
+        Size n_worst = scan_hits.count(worst_score);
+        if (scan_hits.size() - n_worst >= report_top_hits)
+        {
+          scan_hits.erase(worst_score);
+        }
+      }
+    }
+    return pos;
+  }
+
   // query modified residues from database
   set<ConstRibonucleotidePtr> getModifications_(const set<String>& mod_names)
   {
@@ -717,10 +748,22 @@ protected:
     IdentificationData::ScoreTypeRef score_ref =
       id_data.getScoreTypes().begin();
 
-// @TODO: change OpenMP schedule from default ("static") to "dynamic"/"guided"?
-#pragma omp parallel for
-    for (SignedSize scan_index = 0;
-         scan_index < (SignedSize)annotated_hits.size(); ++scan_index)
+    if (resolve_ambiguous_mods_)
+    {
+#pragma omp parallel for schedule(dynamic)
+      for (SignedSize scan_index = 0;
+           scan_index < (SignedSize)annotated_hits.size(); ++scan_index)
+      {
+        if (annotated_hits[scan_index].size() > 1)
+        {
+          resolveAmbiguousMods_(annotated_hits[scan_index]);
+        }
+      }
+    }
+
+    // registering results in "id_data" can't be done in parallel - do it in
+    // one pass (in order of the spectra) instead of locking for every hit:
+    for (Size scan_index = 0; scan_index < annotated_hits.size(); ++scan_index)
     {
       if (annotated_hits[scan_index].empty()) continue;
 
@@ -731,14 +774,8 @@ protected:
       obs.setMetaValue("scan_index", static_cast<unsigned int>(scan_index));
       obs.setMetaValue("precursor_intensity",
                          spectrum.getPrecursors()[0].getIntensity());
-      IdentificationData::ObservationRef obs_ref;
-#pragma omp critical (id_data_access)
-      obs_ref = id_data.registerObservation(obs);
-
-      if (resolve_ambiguous_mods_ && (annotated_hits[scan_index].size() > 1))
-      {
-        resolveAmbiguousMods_(annotated_hits[scan_index]);
-      }
+      IdentificationData::ObservationRef obs_ref =
+        id_data.registerObservation(obs);
 
       // create full oligo hit structure from annotated hits
       for (const auto& pair : annotated_hits[scan_index])
@@ -750,9 +787,8 @@ protected:
         // transfer parent matches from unmodified oligo:
         IdentificationData::IdentifiedOligo oligo = *hit.oligo_ref;
         oligo.sequence = hit.sequence;
-        IdentificationData::IdentifiedOligoRef oligo_ref;
-#pragma omp critical (id_data_access)
-        oligo_ref = id_data.registerIdentifiedOligo(oligo);
+        IdentificationData::IdentifiedOligoRef oligo_ref =
+          id_data.registerIdentifiedOligo(oligo);
 
         Int charge = hit.precursor_ref->charge;
         if ((charge > 0) && negative_mode) charge = -charge;
@@ -765,7 +801,6 @@ protected:
                            hit.precursor_error_ppm);
         match.setMetaValue("isotope_offset", hit.precursor_ref->isotope);
         match.adduct_opt = hit.precursor_ref->adduct;
-#pragma omp critical (id_data_access)
         id_data.registerObservationMatch(match);
       }
     }
@@ -1084,8 +1119,8 @@ protected:
     OPENMS_LOG_DEBUG << "preprocessed spectra: " << spectra.getNrSpectra()
                      << endl;
 
-    // build multimap of precursor mass to scan index (and other information):
-    multimap<double, PrecursorInfo> precursor_mass_map;
+    // build table of precursor masses with scan indexes (and other information):
+    PrecursorTable precursor_table;
     for (PeakMap::ConstIterator s_it = spectra.begin(); s_it != spectra.end();
          ++s_it)
     {
@@ -1146,11 +1181,19 @@ protected:
                                       negative_mode);
             PrecursorInfo info(scan_index, precursor_charge, isotope_number,
                                adduct_pair.second);
-            precursor_mass_map.insert(make_pair(precursor_mass, info));
+            precursor_table.emplace_back(precursor_mass, info);
           }
         }
       }
     }
+    // sorted by mass for binary search (a vector is more compact than a
+    // multimap; stable sort keeps the order of equal masses):
+    stable_sort(precursor_table.begin(), precursor_table.end(),
+                [](const PrecursorTable::value_type& a,
+                   const PrecursorTable::value_type& b)
+                {
+                  return a.first < b.first;
+                });
 
     // create spectrum generator:
     NucleicAcidSpectrumGenerator spectrum_generator;
@@ -1180,6 +1223,13 @@ protected:
     spectrum_generator.setParameters(param);
 
     vector<HitsByScore> annotated_hits(spectra.size());
+    // hits are collected per thread and merged after the search, so threads
+    // don't have to wait for each other (only spectra with hits are stored):
+#ifdef _OPENMP
+    vector<map<Size, HitsByScore>> hits_per_thread(omp_get_max_threads());
+#else
+    vector<map<Size, HitsByScore>> hits_per_thread(1);
+#endif
     MSExperiment exp_ms2_spectra, theo_ms2_spectra; // debug output
 
     String msg = "scoring oligonucleotide models against spectra...";
@@ -1209,6 +1259,12 @@ protected:
         progresslogger.setProgress(index);
       }
 
+#ifdef _OPENMP
+      map<Size, HitsByScore>& thread_hits = hits_per_thread[omp_get_thread_num()];
+#else
+      map<Size, HitsByScore>& thread_hits = hits_per_thread[0];
+#endif
+
       IdentificationData::IdentifiedOligoRef oligo_ref = digest[index];
       vector<NASequence> all_modified_oligos;
       NASequence ns = oligo_ref->sequence;
@@ -1236,9 +1292,19 @@ protected:
         {
           tol *= candidate_mass * 1e-6;
         }
-        multimap<double, PrecursorInfo>::const_iterator low_it =
-          precursor_mass_map.lower_bound(candidate_mass - tol), up_it =
-          precursor_mass_map.upper_bound(candidate_mass + tol);
+        PrecursorTable::const_iterator low_it =
+          lower_bound(precursor_table.begin(), precursor_table.end(),
+                      candidate_mass - tol,
+                      [](const PrecursorTable::value_type& entry, double mass)
+                      {
+                        return entry.first < mass;
+                      });
+        PrecursorTable::const_iterator up_it =
+          upper_bound(low_it, precursor_table.cend(), candidate_mass + tol,
+                      [](double mass, const PrecursorTable::value_type& entry)
+                      {
+                        return mass < entry.first;
+                      });
 
         if (low_it == up_it) continue; // no matching precursor in data
 
@@ -1299,41 +1365,20 @@ protected:
 
             OPENMS_LOG_DEBUG << "Score: " << score << endl;
 
-#pragma omp critical (annotated_hits_access)
+            HitsByScore& scan_hits = thread_hits[scan_index];
+            HitsByScore::iterator pos = insertHit_(scan_hits, score,
+                                                   report_top_hits);
+            // add oligo hit data only if necessary (good enough score):
+            if (pos != scan_hits.end())
             {
-              HitsByScore& scan_hits = annotated_hits[scan_index];
-              HitsByScore::iterator pos = scan_hits.end();
-              if ((report_top_hits == 0) ||
-                  (scan_hits.size() < report_top_hits))
-              {
-                pos = scan_hits.insert(make_pair(score, AnnotatedHit()));
-              }
-              else // already have enough hits for this spectrum - replace one?
-              {
-                double worst_score = (--scan_hits.end())->first;
-                if (score >= worst_score)
-                {
-                  pos = scan_hits.insert(make_pair(score, AnnotatedHit()));
-                  // prune list of hits if possible (careful about tied scores):
-                  Size n_worst = scan_hits.count(worst_score);
-                  if (scan_hits.size() - n_worst >= report_top_hits)
-                  {
-                    scan_hits.erase(worst_score);
-                  }
-                }
-              }
-              // add oligo hit data only if necessary (good enough score):
-              if (pos != scan_hits.end())
-              {
-                AnnotatedHit& ah = pos->second;
-                ah.oligo_ref = oligo_ref;
-                ah.sequence = candidate;
-                // @TODO: is "observed - calculated" the right way around?
-                ah.precursor_error_ppm =
-                  (prec_it->first - candidate_mass) / candidate_mass * 1.0e6;
-                ah.annotations = annotations;
-                ah.precursor_ref = &(prec_it->second);
-              }
+              AnnotatedHit& ah = pos->second;
+              ah.oligo_ref = oligo_ref;
+              ah.sequence = candidate;
+              // @TODO: is "observed - calculated" the right way around?
+              ah.precursor_error_ppm =
+                (prec_it->first - candidate_mass) / candidate_mass * 1.0e6;
+              ah.annotations = std::move(annotations);
+              ah.precursor_ref = &(prec_it->second);
             }
           }
         }
@@ -1341,6 +1386,30 @@ protected:
     }
     progresslogger.endProgress();
 
+    // merge hits from all threads (keeping the top hits per spectrum):
+    for (map<Size, HitsByScore>& thread_hits : hits_per_thread)
+    {
+      for (auto& scan_pair : thread_hits)
+      {
+        HitsByScore& scan_hits = annotated_hits[scan_pair.first];
+        if (scan_hits.empty())
+        {
+          scan_hits.swap(scan_pair.second);
+          continue;
+        }
+        for (auto& hit_pair : scan_pair.second)
+        {
+          HitsByScore::iterator pos = insertHit_(scan_hits, hit_pair.first,
+                                                 report_top_hits);
+          if (pos != scan_hits.end())
+          {
+            pos->second = std::move(hit_pair.second);
+          }
+        }
+      }
+      thread_hits.clear();
+    }
+
     OPENMS_LOG_INFO << "Undigested nucleic acids: " << n_nucleic_acids
                     << "\nOligonucleotides: "
                     << id_data.getIdentifiedOligos().size()
@@ -405,6 +405,7 @@ protected:
     setValidFormats_("tr", ListUtils::create<String>("traML,tsv,pqp"));
     registerStringOption_("tr_type", "<type>", "", "input file type -- default: determined from file extension or content\n", false);
     setValidStrings_("tr_type", ListUtils::create<String>("traML,tsv,pqp"));
+    registerStringOption_("tr_cache", "<file>", "", "Binary assay library used as cache for '-tr' (see TransitionBinaryFile). Loaded instead of '-tr' if it is up to date, otherwise (re-)generated from '-tr'. Speeds up the startup for large libraries.", false, true);
 
     // one of the following two needs to be set
     registerInputFile_("tr_irt", "<file>", "", "transition file ('TraML')", false);
@@ -435,6 +436,7 @@ protected:
 
     registerOutputFile_("out_osw", "<file>", "", "OSW output file (PyProphet-compatible SQLite file)", false);
     setValidFormats_("out_osw", ListUtils::create<String>("osw"));
+    registerFlag_("out_osw_unsynchronized", "Write the OSW file without waiting for the data to reach the disk (faster, but a crash or power failure during the run can leave a corrupt file)", true);
 
     registerOutputFile_("out_chrom", "<file>", "", "Also output all computed chromatograms output in mzML (chrom.mzML) or sqMass (SQLite format)", false, true);
     setValidFormats_("out_chrom", ListUtils::create<String>("mzML,sqMass"));
@@ -784,7 +786,7 @@ protected:
     ///////////////////////////////////
     // Load the transitions
     ///////////////////////////////////
-    OpenSwath::LightTargetedExperiment transition_exp = loadTransitionList(tr_type, tr_file, tsv_reader_param);
+    OpenSwath::LightTargetedExperiment transition_exp = loadTransitionList(tr_type, tr_file, tsv_reader_param, getStringOption_("tr_cache"));
     OPENMS_LOG_INFO << "Loaded " << transition_exp.getProteins().size() << " proteins, " <<
       transition_exp.getCompounds().size() << " compounds with " << transition_exp.getTransitions().size() << " transitions." << std::endl;
 
@@ -929,6 +931,7 @@ protected:
     FeatureMap out_featureFile;
     OpenSwathTSVWriter tsvwriter(out_tsv, file_list[0], use_ms1_traces, sonar); // only active if filename not empty
     OpenSwathOSWWriter oswwriter(out_osw, run_id, file_list[0], enable_uis_scoring); // only active if filename not empty
+    oswwriter.enableBulkWrite(100000, 1000000, !getFlag_("out_osw_unsynchronized")); // write .osw from a dedicated thread using prepared statements
 
     ///////////////////////////////////
     // Extract and score
@@ -13,6 +13,7 @@
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/CONCEPT/Constants.h>
 #include <OpenMS/ANALYSIS/ID/PercolatorFeatureSetHelper.h>
+#include <OpenMS/METADATA/PSMTable.h>
 #include <QtCore/QFile>
 #include <QtCore/QDir>
 #include <QtCore/QProcess>
@@ -257,7 +258,23 @@ protected:
     for (vector<PeptideIdentification>::iterator it = all_peptide_ids.begin(); it != all_peptide_ids.end(); ++it)
     {
       it->setIdentifier(run_identifier);
-      PercolatorFeatureSetHelper::checkExtraFeatures(it->getHits(), extra_features);  // will remove inconsistently available features
+    }
+    // will remove inconsistently available features
+    if (!extra_features.empty())
+    {
+      if (PSMTable::hasUniformScoreType(all_peptide_ids))
+      {
+        PSMTable psms;
+        psms.importIDs(all_peptide_ids, extra_features);
+        PercolatorFeatureSetHelper::checkExtraFeatures(psms, extra_features);
+      }
+      else // concatenated search engine results with different score types
+      {
+        for (const PeptideIdentification& pep_id : all_peptide_ids)
+        {
+          PercolatorFeatureSetHelper::checkExtraFeatures(pep_id.getHits(), extra_features);
+        }
+      }
     }
     
     if (all_protein_ids.size() > 1)
@@ -105,6 +105,10 @@ class SimpleSearchEngine :
       //TODO ??? Why not use the TOPPBase ExitCodes?
       // same for OpenPepXL etc. Otherwise please write a proper mapping.
       SimpleSearchEngineAlgorithm::ExitCodes e = sse.search(in, database, protein_ids, peptide_ids);
+      if (e == SimpleSearchEngineAlgorithm::ExitCodes::ILLEGAL_PARAMETERS)
+      {
+        return TOPPBase::ExitCodes::ILLEGAL_PARAMETERS;
+      }
       if (e != SimpleSearchEngineAlgorithm::ExitCodes::EXECUTION_OK)
       {
         return TOPPBase::ExitCodes::INTERNAL_ERROR;
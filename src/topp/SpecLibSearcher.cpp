@@ -8,19 +8,21 @@
 
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/KERNEL/BinnedSpectrum.h>
 #include <OpenMS/COMPARISON/SpectraSTSimilarityScore.h>
+#include <OpenMS/COMPARISON/SpectrumComparisonKernels.h>
 #include <OpenMS/COMPARISON/ZhangSimilarityScore.h>
 #include <OpenMS/FORMAT/FileHandler.h>
-// TODO add ID support to Handler
-#include <OpenMS/FORMAT/MSPFile.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/MATH/MathFunctions.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
+#include <OpenMS/SYSTEM/File.h>
 
 #include <ctime>
+#include <exception>
 #include <vector>
 #include <map>
 #include <cmath>
@@ -79,6 +81,7 @@ protected:
     setValidFormats_("in", ListUtils::create<String>("mzML"));
     registerInputFile_("lib", "<file>", "", "searchable spectral library (MSP format)");
     setValidFormats_("lib", ListUtils::create<String>("msp"));
+    registerStringOption_("lib_index", "<file>", "", "Binary index of '-lib' (see SpectralLibraryIndex). Used instead of parsing '-lib' if it is up to date with the library and the filter/modification settings, otherwise (re-)generated. Keep it next to large libraries to avoid parsing them for every search.", false, true);
     registerOutputFileList_("out", "<files>", ListUtils::create<String>(""), "Output files. Have to be as many as input files");
     setValidFormats_("out", ListUtils::create<String>("idXML"));
 
@@ -135,112 +138,6 @@ protected:
     addEmptyLine_();
   }
 
-  using MapLibraryPrecursorToLibrarySpectrum = multimap<double, PeakSpectrum>;
-    
-  MapLibraryPrecursorToLibrarySpectrum annotateIdentificationsToSpectra_(const vector<PeptideIdentification>& ids, 
-    const PeakMap& library, 
-    StringList variable_modifications, 
-    StringList fixed_modifications,
-    double remove_peaks_below_threshold)
-  {
-    MapLibraryPrecursorToLibrarySpectrum annotated_lib;
-
-    ModificationsDB* mdb = ModificationsDB::getInstance();
-
-
-    // iterate over library spectra and add associated annotations
-    PeakMap::const_iterator library_it = library.begin();
-    vector<PeptideIdentification>::const_iterator id_it = ids.begin();
-    for (; library_it < library.end(); ++library_it, ++id_it)
-    {
-      const MSSpectrum& lib_spec = *library_it;
-      const double& precursor_MZ = lib_spec.getPrecursors()[0].getMZ();
-
-      const PeptideIdentification& id = *id_it;
-      const AASequence& aaseq = id.getHits()[0].getSequence();
-
-      PeakSpectrum lib_entry;
-      bool variable_modifications_ok(true), fixed_modifications_ok(true);
-
-       // check if each amino acid listed as modified in fixed modifications are modified
-       if (!fixed_modifications.empty())
-       {
-         for (Size j = 0; j < aaseq.size(); ++j)
-         {
-           const Residue& mod = aaseq.getResidue(j);
-           for (Size k = 0; k < fixed_modifications.size(); ++k)
-           {
-             if (mod.getOneLetterCode()[0] == mdb->getModification(fixed_modifications[k])->getOrigin() && fixed_modifications[k] != mod.getModificationName())
-             {
-               fixed_modifications_ok = false;
-               break;
-             }
-           }
-         }
-       }
-
-       // check if each amino acid listed in variable modifications is either unmodified or modified with the corresponding modification
-       // Note: this code currently does not allow for multiple variable modifications with same origin
-       if (aaseq.isModified() && (!variable_modifications.empty()))
-       {
-         for (Size j = 0; j < aaseq.size(); ++j)
-         {
-           if (!aaseq[j].isModified()) { continue; }
-          
-           const Residue& mod = aaseq.getResidue(j);
-           for (Size k = 0; k < variable_modifications.size(); ++k)
-           {
-             if (mod.getOneLetterCode()[0] == mdb->getModification(variable_modifications[k])->getOrigin() && variable_modifications[k] != mod.getModificationName())
-             {
-               variable_modifications_ok = false;
-               break;
-             }
-           }
-         }
-       }
-
-       // TODO: check entries that don't adhere to this rule
-       if (!variable_modifications_ok || !fixed_modifications_ok) { continue; }
-
-       // copy peptide identification over to spectrum meta data
-       lib_entry.getPeptideIdentifications().push_back(id);
-       lib_entry.setPrecursors(lib_spec.getPrecursors());
-
-       // empty array would segfault
-       if (id.getHits().empty() || id.getHits()[0].getPeakAnnotations().empty())
-       {
-         throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Expected StringDataArray of type MSPeakInfo");
-       }
-
-       const vector<PeptideHit::PeakAnnotation>& pa = id.getHits()[0].getPeakAnnotations();
-       // library entry transformation
-       for (UInt l = 0; l < lib_spec.size(); ++l)
-       {
-         Peak1D peak;
-         if (lib_spec[l].getIntensity() > remove_peaks_below_threshold)
-         {
-           // this is the "MSPPeakInfo" array, see MSPFile which creates a single StringDataArray
-           const String& sa = pa[l].annotation;
-
-           // TODO: check why this scaling is done for ? peaks (dubious peaks?)
-           if (sa[0] == '?')
-           {
-             peak.setIntensity(sqrt(0.2 * lib_spec[l].getIntensity()));
-           }
-           else
-           {
-             peak.setIntensity(sqrt(lib_spec[l].getIntensity()));
-           }
-
-           peak.setMZ(lib_spec[l].getMZ());
-           lib_entry.push_back(peak);
-         }
-       }
-       annotated_lib.insert(make_pair(precursor_MZ, lib_entry));
-     }
-    return annotated_lib;
-  }
-
   ExitCodes main_(int, const char**) override
   {
     //-------------------------------------------------------------
@@ -289,39 +186,21 @@ protected:
     }
 
     time_t prog_time = time(nullptr);
-    MSPFile spectral_library;
-    PeakMap query, library;
+    PeakMap query;
 
     time_t start_build_time = time(nullptr);
     // -------------------------------------------------------------
-    // building map for faster search
+    // library index for fast search
     // -------------------------------------------------------------
 
-    // library containing already identified peptide spectra
-    vector<PeptideIdentification> ids;
-    spectral_library.load(in_lib, ids, library);
-
-    /*
-    // Output bin histogram
-    BinnedSpectrum bin_frequency(0.01, 1, PeakSpectrum());
-    for (auto const & s : library)
-    {
-      BinnedSpectrum b(0.01, 1, s);
-      // e.g.: bin_frequency.getBins() += b.getBins();  // sum up itensities
-      // e.g.: bin_frequency.getBins() += b.getBins().coeffs().cwiseMin(1.0f); // count occupied bins (by truncating intensities >= 1 to 1)
-    }
-
-    for (BinnedSpectrum::SparseVectorIteratorType it(bin_frequency.getBins()); it; ++it)
-    {
-      // output m/z of bin start and average bin intensity
-      cout << it.index() * bin_frequency.getBinSize()  << "\t" << static_cast<float>(it.value()/library.size()) << "\n";
-      cout << static_cast<float>(it.value()) << "\n";
-      cout << static_cast<float>(library.size()) << "\n";
-    }
-    cout << endl;
-    */
-
-    MapLibraryPrecursorToLibrarySpectrum mslib = annotateIdentificationsToSpectra_(ids, library, variable_modifications, fixed_modifications, remove_peaks_below_threshold);
+    // library containing already identified peptide spectra, preprocessed and sorted by precursor m/z
+    // (without -lib_index, a temporary index is created)
+    SpectralLibraryIndex::Parameters index_params;
+    index_params.remove_peaks_below_threshold = remove_peaks_below_threshold;
+    index_params.fixed_modifications = fixed_modifications;
+    index_params.variable_modifications = variable_modifications;
+    SpectralLibraryIndex mslib;
+    mslib.openOrCreate(File::getTemporaryFile(getStringOption_("lib_index")), in_lib, index_params);
 
     time_t end_build_time = time(nullptr);
     OPENMS_LOG_INFO << "Time needed for preprocessing data: " << (end_build_time - start_build_time) << "\n";
@@ -341,11 +220,12 @@ protected:
       writeLogError_("Unknown compare function");
       return ILLEGAL_PARAMETERS;
     }
+    // the SpectraST score works on the binned spectra (the library spectra are binned in the index)
+    SpectraSTSimilarityScore* spectrast = dynamic_cast<SpectraSTSimilarityScore*>(comparator.get());
  
    //-------------------------------------------------------------
     // calculations
     //-------------------------------------------------------------
-    double score;
     StringList::iterator in, out_file;
     for (in  = in_spec.begin(), out_file  = out.begin(); in < in_spec.end(); ++in, ++out_file)
     {
@@ -381,204 +261,248 @@ protected:
 
       prot_id.setSearchParameters(search_parameters);
 
-
-      /***********SEARCH**********/
+      // one (pseudo) protein hit per query spectrum
       for (UInt j = 0; j < query.size(); ++j)
       {
-        //Set identifier for each identifications
-        PeptideIdentification pid;
-        pid.setIdentifier("test");
-        pid.setScoreType(compare_function);
         ProteinHit pr_hit;
         pr_hit.setAccession(j);
         prot_id.insertHit(pr_hit);
+      }
 
-        // proper MS2?
-        if (query[j].empty() || query[j].getMSLevel() != 2)
-        {
-          continue;
-        }
-
-        if (query[j].getPrecursors().empty())
-        {
-          writeLogWarn_("Warning MS2 spectrum without precursor information");
-          continue;
-        }
-
-        // filter query spectrum
-        double max_intensity = std::max_element(query[j].begin(), query[j].end(), 
-                                [](const Peak1D& l, const Peak1D& r) 
-                                { 
-                                  return (l.getIntensity() < r.getIntensity()); 
-                                })->getIntensity();
-
-        double min_high_intensity = max_intensity / cut_peaks_below;
+      /***********SEARCH**********/
+      // query spectra are searched in parallel; results, warnings and errors are collected in spectrum order afterwards
+      vector<PeptideIdentification> query_ids(query.size());
+      vector<char> searched(query.size(), false), missing_precursor(query.size(), false);
+      vector<std::exception_ptr> errors(query.size());
 
-        PeakSpectrum filtered_query;
-        for (UInt k = 0; k < query[j].size(); ++k)
+#pragma omp parallel
+      {
+        // per-thread buffers
+        std::vector<Size> candidates;
+        std::vector<SpectrumComparisonKernels::PeakArraysView> candidate_peaks;
+        std::vector<double> scores;
+        SpectrumComparisonKernels::DenseBins query_bins;
+
+#pragma omp for schedule(dynamic)
+        for (SignedSize j = 0; j < (SignedSize)query.size(); ++j)
         {
-          if (query[j][k].getIntensity() >= remove_peaks_below_threshold 
-           && query[j][k].getIntensity() >= min_high_intensity)
+          try
           {
-            Peak1D peak;
-            peak.setIntensity(sqrt(query[j][k].getIntensity()));
-            peak.setMZ(query[j][k].getMZ());
-            filtered_query.push_back(peak);
-          }
-        }
-
-        // retain only top N peaks
-        if (filtered_query.size() > max_peaks)
-        {
-          filtered_query.sortByIntensity(true);
-          filtered_query.resize(max_peaks);
-          filtered_query.sortByPosition();
-        }
-
-        if (filtered_query.size() < min_peaks)
-        { 
-          continue;
-        }
-
-        const double& query_rt = query[j].getRT();
-        const int& query_charge = query[j].getPrecursors()[0].getCharge();
-        const double query_mz = query[j].getPrecursors()[0].getMZ();
-        
-        if (query_charge > 0 && (query_charge < pc_min_charge || query_charge > pc_max_charge))
-        { 
-          continue;
-        } 
-
-        for (auto const & iso : isotopes)
-        {
-          // isotopic misassignment corrected query
-          const double ic_query_mz = query_mz - iso * Constants::C13C12_MASSDIFF_U;
+            //Set identifier for each identifications
+            PeptideIdentification& pid = query_ids[j];
+            pid.setIdentifier("test");
+            pid.setScoreType(compare_function);
+            const String accession((UInt)j);
+
+            // proper MS2?
+            if (query[j].empty() || query[j].getMSLevel() != 2)
+            {
+              continue;
+            }
 
-          // if tolerance unit is ppm convert to m/z
-          const double precursor_mass_tolerance_mz = precursor_mass_tolerance_unit_ppm ? ic_query_mz * precursor_mass_tolerance * 1e-6 : precursor_mass_tolerance;
+            if (query[j].getPrecursors().empty())
+            {
+              missing_precursor[j] = true;
+              continue;
+            }
 
-          // skip matching of isotopic misassignments if charge not annotated
-          if (iso != 0 && query_charge == 0)
-          {
-            continue;
-          }
+            // filter query spectrum
+            double max_intensity = std::max_element(query[j].begin(), query[j].end(), 
+                                    [](const Peak1D& l, const Peak1D& r) 
+                                    { 
+                                      return (l.getIntensity() < r.getIntensity()); 
+                                    })->getIntensity();
 
-          // skip matching of isotopic misassignments if search windows around isotopic peaks would overlap (resulting in more than one report of the same hit)
-          const double isotopic_peak_distance_mz = Constants::C13C12_MASSDIFF_U / query_charge;
-          if (iso != 0 && precursor_mass_tolerance_mz >= 0.5 * isotopic_peak_distance_mz)
-          { 
-            continue;
-          }
+            double min_high_intensity = max_intensity / cut_peaks_below;
 
-          /* TODO: remove old code for charge estimation?
-          bool charge_one = false;
-          Int percent = (Int) Math::round((query[j].size() / 100.0) * 3.0);
-          Int margin  = (Int) Math::round((query[j].size() / 100.0) * 1.0);
-          for (vector<Peak1D>::iterator peak = query[j].end() - 1; percent >= 0; --peak, --percent)
-          {
-            if (peak->getMZ() < query_MZ)
+            PeakSpectrum filtered_query;
+            for (UInt k = 0; k < query[j].size(); ++k)
             {
-              break;
+              if (query[j][k].getIntensity() >= remove_peaks_below_threshold 
+               && query[j][k].getIntensity() >= min_high_intensity)
+              {
+                Peak1D peak;
+                peak.setIntensity(sqrt(query[j][k].getIntensity()));
+                peak.setMZ(query[j][k].getMZ());
+                filtered_query.push_back(peak);
+              }
             }
-          }
-          if (percent > margin)
-          {
-            charge_one = true;
-          }
-          */
-
-
-          // determine MS2 precursors that match to the current peptide mass
-          MapLibraryPrecursorToLibrarySpectrum::const_iterator low_it, up_it;
-        
-          low_it = mslib.lower_bound(ic_query_mz - 0.5 * precursor_mass_tolerance_mz);
-          up_it = mslib.upper_bound(ic_query_mz + 0.5 * precursor_mass_tolerance_mz);
-        
-          // no matching precursor in data
-          if (low_it == up_it)
-          { 
-            continue;
-          }
-       
-          for (; low_it != up_it; ++low_it)
-          {
-            const PeakSpectrum& lib_spec = low_it->second;;
-            PeptideHit hit = lib_spec.getPeptideIdentifications()[0].getHits()[0];
-            const int& lib_charge = hit.getCharge();  
 
-            // check if charge state between library and experimental spectrum match
-            if (query_charge > 0 && lib_charge != query_charge)
+            // retain only top N peaks
+            if (filtered_query.size() > max_peaks)
             {
+              filtered_query.sortByIntensity(true);
+              filtered_query.resize(max_peaks);
+              filtered_query.sortByPosition();
+            }
+
+            if (filtered_query.size() < min_peaks)
+            { 
               continue;
             }
 
-            // Special treatment for SpectraST score as it computes a score based on the whole library
-            if (compare_function == "SpectraSTSimilarityScore")
+            const double& query_rt = query[j].getRT();
+            const int& query_charge = query[j].getPrecursors()[0].getCharge();
+            const double query_mz = query[j].getPrecursors()[0].getMZ();
+            
+            if (query_charge > 0 && (query_charge < pc_min_charge || query_charge > pc_max_charge))
+            { 
+              continue;
+            } 
+
+            // binned query for the SpectraST score
+            if (spectrast != nullptr)
             {
-              auto& sp = dynamic_cast<SpectraSTSimilarityScore&>(*comparator);
-              BinnedSpectrum quer_bin_spec = sp.transform(filtered_query);
-              BinnedSpectrum lib_bin_spec = sp.transform(lib_spec);
-              score = sp(filtered_query, lib_spec); //(*sp)(quer_bin,librar_bin);
-              double dot_bias = sp.dot_bias(quer_bin_spec, lib_bin_spec, score);
-              hit.setMetaValue("DOTBIAS", dot_bias);
+              query_bins.assign(*spectrast->transform(filtered_query).getBins());
             }
-            else
+
+            for (auto const & iso : isotopes)
             {
-              score = (*comparator)(filtered_query, lib_spec);
-            }
+              // isotopic misassignment corrected query
+              const double ic_query_mz = query_mz - iso * Constants::C13C12_MASSDIFF_U;
 
-            DataValue RT(lib_spec.getRT());
-            DataValue MZ(lib_spec.getPrecursors()[0].getMZ());
-            hit.setMetaValue("lib:RT", RT);
-            hit.setMetaValue("lib:MZ", MZ);
-            hit.setMetaValue(Constants::UserParam::ISOTOPE_ERROR, iso);
-            hit.setScore(score);
-            PeptideEvidence pe;
-            pe.setProteinAccession(pr_hit.getAccession());
-            hit.addPeptideEvidence(pe);
-            pid.insertHit(hit);
-          }
-        }
+              // if tolerance unit is ppm convert to m/z
+              const double precursor_mass_tolerance_mz = precursor_mass_tolerance_unit_ppm ? ic_query_mz * precursor_mass_tolerance * 1e-6 : precursor_mass_tolerance;
 
-        pid.setHigherScoreBetter(true);
-        pid.sort();
+              // skip matching of isotopic misassignments if charge not annotated
+              if (iso != 0 && query_charge == 0)
+              {
+                continue;
+              }
 
-        if (compare_function == "SpectraSTSimilarityScore")
-        {
-          if (!pid.empty() && !pid.getHits().empty())
-          {
-            vector<PeptideHit> final_hits;
-            final_hits.resize(pid.getHits().size());
-            auto& sp = dynamic_cast<SpectraSTSimilarityScore&>(*comparator);
-            Size runner_up = 1;
-            for (; runner_up < pid.getHits().size(); ++runner_up)
+              // skip matching of isotopic misassignments if search windows around isotopic peaks would overlap (resulting in more than one report of the same hit)
+              const double isotopic_peak_distance_mz = Constants::C13C12_MASSDIFF_U / query_charge;
+              if (iso != 0 && precursor_mass_tolerance_mz >= 0.5 * isotopic_peak_distance_mz)
+              { 
+                continue;
+              }
+
+              // determine MS2 precursors that match to the current peptide mass
+              const std::pair<Size, Size> range = mslib.getSpectrumRange(ic_query_mz - 0.5 * precursor_mass_tolerance_mz, ic_query_mz + 0.5 * precursor_mass_tolerance_mz);
+
+              // no matching precursor in data
+              if (range.first == range.second)
+              { 
+                continue;
+              }
+           
+              // library spectra with matching charge state, scored against the query in one batch
+              candidates.clear();
+              for (Size lib = range.first; lib != range.second; ++lib)
+              {
+                // check if charge state between library and experimental spectrum match
+                if (query_charge > 0 && mslib.getSpectrum(lib).charge != query_charge)
+                {
+                  continue;
+                }
+                candidates.push_back(lib);
+              }
+              scores.resize(candidates.size());
+              if (spectrast != nullptr)
+              {
+                // normalized dot product of the binned spectra
+                for (Size c = 0; c < candidates.size(); ++c)
+                {
+                  scores[c] = query_bins.dot(mslib.getBins(candidates[c]));
+                }
+              }
+              else
+              {
+                candidate_peaks.clear();
+                for (const Size lib : candidates)
+                {
+                  candidate_peaks.push_back(mslib.getPeaks(lib));
+                }
+                comparator->batchCompareViews(filtered_query, candidate_peaks, scores);
+              }
+
+              for (Size c = 0; c < candidates.size(); ++c)
+              {
+                const SpectralLibraryIndex::SpectrumRecord& lib_spec = mslib.getSpectrum(candidates[c]);
+                PeptideHit hit = mslib.getPeptideHit(candidates[c]);
+                double score = scores[c];
+
+                // Special treatment for SpectraST score as it computes a score based on the whole library
+                if (spectrast != nullptr)
+                {
+                  double dot_bias = spectrast->dot_bias(query_bins, mslib.getBins(candidates[c]), score);
+                  hit.setMetaValue("DOTBIAS", dot_bias);
+                }
+
+                DataValue RT(lib_spec.rt);
+                DataValue MZ(lib_spec.precursor_mz);
+                hit.setMetaValue("lib:RT", RT);
+                hit.setMetaValue("lib:MZ", MZ);
+                hit.setMetaValue(Constants::UserParam::ISOTOPE_ERROR, iso);
+                hit.setScore(score);
+                PeptideEvidence pe;
+                pe.setProteinAccession(accession);
+                hit.addPeptideEvidence(pe);
+                pid.insertHit(hit);
+              }
+            }
+
+            pid.setHigherScoreBetter(true);
+            pid.sort();
+
+            if (spectrast != nullptr)
             {
-              if (pid.getHits()[0].getSequence().toUnmodifiedString() != pid.getHits()[runner_up].getSequence().toUnmodifiedString() 
-               || runner_up > 5)
+              if (!pid.empty() && !pid.getHits().empty())
               {
-                break;
+                vector<PeptideHit> final_hits;
+                final_hits.resize(pid.getHits().size());
+                auto& sp = *spectrast;
+                Size runner_up = 1;
+                for (; runner_up < pid.getHits().size(); ++runner_up)
+                {
+                  if (pid.getHits()[0].getSequence().toUnmodifiedString() != pid.getHits()[runner_up].getSequence().toUnmodifiedString() 
+                   || runner_up > 5)
+                  {
+                    break;
+                  }
+                }
+                double delta_D = sp.delta_D(pid.getHits()[0].getScore(), pid.getHits()[runner_up].getScore());
+                for (Size s = 0; s < pid.getHits().size(); ++s)
+                {
+                  final_hits[s] = pid.getHits()[s];
+                  final_hits[s].setMetaValue("delta D", delta_D);
+                  final_hits[s].setMetaValue("dot product", pid.getHits()[s].getScore());
+                  final_hits[s].setScore(sp.compute_F(pid.getHits()[s].getScore(), delta_D, pid.getHits()[s].getMetaValue("DOTBIAS")));
+                }
+                pid.setHits(final_hits);
+                pid.sort();
+                pid.setMZ(query[j].getPrecursors()[0].getMZ());
+                pid.setRT(query_rt);
               }
             }
-            double delta_D = sp.delta_D(pid.getHits()[0].getScore(), pid.getHits()[runner_up].getScore());
-            for (Size s = 0; s < pid.getHits().size(); ++s)
+
+            if (top_hits != -1 && (UInt)top_hits < pid.getHits().size())
             {
-              final_hits[s] = pid.getHits()[s];
-              final_hits[s].setMetaValue("delta D", delta_D);
-              final_hits[s].setMetaValue("dot product", pid.getHits()[s].getScore());
-              final_hits[s].setScore(sp.compute_F(pid.getHits()[s].getScore(), delta_D, pid.getHits()[s].getMetaValue("DOTBIAS")));
+              pid.getHits().resize(top_hits);
             }
-            pid.setHits(final_hits);
-            pid.sort();
-            pid.setMZ(query[j].getPrecursors()[0].getMZ());
-            pid.setRT(query_rt);
+            searched[j] = true;
+          }
+          catch (...)
+          {
+            errors[j] = std::current_exception();
           }
         }
+      }
 
-        if (top_hits != -1 && (UInt)top_hits < pid.getHits().size())
+      for (Size j = 0; j < query.size(); ++j)
+      {
+        if (missing_precursor[j])
+        {
+          writeLogWarn_("Warning MS2 spectrum without precursor information");
+        }
+        if (errors[j])
+        {
+          std::rethrow_exception(errors[j]);
+        }
+        if (searched[j])
         {
-          pid.getHits().resize(top_hits);
+          peptide_ids.push_back(std::move(query_ids[j]));
         }
-        peptide_ids.push_back(pid);
       }
       protein_ids.push_back(prot_id);
 